@@ -99,12 +99,64 @@ static inline void vkd3d_memcpy_aligned_cached(void *dst_, const void *src_, siz
         vkd3d_memcpy_aligned_16_cached(dst + i, src + i);
 }
 
+/* For arbitrarily aligned copies into write-combined memory, e.g. mapped UPLOAD heaps.
+ * Destination is aligned up to 16 bytes with a plain copy, and the bulk is written with
+ * streaming stores so that we never read back cache lines from uncached memory.
+ * Caller must issue vkd3d_memcpy_non_temporal_barrier() before handing the memory to the GPU. */
+static inline void vkd3d_memcpy_non_temporal(void *dst_, const void *src_, size_t size)
+{
+    const uint8_t *src = src_;
+    uint8_t *dst = dst_;
+    size_t head;
+    __m128i a, b, c, d;
+
+    head = (16 - ((uintptr_t)dst & 15)) & 15;
+
+    if (size < head + 64)
+    {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    while (size >= 64)
+    {
+        a = _mm_loadu_si128((const __m128i *)src + 0);
+        b = _mm_loadu_si128((const __m128i *)src + 1);
+        c = _mm_loadu_si128((const __m128i *)src + 2);
+        d = _mm_loadu_si128((const __m128i *)src + 3);
+        _mm_stream_si128((__m128i *)dst + 0, a);
+        _mm_stream_si128((__m128i *)dst + 1, b);
+        _mm_stream_si128((__m128i *)dst + 2, c);
+        _mm_stream_si128((__m128i *)dst + 3, d);
+        dst += 64;
+        src += 64;
+        size -= 64;
+    }
+
+    while (size >= 16)
+    {
+        a = _mm_loadu_si128((const __m128i *)src);
+        _mm_stream_si128((__m128i *)dst, a);
+        dst += 16;
+        src += 16;
+        size -= 16;
+    }
+
+    memcpy(dst, src, size);
+}
+
 #define vkd3d_memcpy_non_temporal_barrier() _mm_sfence()
 #else
 #define vkd3d_memcpy_aligned_64_non_temporal(dst, src) memcpy((uint8_t *)(dst), (const uint8_t *)(src), 64)
 #define vkd3d_memcpy_aligned_32_non_temporal(dst, src) memcpy((uint8_t *)(dst), (const uint8_t *)(src), 32)
 #define vkd3d_memcpy_aligned_16_non_temporal(dst, src) memcpy((uint8_t *)(dst), (const uint8_t *)(src), 16)
 #define vkd3d_memcpy_aligned_non_temporal(dst, src, size) memcpy((uint8_t *)(dst), (const uint8_t *)(src), size)
+#define vkd3d_memcpy_non_temporal(dst, src, size) memcpy((uint8_t *)(dst), (const uint8_t *)(src), size)
 #define vkd3d_memcpy_aligned_64_cached(dst, src) memcpy((uint8_t *)(dst), (const uint8_t *)(src), 64)
 #define vkd3d_memcpy_aligned_32_cached(dst, src) memcpy((uint8_t *)(dst), (const uint8_t *)(src), 32)
 #define vkd3d_memcpy_aligned_16_cached(dst, src) memcpy((uint8_t *)(dst), (const uint8_t *)(src), 16)
@@ -112,4 +164,47 @@ static inline void vkd3d_memcpy_aligned_cached(void *dst_, const void *src_, siz
 #define vkd3d_memcpy_non_temporal_barrier() ((void)0)
 #endif
 
+#define VKD3D_MEMCPY_REPLICATE_BLOCK_SIZE 4096
+
+/* Fills dst with count back to back copies of a size byte element.
+ * The element is replicated into a cached staging block first, which is then streamed out in bulk,
+ * so dst is never read back. Use this to fill large, possibly uncached, mappings with a template.
+ * Caller must issue vkd3d_memcpy_non_temporal_barrier() before handing the memory to the GPU. */
+static inline void vkd3d_memcpy_replicate_non_temporal(void *dst_, const void *src, size_t size, size_t count)
+{
+    uint8_t block[VKD3D_MEMCPY_REPLICATE_BLOCK_SIZE];
+    size_t block_count, block_size, n;
+    uint8_t *dst = dst_;
+
+    if (!size || !count)
+        return;
+
+    if (size > sizeof(block))
+    {
+        for (n = 0; n < count; n++, dst += size)
+            vkd3d_memcpy_non_temporal(dst, src, size);
+        return;
+    }
+
+    block_count = sizeof(block) / size;
+    if (block_count > count)
+        block_count = count;
+    block_size = block_count * size;
+
+    /* Double the replicated range until we fill the block. */
+    memcpy(block, src, size);
+    for (n = size; n < block_size; n += n)
+        memcpy(block + n, block, n < block_size - n ? n : block_size - n);
+
+    while (count >= block_count)
+    {
+        vkd3d_memcpy_non_temporal(dst, block, block_size);
+        dst += block_size;
+        count -= block_count;
+    }
+
+    if (count)
+        vkd3d_memcpy_non_temporal(dst, block, count * size);
+}
+
 #endif
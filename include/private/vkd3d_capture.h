@@ -0,0 +1,60 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __VKD3D_CAPTURE_H
+#define __VKD3D_CAPTURE_H
+
+#include <stdint.h>
+
+/* Binary layout of API traces written with VKD3D_CAPTURE_PATH and consumed by vkd3d-proton-replay.
+ * A trace is a vkd3d_capture_header followed by records. Every record starts with a
+ * vkd3d_capture_record_header, and its payload is a sequence of little-endian uint32_t words,
+ * with variable length data (shader code, strings) stored as a word count followed by the data,
+ * padded to 4 bytes. Fixed-function state is stored in the D3D12 struct layouts, which only
+ * contain 32-bit members, so traces are portable between 32-bit and 64-bit builds. */
+
+#define VKD3D_CAPTURE_MAGIC 0x50414344u /* "DCAP" */
+#define VKD3D_CAPTURE_VERSION 1
+
+struct vkd3d_capture_header
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+enum vkd3d_capture_record_type
+{
+    /* u32 root_signature_id, u32 node_mask, blob. */
+    VKD3D_CAPTURE_RECORD_ROOT_SIGNATURE = 1,
+    /* u32 root_signature_id, u32 node_mask, u32 flags, blob CS. */
+    VKD3D_CAPTURE_RECORD_COMPUTE_PIPELINE = 2,
+    /* u32 root_signature_id, blob VS, PS, DS, HS, GS, stream output, blend state,
+     * u32 sample_mask, rasterizer state, depth-stencil state, input layout, u32 strip cut,
+     * u32 topology type, u32 rt_count, u32 rtv_formats[8], u32 dsv_format, sample desc,
+     * u32 node_mask, u32 flags. See vkd3d_capture_graphics_pipeline() for the exact order. */
+    VKD3D_CAPTURE_RECORD_GRAPHICS_PIPELINE = 3,
+};
+
+struct vkd3d_capture_record_header
+{
+    uint32_t type;
+    /* Payload size in bytes, excluding this header. Always a multiple of 4. */
+    uint32_t size;
+};
+
+#endif /* __VKD3D_CAPTURE_H */
@@ -174,6 +174,28 @@ static inline struct vkd3d_bitmask_range vkd3d_bitmask_iter32_range(uint32_t *ma
     return range;
 }
 
+static inline struct vkd3d_bitmask_range vkd3d_bitmask_iter64_range(uint64_t *mask)
+{
+    struct vkd3d_bitmask_range range;
+    uint64_t tmp;
+
+    if (*mask == ~0ull)
+    {
+        range.offset = 0;
+        range.count = 64;
+        *mask = 0ull;
+    }
+    else
+    {
+        range.offset = vkd3d_bitmask_tzcnt64(*mask);
+        tmp = *mask >> range.offset;
+        range.count = vkd3d_bitmask_tzcnt64(~tmp);
+        *mask &= ~(((1ull << range.count) - 1ull) << range.offset);
+    }
+
+    return range;
+}
+
 /* Undefined for x == 0. */
 static inline unsigned int vkd3d_log2i(unsigned int x)
 {
@@ -311,6 +333,25 @@ static inline uint64_t vkd3d_get_current_time_ns(void)
 #endif
 }
 
+static inline void vkd3d_sleep_until_ns(uint64_t deadline_ns)
+{
+    uint64_t now_ns;
+
+    while ((now_ns = vkd3d_get_current_time_ns()) < deadline_ns)
+    {
+#ifdef _WIN32
+        /* Sleep() is only accurate to a millisecond or so, spin for the remainder. */
+        if (deadline_ns - now_ns > 2000000)
+            Sleep((DWORD)((deadline_ns - now_ns) / 1000000) - 1);
+#else
+        struct timespec ts;
+        ts.tv_sec = (deadline_ns - now_ns) / 1000000000;
+        ts.tv_nsec = (deadline_ns - now_ns) % 1000000000;
+        nanosleep(&ts, NULL);
+#endif
+    }
+}
+
 #ifdef _MSC_VER
 #pragma intrinsic(__rdtsc)
 #endif
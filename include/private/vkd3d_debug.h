@@ -90,9 +90,24 @@ const char *debugstr_w(const WCHAR *wstr);
         vkd3d_dbg_next_time = true; \
         VKD3D_DBG_PRINTF
 
+/* After this many messages, a FIXME call site is demoted to WARN, so that
+ * unimplemented paths hit every frame do not flood the log. */
+#define VKD3D_DBG_FIXME_THROTTLE_COUNT 16u
+
+#define VKD3D_DBG_LOG_THROTTLED(first_level, level, count) \
+        do { \
+        static unsigned int vkd3d_dbg_call_count; \
+        const enum vkd3d_dbg_channel vkd3d_dbg_channel = VKD3D_DBG_CHANNEL; \
+        const enum vkd3d_dbg_level vkd3d_dbg_level = vkd3d_dbg_call_count < (count) \
+        ? VKD3D_DBG_LEVEL_##first_level : VKD3D_DBG_LEVEL_##level; \
+        if (vkd3d_dbg_call_count < (count)) vkd3d_dbg_call_count++; \
+        VKD3D_DBG_PRINTF
+
+/* Check the level before evaluating any arguments. Disabled messages are the common case. */
 #define VKD3D_DBG_PRINTF(...) \
         VKD3D_DBG_DISABLE_DEBUG_FILE(); \
-        vkd3d_dbg_printf(vkd3d_dbg_channel, vkd3d_dbg_level, __FUNCTION__, __VA_ARGS__); } while (0)
+        if (VKD3D_EXPECT_FALSE(vkd3d_dbg_get_level(vkd3d_dbg_channel) >= vkd3d_dbg_level)) \
+            vkd3d_dbg_printf(vkd3d_dbg_channel, vkd3d_dbg_level, __FUNCTION__, __VA_ARGS__); } while (0)
 
 #ifndef TRACE
 #define TRACE VKD3D_DBG_LOG(TRACE)
@@ -103,7 +118,7 @@ const char *debugstr_w(const WCHAR *wstr);
 #endif
 
 #ifndef FIXME
-#define FIXME VKD3D_DBG_LOG(FIXME)
+#define FIXME VKD3D_DBG_LOG_THROTTLED(FIXME, WARN, VKD3D_DBG_FIXME_THROTTLE_COUNT)
 #endif
 
 #define ERR   VKD3D_DBG_LOG(ERR)
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __VKD3D_JOB_POOL_H
+#define __VKD3D_JOB_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vkd3d_threads.h"
+#include "vkd3d_platform.h"
+#include "vkd3d_spinlock.h"
+#include "vkd3d_atomic.h"
+#include "list.h"
+
+/* Bounded worker pool for background work which is not latency critical.
+ * Every worker owns a deque. Jobs enqueued from a worker go to its own deque and are popped
+ * LIFO, so nested work stays hot in cache, while idle workers steal FIFO from the others.
+ * Jobs enqueued from any other thread are distributed round-robin. */
+
+#define VKD3D_JOB_POOL_MAX_THREADS 16
+
+enum vkd3d_job_status
+{
+    VKD3D_JOB_STATUS_NONE = 0,
+    VKD3D_JOB_STATUS_QUEUED,
+    VKD3D_JOB_STATUS_RUNNING,
+};
+
+struct vkd3d_job
+{
+    struct list entry;
+    /* Called on a worker, or on a thread which waits for the job before a worker picks it up. */
+    void (*callback)(void *userdata);
+    /* Optional, called once the job is no longer observed as pending. */
+    void (*release)(void *userdata);
+    void *userdata;
+    uint32_t status; /* enum vkd3d_job_status */
+    /* Deque which holds the job while it is queued. */
+    uint32_t queue_index;
+};
+
+struct vkd3d_job_queue
+{
+    spinlock_t lock;
+    struct list jobs;
+    /* Passed to the worker which owns the deque. */
+    struct vkd3d_job_pool *pool;
+};
+
+struct vkd3d_job_pool
+{
+    /* Only used for sleeping and for waiting on completion, the deques have their own locks. */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_cond_t done_cond;
+
+    struct vkd3d_job_queue queues[VKD3D_JOB_POOL_MAX_THREADS];
+    pthread_t threads[VKD3D_JOB_POOL_MAX_THREADS];
+    uint32_t thread_count;
+    uint32_t pending_count;
+    uint32_t next_queue;
+    bool should_exit;
+
+    const char *thread_name;
+    enum vkd3d_thread_priority thread_priority;
+};
+
+/* Returns the default worker count for this machine, overridden by VKD3D_WORKER_THREADS. */
+uint32_t vkd3d_job_pool_get_default_thread_count(void);
+/* Returns errno style error code. The pool must have at least one thread. */
+int vkd3d_job_pool_init(struct vkd3d_job_pool *pool, uint32_t thread_count,
+        const char *thread_name, enum vkd3d_thread_priority thread_priority);
+/* Drains all pending jobs before joining the workers. */
+void vkd3d_job_pool_cleanup(struct vkd3d_job_pool *pool);
+void vkd3d_job_pool_enqueue(struct vkd3d_job_pool *pool, struct vkd3d_job *job);
+/* Runs the job inline if no worker has picked it up yet. */
+void vkd3d_job_pool_wait(struct vkd3d_job_pool *pool, struct vkd3d_job *job);
+
+static inline bool vkd3d_job_is_pending(struct vkd3d_job *job)
+{
+    return vkd3d_atomic_uint32_load_explicit(&job->status, vkd3d_memory_order_acquire) !=
+            VKD3D_JOB_STATUS_NONE;
+}
+
+#endif /* __VKD3D_JOB_POOL_H */
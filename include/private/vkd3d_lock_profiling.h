@@ -0,0 +1,34 @@
+/*
+ * Copyright 2020 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __VKD3D_LOCK_PROFILING_H
+#define __VKD3D_LOCK_PROFILING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* With -Denable_lock_profiling=true, the lock wrappers in vkd3d_threads.h, vkd3d_spinlock.h
+ * and vkd3d_rw_spinlock.h are redirected to instrumented versions which report every acquisition
+ * to a "lock <expression>" profiling block, keyed on the spelling of the lock at the call site.
+ * This header has no dependencies so that the lock headers themselves can include it. */
+#ifdef VKD3D_ENABLE_LOCK_PROFILING
+uint64_t vkd3d_lock_profiling_get_ticks(void);
+void vkd3d_lock_profiling_notify(const char *name, bool contended, uint64_t wait_ticks);
+#endif
+
+#endif /* __VKD3D_LOCK_PROFILING_H */
@@ -41,4 +41,19 @@ bool vkd3d_get_env_var(const char *name, char *value, size_t value_size);
 
 bool vkd3d_get_program_name(char program_name[VKD3D_PATH_MAX]);
 
+/* Number of online logical CPUs, at least 1. */
+uint32_t vkd3d_get_cpu_count(void);
+
+enum vkd3d_thread_priority
+{
+    VKD3D_THREAD_PRIORITY_LOW,
+    VKD3D_THREAD_PRIORITY_NORMAL,
+    VKD3D_THREAD_PRIORITY_HIGH,
+};
+
+/* Both return false if the request could not be honored, e.g. due to missing privileges. */
+bool vkd3d_set_current_thread_priority(enum vkd3d_thread_priority priority);
+/* Bit N of the mask selects logical CPU N. */
+bool vkd3d_set_current_thread_affinity(uint64_t mask);
+
 #endif
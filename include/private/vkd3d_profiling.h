@@ -23,37 +23,45 @@
 #include "vkd3d_spinlock.h"
 #include "vkd3d_common.h"
 
-#ifdef VKD3D_ENABLE_PROFILING
-
+/* The profiling runtime is always built. Enabling it with VKD3D_PROFILE_PATH
+ * or VKD3D_TIMELINE_TRACE_PATH selects the profiled device and command list vtables
+ * at creation time, so a release build only pays for the vtable choice when it's off. */
 void vkd3d_init_profiling(void);
 bool vkd3d_uses_profiling(void);
 unsigned int vkd3d_profiling_register_region(const char *name, spinlock_t *lock, uint32_t *latch);
 void vkd3d_profiling_notify_work(unsigned int index, uint64_t start_ticks, uint64_t end_ticks, unsigned int iteration_count);
+void vkd3d_profiling_flush(void);
 
-#define VKD3D_REGION_DECL(name) \
+/* API regions are only reachable through the profiled vtables, so they are always compiled in. */
+#define VKD3D_API_REGION_DECL(name) \
     static uint32_t _vkd3d_region_latch_##name; \
     static spinlock_t _vkd3d_region_lock_##name; \
     uint64_t _vkd3d_region_begin_tick_##name; \
     uint64_t _vkd3d_region_end_tick_##name; \
     unsigned int _vkd3d_region_index_##name
 
-#define VKD3D_REGION_BEGIN(name) \
+#define VKD3D_API_REGION_BEGIN(name) \
     do { \
         if (!(_vkd3d_region_index_##name = vkd3d_atomic_uint32_load_explicit(&_vkd3d_region_latch_##name, vkd3d_memory_order_acquire))) \
             _vkd3d_region_index_##name = vkd3d_profiling_register_region(#name, &_vkd3d_region_lock_##name, &_vkd3d_region_latch_##name); \
         _vkd3d_region_begin_tick_##name = vkd3d_get_current_time_ticks(); \
     } while(0)
 
-#define VKD3D_REGION_END_ITERATIONS(name, iter) \
+#define VKD3D_API_REGION_END_ITERATIONS(name, iter) \
     do { \
         _vkd3d_region_end_tick_##name = vkd3d_get_current_time_ticks(); \
         vkd3d_profiling_notify_work(_vkd3d_region_index_##name, _vkd3d_region_begin_tick_##name, _vkd3d_region_end_tick_##name, iter); \
     } while(0)
 
+#define VKD3D_API_REGION_END(name) VKD3D_API_REGION_END_ITERATIONS(name, 1)
+
+/* Regions inside internal hot paths cost time even when profiling is off,
+ * so they still require -Denable_profiling=true. */
+#ifdef VKD3D_ENABLE_PROFILING
+#define VKD3D_REGION_DECL(name) VKD3D_API_REGION_DECL(name)
+#define VKD3D_REGION_BEGIN(name) VKD3D_API_REGION_BEGIN(name)
+#define VKD3D_REGION_END_ITERATIONS(name, iter) VKD3D_API_REGION_END_ITERATIONS(name, iter)
 #else
-static inline void vkd3d_init_profiling(void)
-{
-}
 #define VKD3D_REGION_DECL(name) ((void)0)
 #define VKD3D_REGION_BEGIN(name) ((void)0)
 #define VKD3D_REGION_END_ITERATIONS(name, iter) ((void)0)
@@ -56,4 +56,40 @@ static inline void rw_spinlock_release_write(spinlock_t *spinlock)
     vkd3d_atomic_uint32_and(spinlock, ~VKD3D_RW_SPINLOCK_WRITE, vkd3d_memory_order_release);
 }
 
+#ifdef VKD3D_ENABLE_LOCK_PROFILING
+static inline void vkd3d_lock_profiled_rw_spinlock_acquire_read(spinlock_t *spinlock, const char *name)
+{
+    uint64_t start_ticks = vkd3d_lock_profiling_get_ticks();
+    uint32_t count = vkd3d_atomic_uint32_add(spinlock, VKD3D_RW_SPINLOCK_READ, vkd3d_memory_order_acquire);
+    bool contended = !!(count & VKD3D_RW_SPINLOCK_WRITE);
+
+    while (count & VKD3D_RW_SPINLOCK_WRITE)
+    {
+        vkd3d_pause();
+        count = vkd3d_atomic_uint32_load_explicit(spinlock, vkd3d_memory_order_acquire);
+    }
+
+    vkd3d_lock_profiling_notify(name, contended, contended ? vkd3d_lock_profiling_get_ticks() - start_ticks : 0);
+}
+
+static inline void vkd3d_lock_profiled_rw_spinlock_acquire_write(spinlock_t *spinlock, const char *name)
+{
+    uint64_t start_ticks;
+
+    if (vkd3d_atomic_uint32_compare_exchange(spinlock, VKD3D_RW_SPINLOCK_IDLE, VKD3D_RW_SPINLOCK_WRITE,
+            vkd3d_memory_order_acquire, vkd3d_memory_order_relaxed) == VKD3D_RW_SPINLOCK_IDLE)
+    {
+        vkd3d_lock_profiling_notify(name, false, 0);
+        return;
+    }
+
+    start_ticks = vkd3d_lock_profiling_get_ticks();
+    rw_spinlock_acquire_write(spinlock);
+    vkd3d_lock_profiling_notify(name, true, vkd3d_lock_profiling_get_ticks() - start_ticks);
+}
+
+#define rw_spinlock_acquire_read(lock) vkd3d_lock_profiled_rw_spinlock_acquire_read(lock, #lock)
+#define rw_spinlock_acquire_write(lock) vkd3d_lock_profiled_rw_spinlock_acquire_write(lock, #lock)
+#endif
+
 #endif
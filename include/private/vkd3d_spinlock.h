@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "vkd3d_atomic.h"
+#include "vkd3d_lock_profiling.h"
 
 #ifdef __SSE2__
 #include <emmintrin.h>
@@ -64,4 +65,23 @@ static inline void spinlock_release(spinlock_t *lock)
     vkd3d_spinlock_unlock(lock);
 }
 
+#ifdef VKD3D_ENABLE_LOCK_PROFILING
+static inline void vkd3d_lock_profiled_spinlock_acquire(spinlock_t *lock, const char *name)
+{
+    uint64_t start_ticks;
+
+    if (spinlock_try_acquire(lock))
+    {
+        vkd3d_lock_profiling_notify(name, false, 0);
+        return;
+    }
+
+    start_ticks = vkd3d_lock_profiling_get_ticks();
+    spinlock_acquire(lock);
+    vkd3d_lock_profiling_notify(name, true, vkd3d_lock_profiling_get_ticks() - start_ticks);
+}
+
+#define spinlock_acquire(lock) vkd3d_lock_profiled_spinlock_acquire(lock, #lock)
+#endif
+
 #endif
@@ -20,11 +20,13 @@
 #define __VKD3D_THREADS_H
 
 #include "vkd3d_memory.h"
+#include "vkd3d_lock_profiling.h"
 
 #if defined(_WIN32)
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <errno.h>
 #include "vkd3d_string.h"
 
 /* pthread_t is passed by value in some functions,
@@ -147,6 +149,11 @@ static inline int pthread_mutex_lock(pthread_mutex_t *lock)
     return 0;
 }
 
+static inline int pthread_mutex_trylock(pthread_mutex_t *lock)
+{
+    return TryAcquireSRWLockExclusive(&lock->lock) ? 0 : EBUSY;
+}
+
 static inline int pthread_mutex_unlock(pthread_mutex_t *lock)
 {
     ReleaseSRWLockExclusive(&lock->lock);
@@ -409,4 +416,89 @@ static inline unsigned int vkd3d_get_current_thread_id(void)
 #endif
 }
 
+/* Futex-style wait on a 32-bit address. vkd3d_futex_wait() blocks while *addr == value,
+ * and may return spuriously, so callers must always re-check their condition. */
+#if defined(_WIN32)
+typedef BOOL (WINAPI *PFN_WaitOnAddress)(volatile VOID *, PVOID, SIZE_T, DWORD);
+typedef VOID (WINAPI *PFN_WakeByAddressSingle)(PVOID);
+
+static inline HMODULE vkd3d_futex_get_module(void)
+{
+    return GetModuleHandleA("kernelbase.dll");
+}
+
+static inline void vkd3d_futex_wait(uint32_t *addr, uint32_t value)
+{
+    static PFN_WaitOnAddress wait_on_address;
+    HMODULE module;
+
+    if (!wait_on_address && (module = vkd3d_futex_get_module()))
+        wait_on_address = (void*)GetProcAddress(module, "WaitOnAddress");
+
+    if (wait_on_address)
+        wait_on_address(addr, &value, sizeof(value), INFINITE);
+    else
+        Sleep(1);
+}
+
+static inline void vkd3d_futex_wake_one(uint32_t *addr)
+{
+    static PFN_WakeByAddressSingle wake_by_address_single;
+    HMODULE module;
+
+    if (!wake_by_address_single && (module = vkd3d_futex_get_module()))
+        wake_by_address_single = (void*)GetProcAddress(module, "WakeByAddressSingle");
+
+    if (wake_by_address_single)
+        wake_by_address_single(addr);
+}
+#elif defined(__linux__)
+#include <linux/futex.h>
+
+static inline void vkd3d_futex_wait(uint32_t *addr, uint32_t value)
+{
+    syscall(__NR_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static inline void vkd3d_futex_wake_one(uint32_t *addr)
+{
+    syscall(__NR_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+#else
+#include <sched.h>
+
+static inline void vkd3d_futex_wait(uint32_t *addr, uint32_t value)
+{
+    (void)addr;
+    (void)value;
+    sched_yield();
+}
+
+static inline void vkd3d_futex_wake_one(uint32_t *addr)
+{
+    (void)addr;
+}
+#endif
+
+#ifdef VKD3D_ENABLE_LOCK_PROFILING
+static inline int vkd3d_lock_profiled_mutex_lock(pthread_mutex_t *lock, const char *name)
+{
+    uint64_t start_ticks;
+    int rc;
+
+    if (!pthread_mutex_trylock(lock))
+    {
+        vkd3d_lock_profiling_notify(name, false, 0);
+        return 0;
+    }
+
+    start_ticks = vkd3d_lock_profiling_get_ticks();
+    rc = pthread_mutex_lock(lock);
+    vkd3d_lock_profiling_notify(name, true, vkd3d_lock_profiling_get_ticks() - start_ticks);
+    return rc;
+}
+
+#define pthread_mutex_lock(lock) vkd3d_lock_profiled_mutex_lock(lock, #lock)
+#endif
+
 #endif /* __VKD3D_THREADS_H */
@@ -24,5 +24,8 @@
 /* max_elements is 0 if only nul-terminator should be used.
  * Otherwise, terminate the string after either a nul-termination byte or max_elements. */
 char *vkd3d_strdup_w_utf8(const WCHAR *wstr, size_t max_elements);
+/* Same as vkd3d_strdup_w_utf8, but converts into buffer if the result fits.
+ * The result must only be freed if it is not buffer. */
+char *vkd3d_strdup_w_utf8_buffer(const WCHAR *wstr, size_t max_elements, char *buffer, size_t buffer_size);
 
 #endif /* __VKD3D_UTF8_H */
@@ -93,6 +93,27 @@ extern "C" {
 #define VKD3D_CONFIG_FLAG_FORCE_COMPUTE_ROOT_PARAMETERS_PUSH_UBO (1ull << 38)
 #define VKD3D_CONFIG_FLAG_SKIP_DRIVER_WORKAROUNDS (1ull << 39)
 #define VKD3D_CONFIG_FLAG_CURB_MEMORY_PSO_CACHE (1ull << 40)
+#define VKD3D_CONFIG_FLAG_FENCE_WORKER_WAIT_ANY (1ull << 41)
+#define VKD3D_CONFIG_FLAG_PIPELINE_ASYNC_COMPILE (1ull << 42)
+#define VKD3D_CONFIG_FLAG_PIPELINE_PARALLEL_COMPILE (1ull << 43)
+#define VKD3D_CONFIG_FLAG_RESIDENCY_DEMOTION (1ull << 44)
+#define VKD3D_CONFIG_FLAG_MEMORY_ALLOCATOR_PACK (1ull << 45)
+#define VKD3D_CONFIG_FLAG_RECYCLE_COMMITTED_RESOURCES (1ull << 46)
+#define VKD3D_CONFIG_FLAG_DESCRIPTOR_COPY_DEDUP (1ull << 47)
+#define VKD3D_CONFIG_FLAG_EXECUTE_INDIRECT_CACHE (1ull << 48)
+#define VKD3D_CONFIG_FLAG_SPECIALIZE_ROOT_CONSTANTS (1ull << 49)
+#define VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_WARM_UP (1ull << 50)
+#define VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_COMPRESS (1ull << 51)
+#define VKD3D_CONFIG_FLAG_PIPELINE_TELEMETRY (1ull << 52)
+#define VKD3D_CONFIG_FLAG_LOW_LATENCY (1ull << 53)
+#define VKD3D_CONFIG_FLAG_SWAPCHAIN_ASYNC_COMPUTE (1ull << 54)
+#define VKD3D_CONFIG_FLAG_QUEUE_WATCHDOG (1ull << 55)
+#define VKD3D_CONFIG_FLAG_META_TIMING (1ull << 56)
+#define VKD3D_CONFIG_FLAG_COMMAND_LIST_STATS (1ull << 57)
+#define VKD3D_CONFIG_FLAG_DEFERRED_RESOURCE_DESTROY (1ull << 58)
+#define VKD3D_CONFIG_FLAG_DEFAULT_BUFFER_HVV (1ull << 59)
+#define VKD3D_CONFIG_FLAG_THREAD_PRIORITY (1ull << 60)
+#define VKD3D_CONFIG_FLAG_DEFERRED_MEMORY_BIND (1ull << 61)
 
 struct vkd3d_instance;
 
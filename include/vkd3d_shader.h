@@ -72,6 +72,7 @@ enum vkd3d_shader_meta_flags
     VKD3D_SHADER_META_FLAG_USES_FRAGMENT_BARYCENTRIC = 1 << 11,
     VKD3D_SHADER_META_FLAG_USES_SAMPLE_RATE_SHADING = 1 << 12,
     VKD3D_SHADER_META_FLAG_USES_RASTERIZER_ORDERED_VIEWS = 1 << 13,
+    VKD3D_SHADER_META_FLAG_USES_ROOT_CONSTANTS = 1 << 14,
 };
 
 struct vkd3d_shader_meta
@@ -101,6 +102,9 @@ void vkd3d_shader_extract_feature_meta(struct vkd3d_shader_code *code);
 
 vkd3d_shader_hash_t vkd3d_shader_hash(const struct vkd3d_shader_code *shader);
 
+/* Computes the checksum stored in the DXBC container header. */
+void vkd3d_compute_dxbc_checksum(const void *dxbc, size_t size, uint32_t checksum[4]);
+
 enum vkd3d_shader_descriptor_type
 {
     VKD3D_SHADER_DESCRIPTOR_TYPE_UNKNOWN,
@@ -417,6 +421,7 @@ struct vkd3d_shader_quirk_hash
 
 struct vkd3d_shader_quirk_info
 {
+    /* Must be sorted by shader_hash, lookups use a binary search. */
     const struct vkd3d_shader_quirk_hash *hashes;
     unsigned int num_hashes;
     uint32_t default_quirks;
@@ -426,6 +431,15 @@ struct vkd3d_shader_quirk_info
     uint32_t global_quirks;
 };
 
+/* Replaces loads of a root constant dword with an immediate.
+ * offset is the byte offset of the dword in the push constant block,
+ * as described by vkd3d_shader_push_constant_buffer::offset. */
+struct vkd3d_shader_root_constant_specialization
+{
+    unsigned int offset;
+    uint32_t value;
+};
+
 struct vkd3d_shader_compile_arguments
 {
     enum vkd3d_shader_target target;
@@ -444,6 +458,10 @@ struct vkd3d_shader_compile_arguments
     uint32_t max_subgroup_size;
     bool promote_wave_size_heuristics;
 
+    /* Only honoured for DXBC shaders. */
+    unsigned int root_constant_specialization_count;
+    const struct vkd3d_shader_root_constant_specialization *root_constant_specializations;
+
     const struct vkd3d_shader_quirk_info *quirks;
 };
 
@@ -944,6 +962,44 @@ int vkd3d_shader_compile_dxil_export(const struct vkd3d_shader_code *dxil,
         const struct vkd3d_shader_interface_local_info *shader_interface_local_info,
         const struct vkd3d_shader_compile_arguments *compiler_args);
 
+/* A parsed DXIL library which can compile any number of exports without reparsing the module.
+ * A library handle must be created, used and destroyed on the same thread.
+ * To compile exports in parallel, create one handle per compile thread. */
+struct vkd3d_shader_dxil_library;
+
+int vkd3d_shader_dxil_library_create(const struct vkd3d_shader_code *dxil,
+        struct vkd3d_shader_dxil_library **library);
+void vkd3d_shader_dxil_library_destroy(struct vkd3d_shader_dxil_library *library);
+int vkd3d_shader_compile_dxil_library_export(struct vkd3d_shader_dxil_library *library,
+        const char *export, const char *demangled_export,
+        struct vkd3d_shader_code *spirv,
+        struct vkd3d_shader_code_debug *spirv_debug,
+        const struct vkd3d_shader_interface_info *shader_interface_info,
+        const struct vkd3d_shader_interface_local_info *shader_interface_local_info,
+        const struct vkd3d_shader_compile_arguments *compiler_args);
+
+/* Optional compile cache for embedders which compile the same inputs repeatedly.
+ * Results are keyed on the shader hash, compiler options, shader interface and compile arguments.
+ * A cache object may be used from multiple threads concurrently. */
+struct vkd3d_shader_cache;
+
+struct vkd3d_shader_cache_info
+{
+    /* Upper bound for the in-memory LRU. 0 selects a default. */
+    size_t max_memory_size;
+    /* Optional. If set, compiled modules are also persisted in this existing directory. */
+    const char *disk_directory;
+};
+
+int vkd3d_shader_cache_create(const struct vkd3d_shader_cache_info *info, struct vkd3d_shader_cache **cache);
+void vkd3d_shader_cache_destroy(struct vkd3d_shader_cache *cache);
+/* Same as vkd3d_shader_compile_dxbc(), which also handles DXIL. cache may be NULL. */
+int vkd3d_shader_cache_compile_dxbc(struct vkd3d_shader_cache *cache,
+        const struct vkd3d_shader_code *dxbc, struct vkd3d_shader_code *spirv,
+        unsigned int compiler_options,
+        const struct vkd3d_shader_interface_info *shader_interface_info,
+        const struct vkd3d_shader_compile_arguments *compile_args);
+
 uint32_t vkd3d_shader_compile_arguments_select_quirks(
         const struct vkd3d_shader_compile_arguments *args, vkd3d_shader_hash_t hash);
 
@@ -61,5 +61,60 @@ typedef struct D3D12_UAV_INFO
     UINT64 gpuVASize;  
 } D3D12_UAV_INFO;
 
+/* Bytes currently held by vkd3d-proton's own data structures, per category. */
+typedef struct D3D12_MEMORY_FOOTPRINT
+{
+    UINT64 descriptorHeapBytes;
+    UINT64 memoryChunkSlackBytes;
+    UINT64 scratchPoolBytes;
+    UINT64 queryPoolBytes;
+    UINT64 pipelineSpirvBytes;
+    UINT64 pipelineLibraryBytes;
+    UINT64 viewMapBytes;
+} D3D12_MEMORY_FOOTPRINT;
+
+/* Work recorded into a command list since it was last reset. */
+typedef struct D3D12_COMMAND_LIST_STATISTICS
+{
+    UINT32 drawCount;
+    UINT32 dispatchCount;
+    UINT32 renderPassBeginCount;
+    UINT32 renderPassSuspendCount;
+    UINT32 renderPassEndCount;
+    UINT32 barrierBatchCount;
+    UINT32 descriptorBufferBindCount;
+    UINT32 dynamicStateEmitCount;
+    UINT32 metaOperationCount;
+    UINT32 queryResolveFlushCount;
+} D3D12_COMMAND_LIST_STATISTICS;
+
+typedef struct D3D12_FRAME_REPORT
+{
+    UINT64 frameID;
+    UINT64 inputSampleTime;
+    UINT64 simStartTime;
+    UINT64 simEndTime;
+    UINT64 renderSubmitStartTime;
+    UINT64 renderSubmitEndTime;
+    UINT64 presentStartTime;
+    UINT64 presentEndTime;
+    UINT64 driverStartTime;
+    UINT64 driverEndTime;
+    UINT64 osRenderQueueStartTime;
+    UINT64 osRenderQueueEndTime;
+    UINT64 gpuRenderStartTime;
+    UINT64 gpuRenderEndTime;
+    UINT32 gpuActiveRenderTimeUs;
+    UINT32 gpuFrameTimeUs;
+    UINT8 rsvd[120];
+} D3D12_FRAME_REPORT;
+
+typedef struct D3D12_LATENCY_RESULTS
+{
+    UINT32 version;
+    D3D12_FRAME_REPORT frame_reports[64];
+    UINT8 rsvd[32];
+} D3D12_LATENCY_RESULTS;
+
 #endif  // __VKD3D_VK_INCLUDES_H
 
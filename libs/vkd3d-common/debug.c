@@ -79,10 +79,159 @@ struct vkd3d_string_stream
 };
 static struct vkd3d_string_stream vkd3d_dbg_buffer;
 
+/* With VKD3D_LOG_ASYNC, messages are formatted straight into a bounded ring which
+ * a background thread drains to the log file. Emitting threads never block on I/O
+ * or on each other, a full ring drops messages instead and the drops are reported. */
+#define VKD3D_DEBUG_ASYNC_SLOT_SIZE 1024
+#define VKD3D_DEBUG_ASYNC_DEFAULT_SLOT_COUNT 4096
+#define VKD3D_DEBUG_ASYNC_MAX_SLOT_COUNT 65536
+#define VKD3D_DEBUG_ASYNC_POLL_INTERVAL_NS 1000000ull
+
+struct vkd3d_dbg_async_slot
+{
+    /* Equal to the ring position when free, position + 1 once a message is written. */
+    uint32_t sequence;
+    uint32_t size;
+    char data[VKD3D_DEBUG_ASYNC_SLOT_SIZE];
+};
+
+struct vkd3d_dbg_async_ring
+{
+    struct vkd3d_dbg_async_slot *slots;
+    uint32_t mask;
+    uint32_t enqueue_pos;
+    uint32_t dequeue_pos;
+    uint32_t drop_count;
+    pthread_t thread;
+};
+static struct vkd3d_dbg_async_ring vkd3d_dbg_async;
+
+static void *vkd3d_dbg_async_thread_main(void *userdata)
+{
+    struct vkd3d_dbg_async_ring *ring = userdata;
+    struct vkd3d_dbg_async_slot *slot;
+    uint32_t sequence, drop_count;
+    bool pending_flush = false;
+    uint32_t pos;
+
+    vkd3d_set_thread_name("vkd3d_log");
+
+    for (;;)
+    {
+        pos = ring->dequeue_pos;
+        slot = &ring->slots[pos & ring->mask];
+        sequence = vkd3d_atomic_uint32_load_explicit(&slot->sequence, vkd3d_memory_order_acquire);
+
+        if (sequence == pos + 1)
+        {
+            fwrite(slot->data, 1, slot->size, vkd3d_log_file);
+            /* Hand the slot back to producers for the next lap around the ring. */
+            vkd3d_atomic_uint32_store_explicit(&slot->sequence, pos + ring->mask + 1, vkd3d_memory_order_release);
+            ring->dequeue_pos = pos + 1;
+            pending_flush = true;
+            continue;
+        }
+
+        if ((drop_count = vkd3d_atomic_uint32_exchange_explicit(&ring->drop_count, 0, vkd3d_memory_order_relaxed)))
+        {
+            fprintf(vkd3d_log_file, "vkd3d-proton: Log ring overflowed, dropped %u messages.\n", drop_count);
+            pending_flush = true;
+        }
+
+        if (pending_flush)
+        {
+            fflush(vkd3d_log_file);
+            pending_flush = false;
+        }
+
+        vkd3d_sleep_until_ns(vkd3d_get_current_time_ns() + VKD3D_DEBUG_ASYNC_POLL_INTERVAL_NS);
+    }
+
+    return NULL;
+}
+
+static bool vkd3d_dbg_async_init(struct vkd3d_dbg_async_ring *ring, uint32_t slot_count)
+{
+    uint32_t i;
+
+    if (!slot_count)
+        slot_count = VKD3D_DEBUG_ASYNC_DEFAULT_SLOT_COUNT;
+    slot_count = min(slot_count, VKD3D_DEBUG_ASYNC_MAX_SLOT_COUNT);
+    /* Round up to a power of two so that positions can wrap around freely. */
+    slot_count = 1u << vkd3d_log2i_ceil(slot_count);
+
+    if (!(ring->slots = malloc(slot_count * sizeof(*ring->slots))))
+        return false;
+
+    for (i = 0; i < slot_count; i++)
+        ring->slots[i].sequence = i;
+
+    ring->mask = slot_count - 1;
+
+    if (pthread_create(&ring->thread, NULL, vkd3d_dbg_async_thread_main, ring))
+    {
+        free(ring->slots);
+        ring->slots = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static void vkd3d_dbg_async_vprintf(struct vkd3d_dbg_async_ring *ring, unsigned int tid,
+        enum vkd3d_dbg_level level, const char *function, const char *fmt, va_list args)
+{
+    struct vkd3d_dbg_async_slot *slot;
+    uint32_t pos, prev_pos, sequence;
+    int prefix_count, count;
+
+    pos = vkd3d_atomic_uint32_load_explicit(&ring->enqueue_pos, vkd3d_memory_order_relaxed);
+
+    /* Claim a slot before formatting anything, so a full ring costs almost nothing. */
+    for (;;)
+    {
+        slot = &ring->slots[pos & ring->mask];
+        sequence = vkd3d_atomic_uint32_load_explicit(&slot->sequence, vkd3d_memory_order_acquire);
+
+        if (sequence == pos)
+        {
+            prev_pos = vkd3d_atomic_uint32_compare_exchange(&ring->enqueue_pos, pos, pos + 1,
+                    vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed);
+            if (prev_pos == pos)
+                break;
+            pos = prev_pos;
+        }
+        else if ((int32_t)(sequence - pos) < 0)
+        {
+            vkd3d_atomic_uint32_increment(&ring->drop_count, vkd3d_memory_order_relaxed);
+            return;
+        }
+        else
+            pos = vkd3d_atomic_uint32_load_explicit(&ring->enqueue_pos, vkd3d_memory_order_relaxed);
+    }
+
+    prefix_count = snprintf(slot->data, sizeof(slot->data), "%04x:%s:%s: ", tid, debug_level_names[level], function);
+    prefix_count = max(0, min(prefix_count, (int)sizeof(slot->data) - 1));
+    count = vsnprintf(slot->data + prefix_count, sizeof(slot->data) - prefix_count, fmt, args);
+    count = max(0, count) + prefix_count;
+
+    if (count >= (int)sizeof(slot->data))
+    {
+        /* Truncated, keep the line structure intact. */
+        count = sizeof(slot->data) - 1;
+        slot->data[count - 1] = '\n';
+    }
+
+    slot->size = count;
+    vkd3d_atomic_uint32_store_explicit(&slot->sequence, pos + 1, vkd3d_memory_order_release);
+}
+
 static void vkd3d_dbg_init_once(void)
 {
     char vkd3d_debug[VKD3D_PATH_MAX];
+    uint32_t async_slot_count = 0;
     unsigned int channel, i;
+    bool use_async = false;
 
     for (channel = 0; channel < VKD3D_DBG_CHANNEL_COUNT; channel++)
     {
@@ -98,7 +247,12 @@ static void vkd3d_dbg_init_once(void)
             vkd3d_dbg_level[channel] = VKD3D_DBG_LEVEL_FIXME;
     }
 
-    if (vkd3d_get_env_var("VKD3D_LOG_BUFFERED", vkd3d_debug, sizeof(vkd3d_debug)))
+    if (vkd3d_get_env_var("VKD3D_LOG_ASYNC", vkd3d_debug, sizeof(vkd3d_debug)))
+    {
+        async_slot_count = strtoul(vkd3d_debug, NULL, 0);
+        use_async = true;
+    }
+    else if (vkd3d_get_env_var("VKD3D_LOG_BUFFERED", vkd3d_debug, sizeof(vkd3d_debug)))
     {
         vkd3d_dbg_buffer.offset = 0;
         vkd3d_dbg_buffer.size = strtoul(vkd3d_debug, NULL, 0);
@@ -111,12 +265,17 @@ static void vkd3d_dbg_init_once(void)
     if (!vkd3d_disable_file && vkd3d_get_env_var("VKD3D_LOG_FILE", vkd3d_debug, sizeof(vkd3d_debug)))
     {
         /* Avoid extra formatting overhead when using buffered. */
-        vkd3d_log_file = fopen(vkd3d_debug, vkd3d_dbg_buffer.buffer ? "wb" : "w");
+        vkd3d_log_file = fopen(vkd3d_debug, vkd3d_dbg_buffer.buffer || use_async ? "wb" : "w");
         if (!vkd3d_log_file)
         {
             fprintf(stderr, "Failed to open log file: %s!\n", vkd3d_debug);
             fflush(stderr);
         }
+        else if (use_async && !vkd3d_dbg_async_init(&vkd3d_dbg_async, async_slot_count))
+        {
+            fprintf(stderr, "Failed to initialize VKD3D_LOG_ASYNC, logging synchronously.\n");
+            fflush(stderr);
+        }
     }
     else
     {
@@ -162,7 +321,11 @@ void vkd3d_dbg_printf(enum vkd3d_dbg_channel channel, enum vkd3d_dbg_level level
     va_start(args, fmt);
     tid = vkd3d_get_current_thread_id();
 
-    if (vkd3d_dbg_buffer.buffer)
+    if (vkd3d_dbg_async.slots)
+    {
+        vkd3d_dbg_async_vprintf(&vkd3d_dbg_async, tid, level, function, fmt, args);
+    }
+    else if (vkd3d_dbg_buffer.buffer)
     {
         char prefix_buffer[256];
         int prefix_buffer_count;
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#include "vkd3d_job_pool.h"
+#include "vkd3d_platform.h"
+#include "vkd3d_debug.h"
+#include <stdlib.h>
+
+/* Lets enqueue find the deque of the calling worker. */
+static VKD3D_THREAD_LOCAL struct vkd3d_job_queue *current_job_queue;
+
+static void vkd3d_job_pool_run(struct vkd3d_job_pool *pool, struct vkd3d_job *job)
+{
+    void (*release)(void *userdata) = job->release;
+    void *userdata = job->userdata;
+
+    job->callback(userdata);
+
+    /* The job may be freed as soon as waiters observe completion, so don't touch it after this. */
+    pthread_mutex_lock(&pool->lock);
+    vkd3d_atomic_uint32_store_explicit(&job->status, VKD3D_JOB_STATUS_NONE, vkd3d_memory_order_release);
+    pthread_cond_broadcast(&pool->done_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    if (release)
+        release(userdata);
+}
+
+static struct vkd3d_job *vkd3d_job_queue_pop(struct vkd3d_job_pool *pool, struct vkd3d_job_queue *queue, bool lifo)
+{
+    struct vkd3d_job *job = NULL;
+    struct list *entry;
+
+    /* Cheap unlocked peek, a stale answer only costs one extra iteration. */
+    if (list_empty(&queue->jobs))
+        return NULL;
+
+    spinlock_acquire(&queue->lock);
+    if ((entry = lifo ? list_tail(&queue->jobs) : list_head(&queue->jobs)))
+    {
+        job = LIST_ENTRY(entry, struct vkd3d_job, entry);
+        list_remove(&job->entry);
+        vkd3d_atomic_uint32_store_explicit(&job->status, VKD3D_JOB_STATUS_RUNNING, vkd3d_memory_order_relaxed);
+    }
+    spinlock_release(&queue->lock);
+
+    if (job)
+        vkd3d_atomic_uint32_decrement(&pool->pending_count, vkd3d_memory_order_relaxed);
+    return job;
+}
+
+static struct vkd3d_job *vkd3d_job_pool_pop(struct vkd3d_job_pool *pool, uint32_t index)
+{
+    struct vkd3d_job *job;
+    uint32_t i;
+
+    if ((job = vkd3d_job_queue_pop(pool, &pool->queues[index], true)))
+        return job;
+
+    for (i = 1; i < pool->thread_count; i++)
+        if ((job = vkd3d_job_queue_pop(pool, &pool->queues[(index + i) % pool->thread_count], false)))
+            return job;
+
+    return NULL;
+}
+
+static void *vkd3d_job_pool_main(void *userdata)
+{
+    struct vkd3d_job_queue *queue = userdata;
+    struct vkd3d_job_pool *pool = queue->pool;
+    uint32_t index = queue - pool->queues;
+    struct vkd3d_job *job;
+    bool should_exit;
+
+    vkd3d_set_thread_name(pool->thread_name);
+    if (pool->thread_priority != VKD3D_THREAD_PRIORITY_NORMAL &&
+            !vkd3d_set_current_thread_priority(pool->thread_priority))
+        WARN("Failed to set worker thread priority.\n");
+    current_job_queue = queue;
+
+    for (;;)
+    {
+        if ((job = vkd3d_job_pool_pop(pool, index)))
+        {
+            vkd3d_job_pool_run(pool, job);
+            continue;
+        }
+
+        /* pending_count is incremented before the signal is sent under the lock,
+         * so checking it under the lock cannot miss a wakeup. */
+        pthread_mutex_lock(&pool->lock);
+        while (!vkd3d_atomic_uint32_load_explicit(&pool->pending_count, vkd3d_memory_order_acquire) &&
+                !pool->should_exit)
+            pthread_cond_wait(&pool->cond, &pool->lock);
+
+        /* Pending jobs are drained before we exit. */
+        should_exit = pool->should_exit &&
+                !vkd3d_atomic_uint32_load_explicit(&pool->pending_count, vkd3d_memory_order_acquire);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (should_exit)
+            break;
+    }
+
+    current_job_queue = NULL;
+    return NULL;
+}
+
+void vkd3d_job_pool_enqueue(struct vkd3d_job_pool *pool, struct vkd3d_job *job)
+{
+    struct vkd3d_job_queue *queue;
+
+    if (current_job_queue && current_job_queue->pool == pool)
+        queue = current_job_queue;
+    else
+        queue = &pool->queues[vkd3d_atomic_uint32_increment(&pool->next_queue, vkd3d_memory_order_relaxed) % pool->thread_count];
+
+    job->queue_index = queue - pool->queues;
+
+    spinlock_acquire(&queue->lock);
+    job->status = VKD3D_JOB_STATUS_QUEUED;
+    list_add_tail(&queue->jobs, &job->entry);
+    spinlock_release(&queue->lock);
+
+    vkd3d_atomic_uint32_increment(&pool->pending_count, vkd3d_memory_order_release);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void vkd3d_job_pool_wait(struct vkd3d_job_pool *pool, struct vkd3d_job *job)
+{
+    struct vkd3d_job_queue *queue;
+    bool run_inline = false;
+
+    if (!vkd3d_job_is_pending(job))
+        return;
+
+    /* If no worker has picked up the job yet, run it on this thread rather than
+     * waiting behind unrelated work. This also guarantees forward progress
+     * when a worker waits on jobs it enqueued itself. */
+    queue = &pool->queues[job->queue_index];
+    spinlock_acquire(&queue->lock);
+    if (job->status == VKD3D_JOB_STATUS_QUEUED)
+    {
+        list_remove(&job->entry);
+        job->status = VKD3D_JOB_STATUS_RUNNING;
+        run_inline = true;
+    }
+    spinlock_release(&queue->lock);
+
+    if (run_inline)
+    {
+        vkd3d_atomic_uint32_decrement(&pool->pending_count, vkd3d_memory_order_relaxed);
+        vkd3d_job_pool_run(pool, job);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (job->status != VKD3D_JOB_STATUS_NONE)
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+uint32_t vkd3d_job_pool_get_default_thread_count(void)
+{
+    uint32_t thread_count;
+    char env[16];
+
+    if (vkd3d_get_env_var("VKD3D_WORKER_THREADS", env, sizeof(env)) && (thread_count = strtoul(env, NULL, 0)))
+        return min(thread_count, VKD3D_JOB_POOL_MAX_THREADS);
+
+    /* Leave one core for the application's render thread. */
+    thread_count = vkd3d_get_cpu_count();
+    return max(min(thread_count - 1, 8u), 1u);
+}
+
+int vkd3d_job_pool_init(struct vkd3d_job_pool *pool, uint32_t thread_count,
+        const char *thread_name, enum vkd3d_thread_priority thread_priority)
+{
+    uint32_t i;
+    int rc;
+
+    memset(pool, 0, sizeof(*pool));
+    pool->thread_name = thread_name;
+    pool->thread_priority = thread_priority;
+    thread_count = min(max(thread_count, 1u), VKD3D_JOB_POOL_MAX_THREADS);
+
+    for (i = 0; i < thread_count; i++)
+    {
+        spinlock_init(&pool->queues[i].lock);
+        list_init(&pool->queues[i].jobs);
+        pool->queues[i].pool = pool;
+    }
+
+    if ((rc = pthread_mutex_init(&pool->lock, NULL)))
+        return rc;
+
+    if ((rc = pthread_cond_init(&pool->cond, NULL)))
+        goto fail_cond;
+
+    if ((rc = pthread_cond_init(&pool->done_cond, NULL)))
+        goto fail_done_cond;
+
+    /* Enqueue picks deques modulo thread_count, so only publish workers which exist. */
+    for (i = 0; i < thread_count; i++)
+    {
+        if ((rc = pthread_create(&pool->threads[i], NULL, vkd3d_job_pool_main, &pool->queues[i])))
+        {
+            ERR("Failed to create worker thread, rc %d.\n", rc);
+            break;
+        }
+        pool->thread_count = i + 1;
+    }
+
+    if (!pool->thread_count)
+    {
+        pthread_cond_destroy(&pool->done_cond);
+        goto fail_done_cond;
+    }
+
+    return 0;
+
+fail_done_cond:
+    pthread_cond_destroy(&pool->cond);
+fail_cond:
+    pthread_mutex_destroy(&pool->lock);
+    return rc;
+}
+
+void vkd3d_job_pool_cleanup(struct vkd3d_job_pool *pool)
+{
+    uint32_t i;
+
+    if (!pool->thread_count)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->should_exit = true;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->thread_count; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    pool->thread_count = 0;
+}
@@ -196,3 +196,98 @@ bool vkd3d_get_env_var(const char *name, char *value, size_t value_size)
 }
 
 #endif
+
+#if defined(_WIN32)
+
+uint32_t vkd3d_get_cpu_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+}
+
+#elif defined(__linux__)
+
+#include <unistd.h>
+
+uint32_t vkd3d_get_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
+}
+
+#else
+
+uint32_t vkd3d_get_cpu_count(void)
+{
+    return 1;
+}
+
+#endif
+
+#if defined(_WIN32)
+
+bool vkd3d_set_current_thread_priority(enum vkd3d_thread_priority priority)
+{
+    static const int priorities[] =
+    {
+        [VKD3D_THREAD_PRIORITY_LOW] = THREAD_PRIORITY_BELOW_NORMAL,
+        [VKD3D_THREAD_PRIORITY_NORMAL] = THREAD_PRIORITY_NORMAL,
+        [VKD3D_THREAD_PRIORITY_HIGH] = THREAD_PRIORITY_ABOVE_NORMAL,
+    };
+
+    return SetThreadPriority(GetCurrentThread(), priorities[priority]);
+}
+
+bool vkd3d_set_current_thread_affinity(uint64_t mask)
+{
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)mask) != 0;
+}
+
+#elif defined(__linux__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+bool vkd3d_set_current_thread_priority(enum vkd3d_thread_priority priority)
+{
+    static const int nice_values[] =
+    {
+        [VKD3D_THREAD_PRIORITY_LOW] = 5,
+        [VKD3D_THREAD_PRIORITY_NORMAL] = 0,
+        [VKD3D_THREAD_PRIORITY_HIGH] = -5,
+    };
+
+    /* On Linux, the nice value is per thread when addressed by TID.
+     * Raising priority requires CAP_SYS_NICE or a suitable RLIMIT_NICE. */
+    return setpriority(PRIO_PROCESS, syscall(SYS_gettid), nice_values[priority]) == 0;
+}
+
+bool vkd3d_set_current_thread_affinity(uint64_t mask)
+{
+    cpu_set_t set;
+    unsigned int i;
+
+    CPU_ZERO(&set);
+    for (i = 0; i < 64; i++)
+        if (mask & (1ull << i))
+            CPU_SET(i, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#else
+
+bool vkd3d_set_current_thread_priority(enum vkd3d_thread_priority priority)
+{
+    return false;
+}
+
+bool vkd3d_set_current_thread_affinity(uint64_t mask)
+{
+    return false;
+}
+
+#endif
@@ -16,8 +16,6 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
  */
 
-#ifdef VKD3D_ENABLE_PROFILING
-
 #define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
 
 #include "vkd3d_profiling.h"
@@ -28,6 +26,12 @@
 #include <string.h>
 #include <stdio.h>
 
+/* The profiler's own locks must not report into the profiler. */
+#ifdef VKD3D_ENABLE_LOCK_PROFILING
+#undef pthread_mutex_lock
+#undef spinlock_acquire
+#endif
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -42,17 +46,39 @@ static pthread_once_t profiling_block_once = PTHREAD_ONCE_INIT;
 static unsigned int profiling_region_count;
 static spinlock_t profiling_lock;
 
+/* Log-linear buckets, 4 sub-buckets per power of two, which bounds the relative
+ * error of a percentile to 25%. Bucket 127 catches everything above 2^33 ticks. */
+#define VKD3D_PROFILING_HISTOGRAM_SUB_BUCKETS_LOG2 2
+#define VKD3D_PROFILING_HISTOGRAM_BUCKETS 128
+
+/* Blocks are a whole number of cache lines and the mapping is page aligned,
+ * so threads hammering different regions never share a line.
+ * The first 64 bytes keep the original layout, vkd3d-profile.py deduces the
+ * block size from the file size to read either format. */
 struct vkd3d_profiling_block
 {
     uint64_t ticks_total;
     uint64_t iteration_total;
     char name[64 - 2 * sizeof(uint64_t)];
+    uint64_t ticks_max;
+    uint64_t contended_total;
+    uint64_t reserved[6];
+    uint64_t histogram[VKD3D_PROFILING_HISTOGRAM_BUCKETS];
 };
 
 static struct vkd3d_profiling_block *mapped_blocks;
 
 #define VKD3D_MAX_PROFILING_REGIONS 256
-static spinlock_t region_locks[VKD3D_MAX_PROFILING_REGIONS];
+
+/* Timeline events are streamed as Chrome trace JSON, which chrome://tracing
+ * and the Perfetto UI both load. The trailing "]" is optional in that format,
+ * so a capture of a process which never shuts down cleanly is still usable. */
+static FILE *timeline_file;
+static pthread_mutex_t timeline_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int timeline_pid;
+static uint64_t timeline_base_ns;
+static uint64_t timeline_base_ticks;
+static VKD3D_THREAD_LOCAL bool timeline_thread_named;
 
 #ifdef _WIN32
 static void vkd3d_init_profiling_path(const char *path)
@@ -123,6 +149,37 @@ static void vkd3d_init_profiling_path(const char *path)
 }
 #endif
 
+static void vkd3d_init_timeline_path(const char *path)
+{
+    char path_pid[VKD3D_PATH_MAX + 32];
+
+#ifdef _WIN32
+    timeline_pid = GetCurrentProcessId();
+#else
+    timeline_pid = getpid();
+#endif
+
+    snprintf(path_pid, sizeof(path_pid), "%s.%u.json", path, timeline_pid);
+    if (!(timeline_file = fopen(path_pid, "w")))
+    {
+        ERR("Failed to open timeline trace file %s.\n", path_pid);
+        return;
+    }
+
+    timeline_base_ns = vkd3d_get_current_time_ns();
+    timeline_base_ticks = vkd3d_get_current_time_ticks();
+    fputs("[\n", timeline_file);
+
+    /* Regions are only collected while the profiling blocks exist,
+     * so keep them in memory when the aggregate profile was not requested. */
+    if (!mapped_blocks && !(mapped_blocks = calloc(VKD3D_MAX_PROFILING_REGIONS, sizeof(*mapped_blocks))))
+    {
+        ERR("Failed to allocate profiling blocks.\n");
+        fclose(timeline_file);
+        timeline_file = NULL;
+    }
+}
+
 static void vkd3d_init_profiling_once(void)
 {
     char path[VKD3D_PATH_MAX];
@@ -130,6 +187,58 @@ static void vkd3d_init_profiling_once(void)
     vkd3d_get_env_var("VKD3D_PROFILE_PATH", path, sizeof(path));
     if (strlen(path) > 0)
         vkd3d_init_profiling_path(path);
+
+    vkd3d_get_env_var("VKD3D_TIMELINE_TRACE_PATH", path, sizeof(path));
+    if (strlen(path) > 0)
+        vkd3d_init_timeline_path(path);
+}
+
+static void vkd3d_timeline_trace_name_thread_locked(unsigned int tid)
+{
+#ifndef _WIN32
+    char name[16];
+
+    if (!pthread_getname_np(pthread_self(), name, sizeof(name)))
+    {
+        fprintf(timeline_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,"
+                "\"args\":{\"name\":\"%s\"}},\n", timeline_pid, tid, name);
+    }
+#endif
+    timeline_thread_named = true;
+}
+
+static void vkd3d_timeline_trace_region(const char *name, uint64_t start_ticks, uint64_t end_ticks)
+{
+    uint64_t now_ns, now_ticks, start_ns, end_ns;
+    unsigned int tid;
+    double ns_per_tick;
+
+    /* Ticks may come from the TSC, so map them to the monotonic clock with
+     * a rate which is refined over the lifetime of the process. */
+    now_ns = vkd3d_get_current_time_ns();
+    now_ticks = vkd3d_get_current_time_ticks();
+    ns_per_tick = now_ticks > timeline_base_ticks ?
+            (double)(now_ns - timeline_base_ns) / (double)(now_ticks - timeline_base_ticks) : 1.0;
+    start_ns = now_ns - (uint64_t)((double)(now_ticks - start_ticks) * ns_per_tick);
+    end_ns = now_ns - (uint64_t)((double)(now_ticks - end_ticks) * ns_per_tick);
+    tid = vkd3d_get_current_thread_id();
+
+    pthread_mutex_lock(&timeline_lock);
+    if (!timeline_thread_named)
+        vkd3d_timeline_trace_name_thread_locked(tid);
+    fprintf(timeline_file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+            name, timeline_pid, tid, 1e-3 * (double)(start_ns - timeline_base_ns), 1e-3 * (double)(end_ns - start_ns));
+    pthread_mutex_unlock(&timeline_lock);
+}
+
+void vkd3d_profiling_flush(void)
+{
+    if (!timeline_file)
+        return;
+
+    pthread_mutex_lock(&timeline_lock);
+    fflush(timeline_file);
+    pthread_mutex_unlock(&timeline_lock);
 }
 
 void vkd3d_init_profiling(void)
@@ -175,24 +284,177 @@ unsigned int vkd3d_profiling_register_region(const char *name, spinlock_t *lock,
     return index;
 }
 
+static unsigned int vkd3d_profiling_histogram_bucket(uint64_t ticks)
+{
+    const unsigned int sub_bucket_count = 1u << VKD3D_PROFILING_HISTOGRAM_SUB_BUCKETS_LOG2;
+    unsigned int msb, sub_bucket, bucket;
+
+    if (ticks < sub_bucket_count)
+        return ticks;
+
+    msb = (ticks >> 32) ? 32 + vkd3d_log2i(ticks >> 32) : vkd3d_log2i(ticks);
+    sub_bucket = (ticks >> (msb - VKD3D_PROFILING_HISTOGRAM_SUB_BUCKETS_LOG2)) & (sub_bucket_count - 1);
+    bucket = (msb - VKD3D_PROFILING_HISTOGRAM_SUB_BUCKETS_LOG2 + 1) * sub_bucket_count + sub_bucket;
+    return min(bucket, VKD3D_PROFILING_HISTOGRAM_BUCKETS - 1);
+}
+
+static void vkd3d_profiling_update_max(uint64_t *target, uint64_t value)
+{
+    uint64_t old_value = vkd3d_atomic_uint64_load_explicit(target, vkd3d_memory_order_relaxed);
+    uint64_t result;
+
+    while (value > old_value)
+    {
+        result = vkd3d_atomic_uint64_compare_exchange(target, old_value, value,
+                vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed);
+        if (result == old_value)
+            break;
+        old_value = result;
+    }
+}
+
 void vkd3d_profiling_notify_work(unsigned int index,
         uint64_t start_ticks, uint64_t end_ticks,
         unsigned int iteration_count)
 {
+    uint64_t ticks = end_ticks - start_ticks;
     struct vkd3d_profiling_block *block;
-    spinlock_t *lock;
 
     if (index == 0 || index > VKD3D_MAX_PROFILING_REGIONS || !mapped_blocks)
         return;
     index--;
 
-    lock = &region_locks[index];
     block = &mapped_blocks[index];
 
-    spinlock_acquire(lock);
-    block->iteration_total += iteration_count;
-    block->ticks_total += end_ticks - start_ticks;
-    spinlock_release(lock);
+    /* Hot regions are hit from every recording thread, so a lock here would serialize
+     * the very work we're trying to measure. The two totals are independent counters,
+     * a reader only ever needs each of them to be consistent on its own. */
+    vkd3d_atomic_uint64_add(&block->iteration_total, iteration_count, vkd3d_memory_order_relaxed);
+    vkd3d_atomic_uint64_add(&block->ticks_total, ticks, vkd3d_memory_order_relaxed);
+
+    /* The histogram counts calls rather than iterations, since a region covering
+     * several iterations is only ever observed as a whole. */
+    vkd3d_atomic_uint64_increment(&block->histogram[vkd3d_profiling_histogram_bucket(ticks)],
+            vkd3d_memory_order_relaxed);
+    vkd3d_profiling_update_max(&block->ticks_max, ticks);
+
+    if (timeline_file)
+        vkd3d_timeline_trace_region(block->name, start_ticks, end_ticks);
+}
+
+#ifdef VKD3D_ENABLE_LOCK_PROFILING
+/* Maps the address of the name string at a call site to its block. Slots are only ever
+ * claimed under profiling_lock and the index is published last, so lookups are lock-free. */
+#define VKD3D_LOCK_PROFILING_CACHE_SIZE 1024
+
+struct vkd3d_lock_profiling_entry
+{
+    const char *name;
+    uint32_t index;
+};
+
+static struct vkd3d_lock_profiling_entry lock_profiling_cache[VKD3D_LOCK_PROFILING_CACHE_SIZE];
+
+static unsigned int vkd3d_lock_profiling_hash(const char *name)
+{
+    return (unsigned int)(((uintptr_t)name >> 3) * 0x9e3779b1u) % VKD3D_LOCK_PROFILING_CACHE_SIZE;
+}
+
+static unsigned int vkd3d_lock_profiling_lookup(const char *name)
+{
+    unsigned int slot, i, index;
+
+    slot = vkd3d_lock_profiling_hash(name);
+    for (i = 0; i < VKD3D_LOCK_PROFILING_CACHE_SIZE; i++)
+    {
+        index = vkd3d_atomic_uint32_load_explicit(&lock_profiling_cache[slot].index, vkd3d_memory_order_acquire);
+        if (!index)
+            return 0;
+        if (lock_profiling_cache[slot].name == name)
+            return index;
+        slot = (slot + 1) % VKD3D_LOCK_PROFILING_CACHE_SIZE;
+    }
+
+    return 0;
 }
 
-#endif /* VKD3D_ENABLE_PROFILING */
+static unsigned int vkd3d_lock_profiling_register_locked(const char *name)
+{
+    char block_name[sizeof(mapped_blocks->name)];
+    unsigned int i, slot, index = 0;
+
+    /* Different translation units spell the same lock with different string addresses,
+     * so fold them by name into one block. */
+    snprintf(block_name, sizeof(block_name), "lock %s", name);
+    for (i = 0; i < min(profiling_region_count, VKD3D_MAX_PROFILING_REGIONS); i++)
+    {
+        if (!strcmp(mapped_blocks[i].name, block_name))
+        {
+            index = i + 1;
+            break;
+        }
+    }
+
+    if (!index)
+    {
+        if (profiling_region_count >= VKD3D_MAX_PROFILING_REGIONS)
+            return 0;
+        index = ++profiling_region_count;
+        memcpy(mapped_blocks[index - 1].name, block_name, sizeof(block_name));
+    }
+
+    slot = vkd3d_lock_profiling_hash(name);
+    for (i = 0; i < VKD3D_LOCK_PROFILING_CACHE_SIZE; i++)
+    {
+        if (!lock_profiling_cache[slot].index)
+        {
+            lock_profiling_cache[slot].name = name;
+            vkd3d_atomic_uint32_store_explicit(&lock_profiling_cache[slot].index, index, vkd3d_memory_order_release);
+            break;
+        }
+        slot = (slot + 1) % VKD3D_LOCK_PROFILING_CACHE_SIZE;
+    }
+
+    return index;
+}
+
+uint64_t vkd3d_lock_profiling_get_ticks(void)
+{
+    return vkd3d_get_current_time_ticks();
+}
+
+void vkd3d_lock_profiling_notify(const char *name, bool contended, uint64_t wait_ticks)
+{
+    struct vkd3d_profiling_block *block;
+    unsigned int index;
+
+    if (!mapped_blocks)
+        return;
+
+    if (!(index = vkd3d_lock_profiling_lookup(name)))
+    {
+        spinlock_acquire(&profiling_lock);
+        if (!(index = vkd3d_lock_profiling_lookup(name)))
+            index = vkd3d_lock_profiling_register_locked(name);
+        spinlock_release(&profiling_lock);
+
+        if (!index)
+            return;
+    }
+
+    /* For locks, iterations count acquisitions and ticks count time spent waiting.
+     * The histogram and max only cover contended acquisitions, so percentiles
+     * describe how long a waiter actually waits. */
+    block = &mapped_blocks[index - 1];
+    vkd3d_atomic_uint64_increment(&block->iteration_total, vkd3d_memory_order_relaxed);
+
+    if (contended)
+    {
+        vkd3d_atomic_uint64_increment(&block->contended_total, vkd3d_memory_order_relaxed);
+        vkd3d_atomic_uint64_add(&block->ticks_total, wait_ticks, vkd3d_memory_order_relaxed);
+        vkd3d_atomic_uint64_increment(&block->histogram[vkd3d_profiling_histogram_bucket(wait_ticks)],
+                vkd3d_memory_order_relaxed);
+        vkd3d_profiling_update_max(&block->ticks_max, wait_ticks);
+    }
+}
+#endif
@@ -24,6 +24,10 @@
 
 #include <inttypes.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 static size_t vkd3d_utf8_len(uint32_t c)
 {
     /* 0x00-0x7f: 1 byte */
@@ -111,13 +115,62 @@ static inline bool vkd3d_string_should_loop_u16(ptrdiff_t max_elements, const WC
     return (!max_elements || cursor_pos < max_elements) && *src;
 }
 
-char *vkd3d_strdup_w_utf8(const WCHAR *wstr, size_t max_elements)
+/* Object names are almost always plain ASCII. Returns the length of the string
+ * if it is, or a negative value once a non-ASCII character is found. */
+static ptrdiff_t vkd3d_utf16_ascii_length(const WCHAR *wstr, size_t max_elements)
+{
+    const WCHAR *src = wstr;
+
+    while (vkd3d_string_should_loop_u16(max_elements, src, wstr))
+    {
+        if (*src >= 0x80)
+            return -1;
+        src++;
+    }
+
+    return src - wstr;
+}
+
+static void vkd3d_utf16_narrow_ascii(char *dst, const WCHAR *src, size_t length)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    __m128i lo, hi;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        lo = _mm_loadu_si128((const __m128i *)(src + i));
+        hi = _mm_loadu_si128((const __m128i *)(src + i + 8));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < length; i++)
+        dst[i] = (char)src[i];
+}
+
+char *vkd3d_strdup_w_utf8_buffer(const WCHAR *wstr, size_t max_elements, char *buffer, size_t buffer_size)
 {
     const WCHAR *src = wstr;
+    ptrdiff_t ascii_length;
     size_t dst_size = 0;
     char *dst, *utf8;
     uint32_t c;
 
+    if ((ascii_length = vkd3d_utf16_ascii_length(wstr, max_elements)) >= 0)
+    {
+        dst_size = ascii_length + 1;
+        if (dst_size <= buffer_size)
+            dst = buffer;
+        else if (!(dst = vkd3d_malloc(dst_size)))
+            return NULL;
+
+        vkd3d_utf16_narrow_ascii(dst, wstr, ascii_length);
+        dst[ascii_length] = '\0';
+        return dst;
+    }
+
     while (vkd3d_string_should_loop_u16(max_elements, src, wstr))
     {
         if (!(c = vkd3d_utf16_read(&src)))
@@ -126,7 +179,9 @@ char *vkd3d_strdup_w_utf8(const WCHAR *wstr, size_t max_elements)
     }
     ++dst_size;
 
-    if (!(dst = vkd3d_malloc(dst_size)))
+    if (dst_size <= buffer_size)
+        dst = buffer;
+    else if (!(dst = vkd3d_malloc(dst_size)))
         return NULL;
 
     utf8 = dst;
@@ -141,3 +196,8 @@ char *vkd3d_strdup_w_utf8(const WCHAR *wstr, size_t max_elements)
 
     return dst;
 }
+
+char *vkd3d_strdup_w_utf8(const WCHAR *wstr, size_t max_elements)
+{
+    return vkd3d_strdup_w_utf8_buffer(wstr, max_elements, NULL, 0);
+}
@@ -0,0 +1,437 @@
+/*
+ * Copyright 2023 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_SHADER
+
+#include "vkd3d_shader_private.h"
+#include "vkd3d_string.h"
+#include "vkd3d_threads.h"
+#include "hashmap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#define VKD3D_SHADER_CACHE_DEFAULT_MEMORY_SIZE (64u * 1024u * 1024u)
+#define VKD3D_SHADER_CACHE_DISK_MAGIC 0x48435356u /* 'VSCH' */
+#define VKD3D_SHADER_CACHE_DISK_VERSION 2u
+
+struct vkd3d_shader_cache_entry
+{
+    struct list lru_entry;
+    uint64_t key;
+    struct vkd3d_shader_meta meta;
+    size_t size;
+    uint8_t code[];
+};
+
+struct vkd3d_shader_cache_map_entry
+{
+    struct hash_map_entry entry;
+    uint64_t key;
+    struct vkd3d_shader_cache_entry *cache_entry;
+};
+
+struct vkd3d_shader_cache
+{
+    pthread_mutex_t lock;
+    struct hash_map map;
+    /* Most recently used entry first. */
+    struct list lru;
+    size_t memory_size;
+    size_t max_memory_size;
+    char *disk_directory;
+};
+
+struct vkd3d_shader_cache_disk_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+    struct vkd3d_shader_meta meta;
+};
+
+static uint32_t vkd3d_shader_cache_map_hash(const void *key)
+{
+    return hash_uint64(*(const uint64_t *)key);
+}
+
+static bool vkd3d_shader_cache_map_compare(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_shader_cache_map_entry *e = (const struct vkd3d_shader_cache_map_entry *)entry;
+    return e->key == *(const uint64_t *)key;
+}
+
+static uint64_t vkd3d_shader_cache_hash_data(uint64_t h, const void *data, size_t size)
+{
+    return hash_xxh64(data, size, h);
+}
+
+static uint64_t vkd3d_shader_cache_hash_binding(uint64_t h, const struct vkd3d_shader_descriptor_binding *binding)
+{
+    h = hash_fnv1_iterate_u8(h, !!binding);
+    if (binding)
+        h = vkd3d_shader_cache_hash_data(h, binding, sizeof(*binding));
+    return h;
+}
+
+static uint64_t vkd3d_shader_cache_compute_key(const struct vkd3d_shader_code *dxbc,
+        unsigned int compiler_options,
+        const struct vkd3d_shader_interface_info *shader_interface_info,
+        const struct vkd3d_shader_compile_arguments *compile_args)
+{
+    vkd3d_shader_hash_t shader_hash = vkd3d_shader_hash(dxbc);
+    unsigned int i;
+    uint64_t h;
+
+    h = hash_fnv1_init();
+    h = hash_fnv1_iterate_u64(h, vkd3d_shader_get_revision());
+    h = hash_fnv1_iterate_u64(h, shader_hash);
+    h = hash_fnv1_iterate_u64(h, dxbc->size);
+    h = hash_fnv1_iterate_u32(h, compiler_options);
+
+    h = hash_fnv1_iterate_u8(h, !!shader_interface_info);
+    if (shader_interface_info)
+    {
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->flags);
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->min_ssbo_alignment);
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->descriptor_tables.offset);
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->descriptor_tables.count);
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->binding_count);
+        h = vkd3d_shader_cache_hash_data(h, shader_interface_info->bindings,
+                shader_interface_info->binding_count * sizeof(*shader_interface_info->bindings));
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->push_constant_buffer_count);
+        h = vkd3d_shader_cache_hash_data(h, shader_interface_info->push_constant_buffers,
+                shader_interface_info->push_constant_buffer_count * sizeof(*shader_interface_info->push_constant_buffers));
+        h = vkd3d_shader_cache_hash_binding(h, shader_interface_info->push_constant_ubo_binding);
+        h = vkd3d_shader_cache_hash_binding(h, shader_interface_info->offset_buffer_binding);
+#ifdef VKD3D_ENABLE_DESCRIPTOR_QA
+        h = vkd3d_shader_cache_hash_binding(h, shader_interface_info->descriptor_qa_global_binding);
+        h = vkd3d_shader_cache_hash_binding(h, shader_interface_info->descriptor_qa_heap_binding);
+#endif
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->stage);
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->descriptor_size_cbv_srv_uav);
+        h = hash_fnv1_iterate_u32(h, shader_interface_info->descriptor_size_sampler);
+    }
+
+    h = hash_fnv1_iterate_u8(h, !!compile_args);
+    if (compile_args)
+    {
+        h = hash_fnv1_iterate_u32(h, compile_args->target);
+        h = hash_fnv1_iterate_u32(h, compile_args->target_extension_count);
+        for (i = 0; i < compile_args->target_extension_count; i++)
+            h = hash_fnv1_iterate_u32(h, compile_args->target_extensions[i]);
+        h = hash_fnv1_iterate_u32(h, compile_args->parameter_count);
+        h = vkd3d_shader_cache_hash_data(h, compile_args->parameters,
+                compile_args->parameter_count * sizeof(*compile_args->parameters));
+        h = hash_fnv1_iterate_u8(h, compile_args->dual_source_blending);
+        h = hash_fnv1_iterate_u32(h, compile_args->output_swizzle_count);
+        for (i = 0; i < compile_args->output_swizzle_count; i++)
+            h = hash_fnv1_iterate_u32(h, compile_args->output_swizzles[i]);
+        h = hash_fnv1_iterate_u32(h, compile_args->min_subgroup_size);
+        h = hash_fnv1_iterate_u32(h, compile_args->max_subgroup_size);
+        h = hash_fnv1_iterate_u8(h, compile_args->promote_wave_size_heuristics);
+        h = hash_fnv1_iterate_u32(h, compile_args->root_constant_specialization_count);
+        h = vkd3d_shader_cache_hash_data(h, compile_args->root_constant_specializations,
+                compile_args->root_constant_specialization_count * sizeof(*compile_args->root_constant_specializations));
+        /* Only the quirks which apply to this shader matter. */
+        h = hash_fnv1_iterate_u32(h, vkd3d_shader_compile_arguments_select_quirks(compile_args, shader_hash));
+    }
+
+    return h;
+}
+
+static bool vkd3d_shader_cache_is_cacheable(const struct vkd3d_shader_interface_info *shader_interface_info)
+{
+    /* Stage I/O maps are filled in by compilation and transform feedback info holds
+     * semantic strings. Neither is worth keying on, so such compiles bypass the cache. */
+    return !shader_interface_info || (!shader_interface_info->stage_input_map &&
+            !shader_interface_info->stage_output_map && !shader_interface_info->xfb_info);
+}
+
+static void vkd3d_shader_cache_free_entry(struct hash_map_entry *entry, void *userdata)
+{
+    struct vkd3d_shader_cache_map_entry *e = (struct vkd3d_shader_cache_map_entry *)entry;
+    vkd3d_free(e->cache_entry);
+}
+
+int vkd3d_shader_cache_create(const struct vkd3d_shader_cache_info *info, struct vkd3d_shader_cache **cache)
+{
+    struct vkd3d_shader_cache *object;
+    int rc;
+
+    TRACE("info %p, cache %p.\n", info, cache);
+
+    if (!(object = vkd3d_calloc(1, sizeof(*object))))
+        return VKD3D_ERROR_OUT_OF_MEMORY;
+
+    if ((rc = pthread_mutex_init(&object->lock, NULL)))
+    {
+        ERR("Failed to initialize mutex, error %d.\n", rc);
+        vkd3d_free(object);
+        return VKD3D_ERROR;
+    }
+
+    hash_map_init(&object->map, vkd3d_shader_cache_map_hash,
+            vkd3d_shader_cache_map_compare, sizeof(struct vkd3d_shader_cache_map_entry));
+    list_init(&object->lru);
+
+    object->max_memory_size = info && info->max_memory_size ?
+            info->max_memory_size : VKD3D_SHADER_CACHE_DEFAULT_MEMORY_SIZE;
+
+    if (info && info->disk_directory)
+    {
+        if (!(object->disk_directory = vkd3d_strdup(info->disk_directory)))
+        {
+            pthread_mutex_destroy(&object->lock);
+            vkd3d_free(object);
+            return VKD3D_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    *cache = object;
+    return VKD3D_OK;
+}
+
+void vkd3d_shader_cache_destroy(struct vkd3d_shader_cache *cache)
+{
+    TRACE("cache %p.\n", cache);
+
+    if (!cache)
+        return;
+
+    hash_map_iter(&cache->map, vkd3d_shader_cache_free_entry, NULL);
+    hash_map_free(&cache->map);
+    pthread_mutex_destroy(&cache->lock);
+    vkd3d_free(cache->disk_directory);
+    vkd3d_free(cache);
+}
+
+static bool vkd3d_shader_cache_entry_to_code(const struct vkd3d_shader_cache_entry *entry,
+        struct vkd3d_shader_code *spirv)
+{
+    void *code;
+
+    if (!(code = vkd3d_malloc(entry->size)))
+        return false;
+
+    memcpy(code, entry->code, entry->size);
+    spirv->code = code;
+    spirv->size = entry->size;
+    spirv->meta = entry->meta;
+    return true;
+}
+
+static void vkd3d_shader_cache_evict_locked(struct vkd3d_shader_cache *cache)
+{
+    struct vkd3d_shader_cache_entry *entry;
+    struct hash_map_entry *map_entry;
+
+    while (cache->memory_size > cache->max_memory_size && !list_empty(&cache->lru))
+    {
+        entry = LIST_ENTRY(list_tail(&cache->lru), struct vkd3d_shader_cache_entry, lru_entry);
+        list_remove(&entry->lru_entry);
+
+        if ((map_entry = hash_map_find(&cache->map, &entry->key)))
+            hash_map_remove(&cache->map, map_entry);
+
+        cache->memory_size -= entry->size;
+        vkd3d_free(entry);
+    }
+}
+
+static bool vkd3d_shader_cache_lookup(struct vkd3d_shader_cache *cache, uint64_t key,
+        struct vkd3d_shader_code *spirv)
+{
+    const struct vkd3d_shader_cache_map_entry *e;
+    bool found = false;
+
+    pthread_mutex_lock(&cache->lock);
+    if ((e = (const struct vkd3d_shader_cache_map_entry *)hash_map_find(&cache->map, &key)))
+    {
+        list_remove(&e->cache_entry->lru_entry);
+        list_add_head(&cache->lru, &e->cache_entry->lru_entry);
+        found = vkd3d_shader_cache_entry_to_code(e->cache_entry, spirv);
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return found;
+}
+
+static void vkd3d_shader_cache_insert(struct vkd3d_shader_cache *cache, uint64_t key,
+        const struct vkd3d_shader_meta *meta, const void *code, size_t size)
+{
+    struct vkd3d_shader_cache_map_entry map_entry;
+    struct vkd3d_shader_cache_entry *entry;
+    struct vkd3d_shader_cache_map_entry *e;
+
+    /* Don't let a single shader flush everything else out. */
+    if (size > cache->max_memory_size)
+        return;
+
+    if (!(entry = vkd3d_malloc(offsetof(struct vkd3d_shader_cache_entry, code[size]))))
+        return;
+
+    entry->key = key;
+    entry->meta = *meta;
+    entry->size = size;
+    memcpy(entry->code, code, size);
+
+    map_entry.key = key;
+    map_entry.cache_entry = entry;
+
+    pthread_mutex_lock(&cache->lock);
+
+    /* If another thread raced us, keep the existing entry. */
+    if (!(e = (struct vkd3d_shader_cache_map_entry *)hash_map_insert(&cache->map, &key, &map_entry.entry)) ||
+            e->cache_entry != entry)
+    {
+        pthread_mutex_unlock(&cache->lock);
+        vkd3d_free(entry);
+        return;
+    }
+
+    list_add_head(&cache->lru, &entry->lru_entry);
+    cache->memory_size += size;
+    vkd3d_shader_cache_evict_locked(cache);
+
+    pthread_mutex_unlock(&cache->lock);
+}
+
+static void vkd3d_shader_cache_get_disk_path(const struct vkd3d_shader_cache *cache, uint64_t key,
+        const char *ext, char *path, size_t path_size)
+{
+    snprintf(path, path_size, "%s/%016"PRIx64".%s", cache->disk_directory, key, ext);
+}
+
+static bool vkd3d_shader_cache_read_disk(struct vkd3d_shader_cache *cache, uint64_t key,
+        struct vkd3d_shader_code *spirv)
+{
+    struct vkd3d_shader_cache_disk_header header;
+    void *code = NULL;
+    char path[1024];
+    FILE *f;
+
+    vkd3d_shader_cache_get_disk_path(cache, key, "spv-cache", path, sizeof(path));
+
+    if (!(f = fopen(path, "rb")))
+        return false;
+
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+            header.magic != VKD3D_SHADER_CACHE_DISK_MAGIC ||
+            header.version != VKD3D_SHADER_CACHE_DISK_VERSION ||
+            header.key != key || !header.size || header.size > SIZE_MAX)
+        goto fail;
+
+    if (!(code = vkd3d_malloc(header.size)))
+        goto fail;
+
+    if (fread(code, 1, header.size, f) != header.size)
+        goto fail;
+
+    /* A concurrent writer might still be appending, reject trailing garbage as well. */
+    if (fgetc(f) != EOF)
+        goto fail;
+
+    fclose(f);
+    spirv->code = code;
+    spirv->size = header.size;
+    spirv->meta = header.meta;
+    return true;
+
+fail:
+    WARN("Ignoring invalid shader cache file %s.\n", path);
+    vkd3d_free(code);
+    fclose(f);
+    return false;
+}
+
+static void vkd3d_shader_cache_write_disk(struct vkd3d_shader_cache *cache, uint64_t key,
+        const struct vkd3d_shader_code *spirv)
+{
+    struct vkd3d_shader_cache_disk_header header;
+    char tmp_path[1024], path[1024];
+    bool success;
+    FILE *f;
+
+    vkd3d_shader_cache_get_disk_path(cache, key, "spv-cache", path, sizeof(path));
+    vkd3d_shader_cache_get_disk_path(cache, key, "spv-cache.tmp", tmp_path, sizeof(tmp_path));
+
+    /* Exclusive open, so only one thread or process writes a given entry. */
+    if (!(f = fopen(tmp_path, "wbx")))
+        return;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = VKD3D_SHADER_CACHE_DISK_MAGIC;
+    header.version = VKD3D_SHADER_CACHE_DISK_VERSION;
+    header.key = key;
+    header.size = spirv->size;
+    header.meta = spirv->meta;
+
+    success = fwrite(&header, sizeof(header), 1, f) == 1 &&
+            fwrite(spirv->code, 1, spirv->size, f) == spirv->size;
+    success = !fclose(f) && success;
+
+    /* Readers only ever observe complete files. */
+    if (!success || rename(tmp_path, path) != 0)
+    {
+        if (success)
+            WARN("Failed to commit shader cache file %s.\n", path);
+        remove(tmp_path);
+    }
+}
+
+int vkd3d_shader_cache_compile_dxbc(struct vkd3d_shader_cache *cache,
+        const struct vkd3d_shader_code *dxbc, struct vkd3d_shader_code *spirv,
+        unsigned int compiler_options,
+        const struct vkd3d_shader_interface_info *shader_interface_info,
+        const struct vkd3d_shader_compile_arguments *compile_args)
+{
+    uint64_t key;
+    int ret;
+
+    TRACE("cache %p, dxbc {%p, %zu}, spirv %p, compiler_options %#x, shader_interface_info %p, compile_args %p.\n",
+            cache, dxbc->code, dxbc->size, spirv, compiler_options, shader_interface_info, compile_args);
+
+    if (!cache || !vkd3d_shader_cache_is_cacheable(shader_interface_info))
+        return vkd3d_shader_compile_dxbc(dxbc, spirv, NULL, compiler_options, shader_interface_info, compile_args);
+
+    key = vkd3d_shader_cache_compute_key(dxbc, compiler_options, shader_interface_info, compile_args);
+
+    if (vkd3d_shader_cache_lookup(cache, key, spirv))
+        return VKD3D_OK;
+
+    if (cache->disk_directory && vkd3d_shader_cache_read_disk(cache, key, spirv))
+    {
+        vkd3d_shader_cache_insert(cache, key, &spirv->meta, spirv->code, spirv->size);
+        return VKD3D_OK;
+    }
+
+    if ((ret = vkd3d_shader_compile_dxbc(dxbc, spirv, NULL, compiler_options, shader_interface_info, compile_args)) < 0)
+        return ret;
+
+    /* Replaced shaders come from the override path and may change between runs. */
+    if (!(spirv->meta.flags & VKD3D_SHADER_META_FLAG_REPLACED))
+    {
+        vkd3d_shader_cache_insert(cache, key, &spirv->meta, spirv->code, spirv->size);
+        if (cache->disk_directory)
+            vkd3d_shader_cache_write_disk(cache, key, spirv);
+    }
+
+    return ret;
+}
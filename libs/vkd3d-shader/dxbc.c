@@ -512,6 +512,8 @@ struct vkd3d_sm4_data
     struct list src_free;
     struct list src;
     struct vkd3d_shader_immediate_constant_buffer icb;
+
+    struct vkd3d_shader_arena arena;
 };
 
 struct vkd3d_sm4_opcode_info
@@ -1493,20 +1495,17 @@ void *shader_sm4_init(const DWORD *byte_code, size_t byte_code_size,
 
     list_init(&priv->src_free);
     list_init(&priv->src);
+    vkd3d_shader_arena_init(&priv->arena);
 
     return priv;
 }
 
 void shader_sm4_free(void *data)
 {
-    struct vkd3d_shader_src_param_entry *e1, *e2;
     struct vkd3d_sm4_data *priv = data;
 
-    list_move_head(&priv->src_free, &priv->src);
-    LIST_FOR_EACH_ENTRY_SAFE(e1, e2, &priv->src_free, struct vkd3d_shader_src_param_entry, entry)
-    {
-        vkd3d_free(e1);
-    }
+    /* Source parameter entries are owned by the arena. */
+    vkd3d_shader_arena_cleanup(&priv->arena);
     vkd3d_free(priv);
 }
 
@@ -1522,7 +1521,7 @@ static struct vkd3d_shader_src_param *get_src_param(struct vkd3d_sm4_data *priv)
     }
     else
     {
-        if (!(e = vkd3d_malloc(sizeof(*e))))
+        if (!(e = vkd3d_shader_arena_alloc(&priv->arena, sizeof(*e))))
             return NULL;
         elem = &e->entry;
     }
@@ -2011,6 +2010,57 @@ bool shader_sm4_is_end(void *data, const DWORD **ptr)
     return *ptr == priv->end;
 }
 
+int shader_sm4_read_instructions(void *data, const DWORD **ptr,
+        struct vkd3d_shader_instruction_array *instructions)
+{
+    struct vkd3d_sm4_data *priv = data;
+    struct vkd3d_shader_instruction *ins;
+    struct vkd3d_shader_dst_param *dst;
+    struct vkd3d_shader_src_param *src;
+
+    while (!shader_sm4_is_end(data, ptr))
+    {
+        if (!vkd3d_array_reserve((void **)&instructions->instructions, &instructions->size,
+                instructions->count + 1, sizeof(*instructions->instructions)))
+            return VKD3D_ERROR_OUT_OF_MEMORY;
+
+        ins = &instructions->instructions[instructions->count];
+        shader_sm4_read_instruction(data, ptr, ins);
+
+        if (ins->handler_idx == VKD3DSIH_INVALID)
+        {
+            WARN("Encountered unrecognized or invalid instruction.\n");
+            return VKD3D_ERROR_INVALID_ARGUMENT;
+        }
+
+        /* Parameters are decoded into per-parser scratch storage which is
+         * reused for the next instruction, so move them into the arena. */
+        if (ins->dst_count)
+        {
+            if (!(dst = vkd3d_shader_arena_alloc(&priv->arena, ins->dst_count * sizeof(*dst))))
+                return VKD3D_ERROR_OUT_OF_MEMORY;
+            memcpy(dst, ins->dst, ins->dst_count * sizeof(*dst));
+            ins->dst = dst;
+        }
+
+        if (ins->src_count)
+        {
+            if (!(src = vkd3d_shader_arena_alloc(&priv->arena, ins->src_count * sizeof(*src))))
+                return VKD3D_ERROR_OUT_OF_MEMORY;
+            memcpy(src, ins->src, ins->src_count * sizeof(*src));
+            ins->src = src;
+        }
+
+        /* Relative addressing parameters must not be recycled either. They
+         * remain owned by the arena. */
+        list_init(&priv->src);
+
+        ++instructions->count;
+    }
+
+    return VKD3D_OK;
+}
+
 #define MAKE_TAG(ch0, ch1, ch2, ch3) \
     ((DWORD)(ch0) | ((DWORD)(ch1) << 8) | \
     ((DWORD)(ch2) << 16) | ((DWORD)(ch3) << 24 ))
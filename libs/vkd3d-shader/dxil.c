@@ -1001,7 +1001,7 @@ end:
     return ret;
 }
 
-int vkd3d_shader_compile_dxil_export(const struct vkd3d_shader_code *dxil,
+static int vkd3d_shader_compile_dxil_export_from_blob(dxil_spv_parsed_blob blob, vkd3d_shader_hash_t hash,
         const char *export, const char *demangled_export,
         struct vkd3d_shader_code *spirv, struct vkd3d_shader_code_debug *spirv_debug,
         const struct vkd3d_shader_interface_info *shader_interface_info,
@@ -1016,39 +1016,11 @@ int vkd3d_shader_compile_dxil_export(const struct vkd3d_shader_code *dxil,
     unsigned int num_root_descriptors = 0;
     unsigned int root_constant_words = 0;
     dxil_spv_converter converter = NULL;
-    dxil_spv_parsed_blob blob = NULL;
     dxil_spv_compiled_spirv compiled;
     unsigned int i, j, max_size;
-    vkd3d_shader_hash_t hash;
     int ret = VKD3D_OK;
     void *code;
 
-    dxil_spv_set_thread_log_callback(vkd3d_dxil_log_callback, NULL);
-
-    memset(&spirv->meta, 0, sizeof(spirv->meta));
-    hash = vkd3d_shader_hash(dxil);
-    spirv->meta.hash = hash;
-
-    /* For user provided (not mangled) export names, just inherit that name. */
-    if (!demangled_export)
-        demangled_export = export;
-
-    if (demangled_export && vkd3d_shader_replace_export(hash, &spirv->code, &spirv->size, demangled_export))
-    {
-        spirv->meta.flags |= VKD3D_SHADER_META_FLAG_REPLACED;
-        return ret;
-    }
-
-    dxil_spv_begin_thread_allocator_context();
-
-    vkd3d_shader_dump_shader(hash, dxil, "lib.dxil");
-
-    if (dxil_spv_parse_dxil_blob(dxil->code, dxil->size, &blob) != DXIL_SPV_SUCCESS)
-    {
-        ret = VKD3D_ERROR_INVALID_SHADER;
-        goto end;
-    }
-
     if (dxil_spv_create_converter(blob, &converter) != DXIL_SPV_SUCCESS)
     {
         ret = VKD3D_ERROR_INVALID_ARGUMENT;
@@ -1436,11 +1408,124 @@ int vkd3d_shader_compile_dxil_export(const struct vkd3d_shader_code *dxil,
 
 end:
     dxil_spv_converter_free(converter);
+    return ret;
+}
+
+static bool vkd3d_shader_dxil_export_try_replace(vkd3d_shader_hash_t hash,
+        const char *demangled_export, struct vkd3d_shader_code *spirv)
+{
+    if (demangled_export && vkd3d_shader_replace_export(hash, &spirv->code, &spirv->size, demangled_export))
+    {
+        spirv->meta.flags |= VKD3D_SHADER_META_FLAG_REPLACED;
+        return true;
+    }
+
+    return false;
+}
+
+int vkd3d_shader_compile_dxil_export(const struct vkd3d_shader_code *dxil,
+        const char *export, const char *demangled_export,
+        struct vkd3d_shader_code *spirv, struct vkd3d_shader_code_debug *spirv_debug,
+        const struct vkd3d_shader_interface_info *shader_interface_info,
+        const struct vkd3d_shader_interface_local_info *shader_interface_local_info,
+        const struct vkd3d_shader_compile_arguments *compiler_args)
+{
+    dxil_spv_parsed_blob blob = NULL;
+    vkd3d_shader_hash_t hash;
+    int ret;
+
+    dxil_spv_set_thread_log_callback(vkd3d_dxil_log_callback, NULL);
+
+    memset(&spirv->meta, 0, sizeof(spirv->meta));
+    hash = vkd3d_shader_hash(dxil);
+    spirv->meta.hash = hash;
+
+    /* For user provided (not mangled) export names, just inherit that name. */
+    if (!demangled_export)
+        demangled_export = export;
+
+    if (vkd3d_shader_dxil_export_try_replace(hash, demangled_export, spirv))
+        return VKD3D_OK;
+
+    dxil_spv_begin_thread_allocator_context();
+
+    vkd3d_shader_dump_shader(hash, dxil, "lib.dxil");
+
+    if (dxil_spv_parse_dxil_blob(dxil->code, dxil->size, &blob) != DXIL_SPV_SUCCESS)
+        ret = VKD3D_ERROR_INVALID_SHADER;
+    else
+        ret = vkd3d_shader_compile_dxil_export_from_blob(blob, hash, export, demangled_export,
+                spirv, spirv_debug, shader_interface_info, shader_interface_local_info, compiler_args);
+
     dxil_spv_parsed_blob_free(blob);
     dxil_spv_end_thread_allocator_context();
     return ret;
 }
 
+struct vkd3d_shader_dxil_library
+{
+    dxil_spv_parsed_blob blob;
+    vkd3d_shader_hash_t hash;
+};
+
+int vkd3d_shader_dxil_library_create(const struct vkd3d_shader_code *dxil,
+        struct vkd3d_shader_dxil_library **library)
+{
+    struct vkd3d_shader_dxil_library *object;
+
+    if (!(object = vkd3d_calloc(1, sizeof(*object))))
+        return VKD3D_ERROR_OUT_OF_MEMORY;
+
+    dxil_spv_set_thread_log_callback(vkd3d_dxil_log_callback, NULL);
+
+    /* The parsed module lives in the thread allocator context, which stays open
+     * until the library is destroyed. */
+    dxil_spv_begin_thread_allocator_context();
+
+    object->hash = vkd3d_shader_hash(dxil);
+    vkd3d_shader_dump_shader(object->hash, dxil, "lib.dxil");
+
+    if (dxil_spv_parse_dxil_blob(dxil->code, dxil->size, &object->blob) != DXIL_SPV_SUCCESS)
+    {
+        dxil_spv_end_thread_allocator_context();
+        vkd3d_free(object);
+        return VKD3D_ERROR_INVALID_SHADER;
+    }
+
+    *library = object;
+    return VKD3D_OK;
+}
+
+void vkd3d_shader_dxil_library_destroy(struct vkd3d_shader_dxil_library *library)
+{
+    if (!library)
+        return;
+
+    dxil_spv_parsed_blob_free(library->blob);
+    dxil_spv_end_thread_allocator_context();
+    vkd3d_free(library);
+}
+
+int vkd3d_shader_compile_dxil_library_export(struct vkd3d_shader_dxil_library *library,
+        const char *export, const char *demangled_export,
+        struct vkd3d_shader_code *spirv, struct vkd3d_shader_code_debug *spirv_debug,
+        const struct vkd3d_shader_interface_info *shader_interface_info,
+        const struct vkd3d_shader_interface_local_info *shader_interface_local_info,
+        const struct vkd3d_shader_compile_arguments *compiler_args)
+{
+    memset(&spirv->meta, 0, sizeof(spirv->meta));
+    spirv->meta.hash = library->hash;
+
+    if (!demangled_export)
+        demangled_export = export;
+
+    if (vkd3d_shader_dxil_export_try_replace(library->hash, demangled_export, spirv))
+        return VKD3D_OK;
+
+    return vkd3d_shader_compile_dxil_export_from_blob(library->blob, library->hash, export, demangled_export,
+            spirv, spirv_debug, shader_interface_info, shader_interface_local_info, compiler_args);
+}
+
 void vkd3d_shader_dxil_free_library_entry_points(struct vkd3d_shader_library_entry_point *entry_points, size_t count)
 {
     size_t i;
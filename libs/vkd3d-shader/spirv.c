@@ -20,7 +20,7 @@
 
 #include "vkd3d_shader_private.h"
 #include "vkd3d_d3d12.h"
-#include "rbtree.h"
+#include "hashmap.h"
 
 #include <stdarg.h>
 #include <stdio.h>
@@ -115,10 +115,12 @@ struct vkd3d_spirv_stream
     struct list inserted_chunks;
 };
 
-static void vkd3d_spirv_stream_init(struct vkd3d_spirv_stream *stream)
+#define VKD3D_SPIRV_STREAM_MIN_CAPACITY 256
+
+static void vkd3d_spirv_stream_init(struct vkd3d_spirv_stream *stream, size_t capacity_hint)
 {
-    stream->capacity = 256;
-    if (!(stream->words = vkd3d_calloc(stream->capacity, sizeof(*stream->words))))
+    stream->capacity = max(capacity_hint, VKD3D_SPIRV_STREAM_MIN_CAPACITY);
+    if (!(stream->words = vkd3d_malloc(stream->capacity * sizeof(*stream->words))))
         stream->capacity = 0;
     stream->word_count = 0;
 
@@ -135,13 +137,8 @@ struct vkd3d_spirv_chunk
 
 static void vkd3d_spirv_stream_clear(struct vkd3d_spirv_stream *stream)
 {
-    struct vkd3d_spirv_chunk *c1, *c2;
-
+    /* Inserted chunks are owned by the builder arena. */
     stream->word_count = 0;
-
-    LIST_FOR_EACH_ENTRY_SAFE(c1, c2, &stream->inserted_chunks, struct vkd3d_spirv_chunk, entry)
-        vkd3d_free(c1);
-
     list_init(&stream->inserted_chunks);
 }
 
@@ -157,12 +154,12 @@ static size_t vkd3d_spirv_stream_current_location(struct vkd3d_spirv_stream *str
     return stream->word_count;
 }
 
-static void vkd3d_spirv_stream_insert(struct vkd3d_spirv_stream *stream,
+static void vkd3d_spirv_stream_insert(struct vkd3d_spirv_stream *stream, struct vkd3d_shader_arena *arena,
         size_t location, const uint32_t *words, unsigned int word_count)
 {
     struct vkd3d_spirv_chunk *chunk, *current;
 
-    if (!(chunk = vkd3d_malloc(offsetof(struct vkd3d_spirv_chunk, words[word_count]))))
+    if (!(chunk = vkd3d_shader_arena_alloc(arena, offsetof(struct vkd3d_spirv_chunk, words[word_count]))))
         return;
 
     chunk->location = location;
@@ -181,43 +178,42 @@ static void vkd3d_spirv_stream_insert(struct vkd3d_spirv_stream *stream,
     list_add_tail(&stream->inserted_chunks, &chunk->entry);
 }
 
-static bool vkd3d_spirv_stream_append(struct vkd3d_spirv_stream *dst_stream,
-        const struct vkd3d_spirv_stream *src_stream)
+static size_t vkd3d_spirv_stream_get_word_count(const struct vkd3d_spirv_stream *stream)
 {
-    size_t word_count, src_word_count = src_stream->word_count;
-    struct vkd3d_spirv_chunk *chunk;
-    size_t src_location = 0;
+    const struct vkd3d_spirv_chunk *chunk;
+    size_t word_count = stream->word_count;
 
-    assert(list_empty(&dst_stream->inserted_chunks));
+    LIST_FOR_EACH_ENTRY(chunk, &stream->inserted_chunks, struct vkd3d_spirv_chunk, entry)
+        word_count += chunk->word_count;
 
-    LIST_FOR_EACH_ENTRY(chunk, &src_stream->inserted_chunks, struct vkd3d_spirv_chunk, entry)
-        src_word_count += chunk->word_count;
+    return word_count;
+}
 
-    if (!vkd3d_array_reserve((void **)&dst_stream->words, &dst_stream->capacity,
-            dst_stream->word_count + src_word_count, sizeof(*dst_stream->words)))
-        return false;
+/* Writes the stream with all inserted chunks resolved. The destination must have room
+ * for vkd3d_spirv_stream_get_word_count() words. Returns the number of words written. */
+static size_t vkd3d_spirv_stream_write(uint32_t *dst, const struct vkd3d_spirv_stream *src_stream)
+{
+    const struct vkd3d_spirv_chunk *chunk;
+    size_t word_count, dst_offset = 0;
+    size_t src_location = 0;
 
-    assert(dst_stream->word_count + src_word_count <= dst_stream->capacity);
     LIST_FOR_EACH_ENTRY(chunk, &src_stream->inserted_chunks, struct vkd3d_spirv_chunk, entry)
     {
         assert(src_location <= chunk->location);
         word_count = chunk->location - src_location;
-        memcpy(&dst_stream->words[dst_stream->word_count], &src_stream->words[src_location],
-                word_count * sizeof(*src_stream->words));
-        dst_stream->word_count += word_count;
+        memcpy(&dst[dst_offset], &src_stream->words[src_location], word_count * sizeof(*src_stream->words));
+        dst_offset += word_count;
         src_location += word_count;
         assert(src_location == chunk->location);
 
-        memcpy(&dst_stream->words[dst_stream->word_count], chunk->words,
-                chunk->word_count * sizeof(*chunk->words));
-        dst_stream->word_count += chunk->word_count;
+        memcpy(&dst[dst_offset], chunk->words, chunk->word_count * sizeof(*chunk->words));
+        dst_offset += chunk->word_count;
     }
 
     word_count = src_stream->word_count - src_location;
-    memcpy(&dst_stream->words[dst_stream->word_count], &src_stream->words[src_location],
-            word_count * sizeof(*src_stream->words));
-    dst_stream->word_count += word_count;
-    return true;
+    memcpy(&dst[dst_offset], &src_stream->words[src_location], word_count * sizeof(*src_stream->words));
+    dst_offset += word_count;
+    return dst_offset;
 }
 
 struct vkd3d_spirv_builder
@@ -232,7 +228,8 @@ struct vkd3d_spirv_builder
 
     uint32_t current_id;
     uint32_t main_function_id;
-    struct rb_tree declarations;
+    struct hash_map declarations;
+    struct vkd3d_shader_arena arena;
     uint32_t type_sampler_id;
     uint32_t type_bool_id;
     uint32_t type_void_id;
@@ -393,7 +390,7 @@ static uint32_t vkd3d_spirv_build_once(struct vkd3d_spirv_builder *builder,
 
 struct vkd3d_spirv_declaration
 {
-    struct rb_entry entry;
+    struct hash_map_entry entry;
 
     SpvOp op;
     unsigned int parameter_count;
@@ -401,41 +398,38 @@ struct vkd3d_spirv_declaration
     uint32_t id;
 };
 
-static int vkd3d_spirv_declaration_compare(const void *key, const struct rb_entry *e)
+static uint32_t vkd3d_spirv_declaration_hash(const void *key)
 {
-    const struct vkd3d_spirv_declaration *a = key;
-    const struct vkd3d_spirv_declaration *b = RB_ENTRY_VALUE(e, const struct vkd3d_spirv_declaration, entry);
+    const struct vkd3d_spirv_declaration *d = key;
+    uint32_t hash;
 
-    if (a->op != b->op)
-        return a->op - b->op;
-    if (a->parameter_count != b->parameter_count)
-        return a->parameter_count - b->parameter_count;
-    assert(a->parameter_count <= ARRAY_SIZE(a->parameters));
-    return memcmp(&a->parameters, &b->parameters, a->parameter_count * sizeof(*a->parameters));
+    assert(d->parameter_count <= ARRAY_SIZE(d->parameters));
+    hash = hash_combine(d->op, d->parameter_count);
+    return hash_combine(hash, hash_data(d->parameters, d->parameter_count * sizeof(*d->parameters)));
 }
 
-static void vkd3d_spirv_declaration_free(struct rb_entry *entry, void *context)
+static bool vkd3d_spirv_declaration_compare(const void *key, const struct hash_map_entry *e)
 {
-    struct vkd3d_spirv_declaration *d = RB_ENTRY_VALUE(entry, struct vkd3d_spirv_declaration, entry);
+    const struct vkd3d_spirv_declaration *a = key;
+    const struct vkd3d_spirv_declaration *b = (const struct vkd3d_spirv_declaration *)e;
 
-    vkd3d_free(d);
+    return a->op == b->op && a->parameter_count == b->parameter_count &&
+            !memcmp(&a->parameters, &b->parameters, a->parameter_count * sizeof(*a->parameters));
 }
 
 static void vkd3d_spirv_insert_declaration(struct vkd3d_spirv_builder *builder,
         const struct vkd3d_spirv_declaration *declaration)
 {
-    struct vkd3d_spirv_declaration *d;
-
     assert(declaration->parameter_count <= ARRAY_SIZE(declaration->parameters));
 
-    if (!(d = vkd3d_malloc(sizeof(*d))))
-        return;
-    memcpy(d, declaration, sizeof(*d));
-    if (rb_put(&builder->declarations, d, &d->entry) == -1)
-    {
+    if (!hash_map_insert(&builder->declarations, declaration, &declaration->entry))
         ERR("Failed to insert declaration entry.\n");
-        vkd3d_free(d);
-    }
+}
+
+static const struct vkd3d_spirv_declaration *vkd3d_spirv_find_declaration(struct vkd3d_spirv_builder *builder,
+        const struct vkd3d_spirv_declaration *declaration)
+{
+    return (const struct vkd3d_spirv_declaration *)hash_map_find(&builder->declarations, declaration);
 }
 
 static uint32_t vkd3d_spirv_build_once_v(struct vkd3d_spirv_builder *builder,
@@ -444,7 +438,7 @@ static uint32_t vkd3d_spirv_build_once_v(struct vkd3d_spirv_builder *builder,
 {
     struct vkd3d_spirv_declaration declaration;
     unsigned int i, param_idx = 0;
-    struct rb_entry *entry;
+    const struct vkd3d_spirv_declaration *entry;
 
     if (operand_count > ARRAY_SIZE(declaration.parameters))
     {
@@ -457,8 +451,8 @@ static uint32_t vkd3d_spirv_build_once_v(struct vkd3d_spirv_builder *builder,
         declaration.parameters[param_idx++] = operands[i];
     declaration.parameter_count = param_idx;
 
-    if ((entry = rb_get(&builder->declarations, &declaration)))
-        return RB_ENTRY_VALUE(entry, struct vkd3d_spirv_declaration, entry)->id;
+    if ((entry = vkd3d_spirv_find_declaration(builder, &declaration)))
+        return entry->id;
 
     declaration.id = build_pfn(builder, operands, operand_count);
     vkd3d_spirv_insert_declaration(builder, &declaration);
@@ -469,14 +463,14 @@ static uint32_t vkd3d_spirv_build_once1(struct vkd3d_spirv_builder *builder,
         SpvOp op, uint32_t operand0, vkd3d_spirv_build1_pfn build_pfn)
 {
     struct vkd3d_spirv_declaration declaration;
-    struct rb_entry *entry;
+    const struct vkd3d_spirv_declaration *entry;
 
     declaration.op = op;
     declaration.parameter_count = 1;
     declaration.parameters[0] = operand0;
 
-    if ((entry = rb_get(&builder->declarations, &declaration)))
-        return RB_ENTRY_VALUE(entry, struct vkd3d_spirv_declaration, entry)->id;
+    if ((entry = vkd3d_spirv_find_declaration(builder, &declaration)))
+        return entry->id;
 
     declaration.id = build_pfn(builder, operand0);
     vkd3d_spirv_insert_declaration(builder, &declaration);
@@ -489,7 +483,7 @@ static uint32_t vkd3d_spirv_build_once1v(struct vkd3d_spirv_builder *builder,
 {
     struct vkd3d_spirv_declaration declaration;
     unsigned int i, param_idx = 0;
-    struct rb_entry *entry;
+    const struct vkd3d_spirv_declaration *entry;
 
     if (operand_count >= ARRAY_SIZE(declaration.parameters))
     {
@@ -503,8 +497,8 @@ static uint32_t vkd3d_spirv_build_once1v(struct vkd3d_spirv_builder *builder,
         declaration.parameters[param_idx++] = operands[i];
     declaration.parameter_count = param_idx;
 
-    if ((entry = rb_get(&builder->declarations, &declaration)))
-        return RB_ENTRY_VALUE(entry, struct vkd3d_spirv_declaration, entry)->id;
+    if ((entry = vkd3d_spirv_find_declaration(builder, &declaration)))
+        return entry->id;
 
     declaration.id = build_pfn(builder, operand0, operands, operand_count);
     vkd3d_spirv_insert_declaration(builder, &declaration);
@@ -515,15 +509,15 @@ static uint32_t vkd3d_spirv_build_once2(struct vkd3d_spirv_builder *builder,
         SpvOp op, uint32_t operand0, uint32_t operand1, vkd3d_spirv_build2_pfn build_pfn)
 {
     struct vkd3d_spirv_declaration declaration;
-    struct rb_entry *entry;
+    const struct vkd3d_spirv_declaration *entry;
 
     declaration.op = op;
     declaration.parameter_count = 2;
     declaration.parameters[0] = operand0;
     declaration.parameters[1] = operand1;
 
-    if ((entry = rb_get(&builder->declarations, &declaration)))
-        return RB_ENTRY_VALUE(entry, struct vkd3d_spirv_declaration, entry)->id;
+    if ((entry = vkd3d_spirv_find_declaration(builder, &declaration)))
+        return entry->id;
 
     declaration.id = build_pfn(builder, operand0, operand1);
     vkd3d_spirv_insert_declaration(builder, &declaration);
@@ -534,14 +528,14 @@ static uint32_t vkd3d_spirv_build_once7(struct vkd3d_spirv_builder *builder,
         SpvOp op, const uint32_t *operands, vkd3d_spirv_build7_pfn build_pfn)
 {
     struct vkd3d_spirv_declaration declaration;
-    struct rb_entry *entry;
+    const struct vkd3d_spirv_declaration *entry;
 
     declaration.op = op;
     declaration.parameter_count = 7;
     memcpy(&declaration.parameters, operands, declaration.parameter_count * sizeof(*operands));
 
-    if ((entry = rb_get(&builder->declarations, &declaration)))
-        return RB_ENTRY_VALUE(entry, struct vkd3d_spirv_declaration, entry)->id;
+    if ((entry = vkd3d_spirv_find_declaration(builder, &declaration)))
+        return entry->id;
 
     declaration.id = build_pfn(builder, operands[0], operands[1], operands[2],
             operands[3], operands[4], operands[5], operands[6]);
@@ -742,7 +736,7 @@ static void vkd3d_spirv_end_function_stream_insertion(struct vkd3d_spirv_builder
     builder->insertion_stream = builder->function_stream;
     builder->function_stream = builder->original_function_stream;
 
-    vkd3d_spirv_stream_insert(&builder->function_stream, builder->insertion_location,
+    vkd3d_spirv_stream_insert(&builder->function_stream, &builder->arena, builder->insertion_location,
             insertion_stream->words, insertion_stream->word_count);
     vkd3d_spirv_stream_clear(insertion_stream);
     builder->insertion_location = ~(size_t)0;
@@ -1771,21 +1765,26 @@ static void vkd3d_spirv_decompose_sparse_result(struct vkd3d_spirv_builder *buil
     *result_id = vkd3d_spirv_build_op_composite_extract1(builder, result_type, val_id, 1);
 }
 
-static void vkd3d_spirv_builder_init(struct vkd3d_spirv_builder *builder)
+static void vkd3d_spirv_builder_init(struct vkd3d_spirv_builder *builder, size_t token_count)
 {
-    vkd3d_spirv_stream_init(&builder->string_stream);
-    vkd3d_spirv_stream_init(&builder->debug_stream);
-    vkd3d_spirv_stream_init(&builder->annotation_stream);
-    vkd3d_spirv_stream_init(&builder->global_stream);
-    vkd3d_spirv_stream_init(&builder->function_stream);
-    vkd3d_spirv_stream_init(&builder->execution_mode_stream);
+    /* Size the streams up front from the DXBC token count to avoid repeated reallocation.
+     * The function body is typically two to three words per DXBC token, while global
+     * declarations and decorations scale with the much smaller declaration section. */
+    vkd3d_spirv_stream_init(&builder->string_stream, 0);
+    vkd3d_spirv_stream_init(&builder->debug_stream, token_count / 4);
+    vkd3d_spirv_stream_init(&builder->annotation_stream, token_count / 4);
+    vkd3d_spirv_stream_init(&builder->global_stream, token_count / 2);
+    vkd3d_spirv_stream_init(&builder->function_stream, token_count * 2);
+    vkd3d_spirv_stream_init(&builder->execution_mode_stream, 0);
 
-    vkd3d_spirv_stream_init(&builder->insertion_stream);
+    vkd3d_spirv_stream_init(&builder->insertion_stream, 0);
     builder->insertion_location = ~(size_t)0;
 
     builder->current_id = 1;
 
-    rb_init(&builder->declarations, vkd3d_spirv_declaration_compare);
+    hash_map_init(&builder->declarations, vkd3d_spirv_declaration_hash,
+            vkd3d_spirv_declaration_compare, sizeof(struct vkd3d_spirv_declaration));
+    vkd3d_shader_arena_init(&builder->arena);
 
     builder->main_function_id = vkd3d_spirv_alloc_id(builder);
     vkd3d_spirv_build_op_name(builder, builder->main_function_id, "main");
@@ -1815,7 +1814,8 @@ static void vkd3d_spirv_builder_free(struct vkd3d_spirv_builder *builder)
 
     vkd3d_spirv_stream_free(&builder->insertion_stream);
 
-    rb_destroy(&builder->declarations, vkd3d_spirv_declaration_free, NULL);
+    hash_map_free(&builder->declarations);
+    vkd3d_shader_arena_cleanup(&builder->arena);
 
     vkd3d_free(builder->capabilities);
     vkd3d_free(builder->iface);
@@ -1875,14 +1875,15 @@ static const struct vkd3d_spirv_capability_extension_mapping vkd3d_spirv_capabil
 static bool vkd3d_spirv_compile_module(struct vkd3d_spirv_builder *builder,
         struct vkd3d_shader_code *spirv)
 {
+    const struct vkd3d_spirv_stream *streams[6];
     SpvAddressingModel addressing_model;
     struct vkd3d_spirv_stream stream;
+    size_t word_count, offset;
     uint32_t extension_mask = 0;
     unsigned int i, j;
     uint32_t *code;
-    size_t size;
 
-    vkd3d_spirv_stream_init(&stream);
+    vkd3d_spirv_stream_init(&stream, 0);
 
     vkd3d_spirv_build_word(&stream, SpvMagicNumber);
     vkd3d_spirv_build_word(&stream, VKD3D_SPIRV_VERSION);
@@ -1931,26 +1932,33 @@ static bool vkd3d_spirv_compile_module(struct vkd3d_spirv_builder *builder,
     if (builder->invocation_count)
         vkd3d_spirv_build_op_execution_mode(&builder->execution_mode_stream,
                 builder->main_function_id, SpvExecutionModeInvocations, &builder->invocation_count, 1);
-    vkd3d_spirv_stream_append(&stream, &builder->execution_mode_stream);
 
-    vkd3d_spirv_stream_append(&stream, &builder->string_stream);
-    vkd3d_spirv_stream_append(&stream, &builder->debug_stream);
-    vkd3d_spirv_stream_append(&stream, &builder->annotation_stream);
-    vkd3d_spirv_stream_append(&stream, &builder->global_stream);
-    vkd3d_spirv_stream_append(&stream, &builder->function_stream);
+    streams[0] = &builder->execution_mode_stream;
+    streams[1] = &builder->string_stream;
+    streams[2] = &builder->debug_stream;
+    streams[3] = &builder->annotation_stream;
+    streams[4] = &builder->global_stream;
+    streams[5] = &builder->function_stream;
 
-    if (!(code = vkd3d_calloc(stream.word_count, sizeof(*code))))
+    /* Assemble the module directly into the output buffer. */
+    word_count = vkd3d_spirv_stream_get_word_count(&stream);
+    for (i = 0; i < ARRAY_SIZE(streams); ++i)
+        word_count += vkd3d_spirv_stream_get_word_count(streams[i]);
+
+    if (!(code = vkd3d_malloc(word_count * sizeof(*code))))
     {
         vkd3d_spirv_stream_free(&stream);
         return false;
     }
 
-    size = stream.word_count * sizeof(*code);
-    memcpy(code, stream.words, size);
+    offset = vkd3d_spirv_stream_write(code, &stream);
+    for (i = 0; i < ARRAY_SIZE(streams); ++i)
+        offset += vkd3d_spirv_stream_write(&code[offset], streams[i]);
+    assert(offset == word_count);
     vkd3d_spirv_stream_free(&stream);
 
     spirv->code = code;
-    spirv->size = size;
+    spirv->size = word_count * sizeof(*code);
 
     return true;
 }
@@ -2047,8 +2055,6 @@ struct vkd3d_symbol_resource_data
 
 struct vkd3d_symbol
 {
-    struct rb_entry entry;
-
     enum
     {
         VKD3D_SYMBOL_REGISTER,
@@ -2077,86 +2083,57 @@ struct vkd3d_sm51_symbol_key
 
 struct vkd3d_sm51_symbol
 {
-    struct rb_entry entry;
+    struct hash_map_entry entry;
     struct vkd3d_sm51_symbol_key key;
     unsigned int register_space;
     unsigned int resource_idx;
 };
 
-static int vkd3d_symbol_compare(const void *key, const struct rb_entry *entry)
+/* Symbols are allocated from the builder arena so that pointers handed out
+ * by lookups remain stable while the table grows or shifts entries. */
+struct vkd3d_symbol_table_entry
 {
-    const struct vkd3d_symbol *a = key;
-    const struct vkd3d_symbol *b = RB_ENTRY_VALUE(entry, const struct vkd3d_symbol, entry);
-
-    if (a->type != b->type)
-        return a->type - b->type;
-    return memcmp(&a->key, &b->key, sizeof(a->key));
-}
+    struct hash_map_entry entry;
+    struct vkd3d_symbol *symbol;
+};
 
-static int vkd3d_sm51_symbol_compare(const void *key, const struct rb_entry *entry)
+static uint32_t vkd3d_symbol_hash(const void *key)
 {
-    const struct vkd3d_sm51_symbol_key *a = key;
-    const struct vkd3d_sm51_symbol *b = RB_ENTRY_VALUE(entry, const struct vkd3d_sm51_symbol, entry);
-    return memcmp(a, &b->key, sizeof(*a));
+    const struct vkd3d_symbol *s = key;
+
+    return hash_combine(s->type, hash_data(&s->key, sizeof(s->key)));
 }
 
-static void vkd3d_symbol_free(struct rb_entry *entry, void *context)
+static bool vkd3d_symbol_compare(const void *key, const struct hash_map_entry *entry)
 {
-    struct vkd3d_symbol *s = RB_ENTRY_VALUE(entry, struct vkd3d_symbol, entry);
+    const struct vkd3d_symbol_table_entry *e = (const struct vkd3d_symbol_table_entry *)entry;
+    const struct vkd3d_symbol *a = key;
+    const struct vkd3d_symbol *b = e->symbol;
 
-    vkd3d_free(s);
+    return a->type == b->type && !memcmp(&a->key, &b->key, sizeof(a->key));
 }
 
-static void vkd3d_sm51_symbol_free(struct rb_entry *entry, void *context)
+static uint32_t vkd3d_sm51_symbol_hash(const void *key)
 {
-    struct vkd3d_sm51_symbol *s = RB_ENTRY_VALUE(entry, struct vkd3d_sm51_symbol, entry);
+    const struct vkd3d_sm51_symbol_key *k = key;
 
-    vkd3d_free(s);
+    return hash_combine(k->descriptor_type, k->idx);
 }
 
-static void vkd3d_symbol_make_register(struct vkd3d_symbol *symbol,
-        const struct vkd3d_shader_register *reg)
-{
-    symbol->type = VKD3D_SYMBOL_REGISTER;
-    memset(&symbol->key, 0, sizeof(symbol->key));
-    symbol->key.reg.type = reg->type;
-    if (vkd3d_shader_register_is_input(reg) && reg->idx[1].offset != ~0u)
-        symbol->key.reg.idx = reg->idx[1].offset;
-    else if (reg->type != VKD3DSPR_IMMCONSTBUFFER)
-        symbol->key.reg.idx = reg->idx[0].offset;
-}
-
-static void vkd3d_symbol_set_register_info(struct vkd3d_symbol *symbol,
-        uint32_t val_id, SpvStorageClass storage_class,
-        enum vkd3d_component_type component_type, DWORD write_mask)
-{
-    symbol->id = val_id;
-    symbol->info.reg.storage_class = storage_class;
-    symbol->info.reg.member_idx = 0;
-    symbol->info.reg.component_type = component_type;
-    symbol->info.reg.write_mask = write_mask;
-    symbol->info.reg.structure_stride = 0;
-    symbol->info.reg.is_aggregate = false;
-    symbol->info.reg.is_dynamically_indexed = false;
-    symbol->info.reg.va_type_id = 0;
-    symbol->info.reg.cbv_binding = NULL;
-    symbol->info.reg.indexable_count = 0;
-}
-
-static void vkd3d_symbol_make_resource(struct vkd3d_symbol *symbol,
-        const struct vkd3d_shader_register *reg)
+static bool vkd3d_sm51_symbol_compare(const void *key, const struct hash_map_entry *entry)
 {
-    symbol->type = VKD3D_SYMBOL_RESOURCE;
-    memset(&symbol->key, 0, sizeof(symbol->key));
-    symbol->key.resource.type = reg->type;
-    symbol->key.resource.idx = reg->idx[0].offset;
+    const struct vkd3d_sm51_symbol *b = (const struct vkd3d_sm51_symbol *)entry;
+    const struct vkd3d_sm51_symbol_key *a = key;
+
+    return a->descriptor_type == b->key.descriptor_type && a->idx == b->key.idx;
 }
 
-static struct vkd3d_symbol *vkd3d_symbol_dup(const struct vkd3d_symbol *symbol)
+static struct vkd3d_symbol *vkd3d_symbol_dup(struct vkd3d_shader_arena *arena,
+        const struct vkd3d_symbol *symbol)
 {
     struct vkd3d_symbol *s;
 
-    if (!(s = vkd3d_malloc(sizeof(*s))))
+    if (!(s = vkd3d_shader_arena_alloc(arena, sizeof(*s))))
         return NULL;
 
     return memcpy(s, symbol, sizeof(*s));
@@ -2293,13 +2270,13 @@ struct vkd3d_dxbc_compiler
     uint32_t options;
     uint32_t quirks;
 
-    struct rb_tree symbol_table;
+    struct hash_map symbol_table;
     uint32_t temp_id;
     unsigned int temp_count;
     struct vkd3d_hull_shader_variables hs;
     uint32_t sample_positions_id;
 
-    struct rb_tree sm51_resource_table;
+    struct hash_map sm51_resource_table;
 
     enum vkd3d_shader_type shader_type;
 
@@ -2350,6 +2327,8 @@ struct vkd3d_dxbc_compiler
     size_t spec_constants_size;
 
     uint32_t push_constant_member_count;
+    uint32_t *push_constant_member_offsets;
+    bool uses_root_constants;
     uint32_t root_parameter_var_id;
     uint32_t descriptor_table_member;
 
@@ -2420,11 +2399,13 @@ struct vkd3d_dxbc_compiler *vkd3d_dxbc_compiler_create(const struct vkd3d_shader
         return NULL;
     }
 
-    vkd3d_spirv_builder_init(&compiler->spirv_builder);
+    vkd3d_spirv_builder_init(&compiler->spirv_builder, shader_desc->byte_code_size / sizeof(uint32_t));
     compiler->options = compiler_options;
 
-    rb_init(&compiler->symbol_table, vkd3d_symbol_compare);
-    rb_init(&compiler->sm51_resource_table, vkd3d_sm51_symbol_compare);
+    hash_map_init(&compiler->symbol_table, vkd3d_symbol_hash,
+            vkd3d_symbol_compare, sizeof(struct vkd3d_symbol_table_entry));
+    hash_map_init(&compiler->sm51_resource_table, vkd3d_sm51_symbol_hash,
+            vkd3d_sm51_symbol_compare, sizeof(struct vkd3d_sm51_symbol));
 
     compiler->shader_type = shader_version->type;
 
@@ -2549,16 +2530,14 @@ static bool vkd3d_get_binding_info_for_register(
 {
     const struct vkd3d_sm51_symbol *symbol;
     struct vkd3d_sm51_symbol_key key;
-    const struct rb_entry *entry;
 
     if (shader_is_sm_5_1(compiler))
     {
         key.descriptor_type = vkd3d_shader_descriptor_type_from_register_type(reg->type);
         key.idx = reg->idx[0].offset;
-        entry = rb_get(&compiler->sm51_resource_table, &key);
-        if (entry)
+        symbol = (const struct vkd3d_sm51_symbol *)hash_map_find(&compiler->sm51_resource_table, &key);
+        if (symbol)
         {
-            symbol = RB_ENTRY_VALUE(entry, const struct vkd3d_sm51_symbol, entry);
             *reg_space = symbol->register_space;
             *reg_binding = symbol->resource_idx;
             return true;
@@ -2675,17 +2654,63 @@ static void vkd3d_dxbc_compiler_emit_descriptor_binding_for_reg(struct vkd3d_dxb
     vkd3d_dxbc_compiler_emit_descriptor_binding(compiler, variable_id, &binding);
 }
 
+static struct vkd3d_symbol *vkd3d_dxbc_compiler_find_symbol(struct vkd3d_dxbc_compiler *compiler,
+        const struct vkd3d_symbol *key)
+{
+    const struct vkd3d_symbol_table_entry *e;
+
+    if (!(e = (const struct vkd3d_symbol_table_entry *)hash_map_find(&compiler->symbol_table, key)))
+        return NULL;
+    return e->symbol;
+}
+
+static bool vkd3d_dxbc_compiler_insert_symbol(struct vkd3d_dxbc_compiler *compiler,
+        struct vkd3d_symbol *symbol)
+{
+    const struct vkd3d_symbol_table_entry *e;
+    struct vkd3d_symbol_table_entry entry;
+
+    entry.symbol = symbol;
+    if (!(e = (const struct vkd3d_symbol_table_entry *)hash_map_insert(&compiler->symbol_table, symbol, &entry.entry)))
+        return false;
+    return e->symbol == symbol;
+}
+
+static void vkd3d_dxbc_compiler_remove_symbol(struct vkd3d_dxbc_compiler *compiler,
+        const struct vkd3d_symbol *symbol)
+{
+    struct hash_map_entry *e;
+
+    if ((e = hash_map_find(&compiler->symbol_table, symbol)))
+        hash_map_remove(&compiler->symbol_table, e);
+}
+
+static void vkd3d_dxbc_compiler_put_sm51_symbol(struct vkd3d_dxbc_compiler *compiler,
+        enum vkd3d_shader_descriptor_type descriptor_type, unsigned int idx,
+        unsigned int register_space, unsigned int resource_idx)
+{
+    struct vkd3d_sm51_symbol sym;
+
+    memset(&sym, 0, sizeof(sym));
+    sym.key.descriptor_type = descriptor_type;
+    sym.key.idx = idx;
+    sym.register_space = register_space;
+    sym.resource_idx = resource_idx;
+
+    /* Redeclarations keep the first entry. */
+    if (!hash_map_insert(&compiler->sm51_resource_table, &sym.key, &sym.entry))
+        ERR("Failed to insert SM 5.1 resource entry.\n");
+}
+
 static void vkd3d_dxbc_compiler_put_symbol(struct vkd3d_dxbc_compiler *compiler,
         const struct vkd3d_symbol *symbol)
 {
     struct vkd3d_symbol *s;
 
-    s = vkd3d_symbol_dup(symbol);
-    if (rb_put(&compiler->symbol_table, s, &s->entry) == -1)
-    {
+    if (!(s = vkd3d_symbol_dup(&compiler->spirv_builder.arena, symbol)))
+        return;
+    if (!vkd3d_dxbc_compiler_insert_symbol(compiler, s))
         ERR("Failed to insert symbol entry (%s).\n", debug_vkd3d_symbol(symbol));
-        vkd3d_free(s);
-    }
 }
 
 static uint32_t vkd3d_dxbc_compiler_get_constant(struct vkd3d_dxbc_compiler *compiler,
@@ -3110,7 +3135,7 @@ static bool vkd3d_dxbc_compiler_find_register_info(const struct vkd3d_dxbc_compi
         const struct vkd3d_shader_register *reg, struct vkd3d_shader_register_info *register_info)
 {
     struct vkd3d_symbol reg_symbol, *symbol;
-    struct rb_entry *entry;
+    struct vkd3d_symbol *entry;
 
     assert(reg->type != VKD3DSPR_IMMCONST && reg->type != VKD3DSPR_IMMCONST64);
 
@@ -3131,13 +3156,13 @@ static bool vkd3d_dxbc_compiler_find_register_info(const struct vkd3d_dxbc_compi
     }
 
     vkd3d_symbol_make_register(&reg_symbol, reg);
-    if (!(entry = rb_get(&compiler->symbol_table, &reg_symbol)))
+    if (!(entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
     {
         memset(register_info, 0, sizeof(*register_info));
         return false;
     }
 
-    symbol = RB_ENTRY_VALUE(entry, struct vkd3d_symbol, entry);
+    symbol = entry;
     register_info->id = symbol->id;
     register_info->storage_class = symbol->info.reg.storage_class;
     register_info->member_idx = symbol->info.reg.member_idx;
@@ -3485,6 +3510,28 @@ static uint32_t vkd3d_dxbc_compiler_load_root_descriptor_va(struct vkd3d_dxbc_co
     return vkd3d_spirv_build_op_bitcast(builder, type_id, var_id);
 }
 
+static const struct vkd3d_shader_root_constant_specialization *vkd3d_dxbc_compiler_find_root_constant_specialization(
+        struct vkd3d_dxbc_compiler *compiler, uint32_t member_idx)
+{
+    const struct vkd3d_shader_compile_arguments *args = compiler->compile_args;
+    uint32_t offset;
+    unsigned int i;
+
+    if (!args || !args->root_constant_specialization_count || !compiler->push_constant_member_offsets)
+        return NULL;
+
+    if ((offset = compiler->push_constant_member_offsets[member_idx]) == ~0u)
+        return NULL;
+
+    for (i = 0; i < args->root_constant_specialization_count; i++)
+    {
+        if (args->root_constant_specializations[i].offset == offset)
+            return &args->root_constant_specializations[i];
+    }
+
+    return NULL;
+}
+
 static uint32_t vkd3d_dxbc_compiler_emit_load_constant_buffer(struct vkd3d_dxbc_compiler *compiler,
         const struct vkd3d_shader_register *reg, const struct vkd3d_shader_register_info *register_info,
         DWORD swizzle, DWORD write_mask)
@@ -3543,6 +3590,15 @@ static uint32_t vkd3d_dxbc_compiler_emit_load_constant_buffer(struct vkd3d_dxbc_
 
             if (index < compiler->push_constant_member_count)
             {
+                const struct vkd3d_shader_root_constant_specialization *spec;
+
+                if ((spec = vkd3d_dxbc_compiler_find_root_constant_specialization(compiler, index)))
+                {
+                    component_ids[j++] = vkd3d_spirv_get_op_constant(builder, type_id, &spec->value, 1);
+                    continue;
+                }
+
+                compiler->uses_root_constants = true;
                 indexes[last_index] = vkd3d_dxbc_compiler_get_constant_uint(compiler, index);
             }
             else
@@ -4730,7 +4786,7 @@ static uint32_t vkd3d_dxbc_compiler_emit_input(struct vkd3d_dxbc_compiler *compi
     struct vkd3d_symbol reg_symbol;
     struct vkd3d_symbol tmp_symbol;
     SpvStorageClass storage_class;
-    struct rb_entry *entry = NULL;
+    struct vkd3d_symbol *entry = NULL;
     bool use_private_var = false;
     unsigned int write_mask;
     unsigned int array_size;
@@ -4800,11 +4856,11 @@ static uint32_t vkd3d_dxbc_compiler_emit_input(struct vkd3d_dxbc_compiler *compi
     if (builtin)
     {
         input_id = vkd3d_dxbc_compiler_emit_builtin_variable(compiler, builtin, storage_class, array_size);
-        entry = rb_get(&compiler->symbol_table, &reg_symbol);
+        entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol);
     }
-    else if ((entry = rb_get(&compiler->symbol_table, &reg_symbol)))
+    else if ((entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
     {
-        input_id = RB_ENTRY_VALUE(entry, const struct vkd3d_symbol, entry)->id;
+        input_id = entry->id;
 
         if (use_private_var)
         {
@@ -4823,9 +4879,9 @@ static uint32_t vkd3d_dxbc_compiler_emit_input(struct vkd3d_dxbc_compiler *compi
             tmp_symbol = reg_symbol;
             tmp_symbol.key.reg.type = VKD3DSPR_INPUT;
 
-            if ((entry = rb_get(&compiler->symbol_table, &tmp_symbol)))
+            if ((entry = vkd3d_dxbc_compiler_find_symbol(compiler, &tmp_symbol)))
             {
-                tmp_symbol = *RB_ENTRY_VALUE(entry, const struct vkd3d_symbol, entry);
+                tmp_symbol = *entry;
                 tmp_symbol.key.reg.type = VKD3DSPR_INCONTROLPOINT;
                 vkd3d_dxbc_compiler_put_symbol(compiler, &tmp_symbol);
 
@@ -4924,7 +4980,7 @@ static void vkd3d_dxbc_compiler_emit_input_register(struct vkd3d_dxbc_compiler *
     struct vkd3d_symbol reg_symbol;
     SpvStorageClass storage_class;
     uint32_t input_id, var_id;
-    struct rb_entry *entry;
+    struct vkd3d_symbol *entry;
 
     assert(!reg->idx[0].rel_addr);
     assert(!reg->idx[1].rel_addr);
@@ -4941,7 +4997,7 @@ static void vkd3d_dxbc_compiler_emit_input_register(struct vkd3d_dxbc_compiler *
 
     /* vPrim may be declared in multiple hull shader phases. */
     vkd3d_symbol_make_register(&reg_symbol, reg);
-    if ((entry = rb_get(&compiler->symbol_table, &reg_symbol)))
+    if ((entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
         return;
 
     input_id = vkd3d_dxbc_compiler_emit_builtin_variable(compiler, builtin, SpvStorageClassInput, 0);
@@ -5214,7 +5270,7 @@ static void vkd3d_dxbc_compiler_emit_output(struct vkd3d_dxbc_compiler *compiler
     bool apply_patch_decoration = true;
     struct vkd3d_symbol reg_symbol;
     SpvStorageClass storage_class;
-    struct rb_entry *entry = NULL;
+    struct vkd3d_symbol *entry = NULL;
     unsigned int signature_idx;
     bool use_private_variable;
     unsigned int write_mask;
@@ -5284,12 +5340,12 @@ static void vkd3d_dxbc_compiler_emit_output(struct vkd3d_dxbc_compiler *compiler
         {
             use_private_variable = true;
             write_mask = VKD3DSP_WRITEMASK_ALL;
-            entry = rb_get(&compiler->symbol_table, &reg_symbol);
+            entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol);
         }
     }
-    else if (!use_private_variable && (entry = rb_get(&compiler->symbol_table, &reg_symbol)))
+    else if (!use_private_variable && (entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
     {
-        id = RB_ENTRY_VALUE(entry, const struct vkd3d_symbol, entry)->id;
+        id = entry->id;
     }
     else
     {
@@ -5333,8 +5389,8 @@ static void vkd3d_dxbc_compiler_emit_output(struct vkd3d_dxbc_compiler *compiler
     if (use_private_variable)
         storage_class = SpvStorageClassPrivate;
 
-    if (entry || (entry = rb_get(&compiler->symbol_table, &reg_symbol)))
-        var_id = RB_ENTRY_VALUE(entry, const struct vkd3d_symbol, entry)->id;
+    if (entry || (entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
+        var_id = entry->id;
     else if (!use_private_variable)
         var_id = id;
     else if (is_patch_constant)
@@ -6623,6 +6679,10 @@ static void vkd3d_dxbc_compiler_emit_push_constant_buffers(struct vkd3d_dxbc_com
     if (!(member_ids = vkd3d_calloc(count, sizeof(*member_ids))))
         return;
 
+    /* Byte offset of every root constant member, used to look up specialized values. */
+    if ((compiler->push_constant_member_offsets = vkd3d_malloc(count * sizeof(*compiler->push_constant_member_offsets))))
+        memset(compiler->push_constant_member_offsets, 0xff, count * sizeof(*compiler->push_constant_member_offsets));
+
     uint_id = vkd3d_spirv_get_type_id(builder, VKD3D_TYPE_UINT, 1);
     float_id = vkd3d_spirv_get_type_id(builder, VKD3D_TYPE_FLOAT, 1);
     uint32x2_id = 0;
@@ -6700,6 +6760,9 @@ static void vkd3d_dxbc_compiler_emit_push_constant_buffers(struct vkd3d_dxbc_com
                     cb->pc.offset + sizeof(uint32_t) * k);
             vkd3d_spirv_build_op_member_name(builder, struct_id, j, "cb%u_%u", reg_idx, k);
 
+            if (compiler->push_constant_member_offsets)
+                compiler->push_constant_member_offsets[j] = cb->pc.offset + sizeof(uint32_t) * k;
+
             j += 1;
         }
     }
@@ -6739,16 +6802,8 @@ static void vkd3d_dxbc_compiler_emit_dcl_constant_buffer(struct vkd3d_dxbc_compi
     assert(!(instruction->flags & ~VKD3DSI_INDEXED_DYNAMIC));
 
     if (shader_is_sm_5_1(compiler))
-    {
-        struct vkd3d_sm51_symbol *sym;
-        sym = vkd3d_calloc(1, sizeof(*sym));
-        sym->key.idx = reg->idx[0].offset;
-        sym->key.descriptor_type = VKD3D_SHADER_DESCRIPTOR_TYPE_CBV;
-        sym->register_space = instruction->declaration.cb.register_space;
-        sym->resource_idx = instruction->declaration.cb.register_index;
-        if (rb_put(&compiler->sm51_resource_table, &sym->key, &sym->entry) == -1)
-            vkd3d_free(sym);
-    }
+        vkd3d_dxbc_compiler_put_sm51_symbol(compiler, VKD3D_SHADER_DESCRIPTOR_TYPE_CBV,
+                reg->idx[0].offset, instruction->declaration.cb.register_space, instruction->declaration.cb.register_index);
 
     if ((push_cb = vkd3d_dxbc_compiler_find_push_constant_buffer(compiler, cb)))
     {
@@ -6865,16 +6920,8 @@ static void vkd3d_dxbc_compiler_emit_dcl_sampler(struct vkd3d_dxbc_compiler *com
     struct vkd3d_symbol resource_symbol;
 
     if (shader_is_sm_5_1(compiler))
-    {
-        struct vkd3d_sm51_symbol *sym;
-        sym = vkd3d_calloc(1, sizeof(*sym));
-        sym->key.idx = reg->idx[0].offset;
-        sym->key.descriptor_type = VKD3D_SHADER_DESCRIPTOR_TYPE_SAMPLER;
-        sym->register_space = instruction->declaration.sampler.register_space;
-        sym->resource_idx = instruction->declaration.sampler.register_index;
-        if (rb_put(&compiler->sm51_resource_table, &sym->key, &sym->entry) == -1)
-            vkd3d_free(sym);
-    }
+        vkd3d_dxbc_compiler_put_sm51_symbol(compiler, VKD3D_SHADER_DESCRIPTOR_TYPE_SAMPLER,
+                reg->idx[0].offset, instruction->declaration.sampler.register_space, instruction->declaration.sampler.register_index);
 
     binding = vkd3d_dxbc_compiler_get_resource_binding(compiler, reg,
             vkd3d_binding_flags_from_resource_type(VKD3D_SHADER_RESOURCE_NONE, false));
@@ -7225,16 +7272,9 @@ static void vkd3d_dxbc_compiler_emit_dcl_resource(struct vkd3d_dxbc_compiler *co
     const struct vkd3d_shader_semantic *semantic = &instruction->declaration.semantic;
 
     if (shader_is_sm_5_1(compiler))
-    {
-        struct vkd3d_sm51_symbol *sym;
-        sym = vkd3d_calloc(1, sizeof(*sym));
-        sym->key.idx = semantic->reg.reg.idx[0].offset;
-        sym->key.descriptor_type = semantic->reg.reg.type == VKD3DSPR_UAV ? VKD3D_SHADER_DESCRIPTOR_TYPE_UAV : VKD3D_SHADER_DESCRIPTOR_TYPE_SRV;
-        sym->register_space = semantic->register_space;
-        sym->resource_idx = semantic->register_index;
-        if (rb_put(&compiler->sm51_resource_table, &sym->key, &sym->entry) == -1)
-            vkd3d_free(sym);
-    }
+        vkd3d_dxbc_compiler_put_sm51_symbol(compiler,
+                semantic->reg.reg.type == VKD3DSPR_UAV ? VKD3D_SHADER_DESCRIPTOR_TYPE_UAV : VKD3D_SHADER_DESCRIPTOR_TYPE_SRV,
+                semantic->reg.reg.idx[0].offset, semantic->register_space, semantic->register_index);
 
     vkd3d_dxbc_compiler_emit_resource_declaration(compiler, instruction, &semantic->reg.reg,
             semantic->resource_type, semantic->resource_data_type, 0, false);
@@ -7246,16 +7286,9 @@ static void vkd3d_dxbc_compiler_emit_dcl_resource_raw(struct vkd3d_dxbc_compiler
     const struct vkd3d_shader_raw_resource *resource = &instruction->declaration.raw_resource;
 
     if (shader_is_sm_5_1(compiler))
-    {
-        struct vkd3d_sm51_symbol *sym;
-        sym = vkd3d_calloc(1, sizeof(*sym));
-        sym->key.idx = resource->dst.reg.idx[0].offset;
-        sym->key.descriptor_type = resource->dst.reg.type == VKD3DSPR_UAV ? VKD3D_SHADER_DESCRIPTOR_TYPE_UAV : VKD3D_SHADER_DESCRIPTOR_TYPE_SRV;
-        sym->register_space = resource->register_space;
-        sym->resource_idx = resource->register_index;
-        if (rb_put(&compiler->sm51_resource_table, &sym->key, &sym->entry) == -1)
-            vkd3d_free(sym);
-    }
+        vkd3d_dxbc_compiler_put_sm51_symbol(compiler,
+                resource->dst.reg.type == VKD3DSPR_UAV ? VKD3D_SHADER_DESCRIPTOR_TYPE_UAV : VKD3D_SHADER_DESCRIPTOR_TYPE_SRV,
+                resource->dst.reg.idx[0].offset, resource->register_space, resource->register_index);
 
     vkd3d_dxbc_compiler_emit_resource_declaration(compiler, instruction, &resource->dst.reg,
             VKD3D_SHADER_RESOURCE_BUFFER, VKD3D_DATA_UINT, 0, true);
@@ -7269,16 +7302,9 @@ static void vkd3d_dxbc_compiler_emit_dcl_resource_structured(struct vkd3d_dxbc_c
     unsigned int stride = resource->byte_stride;
 
     if (shader_is_sm_5_1(compiler))
-    {
-        struct vkd3d_sm51_symbol *sym;
-        sym = vkd3d_calloc(1, sizeof(*sym));
-        sym->key.idx = resource->reg.reg.idx[0].offset;
-        sym->key.descriptor_type = resource->reg.reg.type == VKD3DSPR_UAV ? VKD3D_SHADER_DESCRIPTOR_TYPE_UAV : VKD3D_SHADER_DESCRIPTOR_TYPE_SRV;
-        sym->register_space = resource->register_space;
-        sym->resource_idx = resource->register_index;
-        if (rb_put(&compiler->sm51_resource_table, &sym->key, &sym->entry) == -1)
-            vkd3d_free(sym);
-    }
+        vkd3d_dxbc_compiler_put_sm51_symbol(compiler,
+                resource->reg.reg.type == VKD3DSPR_UAV ? VKD3D_SHADER_DESCRIPTOR_TYPE_UAV : VKD3D_SHADER_DESCRIPTOR_TYPE_SRV,
+                resource->reg.reg.idx[0].offset, resource->register_space, resource->register_index);
 
     vkd3d_dxbc_compiler_emit_resource_declaration(compiler, instruction, reg,
             VKD3D_SHADER_RESOURCE_BUFFER, VKD3D_DATA_UINT, stride / 4, false);
@@ -7614,7 +7640,7 @@ static void vkd3d_dxbc_compiler_leave_shader_phase(struct vkd3d_dxbc_compiler *c
     struct vkd3d_spirv_builder *builder = &compiler->spirv_builder;
     struct vkd3d_symbol reg_symbol, *symbol;
     struct vkd3d_shader_register reg;
-    struct rb_entry *entry;
+    struct vkd3d_symbol *entry;
     unsigned int i;
 
     vkd3d_spirv_build_op_function_end(builder);
@@ -7652,11 +7678,11 @@ static void vkd3d_dxbc_compiler_leave_shader_phase(struct vkd3d_dxbc_compiler *c
             reg.type = VKD3DSPR_OUTPUT;
             reg.idx[0].offset = e->register_index;
             vkd3d_symbol_make_register(&reg_symbol, &reg);
-            if ((entry = rb_get(&compiler->symbol_table, &reg_symbol)))
+            if ((entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
             {
-                rb_remove(&compiler->symbol_table, entry);
+                vkd3d_dxbc_compiler_remove_symbol(compiler, entry);
 
-                symbol = RB_ENTRY_VALUE(entry, struct vkd3d_symbol, entry);
+                symbol = entry;
 
                 reg.type = VKD3DSPR_OUTCONTROLPOINT;
                 reg.idx[1].offset = reg.idx[0].offset;
@@ -7664,11 +7690,8 @@ static void vkd3d_dxbc_compiler_leave_shader_phase(struct vkd3d_dxbc_compiler *c
                 vkd3d_symbol_make_register(symbol, &reg);
                 symbol->info.reg.is_aggregate = false;
 
-                if (rb_put(&compiler->symbol_table, symbol, entry) == -1)
-                {
+                if (!vkd3d_dxbc_compiler_insert_symbol(compiler, symbol))
                     ERR("Failed to insert vocp symbol entry (%s).\n", debug_vkd3d_symbol(symbol));
-                    vkd3d_symbol_free(entry, NULL);
-                }
             }
         }
     }
@@ -7688,11 +7711,8 @@ static void vkd3d_dxbc_compiler_leave_shader_phase(struct vkd3d_dxbc_compiler *c
             reg.idx[0].offset = e->register_index;
             vkd3d_symbol_make_register(&reg_symbol, &reg);
 
-            if ((entry = rb_get(&compiler->symbol_table, &reg_symbol)))
-            {
-                rb_remove(&compiler->symbol_table, entry);
-                vkd3d_symbol_free(entry, NULL);
-            }
+            if ((entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
+                vkd3d_dxbc_compiler_remove_symbol(compiler, entry);
         }
     }
 
@@ -7701,11 +7721,8 @@ static void vkd3d_dxbc_compiler_leave_shader_phase(struct vkd3d_dxbc_compiler *c
         reg.type = phase->type == VKD3DSIH_HS_FORK_PHASE ? VKD3DSPR_FORKINSTID : VKD3DSPR_JOININSTID;
         reg.idx[0].offset = ~0u;
         vkd3d_symbol_make_register(&reg_symbol, &reg);
-        if ((entry = rb_get(&compiler->symbol_table, &reg_symbol)))
-        {
-            rb_remove(&compiler->symbol_table, entry);
-            vkd3d_symbol_free(entry, NULL);
-        }
+        if ((entry = vkd3d_dxbc_compiler_find_symbol(compiler, &reg_symbol)))
+            vkd3d_dxbc_compiler_remove_symbol(compiler, entry);
     }
 }
 
@@ -9207,12 +9224,12 @@ static const struct vkd3d_symbol *vkd3d_dxbc_compiler_find_resource(struct vkd3d
         const struct vkd3d_shader_register *resource_reg)
 {
     struct vkd3d_symbol resource_key;
-    struct rb_entry *entry;
+    struct vkd3d_symbol *entry;
 
     vkd3d_symbol_make_resource(&resource_key, resource_reg);
-    entry = rb_get(&compiler->symbol_table, &resource_key);
+    entry = vkd3d_dxbc_compiler_find_symbol(compiler, &resource_key);
     assert(entry);
-    return RB_ENTRY_VALUE(entry, struct vkd3d_symbol, entry);
+    return entry;
 }
 
 static uint32_t vkd3d_dxbc_compiler_load_descriptor_table_offset(struct vkd3d_dxbc_compiler *compiler,
@@ -11607,6 +11624,9 @@ int vkd3d_dxbc_compiler_generate_spirv(struct vkd3d_dxbc_compiler *compiler,
 
     vkd3d_shader_extract_feature_meta(spirv);
 
+    if (compiler->uses_root_constants)
+        spirv->meta.flags |= VKD3D_SHADER_META_FLAG_USES_ROOT_CONSTANTS;
+
     return VKD3D_OK;
 }
 
@@ -11620,14 +11640,15 @@ void vkd3d_dxbc_compiler_destroy(struct vkd3d_dxbc_compiler *compiler)
 
     vkd3d_spirv_builder_free(&compiler->spirv_builder);
 
-    rb_destroy(&compiler->symbol_table, vkd3d_symbol_free, NULL);
-    rb_destroy(&compiler->sm51_resource_table, vkd3d_sm51_symbol_free, NULL);
+    hash_map_free(&compiler->symbol_table);
+    hash_map_free(&compiler->sm51_resource_table);
 
     vkd3d_free(compiler->shader_phases);
     vkd3d_free(compiler->spec_constants);
     vkd3d_free(compiler->global_bindings);
     vkd3d_free(compiler->buffer_ref_types);
     vkd3d_free(compiler->root_descriptor_info);
+    vkd3d_free(compiler->push_constant_member_offsets);
 
     vkd3d_free(compiler);
 }
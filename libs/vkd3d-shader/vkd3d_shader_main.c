@@ -22,9 +22,170 @@
 #include "vkd3d_string.h"
 
 #include "vkd3d_platform.h"
+#include "vkd3d_threads.h"
 
 #include <stdio.h>
 #include <inttypes.h>
+#include <time.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+/* Environment variables are queried once, compilation is far too hot to do it per shader. */
+struct vkd3d_shader_env
+{
+    char override_path[VKD3D_PATH_MAX];
+    char dump_path[VKD3D_PATH_MAX];
+    bool has_override_path;
+    bool has_dump_path;
+};
+
+static struct vkd3d_shader_env vkd3d_shader_env;
+static pthread_once_t vkd3d_shader_env_once = PTHREAD_ONCE_INIT;
+
+static void vkd3d_shader_env_init_once(void)
+{
+    vkd3d_shader_env.has_override_path = vkd3d_get_env_var("VKD3D_SHADER_OVERRIDE",
+            vkd3d_shader_env.override_path, sizeof(vkd3d_shader_env.override_path));
+    vkd3d_shader_env.has_dump_path = vkd3d_get_env_var("VKD3D_SHADER_DUMP_PATH",
+            vkd3d_shader_env.dump_path, sizeof(vkd3d_shader_env.dump_path));
+}
+
+static const struct vkd3d_shader_env *vkd3d_shader_get_env(void)
+{
+    pthread_once(&vkd3d_shader_env_once, vkd3d_shader_env_init_once);
+    return &vkd3d_shader_env;
+}
+
+/* Set of hashes which have at least one file in the override directory, so that
+ * compiling shaders without an override does not cost a failing fopen() each.
+ * The directory is polled for changes at most this often to support hot reload. */
+#define VKD3D_SHADER_OVERRIDE_RESCAN_INTERVAL_NS 1000000000ull
+
+struct vkd3d_shader_override_index
+{
+    pthread_mutex_t lock;
+    vkd3d_shader_hash_t *hashes;
+    size_t hashes_count;
+    size_t hashes_size;
+    time_t dir_mtime;
+    time_t scan_time;
+    uint64_t next_check_ns;
+    bool valid;
+};
+
+static struct vkd3d_shader_override_index vkd3d_shader_override_index = { PTHREAD_MUTEX_INITIALIZER };
+
+static int vkd3d_shader_hash_compare(const void *a, const void *b)
+{
+    vkd3d_shader_hash_t x = *(const vkd3d_shader_hash_t *)a;
+    vkd3d_shader_hash_t y = *(const vkd3d_shader_hash_t *)b;
+
+    if (x != y)
+        return x < y ? -1 : 1;
+    return 0;
+}
+
+static void vkd3d_shader_override_index_add_file(struct vkd3d_shader_override_index *index, const char *name)
+{
+    vkd3d_shader_hash_t hash = 0;
+    size_t len = strlen(name);
+    unsigned int i;
+    char c;
+
+    /* Either <hash>.spv or <hash>.lib.<export>.spv. */
+    if (len < 16 + 4 || name[16] != '.' || strcmp(name + len - 4, ".spv"))
+        return;
+
+    for (i = 0; i < 16; i++)
+    {
+        c = name[i];
+        if (c >= '0' && c <= '9')
+            hash = (hash << 4) | (c - '0');
+        else if (c >= 'a' && c <= 'f')
+            hash = (hash << 4) | (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            hash = (hash << 4) | (c - 'A' + 10);
+        else
+            return;
+    }
+
+    if (!vkd3d_array_reserve((void **)&index->hashes, &index->hashes_size,
+            index->hashes_count + 1, sizeof(*index->hashes)))
+        return;
+
+    index->hashes[index->hashes_count++] = hash;
+}
+
+static void vkd3d_shader_override_index_scan(struct vkd3d_shader_override_index *index, const char *path)
+{
+#ifdef _WIN32
+    WIN32_FIND_DATAA find_data;
+    char pattern[VKD3D_PATH_MAX];
+    HANDLE handle;
+#else
+    struct dirent *entry;
+    DIR *dir;
+#endif
+
+    index->hashes_count = 0;
+
+#ifdef _WIN32
+    snprintf(pattern, sizeof(pattern), "%s/*.spv", path);
+    if ((handle = FindFirstFileA(pattern, &find_data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            vkd3d_shader_override_index_add_file(index, find_data.cFileName);
+        } while (FindNextFileA(handle, &find_data));
+        FindClose(handle);
+    }
+#else
+    if ((dir = opendir(path)))
+    {
+        while ((entry = readdir(dir)))
+            vkd3d_shader_override_index_add_file(index, entry->d_name);
+        closedir(dir);
+    }
+#endif
+
+    qsort(index->hashes, index->hashes_count, sizeof(*index->hashes), vkd3d_shader_hash_compare);
+    INFO("Found %zu shader override files in %s.\n", index->hashes_count, path);
+}
+
+static bool vkd3d_shader_override_index_contains(const char *path, vkd3d_shader_hash_t hash)
+{
+    struct vkd3d_shader_override_index *index = &vkd3d_shader_override_index;
+    struct stat st;
+    uint64_t now;
+    bool found;
+
+    pthread_mutex_lock(&index->lock);
+
+    now = vkd3d_get_current_time_ns();
+    if (!index->valid || now >= index->next_check_ns)
+    {
+        index->next_check_ns = now + VKD3D_SHADER_OVERRIDE_RESCAN_INTERVAL_NS;
+
+        if (stat(path, &st))
+            st.st_mtime = 0;
+
+        /* Modifications within the second of the last scan may not show up in the mtime, rescan once more. */
+        if (!index->valid || st.st_mtime != index->dir_mtime || st.st_mtime >= index->scan_time)
+        {
+            index->dir_mtime = st.st_mtime;
+            index->scan_time = time(NULL);
+            vkd3d_shader_override_index_scan(index, path);
+            index->valid = true;
+        }
+    }
+
+    found = bsearch(&hash, index->hashes, index->hashes_count,
+            sizeof(*index->hashes), vkd3d_shader_hash_compare) != NULL;
+    pthread_mutex_unlock(&index->lock);
+    return found;
+}
 
 static void vkd3d_shader_dump_blob(const char *path, vkd3d_shader_hash_t hash, const void *data, size_t size, const char *ext)
 {
@@ -83,94 +244,110 @@ err:
 
 bool vkd3d_shader_replace(vkd3d_shader_hash_t hash, const void **data, size_t *size)
 {
-    static bool enabled = true;
-    char path[VKD3D_PATH_MAX];
+    const struct vkd3d_shader_env *env = vkd3d_shader_get_env();
     char filename[1024];
 
-    if (!enabled)
-        return false;
-
-    if (!vkd3d_get_env_var("VKD3D_SHADER_OVERRIDE", path, sizeof(path)))
-    {
-        enabled = false;
+    if (!env->has_override_path || !vkd3d_shader_override_index_contains(env->override_path, hash))
         return false;
-    }
 
-    snprintf(filename, ARRAY_SIZE(filename), "%s/%016"PRIx64".spv", path, hash);
+    snprintf(filename, ARRAY_SIZE(filename), "%s/%016"PRIx64".spv", env->override_path, hash);
     return vkd3d_shader_replace_path(filename, hash, data, size);
 }
 
 bool vkd3d_shader_replace_export(vkd3d_shader_hash_t hash, const void **data, size_t *size, const char *export)
 {
-    static bool enabled = true;
-    char path[VKD3D_PATH_MAX];
+    const struct vkd3d_shader_env *env = vkd3d_shader_get_env();
     char filename[1024];
 
-    if (!enabled)
-        return false;
-
-    if (!vkd3d_get_env_var("VKD3D_SHADER_OVERRIDE", path, sizeof(path)))
-    {
-        enabled = false;
+    if (!env->has_override_path || !vkd3d_shader_override_index_contains(env->override_path, hash))
         return false;
-    }
 
-    snprintf(filename, ARRAY_SIZE(filename), "%s/%016"PRIx64".lib.%s.spv", path, hash, export);
+    snprintf(filename, ARRAY_SIZE(filename), "%s/%016"PRIx64".lib.%s.spv", env->override_path, hash, export);
     return vkd3d_shader_replace_path(filename, hash, data, size);
 }
 
 void vkd3d_shader_dump_shader(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader, const char *ext)
 {
-    static bool enabled = true;
-    char path[VKD3D_PATH_MAX];
+    const struct vkd3d_shader_env *env = vkd3d_shader_get_env();
 
-    if (!enabled)
-        return;
+    if (env->has_dump_path)
+        vkd3d_shader_dump_blob(env->dump_path, hash, shader->code, shader->size, ext);
+}
 
-    if (!vkd3d_get_env_var("VKD3D_SHADER_DUMP_PATH", path, sizeof(path)))
-    {
-        enabled = false;
-        return;
-    }
+void vkd3d_shader_dump_spirv_shader(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader)
+{
+    const struct vkd3d_shader_env *env = vkd3d_shader_get_env();
 
-    vkd3d_shader_dump_blob(path, hash, shader->code, shader->size, ext);
+    if (env->has_dump_path)
+        vkd3d_shader_dump_blob(env->dump_path, hash, shader->code, shader->size, "spv");
 }
 
-void vkd3d_shader_dump_spirv_shader(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader)
+void vkd3d_shader_dump_spirv_shader_export(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader,
+        const char *export)
 {
-    static bool enabled = true;
-    char path[VKD3D_PATH_MAX];
+    const struct vkd3d_shader_env *env = vkd3d_shader_get_env();
+    char tag[1024];
 
-    if (!enabled)
+    if (!env->has_dump_path)
         return;
 
-    if (!vkd3d_get_env_var("VKD3D_SHADER_DUMP_PATH", path, sizeof(path)))
+    snprintf(tag, sizeof(tag), "lib.%s.spv", export);
+    vkd3d_shader_dump_blob(env->dump_path, hash, shader->code, shader->size, tag);
+}
+
+#define VKD3D_SHADER_ARENA_BLOCK_SIZE (16 * 1024)
+#define VKD3D_SHADER_ARENA_ALIGNMENT 16
+
+struct vkd3d_shader_arena_block
+{
+    struct vkd3d_shader_arena_block *next;
+    size_t size;
+    size_t offset;
+};
+
+void vkd3d_shader_arena_init(struct vkd3d_shader_arena *arena)
+{
+    arena->blocks = NULL;
+}
+
+void *vkd3d_shader_arena_alloc(struct vkd3d_shader_arena *arena, size_t size)
+{
+    const size_t header_size = align(sizeof(struct vkd3d_shader_arena_block), VKD3D_SHADER_ARENA_ALIGNMENT);
+    struct vkd3d_shader_arena_block *block = arena->blocks;
+    size_t block_size;
+    void *ptr;
+
+    size = align(size, VKD3D_SHADER_ARENA_ALIGNMENT);
+
+    if (!block || block->offset + size > block->size)
     {
-        enabled = false;
-        return;
+        block_size = max(size, VKD3D_SHADER_ARENA_BLOCK_SIZE - header_size);
+
+        if (!(block = vkd3d_malloc(header_size + block_size)))
+            return NULL;
+
+        block->next = arena->blocks;
+        block->size = block_size;
+        block->offset = 0;
+        arena->blocks = block;
     }
 
-    vkd3d_shader_dump_blob(path, hash, shader->code, shader->size, "spv");
+    ptr = void_ptr_offset(block, header_size + block->offset);
+    block->offset += size;
+    return ptr;
 }
 
-void vkd3d_shader_dump_spirv_shader_export(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader,
-        const char *export)
+void vkd3d_shader_arena_cleanup(struct vkd3d_shader_arena *arena)
 {
-    static bool enabled = true;
-    char path[VKD3D_PATH_MAX];
-    char tag[1024];
-
-    if (!enabled)
-        return;
+    struct vkd3d_shader_arena_block *block, *next;
 
-    if (!vkd3d_get_env_var("VKD3D_SHADER_DUMP_PATH", path, sizeof(path)))
+    for (block = arena->blocks; block; block = next)
     {
-        enabled = false;
-        return;
+        next = block->next;
+        vkd3d_free(block);
     }
 
-    snprintf(tag, sizeof(tag), "lib.%s.spv", export);
-    vkd3d_shader_dump_blob(path, hash, shader->code, shader->size, tag);
+    arena->blocks = NULL;
 }
 
 struct vkd3d_shader_parser
@@ -362,6 +539,9 @@ static int vkd3d_shader_validate_shader_type(enum vkd3d_shader_type type, VkShad
     return 0;
 }
 
+static void vkd3d_shader_scan_instruction(struct vkd3d_shader_scan_info *scan_info,
+        const struct vkd3d_shader_instruction *instruction);
+
 int vkd3d_shader_compile_dxbc(const struct vkd3d_shader_code *dxbc,
         struct vkd3d_shader_code *spirv,
         struct vkd3d_shader_code_debug *spirv_debug,
@@ -369,11 +549,12 @@ int vkd3d_shader_compile_dxbc(const struct vkd3d_shader_code *dxbc,
         const struct vkd3d_shader_interface_info *shader_interface_info,
         const struct vkd3d_shader_compile_arguments *compile_args)
 {
-    struct vkd3d_shader_instruction instruction;
+    struct vkd3d_shader_instruction_array instructions;
     struct vkd3d_dxbc_compiler *spirv_compiler;
     struct vkd3d_shader_scan_info scan_info;
     struct vkd3d_shader_parser parser;
     vkd3d_shader_hash_t hash;
+    size_t i;
     int ret;
 
     TRACE("dxbc {%p, %zu}, spirv %p, compiler_options %#x, shader_interface_info %p, compile_args %p.\n",
@@ -400,56 +581,47 @@ int vkd3d_shader_compile_dxbc(const struct vkd3d_shader_code *dxbc,
 
     vkd3d_shader_dump_shader(hash, dxbc, "dxbc");
 
-    vkd3d_shader_scan_init(&scan_info);
-
-    if ((ret = vkd3d_shader_scan_dxbc(dxbc, &scan_info)) < 0)
-    {
-        vkd3d_shader_scan_destroy(&scan_info);
-        return ret;
-    }
-
-    spirv->meta.patch_vertex_count = scan_info.patch_vertex_count;
-
     if ((ret = vkd3d_shader_parser_init(&parser, dxbc)) < 0)
-    {
-        vkd3d_shader_scan_destroy(&scan_info);
         return ret;
-    }
 
     if (shader_interface_info)
     {
         if ((ret = vkd3d_shader_validate_shader_type(parser.shader_version.type, shader_interface_info->stage)) < 0)
         {
-            vkd3d_shader_scan_destroy(&scan_info);
             vkd3d_shader_parser_destroy(&parser);
             return ret;
         }
     }
 
+    /* Decode the token stream once and run both the scan and SPIR-V emission over it. */
+    memset(&instructions, 0, sizeof(instructions));
+    if ((ret = shader_sm4_read_instructions(parser.data, &parser.ptr, &instructions)) < 0)
+    {
+        vkd3d_free(instructions.instructions);
+        vkd3d_shader_parser_destroy(&parser);
+        return ret;
+    }
+
+    vkd3d_shader_scan_init(&scan_info);
+    for (i = 0; i < instructions.count; ++i)
+        vkd3d_shader_scan_instruction(&scan_info, &instructions.instructions[i]);
+
+    spirv->meta.patch_vertex_count = scan_info.patch_vertex_count;
+
     if (!(spirv_compiler = vkd3d_dxbc_compiler_create(&parser.shader_version,
             &parser.shader_desc, compiler_options, shader_interface_info, compile_args, &scan_info,
             spirv->meta.hash)))
     {
         ERR("Failed to create DXBC compiler.\n");
         vkd3d_shader_scan_destroy(&scan_info);
+        vkd3d_free(instructions.instructions);
         vkd3d_shader_parser_destroy(&parser);
         return VKD3D_ERROR;
     }
 
-    while (!shader_sm4_is_end(parser.data, &parser.ptr))
+    for (i = 0; i < instructions.count; ++i)
     {
-        shader_sm4_read_instruction(parser.data, &parser.ptr, &instruction);
-
-        if (instruction.handler_idx == VKD3DSIH_INVALID)
-        {
-            WARN("Encountered unrecognized or invalid instruction.\n");
-            vkd3d_dxbc_compiler_destroy(spirv_compiler);
-            vkd3d_shader_scan_destroy(&scan_info);
-            vkd3d_shader_parser_destroy(&parser);
-            return VKD3D_ERROR_INVALID_ARGUMENT;
-        }
-
-        if ((ret = vkd3d_dxbc_compiler_handle_instruction(spirv_compiler, &instruction)) < 0)
+        if ((ret = vkd3d_dxbc_compiler_handle_instruction(spirv_compiler, &instructions.instructions[i])) < 0)
             break;
     }
 
@@ -464,6 +636,7 @@ int vkd3d_shader_compile_dxbc(const struct vkd3d_shader_code *dxbc,
 
     vkd3d_dxbc_compiler_destroy(spirv_compiler);
     vkd3d_shader_scan_destroy(&scan_info);
+    vkd3d_free(instructions.instructions);
     vkd3d_shader_parser_destroy(&parser);
     return ret;
 }
@@ -824,16 +997,28 @@ vkd3d_shader_hash_t vkd3d_shader_hash(const struct vkd3d_shader_code *shader)
 uint32_t vkd3d_shader_compile_arguments_select_quirks(
         const struct vkd3d_shader_compile_arguments *compile_args, vkd3d_shader_hash_t shader_hash)
 {
-    unsigned int i;
-    if (compile_args && compile_args->quirks)
+    const struct vkd3d_shader_quirk_info *info;
+    unsigned int lo, hi, mid;
+
+    if (!compile_args || !(info = compile_args->quirks))
+        return 0;
+
+    lo = 0;
+    hi = info->num_hashes;
+
+    while (lo < hi)
     {
-        for (i = 0; i < compile_args->quirks->num_hashes; i++)
-            if (compile_args->quirks->hashes[i].shader_hash == shader_hash)
-                return compile_args->quirks->hashes[i].quirks | compile_args->quirks->global_quirks;
-        return compile_args->quirks->default_quirks | compile_args->quirks->global_quirks;
+        mid = lo + (hi - lo) / 2;
+
+        if (info->hashes[mid].shader_hash == shader_hash)
+            return info->hashes[mid].quirks | info->global_quirks;
+        else if (info->hashes[mid].shader_hash < shader_hash)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
-    else
-        return 0;
+
+    return info->default_quirks | info->global_quirks;
 }
 
 uint64_t vkd3d_shader_get_revision(void)
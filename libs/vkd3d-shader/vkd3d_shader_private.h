@@ -766,6 +766,19 @@ static inline bool vkd3d_shader_register_is_output(const struct vkd3d_shader_reg
 
 const char *shader_get_type_prefix(enum vkd3d_shader_type type);
 
+/* Per-compilation bump allocator. Allocations are never freed individually,
+ * the entire arena is released at once when the owning context is destroyed. */
+struct vkd3d_shader_arena_block;
+
+struct vkd3d_shader_arena
+{
+    struct vkd3d_shader_arena_block *blocks;
+};
+
+void vkd3d_shader_arena_init(struct vkd3d_shader_arena *arena);
+void *vkd3d_shader_arena_alloc(struct vkd3d_shader_arena *arena, size_t size);
+void vkd3d_shader_arena_cleanup(struct vkd3d_shader_arena *arena);
+
 void *shader_sm4_init(const DWORD *byte_code, size_t byte_code_size,
         const struct vkd3d_shader_signature *output_signature);
 void shader_sm4_free(void *data);
@@ -775,6 +788,18 @@ void shader_sm4_read_instruction(void *data, const DWORD **ptr,
         struct vkd3d_shader_instruction *ins);
 bool shader_sm4_is_end(void *data, const DWORD **ptr);
 
+/* Decoded instruction stream. Instructions reference parameters owned by the
+ * parser, so the array must not outlive it. */
+struct vkd3d_shader_instruction_array
+{
+    struct vkd3d_shader_instruction *instructions;
+    size_t size;
+    size_t count;
+};
+
+int shader_sm4_read_instructions(void *data, const DWORD **ptr,
+        struct vkd3d_shader_instruction_array *instructions);
+
 int shader_extract_from_dxbc(const void *dxbc, size_t dxbc_length,
         struct vkd3d_shader_desc *desc);
 bool shader_is_dxil(const void *dxbc, size_t dxbc_length);
@@ -799,8 +824,6 @@ int vkd3d_dxbc_compiler_generate_spirv(struct vkd3d_dxbc_compiler *compiler,
         struct vkd3d_shader_code *spirv);
 void vkd3d_dxbc_compiler_destroy(struct vkd3d_dxbc_compiler *compiler);
 
-void vkd3d_compute_dxbc_checksum(const void *dxbc, size_t size, uint32_t checksum[4]);
-
 void vkd3d_shader_dump_spirv_shader(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader);
 void vkd3d_shader_dump_spirv_shader_export(vkd3d_shader_hash_t hash, const struct vkd3d_shader_code *shader,
         const char *export);
@@ -21,9 +21,81 @@
 
 #define RT_TRACE TRACE
 
+#define VKD3D_BUILD_ARENA_MIN_BLOCK_SIZE (64 * 1024)
+
+static void *vkd3d_acceleration_structure_build_arena_alloc(
+        struct vkd3d_acceleration_structure_build_arena *arena, size_t size)
+{
+    size_t block_size;
+    void *ptr;
+
+    size = align(size, 16);
+
+    if (!arena->blocks_count || arena->block_offset + size > arena->block_size)
+    {
+        block_size = max(size, max(2 * arena->block_size, (size_t)VKD3D_BUILD_ARENA_MIN_BLOCK_SIZE));
+
+        if (!vkd3d_array_reserve((void **)&arena->blocks, &arena->blocks_size,
+                arena->blocks_count + 1, sizeof(*arena->blocks)))
+            return NULL;
+        if (!(ptr = vkd3d_malloc(block_size)))
+            return NULL;
+
+        /* Blocks cannot be reallocated since pending builds may point into them. */
+        arena->blocks[arena->blocks_count++] = ptr;
+        arena->block_size = block_size;
+        arena->block_offset = 0;
+        arena->total_size += block_size;
+    }
+
+    ptr = (uint8_t *)arena->blocks[arena->blocks_count - 1] + arena->block_offset;
+    arena->block_offset += size;
+    return ptr;
+}
+
+void vkd3d_acceleration_structure_build_arena_reset(struct vkd3d_acceleration_structure_build_arena *arena)
+{
+    size_t i;
+
+    /* If we had to chain blocks, replace them with one block that fits everything,
+     * so that the next round of builds does not have to allocate. */
+    if (arena->blocks_count > 1)
+    {
+        for (i = 0; i < arena->blocks_count; i++)
+            vkd3d_free(arena->blocks[i]);
+
+        if ((arena->blocks[0] = vkd3d_malloc(arena->total_size)))
+        {
+            arena->blocks_count = 1;
+            arena->block_size = arena->total_size;
+        }
+        else
+        {
+            arena->blocks_count = 0;
+            arena->block_size = 0;
+            arena->total_size = 0;
+        }
+    }
+
+    arena->block_offset = 0;
+}
+
+void vkd3d_acceleration_structure_build_arena_cleanup(struct vkd3d_acceleration_structure_build_arena *arena)
+{
+    size_t i;
+
+    for (i = 0; i < arena->blocks_count; i++)
+        vkd3d_free(arena->blocks[i]);
+    vkd3d_free(arena->blocks);
+    memset(arena, 0, sizeof(*arena));
+}
+
 void vkd3d_acceleration_structure_build_info_cleanup(
         struct vkd3d_acceleration_structure_build_info *info)
 {
+    if (info->uses_arena)
+        return;
+
     if (info->primitive_counts != info->primitive_counts_stack)
         vkd3d_free(info->primitive_counts);
     if (info->geometries != info->geometries_stack)
@@ -67,7 +139,8 @@ static VkGeometryFlagsKHR d3d12_geometry_flags_to_vk(D3D12_RAYTRACING_GEOMETRY_F
 
 bool vkd3d_acceleration_structure_convert_inputs(const struct d3d12_device *device,
         struct vkd3d_acceleration_structure_build_info *info,
-        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS *desc)
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS *desc,
+        struct vkd3d_acceleration_structure_build_arena *arena)
 {
     VkAccelerationStructureGeometryTrianglesDataKHR *triangles;
     VkAccelerationStructureBuildGeometryInfoKHR *build_info;
@@ -104,6 +177,7 @@ bool vkd3d_acceleration_structure_convert_inputs(const struct d3d12_device *devi
     else
         build_info->mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
 
+    info->uses_arena = false;
     info->geometries = info->geometries_stack;
     info->primitive_counts = info->primitive_counts_stack;
     info->build_ranges = info->build_range_stack;
@@ -137,6 +211,27 @@ bool vkd3d_acceleration_structure_convert_inputs(const struct d3d12_device *devi
             memset(info->geometries, 0, sizeof(*info->geometries) * desc->NumDescs);
             memset(info->primitive_counts, 0, sizeof(*info->primitive_counts) * desc->NumDescs);
         }
+        else if (arena)
+        {
+            info->geometries = vkd3d_acceleration_structure_build_arena_alloc(arena,
+                    desc->NumDescs * sizeof(*info->geometries));
+            info->primitive_counts = vkd3d_acceleration_structure_build_arena_alloc(arena,
+                    desc->NumDescs * sizeof(*info->primitive_counts));
+            info->build_ranges = vkd3d_acceleration_structure_build_arena_alloc(arena,
+                    desc->NumDescs * sizeof(*info->build_ranges));
+            info->build_range_ptrs = vkd3d_acceleration_structure_build_arena_alloc(arena,
+                    desc->NumDescs * sizeof(*info->build_range_ptrs));
+            info->uses_arena = true;
+
+            if (!info->geometries || !info->primitive_counts || !info->build_ranges || !info->build_range_ptrs)
+            {
+                ERR("Failed to allocate build info.\n");
+                return false;
+            }
+
+            memset(info->geometries, 0, sizeof(*info->geometries) * desc->NumDescs);
+            memset(info->primitive_counts, 0, sizeof(*info->primitive_counts) * desc->NumDescs);
+        }
         else
         {
             info->geometries = vkd3d_calloc(desc->NumDescs, sizeof(*info->geometries));
@@ -113,13 +113,9 @@ HRESULT vkd3d_breadcrumb_tracer_init(struct vkd3d_breadcrumb_tracer *tracer, str
     D3D12_RESOURCE_DESC1 resource_desc;
     VkMemoryPropertyFlags memory_props;
     HRESULT hr;
-    int rc;
 
     memset(tracer, 0, sizeof(*tracer));
 
-    if ((rc = pthread_mutex_init(&tracer->lock, NULL)))
-        return hresult_from_errno(rc);
-
     if (device->vk_info.NV_device_diagnostic_checkpoints)
     {
         INFO("Enabling NV_device_diagnostics_checkpoints breadcrumbs.\n");
@@ -194,6 +190,7 @@ err:
 void vkd3d_breadcrumb_tracer_cleanup(struct vkd3d_breadcrumb_tracer *tracer, struct d3d12_device *device)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    unsigned int i;
 
     if (device->vk_info.AMD_buffer_marker)
     {
@@ -201,37 +198,37 @@ void vkd3d_breadcrumb_tracer_cleanup(struct vkd3d_breadcrumb_tracer *tracer, str
         vkd3d_free_device_memory(device, &tracer->host_buffer_memory);
     }
 
+    if (tracer->trace_contexts)
+    {
+        for (i = 0; i < MAX_COMMAND_LISTS; i++)
+            vkd3d_free(tracer->trace_contexts[i].commands);
+    }
+
     vkd3d_free(tracer->trace_contexts);
-    pthread_mutex_destroy(&tracer->lock);
 }
 
 unsigned int vkd3d_breadcrumb_tracer_allocate_command_list(struct vkd3d_breadcrumb_tracer *tracer,
         struct d3d12_command_list *list, struct d3d12_command_allocator *allocator)
 {
+    struct vkd3d_breadcrumb_command_list_trace_context *trace;
     unsigned int index = UINT32_MAX;
     unsigned int iteration_count;
-    int rc;
-
-    if ((rc = pthread_mutex_lock(&tracer->lock)))
-    {
-        ERR("Failed to lock mutex, rc %d.\n", rc);
-        return UINT32_MAX;
-    }
+    unsigned int candidate;
 
     /* Since this is a ring, this is extremely likely to succeed on first attempt. */
     for (iteration_count = 0; iteration_count < MAX_COMMAND_LISTS; iteration_count++)
     {
-        tracer->trace_context_index = (tracer->trace_context_index + 1) % MAX_COMMAND_LISTS;
-        if (!tracer->trace_contexts[tracer->trace_context_index].locked)
+        candidate = vkd3d_atomic_uint32_increment(&tracer->trace_context_index, vkd3d_memory_order_relaxed) %
+                MAX_COMMAND_LISTS;
+
+        if (vkd3d_atomic_uint32_compare_exchange(&tracer->trace_contexts[candidate].locked, 0, 1,
+                vkd3d_memory_order_acquire, vkd3d_memory_order_relaxed) == 0)
         {
-            tracer->trace_contexts[tracer->trace_context_index].locked = 1;
-            index = tracer->trace_context_index;
+            index = candidate;
             break;
         }
     }
 
-    pthread_mutex_unlock(&tracer->lock);
-
     if (index == UINT32_MAX)
     {
         ERR("Failed to allocate new index for command list.\n");
@@ -243,8 +240,15 @@ unsigned int vkd3d_breadcrumb_tracer_allocate_command_list(struct vkd3d_breadcru
 
     /* Need to clear this on a fresh allocation rather than release, since we can end up releasing a command list
      * before we observe the device lost. */
-    tracer->trace_contexts[index].command_count = 0;
-    tracer->trace_contexts[index].counter = 0;
+    trace = &tracer->trace_contexts[index];
+    trace->command_count = 0;
+    trace->counter = 0;
+
+    if (!trace->command_size)
+    {
+        vkd3d_array_reserve((void **)&trace->commands, &trace->command_size,
+                VKD3D_BREADCRUMB_INITIAL_COMMAND_COUNT, sizeof(*trace->commands));
+    }
 
     if (!list->device->vk_info.NV_device_diagnostic_checkpoints && list->device->vk_info.AMD_buffer_marker)
         memset(&tracer->mapped[index], 0, sizeof(tracer->mapped[index]));
@@ -262,25 +266,14 @@ void vkd3d_breadcrumb_tracer_release_command_lists(struct vkd3d_breadcrumb_trace
 {
     unsigned int index;
     size_t i;
-    int rc;
-
-    if (!indices_count)
-        return;
-
-    if ((rc = pthread_mutex_lock(&tracer->lock)))
-    {
-        ERR("Failed to lock mutex, rc %d.\n", rc);
-        return;
-    }
 
     for (i = 0; i < indices_count; i++)
     {
         index = indices[i];
         if (index != UINT32_MAX)
-            tracer->trace_contexts[index].locked = 0;
+            vkd3d_atomic_uint32_store_explicit(&tracer->trace_contexts[index].locked, 0, vkd3d_memory_order_release);
         TRACE("Releasing breadcrumb context %u.\n", index);
     }
-    pthread_mutex_unlock(&tracer->lock);
 }
 
 static pthread_mutex_t global_report_lock = PTHREAD_MUTEX_INITIALIZER;
@@ -351,7 +344,7 @@ static void vkd3d_breadcrumb_tracer_report_command_list(
                     break;
 
                 case VKD3D_BREADCRUMB_COMMAND_SET_SHADER_HASH:
-                    ERR("    hash: %016"PRIx64", stage: %x\n", cmd->shader.hash, cmd->shader.stage);
+                    ERR("    hash: %016"PRIx64", stage: %x\n", cmd->shader_hash, cmd->shader_stage);
                     break;
 
                 default:
@@ -627,8 +620,12 @@ void vkd3d_breadcrumb_tracer_add_command(struct d3d12_command_list *list,
     TRACE("Adding command (%s) to context %u.\n",
             vkd3d_breadcrumb_command_type_to_str(command->type), context);
 
-    vkd3d_array_reserve((void**)&trace->commands, &trace->command_size,
-            trace->command_count + 1, sizeof(*trace->commands));
+    /* Storage is preallocated when the context is allocated, so this rarely has to grow. */
+    if (trace->command_count == trace->command_size &&
+            !vkd3d_array_reserve((void**)&trace->commands, &trace->command_size,
+                    trace->command_count + 1, sizeof(*trace->commands)))
+        return;
+
     trace->commands[trace->command_count++] = *command;
 }
 
@@ -26,34 +26,73 @@ static inline struct d3d12_bundle_allocator *impl_from_ID3D12CommandAllocator(ID
     return CONTAINING_RECORD(iface, struct d3d12_bundle_allocator, ID3D12CommandAllocator_iface);
 }
 
-static void *d3d12_bundle_allocator_alloc_chunk_data(struct d3d12_bundle_allocator *allocator, size_t size)
+static bool d3d12_bundle_allocator_add_chunk(struct d3d12_bundle_allocator *allocator, size_t size)
+{
+    struct d3d12_bundle_chunk *chunk;
+
+    if (!vkd3d_array_reserve((void **)&allocator->chunks, &allocator->chunks_size,
+            allocator->chunks_count + 1, sizeof(*allocator->chunks)))
+        return false;
+
+    chunk = &allocator->chunks[allocator->chunks_count];
+    chunk->size = align(max(max(size, allocator->high_water_bytes), VKD3D_BUNDLE_CHUNK_SIZE), VKD3D_BUNDLE_CHUNK_SIZE);
+
+    if (!(chunk->data = vkd3d_malloc(chunk->size)))
+        return false;
+
+    allocator->chunks_count++;
+    return true;
+}
+
+static void *d3d12_bundle_allocator_alloc_data(struct d3d12_bundle_allocator *allocator,
+        size_t size, bool is_command)
 {
-    size_t chunk_offset = 0;
-    void *chunk = NULL;
+    struct d3d12_bundle_chunk *chunk;
+    size_t offset;
 
     size = align(size, VKD3D_BUNDLE_COMMAND_ALIGNMENT);
 
-    if (allocator->chunks_count)
+    for (;;)
     {
-        chunk = allocator->chunks[allocator->chunks_count - 1];
-        chunk_offset = allocator->chunk_offset;
-    }
+        chunk = allocator->chunk_index < allocator->chunks_count ? &allocator->chunks[allocator->chunk_index] : NULL;
+        offset = allocator->chunk_offset;
 
-    if (!chunk || chunk_offset + size > VKD3D_BUNDLE_CHUNK_SIZE)
-    {
-        if (!vkd3d_array_reserve((void **)&allocator->chunks, &allocator->chunks_size,
-                allocator->chunks_count + 1, sizeof(*allocator->chunks)))
-            return NULL;
+        if (chunk && is_command && size <= VKD3D_BUNDLE_CACHE_LINE_SIZE &&
+                (offset & (VKD3D_BUNDLE_CACHE_LINE_SIZE - 1)) + size > VKD3D_BUNDLE_CACHE_LINE_SIZE)
+            offset = align(offset, VKD3D_BUNDLE_CACHE_LINE_SIZE);
 
-        if (!(chunk = vkd3d_malloc(VKD3D_BUNDLE_CHUNK_SIZE)))
-            return NULL;
+        if (chunk && offset + size <= chunk->size)
+            break;
+
+        /* Move on to the next chunk, recycling chunks kept from previous recordings. */
+        if (chunk)
+        {
+            allocator->used_bytes += allocator->chunk_offset;
+            allocator->chunk_index++;
+        }
+
+        allocator->chunk_offset = 0;
+
+        if (allocator->chunk_index < allocator->chunks_count &&
+                allocator->chunks[allocator->chunk_index].size < size)
+        {
+            /* Chunks are only reused in order, so an undersized chunk is simply dropped. */
+            vkd3d_free(allocator->chunks[allocator->chunk_index].data);
+            allocator->chunks[allocator->chunk_index] = allocator->chunks[--allocator->chunks_count];
+        }
 
-        allocator->chunks[allocator->chunks_count++] = chunk;
-        allocator->chunk_offset = chunk_offset = 0;
+        if (allocator->chunk_index >= allocator->chunks_count &&
+                !d3d12_bundle_allocator_add_chunk(allocator, size))
+            return NULL;
     }
 
-    allocator->chunk_offset = chunk_offset + size;
-    return void_ptr_offset(chunk, chunk_offset);
+    allocator->chunk_offset = offset + size;
+    return void_ptr_offset(chunk->data, offset);
+}
+
+static void *d3d12_bundle_allocator_alloc_chunk_data(struct d3d12_bundle_allocator *allocator, size_t size)
+{
+    return d3d12_bundle_allocator_alloc_data(allocator, size, false);
 }
 
 static void d3d12_bundle_allocator_free_chunks(struct d3d12_bundle_allocator *allocator)
@@ -61,13 +100,39 @@ static void d3d12_bundle_allocator_free_chunks(struct d3d12_bundle_allocator *al
     size_t i;
 
     for (i = 0; i < allocator->chunks_count; i++)
-        vkd3d_free(allocator->chunks[i]);
+        vkd3d_free(allocator->chunks[i].data);
 
     vkd3d_free(allocator->chunks);
     allocator->chunks = NULL;
     allocator->chunks_size = 0;
     allocator->chunks_count = 0;
+    allocator->chunk_index = 0;
+    allocator->chunk_offset = 0;
+    allocator->used_bytes = 0;
+}
+
+static void d3d12_bundle_allocator_recycle_chunks(struct d3d12_bundle_allocator *allocator)
+{
+    size_t used_bytes, i;
+
+    used_bytes = allocator->used_bytes + allocator->chunk_offset;
+
+    /* Let the high-water mark decay slowly so that one-off spikes do not pin memory forever. */
+    allocator->high_water_bytes = max(used_bytes, allocator->high_water_bytes - allocator->high_water_bytes / 8);
+
+    if (allocator->chunk_index || (allocator->chunks_count &&
+            allocator->chunks[0].size >= 4 * max(allocator->high_water_bytes, VKD3D_BUNDLE_CHUNK_SIZE)))
+    {
+        /* The last recording did not fit in one chunk, or the chunk is way oversized.
+         * Start over with a single chunk sized for the high-water mark on next use. */
+        for (i = 0; i < allocator->chunks_count; i++)
+            vkd3d_free(allocator->chunks[i].data);
+        allocator->chunks_count = 0;
+    }
+
+    allocator->chunk_index = 0;
     allocator->chunk_offset = 0;
+    allocator->used_bytes = 0;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d12_bundle_allocator_QueryInterface(ID3D12CommandAllocator *iface,
@@ -176,7 +241,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_bundle_allocator_Reset(ID3D12CommandAlloc
         bundle->tail = NULL;
     }
 
-    d3d12_bundle_allocator_free_chunks(allocator);
+    d3d12_bundle_allocator_recycle_chunks(allocator);
     return S_OK;
 }
 
@@ -236,7 +301,7 @@ static inline struct d3d12_bundle *impl_from_ID3D12GraphicsCommandList(d3d12_com
 
 void *d3d12_bundle_add_command(struct d3d12_bundle *bundle, pfn_d3d12_bundle_command proc, size_t size)
 {
-    struct d3d12_bundle_command *command = d3d12_bundle_allocator_alloc_chunk_data(bundle->allocator, size);
+    struct d3d12_bundle_command *command = d3d12_bundle_allocator_alloc_data(bundle->allocator, size, true);
 
     command->proc = proc;
     command->next = NULL;
@@ -358,6 +423,8 @@ static D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE d3d12_bundle_GetType(d3d12_comm
     return D3D12_COMMAND_LIST_TYPE_BUNDLE;
 }
 
+static void d3d12_bundle_optimize(struct d3d12_bundle *bundle);
+
 static HRESULT STDMETHODCALLTYPE d3d12_bundle_Close(d3d12_command_list_iface *iface)
 {
     struct d3d12_bundle *bundle = impl_from_ID3D12GraphicsCommandList(iface);
@@ -370,6 +437,8 @@ static HRESULT STDMETHODCALLTYPE d3d12_bundle_Close(d3d12_command_list_iface *if
         return E_FAIL;
     }
 
+    d3d12_bundle_optimize(bundle);
+
     bundle->is_recording = false;
     return S_OK;
 }
@@ -1797,6 +1866,129 @@ HRESULT d3d12_bundle_create(struct d3d12_device *device,
     return S_OK;
 }
 
+enum vkd3d_bundle_state_slot
+{
+    VKD3D_BUNDLE_STATE_SLOT_PRIMITIVE_TOPOLOGY,
+    VKD3D_BUNDLE_STATE_SLOT_BLEND_FACTOR,
+    VKD3D_BUNDLE_STATE_SLOT_STENCIL_REF,
+    VKD3D_BUNDLE_STATE_SLOT_DEPTH_BOUNDS,
+    VKD3D_BUNDLE_STATE_SLOT_INDEX_BUFFER,
+    VKD3D_BUNDLE_STATE_SLOT_GRAPHICS_ROOT_PARAMETER,
+    VKD3D_BUNDLE_STATE_SLOT_COMPUTE_ROOT_PARAMETER = VKD3D_BUNDLE_STATE_SLOT_GRAPHICS_ROOT_PARAMETER + D3D12_MAX_ROOT_COST,
+    VKD3D_BUNDLE_STATE_SLOT_COUNT = VKD3D_BUNDLE_STATE_SLOT_COMPUTE_ROOT_PARAMETER + D3D12_MAX_ROOT_COST,
+};
+
+static bool d3d12_bundle_command_get_state_slot(const struct d3d12_bundle_command *command, uint32_t *slot)
+{
+    const struct d3d12_set_root_descriptor_table_command *table;
+    const struct d3d12_set_root_descriptor_command *descriptor;
+    pfn_d3d12_bundle_command proc = command->proc;
+
+    /* Only commands which fully overwrite a single piece of state are eligible,
+     * anything that may consume state or only partially updates it is not. */
+    if (proc == d3d12_bundle_exec_ia_set_primitive_topology)
+        *slot = VKD3D_BUNDLE_STATE_SLOT_PRIMITIVE_TOPOLOGY;
+    else if (proc == d3d12_bundle_exec_om_set_blend_factor)
+        *slot = VKD3D_BUNDLE_STATE_SLOT_BLEND_FACTOR;
+    else if (proc == d3d12_bundle_exec_om_set_stencil_ref)
+        *slot = VKD3D_BUNDLE_STATE_SLOT_STENCIL_REF;
+    else if (proc == d3d12_bundle_exec_om_set_depth_bounds)
+        *slot = VKD3D_BUNDLE_STATE_SLOT_DEPTH_BOUNDS;
+    else if (proc == d3d12_bundle_exec_ia_set_index_buffer ||
+            proc == d3d12_bundle_exec_ia_set_index_buffer_null)
+        *slot = VKD3D_BUNDLE_STATE_SLOT_INDEX_BUFFER;
+    else if (proc == d3d12_bundle_exec_set_graphics_root_descriptor_table ||
+            proc == d3d12_bundle_exec_set_compute_root_descriptor_table)
+    {
+        table = CONTAINING_RECORD(command, struct d3d12_set_root_descriptor_table_command, command);
+
+        if (table->parameter_index >= D3D12_MAX_ROOT_COST)
+            return false;
+
+        *slot = (proc == d3d12_bundle_exec_set_graphics_root_descriptor_table
+                ? VKD3D_BUNDLE_STATE_SLOT_GRAPHICS_ROOT_PARAMETER
+                : VKD3D_BUNDLE_STATE_SLOT_COMPUTE_ROOT_PARAMETER) + table->parameter_index;
+    }
+    else if (proc == d3d12_bundle_exec_set_graphics_root_cbv ||
+            proc == d3d12_bundle_exec_set_graphics_root_srv ||
+            proc == d3d12_bundle_exec_set_graphics_root_uav ||
+            proc == d3d12_bundle_exec_set_compute_root_cbv ||
+            proc == d3d12_bundle_exec_set_compute_root_srv ||
+            proc == d3d12_bundle_exec_set_compute_root_uav)
+    {
+        descriptor = CONTAINING_RECORD(command, struct d3d12_set_root_descriptor_command, command);
+
+        if (descriptor->parameter_index >= D3D12_MAX_ROOT_COST)
+            return false;
+
+        *slot = (proc == d3d12_bundle_exec_set_graphics_root_cbv ||
+                proc == d3d12_bundle_exec_set_graphics_root_srv ||
+                proc == d3d12_bundle_exec_set_graphics_root_uav
+                ? VKD3D_BUNDLE_STATE_SLOT_GRAPHICS_ROOT_PARAMETER
+                : VKD3D_BUNDLE_STATE_SLOT_COMPUTE_ROOT_PARAMETER) + descriptor->parameter_index;
+    }
+    else
+        return false;
+
+    return true;
+}
+
+static void d3d12_bundle_optimize(struct d3d12_bundle *bundle)
+{
+    struct d3d12_bundle_command *pending[VKD3D_BUNDLE_STATE_SLOT_COUNT];
+    struct d3d12_bundle_command *command, *prev;
+    unsigned int dropped_count = 0;
+    uint32_t slot;
+
+    /* Bundles are typically recorded once and replayed many times, so strip
+     * state updates which are overwritten before anything can observe them.
+     * Dropped commands are marked and unlinked in a second pass. */
+    memset(pending, 0, sizeof(pending));
+
+    for (command = bundle->head; command; command = command->next)
+    {
+        if (d3d12_bundle_command_get_state_slot(command, &slot))
+        {
+            if (pending[slot])
+            {
+                pending[slot]->proc = NULL;
+                dropped_count++;
+            }
+
+            pending[slot] = command;
+        }
+        else
+            memset(pending, 0, sizeof(pending));
+    }
+
+    if (!dropped_count)
+        return;
+
+    TRACE("Dropping %u redundant state commands from bundle %p.\n", dropped_count, bundle);
+
+    prev = NULL;
+
+    for (command = bundle->head; command; command = command->next)
+    {
+        if (!command->proc)
+            continue;
+
+        if (prev)
+            prev->next = command;
+        else
+            bundle->head = command;
+
+        prev = command;
+    }
+
+    if (prev)
+        prev->next = NULL;
+    else
+        bundle->head = NULL;
+
+    bundle->tail = prev;
+}
+
 void d3d12_bundle_execute(struct d3d12_bundle *bundle, d3d12_command_list_iface *list)
 {
     struct d3d12_bundle_command *command = bundle->head;
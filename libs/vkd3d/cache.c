@@ -29,11 +29,25 @@ struct vkd3d_cached_pipeline_key
     uint64_t internal_key_hash; /* Used for internal keys which are just hashes. Used if name_length is 0. */
 };
 
+enum vkd3d_cached_pipeline_blob_ownership
+{
+    /* Blob points into application memory or a mapped archive. */
+    VKD3D_CACHED_PIPELINE_BLOB_BORROWED = 0,
+    /* Blob and name were allocated by the library. */
+    VKD3D_CACHED_PIPELINE_BLOB_OWNED = 1,
+    /* Blob is interned in the device-wide pipeline blob store. */
+    VKD3D_CACHED_PIPELINE_BLOB_SHARED = 2,
+};
+
 struct vkd3d_cached_pipeline_data
 {
     const void *blob;
     size_t blob_length;
-    size_t is_new; /* Avoid padding issues. */
+    size_t is_new; /* Avoid padding issues. A vkd3d_cached_pipeline_blob_ownership value. */
+    /* Stream archive entries which are loaded through the sidecar index are not checksummed up front.
+     * The payload is validated on first lookup instead, see d3d12_pipeline_library_validate_cached_entry(). */
+    uint32_t stream_validation;
+    uint32_t stream_type;
     /* Need to internally hold a PSO and hand out the same one on subsequent LoadLibrary.
      * This is a good performance boost for applications which load PSOs from library directly
      * multiple times throughout the lifetime of an application. */
@@ -47,6 +61,13 @@ struct vkd3d_cached_pipeline_entry
     struct vkd3d_cached_pipeline_data data;
 };
 
+enum vkd3d_cached_pipeline_stream_validation
+{
+    VKD3D_CACHED_PIPELINE_STREAM_VALIDATED = 0,
+    VKD3D_CACHED_PIPELINE_STREAM_PENDING = 1,
+    VKD3D_CACHED_PIPELINE_STREAM_CORRUPT = 2,
+};
+
 /* The stream format is used for internal magic cache.
  * In this scheme, we optimize for append performance rather than read performance.
  * TODO: This is a stepping stone for Fossilize integration, which would allow e.g. Steam to provide us with
@@ -166,6 +187,176 @@ static bool vkd3d_decode_varint(uint32_t *words, size_t words_size, const uint8_
     return buffer_size == offset;
 }
 
+/* Byte-oriented LZ77 block codec following the LZ4 block format.
+ * VkPipelineCache data compresses well, but is not word-structured like SPIR-V. */
+#define VKD3D_LZ4_MIN_MATCH 4
+#define VKD3D_LZ4_HASH_BITS 12
+#define VKD3D_LZ4_LAST_LITERALS 5
+#define VKD3D_LZ4_MATCH_START_LIMIT 12
+#define VKD3D_LZ4_MAX_OFFSET 65535
+
+static size_t vkd3d_lz4_compress_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+static uint32_t vkd3d_lz4_read32(const uint8_t *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static uint8_t *vkd3d_lz4_encode_length(uint8_t *buffer, size_t length)
+{
+    while (length >= 255)
+    {
+        *buffer++ = 255;
+        length -= 255;
+    }
+
+    *buffer++ = length;
+    return buffer;
+}
+
+static uint8_t *vkd3d_lz4_encode_literals(uint8_t *buffer, uint8_t *token, const uint8_t *literals, size_t length)
+{
+    *token = (length >= 15 ? 15 : length) << 4;
+    if (length >= 15)
+        buffer = vkd3d_lz4_encode_length(buffer, length - 15);
+    memcpy(buffer, literals, length);
+    return buffer + length;
+}
+
+/* dst must hold at least vkd3d_lz4_compress_bound(size) bytes. */
+static size_t vkd3d_lz4_compress(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    uint32_t table[1u << VKD3D_LZ4_HASH_BITS];
+    const uint8_t *anchor = src;
+    const uint8_t *end = src + size;
+    size_t match_length, offset;
+    const uint8_t *match_limit;
+    const uint8_t *ip = src;
+    const uint8_t *match;
+    uint32_t candidate;
+    uint8_t *op = dst;
+    uint8_t *token;
+    uint32_t hash;
+
+    memset(table, 0xff, sizeof(table));
+    match_limit = size > VKD3D_LZ4_MATCH_START_LIMIT ? end - VKD3D_LZ4_MATCH_START_LIMIT : src;
+
+    while (ip < match_limit)
+    {
+        hash = (vkd3d_lz4_read32(ip) * 2654435761u) >> (32 - VKD3D_LZ4_HASH_BITS);
+        candidate = table[hash];
+        table[hash] = ip - src;
+
+        if (candidate == UINT32_MAX || (size_t)(ip - src) - candidate > VKD3D_LZ4_MAX_OFFSET ||
+                vkd3d_lz4_read32(src + candidate) != vkd3d_lz4_read32(ip))
+        {
+            ip++;
+            continue;
+        }
+
+        match = src + candidate;
+        while (ip > anchor && match > src && ip[-1] == match[-1])
+        {
+            ip--;
+            match--;
+        }
+
+        /* The final bytes of a block must always be literals. */
+        match_length = VKD3D_LZ4_MIN_MATCH;
+        while (ip + match_length < end - VKD3D_LZ4_LAST_LITERALS && ip[match_length] == match[match_length])
+            match_length++;
+
+        token = op++;
+        op = vkd3d_lz4_encode_literals(op, token, anchor, ip - anchor);
+
+        offset = ip - match;
+        *op++ = offset & 0xff;
+        *op++ = offset >> 8;
+
+        match_length -= VKD3D_LZ4_MIN_MATCH;
+        *token |= match_length >= 15 ? 15 : match_length;
+        if (match_length >= 15)
+            op = vkd3d_lz4_encode_length(op, match_length - 15);
+
+        ip += match_length + VKD3D_LZ4_MIN_MATCH;
+        anchor = ip;
+    }
+
+    token = op++;
+    op = vkd3d_lz4_encode_literals(op, token, anchor, end - anchor);
+    return op - dst;
+}
+
+static bool vkd3d_lz4_decode_length(const uint8_t **buffer, const uint8_t *end, size_t *length)
+{
+    uint8_t value;
+
+    do
+    {
+        if (*buffer >= end)
+            return false;
+        value = *(*buffer)++;
+        *length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+static bool vkd3d_lz4_decompress(uint8_t *dst, size_t dst_size, const uint8_t *src, size_t src_size)
+{
+    const uint8_t *src_end = src + src_size;
+    uint8_t *dst_end = dst + dst_size;
+    size_t length, offset;
+    const uint8_t *match;
+    uint8_t *op = dst;
+    uint8_t token;
+
+    while (src < src_end)
+    {
+        token = *src++;
+
+        length = token >> 4;
+        if (length == 15 && !vkd3d_lz4_decode_length(&src, src_end, &length))
+            return false;
+        if (length > (size_t)(src_end - src) || length > (size_t)(dst_end - op))
+            return false;
+
+        memcpy(op, src, length);
+        op += length;
+        src += length;
+
+        /* The last sequence has no match. */
+        if (src == src_end)
+            break;
+
+        if (src_end - src < 2)
+            return false;
+        offset = src[0] | (src[1] << 8);
+        src += 2;
+        if (!offset || offset > (size_t)(op - dst))
+            return false;
+
+        length = token & 15;
+        if (length == 15 && !vkd3d_lz4_decode_length(&src, src_end, &length))
+            return false;
+        length += VKD3D_LZ4_MIN_MATCH;
+        if (length > (size_t)(dst_end - op))
+            return false;
+
+        /* Matches may overlap the bytes they produce. */
+        match = op - offset;
+        while (length--)
+            *op++ = *match++;
+    }
+
+    return op == dst_end;
+}
+
 VkResult vkd3d_create_pipeline_cache(struct d3d12_device *device,
         size_t size, const void *data, VkPipelineCache *cache)
 {
@@ -181,7 +372,7 @@ VkResult vkd3d_create_pipeline_cache(struct d3d12_device *device,
     return VK_CALL(vkCreatePipelineCache(device->vk_device, &info, NULL, cache));
 }
 
-#define VKD3D_CACHE_BLOB_VERSION MAKE_MAGIC('V','K','B',3)
+#define VKD3D_CACHE_BLOB_VERSION MAKE_MAGIC('V','K','B',4)
 
 enum vkd3d_pipeline_blob_chunk_type
 {
@@ -218,6 +409,20 @@ struct vkd3d_pipeline_blob_chunk_spirv
     uint8_t data[];
 };
 
+enum vkd3d_pipeline_blob_encoding
+{
+    VKD3D_PIPELINE_BLOB_ENCODING_RAW = 0,
+    VKD3D_PIPELINE_BLOB_ENCODING_LZ4 = 1,
+};
+
+/* Payload of internal driver cache blobs. */
+struct vkd3d_pipeline_blob_chunk_driver_cache
+{
+    uint32_t encoding; /* enum vkd3d_pipeline_blob_encoding */
+    uint32_t decompressed_size;
+    uint8_t data[];
+};
+
 struct vkd3d_pipeline_blob_chunk_link
 {
     uint64_t hash;
@@ -237,6 +442,8 @@ STATIC_ASSERT(sizeof(struct vkd3d_pipeline_blob_chunk) == 8);
 STATIC_ASSERT(offsetof(struct vkd3d_pipeline_blob_chunk, data) == 8);
 STATIC_ASSERT(sizeof(struct vkd3d_pipeline_blob_chunk_spirv) == 8);
 STATIC_ASSERT(sizeof(struct vkd3d_pipeline_blob_chunk_spirv) == offsetof(struct vkd3d_pipeline_blob_chunk_spirv, data));
+STATIC_ASSERT(sizeof(struct vkd3d_pipeline_blob_chunk_driver_cache) ==
+        offsetof(struct vkd3d_pipeline_blob_chunk_driver_cache, data));
 
 struct vkd3d_pipeline_blob
 {
@@ -272,22 +479,24 @@ STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_stream_entry) ==
         offsetof(struct vkd3d_serialized_pipeline_stream_entry, data));
 STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_stream_entry) == 24);
 
+/* These blobs can be many MiB and are never compared against DXBC hashes,
+ * so use the faster XXH64 rather than vkd3d_shader_hash(). */
 static uint32_t vkd3d_pipeline_blob_compute_data_checksum(const uint8_t *data, size_t size)
 {
-    const struct vkd3d_shader_code code = { data, size };
-    vkd3d_shader_hash_t h;
+    return hash_uint64(hash_xxh64(data, size, 0));
+}
 
-    h = vkd3d_shader_hash(&code);
-    return hash_uint64(h);
+static uint64_t vkd3d_pipeline_blob_compute_internal_key_hash(const void *data, size_t size)
+{
+    return hash_xxh64(data, size, 0);
 }
 
 static uint64_t vkd3d_serialized_pipeline_stream_entry_compute_checksum(const uint8_t *data,
         const struct vkd3d_serialized_pipeline_stream_entry *entry)
 {
-    const struct vkd3d_shader_code code = { data, entry->size };
-    vkd3d_shader_hash_t h;
+    uint64_t h;
 
-    h = vkd3d_shader_hash(&code);
+    h = hash_xxh64(data, entry->size, 0);
     h = hash_fnv1_iterate_u64(h, entry->hash);
     h = hash_fnv1_iterate_u32(h, entry->size);
     h = hash_fnv1_iterate_u32(h, entry->type);
@@ -533,6 +742,41 @@ static struct vkd3d_pipeline_blob_chunk *finish_and_iterate_blob_chunk(struct vk
     return (struct vkd3d_pipeline_blob_chunk *)&chunk->data[aligned_size];
 }
 
+static bool d3d12_pipeline_library_validate_cached_entry(const struct vkd3d_cached_pipeline_entry *entry)
+{
+    /* Validation state is lazily resolved under a read lock, so it's the only mutable part of the entry. */
+    uint32_t *validation = (uint32_t *)&entry->data.stream_validation;
+    const struct vkd3d_serialized_pipeline_stream_entry *stream_entry;
+    uint32_t state;
+
+    state = vkd3d_atomic_uint32_load_explicit(validation, vkd3d_memory_order_acquire);
+    if (state != VKD3D_CACHED_PIPELINE_STREAM_PENDING)
+        return state == VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+
+    /* Entries loaded through the stream archive index point straight into the mapped archive,
+     * so the original entry header sits right in front of the payload.
+     * Racing threads may both validate the entry, but they will reach the same conclusion. */
+    stream_entry = (const struct vkd3d_serialized_pipeline_stream_entry *)
+            ((const uint8_t *)entry->data.blob - offsetof(struct vkd3d_serialized_pipeline_stream_entry, data));
+
+    if (stream_entry->hash == entry->key.internal_key_hash &&
+            stream_entry->size == entry->data.blob_length &&
+            stream_entry->type == entry->data.stream_type &&
+            vkd3d_serialized_pipeline_stream_entry_validate(stream_entry->data, stream_entry))
+    {
+        state = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+    }
+    else
+    {
+        INFO("Corrupt stream cache entry %016"PRIx64" detected on first use, ignoring it.\n",
+                entry->key.internal_key_hash);
+        state = VKD3D_CACHED_PIPELINE_STREAM_CORRUPT;
+    }
+
+    vkd3d_atomic_uint32_store_explicit(validation, state, vkd3d_memory_order_release);
+    return state == VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+}
+
 static bool d3d12_pipeline_library_find_internal_blob(struct d3d12_pipeline_library *pipeline_library,
         const struct hash_map *map, uint64_t hash, const void **data, size_t *size)
 {
@@ -543,7 +787,7 @@ static bool d3d12_pipeline_library_find_internal_blob(struct d3d12_pipeline_libr
     bool ret = false;
 
     /* We are called from within D3D12 PSO creation, and we won't have read locks active here. */
-    if (rwlock_lock_read(&pipeline_library->mutex))
+    if (rwlock_lock_read(&pipeline_library->internal_hashmap_mutex))
         return false;
 
     key.name_length = 0;
@@ -551,7 +795,7 @@ static bool d3d12_pipeline_library_find_internal_blob(struct d3d12_pipeline_libr
     key.internal_key_hash = hash;
     entry = (const struct vkd3d_cached_pipeline_entry *)hash_map_find(map, &key);
 
-    if (entry)
+    if (entry && d3d12_pipeline_library_validate_cached_entry(entry))
     {
         internal = entry->data.blob;
         if (entry->data.blob_length < sizeof(*internal))
@@ -578,10 +822,81 @@ static bool d3d12_pipeline_library_find_internal_blob(struct d3d12_pipeline_libr
     }
 
 out:
-    rwlock_unlock_read(&pipeline_library->mutex);
+    rwlock_unlock_read(&pipeline_library->internal_hashmap_mutex);
     return ret;
 }
 
+static bool vkd3d_pipeline_blob_decode_driver_cache(const void *blob, size_t blob_size,
+        const void **data, size_t *size, void **decoded_data)
+{
+    const struct vkd3d_pipeline_blob_chunk_driver_cache *driver_cache = blob;
+
+    *decoded_data = NULL;
+
+    if (blob_size < sizeof(*driver_cache))
+        return false;
+    blob_size -= sizeof(*driver_cache);
+
+    switch (driver_cache->encoding)
+    {
+        case VKD3D_PIPELINE_BLOB_ENCODING_RAW:
+            if (driver_cache->decompressed_size != blob_size)
+                return false;
+            *data = driver_cache->data;
+            *size = blob_size;
+            return true;
+
+        case VKD3D_PIPELINE_BLOB_ENCODING_LZ4:
+            if (!(*decoded_data = vkd3d_malloc(driver_cache->decompressed_size)))
+                return false;
+
+            if (!vkd3d_lz4_decompress(*decoded_data, driver_cache->decompressed_size,
+                    driver_cache->data, blob_size))
+            {
+                vkd3d_free(*decoded_data);
+                *decoded_data = NULL;
+                return false;
+            }
+
+            *data = *decoded_data;
+            *size = driver_cache->decompressed_size;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/* Returns a new internal blob holding an LZ4 encoded copy of the raw driver cache in internal,
+ * or NULL if compression does not pay off. */
+static struct vkd3d_pipeline_blob_internal *vkd3d_pipeline_blob_compress_driver_cache(
+        const struct vkd3d_pipeline_blob_internal *internal, size_t *blob_length)
+{
+    const struct vkd3d_pipeline_blob_chunk_driver_cache *raw = CONST_CAST_CHUNK_DATA(internal, driver_cache);
+    struct vkd3d_pipeline_blob_chunk_driver_cache *compressed;
+    struct vkd3d_pipeline_blob_internal *compressed_internal;
+    size_t compressed_size;
+
+    if (!(compressed_internal = vkd3d_malloc(sizeof(*compressed_internal) + sizeof(*compressed) +
+            vkd3d_lz4_compress_bound(raw->decompressed_size))))
+        return NULL;
+
+    compressed = CAST_CHUNK_DATA(compressed_internal, driver_cache);
+    compressed->encoding = VKD3D_PIPELINE_BLOB_ENCODING_LZ4;
+    compressed->decompressed_size = raw->decompressed_size;
+    compressed_size = vkd3d_lz4_compress(compressed->data, raw->data, raw->decompressed_size);
+
+    /* Decompression is not free, only bother if we save a meaningful amount of space. */
+    if (compressed_size > raw->decompressed_size - raw->decompressed_size / 8)
+    {
+        vkd3d_free(compressed_internal);
+        return NULL;
+    }
+
+    *blob_length = sizeof(*compressed_internal) + sizeof(*compressed) + compressed_size;
+    return compressed_internal;
+}
+
 HRESULT vkd3d_create_pipeline_cache_from_d3d12_desc(struct d3d12_device *device,
         const struct d3d12_cached_pipeline_state *state, VkPipelineCache *cache)
 {
@@ -589,6 +904,7 @@ HRESULT vkd3d_create_pipeline_cache_from_d3d12_desc(struct d3d12_device *device,
     const struct vkd3d_pipeline_blob_chunk_link *link;
     const struct vkd3d_pipeline_blob_chunk *chunk;
     uint32_t pipeline_library_flags;
+    void *decoded_data = NULL;
     size_t payload_size;
     const void *data;
     size_t size;
@@ -634,6 +950,12 @@ HRESULT vkd3d_create_pipeline_cache_from_d3d12_desc(struct d3d12_device *device,
             data = NULL;
             size = 0;
         }
+        else if (!vkd3d_pipeline_blob_decode_driver_cache(data, size, &data, &size, &decoded_data))
+        {
+            FIXME("Failed to decode internal PSO cache reference %016"PRIx64".\n", link->hash);
+            data = NULL;
+            size = 0;
+        }
     }
     else
     {
@@ -642,6 +964,7 @@ HRESULT vkd3d_create_pipeline_cache_from_d3d12_desc(struct d3d12_device *device,
     }
 
     vr = vkd3d_create_pipeline_cache(device, size, data, cache);
+    vkd3d_free(decoded_data);
     return hresult_from_vk_result(vr);
 }
 
@@ -750,19 +1073,252 @@ static uint32_t d3d12_cached_pipeline_entry_name_table_size(const struct vkd3d_c
         return sizeof(entry->key.internal_key_hash);
 }
 
+static void d3d12_pipeline_library_update_footprint(struct d3d12_pipeline_library *pipeline_library,
+        const struct hash_map *map, size_t old_map_size, const struct vkd3d_cached_pipeline_entry *new_entry)
+{
+    int64_t delta;
+
+    /* Blobs which are borrowed from the application or shared through the device-wide store
+     * are not owned by the library, only count the map itself for those. */
+    delta = (int64_t)hash_map_get_allocated_size(map) - (int64_t)old_map_size;
+    if (new_entry && new_entry->data.is_new == VKD3D_CACHED_PIPELINE_BLOB_OWNED)
+        delta += new_entry->data.blob_length + new_entry->key.name_length;
+
+    if (delta)
+    {
+        vkd3d_atomic_uint64_add(&pipeline_library->footprint_size, (uint64_t)delta, vkd3d_memory_order_relaxed);
+        vkd3d_memory_footprint_add(&pipeline_library->device->memory_footprint,
+                VKD3D_MEMORY_FOOTPRINT_PIPELINE_LIBRARY, delta);
+    }
+}
+
 static bool d3d12_pipeline_library_insert_hash_map_blob_locked(struct d3d12_pipeline_library *pipeline_library,
         struct hash_map *map, const struct vkd3d_cached_pipeline_entry *entry)
 {
+    size_t old_map_size = hash_map_get_allocated_size(map);
     const struct vkd3d_cached_pipeline_entry *new_entry;
+    bool ret;
+
     if ((new_entry = (const struct vkd3d_cached_pipeline_entry*)hash_map_insert(map, &entry->key, &entry->entry)) &&
             new_entry->data.blob == entry->data.blob)
     {
         pipeline_library->total_name_table_size += d3d12_cached_pipeline_entry_name_table_size(entry);
         pipeline_library->total_blob_size += align(entry->data.blob_length, VKD3D_PIPELINE_BLOB_ALIGN);
-        return true;
+        ret = true;
     }
     else
-        return false;
+        ret = false;
+
+    d3d12_pipeline_library_update_footprint(pipeline_library, map, old_map_size, ret ? entry : NULL);
+    return ret;
+}
+
+static struct d3d12_pipeline_library_shard *d3d12_pipeline_library_get_shard(
+        struct d3d12_pipeline_library *pipeline_library, const struct vkd3d_cached_pipeline_key *key)
+{
+    /* All shards share the same hash function. The full hash picks the bucket within a shard,
+     * so select the shard with the high bits to keep the two reasonably independent. */
+    uint32_t hash = pipeline_library->pso_shards[0].map.hash_func(key);
+    return &pipeline_library->pso_shards[(hash >> 24) % VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT];
+}
+
+static bool d3d12_pipeline_library_shard_insert_locked(struct d3d12_pipeline_library *pipeline_library,
+        struct d3d12_pipeline_library_shard *shard, const struct vkd3d_cached_pipeline_entry *entry)
+{
+    size_t old_map_size = hash_map_get_allocated_size(&shard->map);
+    const struct vkd3d_cached_pipeline_entry *new_entry;
+    bool ret;
+
+    if ((new_entry = (const struct vkd3d_cached_pipeline_entry*)hash_map_insert(&shard->map, &entry->key, &entry->entry)) &&
+            new_entry->data.blob == entry->data.blob)
+    {
+        shard->total_name_table_size += d3d12_cached_pipeline_entry_name_table_size(entry);
+        shard->total_blob_size += align(entry->data.blob_length, VKD3D_PIPELINE_BLOB_ALIGN);
+        ret = true;
+    }
+    else
+        ret = false;
+
+    d3d12_pipeline_library_update_footprint(pipeline_library, &shard->map, old_map_size, ret ? entry : NULL);
+    return ret;
+}
+
+static bool d3d12_pipeline_library_insert_blob_locked(struct d3d12_pipeline_library *pipeline_library,
+        uint32_t type /* vkd3d_serialized_pipeline_stream_entry_type */,
+        const struct vkd3d_cached_pipeline_entry *entry)
+{
+    switch (type)
+    {
+        case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_SPIRV:
+            return d3d12_pipeline_library_insert_hash_map_blob_locked(pipeline_library,
+                    &pipeline_library->spirv_cache_map, entry);
+
+        case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_DRIVER_CACHE:
+            return d3d12_pipeline_library_insert_hash_map_blob_locked(pipeline_library,
+                    &pipeline_library->driver_cache_map, entry);
+
+        case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE:
+            return d3d12_pipeline_library_shard_insert_locked(pipeline_library,
+                    d3d12_pipeline_library_get_shard(pipeline_library, &entry->key), entry);
+
+        default:
+            return false;
+    }
+}
+
+static int d3d12_pipeline_library_lock_shards_read(struct d3d12_pipeline_library *pipeline_library)
+{
+    unsigned int i;
+    int rc;
+
+    /* Always lock in index order, so that we never deadlock against another full lock. */
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+    {
+        if ((rc = rwlock_lock_read(&pipeline_library->pso_shards[i].lock)))
+        {
+            while (i--)
+                rwlock_unlock_read(&pipeline_library->pso_shards[i].lock);
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static void d3d12_pipeline_library_unlock_shards_read(struct d3d12_pipeline_library *pipeline_library)
+{
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+        rwlock_unlock_read(&pipeline_library->pso_shards[i].lock);
+}
+
+struct vkd3d_pipeline_blob_store_key
+{
+    uint64_t hash;
+    uint32_t type;
+    size_t size;
+    const void *data;
+};
+
+struct vkd3d_pipeline_blob_store_entry
+{
+    struct hash_map_entry entry;
+    struct vkd3d_pipeline_blob_store_key key;
+    uint32_t refcount;
+};
+
+static uint32_t vkd3d_pipeline_blob_store_hash_key(const void *key)
+{
+    const struct vkd3d_pipeline_blob_store_key *k = key;
+    return hash_combine(hash_uint64(k->hash), k->type);
+}
+
+static bool vkd3d_pipeline_blob_store_compare_key(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_pipeline_blob_store_entry *e = (const struct vkd3d_pipeline_blob_store_entry *)entry;
+    const struct vkd3d_pipeline_blob_store_key *k = key;
+
+    /* The hash is only a hint, blobs must be byte identical to be shared. */
+    return e->key.hash == k->hash && e->key.type == k->type && e->key.size == k->size &&
+            (e->key.data == k->data || !memcmp(e->key.data, k->data, k->size));
+}
+
+HRESULT vkd3d_pipeline_blob_store_init(struct vkd3d_pipeline_blob_store *store)
+{
+    int rc;
+
+    memset(store, 0, sizeof(*store));
+
+    if ((rc = pthread_mutex_init(&store->mutex, NULL)))
+        return hresult_from_errno(rc);
+
+    hash_map_init(&store->map, vkd3d_pipeline_blob_store_hash_key,
+            vkd3d_pipeline_blob_store_compare_key, sizeof(struct vkd3d_pipeline_blob_store_entry));
+    return S_OK;
+}
+
+void vkd3d_pipeline_blob_store_cleanup(struct vkd3d_pipeline_blob_store *store)
+{
+    struct vkd3d_pipeline_blob_store_entry *e;
+    uint32_t i;
+
+    /* Every pipeline library releases its blobs on destruction, so anything left here has leaked. */
+    if (store->map.used_count)
+        WARN("%u shared pipeline blobs still alive at device destruction.\n", store->map.used_count);
+
+    for (i = 0; i < store->map.entry_count; i++)
+    {
+        e = (struct vkd3d_pipeline_blob_store_entry *)hash_map_get_entry(&store->map, i);
+        if (e->entry.flags & HASH_MAP_ENTRY_OCCUPIED)
+            vkd3d_free((void *)e->key.data);
+    }
+
+    hash_map_free(&store->map);
+    pthread_mutex_destroy(&store->mutex);
+}
+
+/* Takes ownership of blob. Returns the canonical copy, which may be a blob interned earlier
+ * by another pipeline library, in which case the argument is freed.
+ * Returns NULL on failure, in which case the caller still owns blob. */
+static const void *vkd3d_pipeline_blob_store_intern(struct vkd3d_pipeline_blob_store *store,
+        uint32_t type, uint64_t hash, void *blob, size_t size)
+{
+    struct vkd3d_pipeline_blob_store_entry *e, new_entry;
+    const void *data;
+
+    new_entry.key.hash = hash;
+    new_entry.key.type = type;
+    new_entry.key.size = size;
+    new_entry.key.data = blob;
+    new_entry.refcount = 1;
+
+    pthread_mutex_lock(&store->mutex);
+
+    if ((e = (struct vkd3d_pipeline_blob_store_entry *)hash_map_find(&store->map, &new_entry.key)))
+    {
+        e->refcount++;
+        data = e->key.data;
+        pthread_mutex_unlock(&store->mutex);
+        vkd3d_free(blob);
+        return data;
+    }
+
+    e = (struct vkd3d_pipeline_blob_store_entry *)hash_map_insert(&store->map, &new_entry.key, &new_entry.entry);
+    pthread_mutex_unlock(&store->mutex);
+    return e ? blob : NULL;
+}
+
+static void vkd3d_pipeline_blob_store_release(struct vkd3d_pipeline_blob_store *store,
+        uint32_t type, uint64_t hash, const void *blob, size_t size)
+{
+    struct vkd3d_pipeline_blob_store_entry *e;
+    struct vkd3d_pipeline_blob_store_key key;
+
+    key.hash = hash;
+    key.type = type;
+    key.size = size;
+    key.data = blob;
+
+    pthread_mutex_lock(&store->mutex);
+
+    e = (struct vkd3d_pipeline_blob_store_entry *)hash_map_find(&store->map, &key);
+    if (!e || e->key.data != blob)
+    {
+        ERR("Releasing pipeline blob %p which is not owned by the blob store.\n", blob);
+        pthread_mutex_unlock(&store->mutex);
+        return;
+    }
+
+    if (!--e->refcount)
+    {
+        hash_map_remove(&store->map, &e->entry);
+        pthread_mutex_unlock(&store->mutex);
+        vkd3d_free((void *)blob);
+        return;
+    }
+
+    pthread_mutex_unlock(&store->mutex);
 }
 
 static bool d3d12_pipeline_library_insert_hash_map_blob_internal(struct d3d12_pipeline_library *pipeline_library,
@@ -771,6 +1327,7 @@ static bool d3d12_pipeline_library_insert_hash_map_blob_internal(struct d3d12_pi
     /* Used for internal hashmap updates. We expect reasonable amount of duplicates,
      * prefer read -> write promotion. */
     const struct vkd3d_cached_pipeline_entry *new_entry;
+    size_t old_map_size;
     bool ret;
     int rc;
 
@@ -793,6 +1350,7 @@ static bool d3d12_pipeline_library_insert_hash_map_blob_internal(struct d3d12_pi
         return false;
     }
 
+    old_map_size = hash_map_get_allocated_size(map);
     if ((new_entry = (const struct vkd3d_cached_pipeline_entry*)hash_map_insert(map, &entry->key, &entry->entry)) &&
             new_entry->data.blob == entry->data.blob)
     {
@@ -803,10 +1361,42 @@ static bool d3d12_pipeline_library_insert_hash_map_blob_internal(struct d3d12_pi
     else
         ret = false;
 
+    d3d12_pipeline_library_update_footprint(pipeline_library, map, old_map_size, ret ? entry : NULL);
+
     rwlock_unlock_write(&pipeline_library->internal_hashmap_mutex);
     return ret;
 }
 
+/* Interns a freshly serialized blob in the device-wide store so that libraries which see the same
+ * shader or driver cache share a single allocation, then inserts it into the library map.
+ * Ownership of the blob is always consumed. */
+static bool d3d12_pipeline_library_insert_shared_blob_internal(struct d3d12_pipeline_library *pipeline_library,
+        struct hash_map *map, struct vkd3d_cached_pipeline_entry *entry, uint32_t type)
+{
+    struct vkd3d_pipeline_blob_store *store = &pipeline_library->device->pipeline_blob_store;
+    void *blob = (void *)entry->data.blob;
+    const void *shared;
+
+    if ((shared = vkd3d_pipeline_blob_store_intern(store, type, entry->key.internal_key_hash,
+            blob, entry->data.blob_length)))
+    {
+        entry->data.blob = shared;
+        entry->data.is_new = VKD3D_CACHED_PIPELINE_BLOB_SHARED;
+    }
+
+    if (d3d12_pipeline_library_insert_hash_map_blob_internal(pipeline_library, map, entry))
+        return true;
+
+    if (shared)
+    {
+        vkd3d_pipeline_blob_store_release(store, type, entry->key.internal_key_hash,
+                shared, entry->data.blob_length);
+    }
+    else
+        vkd3d_free(blob);
+    return false;
+}
+
 static size_t vkd3d_shader_code_compute_serialized_size(const struct vkd3d_shader_code *code,
         size_t *out_varint_size, bool inline_spirv)
 {
@@ -901,7 +1491,6 @@ static void vkd3d_shader_code_serialize_referenced(struct d3d12_pipeline_library
     struct vkd3d_pipeline_blob_internal *internal;
     struct vkd3d_pipeline_blob_chunk_link *link;
     struct vkd3d_cached_pipeline_entry entry;
-    struct vkd3d_shader_code blob;
     size_t wrapped_varint_size;
 
     if (code->size && !(code->meta.flags & VKD3D_SHADER_META_FLAG_REPLACED))
@@ -909,6 +1498,8 @@ static void vkd3d_shader_code_serialize_referenced(struct d3d12_pipeline_library
         entry.key.name_length = 0;
         entry.key.name = NULL;
         entry.data.is_new = 1;
+        entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+        entry.data.stream_type = 0;
         entry.data.state = NULL;
 
         wrapped_varint_size = sizeof(struct vkd3d_pipeline_blob_chunk_spirv) + varint_size;
@@ -921,9 +1512,7 @@ static void vkd3d_shader_code_serialize_referenced(struct d3d12_pipeline_library
         vkd3d_encode_varint(spirv->data, code->code, code->size / sizeof(uint32_t));
 
         entry.data.blob = internal;
-        blob.code = spirv->data;
-        blob.size = varint_size;
-        entry.key.internal_key_hash = vkd3d_shader_hash(&blob);
+        entry.key.internal_key_hash = vkd3d_pipeline_blob_compute_internal_key_hash(spirv->data, varint_size);
 
         /* In stream archives, checksums are handled at the outer layer, just ignore them here. */
         if (!pipeline_library || !(pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE))
@@ -931,13 +1520,10 @@ static void vkd3d_shader_code_serialize_referenced(struct d3d12_pipeline_library
         else
             internal->checksum = 0;
 
-        /* For duplicate, we won't insert. Just free the blob. */
-        if (!d3d12_pipeline_library_insert_hash_map_blob_internal(pipeline_library,
-                &pipeline_library->spirv_cache_map, &entry))
-        {
-            vkd3d_free(internal);
-        }
-        else if (pipeline_library->disk_cache_listener)
+        /* For duplicate, we won't insert and the blob is freed. */
+        if (d3d12_pipeline_library_insert_shared_blob_internal(pipeline_library,
+                &pipeline_library->spirv_cache_map, &entry, VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_SPIRV) &&
+                pipeline_library->disk_cache_listener)
         {
             vkd3d_pipeline_library_disk_cache_notify_blob_insert(pipeline_library->disk_cache_listener,
                     entry.key.internal_key_hash,
@@ -1021,6 +1607,8 @@ static VkResult vkd3d_serialize_pipeline_state_referenced(struct d3d12_pipeline_
         size_t vk_pipeline_cache_size, const size_t *varint_size)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &state->device->vk_procs;
+    struct vkd3d_pipeline_blob_internal *compressed_internal;
+    struct vkd3d_pipeline_blob_chunk_driver_cache *driver_cache;
     struct vkd3d_pipeline_blob_internal *internal;
     struct vkd3d_pipeline_blob_chunk_link *link;
     struct vkd3d_cached_pipeline_entry entry;
@@ -1032,21 +1620,28 @@ static VkResult vkd3d_serialize_pipeline_state_referenced(struct d3d12_pipeline_
     entry.key.name_length = 0;
     entry.key.name = NULL;
     entry.data.is_new = 1;
+    entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+    entry.data.stream_type = 0;
     entry.data.state = NULL;
 
     if (state->vk_pso_cache && (pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_SAVE_PSO_BLOB))
     {
-        entry.data.blob_length = sizeof(*internal) + vk_pipeline_cache_size;
-        internal = vkd3d_malloc(entry.data.blob_length);
-        entry.data.blob = internal;
+        entry.data.blob_length = sizeof(*internal) + sizeof(*driver_cache) + vk_pipeline_cache_size;
+        if (!(internal = vkd3d_malloc(entry.data.blob_length)))
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+        driver_cache = CAST_CHUNK_DATA(internal, driver_cache);
+        driver_cache->encoding = VKD3D_PIPELINE_BLOB_ENCODING_RAW;
+        driver_cache->decompressed_size = vk_pipeline_cache_size;
 
         reference_size = vk_pipeline_cache_size;
         /* In case driver leaves uninitialized memory for blob data. */
-        memset(internal->data, 0, vk_pipeline_cache_size);
+        memset(driver_cache->data, 0, vk_pipeline_cache_size);
         if ((vr = VK_CALL(vkGetPipelineCacheData(state->device->vk_device, state->vk_pso_cache,
-                &reference_size, internal->data))))
+                &reference_size, driver_cache->data))))
         {
             FIXME("Failed to serialize pipeline cache data, vr %d.\n", vr);
+            vkd3d_free(internal);
             return vr;
         }
 
@@ -1057,23 +1652,33 @@ static VkResult vkd3d_serialize_pipeline_state_referenced(struct d3d12_pipeline_
                     (unsigned int)vk_pipeline_cache_size);
         }
 
-        blob.code = internal->data;
+        /* Key on the raw data so that de-dupe does not depend on the encoding. */
+        blob.code = driver_cache->data;
         blob.size = vk_pipeline_cache_size;
-        entry.key.internal_key_hash = vkd3d_shader_hash(&blob);
+        entry.key.internal_key_hash = vkd3d_pipeline_blob_compute_internal_key_hash(blob.code, blob.size);
+
+        if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_COMPRESS) &&
+                (compressed_internal = vkd3d_pipeline_blob_compress_driver_cache(internal, &entry.data.blob_length)))
+        {
+            vkd3d_free(internal);
+            internal = compressed_internal;
+        }
+
+        entry.data.blob = internal;
 
         /* In stream archives, checksums are handled at the outer layer, just ignore them here. */
         if (!pipeline_library || !(pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE))
-            internal->checksum = vkd3d_pipeline_blob_compute_data_checksum(blob.code, blob.size);
+        {
+            internal->checksum = vkd3d_pipeline_blob_compute_data_checksum(internal->data,
+                    entry.data.blob_length - sizeof(*internal));
+        }
         else
             internal->checksum = 0;
 
-        /* For duplicate, we won't insert. Just free the blob. */
-        if (!d3d12_pipeline_library_insert_hash_map_blob_internal(pipeline_library,
-                &pipeline_library->driver_cache_map, &entry))
-        {
-            vkd3d_free(internal);
-        }
-        else if (pipeline_library->disk_cache_listener)
+        /* For duplicate, we won't insert and the blob is freed. */
+        if (d3d12_pipeline_library_insert_shared_blob_internal(pipeline_library,
+                &pipeline_library->driver_cache_map, &entry, VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_DRIVER_CACHE) &&
+                pipeline_library->disk_cache_listener)
         {
             vkd3d_pipeline_library_disk_cache_notify_blob_insert(pipeline_library->disk_cache_listener,
                     entry.key.internal_key_hash,
@@ -1150,6 +1755,9 @@ VkResult vkd3d_serialize_pipeline_state(struct d3d12_pipeline_library *pipeline_
     unsigned int i;
     VkResult vr;
 
+    /* The pipeline cache is only complete once the primary pipeline is compiled. */
+    d3d12_pipeline_state_wait_async_compile((struct d3d12_pipeline_state *)state);
+
     need_blob_sizes = !pipeline_library || data;
 
     /* PSO compatibility information is global to a PSO. */
@@ -1314,8 +1922,8 @@ struct vkd3d_serialized_pipeline_toc_entry
 };
 STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_toc_entry) == 16);
 
-#define VKD3D_PIPELINE_LIBRARY_VERSION_TOC MAKE_MAGIC('V','K','L',4)
-#define VKD3D_PIPELINE_LIBRARY_VERSION_STREAM MAKE_MAGIC('V','K','S',4)
+#define VKD3D_PIPELINE_LIBRARY_VERSION_TOC MAKE_MAGIC('V','K','L',6)
+#define VKD3D_PIPELINE_LIBRARY_VERSION_STREAM MAKE_MAGIC('V','K','S',6)
 
 struct vkd3d_serialized_pipeline_library_toc
 {
@@ -1397,7 +2005,43 @@ STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_library_stream) ==
         offsetof(struct vkd3d_serialized_pipeline_library_stream, entries));
 STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_library_stream) == 32 + VK_UUID_SIZE);
 
-/* ID3D12PipelineLibrary */
+/* Sidecar index for the on-disk stream archive. It is a compact table of contents which lets us
+ * populate the hash maps in O(entries) without faulting in every payload of a cold archive at startup.
+ * The index is only trusted if it matches the archive it was built from. */
+#define VKD3D_PIPELINE_STREAM_INDEX_VERSION 2
+
+struct vkd3d_serialized_pipeline_stream_index_entry
+{
+    uint64_t hash;
+    uint64_t checksum;
+    uint64_t offset; /* Offset of the vkd3d_serialized_pipeline_stream_entry header within the archive. */
+    uint32_t size;
+    uint32_t type;
+};
+STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_stream_index_entry) == 32);
+
+struct vkd3d_serialized_pipeline_stream_index
+{
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t archive_size;
+    uint64_t checksum; /* Checksum of the entries. */
+    uint64_t reserved;
+    struct vkd3d_serialized_pipeline_library_stream archive_header;
+    struct vkd3d_serialized_pipeline_stream_index_entry entries[];
+};
+STATIC_ASSERT(sizeof(struct vkd3d_serialized_pipeline_stream_index) ==
+        offsetof(struct vkd3d_serialized_pipeline_stream_index, entries));
+
+struct vkd3d_pipeline_library_stream_index_builder
+{
+    struct vkd3d_serialized_pipeline_stream_index_entry *entries;
+    size_t entries_size;
+    size_t entries_count;
+    bool complete;
+};
+
+/* ID3D12PipelineLibrary */
 static inline struct d3d12_pipeline_library *impl_from_ID3D12PipelineLibrary(d3d12_pipeline_library_iface *iface)
 {
     return CONTAINING_RECORD(iface, struct d3d12_pipeline_library, ID3D12PipelineLibrary_iface);
@@ -1420,7 +2064,8 @@ static void d3d12_pipeline_library_serialize_entry(
     memcpy(data + blob_offset, entry->data.blob, entry->data.blob_length);
 }
 
-static void d3d12_pipeline_library_cleanup_map(struct hash_map *map)
+static void d3d12_pipeline_library_cleanup_map(struct d3d12_pipeline_library *pipeline_library,
+        struct hash_map *map, uint32_t type)
 {
     size_t i;
 
@@ -1430,7 +2075,12 @@ static void d3d12_pipeline_library_cleanup_map(struct hash_map *map)
 
         if (e->entry.flags & HASH_MAP_ENTRY_OCCUPIED)
         {
-            if (e->data.is_new)
+            if (e->data.is_new == VKD3D_CACHED_PIPELINE_BLOB_SHARED)
+            {
+                vkd3d_pipeline_blob_store_release(&pipeline_library->device->pipeline_blob_store,
+                        type, e->key.internal_key_hash, e->data.blob, e->data.blob_length);
+            }
+            else if (e->data.is_new)
             {
                 vkd3d_free((void*)e->key.name);
                 vkd3d_free((void*)e->data.blob);
@@ -1446,12 +2096,23 @@ static void d3d12_pipeline_library_cleanup_map(struct hash_map *map)
 
 static void d3d12_pipeline_library_cleanup(struct d3d12_pipeline_library *pipeline_library, struct d3d12_device *device)
 {
-    d3d12_pipeline_library_cleanup_map(&pipeline_library->pso_map);
-    d3d12_pipeline_library_cleanup_map(&pipeline_library->driver_cache_map);
-    d3d12_pipeline_library_cleanup_map(&pipeline_library->spirv_cache_map);
+    unsigned int i;
 
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+    {
+        d3d12_pipeline_library_cleanup_map(pipeline_library, &pipeline_library->pso_shards[i].map,
+                VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE);
+        rwlock_destroy(&pipeline_library->pso_shards[i].lock);
+    }
+
+    d3d12_pipeline_library_cleanup_map(pipeline_library, &pipeline_library->driver_cache_map,
+            VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_DRIVER_CACHE);
+    d3d12_pipeline_library_cleanup_map(pipeline_library, &pipeline_library->spirv_cache_map,
+            VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_SPIRV);
+
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_PIPELINE_LIBRARY,
+            -(int64_t)pipeline_library->footprint_size);
     vkd3d_private_store_destroy(&pipeline_library->private_store);
-    rwlock_destroy(&pipeline_library->mutex);
     rwlock_destroy(&pipeline_library->internal_hashmap_mutex);
 }
 
@@ -1573,6 +2234,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_StorePipeline(d3d12_pipe
 {
     struct d3d12_pipeline_library *pipeline_library = impl_from_ID3D12PipelineLibrary(iface);
     struct d3d12_pipeline_state *pipeline_state = impl_from_ID3D12PipelineState(pipeline);
+    struct d3d12_pipeline_library_shard *shard;
     struct vkd3d_cached_pipeline_entry entry;
     void *new_name, *new_blob;
     VkResult vr;
@@ -1584,27 +2246,29 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_StorePipeline(d3d12_pipe
     if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
         INFO("Serializing pipeline to library.\n");
 
-    if ((rc = rwlock_lock_read(&pipeline_library->mutex)))
+    entry.key.name_length = vkd3d_wcslen(name) * sizeof(WCHAR);
+    entry.key.name = name;
+    entry.key.internal_key_hash = 0;
+
+    shard = d3d12_pipeline_library_get_shard(pipeline_library, &entry.key);
+
+    if ((rc = rwlock_lock_read(&shard->lock)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         return hresult_from_errno(rc);
     }
 
-    entry.key.name_length = vkd3d_wcslen(name) * sizeof(WCHAR);
-    entry.key.name = name;
-    entry.key.internal_key_hash = 0;
-
-    if (hash_map_find(&pipeline_library->pso_map, &entry.key))
+    if (hash_map_find(&shard->map, &entry.key))
     {
         WARN("Pipeline %s already exists.\n", debugstr_w(name));
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_INVALIDARG;
     }
 
     /* We need to allocate persistent storage for the name */
     if (!(new_name = vkd3d_malloc(entry.key.name_length)))
     {
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_OUTOFMEMORY;
     }
 
@@ -1614,14 +2278,14 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_StorePipeline(d3d12_pipe
     if (FAILED(vr = vkd3d_serialize_pipeline_state(pipeline_library, pipeline_state, &entry.data.blob_length, NULL)))
     {
         vkd3d_free(new_name);
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return hresult_from_vk_result(vr);
     }
 
     if (!(new_blob = vkd3d_malloc(entry.data.blob_length)))
     {
         vkd3d_free(new_name);
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_OUTOFMEMORY;
     }
 
@@ -1629,18 +2293,20 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_StorePipeline(d3d12_pipe
     {
         vkd3d_free(new_name);
         vkd3d_free(new_blob);
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return hresult_from_vk_result(vr);
     }
 
-    rwlock_unlock_read(&pipeline_library->mutex);
+    rwlock_unlock_read(&shard->lock);
 
     entry.data.blob = new_blob;
     entry.data.is_new = 1;
+    entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+    entry.data.stream_type = 0;
     entry.data.state = pipeline_state;
 
     /* Now is the time to promote to a writer lock. */
-    if ((rc = rwlock_lock_write(&pipeline_library->mutex)))
+    if ((rc = rwlock_lock_write(&shard->lock)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         vkd3d_free(new_name);
@@ -1649,12 +2315,12 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_StorePipeline(d3d12_pipe
     }
 
     /* Detected duplicate late, but be accurate in how we report this. */
-    if (hash_map_find(&pipeline_library->pso_map, &entry.key))
+    if (hash_map_find(&shard->map, &entry.key))
     {
         WARN("Pipeline %s already exists.\n", debugstr_w(name));
         hr = E_INVALIDARG;
     }
-    else if (!d3d12_pipeline_library_insert_hash_map_blob_locked(pipeline_library, &pipeline_library->pso_map, &entry))
+    else if (!d3d12_pipeline_library_shard_insert_locked(pipeline_library, shard, &entry))
     {
         /* This path shouldn't happen unless there are OOM scenarios. */
         hr = E_OUTOFMEMORY;
@@ -1667,7 +2333,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_StorePipeline(d3d12_pipe
         hr = S_OK;
     }
 
-    rwlock_unlock_write(&pipeline_library->mutex);
+    rwlock_unlock_write(&shard->lock);
 
     if (FAILED(hr))
     {
@@ -1682,6 +2348,7 @@ static HRESULT d3d12_pipeline_library_load_pipeline(struct d3d12_pipeline_librar
         VkPipelineBindPoint bind_point, struct d3d12_pipeline_state_desc *desc, struct d3d12_pipeline_state **state)
 {
     struct vkd3d_pipeline_cache_compatibility pipeline_cache_compat;
+    struct d3d12_pipeline_library_shard *shard;
     const struct vkd3d_cached_pipeline_entry *e;
     struct d3d12_pipeline_state *existing_state;
     struct d3d12_root_signature *root_signature;
@@ -1690,19 +2357,21 @@ static HRESULT d3d12_pipeline_library_load_pipeline(struct d3d12_pipeline_librar
     HRESULT hr;
     int rc;
 
-    if ((rc = rwlock_lock_read(&pipeline_library->mutex)))
+    key.name_length = vkd3d_wcslen(name) * sizeof(WCHAR);
+    key.name = name;
+
+    shard = d3d12_pipeline_library_get_shard(pipeline_library, &key);
+
+    if ((rc = rwlock_lock_read(&shard->lock)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         return hresult_from_errno(rc);
     }
 
-    key.name_length = vkd3d_wcslen(name) * sizeof(WCHAR);
-    key.name = name;
-
-    if (!(e = (const struct vkd3d_cached_pipeline_entry*)hash_map_find(&pipeline_library->pso_map, &key)))
+    if (!(e = (const struct vkd3d_cached_pipeline_entry*)hash_map_find(&shard->map, &key)))
     {
         WARN("Pipeline %s does not exist.\n", debugstr_w(name));
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_INVALIDARG;
     }
 
@@ -1713,11 +2382,12 @@ static HRESULT d3d12_pipeline_library_load_pipeline(struct d3d12_pipeline_librar
 
     if (cached_state)
     {
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
 
         /* If we have handed out the PSO once, just need to do a quick validation. */
         memset(&pipeline_cache_compat, 0, sizeof(pipeline_cache_compat));
-        vkd3d_pipeline_cache_compat_from_state_desc(&pipeline_cache_compat, desc);
+        vkd3d_pipeline_cache_compat_from_state_desc(&pipeline_cache_compat,
+                pipeline_library->device, desc);
 
         if (desc->root_signature)
         {
@@ -1752,7 +2422,7 @@ static HRESULT d3d12_pipeline_library_load_pipeline(struct d3d12_pipeline_librar
         desc->cached_pso.blob.CachedBlobSizeInBytes = e->data.blob_length;
         desc->cached_pso.blob.pCachedBlob = e->data.blob;
         desc->cached_pso.library = pipeline_library;
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
 
         /* Don't hold locks while creating pipeline, it takes *some* time to validate and decompress stuff,
          * and in heavily multi-threaded scenarios we want to go as wide as we can. */
@@ -1760,11 +2430,11 @@ static HRESULT d3d12_pipeline_library_load_pipeline(struct d3d12_pipeline_librar
             return hr;
 
         /* These really should not fail ... */
-        rwlock_lock_read(&pipeline_library->mutex);
-        e = (const struct vkd3d_cached_pipeline_entry*)hash_map_find(&pipeline_library->pso_map, &key);
+        rwlock_lock_read(&shard->lock);
+        e = (const struct vkd3d_cached_pipeline_entry*)hash_map_find(&shard->map, &key);
         existing_state = vkd3d_atomic_ptr_compare_exchange(&e->data.state, NULL, cached_state,
                 vkd3d_memory_order_acq_rel, vkd3d_memory_order_acquire);
-        rwlock_unlock_read(&pipeline_library->mutex);
+        rwlock_unlock_read(&shard->lock);
 
         if (!existing_state)
         {
@@ -1837,23 +2507,44 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_LoadComputePipeline(d3d1
 
 static size_t d3d12_pipeline_library_get_aligned_name_table_size(struct d3d12_pipeline_library *pipeline_library)
 {
-    return align(pipeline_library->total_name_table_size, VKD3D_PIPELINE_BLOB_ALIGN);
+    size_t total_size = pipeline_library->total_name_table_size;
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+        total_size += pipeline_library->pso_shards[i].total_name_table_size;
+
+    return align(total_size, VKD3D_PIPELINE_BLOB_ALIGN);
+}
+
+static uint32_t d3d12_pipeline_library_get_pipeline_count(struct d3d12_pipeline_library *pipeline_library)
+{
+    uint32_t count = 0;
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+        count += pipeline_library->pso_shards[i].map.used_count;
+
+    return count;
 }
 
 static size_t d3d12_pipeline_library_get_serialized_size(struct d3d12_pipeline_library *pipeline_library)
 {
     size_t total_size = 0;
+    unsigned int i;
 
     /* Stream archives are not serialized as a monolithic blob. */
     if (pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE)
         return 0;
 
     total_size += sizeof(struct vkd3d_serialized_pipeline_library_toc);
-    total_size += sizeof(struct vkd3d_serialized_pipeline_toc_entry) * pipeline_library->pso_map.used_count;
+    total_size += sizeof(struct vkd3d_serialized_pipeline_toc_entry) *
+            d3d12_pipeline_library_get_pipeline_count(pipeline_library);
     total_size += sizeof(struct vkd3d_serialized_pipeline_toc_entry) * pipeline_library->spirv_cache_map.used_count;
     total_size += sizeof(struct vkd3d_serialized_pipeline_toc_entry) * pipeline_library->driver_cache_map.used_count;
     total_size += d3d12_pipeline_library_get_aligned_name_table_size(pipeline_library);
     total_size += pipeline_library->total_blob_size;
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+        total_size += pipeline_library->pso_shards[i].total_blob_size;
 
     return total_size;
 }
@@ -1866,7 +2557,7 @@ static SIZE_T STDMETHODCALLTYPE d3d12_pipeline_library_GetSerializedSize(d3d12_p
 
     TRACE("iface %p.\n", iface);
 
-    if ((rc = rwlock_lock_read(&pipeline_library->mutex)))
+    if ((rc = d3d12_pipeline_library_lock_shards_read(pipeline_library)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         return 0;
@@ -1875,14 +2566,14 @@ static SIZE_T STDMETHODCALLTYPE d3d12_pipeline_library_GetSerializedSize(d3d12_p
     if ((rc = rwlock_lock_read(&pipeline_library->internal_hashmap_mutex)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
-        rwlock_unlock_read(&pipeline_library->mutex);
+        d3d12_pipeline_library_unlock_shards_read(pipeline_library);
         return 0;
     }
 
     total_size = d3d12_pipeline_library_get_serialized_size(pipeline_library);
 
-    rwlock_unlock_read(&pipeline_library->mutex);
     rwlock_unlock_read(&pipeline_library->internal_hashmap_mutex);
+    d3d12_pipeline_library_unlock_shards_read(pipeline_library);
     return total_size;
 }
 
@@ -1936,12 +2627,49 @@ static void d3d12_pipeline_library_serialize_stream_archive_header(struct d3d12_
         memset(header->cache_uuid, 0, VK_UUID_SIZE);
 }
 
+/* Below this size, handing shards to workers costs more than it saves. */
+#define VKD3D_PIPELINE_LIBRARY_SERIALIZE_PARALLEL_THRESHOLD (4u << 20)
+
+/* Unit 0 holds the internal SPIR-V and driver cache maps, which share running totals,
+ * the remaining units hold one PSO shard each. */
+#define VKD3D_PIPELINE_LIBRARY_SERIALIZE_UNIT_COUNT (1 + VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT)
+
+struct vkd3d_pipeline_library_serialize_task
+{
+    struct vkd3d_job task;
+    const struct hash_map *maps[2];
+    unsigned int map_count;
+    struct vkd3d_serialized_pipeline_toc_entry *toc_entries;
+    uint8_t *serialized_data;
+    size_t name_offset;
+    size_t blob_offset;
+    /* Blob offset after each map, only used for logging. */
+    size_t blob_end_offsets[2];
+};
+
+static void vkd3d_pipeline_library_serialize_task_run(void *userdata)
+{
+    struct vkd3d_pipeline_library_serialize_task *task = userdata;
+    unsigned int i;
+
+    for (i = 0; i < task->map_count; i++)
+    {
+        d3d12_pipeline_library_serialize_hash_map(task->maps[i], &task->toc_entries,
+                task->serialized_data, &task->name_offset, &task->blob_offset);
+        task->blob_end_offsets[i] = task->blob_offset;
+    }
+}
+
 static HRESULT d3d12_pipeline_library_serialize(struct d3d12_pipeline_library *pipeline_library,
         void *data, size_t data_size)
 {
+    struct vkd3d_pipeline_library_serialize_task tasks[VKD3D_PIPELINE_LIBRARY_SERIALIZE_UNIT_COUNT];
     const VkPhysicalDeviceProperties *device_properties = &pipeline_library->device->device_info.properties2.properties;
+    struct vkd3d_job_pool *pool = &pipeline_library->device->job_pool;
     struct vkd3d_serialized_pipeline_library_toc *header = data;
     struct vkd3d_serialized_pipeline_toc_entry *toc_entries;
+    const struct d3d12_pipeline_library_shard *shard;
+    struct vkd3d_pipeline_library_serialize_task *task;
     uint64_t driver_cache_size;
     uint8_t *serialized_data;
     size_t total_toc_entries;
@@ -1950,6 +2678,8 @@ static HRESULT d3d12_pipeline_library_serialize(struct d3d12_pipeline_library *p
     size_t name_offset;
     size_t blob_offset;
     uint64_t pso_size;
+    bool use_workers;
+    unsigned int i;
 
     /* Stream archives are not serialized as a monolithic blob. */
     if (pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE)
@@ -1962,7 +2692,7 @@ static HRESULT d3d12_pipeline_library_serialize(struct d3d12_pipeline_library *p
     header->version = VKD3D_PIPELINE_LIBRARY_VERSION_TOC;
     header->vendor_id = device_properties->vendorID;
     header->device_id = device_properties->deviceID;
-    header->pipeline_count = pipeline_library->pso_map.used_count;
+    header->pipeline_count = d3d12_pipeline_library_get_pipeline_count(pipeline_library);
     header->spirv_count = pipeline_library->spirv_cache_map.used_count;
     header->driver_cache_count = pipeline_library->driver_cache_map.used_count;
     header->vkd3d_build = vkd3d_build;
@@ -1986,21 +2716,68 @@ static HRESULT d3d12_pipeline_library_serialize(struct d3d12_pipeline_library *p
     name_offset = 0;
     blob_offset = d3d12_pipeline_library_get_aligned_name_table_size(pipeline_library);
 
-    spirv_size = blob_offset;
-    d3d12_pipeline_library_serialize_hash_map(&pipeline_library->spirv_cache_map, &toc_entries,
-            serialized_data, &name_offset, &blob_offset);
-    spirv_size = blob_offset - spirv_size;
+    /* The running totals give every unit its TOC, name and blob offsets up front,
+     * so units can be written independently. */
+    memset(tasks, 0, sizeof(tasks));
+    tasks[0].maps[0] = &pipeline_library->spirv_cache_map;
+    tasks[0].maps[1] = &pipeline_library->driver_cache_map;
+    tasks[0].map_count = 2;
+    tasks[0].toc_entries = toc_entries;
+    tasks[0].name_offset = name_offset;
+    tasks[0].blob_offset = blob_offset;
+
+    toc_entries += header->spirv_count + header->driver_cache_count;
+    name_offset += pipeline_library->total_name_table_size;
+    blob_offset += pipeline_library->total_blob_size;
+    pso_size = blob_offset;
 
-    driver_cache_size = blob_offset;
-    d3d12_pipeline_library_serialize_hash_map(&pipeline_library->driver_cache_map, &toc_entries,
-            serialized_data, &name_offset, &blob_offset);
-    driver_cache_size = blob_offset - driver_cache_size;
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+    {
+        shard = &pipeline_library->pso_shards[i];
+        task = &tasks[i + 1];
+        task->maps[0] = &shard->map;
+        task->map_count = 1;
+        task->toc_entries = toc_entries;
+        task->name_offset = name_offset;
+        task->blob_offset = blob_offset;
+
+        toc_entries += shard->map.used_count;
+        name_offset += shard->total_name_table_size;
+        blob_offset += shard->total_blob_size;
+    }
 
-    pso_size = blob_offset;
-    d3d12_pipeline_library_serialize_hash_map(&pipeline_library->pso_map, &toc_entries,
-            serialized_data, &name_offset, &blob_offset);
     pso_size = blob_offset - pso_size;
 
+    for (i = 0; i < ARRAY_SIZE(tasks); i++)
+    {
+        tasks[i].serialized_data = serialized_data;
+        tasks[i].task.callback = vkd3d_pipeline_library_serialize_task_run;
+        tasks[i].task.userdata = &tasks[i];
+    }
+
+    use_workers = pool->thread_count && required_size >= VKD3D_PIPELINE_LIBRARY_SERIALIZE_PARALLEL_THRESHOLD;
+
+    if (use_workers)
+    {
+        for (i = 1; i < ARRAY_SIZE(tasks); i++)
+            if (tasks[i].maps[0]->used_count)
+                vkd3d_job_pool_enqueue(pool, &tasks[i].task);
+    }
+
+    vkd3d_pipeline_library_serialize_task_run(&tasks[0]);
+
+    for (i = 1; i < ARRAY_SIZE(tasks); i++)
+    {
+        /* Empty units are never queued. */
+        if (!use_workers)
+            vkd3d_pipeline_library_serialize_task_run(&tasks[i]);
+        else if (tasks[i].maps[0]->used_count)
+            vkd3d_job_pool_wait(pool, &tasks[i].task);
+    }
+
+    spirv_size = tasks[0].blob_end_offsets[0] - d3d12_pipeline_library_get_aligned_name_table_size(pipeline_library);
+    driver_cache_size = tasks[0].blob_end_offsets[1] - tasks[0].blob_end_offsets[0];
+
     if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
     {
         INFO("Serializing pipeline library (%"PRIu64" bytes):\n"
@@ -2029,7 +2806,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_Serialize(d3d12_pipeline
 
     TRACE("iface %p.\n", iface);
 
-    if ((rc = rwlock_lock_read(&pipeline_library->mutex)))
+    if ((rc = d3d12_pipeline_library_lock_shards_read(pipeline_library)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         return E_FAIL;
@@ -2038,13 +2815,13 @@ static HRESULT STDMETHODCALLTYPE d3d12_pipeline_library_Serialize(d3d12_pipeline
     if ((rc = rwlock_lock_read(&pipeline_library->internal_hashmap_mutex)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
-        rwlock_unlock_read(&pipeline_library->mutex);
+        d3d12_pipeline_library_unlock_shards_read(pipeline_library);
         return E_FAIL;
     }
 
     hr = d3d12_pipeline_library_serialize(pipeline_library, data, data_size);
-    rwlock_unlock_read(&pipeline_library->mutex);
     rwlock_unlock_read(&pipeline_library->internal_hashmap_mutex);
+    d3d12_pipeline_library_unlock_shards_read(pipeline_library);
     return hr;
 }
 
@@ -2100,7 +2877,7 @@ static CONST_VTBL struct ID3D12PipelineLibrary1Vtbl d3d12_pipeline_library_vtbl
 static HRESULT d3d12_pipeline_library_unserialize_hash_map(
         struct d3d12_pipeline_library *pipeline_library,
         const struct vkd3d_serialized_pipeline_toc_entry *entries,
-        size_t entries_count, struct hash_map *map,
+        size_t entries_count, uint32_t type /* vkd3d_serialized_pipeline_stream_entry_type */,
         const uint8_t *serialized_data_base, size_t serialized_data_size,
         const uint8_t **inout_name_table)
 {
@@ -2143,9 +2920,11 @@ static HRESULT d3d12_pipeline_library_unserialize_hash_map(
         entry.data.blob_length = toc_entry->blob_length;
         entry.data.blob = serialized_data_base + toc_entry->blob_offset;
         entry.data.is_new = 0;
+        entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+        entry.data.stream_type = 0;
         entry.data.state = NULL;
 
-        if (!d3d12_pipeline_library_insert_hash_map_blob_locked(pipeline_library, map, &entry))
+        if (!d3d12_pipeline_library_insert_blob_locked(pipeline_library, type, &entry))
             return E_OUTOFMEMORY;
     }
 
@@ -2189,24 +2968,97 @@ static HRESULT d3d12_pipeline_library_validate_stream_format_header(struct d3d12
     return S_OK;
 }
 
+struct vkd3d_pipeline_library_stream_stats
+{
+    uint32_t spirv_count;
+    uint32_t driver_cache_count;
+    uint32_t pipeline_count;
+};
+
+static void d3d12_pipeline_library_insert_stream_entry(struct d3d12_pipeline_library *pipeline_library,
+        const struct vkd3d_cached_pipeline_entry *entry, struct vkd3d_pipeline_library_stream_stats *stats)
+{
+    struct d3d12_pipeline_library_shard *shard;
+    struct hash_map *map = NULL;
+
+    switch (entry->data.stream_type)
+    {
+        case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_SPIRV:
+            map = &pipeline_library->spirv_cache_map;
+            stats->spirv_count++;
+            break;
+
+        case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_DRIVER_CACHE:
+            map = &pipeline_library->driver_cache_map;
+            stats->driver_cache_count++;
+            break;
+
+        case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE:
+            stats->pipeline_count++;
+            break;
+
+        default:
+            FIXME("Unrecognized type %u.\n", entry->data.stream_type);
+            return;
+    }
+
+    /* If async flag is set it means we're parsing from a thread, and we must lock since application
+     * might be busy trying to create pipelines at this time.
+     * If we're parsing at device init, we don't need to lock. */
+    if (pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE_PARSE_ASYNC)
+    {
+        if (entry->data.stream_type == VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE)
+        {
+            /* Pipeline entries are handled with the shard lock. */
+            shard = d3d12_pipeline_library_get_shard(pipeline_library, &entry->key);
+            rwlock_lock_write(&shard->lock);
+            d3d12_pipeline_library_shard_insert_locked(pipeline_library, shard, entry);
+            rwlock_unlock_write(&shard->lock);
+        }
+        else
+        {
+            /* Non-PSO caches use the internal lock implicitly here. */
+            d3d12_pipeline_library_insert_hash_map_blob_internal(pipeline_library, map, entry);
+        }
+    }
+    else
+        d3d12_pipeline_library_insert_blob_locked(pipeline_library, entry->data.stream_type, entry);
+}
+
+static void d3d12_pipeline_library_log_stream_stats(const struct vkd3d_pipeline_library_stream_stats *stats,
+        uint64_t blob_length)
+{
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
+    {
+        INFO("Loading stream pipeline library (%"PRIu64" bytes):\n"
+                "  D3D12 PSO count: %u\n"
+                "  Unique SPIR-V count: %u\n"
+                "  Unique VkPipelineCache count: %u\n",
+                blob_length,
+                stats->pipeline_count,
+                stats->spirv_count,
+                stats->driver_cache_count);
+    }
+}
+
 static HRESULT d3d12_pipeline_library_read_blob_stream_format(struct d3d12_pipeline_library *pipeline_library,
-        struct d3d12_device *device, const void *blob, size_t blob_length)
+        struct d3d12_device *device, const void *blob, size_t blob_length,
+        struct vkd3d_pipeline_library_stream_index_builder *index_builder)
 {
     const struct vkd3d_serialized_pipeline_library_stream *header = blob;
+    struct vkd3d_serialized_pipeline_stream_index_entry *index_entry;
     const struct vkd3d_serialized_pipeline_stream_entry *entries;
+    struct vkd3d_pipeline_library_stream_stats stats;
     struct vkd3d_cached_pipeline_entry entry;
     uint64_t blob_length_saved = blob_length;
-    uint32_t driver_cache_count = 0;
-    uint32_t pipeline_count = 0;
     bool early_teardown = false;
-    uint32_t spirv_count = 0;
     uint32_t aligned_size;
-    struct hash_map *map;
     HRESULT hr;
 
     if (FAILED(hr = d3d12_pipeline_library_validate_stream_format_header(pipeline_library, device, blob, blob_length)))
         return hr;
 
+    memset(&stats, 0, sizeof(stats));
     entries = (const struct vkd3d_serialized_pipeline_stream_entry *)header->entries;
     blob_length -= offsetof(struct vkd3d_serialized_pipeline_library_stream, entries);
 
@@ -2245,71 +3097,90 @@ static HRESULT d3d12_pipeline_library_read_blob_stream_format(struct d3d12_pipel
         /* The read-only portion of the stream archive is backed by mmap so we avoid committing too much memory.
          * Similar idea as normal application pipeline libraries. */
         entry.data.is_new = 0;
+        entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+        entry.data.stream_type = entries->type;
         entry.data.state = NULL;
 
-        switch (entries->type)
+        d3d12_pipeline_library_insert_stream_entry(pipeline_library, &entry, &stats);
+
+        if (index_builder && vkd3d_array_reserve((void **)&index_builder->entries, &index_builder->entries_size,
+                index_builder->entries_count + 1, sizeof(*index_builder->entries)))
         {
-            case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_SPIRV:
-                map = &pipeline_library->spirv_cache_map;
-                spirv_count++;
-                break;
+            index_entry = &index_builder->entries[index_builder->entries_count++];
+            index_entry->hash = entries->hash;
+            index_entry->checksum = entries->checksum;
+            index_entry->offset = (const uint8_t *)entries - (const uint8_t *)blob;
+            index_entry->size = entries->size;
+            index_entry->type = entries->type;
+        }
+
+        blob_length -= aligned_size;
+        entries = (const struct vkd3d_serialized_pipeline_stream_entry *)&entries->data[aligned_size];
+    }
+
+    /* An index of a partially parsed archive is useless, since it would hide entries on next load. */
+    if (index_builder)
+        index_builder->complete = !early_teardown;
+
+    if (!early_teardown)
+        d3d12_pipeline_library_log_stream_stats(&stats, blob_length_saved);
+
+    return S_OK;
+}
 
-            case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_DRIVER_CACHE:
-                map = &pipeline_library->driver_cache_map;
-                driver_cache_count++;
-                break;
+static HRESULT d3d12_pipeline_library_read_blob_stream_index(struct d3d12_pipeline_library *pipeline_library,
+        struct d3d12_device *device, const void *blob, size_t blob_length,
+        const struct vkd3d_serialized_pipeline_stream_index *index)
+{
+    const struct vkd3d_serialized_pipeline_stream_index_entry *index_entry;
+    struct vkd3d_pipeline_library_stream_stats stats;
+    struct vkd3d_cached_pipeline_entry entry;
+    uint32_t i;
+    HRESULT hr;
 
-            case VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE:
-                map = &pipeline_library->pso_map;
-                pipeline_count++;
-                break;
+    if (FAILED(hr = d3d12_pipeline_library_validate_stream_format_header(pipeline_library, device, blob, blob_length)))
+        return hr;
 
-            default:
-                FIXME("Unrecognized type %u.\n", entries->type);
-                map = NULL;
-                break;
+    memset(&stats, 0, sizeof(stats));
+
+    for (i = 0; i < index->entry_count; i++)
+    {
+        if (vkd3d_atomic_uint32_load_explicit(&pipeline_library->stream_archive_cancellation_point,
+                vkd3d_memory_order_relaxed))
+        {
+            INFO("Device teardown request received, stopping parse early.\n");
+            return S_OK;
         }
 
-        if (map)
+        index_entry = &index->entries[i];
+
+        /* The index has already been matched against this archive, but never trust offsets blindly.
+         * Payloads are not touched here, they are checksummed on first lookup. */
+        if (index_entry->offset < sizeof(struct vkd3d_serialized_pipeline_library_stream) ||
+                index_entry->offset > blob_length ||
+                blob_length - index_entry->offset < sizeof(struct vkd3d_serialized_pipeline_stream_entry) ||
+                blob_length - index_entry->offset - sizeof(struct vkd3d_serialized_pipeline_stream_entry) <
+                        align(index_entry->size, VKD3D_PIPELINE_BLOB_ALIGN))
         {
-            /* If async flag is set it means we're parsing from a thread, and we must lock since application
-             * might be busy trying to create pipelines at this time.
-             * If we're parsing at device init, we don't need to lock. */
-            if (pipeline_library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE_PARSE_ASYNC)
-            {
-                if (entries->type == VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE)
-                {
-                    /* Pipeline entries are handled with the main mutex. */
-                    rwlock_lock_write(&pipeline_library->mutex);
-                    d3d12_pipeline_library_insert_hash_map_blob_locked(pipeline_library, map, &entry);
-                    rwlock_unlock_write(&pipeline_library->mutex);
-                }
-                else
-                {
-                    /* Non-PSO caches use the internal lock implicitly here. */
-                    d3d12_pipeline_library_insert_hash_map_blob_internal(pipeline_library, map, &entry);
-                }
-            }
-            else
-                d3d12_pipeline_library_insert_hash_map_blob_locked(pipeline_library, map, &entry);
+            INFO("Stream archive index entry %u is out of bounds. Ignoring rest of index.\n", i);
+            break;
         }
 
-        blob_length -= aligned_size;
-        entries = (const struct vkd3d_serialized_pipeline_stream_entry *)&entries->data[aligned_size];
-    }
+        entry.key.name_length = 0;
+        entry.key.name = NULL;
+        entry.key.internal_key_hash = index_entry->hash;
+        entry.data.blob_length = index_entry->size;
+        entry.data.blob = (const uint8_t *)blob + index_entry->offset +
+                sizeof(struct vkd3d_serialized_pipeline_stream_entry);
+        entry.data.is_new = 0;
+        entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_PENDING;
+        entry.data.stream_type = index_entry->type;
+        entry.data.state = NULL;
 
-    if (!early_teardown && (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG))
-    {
-        INFO("Loading stream pipeline library (%"PRIu64" bytes):\n"
-                "  D3D12 PSO count: %u\n"
-                "  Unique SPIR-V count: %u\n"
-                "  Unique VkPipelineCache count: %u\n",
-                blob_length_saved,
-                pipeline_count,
-                spirv_count,
-                driver_cache_count);
+        d3d12_pipeline_library_insert_stream_entry(pipeline_library, &entry, &stats);
     }
 
+    d3d12_pipeline_library_log_stream_stats(&stats, blob_length);
     return S_OK;
 }
 
@@ -2400,21 +3271,21 @@ static HRESULT d3d12_pipeline_library_read_blob_toc_format(struct d3d12_pipeline
 
     if (FAILED(hr = d3d12_pipeline_library_unserialize_hash_map(pipeline_library,
             &header->entries[i], header->spirv_count,
-            &pipeline_library->spirv_cache_map, serialized_data_base, serialized_data_size,
+            VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_SPIRV, serialized_data_base, serialized_data_size,
             &name_table)))
         return hr;
     i += header->spirv_count;
 
     if (FAILED(hr = d3d12_pipeline_library_unserialize_hash_map(pipeline_library,
             &header->entries[i], header->driver_cache_count,
-            &pipeline_library->driver_cache_map, serialized_data_base, serialized_data_size,
+            VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_DRIVER_CACHE, serialized_data_base, serialized_data_size,
             &name_table)))
         return hr;
     i += header->driver_cache_count;
 
     if (FAILED(hr = d3d12_pipeline_library_unserialize_hash_map(pipeline_library,
             &header->entries[i], header->pipeline_count,
-            &pipeline_library->pso_map, serialized_data_base, serialized_data_size,
+            VKD3D_SERIALIZED_PIPELINE_STREAM_ENTRY_PIPELINE, serialized_data_base, serialized_data_size,
             &name_table)))
         return hr;
     i += header->pipeline_count;
@@ -2450,6 +3321,7 @@ static HRESULT d3d12_pipeline_library_init(struct d3d12_pipeline_library *pipeli
         struct d3d12_device *device, const void *blob, size_t blob_length, uint32_t flags)
 {
     bool internal_keys;
+    unsigned int i;
     HRESULT hr;
     int rc;
 
@@ -2458,6 +3330,8 @@ static HRESULT d3d12_pipeline_library_init(struct d3d12_pipeline_library *pipeli
     pipeline_library->refcount = 1;
     pipeline_library->internal_refcount = 1;
     pipeline_library->flags = flags;
+    /* Parsing the blob below already accounts memory to the device. */
+    pipeline_library->device = device;
 
     /* Mutually exclusive features. */
     if ((flags & VKD3D_PIPELINE_LIBRARY_FLAG_USE_PIPELINE_CACHE_UUID) &&
@@ -2472,13 +3346,18 @@ static HRESULT d3d12_pipeline_library_init(struct d3d12_pipeline_library *pipeli
     if (!blob_length && blob)
         return E_INVALIDARG;
 
-    if ((rc = rwlock_init(&pipeline_library->mutex)))
+    if ((rc = rwlock_init(&pipeline_library->internal_hashmap_mutex)))
         return hresult_from_errno(rc);
 
-    if ((rc = rwlock_init(&pipeline_library->internal_hashmap_mutex)))
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
     {
-        rwlock_destroy(&pipeline_library->mutex);
-        return hresult_from_errno(rc);
+        if ((rc = rwlock_init(&pipeline_library->pso_shards[i].lock)))
+        {
+            while (i--)
+                rwlock_destroy(&pipeline_library->pso_shards[i].lock);
+            rwlock_destroy(&pipeline_library->internal_hashmap_mutex);
+            return hresult_from_errno(rc);
+        }
     }
 
     internal_keys = !!(flags & VKD3D_PIPELINE_LIBRARY_FLAG_INTERNAL_KEYS);
@@ -2487,10 +3366,13 @@ static HRESULT d3d12_pipeline_library_init(struct d3d12_pipeline_library *pipeli
             vkd3d_cached_pipeline_compare_internal, sizeof(struct vkd3d_cached_pipeline_entry));
     hash_map_init(&pipeline_library->driver_cache_map, vkd3d_cached_pipeline_hash_internal,
             vkd3d_cached_pipeline_compare_internal, sizeof(struct vkd3d_cached_pipeline_entry));
-    hash_map_init(&pipeline_library->pso_map,
-            internal_keys ? vkd3d_cached_pipeline_hash_internal : vkd3d_cached_pipeline_hash_name,
-            internal_keys ? vkd3d_cached_pipeline_compare_internal : vkd3d_cached_pipeline_compare_name,
-            sizeof(struct vkd3d_cached_pipeline_entry));
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+    {
+        hash_map_init(&pipeline_library->pso_shards[i].map,
+                internal_keys ? vkd3d_cached_pipeline_hash_internal : vkd3d_cached_pipeline_hash_name,
+                internal_keys ? vkd3d_cached_pipeline_compare_internal : vkd3d_cached_pipeline_compare_name,
+                sizeof(struct vkd3d_cached_pipeline_entry));
+    }
 
     if (blob_length)
     {
@@ -2515,15 +3397,20 @@ static HRESULT d3d12_pipeline_library_init(struct d3d12_pipeline_library *pipeli
     if (FAILED(hr = vkd3d_private_store_init(&pipeline_library->private_store)))
         goto cleanup_mutex;
 
-    d3d12_device_add_ref(pipeline_library->device = device);
+    d3d12_device_add_ref(device);
     return hr;
 
 cleanup_hash_map:
-    hash_map_free(&pipeline_library->pso_map);
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+        hash_map_free(&pipeline_library->pso_shards[i].map);
     hash_map_free(&pipeline_library->spirv_cache_map);
     hash_map_free(&pipeline_library->driver_cache_map);
 cleanup_mutex:
-    rwlock_destroy(&pipeline_library->mutex);
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_PIPELINE_LIBRARY,
+            -(int64_t)pipeline_library->footprint_size);
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+        rwlock_destroy(&pipeline_library->pso_shards[i].lock);
+    rwlock_destroy(&pipeline_library->internal_hashmap_mutex);
     return hr;
 }
 
@@ -2548,8 +3435,107 @@ HRESULT d3d12_pipeline_library_create(struct d3d12_device *device, const void *b
     return S_OK;
 }
 
+uint32_t vkd3d_pipeline_library_get_application_flags(struct d3d12_device *device)
+{
+    bool use_identifiers;
+    uint32_t flags = 0;
+
+    /* If we use a disk cache, it is somewhat meaningless to use application pipeline libraries
+     * to store SPIR-V / blob.
+     * We only need to store metadata so we can implement the API correctly w.r.t. return values, and
+     * PSO reload.
+     * Otherwise, prefer shader module identifiers over full SPIR-V if the driver supports them.
+     * Identifiers are a tiny fraction of the SPIR-V size, and if the driver rejects them on reload,
+     * we recompile from the DXBC the application passes in anyway. */
+    use_identifiers = !device->disk_cache.library &&
+            device->device_info.shader_module_identifier_features.shaderModuleIdentifier;
+
+    if (use_identifiers)
+        flags |= VKD3D_PIPELINE_LIBRARY_FLAG_SHADER_IDENTIFIER;
+    else if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_NO_SERIALIZE_SPIRV) &&
+            !device->disk_cache.library)
+        flags |= VKD3D_PIPELINE_LIBRARY_FLAG_SAVE_FULL_SPIRV;
+
+    /* If we're using global pipeline caches, these are irrelevant.
+     * Do not use pipeline library blobs at all. */
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_GLOBAL_PIPELINE_CACHE))
+    {
+        flags |= VKD3D_PIPELINE_LIBRARY_FLAG_SAVE_PSO_BLOB;
+
+        /* The blob header only has room for one UUID, and identifiers take precedence.
+         * Drivers validate the header of pipeline cache data themselves and ignore stale blobs. */
+        if (!use_identifiers)
+            flags |= VKD3D_PIPELINE_LIBRARY_FLAG_USE_PIPELINE_CACHE_UUID;
+    }
+
+    return flags;
+}
+
+HRESULT vkd3d_shader_hash_cache_init(struct vkd3d_shader_hash_cache *cache)
+{
+    int rc;
+
+    memset(cache, 0, sizeof(*cache));
+
+    if ((rc = pthread_mutex_init(&cache->lock, NULL)))
+        return hresult_from_errno(rc);
+
+    return S_OK;
+}
+
+void vkd3d_shader_hash_cache_cleanup(struct vkd3d_shader_hash_cache *cache)
+{
+    pthread_mutex_destroy(&cache->lock);
+}
+
+/* DXBC containers start with the magic, followed by a checksum of the rest of the container. */
+#define VKD3D_DXBC_CHECKSUM_OFFSET 4
+#define VKD3D_DXBC_CHECKSUM_SIZE 16
+
+static vkd3d_shader_hash_t vkd3d_shader_hash_cache_get(struct vkd3d_shader_hash_cache *cache,
+        const D3D12_SHADER_BYTECODE *code)
+{
+    static const uint8_t zero_checksum[VKD3D_DXBC_CHECKSUM_SIZE];
+    const struct vkd3d_shader_code dxbc = { code->pShaderBytecode, code->BytecodeLength };
+    struct vkd3d_shader_hash_cache_entry *entry;
+    const uint8_t *checksum;
+    vkd3d_shader_hash_t hash;
+    uint32_t slot;
+
+    /* Unsigned containers have a zero checksum, and then we cannot tell reused memory apart. */
+    checksum = (const uint8_t *)code->pShaderBytecode + VKD3D_DXBC_CHECKSUM_OFFSET;
+    if (code->BytecodeLength < VKD3D_DXBC_CHECKSUM_OFFSET + VKD3D_DXBC_CHECKSUM_SIZE ||
+            memcmp(code->pShaderBytecode, "DXBC", 4) ||
+            !memcmp(checksum, zero_checksum, sizeof(zero_checksum)))
+        return vkd3d_shader_hash(&dxbc);
+
+    slot = hash_uint64((uintptr_t)code->pShaderBytecode) % ARRAY_SIZE(cache->entries);
+    entry = &cache->entries[slot];
+
+    pthread_mutex_lock(&cache->lock);
+    if (entry->code == code->pShaderBytecode && entry->size == code->BytecodeLength &&
+            !memcmp(entry->checksum, checksum, sizeof(entry->checksum)))
+    {
+        hash = entry->hash;
+        pthread_mutex_unlock(&cache->lock);
+        return hash;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    hash = vkd3d_shader_hash(&dxbc);
+
+    pthread_mutex_lock(&cache->lock);
+    entry->code = code->pShaderBytecode;
+    entry->size = code->BytecodeLength;
+    memcpy(entry->checksum, checksum, sizeof(entry->checksum));
+    entry->hash = hash;
+    pthread_mutex_unlock(&cache->lock);
+
+    return hash;
+}
+
 void vkd3d_pipeline_cache_compat_from_state_desc(struct vkd3d_pipeline_cache_compatibility *compat,
-        const struct d3d12_pipeline_state_desc *desc)
+        struct d3d12_device *device, const struct d3d12_pipeline_state_desc *desc)
 {
     const D3D12_SHADER_BYTECODE *code_list[] = {
         &desc->vs,
@@ -2683,8 +3669,8 @@ void vkd3d_pipeline_cache_compat_from_state_desc(struct vkd3d_pipeline_cache_com
     {
         if (code_list[i]->BytecodeLength)
         {
-            const struct vkd3d_shader_code dxbc = { code_list[i]->pShaderBytecode, code_list[i]->BytecodeLength };
-            compat->dxbc_blob_hashes[output_index] = vkd3d_shader_hash(&dxbc);
+            compat->dxbc_blob_hashes[output_index] = vkd3d_shader_hash_cache_get(&device->shader_hash_cache,
+                    code_list[i]);
             compat->dxbc_blob_hashes[output_index] = hash_fnv1_iterate_u8(compat->dxbc_blob_hashes[output_index], i);
             output_index++;
         }
@@ -2708,6 +3694,7 @@ static HRESULT vkd3d_pipeline_library_disk_cache_save_pipeline_state(struct vkd3
         const struct vkd3d_pipeline_library_disk_cache_item *item)
 {
     struct d3d12_pipeline_library *library = cache->library;
+    struct d3d12_pipeline_library_shard *shard;
     struct vkd3d_cached_pipeline_entry entry;
     void *new_blob;
     VkResult vr;
@@ -2720,65 +3707,68 @@ static HRESULT vkd3d_pipeline_library_disk_cache_save_pipeline_state(struct vkd3
     entry.key.name_length = 0;
     entry.key.name = NULL;
     entry.key.internal_key_hash = vkd3d_pipeline_cache_compatibility_condense(&item->state->pipeline_cache_compat);
+    shard = d3d12_pipeline_library_get_shard(library, &entry.key);
 
-    if ((rc = rwlock_lock_read(&library->mutex)))
+    if ((rc = rwlock_lock_read(&shard->lock)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         return hresult_from_errno(rc);
     }
 
-    if (hash_map_find(&library->pso_map, &entry.key))
+    if (hash_map_find(&shard->map, &entry.key))
     {
         /* This could happen if a parallel thread tried to create the same PSO.
          * In a single threaded scenario we would find the PSO when creating the PSO,
          * and we would never try to enter this path. */
-        rwlock_unlock_read(&library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_INVALIDARG;
     }
 
     if (FAILED(vr = vkd3d_serialize_pipeline_state(library, item->state, &entry.data.blob_length, NULL)))
     {
-        rwlock_unlock_read(&library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return hresult_from_vk_result(vr);
     }
 
     if (!(new_blob = vkd3d_malloc(entry.data.blob_length)))
     {
-        rwlock_unlock_read(&library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_OUTOFMEMORY;
     }
 
     if (FAILED(vr = vkd3d_serialize_pipeline_state(library, item->state, &entry.data.blob_length, new_blob)))
     {
         vkd3d_free(new_blob);
-        rwlock_unlock_read(&library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return hresult_from_vk_result(vr);
     }
 
     entry.data.blob = new_blob;
     entry.data.is_new = 1;
+    entry.data.stream_validation = VKD3D_CACHED_PIPELINE_STREAM_VALIDATED;
+    entry.data.stream_type = 0;
     /* We cannot hand the same object out again, since this is not part of the ID3D12PipelineLibrary interface. */
     entry.data.state = NULL;
 
     /* Now is the time to promote to a writer lock. */
-    rwlock_unlock_read(&library->mutex);
+    rwlock_unlock_read(&shard->lock);
 
-    if ((rc = rwlock_lock_write(&library->mutex)))
+    if ((rc = rwlock_lock_write(&shard->lock)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         vkd3d_free(new_blob);
         return hresult_from_errno(rc);
     }
 
-    if (!d3d12_pipeline_library_insert_hash_map_blob_locked(library, &library->pso_map, &entry))
+    if (!d3d12_pipeline_library_shard_insert_locked(library, shard, &entry))
     {
         /* Found duplicate. */
         vkd3d_free(new_blob);
-        rwlock_unlock_write(&library->mutex);
+        rwlock_unlock_write(&shard->lock);
         return E_OUTOFMEMORY;
     }
 
-    rwlock_unlock_write(&library->mutex);
+    rwlock_unlock_write(&shard->lock);
 
     if (library->disk_cache_listener)
     {
@@ -2813,30 +3803,33 @@ HRESULT vkd3d_pipeline_library_find_cached_blob_from_disk_cache(struct vkd3d_pip
         struct d3d12_cached_pipeline_state *cached_state)
 {
     struct d3d12_pipeline_library *library = cache->library;
+    struct d3d12_pipeline_library_shard *shard;
     const struct vkd3d_cached_pipeline_entry *e;
     struct vkd3d_cached_pipeline_key key;
     int rc;
 
-    if ((rc = rwlock_lock_read(&library->mutex)))
+    key.name_length = 0;
+    key.name = NULL;
+    key.internal_key_hash = vkd3d_pipeline_cache_compatibility_condense(compat);
+    shard = d3d12_pipeline_library_get_shard(library, &key);
+
+    if ((rc = rwlock_lock_read(&shard->lock)))
     {
         ERR("Failed to lock mutex, rc %d.\n", rc);
         return hresult_from_errno(rc);
     }
 
-    key.name_length = 0;
-    key.name = NULL;
-    key.internal_key_hash = vkd3d_pipeline_cache_compatibility_condense(compat);
-
-    if (!(e = (const struct vkd3d_cached_pipeline_entry*)hash_map_find(&library->pso_map, &key)))
+    if (!(e = (const struct vkd3d_cached_pipeline_entry*)hash_map_find(&shard->map, &key)) ||
+            !d3d12_pipeline_library_validate_cached_entry(e))
     {
-        rwlock_unlock_read(&library->mutex);
+        rwlock_unlock_read(&shard->lock);
         return E_INVALIDARG;
     }
 
     cached_state->blob.CachedBlobSizeInBytes = e->data.blob_length;
     cached_state->blob.pCachedBlob = e->data.blob;
     cached_state->library = library;
-    rwlock_unlock_read(&library->mutex);
+    rwlock_unlock_read(&shard->lock);
     return S_OK;
 }
 
@@ -3090,12 +4083,96 @@ out_cancellation:
     vkd3d_free(tmp_buffer);
 }
 
+static uint64_t vkd3d_serialized_pipeline_stream_index_compute_checksum(
+        const struct vkd3d_serialized_pipeline_stream_index_entry *entries, uint32_t entry_count)
+{
+    return hash_xxh64(entries, entry_count * sizeof(*entries), 0);
+}
+
+static bool vkd3d_pipeline_library_disk_cache_map_index(struct vkd3d_pipeline_library_disk_cache *cache,
+        struct vkd3d_memory_mapped_file *mapped_index)
+{
+    const struct vkd3d_serialized_pipeline_stream_index *index;
+
+    if (cache->mapped_file.mapped_size < sizeof(index->archive_header))
+        return false;
+
+    if (!vkd3d_file_map_read_only(cache->index_path, mapped_index))
+        return false;
+
+    index = mapped_index->mapped;
+
+    /* The index must describe exactly the archive we just mapped. If the archive was merged or replaced
+     * in the meantime, the size or header will not match and we fall back to a full parse.
+     * Payload checksums are still verified on first use, so a stale but plausible index cannot feed us garbage. */
+    if (mapped_index->mapped_size < sizeof(*index) ||
+            index->version != VKD3D_PIPELINE_STREAM_INDEX_VERSION ||
+            (mapped_index->mapped_size - sizeof(*index)) / sizeof(*index->entries) != index->entry_count ||
+            index->archive_size != cache->mapped_file.mapped_size ||
+            memcmp(&index->archive_header, cache->mapped_file.mapped, sizeof(index->archive_header)) != 0 ||
+            index->checksum != vkd3d_serialized_pipeline_stream_index_compute_checksum(
+                    index->entries, index->entry_count))
+    {
+        INFO("Stream archive index is stale, ignoring it.\n");
+        vkd3d_file_unmap(mapped_index);
+        return false;
+    }
+
+    return true;
+}
+
+static void vkd3d_pipeline_library_disk_cache_write_index(struct vkd3d_pipeline_library_disk_cache *cache,
+        const struct vkd3d_pipeline_library_stream_index_builder *builder)
+{
+    struct vkd3d_serialized_pipeline_stream_index index;
+    char tmp_path[VKD3D_PATH_MAX];
+    bool success;
+    FILE *file;
+
+    memset(&index, 0, sizeof(index));
+    index.version = VKD3D_PIPELINE_STREAM_INDEX_VERSION;
+    index.entry_count = builder->entries_count;
+    index.archive_size = cache->mapped_file.mapped_size;
+    index.checksum = vkd3d_serialized_pipeline_stream_index_compute_checksum(builder->entries, index.entry_count);
+    memcpy(&index.archive_header, cache->mapped_file.mapped, sizeof(index.archive_header));
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", cache->index_path);
+
+    /* Similar to merging, we might race with another process here, or a previous process was killed
+     * while writing the index. Either way, don't bother, clean up and try again next time. */
+    if (!(file = vkd3d_file_open_exclusive_write(tmp_path)))
+    {
+        INFO("Cannot write stream archive index, removing stale temporary file.\n");
+        vkd3d_file_delete(tmp_path);
+        return;
+    }
+
+    success = fwrite(&index, sizeof(index), 1, file) == 1;
+    if (success && index.entry_count)
+        success = fwrite(builder->entries, sizeof(*builder->entries), index.entry_count, file) == index.entry_count;
+    if (fclose(file) != 0)
+        success = false;
+
+    if (success && vkd3d_file_rename_overwrite(tmp_path, cache->index_path))
+        INFO("Wrote stream archive index with %u entries.\n", index.entry_count);
+    else
+    {
+        INFO("Failed to write stream archive index.\n");
+        vkd3d_file_delete(tmp_path);
+    }
+}
+
 static void vkd3d_pipeline_library_disk_cache_initial_setup(struct vkd3d_pipeline_library_disk_cache *cache)
 {
+    struct vkd3d_pipeline_library_stream_index_builder index_builder;
+    struct vkd3d_memory_mapped_file mapped_index;
     uint64_t begin_ts;
     uint64_t end_ts;
     HRESULT hr;
 
+    memset(&index_builder, 0, sizeof(index_builder));
+    memset(&mapped_index, 0, sizeof(mapped_index));
+
     begin_ts = vkd3d_get_current_time_ns();
 
     /* Fairly complex operation. Ideally, Steam handles this.
@@ -3118,10 +4195,25 @@ static void vkd3d_pipeline_library_disk_cache_initial_setup(struct vkd3d_pipelin
         INFO("Mapping read-only cache took %.3f ms.\n", 1e-6 * (double)(end_ts - begin_ts));
 
         begin_ts = vkd3d_get_current_time_ns();
-        hr = d3d12_pipeline_library_read_blob_stream_format(cache->library, cache->library->device,
-                cache->mapped_file.mapped, cache->mapped_file.mapped_size);
-        end_ts = vkd3d_get_current_time_ns();
-        INFO("Parsing stream archive took %.3f ms.\n", 1e-6 * (double)(end_ts - begin_ts));
+        if (vkd3d_pipeline_library_disk_cache_map_index(cache, &mapped_index))
+        {
+            hr = d3d12_pipeline_library_read_blob_stream_index(cache->library, cache->library->device,
+                    cache->mapped_file.mapped, cache->mapped_file.mapped_size, mapped_index.mapped);
+            vkd3d_file_unmap(&mapped_index);
+            end_ts = vkd3d_get_current_time_ns();
+            INFO("Parsing stream archive through index took %.3f ms.\n", 1e-6 * (double)(end_ts - begin_ts));
+        }
+        else
+        {
+            hr = d3d12_pipeline_library_read_blob_stream_format(cache->library, cache->library->device,
+                    cache->mapped_file.mapped, cache->mapped_file.mapped_size, &index_builder);
+            end_ts = vkd3d_get_current_time_ns();
+            INFO("Parsing stream archive took %.3f ms.\n", 1e-6 * (double)(end_ts - begin_ts));
+
+            /* Next time around we can skip validating the full archive. */
+            if (SUCCEEDED(hr) && index_builder.complete)
+                vkd3d_pipeline_library_disk_cache_write_index(cache, &index_builder);
+        }
 
         if (hr == D3D12_ERROR_DRIVER_VERSION_MISMATCH)
             INFO("Cannot load existing on-disk cache due to driver version mismatch.\n");
@@ -3131,6 +4223,8 @@ static void vkd3d_pipeline_library_disk_cache_initial_setup(struct vkd3d_pipelin
             INFO("Failed to load driver cache with hr #%x, falling back to empty cache.\n", hr);
     }
 
+    vkd3d_free(index_builder.entries);
+
     /* When we add new internal blobs from this point,
      * we'll be notified where we can write out a stream blob to disk.
      * This all happens within the disk$ thread. */
@@ -3195,6 +4289,7 @@ HRESULT vkd3d_pipeline_library_init_disk_cache(struct vkd3d_pipeline_library_dis
 
     /* Split the reader and writer. */
     snprintf(cache->write_path, sizeof(cache->write_path), "%s.write", cache->read_path);
+    snprintf(cache->index_path, sizeof(cache->index_path), "%s.index", cache->read_path);
 
     flags = VKD3D_PIPELINE_LIBRARY_FLAG_INTERNAL_KEYS | VKD3D_PIPELINE_LIBRARY_FLAG_STREAM_ARCHIVE;
 
@@ -3338,6 +4433,72 @@ void vkd3d_pipeline_library_disk_cache_notify_blob_insert(struct vkd3d_pipeline_
     }
 }
 
+static unsigned int d3d12_pipeline_library_warm_up_map(struct d3d12_pipeline_library *pipeline_library,
+        const struct hash_map *map, unsigned int *corrupt_count)
+{
+    const struct vkd3d_cached_pipeline_entry *entry;
+    unsigned int count = 0;
+    uint32_t *validation;
+    uint32_t i;
+
+    for (i = 0; i < map->entry_count; i++)
+    {
+        entry = (const struct vkd3d_cached_pipeline_entry *)hash_map_get_entry(map, i);
+        if (!(entry->entry.flags & HASH_MAP_ENTRY_OCCUPIED))
+            continue;
+
+        validation = (uint32_t *)&entry->data.stream_validation;
+        if (vkd3d_atomic_uint32_load_explicit(validation, vkd3d_memory_order_acquire) !=
+                VKD3D_CACHED_PIPELINE_STREAM_PENDING)
+            continue;
+
+        if (vkd3d_atomic_uint32_load_explicit(&pipeline_library->stream_archive_cancellation_point,
+                vkd3d_memory_order_relaxed))
+            break;
+
+        /* Validating reads the entire payload, so it is paged in as a side effect. */
+        if (!d3d12_pipeline_library_validate_cached_entry(entry))
+            (*corrupt_count)++;
+        count++;
+    }
+
+    return count;
+}
+
+static void vkd3d_pipeline_library_disk_cache_warm_up(struct vkd3d_pipeline_library_disk_cache *cache)
+{
+    struct d3d12_pipeline_library *library = cache->library;
+    unsigned int corrupt_count = 0;
+    unsigned int count = 0;
+    uint64_t begin_ts;
+    uint64_t end_ts;
+    unsigned int i;
+
+    begin_ts = vkd3d_get_current_time_ns();
+
+    /* New entries are only inserted by the disk thread, and lookups only need the read lock,
+     * so holding it for the whole pass does not block pipeline creation. */
+    for (i = 0; i < VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT; i++)
+    {
+        if (rwlock_lock_read(&library->pso_shards[i].lock))
+            return;
+        count += d3d12_pipeline_library_warm_up_map(library, &library->pso_shards[i].map, &corrupt_count);
+        rwlock_unlock_read(&library->pso_shards[i].lock);
+    }
+
+    if (rwlock_lock_read(&library->internal_hashmap_mutex))
+        return;
+
+    count += d3d12_pipeline_library_warm_up_map(library, &library->spirv_cache_map, &corrupt_count);
+    count += d3d12_pipeline_library_warm_up_map(library, &library->driver_cache_map, &corrupt_count);
+
+    rwlock_unlock_read(&library->internal_hashmap_mutex);
+
+    end_ts = vkd3d_get_current_time_ns();
+    INFO("Warming up %u stream archive entries (%u corrupt) took %.3f ms.\n",
+            count, corrupt_count, 1e-6 * (double)(end_ts - begin_ts));
+}
+
 static void *vkd3d_pipeline_library_disk_thread_main(void *userarg)
 {
     struct vkd3d_pipeline_library_disk_cache_item *tmp_items = NULL;
@@ -3361,6 +4522,9 @@ static void *vkd3d_pipeline_library_disk_thread_main(void *userarg)
         INFO("Done performing async setup of stream archive.\n");
     }
 
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_WARM_UP)
+        vkd3d_pipeline_library_disk_cache_warm_up(cache);
+
     while (active)
     {
         pthread_mutex_lock(&cache->lock);
@@ -3466,3 +4630,126 @@ static void *vkd3d_pipeline_library_disk_thread_main(void *userarg)
     vkd3d_free(tmp_items);
     return NULL;
 }
+
+struct vkd3d_shader_spirv_cache_entry
+{
+    struct hash_map_entry entry;
+    struct vkd3d_shader_spirv_cache_key key;
+    struct vkd3d_shader_code spirv;
+};
+
+static uint32_t vkd3d_shader_spirv_cache_hash_key(const void *key)
+{
+    const struct vkd3d_shader_spirv_cache_key *k = key;
+    uint32_t hash;
+
+    hash = hash_uint64(k->dxbc_hash);
+    hash = hash_combine(hash, hash_uint64(k->root_signature_compat_hash));
+    hash = hash_combine(hash, hash_uint64(k->compile_args_hash));
+    return hash;
+}
+
+static bool vkd3d_shader_spirv_cache_compare_key(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_shader_spirv_cache_entry *e = (const struct vkd3d_shader_spirv_cache_entry *)entry;
+    const struct vkd3d_shader_spirv_cache_key *k = key;
+
+    return e->key.dxbc_hash == k->dxbc_hash &&
+            e->key.root_signature_compat_hash == k->root_signature_compat_hash &&
+            e->key.compile_args_hash == k->compile_args_hash;
+}
+
+HRESULT vkd3d_shader_spirv_cache_init(struct vkd3d_shader_spirv_cache *cache)
+{
+    int rc;
+
+    memset(cache, 0, sizeof(*cache));
+
+    if ((rc = rwlock_init(&cache->lock)))
+        return hresult_from_errno(rc);
+
+    hash_map_init(&cache->map, vkd3d_shader_spirv_cache_hash_key,
+            vkd3d_shader_spirv_cache_compare_key, sizeof(struct vkd3d_shader_spirv_cache_entry));
+    return S_OK;
+}
+
+static void vkd3d_shader_spirv_cache_free_entry(struct hash_map_entry *entry, void *userdata)
+{
+    struct vkd3d_shader_spirv_cache_entry *e = (struct vkd3d_shader_spirv_cache_entry *)entry;
+    vkd3d_shader_free_shader_code(&e->spirv);
+}
+
+void vkd3d_shader_spirv_cache_cleanup(struct vkd3d_shader_spirv_cache *cache)
+{
+    if (cache->hit_count || cache->miss_count)
+    {
+        INFO("SPIR-V cache: %"PRIu64" hits, %"PRIu64" misses, %u entries, %zu bytes.\n",
+                cache->hit_count, cache->miss_count, cache->map.used_count, cache->total_size);
+    }
+
+    hash_map_iter(&cache->map, vkd3d_shader_spirv_cache_free_entry, NULL);
+    hash_map_free(&cache->map);
+    rwlock_destroy(&cache->lock);
+}
+
+bool vkd3d_shader_spirv_cache_lookup(struct vkd3d_shader_spirv_cache *cache,
+        const struct vkd3d_shader_spirv_cache_key *key, struct vkd3d_shader_code *spirv)
+{
+    const struct vkd3d_shader_spirv_cache_entry *e;
+    void *code = NULL;
+    bool found;
+
+    rwlock_lock_read(&cache->lock);
+    if ((e = (const struct vkd3d_shader_spirv_cache_entry *)hash_map_find(&cache->map, key)) &&
+            (code = vkd3d_malloc(e->spirv.size)))
+    {
+        /* Every PSO owns its SPIR-V, so hand out a copy. */
+        memcpy(code, e->spirv.code, e->spirv.size);
+        spirv->code = code;
+        spirv->size = e->spirv.size;
+        spirv->meta = e->spirv.meta;
+    }
+    rwlock_unlock_read(&cache->lock);
+
+    found = !!code;
+
+    if (found)
+        vkd3d_atomic_uint64_increment(&cache->hit_count, vkd3d_memory_order_relaxed);
+    else
+        vkd3d_atomic_uint64_increment(&cache->miss_count, vkd3d_memory_order_relaxed);
+
+    return found;
+}
+
+void vkd3d_shader_spirv_cache_insert(struct vkd3d_shader_spirv_cache *cache,
+        const struct vkd3d_shader_spirv_cache_key *key, const struct vkd3d_shader_code *spirv)
+{
+    struct vkd3d_shader_spirv_cache_entry entry, *e;
+    void *code;
+
+    if (!(code = vkd3d_malloc(spirv->size)))
+        return;
+
+    memcpy(code, spirv->code, spirv->size);
+    memset(&entry, 0, sizeof(entry));
+    entry.key = *key;
+    entry.spirv.code = code;
+    entry.spirv.size = spirv->size;
+    entry.spirv.meta = spirv->meta;
+
+    rwlock_lock_write(&cache->lock);
+
+    if (cache->total_size + spirv->size > VKD3D_SHADER_SPIRV_CACHE_MAX_SIZE)
+        e = NULL;
+    else if ((e = (struct vkd3d_shader_spirv_cache_entry *)hash_map_insert(&cache->map, key, &entry.entry)) &&
+            e->spirv.code == code)
+        cache->total_size += spirv->size;
+    else
+        e = NULL;
+
+    rwlock_unlock_write(&cache->lock);
+
+    /* Out of budget, or another thread inserted the same shader first. */
+    if (!e)
+        vkd3d_free(code);
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#include "vkd3d_private.h"
+#include "vkd3d_capture.h"
+#include <stdio.h>
+
+static pthread_once_t capture_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t capture_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *capture_file;
+static uint32_t capture_root_signature_id;
+
+struct vkd3d_capture_stream
+{
+    uint32_t *words;
+    size_t words_size;
+    size_t words_count;
+    bool failed;
+};
+
+static void vkd3d_init_capture_once(void)
+{
+    struct vkd3d_capture_header header;
+    char path[VKD3D_PATH_MAX];
+
+    vkd3d_get_env_var("VKD3D_CAPTURE_PATH", path, sizeof(path));
+    if (!strlen(path))
+        return;
+
+    if (!(capture_file = fopen(path, "wb")))
+    {
+        ERR("Failed to open capture file \"%s\".\n", path);
+        return;
+    }
+
+    header.magic = VKD3D_CAPTURE_MAGIC;
+    header.version = VKD3D_CAPTURE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, capture_file) != 1)
+    {
+        ERR("Failed to write capture header.\n");
+        fclose(capture_file);
+        capture_file = NULL;
+        return;
+    }
+
+    INFO("Capturing API stream to \"%s\".\n", path);
+}
+
+void vkd3d_init_capture(void)
+{
+    pthread_once(&capture_once, vkd3d_init_capture_once);
+}
+
+bool vkd3d_uses_capture(void)
+{
+    return capture_file != NULL;
+}
+
+static void vkd3d_capture_stream_push_words(struct vkd3d_capture_stream *stream,
+        const void *data, size_t size)
+{
+    size_t word_count = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    if (stream->failed)
+        return;
+
+    if (!vkd3d_array_reserve((void **)&stream->words, &stream->words_size,
+            stream->words_count + word_count, sizeof(*stream->words)))
+    {
+        stream->failed = true;
+        return;
+    }
+
+    /* Zero the tail so that padding is deterministic. */
+    if (word_count)
+    {
+        stream->words[stream->words_count + word_count - 1] = 0;
+        memcpy(stream->words + stream->words_count, data, size);
+    }
+    stream->words_count += word_count;
+}
+
+static void vkd3d_capture_stream_push_u32(struct vkd3d_capture_stream *stream, uint32_t value)
+{
+    vkd3d_capture_stream_push_words(stream, &value, sizeof(value));
+}
+
+static void vkd3d_capture_stream_push_blob(struct vkd3d_capture_stream *stream, const void *data, size_t size)
+{
+    vkd3d_capture_stream_push_u32(stream, size);
+    vkd3d_capture_stream_push_words(stream, data, size);
+}
+
+static void vkd3d_capture_stream_push_string(struct vkd3d_capture_stream *stream, const char *str)
+{
+    /* Include the terminator so that replay can point straight into the trace. */
+    vkd3d_capture_stream_push_blob(stream, str ? str : "", str ? strlen(str) + 1 : 1);
+}
+
+static void vkd3d_capture_stream_push_shader(struct vkd3d_capture_stream *stream, const D3D12_SHADER_BYTECODE *code)
+{
+    vkd3d_capture_stream_push_blob(stream, code->pShaderBytecode, code->BytecodeLength);
+}
+
+static void vkd3d_capture_stream_push_root_signature(struct vkd3d_capture_stream *stream,
+        ID3D12RootSignature *iface)
+{
+    /* 0 means no root signature, e.g. when it is embedded in the shader code. */
+    vkd3d_capture_stream_push_u32(stream, iface ? impl_from_ID3D12RootSignature(iface)->capture_id : 0);
+}
+
+static void vkd3d_capture_stream_submit(struct vkd3d_capture_stream *stream, enum vkd3d_capture_record_type type)
+{
+    struct vkd3d_capture_record_header header;
+    bool failed;
+
+    if (stream->failed)
+    {
+        ERR("Failed to allocate capture record of type %u.\n", type);
+        vkd3d_free(stream->words);
+        return;
+    }
+
+    header.type = type;
+    header.size = stream->words_count * sizeof(uint32_t);
+
+    pthread_mutex_lock(&capture_lock);
+    failed = fwrite(&header, sizeof(header), 1, capture_file) != 1 ||
+            fwrite(stream->words, sizeof(uint32_t), stream->words_count, capture_file) != stream->words_count;
+    pthread_mutex_unlock(&capture_lock);
+
+    if (failed)
+        ERR("Failed to write capture record of type %u.\n", type);
+
+    vkd3d_free(stream->words);
+}
+
+void vkd3d_capture_root_signature(struct d3d12_root_signature *root_signature,
+        UINT node_mask, const void *blob, size_t size)
+{
+    struct vkd3d_capture_stream stream;
+
+    /* Identical blobs share one object, keep the ID of the first creation so that
+     * pipelines which were recorded against it still resolve on replay. */
+    if (!root_signature->capture_id)
+        root_signature->capture_id = vkd3d_atomic_uint32_increment(&capture_root_signature_id, vkd3d_memory_order_relaxed);
+
+    memset(&stream, 0, sizeof(stream));
+    vkd3d_capture_stream_push_u32(&stream, root_signature->capture_id);
+    vkd3d_capture_stream_push_u32(&stream, node_mask);
+    vkd3d_capture_stream_push_blob(&stream, blob, size);
+    vkd3d_capture_stream_submit(&stream, VKD3D_CAPTURE_RECORD_ROOT_SIGNATURE);
+}
+
+void vkd3d_capture_compute_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc)
+{
+    struct vkd3d_capture_stream stream;
+
+    if (desc->CachedPSO.CachedBlobSizeInBytes)
+        FIXME_ONCE("Not capturing cached PSO blob.\n");
+
+    memset(&stream, 0, sizeof(stream));
+    vkd3d_capture_stream_push_root_signature(&stream, desc->pRootSignature);
+    vkd3d_capture_stream_push_u32(&stream, desc->NodeMask);
+    vkd3d_capture_stream_push_u32(&stream, desc->Flags);
+    vkd3d_capture_stream_push_shader(&stream, &desc->CS);
+    vkd3d_capture_stream_submit(&stream, VKD3D_CAPTURE_RECORD_COMPUTE_PIPELINE);
+}
+
+void vkd3d_capture_graphics_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc)
+{
+    const D3D12_STREAM_OUTPUT_DESC *so_desc = &desc->StreamOutput;
+    const D3D12_INPUT_LAYOUT_DESC *il_desc = &desc->InputLayout;
+    struct vkd3d_capture_stream stream;
+    unsigned int i;
+
+    if (desc->CachedPSO.CachedBlobSizeInBytes)
+        FIXME_ONCE("Not capturing cached PSO blob.\n");
+
+    memset(&stream, 0, sizeof(stream));
+    vkd3d_capture_stream_push_root_signature(&stream, desc->pRootSignature);
+    vkd3d_capture_stream_push_shader(&stream, &desc->VS);
+    vkd3d_capture_stream_push_shader(&stream, &desc->PS);
+    vkd3d_capture_stream_push_shader(&stream, &desc->DS);
+    vkd3d_capture_stream_push_shader(&stream, &desc->HS);
+    vkd3d_capture_stream_push_shader(&stream, &desc->GS);
+
+    vkd3d_capture_stream_push_u32(&stream, so_desc->NumEntries);
+    for (i = 0; i < so_desc->NumEntries; i++)
+    {
+        const D3D12_SO_DECLARATION_ENTRY *e = &so_desc->pSODeclaration[i];
+        vkd3d_capture_stream_push_u32(&stream, e->Stream);
+        vkd3d_capture_stream_push_string(&stream, e->SemanticName);
+        vkd3d_capture_stream_push_u32(&stream, e->SemanticIndex);
+        vkd3d_capture_stream_push_u32(&stream, e->StartComponent);
+        vkd3d_capture_stream_push_u32(&stream, e->ComponentCount);
+        vkd3d_capture_stream_push_u32(&stream, e->OutputSlot);
+    }
+    vkd3d_capture_stream_push_blob(&stream, so_desc->pBufferStrides, so_desc->NumStrides * sizeof(UINT));
+    vkd3d_capture_stream_push_u32(&stream, so_desc->RasterizedStream);
+
+    vkd3d_capture_stream_push_words(&stream, &desc->BlendState, sizeof(desc->BlendState));
+    vkd3d_capture_stream_push_u32(&stream, desc->SampleMask);
+    vkd3d_capture_stream_push_words(&stream, &desc->RasterizerState, sizeof(desc->RasterizerState));
+    vkd3d_capture_stream_push_words(&stream, &desc->DepthStencilState, sizeof(desc->DepthStencilState));
+
+    vkd3d_capture_stream_push_u32(&stream, il_desc->NumElements);
+    for (i = 0; i < il_desc->NumElements; i++)
+    {
+        const D3D12_INPUT_ELEMENT_DESC *e = &il_desc->pInputElementDescs[i];
+        vkd3d_capture_stream_push_string(&stream, e->SemanticName);
+        vkd3d_capture_stream_push_u32(&stream, e->SemanticIndex);
+        vkd3d_capture_stream_push_u32(&stream, e->Format);
+        vkd3d_capture_stream_push_u32(&stream, e->InputSlot);
+        vkd3d_capture_stream_push_u32(&stream, e->AlignedByteOffset);
+        vkd3d_capture_stream_push_u32(&stream, e->InputSlotClass);
+        vkd3d_capture_stream_push_u32(&stream, e->InstanceDataStepRate);
+    }
+
+    vkd3d_capture_stream_push_u32(&stream, desc->IBStripCutValue);
+    vkd3d_capture_stream_push_u32(&stream, desc->PrimitiveTopologyType);
+    vkd3d_capture_stream_push_u32(&stream, desc->NumRenderTargets);
+    for (i = 0; i < ARRAY_SIZE(desc->RTVFormats); i++)
+        vkd3d_capture_stream_push_u32(&stream, desc->RTVFormats[i]);
+    vkd3d_capture_stream_push_u32(&stream, desc->DSVFormat);
+    vkd3d_capture_stream_push_words(&stream, &desc->SampleDesc, sizeof(desc->SampleDesc));
+    vkd3d_capture_stream_push_u32(&stream, desc->NodeMask);
+    vkd3d_capture_stream_push_u32(&stream, desc->Flags);
+    vkd3d_capture_stream_submit(&stream, VKD3D_CAPTURE_RECORD_GRAPHICS_PIPELINE);
+}
+
+void vkd3d_capture_flush(void)
+{
+    if (!capture_file)
+        return;
+
+    pthread_mutex_lock(&capture_lock);
+    fflush(capture_file);
+    pthread_mutex_unlock(&capture_lock);
+}
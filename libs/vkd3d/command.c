@@ -33,20 +33,15 @@ static void d3d12_fence_inc_ref(struct d3d12_fence *fence);
 static void d3d12_fence_dec_ref(struct d3d12_fence *fence);
 static void d3d12_shared_fence_inc_ref(struct d3d12_shared_fence *fence);
 static void d3d12_shared_fence_dec_ref(struct d3d12_shared_fence *fence);
+static void vkd3d_shared_fence_worker_remove(struct vkd3d_shared_fence_worker *worker,
+        struct d3d12_shared_fence *fence);
 static void d3d12_fence_iface_inc_ref(d3d12_fence_iface *iface);
 static void d3d12_fence_iface_dec_ref(d3d12_fence_iface *iface);
 
-#define MAX_BATCHED_IMAGE_BARRIERS 16
-struct d3d12_command_list_barrier_batch
-{
-    VkImageMemoryBarrier2 vk_image_barriers[MAX_BATCHED_IMAGE_BARRIERS];
-    VkMemoryBarrier2 vk_memory_barrier;
-    uint32_t image_barrier_count;
-};
-
 static void d3d12_command_list_barrier_batch_init(struct d3d12_command_list_barrier_batch *batch);
 static void d3d12_command_list_barrier_batch_end(struct d3d12_command_list *list,
         struct d3d12_command_list_barrier_batch *batch);
+static void d3d12_command_list_flush_deferred_barriers(struct d3d12_command_list *list);
 static void d3d12_command_list_barrier_batch_add_layout_transition(
         struct d3d12_command_list *list,
         struct d3d12_command_list_barrier_batch *batch,
@@ -74,8 +69,10 @@ static void d3d12_command_list_decay_optimal_dsv_resource(struct d3d12_command_l
         const struct d3d12_resource *resource, uint32_t plane_optimal_mask,
         struct d3d12_command_list_barrier_batch *batch);
 static void d3d12_command_list_end_transfer_batch(struct d3d12_command_list *list);
+static void d3d12_command_list_flush_rtas_batch(struct d3d12_command_list *list);
+static void d3d12_command_list_discard_rtas_batch(struct d3d12_command_list *list);
 static void d3d12_command_list_end_wbi_batch(struct d3d12_command_list *list);
-static inline void d3d12_command_list_ensure_transfer_batch(struct d3d12_command_list *list, enum vkd3d_batch_type type);
+static bool d3d12_command_list_ensure_transfer_batch(struct d3d12_command_list *list, enum vkd3d_batch_type type);
 
 static void d3d12_command_list_flush_query_resolves(struct d3d12_command_list *list);
 
@@ -506,14 +503,48 @@ static void vkd3d_waiting_fence_release_submissions(const struct vkd3d_waiting_f
     vkd3d_free(fence->submission_counters);
 }
 
+static void vkd3d_waiting_fence_retire(struct vkd3d_fence_worker *worker, const struct vkd3d_waiting_fence *fence)
+{
+    struct d3d12_fence *local_fence;
+    HRESULT hr;
+
+    if (fence->fence && !is_shared_ID3D12Fence1(fence->fence) && fence->signal)
+    {
+        local_fence = impl_from_ID3D12Fence1(fence->fence);
+        TRACE("Signaling fence %p value %#"PRIx64".\n", local_fence, fence->value);
+        if (FAILED(hr = d3d12_fence_signal(local_fence, fence->value)))
+            ERR("Failed to signal D3D12 fence, hr %#x.\n", hr);
+    }
+
+    if (fence->fence)
+        d3d12_fence_iface_dec_ref(fence->fence);
+
+    /* Submission release should only be paired with an execute command.
+     * Such execute commands can be paired with a d3d12_fence_dec_ref(),
+     * but no signalling operation. */
+    assert(!fence->num_submission_counts || !fence->signal);
+    vkd3d_waiting_fence_release_submissions(fence);
+}
+
+static uint64_t vkd3d_fence_worker_get_wait_timeout(void)
+{
+    /* Some drivers hang indefinitely in face of device lost.
+     * If a wait here takes more than 5 seconds, this is pretty much
+     * a guaranteed timeout (TDR) scenario.
+     * Usually, we'd observe DEVICE_LOST in subsequent submissions,
+     * but if application submits something and expects to wait on that submission
+     * immediately, this can happen. */
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_BREADCRUMBS)
+        return 5000000000ull;
+    else
+        return UINT64_MAX;
+}
+
 static void vkd3d_wait_for_gpu_timeline_semaphore(struct vkd3d_fence_worker *worker, const struct vkd3d_waiting_fence *fence)
 {
     struct d3d12_device *device = worker->device;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
-    struct d3d12_fence *local_fence;
     VkSemaphoreWaitInfo wait_info;
-    uint64_t timeout = UINT64_MAX;
-    HRESULT hr;
     int vr;
 
     wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
@@ -523,16 +554,7 @@ static void vkd3d_wait_for_gpu_timeline_semaphore(struct vkd3d_fence_worker *wor
     wait_info.pSemaphores = &fence->submission_timeline;
     wait_info.pValues = &fence->value;
 
-    /* Some drivers hang indefinitely in face of device lost.
-     * If a wait here takes more than 5 seconds, this is pretty much
-     * a guaranteed timeout (TDR) scenario.
-     * Usually, we'd observe DEVICE_LOST in subsequent submissions,
-     * but if application submits something and expects to wait on that submission
-     * immediately, this can happen. */
-    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_BREADCRUMBS)
-        timeout = 5000000000ull;
-
-    if ((vr = VK_CALL(vkWaitSemaphores(device->vk_device, &wait_info, timeout))))
+    if ((vr = VK_CALL(vkWaitSemaphores(device->vk_device, &wait_info, vkd3d_fence_worker_get_wait_timeout()))))
     {
         ERR("Failed to wait for Vulkan timeline semaphore, vr %d.\n", vr);
         VKD3D_DEVICE_REPORT_BREADCRUMB_IF(device, vr == VK_ERROR_DEVICE_LOST || vr == VK_TIMEOUT);
@@ -544,40 +566,138 @@ static void vkd3d_wait_for_gpu_timeline_semaphore(struct vkd3d_fence_worker *wor
     vkd3d_shader_debug_ring_kick(&device->debug_ring, device, false);
     vkd3d_descriptor_debug_kick_qa_check(device->descriptor_qa_global_info);
 
-    if (fence->fence && !is_shared_ID3D12Fence1(fence->fence) && fence->signal)
+    vkd3d_waiting_fence_retire(worker, fence);
+}
+
+static uint32_t vkd3d_fence_worker_find_wait_semaphore(struct vkd3d_fence_worker *worker,
+        uint32_t semaphore_count, VkSemaphore vk_semaphore)
+{
+    uint32_t i;
+
+    for (i = 0; i < semaphore_count; i++)
+        if (worker->wait_semaphores[i] == vk_semaphore)
+            return i;
+
+    return semaphore_count;
+}
+
+static size_t vkd3d_fence_worker_wait_any(struct vkd3d_fence_worker *worker,
+        struct vkd3d_waiting_fence *fences, size_t fence_count)
+{
+    struct d3d12_device *device = worker->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    uint32_t semaphore_count, semaphore_index;
+    size_t i, pending_count;
+    VkSemaphoreWaitInfo wait_info;
+    int vr;
+
+    VKD3D_REGION_DECL(fence_worker_retire);
+
+    if (!vkd3d_array_reserve((void **)&worker->wait_semaphores, &worker->wait_semaphores_size,
+            fence_count, sizeof(*worker->wait_semaphores)) ||
+            !vkd3d_array_reserve((void **)&worker->wait_values, &worker->wait_values_size,
+            fence_count, sizeof(*worker->wait_values)))
     {
-        local_fence = impl_from_ID3D12Fence1(fence->fence);
-        TRACE("Signaling fence %p value %#"PRIx64".\n", local_fence, fence->value);
-        if (FAILED(hr = d3d12_fence_signal(local_fence, fence->value)))
-            ERR("Failed to signal D3D12 fence, hr %#x.\n", hr);
+        /* Fall back to blocking on the oldest fence. */
+        ERR("Failed to allocate wait semaphore array.\n");
+        vkd3d_wait_for_gpu_timeline_semaphore(worker, &fences[0]);
+        memmove(fences, fences + 1, (fence_count - 1) * sizeof(*fences));
+        return fence_count - 1;
     }
 
-    if (fence->fence)
-        d3d12_fence_iface_dec_ref(fence->fence);
+    /* Fences are enqueued in submission order, so the first entry for any given
+     * timeline is also the one which will complete first on that timeline. */
+    semaphore_count = 0;
+    for (i = 0; i < fence_count; i++)
+    {
+        semaphore_index = vkd3d_fence_worker_find_wait_semaphore(worker,
+                semaphore_count, fences[i].submission_timeline);
 
-    /* Submission release should only be paired with an execute command.
-     * Such execute commands can be paired with a d3d12_fence_dec_ref(),
-     * but no signalling operation. */
-    assert(!fence->num_submission_counts || !fence->signal);
-    vkd3d_waiting_fence_release_submissions(fence);
+        if (semaphore_index == semaphore_count)
+        {
+            worker->wait_semaphores[semaphore_count] = fences[i].submission_timeline;
+            worker->wait_values[semaphore_count] = fences[i].value;
+            semaphore_count++;
+        }
+        else if (fences[i].value < worker->wait_values[semaphore_index])
+            worker->wait_values[semaphore_index] = fences[i].value;
+    }
+
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.pNext = NULL;
+    wait_info.flags = VK_SEMAPHORE_WAIT_ANY_BIT;
+    wait_info.semaphoreCount = semaphore_count;
+    wait_info.pSemaphores = worker->wait_semaphores;
+    wait_info.pValues = worker->wait_values;
+
+    if ((vr = VK_CALL(vkWaitSemaphores(device->vk_device, &wait_info, vkd3d_fence_worker_get_wait_timeout()))))
+    {
+        ERR("Failed to wait for Vulkan timeline semaphores, vr %d.\n", vr);
+        VKD3D_DEVICE_REPORT_BREADCRUMB_IF(device, vr == VK_ERROR_DEVICE_LOST || vr == VK_TIMEOUT);
+        for (i = 0; i < fence_count; i++)
+            vkd3d_waiting_fence_release_submissions(&fences[i]);
+        return 0;
+    }
+
+    /* Measures how long it takes from observing GPU completion until
+     * every completed fence has been signalled on the CPU timeline. */
+    VKD3D_REGION_BEGIN(fence_worker_retire);
+
+    vkd3d_shader_debug_ring_kick(&device->debug_ring, device, false);
+    vkd3d_descriptor_debug_kick_qa_check(device->descriptor_qa_global_info);
+
+    /* Sample every timeline exactly once so that fences sharing a timeline
+     * are retired in the order they were enqueued. */
+    for (i = 0; i < semaphore_count; i++)
+    {
+        if ((vr = VK_CALL(vkGetSemaphoreCounterValue(device->vk_device,
+                worker->wait_semaphores[i], &worker->wait_values[i]))))
+        {
+            ERR("Failed to query timeline semaphore value, vr %d.\n", vr);
+            worker->wait_values[i] = 0;
+        }
+    }
+
+    pending_count = 0;
+    for (i = 0; i < fence_count; i++)
+    {
+        semaphore_index = vkd3d_fence_worker_find_wait_semaphore(worker,
+                semaphore_count, fences[i].submission_timeline);
+
+        if (fences[i].value <= worker->wait_values[semaphore_index])
+            vkd3d_waiting_fence_retire(worker, &fences[i]);
+        else
+            fences[pending_count++] = fences[i];
+    }
+
+    VKD3D_REGION_END_ITERATIONS(fence_worker_retire, fence_count - pending_count);
+    return pending_count;
 }
 
 static void *vkd3d_fence_worker_main(void *arg)
 {
-    struct vkd3d_waiting_fence *cur_fences, *old_fences;
+    struct vkd3d_waiting_fence *cur_fences, *old_fences, *pending_fences;
+    size_t cur_fences_size, old_fences_size, pending_fences_size;
     struct vkd3d_fence_worker *worker = arg;
-    size_t cur_fences_size, old_fences_size;
+    size_t pending_fence_count;
     uint32_t cur_fence_count;
+    bool do_exit, wait_any;
     uint32_t i;
-    bool do_exit;
     int rc;
 
     vkd3d_set_thread_name("vkd3d_fence");
+    vkd3d_set_thread_role(VKD3D_THREAD_ROLE_FENCE);
 
     cur_fence_count = 0;
     cur_fences_size = 0;
     cur_fences = NULL;
 
+    pending_fence_count = 0;
+    pending_fences_size = 0;
+    pending_fences = NULL;
+
+    wait_any = !!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_FENCE_WORKER_WAIT_ANY);
+
     for (;;)
     {
         if ((rc = pthread_mutex_lock(&worker->mutex)))
@@ -586,7 +706,7 @@ static void *vkd3d_fence_worker_main(void *arg)
             break;
         }
 
-        if (!worker->enqueued_fence_count && !worker->should_exit)
+        if (!worker->enqueued_fence_count && !worker->should_exit && !pending_fence_count)
         {
             if ((rc = pthread_cond_wait(&worker->cond, &worker->mutex)))
             {
@@ -610,13 +730,37 @@ static void *vkd3d_fence_worker_main(void *arg)
 
         pthread_mutex_unlock(&worker->mutex);
 
+        if (wait_any)
+        {
+            /* Keep a rolling set of outstanding fences, so that a slow submission
+             * does not hold back signalling of unrelated timelines which complete earlier. */
+            if (cur_fence_count && vkd3d_array_reserve((void **)&pending_fences, &pending_fences_size,
+                    pending_fence_count + cur_fence_count, sizeof(*pending_fences)))
+            {
+                memcpy(pending_fences + pending_fence_count, cur_fences, cur_fence_count * sizeof(*cur_fences));
+                pending_fence_count += cur_fence_count;
+                cur_fence_count = 0;
+            }
+            else if (cur_fence_count)
+            {
+                ERR("Failed to allocate pending fence array.\n");
+                for (i = 0; i < pending_fence_count; i++)
+                    vkd3d_wait_for_gpu_timeline_semaphore(worker, &pending_fences[i]);
+                pending_fence_count = 0;
+            }
+
+            if (pending_fence_count)
+                pending_fence_count = vkd3d_fence_worker_wait_any(worker, pending_fences, pending_fence_count);
+        }
+
         for (i = 0; i < cur_fence_count; i++)
             vkd3d_wait_for_gpu_timeline_semaphore(worker, &cur_fences[i]);
 
-        if (do_exit)
+        if (do_exit && !pending_fence_count)
             break;
     }
 
+    vkd3d_free(pending_fences);
     vkd3d_free(cur_fences);
     return NULL;
 }
@@ -635,6 +779,11 @@ HRESULT vkd3d_fence_worker_start(struct vkd3d_fence_worker *worker,
     worker->enqueued_fences = NULL;
     worker->enqueued_fences_size = 0;
 
+    worker->wait_semaphores = NULL;
+    worker->wait_semaphores_size = 0;
+    worker->wait_values = NULL;
+    worker->wait_values_size = 0;
+
     if ((rc = pthread_mutex_init(&worker->mutex, NULL)))
     {
         ERR("Failed to initialize mutex, error %d.\n", rc);
@@ -680,6 +829,8 @@ HRESULT vkd3d_fence_worker_stop(struct vkd3d_fence_worker *worker,
     pthread_cond_destroy(&worker->cond);
 
     vkd3d_free(worker->enqueued_fences);
+    vkd3d_free(worker->wait_semaphores);
+    vkd3d_free(worker->wait_values);
     return S_OK;
 }
 
@@ -818,6 +969,16 @@ static HRESULT vkd3d_waiting_event_signal(const struct vkd3d_waiting_event *even
     return hr;
 }
 
+static void d3d12_fence_publish_virtual_value_locked(struct d3d12_fence *fence)
+{
+    vkd3d_atomic_uint64_store_explicit(&fence->completed_value, fence->virtual_value, vkd3d_memory_order_release);
+}
+
+static uint64_t d3d12_fence_get_completed_value(struct d3d12_fence *fence)
+{
+    return vkd3d_atomic_uint64_load_explicit(&fence->completed_value, vkd3d_memory_order_acquire);
+}
+
 static void d3d12_fence_signal_external_events_locked(struct d3d12_fence *fence)
 {
     bool signal_null_event_cond = false;
@@ -918,6 +1079,7 @@ static HRESULT d3d12_fence_signal_cpu_timeline_semaphore(struct d3d12_fence *fen
     }
 
     fence->virtual_value = value;
+    d3d12_fence_publish_virtual_value_locked(fence);
     d3d12_fence_signal_external_events_locked(fence);
     d3d12_fence_update_pending_value_locked(fence);
     pthread_mutex_unlock(&fence->mutex);
@@ -987,6 +1149,7 @@ static HRESULT d3d12_fence_signal(struct d3d12_fence *fence, uint64_t physical_v
             if (fence->physical_value == fence->pending_updates[i].physical_value)
             {
                 fence->virtual_value = fence->pending_updates[i].virtual_value;
+                d3d12_fence_publish_virtual_value_locked(fence);
                 d3d12_fence_signal_external_events_locked(fence);
                 fence->pending_updates[i] = fence->pending_updates[--fence->pending_updates_count];
                 did_signal = true;
@@ -1112,19 +1275,11 @@ static HRESULT STDMETHODCALLTYPE d3d12_fence_GetDevice(d3d12_fence_iface *iface,
 static UINT64 STDMETHODCALLTYPE d3d12_fence_GetCompletedValue(d3d12_fence_iface *iface)
 {
     struct d3d12_fence *fence = impl_from_ID3D12Fence1(iface);
-    uint64_t completed_value;
-    int rc;
 
     TRACE("iface %p.\n", iface);
 
-    if ((rc = pthread_mutex_lock(&fence->mutex)))
-    {
-        ERR("Failed to lock mutex, error %d.\n", rc);
-        return 0;
-    }
-    completed_value = fence->virtual_value;
-    pthread_mutex_unlock(&fence->mutex);
-    return completed_value;
+    /* Applications tend to poll this in tight loops, don't take the lock. */
+    return d3d12_fence_get_completed_value(fence);
 }
 
 static HRESULT d3d12_fence_set_native_sync_handle_on_completion_explicit(struct d3d12_fence *fence,
@@ -1136,12 +1291,6 @@ static HRESULT d3d12_fence_set_native_sync_handle_on_completion_explicit(struct
     bool latch;
     int rc;
 
-    if ((rc = pthread_mutex_lock(&fence->mutex)))
-    {
-        ERR("Failed to lock mutex, error %d.\n", rc);
-        return hresult_from_errno(rc);
-    }
-
     memset(&event, 0, sizeof(event));
     event.wait_type = wait_type;
     event.value = value;
@@ -1149,6 +1298,17 @@ static HRESULT d3d12_fence_set_native_sync_handle_on_completion_explicit(struct
     event.latch = &latch;
     event.payload = payload;
 
+    /* Fast path for waits which are already satisfied. A concurrent rewind may not be
+     * observed yet, but then the wait simply completes before the rewind. */
+    if (value <= d3d12_fence_get_completed_value(fence))
+        return vkd3d_waiting_event_signal(&event);
+
+    if ((rc = pthread_mutex_lock(&fence->mutex)))
+    {
+        ERR("Failed to lock mutex, error %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
+
     if (value <= fence->virtual_value)
     {
         hr = vkd3d_waiting_event_signal(&event);
@@ -1264,6 +1424,7 @@ static HRESULT d3d12_fence_init_timeline(struct d3d12_fence *fence, struct d3d12
         UINT64 initial_value)
 {
     fence->virtual_value = initial_value;
+    fence->completed_value = initial_value;
     fence->max_pending_virtual_timeline_value = initial_value;
     fence->physical_value = 0;
     fence->counter = 0;
@@ -1390,31 +1551,15 @@ static void d3d12_shared_fence_dec_ref(struct d3d12_shared_fence *fence)
     ULONG refcount_internal = InterlockedDecrement(&fence->refcount_internal);
     struct vkd3d_shared_fence_waiting_event *current, *e;
     const struct vkd3d_vk_device_procs *vk_procs;
-    bool is_running;
 
     if (!refcount_internal)
     {
-        pthread_mutex_lock(&fence->mutex);
-        is_running = fence->is_running;
-        if (is_running)
-        {
-            fence->is_running = false;
-            pthread_cond_signal(&fence->cond_var);
-        }
-        pthread_mutex_unlock(&fence->mutex);
-
-        if (is_running)
-        {
-            pthread_join(fence->thread, NULL);
-        }
-
         LIST_FOR_EACH_ENTRY_SAFE(current, e, &fence->events, struct vkd3d_shared_fence_waiting_event, entry)
         {
             vkd3d_free(current);
         }
 
         pthread_mutex_destroy(&fence->mutex);
-        pthread_cond_destroy(&fence->cond_var);
 
         vk_procs = &fence->device->vk_procs;
         VK_CALL(vkDestroySemaphore(fence->device->vk_device, fence->timeline_semaphore, NULL));
@@ -1436,6 +1581,7 @@ static ULONG STDMETHODCALLTYPE d3d12_shared_fence_Release(d3d12_fence_iface *ifa
     {
         struct d3d12_device *device = fence->device;
 
+        vkd3d_shared_fence_worker_remove(&device->shared_fence_worker, fence);
         d3d12_shared_fence_dec_ref(fence);
         d3d12_device_release(device);
     }
@@ -1504,152 +1650,319 @@ static UINT64 STDMETHODCALLTYPE d3d12_shared_fence_GetCompletedValue(d3d12_fence
     return completed_value;
 }
 
-static void *vkd3d_shared_fence_worker_main(void *userdata)
+static void vkd3d_shared_fence_worker_remove(struct vkd3d_shared_fence_worker *worker,
+        struct d3d12_shared_fence *fence)
+{
+    bool was_queued;
+
+    /* Pending events are dropped along with the fence, same as a native fence being destroyed. */
+    pthread_mutex_lock(&worker->mutex);
+    if ((was_queued = fence->is_queued))
+    {
+        list_remove(&fence->worker_entry);
+        fence->is_queued = false;
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    if (was_queued)
+        d3d12_shared_fence_dec_ref(fence);
+}
+
+static bool vkd3d_shared_fence_worker_collect_events(struct d3d12_shared_fence *fence,
+        struct list *completed, uint64_t *next_value)
 {
     struct vkd3d_shared_fence_waiting_event *current, *e;
     const struct vkd3d_vk_device_procs *vk_procs;
-    struct d3d12_shared_fence *fence;
-    VkSemaphoreWaitInfo wait_info;
     uint64_t completed_value;
+    bool pending = false;
     VkResult vr;
 
-    fence = userdata;
     vk_procs = &fence->device->vk_procs;
+    *next_value = UINT64_MAX;
 
-    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-    wait_info.pNext = NULL;
-    wait_info.flags = 0;
-    wait_info.semaphoreCount = 1;
-    wait_info.pSemaphores = &fence->timeline_semaphore;
-    wait_info.pValues = &completed_value;
+    pthread_mutex_lock(&fence->mutex);
 
-    while (true)
+    if ((vr = VK_CALL(vkGetSemaphoreCounterValue(fence->device->vk_device, fence->timeline_semaphore, &completed_value))))
     {
-        pthread_mutex_lock(&fence->mutex);
-        while (fence->is_running && list_empty(&fence->events))
-        {
-            pthread_cond_wait(&fence->cond_var, &fence->mutex);
-        }
-
-        vr = VK_CALL(vkGetSemaphoreCounterValue(fence->device->vk_device, fence->timeline_semaphore, &completed_value));
-        if (vr != VK_SUCCESS)
-        {
-            ERR("Failed to get shared fence counter value, error %d.\n", vr);
-            pthread_mutex_unlock(&fence->mutex);
-            return NULL;
-        }
-
-        LIST_FOR_EACH_ENTRY_SAFE(current, e, &fence->events, struct vkd3d_shared_fence_waiting_event, entry)
-        {
-            if (current->wait.value <= completed_value)
-            {
-                vkd3d_waiting_event_signal(&current->wait);
-                list_remove(&current->entry);
-                vkd3d_free(current);
-            }
-        }
-
-        if (!fence->is_running)
-        {
-            pthread_mutex_unlock(&fence->mutex);
-            return NULL;
-        }
+        ERR("Failed to get shared fence counter value, error %d.\n", vr);
+        pthread_mutex_unlock(&fence->mutex);
+        /* Keep polling rather than spinning. */
+        return true;
+    }
 
-        if (list_empty(&fence->events))
+    LIST_FOR_EACH_ENTRY_SAFE(current, e, &fence->events, struct vkd3d_shared_fence_waiting_event, entry)
+    {
+        if (current->wait.value <= completed_value)
         {
-            pthread_mutex_unlock(&fence->mutex);
-            continue;
+            list_remove(&current->entry);
+            list_add_tail(completed, &current->entry);
         }
-
-        pthread_mutex_unlock(&fence->mutex);
-
-        completed_value++;
-        vr = VK_CALL(vkWaitSemaphores(fence->device->vk_device, &wait_info, 10000000ull));
-        if (vr != VK_SUCCESS && vr != VK_TIMEOUT)
+        else
         {
-            ERR("Failed to wait for semaphore, error %d.\n", vr);
-            return NULL;
+            *next_value = min(*next_value, current->wait.value);
+            pending = true;
         }
     }
 
-
-    return NULL;
+    pthread_mutex_unlock(&fence->mutex);
+    return pending;
 }
 
-static HRESULT d3d12_shared_fence_set_native_sync_handle_on_completion_explicit(struct d3d12_shared_fence *fence,
-        enum vkd3d_waiting_event_type wait_type, UINT64 value, vkd3d_native_sync_handle handle, uint32_t *payload)
+static void *vkd3d_shared_fence_worker_main(void *userdata)
 {
-    const struct vkd3d_vk_device_procs *vk_procs = &fence->device->vk_procs;
-    struct vkd3d_shared_fence_waiting_event *waiting_event;
-    struct vkd3d_waiting_event event;
+    struct vkd3d_shared_fence_waiting_event *current, *e;
+    struct vkd3d_shared_fence_worker *worker = userdata;
+    const struct vkd3d_vk_device_procs *vk_procs;
+    size_t fence_count, wait_count, retire_count, i;
+    struct d3d12_shared_fence *fence;
     VkSemaphoreWaitInfo wait_info;
-    uint64_t completed_value;
+    struct list completed;
+    uint64_t next_value;
     VkResult vr;
 
-    TRACE("fence %p, value %#"PRIx64".\n", fence, value);
+    vkd3d_set_thread_name("vkd3d_shared_fence");
+    vkd3d_set_thread_role(VKD3D_THREAD_ROLE_FENCE);
 
-    if (vkd3d_native_sync_handle_is_valid(handle))
+    vk_procs = &worker->device->vk_procs;
+
+    for (;;)
     {
-        memset(&event, 0, sizeof(event));
-        event.wait_type = wait_type;
-        event.value = value;
-        event.handle = handle;
-        event.payload = payload;
+        pthread_mutex_lock(&worker->mutex);
+        while (!worker->should_exit && list_empty(&worker->fences))
+            pthread_cond_wait(&worker->cond, &worker->mutex);
 
-        if ((vr = VK_CALL(vkGetSemaphoreCounterValue(fence->device->vk_device, fence->timeline_semaphore, &completed_value))))
+        if (worker->should_exit)
         {
-            ERR("Failed to get current semaphore value, vr %d.\n", vr);
-            return hresult_from_vk_result(vr);
+            pthread_mutex_unlock(&worker->mutex);
+            break;
         }
 
-        if (completed_value >= value)
-        {
-            vkd3d_waiting_event_signal(&event);
-            return S_OK;
-        }
-        else
+        /* Hold a reference to every fence for the duration of the wait, so that a fence
+         * released by the application does not destroy its semaphore underneath us. */
+        fence_count = 0;
+        LIST_FOR_EACH_ENTRY(fence, &worker->fences, struct d3d12_shared_fence, worker_entry)
         {
-            if (!(waiting_event = vkd3d_malloc(sizeof(*waiting_event))))
+            if (!vkd3d_array_reserve((void **)&worker->wait_fences, &worker->wait_fences_size,
+                    fence_count + 1, sizeof(*worker->wait_fences)))
             {
-                ERR("Failed to register device singleton for adapter.");
-                return E_OUTOFMEMORY;
+                ERR("Failed to allocate wait fence array.\n");
+                break;
             }
 
-            waiting_event->wait = event;
+            d3d12_shared_fence_inc_ref(fence);
+            worker->wait_fences[fence_count++] = fence;
+        }
+        pthread_mutex_unlock(&worker->mutex);
 
-            pthread_mutex_lock(&fence->mutex);
-            list_add_head(&fence->events, &waiting_event->entry);
-            if (!fence->is_running)
-            {
-                fence->is_running = true;
-                pthread_create(&fence->thread, NULL, vkd3d_shared_fence_worker_main, fence);
-            }
-            else
+        if (!vkd3d_array_reserve((void **)&worker->wait_semaphores, &worker->wait_semaphores_size,
+                fence_count, sizeof(*worker->wait_semaphores)) ||
+                !vkd3d_array_reserve((void **)&worker->wait_values, &worker->wait_values_size,
+                fence_count, sizeof(*worker->wait_values)))
+        {
+            ERR("Failed to allocate wait semaphore array.\n");
+            for (i = 0; i < fence_count; i++)
+                d3d12_shared_fence_dec_ref(worker->wait_fences[i]);
+            continue;
+        }
+
+        /* Gather completed events across all fences first, then signal them as one batch
+         * without holding any fence locks. */
+        list_init(&completed);
+        wait_count = 0;
+        retire_count = 0;
+
+        for (i = 0; i < fence_count; i++)
+        {
+            fence = worker->wait_fences[i];
+
+            if (vkd3d_shared_fence_worker_collect_events(fence, &completed, &next_value))
             {
-                pthread_cond_signal(&fence->cond_var);
+                worker->wait_semaphores[wait_count] = fence->timeline_semaphore;
+                worker->wait_values[wait_count] = next_value;
+                wait_count++;
             }
-            pthread_mutex_unlock(&fence->mutex);
-
-            return S_OK;
         }
-    }
-    else
-    {
-        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-        wait_info.pNext = NULL;
-        wait_info.flags = 0;
-        wait_info.semaphoreCount = 1;
-        wait_info.pSemaphores = &fence->timeline_semaphore;
-        wait_info.pValues = &value;
 
-        if ((vr = VK_CALL(vkWaitSemaphores(fence->device->vk_device, &wait_info, UINT64_MAX))))
+        LIST_FOR_EACH_ENTRY_SAFE(current, e, &completed, struct vkd3d_shared_fence_waiting_event, entry)
         {
-            ERR("Failed to wait on shared fence, vr %d.\n", vr);
-            return E_FAIL;
+            vkd3d_waiting_event_signal(&current->wait);
+            list_remove(&current->entry);
+            vkd3d_free(current);
+            retire_count++;
         }
 
-        return S_OK;
-    }
+        /* Drop fences without pending events. New events can only be added while holding
+         * the worker lock, so checking for an empty list here is race free. */
+        pthread_mutex_lock(&worker->mutex);
+        for (i = 0; i < fence_count; i++)
+        {
+            fence = worker->wait_fences[i];
+
+            if (fence->is_queued && list_empty(&fence->events))
+            {
+                list_remove(&fence->worker_entry);
+                fence->is_queued = false;
+                d3d12_shared_fence_dec_ref(fence);
+            }
+        }
+        pthread_mutex_unlock(&worker->mutex);
+
+        if (!retire_count && wait_count)
+        {
+            wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            wait_info.pNext = NULL;
+            wait_info.flags = VK_SEMAPHORE_WAIT_ANY_BIT;
+            wait_info.semaphoreCount = wait_count;
+            wait_info.pSemaphores = worker->wait_semaphores;
+            wait_info.pValues = worker->wait_values;
+
+            /* Time out periodically to pick up events registered since we started waiting. */
+            vr = VK_CALL(vkWaitSemaphores(worker->device->vk_device, &wait_info, 10000000ull));
+            if (vr != VK_SUCCESS && vr != VK_TIMEOUT)
+                ERR("Failed to wait for semaphores, error %d.\n", vr);
+        }
+
+        for (i = 0; i < fence_count; i++)
+            d3d12_shared_fence_dec_ref(worker->wait_fences[i]);
+    }
+
+    return NULL;
+}
+
+HRESULT vkd3d_shared_fence_worker_init(struct vkd3d_shared_fence_worker *worker,
+        struct d3d12_device *device)
+{
+    int rc;
+
+    memset(worker, 0, sizeof(*worker));
+    worker->device = device;
+    list_init(&worker->fences);
+
+    if ((rc = pthread_mutex_init(&worker->mutex, NULL)))
+    {
+        ERR("Failed to initialize mutex, error %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
+
+    if ((rc = pthread_cond_init(&worker->cond, NULL)))
+    {
+        ERR("Failed to initialize condition variable, error %d.\n", rc);
+        pthread_mutex_destroy(&worker->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    return S_OK;
+}
+
+void vkd3d_shared_fence_worker_cleanup(struct vkd3d_shared_fence_worker *worker)
+{
+    pthread_mutex_lock(&worker->mutex);
+    worker->should_exit = true;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->mutex);
+
+    if (worker->is_running)
+        pthread_join(worker->thread, NULL);
+
+    pthread_mutex_destroy(&worker->mutex);
+    pthread_cond_destroy(&worker->cond);
+
+    vkd3d_free(worker->wait_fences);
+    vkd3d_free(worker->wait_semaphores);
+    vkd3d_free(worker->wait_values);
+}
+
+static void vkd3d_shared_fence_worker_add_event(struct vkd3d_shared_fence_worker *worker,
+        struct d3d12_shared_fence *fence, struct vkd3d_shared_fence_waiting_event *waiting_event)
+{
+    pthread_mutex_lock(&worker->mutex);
+
+    pthread_mutex_lock(&fence->mutex);
+    list_add_head(&fence->events, &waiting_event->entry);
+    pthread_mutex_unlock(&fence->mutex);
+
+    if (!fence->is_queued)
+    {
+        d3d12_shared_fence_inc_ref(fence);
+        list_add_tail(&worker->fences, &fence->worker_entry);
+        fence->is_queued = true;
+    }
+
+    /* The thread is only needed once shared fences have events, which is rare. */
+    if (!worker->is_running)
+    {
+        if (pthread_create(&worker->thread, NULL, vkd3d_shared_fence_worker_main, worker))
+            ERR("Failed to create shared fence worker thread.\n");
+        else
+            worker->is_running = true;
+    }
+    else
+        pthread_cond_signal(&worker->cond);
+
+    pthread_mutex_unlock(&worker->mutex);
+}
+
+static HRESULT d3d12_shared_fence_set_native_sync_handle_on_completion_explicit(struct d3d12_shared_fence *fence,
+        enum vkd3d_waiting_event_type wait_type, UINT64 value, vkd3d_native_sync_handle handle, uint32_t *payload)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &fence->device->vk_procs;
+    struct vkd3d_shared_fence_waiting_event *waiting_event;
+    struct vkd3d_waiting_event event;
+    VkSemaphoreWaitInfo wait_info;
+    uint64_t completed_value;
+    VkResult vr;
+
+    TRACE("fence %p, value %#"PRIx64".\n", fence, value);
+
+    if (vkd3d_native_sync_handle_is_valid(handle))
+    {
+        memset(&event, 0, sizeof(event));
+        event.wait_type = wait_type;
+        event.value = value;
+        event.handle = handle;
+        event.payload = payload;
+
+        if ((vr = VK_CALL(vkGetSemaphoreCounterValue(fence->device->vk_device, fence->timeline_semaphore, &completed_value))))
+        {
+            ERR("Failed to get current semaphore value, vr %d.\n", vr);
+            return hresult_from_vk_result(vr);
+        }
+
+        if (completed_value >= value)
+        {
+            vkd3d_waiting_event_signal(&event);
+            return S_OK;
+        }
+        else
+        {
+            if (!(waiting_event = vkd3d_malloc(sizeof(*waiting_event))))
+            {
+                ERR("Failed to register device singleton for adapter.");
+                return E_OUTOFMEMORY;
+            }
+
+            waiting_event->wait = event;
+            vkd3d_shared_fence_worker_add_event(&fence->device->shared_fence_worker, fence, waiting_event);
+            return S_OK;
+        }
+    }
+    else
+    {
+        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wait_info.pNext = NULL;
+        wait_info.flags = 0;
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &fence->timeline_semaphore;
+        wait_info.pValues = &value;
+
+        if ((vr = VK_CALL(vkWaitSemaphores(fence->device->vk_device, &wait_info, UINT64_MAX))))
+        {
+            ERR("Failed to wait on shared fence, vr %d.\n", vr);
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
 }
 
 static HRESULT STDMETHODCALLTYPE d3d12_shared_fence_SetEventOnCompletion(d3d12_fence_iface *iface,
@@ -1746,9 +2059,8 @@ HRESULT d3d12_shared_fence_create(struct d3d12_device *device,
     d3d12_device_add_ref(object->device = device);
 
     pthread_mutex_init(&object->mutex, NULL);
-    pthread_cond_init(&object->cond_var, NULL);
     list_init(&object->events);
-    object->is_running = false;
+    object->is_queued = false;
 
     *fence = object;
     return S_OK;
@@ -1988,18 +2300,218 @@ static bool d3d12_command_allocator_add_view(struct d3d12_command_allocator *all
     return true;
 }
 
-static bool d3d12_command_allocator_add_buffer_view(struct d3d12_command_allocator *allocator,
-        VkBufferView view)
+static uint32_t vkd3d_buffer_view_pool_entry_hash(const void *key)
+{
+    const struct vkd3d_buffer_view_pool_key *k = key;
+    uint32_t hash;
+
+    hash = hash_uint64(k->cookie);
+    hash = hash_combine(hash, hash_uint64(k->offset));
+    hash = hash_combine(hash, hash_uint64(k->range));
+    hash = hash_combine(hash, (uint32_t)k->vk_format);
+    return hash;
+}
+
+static bool vkd3d_buffer_view_pool_entry_compare(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_buffer_view_pool_key *a = key;
+    const struct vkd3d_buffer_view_pool_key *b = &((const struct vkd3d_buffer_view_pool_entry *)entry)->key;
+
+    return a->cookie == b->cookie && a->offset == b->offset &&
+            a->range == b->range && a->vk_format == b->vk_format;
+}
+
+/* Returns a texel buffer view which lives until the allocator is reset.
+ * A NULL format requests a raw R32_UINT view. */
+static bool d3d12_command_allocator_get_buffer_view(struct d3d12_command_allocator *allocator,
+        VkBuffer vk_buffer, uint64_t cookie, VkDeviceSize offset, VkDeviceSize range,
+        const struct vkd3d_format *format, VkBufferView *vk_buffer_view)
 {
-    if (!vkd3d_array_reserve((void **)&allocator->buffer_views, &allocator->buffer_views_size,
-            allocator->buffer_view_count + 1, sizeof(*allocator->buffer_views)))
+    struct d3d12_device *device = allocator->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_buffer_view_pool_entry entry, *e;
+    bool ret;
+
+    entry.key.cookie = cookie;
+    entry.key.offset = offset;
+    entry.key.range = range;
+    entry.key.vk_format = format ? format->vk_format : VK_FORMAT_R32_UINT;
+
+    if ((e = (struct vkd3d_buffer_view_pool_entry *)hash_map_find(&allocator->buffer_view_pool, &entry.key)))
+    {
+        e->generation = allocator->buffer_view_generation;
+        *vk_buffer_view = e->vk_buffer_view;
+        return true;
+    }
+
+    if (format)
+        ret = vkd3d_create_vk_buffer_view(device, vk_buffer, format, offset, range, vk_buffer_view);
+    else
+        ret = vkd3d_create_raw_r32ui_vk_buffer_view(device, vk_buffer, offset, range, vk_buffer_view);
+
+    if (!ret)
         return false;
 
-    allocator->buffer_views[allocator->buffer_view_count++] = view;
+    entry.vk_buffer_view = *vk_buffer_view;
+    entry.generation = allocator->buffer_view_generation;
+
+    if (!hash_map_insert(&allocator->buffer_view_pool, &entry.key, &entry.hash_entry))
+    {
+        ERR("Failed to insert buffer view into pool.\n");
+        VK_CALL(vkDestroyBufferView(device->vk_device, *vk_buffer_view, NULL));
+        return false;
+    }
 
     return true;
 }
 
+void vkd3d_command_pool_cache_init(struct vkd3d_command_pool_cache *cache)
+{
+    uint32_t high_water_mark;
+    unsigned int i;
+
+    memset(cache, 0, sizeof(*cache));
+
+    /* Titles known to churn allocators start out with a warm cache. */
+    high_water_mark = (vkd3d_config_flags & VKD3D_CONFIG_FLAG_RECYCLE_COMMAND_POOLS) ?
+            VKD3D_COMMAND_POOL_CACHE_FORCED_POOLS : 0;
+
+    for (i = 0; i < ARRAY_SIZE(cache->families); i++)
+        cache->families[i].high_water_mark = high_water_mark;
+}
+
+void vkd3d_command_pool_cache_cleanup(struct vkd3d_command_pool_cache *cache, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_command_pool_cache_family *family;
+    unsigned int i, j;
+
+    for (i = 0; i < ARRAY_SIZE(cache->families); i++)
+    {
+        family = &cache->families[i];
+
+        if (family->high_water_mark)
+        {
+            INFO("Command pool cache for family #%u: high-water mark %u, %u pools retained.\n",
+                    i, family->high_water_mark, family->cached_count);
+        }
+
+        for (j = 0; j < ARRAY_SIZE(family->vk_command_pools); j++)
+        {
+            if (family->vk_command_pools[j])
+                VK_CALL(vkDestroyCommandPool(device->vk_device, (VkCommandPool)family->vk_command_pools[j], NULL));
+        }
+    }
+
+    if (cache->release_count)
+    {
+        INFO("Command pool cache: %u hits, %u misses, %u dropped, %u recycled command buffers.\n",
+                cache->hit_count, cache->miss_count, cache->drop_count, cache->recycled_command_buffer_count);
+    }
+}
+
+static struct vkd3d_command_pool_cache_family *d3d12_device_get_command_pool_cache_family(
+        struct d3d12_device *device, uint32_t vk_family_index)
+{
+    unsigned int i;
+
+    for (i = 0; i < device->queue_family_count; i++)
+        if (device->queue_family_indices[i] == vk_family_index)
+            return &device->command_pool_cache.families[i];
+
+    return NULL;
+}
+
+static VkCommandPool d3d12_device_acquire_cached_command_pool(struct d3d12_device *device, uint32_t vk_family_index)
+{
+    struct vkd3d_command_pool_cache *cache = &device->command_pool_cache;
+    struct vkd3d_command_pool_cache_family *family;
+    uint32_t high_water_mark;
+    UINT64 vk_pool;
+    unsigned int i;
+
+    if (!(family = d3d12_device_get_command_pool_cache_family(device, vk_family_index)))
+        return VK_NULL_HANDLE;
+
+    if (vkd3d_atomic_uint32_load_explicit(&family->cached_count, vkd3d_memory_order_relaxed))
+    {
+        for (i = 0; i < ARRAY_SIZE(family->vk_command_pools); i++)
+        {
+            if (!vkd3d_atomic_uint64_load_explicit(&family->vk_command_pools[i], vkd3d_memory_order_relaxed))
+                continue;
+
+            if ((vk_pool = vkd3d_atomic_uint64_exchange_explicit(&family->vk_command_pools[i], 0,
+                    vkd3d_memory_order_acquire)))
+            {
+                vkd3d_atomic_uint32_decrement(&family->cached_count, vkd3d_memory_order_relaxed);
+                vkd3d_atomic_uint32_increment(&cache->hit_count, vkd3d_memory_order_relaxed);
+                return (VkCommandPool)vk_pool;
+            }
+        }
+    }
+
+    vkd3d_atomic_uint32_increment(&cache->miss_count, vkd3d_memory_order_relaxed);
+
+    /* Creating a pool after pools have been released means the application churns allocators.
+     * Allow one more pool to be retained so the working set eventually fits in the cache. */
+    if (vkd3d_atomic_uint32_load_explicit(&cache->release_count, vkd3d_memory_order_relaxed))
+    {
+        high_water_mark = vkd3d_atomic_uint32_load_explicit(&family->high_water_mark, vkd3d_memory_order_relaxed);
+        if (high_water_mark < VKD3D_COMMAND_POOL_CACHE_MAX_POOLS)
+        {
+            vkd3d_atomic_uint32_compare_exchange(&family->high_water_mark, high_water_mark, high_water_mark + 1,
+                    vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed);
+        }
+    }
+
+    return VK_NULL_HANDLE;
+}
+
+/* Returns true if the pool was taken over by the cache. Otherwise the caller must destroy it. */
+static bool d3d12_device_release_cached_command_pool(struct d3d12_device *device, uint32_t vk_family_index,
+        VkCommandPool vk_command_pool, VkCommandBuffer *command_buffers, size_t command_buffer_count)
+{
+    struct vkd3d_command_pool_cache *cache = &device->command_pool_cache;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_command_pool_cache_family *family;
+    uint32_t high_water_mark;
+    unsigned int i;
+
+    if (!(family = d3d12_device_get_command_pool_cache_family(device, vk_family_index)))
+        return false;
+
+    vkd3d_atomic_uint32_increment(&cache->release_count, vkd3d_memory_order_relaxed);
+
+    high_water_mark = vkd3d_atomic_uint32_load_explicit(&family->high_water_mark, vkd3d_memory_order_relaxed);
+    if (vkd3d_atomic_uint32_load_explicit(&family->cached_count, vkd3d_memory_order_relaxed) >= high_water_mark)
+    {
+        vkd3d_atomic_uint32_increment(&cache->drop_count, vkd3d_memory_order_relaxed);
+        return false;
+    }
+
+    /* Have to free command buffers here if we're going to recycle,
+     * otherwise DestroyCommandPool takes care of it.
+     * Resetting without RELEASE_RESOURCES keeps the pool memory around, which is the point. */
+    VK_CALL(vkFreeCommandBuffers(device->vk_device, vk_command_pool, command_buffer_count, command_buffers));
+    VK_CALL(vkResetCommandPool(device->vk_device, vk_command_pool, 0));
+
+    for (i = 0; i < high_water_mark; i++)
+    {
+        if (vkd3d_atomic_uint64_compare_exchange(&family->vk_command_pools[i], 0, (uint64_t)vk_command_pool,
+                vkd3d_memory_order_release, vkd3d_memory_order_relaxed) == 0)
+        {
+            vkd3d_atomic_uint32_increment(&family->cached_count, vkd3d_memory_order_relaxed);
+            vkd3d_atomic_uint32_add(&cache->recycled_command_buffer_count, command_buffer_count,
+                    vkd3d_memory_order_relaxed);
+            return true;
+        }
+    }
+
+    /* Lost a race for the last free slot. The command buffers are already gone, which is fine. */
+    vkd3d_atomic_uint32_increment(&cache->drop_count, vkd3d_memory_order_relaxed);
+    return false;
+}
+
 static void d3d12_command_list_allocator_destroyed(struct d3d12_command_list *list)
 {
     TRACE("list %p.\n", list);
@@ -2014,13 +2526,28 @@ static void d3d12_command_allocator_free_resources(struct d3d12_command_allocato
 {
     struct d3d12_device *device = allocator->device;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_buffer_view_pool_entry *e;
+    uint32_t generation;
     unsigned int i;
 
-    for (i = 0; i < allocator->buffer_view_count; ++i)
+    /* Resources referenced by the previous recording are likely to be referenced again,
+     * so only destroy views which went unused for an entire recording. */
+    generation = allocator->buffer_view_generation++;
+
+    for (i = 0; i < allocator->buffer_view_pool.entry_count; )
     {
-        VK_CALL(vkDestroyBufferView(device->vk_device, allocator->buffer_views[i], NULL));
+        e = (struct vkd3d_buffer_view_pool_entry *)hash_map_get_entry(&allocator->buffer_view_pool, i);
+
+        if ((e->hash_entry.flags & HASH_MAP_ENTRY_OCCUPIED) &&
+                (!keep_reusable_resources || e->generation != generation))
+        {
+            VK_CALL(vkDestroyBufferView(device->vk_device, e->vk_buffer_view, NULL));
+            /* Removal shifts a later entry into this slot, so look at it again. */
+            hash_map_remove(&allocator->buffer_view_pool, &e->hash_entry);
+        }
+        else
+            i++;
     }
-    allocator->buffer_view_count = 0;
 
     for (i = 0; i < allocator->view_count; ++i)
     {
@@ -2077,7 +2604,7 @@ static ULONG STDMETHODCALLTYPE d3d12_command_allocator_Release(ID3D12CommandAllo
 {
     struct d3d12_command_allocator *allocator = impl_from_ID3D12CommandAllocator(iface);
     ULONG refcount = InterlockedDecrement(&allocator->refcount);
-    unsigned int i, j;
+    unsigned int i;
     LONG pending;
 
     TRACE("%p decreasing refcount to %u.\n", allocator, refcount);
@@ -2100,37 +2627,14 @@ static ULONG STDMETHODCALLTYPE d3d12_command_allocator_Release(ID3D12CommandAllo
             d3d12_command_list_allocator_destroyed(allocator->current_command_list);
 
         d3d12_command_allocator_free_resources(allocator, false);
-        vkd3d_free(allocator->buffer_views);
+        hash_map_free(&allocator->buffer_view_pool);
         vkd3d_free(allocator->views);
 
-        if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_RECYCLE_COMMAND_POOLS)
-        {
-            /* Don't want to do this unless we have to, so hide it behind a config.
-             * For well-behaving apps, we'll just bloat memory. */
-            if (pthread_mutex_lock(&device->mutex) == 0)
-            {
-                if (device->cached_command_allocator_count < ARRAY_SIZE(device->cached_command_allocators))
-                {
-                    /* Recycle the pool. Some games spam free/allocate pools,
-                     * even if it completely goes against the point of the API. */
-
-                    /* Have to free command buffers here if we're going to recycle,
-                     * otherwise DestroyCommandPool takes care of it. */
-                    VK_CALL(vkFreeCommandBuffers(device->vk_device, allocator->vk_command_pool,
-                            allocator->command_buffer_count, allocator->command_buffers));
-                    VK_CALL(vkResetCommandPool(device->vk_device, allocator->vk_command_pool, 0));
-
-                    device->cached_command_allocators[device->cached_command_allocator_count].vk_command_pool =
-                            allocator->vk_command_pool;
-                    device->cached_command_allocators[device->cached_command_allocator_count].vk_family_index =
-                            allocator->vk_family_index;
-                    device->cached_command_allocator_count++;
-                    allocator->vk_command_pool = VK_NULL_HANDLE;
-                }
-
-                pthread_mutex_unlock(&device->mutex);
-            }
-        }
+        /* Recycle the pool. Some games spam free/allocate pools,
+         * even if it completely goes against the point of the API. */
+        if (d3d12_device_release_cached_command_pool(device, allocator->vk_family_index,
+                allocator->vk_command_pool, allocator->command_buffers, allocator->command_buffer_count))
+            allocator->vk_command_pool = VK_NULL_HANDLE;
 
         /* Command buffers are implicitly freed when destroying the pool. */
         vkd3d_free(allocator->command_buffers);
@@ -2138,15 +2642,17 @@ static ULONG STDMETHODCALLTYPE d3d12_command_allocator_Release(ID3D12CommandAllo
 
         for (i = 0; i < VKD3D_SCRATCH_POOL_KIND_COUNT; i++)
         {
-            for (j = 0; j < allocator->scratch_pools[i].scratch_buffer_count; j++)
-                d3d12_device_return_scratch_buffer(device, i, &allocator->scratch_pools[i].scratch_buffers[j]);
+            d3d12_device_return_scratch_buffers(device, i, allocator->scratch_pools[i].scratch_buffers,
+                    allocator->scratch_pools[i].scratch_buffer_count);
             vkd3d_free(allocator->scratch_pools[i].scratch_buffers);
         }
 
-        for (i = 0; i < allocator->query_pool_count; i++)
-            d3d12_device_return_query_pool(device, &allocator->query_pools[i]);
+        d3d12_device_return_query_pools(device, allocator->query_pools, allocator->query_pool_count);
+        d3d12_device_return_query_pools(device, allocator->free_query_pools, allocator->free_query_pool_count);
 
         vkd3d_free(allocator->query_pools);
+        vkd3d_free(allocator->free_query_pools);
+        vkd3d_free(allocator->meta_timings);
 
 #ifdef VKD3D_ENABLE_BREADCRUMBS
         if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_BREADCRUMBS)
@@ -2206,6 +2712,297 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_GetDevice(ID3D12Command
     return d3d12_device_query_interface(allocator->device, iid, device);
 }
 
+static void d3d12_command_allocator_trim_scratch_pool(struct d3d12_command_allocator *allocator,
+        enum vkd3d_scratch_pool_kind kind)
+{
+    struct d3d12_command_allocator_scratch_pool *pool = &allocator->scratch_pools[kind];
+    struct vkd3d_scratch_buffer tmp;
+    size_t retained_count = 0;
+    size_t i;
+
+    /* Move default sized buffers to the front. Oversized buffers are one-off allocations. */
+    for (i = 0; i < pool->scratch_buffer_count &&
+            retained_count < VKD3D_COMMAND_ALLOCATOR_SCRATCH_BUFFER_RETAIN_COUNT; i++)
+    {
+        if (pool->scratch_buffers[i].allocation.resource.size != VKD3D_SCRATCH_BUFFER_SIZE)
+            continue;
+
+        if (i != retained_count)
+        {
+            tmp = pool->scratch_buffers[retained_count];
+            pool->scratch_buffers[retained_count] = pool->scratch_buffers[i];
+            pool->scratch_buffers[i] = tmp;
+        }
+
+        pool->scratch_buffers[retained_count++].offset = 0;
+    }
+
+    d3d12_device_return_scratch_buffers(allocator->device, kind, pool->scratch_buffers + retained_count,
+            pool->scratch_buffer_count - retained_count);
+    pool->scratch_buffer_count = retained_count;
+}
+
+static bool d3d12_command_allocator_should_retain_query_pool(struct d3d12_command_allocator *allocator,
+        const uint32_t *pool_counts, size_t retain_count, uint32_t type_index)
+{
+    return pool_counts[type_index] < allocator->query_pool_history[type_index] &&
+            retain_count < VKD3D_COMMAND_ALLOCATOR_QUERY_POOL_RETAIN_COUNT;
+}
+
+static void d3d12_command_allocator_trim_query_pools(struct d3d12_command_allocator *allocator)
+{
+    uint32_t pool_counts[VKD3D_VIRTUAL_QUERY_TYPE_COUNT];
+    size_t retain_count, reject_count, i;
+    struct vkd3d_query_pool pool;
+    uint32_t type_index;
+
+    /* Remember how many pools of each type the last recording needed. The peak
+     * decays slowly so that a single heavy frame does not pin pools forever. */
+    for (i = 0; i < VKD3D_VIRTUAL_QUERY_TYPE_COUNT; i++)
+    {
+        allocator->query_pool_history[i] = max(allocator->query_pool_usage[i],
+                allocator->query_pool_history[i] - allocator->query_pool_history[i] / 4u);
+        allocator->query_pool_usage[i] = 0;
+        pool_counts[i] = 0;
+    }
+
+    /* Compact wanted free pools to the front and return the rest. */
+    retain_count = 0;
+
+    for (i = 0; i < allocator->free_query_pool_count; i++)
+    {
+        type_index = allocator->free_query_pools[i].type_index;
+
+        if (d3d12_command_allocator_should_retain_query_pool(allocator, pool_counts, retain_count, type_index))
+        {
+            pool = allocator->free_query_pools[i];
+            allocator->free_query_pools[i] = allocator->free_query_pools[retain_count];
+            allocator->free_query_pools[retain_count++] = pool;
+            pool_counts[type_index]++;
+        }
+    }
+
+    d3d12_device_return_query_pools(allocator->device, allocator->free_query_pools + retain_count,
+            allocator->free_query_pool_count - retain_count);
+    allocator->free_query_pool_count = retain_count;
+
+    /* Pools used by the previous recording are the next candidates. */
+    reject_count = allocator->query_pool_count;
+
+    if (vkd3d_array_reserve((void **)&allocator->free_query_pools, &allocator->free_query_pools_size,
+            VKD3D_COMMAND_ALLOCATOR_QUERY_POOL_RETAIN_COUNT, sizeof(*allocator->free_query_pools)))
+    {
+        reject_count = 0;
+
+        for (i = 0; i < allocator->query_pool_count; i++)
+        {
+            type_index = allocator->query_pools[i].type_index;
+
+            if (d3d12_command_allocator_should_retain_query_pool(allocator, pool_counts, retain_count, type_index))
+            {
+                allocator->free_query_pools[allocator->free_query_pool_count++] = allocator->query_pools[i];
+                pool_counts[type_index]++;
+                retain_count++;
+            }
+            else
+                allocator->query_pools[reject_count++] = allocator->query_pools[i];
+        }
+    }
+
+    d3d12_device_return_query_pools(allocator->device, allocator->query_pools, reject_count);
+    allocator->query_pool_count = 0;
+
+    /* Pre-acquire whatever is still missing, so that the next recording does not
+     * have to go through the device-wide pool cache while recording. */
+    for (type_index = 0; type_index < VKD3D_VIRTUAL_QUERY_TYPE_COUNT; type_index++)
+    {
+        while (allocator->free_query_pool_count < allocator->free_query_pools_size &&
+                d3d12_command_allocator_should_retain_query_pool(allocator, pool_counts, retain_count, type_index))
+        {
+            if (FAILED(d3d12_device_get_query_pool(allocator->device, type_index, &pool)))
+                break;
+
+            allocator->free_query_pools[allocator->free_query_pool_count++] = pool;
+            pool_counts[type_index]++;
+            retain_count++;
+        }
+    }
+}
+
+static const char * const vkd3d_meta_timing_category_names[VKD3D_META_TIMING_CATEGORY_COUNT] =
+{
+    "clear UAV", "query resolve", "execute indirect", "predication",
+};
+
+void vkd3d_meta_timing_init(struct vkd3d_meta_timing *timing, struct d3d12_device *device)
+{
+    memset(timing, 0, sizeof(*timing));
+    spinlock_init(&timing->lock);
+    timing->ns_per_tick = device->vk_info.device_limits.timestampPeriod;
+    timing->report_time_ns = vkd3d_get_current_time_ns();
+
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_META_TIMING)
+        INFO("Timing meta operations on the GPU.\n");
+}
+
+static void vkd3d_meta_timing_report_locked(struct vkd3d_meta_timing *timing, uint64_t frame_count)
+{
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_META_TIMING_CATEGORY_COUNT; i++)
+    {
+        if (!timing->total_count[i])
+            continue;
+
+        if (frame_count)
+        {
+            INFO("Meta GPU time (%s): %.3f ms per frame, %.1f operations per frame.\n",
+                    vkd3d_meta_timing_category_names[i], 1e-6 * (double)timing->total_ns[i] / frame_count,
+                    (double)timing->total_count[i] / frame_count);
+        }
+        else
+        {
+            INFO("Meta GPU time (%s): %.3f ms over %u operations.\n",
+                    vkd3d_meta_timing_category_names[i], 1e-6 * (double)timing->total_ns[i],
+                    timing->total_count[i]);
+        }
+    }
+
+    memset(timing->total_ns, 0, sizeof(timing->total_ns));
+    memset(timing->total_count, 0, sizeof(timing->total_count));
+}
+
+void vkd3d_meta_timing_cleanup(struct vkd3d_meta_timing *timing, struct d3d12_device *device)
+{
+    uint64_t frame_index;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_META_TIMING))
+        return;
+
+    frame_index = vkd3d_atomic_uint64_load_explicit(&device->residency_manager.frame_index, vkd3d_memory_order_relaxed);
+    vkd3d_meta_timing_report_locked(timing, frame_index - timing->report_frame_index);
+}
+
+static const char * const vkd3d_command_list_stat_names[VKD3D_COMMAND_LIST_STAT_COUNT] =
+{
+    "draws", "dispatches", "render pass begins", "render pass suspends", "render pass ends",
+    "barrier batches", "descriptor buffer binds", "dynamic state emits", "meta operations",
+    "query resolve flushes",
+};
+
+void vkd3d_command_list_stats_report_init(struct vkd3d_command_list_stats_report *report)
+{
+    memset(report, 0, sizeof(*report));
+    report->report_time_ns = vkd3d_get_current_time_ns();
+
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_COMMAND_LIST_STATS)
+        INFO("Logging command list statistics.\n");
+}
+
+void vkd3d_command_list_stats_report_notify_frame(struct vkd3d_command_list_stats_report *report)
+{
+    uint64_t now_ns, report_time_ns, frame_count, list_count, total;
+    unsigned int i;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_COMMAND_LIST_STATS))
+        return;
+
+    vkd3d_atomic_uint64_add(&report->frame_count, 1, vkd3d_memory_order_relaxed);
+
+    now_ns = vkd3d_get_current_time_ns();
+    report_time_ns = vkd3d_atomic_uint64_load_explicit(&report->report_time_ns, vkd3d_memory_order_relaxed);
+    if (now_ns - report_time_ns < 1000000000ull)
+        return;
+
+    /* Multiple swapchains may present concurrently, only one of them gets to report. */
+    if (vkd3d_atomic_uint64_compare_exchange(&report->report_time_ns, report_time_ns, now_ns,
+            vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed) != report_time_ns)
+        return;
+
+    /* Submissions racing with the report end up in the next interval. */
+    frame_count = vkd3d_atomic_uint64_exchange_explicit(&report->frame_count, 0, vkd3d_memory_order_relaxed);
+    list_count = vkd3d_atomic_uint64_exchange_explicit(&report->list_count, 0, vkd3d_memory_order_relaxed);
+
+    INFO("Command lists: %.1f submitted per frame over %"PRIu64" frames.\n",
+            (double)list_count / frame_count, frame_count);
+
+    for (i = 0; i < VKD3D_COMMAND_LIST_STAT_COUNT; i++)
+    {
+        total = vkd3d_atomic_uint64_exchange_explicit(&report->totals[i], 0, vkd3d_memory_order_relaxed);
+        INFO("Command lists (%s): %.1f per frame, %.1f per list.\n", vkd3d_command_list_stat_names[i],
+                (double)total / frame_count, list_count ? (double)total / list_count : 0.0);
+    }
+}
+
+static void vkd3d_meta_timing_accumulate(struct vkd3d_meta_timing *timing, struct d3d12_device *device,
+        const uint64_t *total_ns, const uint32_t *total_count)
+{
+    uint64_t now_ns, frame_index;
+    unsigned int i;
+
+    spinlock_acquire(&timing->lock);
+
+    for (i = 0; i < VKD3D_META_TIMING_CATEGORY_COUNT; i++)
+    {
+        timing->total_ns[i] += total_ns[i];
+        timing->total_count[i] += total_count[i];
+    }
+
+    /* Allocators are reset by the application once a frame's GPU work retired,
+     * which makes this a convenient point to report from. */
+    now_ns = vkd3d_get_current_time_ns();
+    if (now_ns - timing->report_time_ns >= 1000000000ull)
+    {
+        frame_index = vkd3d_atomic_uint64_load_explicit(&device->residency_manager.frame_index, vkd3d_memory_order_relaxed);
+        vkd3d_meta_timing_report_locked(timing, frame_index - timing->report_frame_index);
+        timing->report_frame_index = frame_index;
+        timing->report_time_ns = now_ns;
+    }
+
+    spinlock_release(&timing->lock);
+}
+
+static bool d3d12_command_allocator_read_meta_timestamp(struct d3d12_command_allocator *allocator,
+        const struct vkd3d_meta_timing_scope *scope, uint64_t *timestamp)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &allocator->device->vk_procs;
+
+    return VK_CALL(vkGetQueryPoolResults(allocator->device->vk_device, scope->vk_query_pool,
+            scope->query_index, 1, sizeof(*timestamp), timestamp, sizeof(*timestamp),
+            VK_QUERY_RESULT_64_BIT)) == VK_SUCCESS;
+}
+
+static void d3d12_command_allocator_resolve_meta_timings(struct d3d12_command_allocator *allocator)
+{
+    struct vkd3d_meta_timing *timing = &allocator->device->meta_timing;
+    uint32_t total_count[VKD3D_META_TIMING_CATEGORY_COUNT];
+    uint64_t total_ns[VKD3D_META_TIMING_CATEGORY_COUNT];
+    const struct vkd3d_meta_timing_record *record;
+    uint64_t begin, end;
+    size_t i;
+
+    memset(total_ns, 0, sizeof(total_ns));
+    memset(total_count, 0, sizeof(total_count));
+
+    /* Reset() requires the GPU to be done with the allocator, so results are final.
+     * Command lists which were never submitted yield no available results. */
+    for (i = 0; i < allocator->meta_timing_count; i++)
+    {
+        record = &allocator->meta_timings[i];
+
+        if (!d3d12_command_allocator_read_meta_timestamp(allocator, &record->begin, &begin) ||
+                !d3d12_command_allocator_read_meta_timestamp(allocator, &record->end, &end))
+            continue;
+
+        total_ns[record->category] += (uint64_t)((double)((end - begin) & allocator->meta_timing_mask) *
+                timing->ns_per_tick);
+        total_count[record->category]++;
+    }
+
+    allocator->meta_timing_count = 0;
+    vkd3d_meta_timing_accumulate(timing, allocator->device, total_ns, total_count);
+}
+
 static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_Reset(ID3D12CommandAllocator *iface)
 {
     struct d3d12_command_allocator *allocator = impl_from_ID3D12CommandAllocator(iface);
@@ -2214,7 +3011,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_Reset(ID3D12CommandAllo
     struct d3d12_device *device;
     LONG pending;
     VkResult vr;
-    size_t i, j;
+    size_t i;
 
     TRACE("iface %p.\n", iface);
 
@@ -2263,13 +3060,9 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_Reset(ID3D12CommandAllo
         return hresult_from_vk_result(vr);
     }
 
-    /* Return scratch buffers to the device */
+    /* Keep a few scratch buffers for the next recording and return the rest to the device */
     for (i = 0; i < VKD3D_SCRATCH_POOL_KIND_COUNT; i++)
-    {
-        for (j = 0; j < allocator->scratch_pools[i].scratch_buffer_count; j++)
-            d3d12_device_return_scratch_buffer(device, i, &allocator->scratch_pools[i].scratch_buffers[j]);
-        allocator->scratch_pools[i].scratch_buffer_count = 0;
-    }
+        d3d12_command_allocator_trim_scratch_pool(allocator, i);
 
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_BREADCRUMBS)
@@ -2281,11 +3074,11 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_allocator_Reset(ID3D12CommandAllo
     }
 #endif
 
-    /* Return query pools to the device */
-    for (i = 0; i < allocator->query_pool_count; i++)
-        d3d12_device_return_query_pool(device, &allocator->query_pools[i]);
+    /* Must happen before the query pools are recycled. */
+    if (allocator->meta_timing_count)
+        d3d12_command_allocator_resolve_meta_timings(allocator);
 
-    allocator->query_pool_count = 0;
+    d3d12_command_allocator_trim_query_pools(allocator);
     memset(&allocator->active_query_pools, 0, sizeof(allocator->active_query_pools));
     return S_OK;
 }
@@ -2324,22 +3117,43 @@ struct vkd3d_queue_family_info *d3d12_device_get_vkd3d_queue_family(struct d3d12
     }
 }
 
+static bool vkd3d_queue_is_less_loaded(struct vkd3d_queue *queue, struct vkd3d_queue *other,
+        bool high_priority)
+{
+    uint32_t queue_count, other_count;
+
+    /* Queues with the requested priority always win. Otherwise, the high priority queue counts
+     * as having an extra virtual queue, so it's only shared with normal queues once everything else is busy. */
+    if (queue->high_priority != other->high_priority && high_priority)
+        return queue->high_priority;
+
+    queue_count = queue->virtual_queue_count + (queue->high_priority && !high_priority);
+    other_count = other->virtual_queue_count + (other->high_priority && !high_priority);
+
+    if (queue_count != other_count)
+        return queue_count < other_count;
+
+    /* Break ties with how much work has actually been submitted, so that new queues
+     * avoid sharing a VkQueue with whatever queue the application is hammering. */
+    return vkd3d_atomic_uint64_load_explicit(&queue->execute_count, vkd3d_memory_order_relaxed) <
+            vkd3d_atomic_uint64_load_explicit(&other->execute_count, vkd3d_memory_order_relaxed);
+}
+
 struct vkd3d_queue *d3d12_device_allocate_vkd3d_queue(struct d3d12_device *device,
-        struct vkd3d_queue_family_info *queue_family)
+        struct vkd3d_queue_family_info *queue_family, bool high_priority)
 {
     struct vkd3d_queue *queue;
     unsigned int i;
 
     pthread_mutex_lock(&device->mutex);
 
-    /* Select the queue that has the lowest number of virtual queues mapped
-     * to it, in order to avoid situations where we map multiple queues to
+    /* Select the least loaded queue, in order to avoid situations where we map multiple queues to
      * the same vkd3d queue while others are unused */
     queue = queue_family->queues[0];
 
     for (i = 1; i < queue_family->queue_count; i++)
     {
-        if (queue_family->queues[i]->virtual_queue_count < queue->virtual_queue_count)
+        if (vkd3d_queue_is_less_loaded(queue_family->queues[i], queue, high_priority))
             queue = queue_family->queues[i];
     }
 
@@ -2365,7 +3179,6 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
     VkCommandPoolCreateInfo command_pool_info;
     VkResult vr;
     HRESULT hr;
-    size_t i;
 
     if (FAILED(hr = vkd3d_private_store_init(&allocator->private_store)))
         return hr;
@@ -2388,24 +3201,8 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
     allocator->vk_command_pool = VK_NULL_HANDLE;
     allocator->vk_family_index = queue_family->vk_family_index;
 
-    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_RECYCLE_COMMAND_POOLS)
-    {
-        /* Try to recycle command allocators. Some games spam free/allocate pools. */
-        if (pthread_mutex_lock(&device->mutex) == 0)
-        {
-            for (i = 0; i < device->cached_command_allocator_count; i++)
-            {
-                if (device->cached_command_allocators[i].vk_family_index == queue_family->vk_family_index)
-                {
-                    allocator->vk_command_pool = device->cached_command_allocators[i].vk_command_pool;
-                    device->cached_command_allocators[i] =
-                            device->cached_command_allocators[--device->cached_command_allocator_count];
-                    break;
-                }
-            }
-            pthread_mutex_unlock(&device->mutex);
-        }
-    }
+    /* Try to recycle command allocators. Some games spam free/allocate pools. */
+    allocator->vk_command_pool = d3d12_device_acquire_cached_command_pool(device, queue_family->vk_family_index);
 
     if (allocator->vk_command_pool == VK_NULL_HANDLE)
     {
@@ -2428,9 +3225,9 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
     allocator->views_size = 0;
     allocator->view_count = 0;
 
-    allocator->buffer_views = NULL;
-    allocator->buffer_views_size = 0;
-    allocator->buffer_view_count = 0;
+    hash_map_init(&allocator->buffer_view_pool, vkd3d_buffer_view_pool_entry_hash,
+            vkd3d_buffer_view_pool_entry_compare, sizeof(struct vkd3d_buffer_view_pool_entry));
+    allocator->buffer_view_generation = 0;
 
     allocator->command_buffers = NULL;
     allocator->command_buffers_size = 0;
@@ -2441,7 +3238,21 @@ static HRESULT d3d12_command_allocator_init(struct d3d12_command_allocator *allo
     allocator->query_pools = NULL;
     allocator->query_pools_size = 0;
     allocator->query_pool_count = 0;
+
+    allocator->free_query_pools = NULL;
+    allocator->free_query_pools_size = 0;
+    allocator->free_query_pool_count = 0;
+
     memset(&allocator->active_query_pools, 0, sizeof(allocator->active_query_pools));
+    memset(allocator->query_pool_usage, 0, sizeof(allocator->query_pool_usage));
+    memset(allocator->query_pool_history, 0, sizeof(allocator->query_pool_history));
+
+    allocator->meta_timings = NULL;
+    allocator->meta_timings_size = 0;
+    allocator->meta_timing_count = 0;
+    allocator->meta_timing = (vkd3d_config_flags & VKD3D_CONFIG_FLAG_META_TIMING) && queue_family->timestamp_bits;
+    allocator->meta_timing_mask = queue_family->timestamp_bits >= 64 ?
+            UINT64_MAX : (1ull << queue_family->timestamp_bits) - 1;
 
     allocator->current_command_list = NULL;
 
@@ -2481,6 +3292,7 @@ HRESULT d3d12_command_allocator_create(struct d3d12_device *device,
 struct vkd3d_scratch_allocation
 {
     VkBuffer buffer;
+    uint64_t cookie; /* Only set for allocations from the allocator's scratch pools. */
     VkDeviceSize offset;
     VkDeviceAddress va;
     void *host_ptr;
@@ -2514,6 +3326,7 @@ static bool d3d12_command_allocator_allocate_scratch_memory(struct d3d12_command
             scratch->offset = aligned_offset + aligned_size;
 
             allocation->buffer = scratch->allocation.resource.vk_buffer;
+            allocation->cookie = scratch->allocation.resource.cookie;
             allocation->offset = scratch->allocation.offset + aligned_offset;
             allocation->va = scratch->allocation.resource.va + aligned_offset;
             if (scratch->allocation.cpu_address)
@@ -2542,6 +3355,7 @@ static bool d3d12_command_allocator_allocate_scratch_memory(struct d3d12_command
     scratch->offset = aligned_size;
 
     allocation->buffer = scratch->allocation.resource.vk_buffer;
+    allocation->cookie = scratch->allocation.resource.cookie;
     allocation->offset = scratch->allocation.offset;
     allocation->va = scratch->allocation.resource.va;
     allocation->host_ptr = scratch->allocation.cpu_address;
@@ -2569,6 +3383,26 @@ static uint32_t d3d12_query_heap_type_to_type_index(D3D12_QUERY_HEAP_TYPE heap_t
     }
 }
 
+static bool d3d12_command_allocator_get_free_query_pool(struct d3d12_command_allocator *allocator,
+        uint32_t type_index, struct vkd3d_query_pool *pool)
+{
+    size_t i;
+
+    for (i = 0; i < allocator->free_query_pool_count; i++)
+    {
+        if (allocator->free_query_pools[i].type_index == type_index)
+        {
+            *pool = allocator->free_query_pools[i];
+            pool->next_index = 0;
+            if (--allocator->free_query_pool_count != i)
+                allocator->free_query_pools[i] = allocator->free_query_pools[allocator->free_query_pool_count];
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool d3d12_command_allocator_allocate_query_from_type_index(
         struct d3d12_command_allocator *allocator,
         uint32_t type_index, VkQueryPool *query_pool, uint32_t *query_index)
@@ -2578,9 +3412,12 @@ bool d3d12_command_allocator_allocate_query_from_type_index(
 
     if (pool->next_index >= pool->query_count)
     {
-        if (FAILED(d3d12_device_get_query_pool(allocator->device, type_index, pool)))
+        if (!d3d12_command_allocator_get_free_query_pool(allocator, type_index, pool) &&
+                FAILED(d3d12_device_get_query_pool(allocator->device, type_index, pool)))
             return false;
 
+        allocator->query_pool_usage[type_index]++;
+
         if (vkd3d_array_reserve((void**)&allocator->query_pools, &allocator->query_pools_size,
                 allocator->query_pool_count + 1, sizeof(*allocator->query_pools)))
             allocator->query_pools[allocator->query_pool_count++] = *pool;
@@ -2938,34 +3775,65 @@ static void d3d12_command_list_decay_optimal_dsv_resource(struct d3d12_command_l
     d3d12_command_list_barrier_batch_add_layout_transition(list, batch, &barrier);
 }
 
-static uint32_t d3d12_command_list_notify_decay_dsv_resource(struct d3d12_command_list *list,
-        struct d3d12_resource *resource)
+static uint32_t *d3d12_command_list_get_dsv_tracking_hint(struct d3d12_command_list *list,
+        const struct d3d12_resource *resource)
+{
+    return &list->dsv_resource_tracking_hints[resource->res.cookie % VKD3D_DSV_RESOURCE_TRACKING_HINT_COUNT];
+}
+
+static bool d3d12_command_list_find_dsv_tracking(const struct d3d12_command_list *list,
+        const struct d3d12_resource *resource, size_t *index)
 {
-    uint32_t decay_aspects;
     size_t i, n;
 
-    /* No point in adding these since they are always deduced to be optimal or general. */
-    if ((resource->desc.Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE) ||
-            resource->common_layout == VK_IMAGE_LAYOUT_GENERAL)
-        return 0;
+    /* Engines commonly ping-pong between a few depth targets, e.g. shadow cascades
+     * and the main depth buffer, so avoid scanning everything that was promoted. */
+    i = list->dsv_resource_tracking_hints[resource->res.cookie % VKD3D_DSV_RESOURCE_TRACKING_HINT_COUNT];
+    if (i < list->dsv_resource_tracking_count && list->dsv_resource_tracking[i].resource == resource)
+    {
+        *index = i;
+        return true;
+    }
 
     for (i = 0, n = list->dsv_resource_tracking_count; i < n; i++)
     {
         if (list->dsv_resource_tracking[i].resource == resource)
         {
-            decay_aspects = list->dsv_resource_tracking[i].plane_optimal_mask;
-            list->dsv_resource_tracking[i] = list->dsv_resource_tracking[--list->dsv_resource_tracking_count];
-            return decay_aspects;
+            *index = i;
+            return true;
         }
     }
 
-    return 0;
+    return false;
+}
+
+static uint32_t d3d12_command_list_notify_decay_dsv_resource(struct d3d12_command_list *list,
+        struct d3d12_resource *resource)
+{
+    uint32_t decay_aspects;
+    size_t i;
+
+    /* No point in adding these since they are always deduced to be optimal or general. */
+    if ((resource->desc.Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE) ||
+            resource->common_layout == VK_IMAGE_LAYOUT_GENERAL)
+        return 0;
+
+    if (!d3d12_command_list_find_dsv_tracking(list, resource, &i))
+        return 0;
+
+    decay_aspects = list->dsv_resource_tracking[i].plane_optimal_mask;
+    list->dsv_resource_tracking[i] = list->dsv_resource_tracking[--list->dsv_resource_tracking_count];
+
+    if (i < list->dsv_resource_tracking_count)
+        *d3d12_command_list_get_dsv_tracking_hint(list, list->dsv_resource_tracking[i].resource) = i;
+
+    return decay_aspects;
 }
 
 static uint32_t d3d12_command_list_promote_dsv_resource(struct d3d12_command_list *list,
         struct d3d12_resource *resource, uint32_t plane_optimal_mask)
 {
-    size_t i, n;
+    size_t i;
     assert(!(plane_optimal_mask & ~(VKD3D_DEPTH_PLANE_OPTIMAL | VKD3D_STENCIL_PLANE_OPTIMAL)));
 
     /* No point in adding these since they are always deduced to be optimal. */
@@ -2982,17 +3850,16 @@ static uint32_t d3d12_command_list_promote_dsv_resource(struct d3d12_command_lis
     if (!(resource->format->vk_aspect_mask & VK_IMAGE_ASPECT_DEPTH_BIT))
         plane_optimal_mask |= (plane_optimal_mask & VKD3D_STENCIL_PLANE_OPTIMAL) ? VKD3D_DEPTH_PLANE_OPTIMAL : 0;
 
-    for (i = 0, n = list->dsv_resource_tracking_count; i < n; i++)
+    if (d3d12_command_list_find_dsv_tracking(list, resource, &i))
     {
-        if (list->dsv_resource_tracking[i].resource == resource)
-        {
-            list->dsv_resource_tracking[i].plane_optimal_mask |= plane_optimal_mask;
-            return list->dsv_resource_tracking[i].plane_optimal_mask;
-        }
+        *d3d12_command_list_get_dsv_tracking_hint(list, resource) = i;
+        list->dsv_resource_tracking[i].plane_optimal_mask |= plane_optimal_mask;
+        return list->dsv_resource_tracking[i].plane_optimal_mask;
     }
 
     vkd3d_array_reserve((void **)&list->dsv_resource_tracking, &list->dsv_resource_tracking_size,
             list->dsv_resource_tracking_count + 1, sizeof(*list->dsv_resource_tracking));
+    *d3d12_command_list_get_dsv_tracking_hint(list, resource) = list->dsv_resource_tracking_count;
     list->dsv_resource_tracking[list->dsv_resource_tracking_count].resource = resource;
     list->dsv_resource_tracking[list->dsv_resource_tracking_count].plane_optimal_mask = plane_optimal_mask;
     list->dsv_resource_tracking_count++;
@@ -3117,7 +3984,7 @@ static void d3d12_command_list_decay_optimal_dsv_resources(struct d3d12_command_
 static VkImageLayout d3d12_command_list_get_depth_stencil_resource_layout(const struct d3d12_command_list *list,
         const struct d3d12_resource *resource, uint32_t *plane_optimal_mask)
 {
-    size_t i, n;
+    size_t i;
 
     if (resource->desc.Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE)
     {
@@ -3132,15 +3999,12 @@ static VkImageLayout d3d12_command_list_get_depth_stencil_resource_layout(const
         return VK_IMAGE_LAYOUT_GENERAL;
     }
 
-    for (i = 0, n = list->dsv_resource_tracking_count; i < n; i++)
+    if (d3d12_command_list_find_dsv_tracking(list, resource, &i))
     {
-        if (resource == list->dsv_resource_tracking[i].resource)
-        {
-            if (plane_optimal_mask)
-                *plane_optimal_mask = list->dsv_resource_tracking[i].plane_optimal_mask;
-            return dsv_plane_optimal_mask_to_layout(list->dsv_resource_tracking[i].plane_optimal_mask,
-                    resource->format->vk_aspect_mask);
-        }
+        if (plane_optimal_mask)
+            *plane_optimal_mask = list->dsv_resource_tracking[i].plane_optimal_mask;
+        return dsv_plane_optimal_mask_to_layout(list->dsv_resource_tracking[i].plane_optimal_mask,
+                resource->format->vk_aspect_mask);
     }
 
     if (plane_optimal_mask)
@@ -3189,6 +4053,35 @@ static bool d3d12_resource_may_alias_other_resources(struct d3d12_resource *reso
     return true;
 }
 
+static bool d3d12_resource_heap_range_is_exact(struct d3d12_resource *resource)
+{
+    return resource->heap && resource->heap_range.registered &&
+            !vkd3d_atomic_uint32_load_explicit(&resource->heap->has_tile_mappings, vkd3d_memory_order_relaxed);
+}
+
+/* Unlike d3d12_resource_may_alias_other_resources(), which only tells whether a resource is placed
+ * and thus needs explicit initialization, this consults the heap index to tell whether two
+ * resources (NULL meaning any resource) can actually share memory right now. */
+static bool d3d12_resource_may_alias(struct d3d12_resource *a, struct d3d12_resource *b)
+{
+    if (!d3d12_resource_may_alias_other_resources(a) || !d3d12_resource_may_alias_other_resources(b))
+        return false;
+
+    if (a && b && d3d12_resource_heap_range_is_exact(a) && d3d12_resource_heap_range_is_exact(b))
+    {
+        return a->heap == b->heap &&
+                a->heap_range.offset < b->heap_range.offset + b->heap_range.size &&
+                b->heap_range.offset < a->heap_range.offset + a->heap_range.size;
+    }
+
+    if (a && !b && d3d12_resource_heap_range_is_exact(a))
+        return vkd3d_atomic_uint32_load_explicit(&a->heap_range.alias_count, vkd3d_memory_order_relaxed) != 0;
+    if (b && !a && d3d12_resource_heap_range_is_exact(b))
+        return vkd3d_atomic_uint32_load_explicit(&b->heap_range.alias_count, vkd3d_memory_order_relaxed) != 0;
+
+    return true;
+}
+
 static void d3d12_command_list_debug_mark_begin_region(
         struct d3d12_command_list *list, const char *tag)
 {
@@ -3215,6 +4108,20 @@ static void d3d12_command_list_debug_mark_end_region(struct d3d12_command_list *
         VK_CALL(vkCmdEndDebugUtilsLabelEXT(list->vk_command_buffer));
 }
 
+static bool d3d12_command_list_render_pass_is_idle(const struct d3d12_command_list *list, bool suspend)
+{
+    uint32_t state_flags = VKD3D_RENDERING_ACTIVE;
+
+    /* Ending a suspended render pass for real emits the end-of-pass transitions. */
+    if (!suspend)
+        state_flags |= VKD3D_RENDERING_SUSPENDED;
+
+    /* Ending the render pass would not record any commands besides pending barriers and clears. */
+    return !(list->rendering_info.state_flags & state_flags) &&
+            !list->xfb_enabled && !list->active_queries_count &&
+            !list->query_resolve_count && !list->wbi_batch.batch_len;
+}
+
 static void d3d12_command_list_clear_attachment_pass(struct d3d12_command_list *list, struct d3d12_resource *resource,
         struct vkd3d_view *view, VkImageAspectFlags clear_aspects, const VkClearValue *clear_value, UINT rect_count,
         const D3D12_RECT *rects, bool is_bound)
@@ -3433,7 +4340,94 @@ static void d3d12_command_list_clear_attachment_pass(struct d3d12_command_list *
     VKD3D_BREADCRUMB_RESOURCE(resource);
     VKD3D_BREADCRUMB_COMMAND(CLEAR_PASS);
 
-    d3d12_command_list_debug_mark_end_region(list);
+    d3d12_command_list_debug_mark_end_region(list);
+}
+
+static bool d3d12_command_list_defer_clear_attachment(struct d3d12_command_list *list,
+        struct d3d12_resource *resource, const struct vkd3d_view *view, VkImageAspectFlags clear_aspects,
+        const VkClearValue *clear_value, UINT rect_count)
+{
+    unsigned int i;
+
+    /* A full clear of a bound render target can become the loadOp of the next render pass.
+     * Aliased resources need a discard barrier and staging copies need an update, so leave those alone. */
+    if (rect_count || clear_aspects != VK_IMAGE_ASPECT_COLOR_BIT ||
+            !d3d12_command_list_render_pass_is_idle(list, false) ||
+            resource->desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ||
+            (resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY) ||
+            d3d12_resource_may_alias_other_resources(resource))
+        return false;
+
+    for (i = 0; i < ARRAY_SIZE(list->rtvs); i++)
+    {
+        if (list->rtvs[i].view == view)
+        {
+            list->rendering_info.rtv[i].clearValue = *clear_value;
+            list->rendering_info.clear_rtv_mask |= 1u << i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void d3d12_command_list_flush_pending_clears(struct d3d12_command_list *list)
+{
+    struct vkd3d_rendering_info *rendering_info = &list->rendering_info;
+    uint32_t clear_mask = rendering_info->clear_rtv_mask;
+    unsigned int i;
+
+    if (!clear_mask)
+        return;
+
+    /* Barriers deferred before the clears must land first. */
+    d3d12_command_list_flush_deferred_barriers(list);
+    rendering_info->clear_rtv_mask = 0;
+
+    while (clear_mask)
+    {
+        i = vkd3d_bitmask_iter32(&clear_mask);
+        d3d12_command_list_clear_attachment_pass(list, list->rtvs[i].resource, list->rtvs[i].view,
+                VK_IMAGE_ASPECT_COLOR_BIT, &rendering_info->rtv[i].clearValue, 0, NULL, false);
+    }
+}
+
+/* Turns pending clears into loadOp = CLEAR where the render pass covers the entire view,
+ * and returns the mask of attachments which need their loadOp restored afterwards. */
+static uint32_t d3d12_command_list_resolve_pending_clears(struct d3d12_command_list *list)
+{
+    struct vkd3d_rendering_info *rendering_info = &list->rendering_info;
+    uint32_t clear_mask = rendering_info->clear_rtv_mask;
+    const struct d3d12_rtv_desc *rtv;
+    uint32_t load_op_mask = 0;
+    unsigned int i;
+
+    rendering_info->clear_rtv_mask = 0;
+
+    while (clear_mask)
+    {
+        i = vkd3d_bitmask_iter32(&clear_mask);
+        rtv = &list->rtvs[i];
+
+        if ((rendering_info->rtv_mask & (1u << i)) &&
+                rendering_info->rtv[i].imageView == rtv->view->vk_image_view &&
+                rendering_info->info.renderArea.extent.width ==
+                        d3d12_resource_desc_get_width(&rtv->resource->desc, rtv->view->info.texture.miplevel_idx) &&
+                rendering_info->info.renderArea.extent.height ==
+                        d3d12_resource_desc_get_height(&rtv->resource->desc, rtv->view->info.texture.miplevel_idx) &&
+                rendering_info->info.layerCount == rtv->view->info.texture.layer_count)
+        {
+            rendering_info->rtv[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            load_op_mask |= 1u << i;
+        }
+        else
+        {
+            d3d12_command_list_clear_attachment_pass(list, rtv->resource, rtv->view,
+                    VK_IMAGE_ASPECT_COLOR_BIT, &rendering_info->rtv[i].clearValue, 0, NULL, false);
+        }
+    }
+
+    return load_op_mask;
 }
 
 static VkPipelineStageFlags2 vk_queue_shader_stages(VkQueueFlags vk_queue_flags)
@@ -3696,6 +4690,8 @@ static void d3d12_command_list_flush_subresource_updates(struct d3d12_command_li
     if (!list->subresource_tracking_count)
         return;
 
+    d3d12_command_list_flush_deferred_barriers(list);
+
     /* Images may not be in COMMON state anymore by the time the subresource
      * updates get resolved, however we should still perform the update. Emit
      * a full barrier to reduce the amount of tracking needed. */
@@ -3997,9 +4993,189 @@ static size_t get_query_heap_stride(D3D12_QUERY_HEAP_TYPE heap_type)
     return sizeof(uint64_t);
 }
 
+static bool d3d12_command_list_write_meta_timestamp(struct d3d12_command_list *list,
+        VkCommandBuffer vk_command_buffer, struct vkd3d_meta_timing_scope *scope)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+
+    if (!d3d12_command_allocator_allocate_query_from_type_index(list->allocator,
+            VKD3D_QUERY_TYPE_INDEX_TIMESTAMP, &scope->vk_query_pool, &scope->query_index))
+        return false;
+
+    if (!d3d12_command_list_reset_query(list, scope->vk_query_pool, scope->query_index))
+        return false;
+
+    VK_CALL(vkCmdWriteTimestamp2(vk_command_buffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            scope->vk_query_pool, scope->query_index));
+    return true;
+}
+
+static inline void d3d12_command_list_count_stat(struct d3d12_command_list *list,
+        enum vkd3d_command_list_stat stat)
+{
+    list->stats.counts[stat]++;
+}
+
+static void d3d12_command_list_begin_meta_timing(struct d3d12_command_list *list,
+        VkCommandBuffer vk_command_buffer, struct vkd3d_meta_timing_scope *scope)
+{
+    scope->vk_query_pool = VK_NULL_HANDLE;
+
+    /* Timestamps inside a render pass would have to account for multiview, so don't bother. */
+    if (!list->allocator || !list->allocator->meta_timing ||
+            (list->rendering_info.state_flags & VKD3D_RENDERING_ACTIVE))
+        return;
+
+    if (!d3d12_command_list_write_meta_timestamp(list, vk_command_buffer, scope))
+        scope->vk_query_pool = VK_NULL_HANDLE;
+}
+
+static void d3d12_command_list_end_meta_timing(struct d3d12_command_list *list,
+        VkCommandBuffer vk_command_buffer, const struct vkd3d_meta_timing_scope *scope,
+        enum vkd3d_meta_timing_category category)
+{
+    struct d3d12_command_allocator *allocator = list->allocator;
+    struct vkd3d_meta_timing_record *record;
+    struct vkd3d_meta_timing_scope end;
+
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_META_OPERATION);
+
+    if (!scope->vk_query_pool || (list->rendering_info.state_flags & VKD3D_RENDERING_ACTIVE))
+        return;
+
+    if (!d3d12_command_list_write_meta_timestamp(list, vk_command_buffer, &end))
+        return;
+
+    if (!vkd3d_array_reserve((void **)&allocator->meta_timings, &allocator->meta_timings_size,
+            allocator->meta_timing_count + 1, sizeof(*allocator->meta_timings)))
+    {
+        ERR("Failed to allocate meta timing record.\n");
+        return;
+    }
+
+    record = &allocator->meta_timings[allocator->meta_timing_count++];
+    record->begin = *scope;
+    record->end = end;
+    record->category = category;
+}
+
 static void d3d12_command_list_invalidate_root_parameters(struct d3d12_command_list *list,
         struct vkd3d_pipeline_bindings *bindings, bool invalidate_descriptor_heaps);
 
+static void d3d12_command_list_copy_direct_pending_queries(struct d3d12_command_list *list)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct vkd3d_direct_query_range
+    {
+        VkQueryPool vk_pool;
+        uint32_t vk_index;
+        uint32_t index;
+        uint32_t count;
+    } ranges[VKD3D_QUERY_MAX_DIRECT_COPY_RANGES], *r;
+    struct vkd3d_active_query *queries = list->pending_queries;
+    size_t begin, end, i, j, keep_count = 0;
+    const struct vkd3d_active_query *q;
+    unsigned int range_count;
+    struct d3d12_query_heap *heap;
+    bool has_copies = false;
+    VkMemoryBarrier2 vk_barrier;
+    VkDeviceSize stride;
+    VkDependencyInfo dep_info;
+    bool eligible;
+
+    memset(&vk_barrier, 0, sizeof(vk_barrier));
+    vk_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.memoryBarrierCount = 1;
+    dep_info.pMemoryBarriers = &vk_barrier;
+
+    /* Pending queries are sorted by heap. SO statistics which were not split across
+     * multiple Vulkan queries need no accumulation, and their layout matches D3D12,
+     * so copy them straight into the heap instead of going through a gather dispatch. */
+    for (begin = 0; begin < list->pending_queries_count; begin = end)
+    {
+        heap = queries[begin].heap;
+
+        for (end = begin + 1; end < list->pending_queries_count && queries[end].heap == heap; end++)
+            continue;
+
+        eligible = heap->desc.Type == D3D12_QUERY_HEAP_TYPE_SO_STATISTICS;
+        range_count = 0;
+
+        for (i = begin; eligible && i < end; i++)
+        {
+            q = &queries[i];
+            r = range_count ? &ranges[range_count - 1] : NULL;
+
+            if (r && r->vk_pool == q->vk_pool && r->vk_index + r->count == q->vk_index &&
+                    r->index + r->count == q->index)
+            {
+                r->count++;
+            }
+            else if (range_count < ARRAY_SIZE(ranges))
+            {
+                r = &ranges[range_count++];
+                r->vk_pool = q->vk_pool;
+                r->vk_index = q->vk_index;
+                r->index = q->index;
+                r->count = 1;
+            }
+            else
+                eligible = false;
+        }
+
+        /* Any D3D12 query which appears more than once needs to be accumulated. */
+        for (i = 0; eligible && i < range_count; i++)
+        {
+            for (j = i + 1; eligible && j < range_count; j++)
+            {
+                if (ranges[i].index < ranges[j].index + ranges[j].count &&
+                        ranges[j].index < ranges[i].index + ranges[i].count)
+                    eligible = false;
+            }
+        }
+
+        if (!eligible)
+        {
+            for (i = begin; i < end; i++)
+                queries[keep_count++] = queries[i];
+            continue;
+        }
+
+        if (!has_copies)
+        {
+            /* Order against previous resolves reading the heap buffer. */
+            vk_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+            vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+            has_copies = true;
+        }
+
+        stride = get_query_heap_stride(heap->desc.Type);
+
+        for (i = 0; i < range_count; i++)
+        {
+            VK_CALL(vkCmdCopyQueryPoolResults(list->vk_command_buffer,
+                    ranges[i].vk_pool, ranges[i].vk_index, ranges[i].count,
+                    heap->vk_buffer, ranges[i].index * stride,
+                    stride, VK_QUERY_RESULT_WAIT_BIT | VK_QUERY_RESULT_64_BIT));
+        }
+    }
+
+    list->pending_queries_count = keep_count;
+
+    if (has_copies)
+    {
+        vk_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        vk_barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_COPY_BIT;
+        vk_barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT;
+        VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+    }
+}
+
 static bool d3d12_command_list_gather_pending_queries(struct d3d12_command_list *list)
 {
     /* TODO allocate arrays from command allocator in case
@@ -4009,6 +5185,7 @@ static bool d3d12_command_list_gather_pending_queries(struct d3d12_command_list
     struct vkd3d_scratch_allocation resolve_buffer, entry_buffer;
     struct vkd3d_query_gather_info gather_pipeline;
     const struct vkd3d_active_query *src_queries;
+    struct vkd3d_meta_timing_scope timing_scope;
     unsigned int i, j, k, workgroup_count;
     uint32_t resolve_index, entry_offset;
     struct vkd3d_query_gather_args args;
@@ -4065,10 +5242,20 @@ static bool d3d12_command_list_gather_pending_queries(struct d3d12_command_list
     if (!list->pending_queries_count)
         return true;
 
+    d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
+
     /* Sort pending query list so that we can batch commands */
     qsort(list->pending_queries, list->pending_queries_count,
             sizeof(*list->pending_queries), &vkd3d_compare_pending_query);
 
+    d3d12_command_list_copy_direct_pending_queries(list);
+
+    if (!list->pending_queries_count)
+    {
+        result = true;
+        goto cleanup;
+    }
+
     ssbo_alignment = d3d12_device_get_ssbo_alignment(list->device);
     resolve_buffer_size = 0;
     resolve_buffer_stride = 0;
@@ -4293,6 +5480,7 @@ static bool d3d12_command_list_gather_pending_queries(struct d3d12_command_list
     VKD3D_BREADCRUMB_COMMAND(GATHER_VIRTUAL_QUERY);
 
 cleanup:
+    d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_QUERY_RESOLVE);
     vkd3d_free(resolves);
     vkd3d_free(dispatches);
     vkd3d_free(query_list);
@@ -4306,6 +5494,10 @@ static void d3d12_command_list_end_current_render_pass(struct d3d12_command_list
     VkMemoryBarrier2 vk_barrier;
     VkDependencyInfo dep_info;
 
+    /* Anything recorded outside a render pass may depend on pending barriers and clears. */
+    d3d12_command_list_flush_deferred_barriers(list);
+    d3d12_command_list_flush_pending_clears(list);
+
     d3d12_command_list_handle_active_queries(list, true);
 
     if (list->xfb_enabled)
@@ -4318,6 +5510,8 @@ static void d3d12_command_list_end_current_render_pass(struct d3d12_command_list
     {
         VK_CALL(vkCmdEndRendering(list->vk_command_buffer));
         d3d12_command_list_debug_mark_end_region(list);
+        d3d12_command_list_count_stat(list, suspend
+                ? VKD3D_COMMAND_LIST_STAT_RENDER_PASS_SUSPEND : VKD3D_COMMAND_LIST_STAT_RENDER_PASS_END);
     }
 
     /* Don't emit barriers for temporary suspension of the render pass */
@@ -4360,15 +5554,19 @@ static void d3d12_command_list_invalidate_push_constants(struct vkd3d_pipeline_b
     if (bindings->root_signature->descriptor_table_count)
         bindings->dirty_flags |= VKD3D_PIPELINE_DIRTY_DESCRIPTOR_TABLE_OFFSETS;
 
+    bindings->descriptor_table_dirty_mask = bindings->root_signature->descriptor_table_mask;
     bindings->root_descriptor_dirty_mask =
             bindings->root_signature->root_descriptor_raw_va_mask |
             bindings->root_signature->root_descriptor_push_mask;
     bindings->root_constant_dirty_mask = bindings->root_signature->root_constant_mask;
+    bindings->root_constant_word_dirty_mask = ~0ull;
 }
 
 static void d3d12_command_list_invalidate_root_parameters(struct d3d12_command_list *list,
         struct vkd3d_pipeline_bindings *bindings, bool invalidate_descriptor_heaps)
 {
+    bindings->hoisted_descriptor_valid_mask = 0;
+
     if (!bindings->root_signature)
         return;
 
@@ -4608,6 +5806,10 @@ static void d3d12_command_list_track_resource_usage(struct d3d12_command_list *l
 {
     struct vkd3d_initial_transition transition;
 
+    /* Commands which reference the image are recorded right after this. */
+    if (resource->flags & VKD3D_RESOURCE_DEFERRED_BIND)
+        vkd3d_memory_bind_queue_flush_if_pending(&list->device->memory_binds, list->device);
+
     /* When a command queue has confirmed that it has received a command list for submission, this flag will eventually
      * be cleared. The command queue will only perform the transition once.
      * Until that point, we must keep submitting initial transitions like this. */
@@ -4633,7 +5835,7 @@ static void d3d12_command_list_track_query_heap(struct d3d12_command_list *list,
     }
 }
 
-extern ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_AddRef(ID3D12GraphicsCommandListExt *iface);
+extern ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_AddRef(ID3D12GraphicsCommandListExt1 *iface);
 
 HRESULT STDMETHODCALLTYPE d3d12_command_list_QueryInterface(d3d12_command_list_iface *iface,
         REFIID iid, void **object)
@@ -4660,7 +5862,8 @@ HRESULT STDMETHODCALLTYPE d3d12_command_list_QueryInterface(d3d12_command_list_i
         return S_OK;
     }
 
-    if (IsEqualGUID(iid, &IID_ID3D12GraphicsCommandListExt))
+    if (IsEqualGUID(iid, &IID_ID3D12GraphicsCommandListExt)
+            || IsEqualGUID(iid, &IID_ID3D12GraphicsCommandListExt1))
     {
         struct d3d12_command_list *command_list = impl_from_ID3D12GraphicsCommandList(iface);
         d3d12_command_list_vkd3d_ext_AddRef(&command_list->ID3D12GraphicsCommandListExt_iface);
@@ -4708,6 +5911,12 @@ ULONG STDMETHODCALLTYPE d3d12_command_list_Release(d3d12_command_list_iface *ifa
         vkd3d_free(list->dsv_resource_tracking);
         vkd3d_free(list->subresource_tracking);
         vkd3d_free(list->query_resolves);
+        vkd3d_free(list->transfer_batch.batch);
+        d3d12_command_list_discard_rtas_batch(list);
+        vkd3d_free(list->rtas_batch.build_infos);
+        if (list->rtas_batch.arena)
+            vkd3d_acceleration_structure_build_arena_cleanup(list->rtas_batch.arena);
+        vkd3d_free(list->rtas_batch.arena);
         hash_map_free(&list->query_resolve_lut);
 
         vkd3d_free_aligned(list);
@@ -5087,6 +6296,7 @@ static void d3d12_command_list_reset_api_state(struct d3d12_command_list *list,
     /* Initial state is considered unbound render targets.
      * Also need to mark rendering_info as dirty. */
     list->rendering_info.state_flags = 0;
+    list->rendering_info.clear_rtv_mask = 0;
     list->fb_width = limits->maxFramebufferWidth;
     list->fb_height = limits->maxFramebufferHeight;
     list->fb_layer_count = limits->maxFramebufferLayers;
@@ -5095,11 +6305,14 @@ static void d3d12_command_list_reset_api_state(struct d3d12_command_list *list,
 
     list->predicate_enabled = false;
     list->predicate_va = 0;
+    list->predicate_vk_buffer = VK_NULL_HANDLE;
+    list->predicate_vk_offset = 0;
 
     list->index_buffer.buffer = VK_NULL_HANDLE;
 
     list->current_pipeline = VK_NULL_HANDLE;
     list->command_buffer_pipeline = VK_NULL_HANDLE;
+    memset(&list->fallback_pipeline_cache, 0, sizeof(list->fallback_pipeline_cache));
 
     memset(&list->dynamic_state, 0, sizeof(list->dynamic_state));
     list->dynamic_state.blend_constants[0] = D3D12_DEFAULT_BLEND_FACTOR_RED;
@@ -5146,6 +6359,8 @@ static void d3d12_command_list_reset_internal_state(struct d3d12_command_list *l
 #endif
     list->has_replaced_shaders = false;
 
+    memset(&list->stats, 0, sizeof(list->stats));
+
     list->init_transitions_count = 0;
     list->query_ranges_count = 0;
     list->active_queries_count = 0;
@@ -5154,7 +6369,9 @@ static void d3d12_command_list_reset_internal_state(struct d3d12_command_list *l
     list->subresource_tracking_count = 0;
     list->tracked_copy_buffer_count = 0;
     list->wbi_batch.batch_len = 0;
+    d3d12_command_list_discard_rtas_batch(list);
     list->query_resolve_count = 0;
+    d3d12_command_list_barrier_batch_init(&list->deferred_barriers);
 
     list->execute_indirect.has_emitted_indirect_to_compute_barrier = false;
     list->execute_indirect.has_emitted_indirect_to_compute_cbv_barrier = false;
@@ -5323,11 +6540,16 @@ static bool d3d12_command_list_update_rendering_info(struct d3d12_command_list *
     return true;
 }
 
-static bool d3d12_command_list_update_compute_pipeline(struct d3d12_command_list *list)
+static bool d3d12_command_list_update_compute_pipeline(struct d3d12_command_list *list, bool allow_specialization)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    bool is_specialized;
+    VkPipeline vk_pipeline;
 
-    if (list->current_pipeline != VK_NULL_HANDLE)
+    /* PSOs with root constant specialization may switch variants between dispatches. */
+    is_specialized = d3d12_pipeline_state_is_compute(list->state) && list->state->compute.specialization;
+
+    if (list->current_pipeline != VK_NULL_HANDLE && !is_specialized)
         return true;
 
     if (!d3d12_pipeline_state_is_compute(list->state))
@@ -5336,14 +6558,26 @@ static bool d3d12_command_list_update_compute_pipeline(struct d3d12_command_list
         return false;
     }
 
-    if (list->command_buffer_pipeline != list->state->compute.vk_pipeline)
+    /* Indirect commands may rewrite root constants on the GPU, so they always use the generic pipeline. */
+    if (is_specialized && allow_specialization)
+    {
+        vk_pipeline = d3d12_pipeline_state_select_compute_pipeline(list->state,
+                list->compute_bindings.root_constants);
+    }
+    else
+        vk_pipeline = list->state->compute.vk_pipeline;
+
+    if (list->current_pipeline == vk_pipeline)
+        return true;
+
+    if (list->command_buffer_pipeline != vk_pipeline)
     {
         VK_CALL(vkCmdBindPipeline(list->vk_command_buffer,
                 vk_bind_point_from_pipeline_type(list->state->pipeline_type),
-                list->state->compute.vk_pipeline));
-        list->command_buffer_pipeline = list->state->compute.vk_pipeline;
+                vk_pipeline));
+        list->command_buffer_pipeline = vk_pipeline;
     }
-    list->current_pipeline = list->state->compute.vk_pipeline;
+    list->current_pipeline = vk_pipeline;
     list->dynamic_state.active_flags = 0;
 
     return true;
@@ -5406,6 +6640,32 @@ static void d3d12_command_list_check_vbo_alignment(struct d3d12_command_list *li
     }
 }
 
+static VkPipeline d3d12_command_list_get_fallback_pipeline(struct d3d12_command_list *list,
+        uint32_t *dynamic_state_flags)
+{
+    struct vkd3d_pipeline_key pipeline_key;
+    VkPipeline vk_pipeline;
+
+    d3d12_pipeline_state_init_pipeline_key(list->state, &list->dynamic_state, list->dsv.format, &pipeline_key);
+
+    if (list->fallback_pipeline_cache.state == list->state &&
+            !memcmp(&list->fallback_pipeline_cache.key, &pipeline_key, sizeof(pipeline_key)))
+    {
+        *dynamic_state_flags = list->fallback_pipeline_cache.dynamic_state_flags;
+        return list->fallback_pipeline_cache.vk_pipeline;
+    }
+
+    if (!(vk_pipeline = d3d12_pipeline_state_get_or_create_pipeline(list->state,
+            &pipeline_key, list->dsv.format, dynamic_state_flags)))
+        return VK_NULL_HANDLE;
+
+    list->fallback_pipeline_cache.state = list->state;
+    list->fallback_pipeline_cache.key = pipeline_key;
+    list->fallback_pipeline_cache.vk_pipeline = vk_pipeline;
+    list->fallback_pipeline_cache.dynamic_state_flags = *dynamic_state_flags;
+    return vk_pipeline;
+}
+
 static bool d3d12_command_list_update_graphics_pipeline(struct d3d12_command_list *list,
         enum vkd3d_pipeline_type pipeline_type)
 {
@@ -5435,8 +6695,7 @@ static bool d3d12_command_list_update_graphics_pipeline(struct d3d12_command_lis
     if (!(vk_pipeline = d3d12_pipeline_state_get_pipeline(list->state,
             &list->dynamic_state, list->dsv.format, &new_active_flags)))
     {
-        if (!(vk_pipeline = d3d12_pipeline_state_get_or_create_pipeline(list->state,
-                &list->dynamic_state, list->dsv.format, &new_active_flags)))
+        if (!(vk_pipeline = d3d12_command_list_get_fallback_pipeline(list, &new_active_flags)))
             return false;
     }
 
@@ -5500,32 +6759,45 @@ static void d3d12_command_list_update_descriptor_table_offsets(struct d3d12_comm
         struct vkd3d_pipeline_bindings *bindings, VkPipelineLayout layout, VkShaderStageFlags push_stages)
 {
     const struct d3d12_root_signature *root_signature = bindings->root_signature;
+    const struct vkd3d_root_binding_program *program = &root_signature->binding_program;
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
-    const struct vkd3d_shader_descriptor_table *table;
+    const struct vkd3d_root_binding_table_op *op;
     uint32_t table_offsets[D3D12_MAX_ROOT_COST];
-    unsigned int root_parameter_index;
-    uint64_t descriptor_table_mask;
+    struct vkd3d_bitmask_range range;
+    uint64_t table_index_mask;
+    uint64_t update_mask;
+    unsigned int i;
 
     assert(root_signature->descriptor_table_count);
-    descriptor_table_mask = root_signature->descriptor_table_mask & bindings->descriptor_table_active_mask;
+    update_mask = bindings->descriptor_table_active_mask & bindings->descriptor_table_dirty_mask;
+    table_index_mask = 0;
 
-    while (descriptor_table_mask)
+    for (i = 0; i < program->table_op_count; i++)
     {
-        root_parameter_index = vkd3d_bitmask_iter64(&descriptor_table_mask);
-        table = root_signature_get_descriptor_table(root_signature, root_parameter_index);
-        table_offsets[table->table_index] = bindings->descriptor_tables[root_parameter_index];
+        op = &program->table_ops[i];
+        if (update_mask & (1ull << op->parameter_index))
+        {
+            table_offsets[op->table_index] = bindings->descriptor_tables[op->parameter_index];
+            table_index_mask |= 1ull << op->table_index;
+        }
     }
 
-    /* Set descriptor offsets */
+    /* Set descriptor offsets. Only push the runs of tables which changed,
+     * push constant state is invalidated wholesale on root signature or layout changes. */
     if (push_stages)
     {
-        VK_CALL(vkCmdPushConstants(list->vk_command_buffer,
-                layout, push_stages,
-                root_signature->descriptor_table_offset,
-                root_signature->descriptor_table_count * sizeof(uint32_t),
-                table_offsets));
+        while (table_index_mask)
+        {
+            range = vkd3d_bitmask_iter64_range(&table_index_mask);
+            VK_CALL(vkCmdPushConstants(list->vk_command_buffer,
+                    layout, push_stages,
+                    root_signature->descriptor_table_offset + range.offset * sizeof(uint32_t),
+                    range.count * sizeof(uint32_t),
+                    &table_offsets[range.offset]));
+        }
     }
 
+    bindings->descriptor_table_dirty_mask = 0;
     bindings->dirty_flags &= ~VKD3D_PIPELINE_DIRTY_DESCRIPTOR_TABLE_OFFSETS;
 }
 
@@ -5596,6 +6868,7 @@ static void d3d12_command_list_update_descriptor_buffers(struct d3d12_command_li
 
         VK_CALL(vkCmdBindDescriptorBuffersEXT(list->vk_command_buffer,
                 ARRAY_SIZE(global_buffers), global_buffers));
+        d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DESCRIPTOR_BUFFER_BIND);
 
         list->descriptor_heap.buffers.heap_dirty = false;
     }
@@ -5664,32 +6937,44 @@ static void d3d12_command_list_update_static_samplers(struct d3d12_command_list
     bindings->dirty_flags &= ~VKD3D_PIPELINE_DIRTY_STATIC_SAMPLER_SET;
 }
 
+static inline uint64_t vkd3d_root_constant_word_mask(unsigned int first_word, unsigned int word_count)
+{
+    if (!word_count)
+        return 0;
+    return (~0ull >> (64 - word_count)) << first_word;
+}
+
 static void d3d12_command_list_update_root_constants(struct d3d12_command_list *list,
         struct vkd3d_pipeline_bindings *bindings,
         VkPipelineLayout layout, VkShaderStageFlags push_stages)
 {
     const struct d3d12_root_signature *root_signature = bindings->root_signature;
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
-    const struct vkd3d_shader_root_constant *root_constant;
-    unsigned int root_parameter_index;
+    struct vkd3d_bitmask_range range;
+    uint64_t word_mask;
 
     if (!push_stages)
     {
         bindings->root_constant_dirty_mask = 0;
+        bindings->root_constant_word_dirty_mask = 0;
         return;
     }
 
-    while (bindings->root_constant_dirty_mask)
-    {
-        root_parameter_index = vkd3d_bitmask_iter64(&bindings->root_constant_dirty_mask);
-        root_constant = root_signature_get_32bit_constants(root_signature, root_parameter_index);
+    /* Only push the words which were written since the last push. */
+    word_mask = bindings->root_constant_word_dirty_mask & root_signature->binding_program.root_constant_word_mask;
 
+    while (word_mask)
+    {
+        range = vkd3d_bitmask_iter64_range(&word_mask);
         VK_CALL(vkCmdPushConstants(list->vk_command_buffer,
                 layout, push_stages,
-                root_constant->constant_index * sizeof(uint32_t),
-                root_constant->constant_count * sizeof(uint32_t),
-                &bindings->root_constants[root_constant->constant_index]));
+                range.offset * sizeof(uint32_t),
+                range.count * sizeof(uint32_t),
+                &bindings->root_constants[range.offset]));
     }
+
+    bindings->root_constant_dirty_mask = 0;
+    bindings->root_constant_word_dirty_mask = 0;
 }
 
 union root_parameter_data
@@ -5701,55 +6986,50 @@ union root_parameter_data
 static unsigned int d3d12_command_list_fetch_root_descriptor_vas(struct d3d12_command_list *list,
         struct vkd3d_pipeline_bindings *bindings, union root_parameter_data *dst_data)
 {
-    const struct d3d12_root_signature *root_signature = bindings->root_signature;
-    uint64_t root_descriptor_mask = root_signature->root_descriptor_raw_va_mask;
-    unsigned int va_idx = 0;
+    const struct vkd3d_root_binding_program *program = &bindings->root_signature->binding_program;
+    unsigned int i;
 
     /* Ignore dirty mask. We'll always update all VAs either via push constants
      * in order to reduce API calls, or an inline uniform buffer in which case
      * we need to re-upload all data anyway. */
-    while (root_descriptor_mask)
+    for (i = 0; i < program->root_descriptor_va_count; i++)
     {
-        unsigned int root_parameter_index = vkd3d_bitmask_iter64(&root_descriptor_mask);
-        dst_data->root_descriptor_vas[va_idx++] = bindings->root_descriptors[root_parameter_index].info.va;
+        dst_data->root_descriptor_vas[i] =
+                bindings->root_descriptors[program->root_descriptor_va_parameters[i]].info.va;
     }
 
-    return va_idx;
+    return program->root_descriptor_va_count;
 }
 
 static void d3d12_command_list_fetch_root_parameter_uniform_block_data(struct d3d12_command_list *list,
         struct vkd3d_pipeline_bindings *bindings, union root_parameter_data *dst_data)
 {
     const struct d3d12_root_signature *root_signature = bindings->root_signature;
-    uint64_t root_constant_mask = root_signature->root_constant_mask;
-    const struct vkd3d_shader_root_constant *root_constant;
+    const struct vkd3d_root_binding_program *program = &root_signature->binding_program;
+    uint64_t descriptor_table_active_mask = bindings->descriptor_table_active_mask;
+    const struct vkd3d_root_binding_constant_op *constant_op;
+    const struct vkd3d_root_binding_table_op *table_op;
     const uint32_t *src_data = bindings->root_constants;
-    const struct vkd3d_shader_descriptor_table *table;
-    unsigned int root_parameter_index;
-    uint64_t descriptor_table_mask;
-    uint32_t first_table_offset;
+    uint32_t *dst_tables;
+    unsigned int i;
 
     /* Root descriptors are already filled in dst_data. */
 
-    while (root_constant_mask)
+    for (i = 0; i < program->constant_op_count; i++)
     {
-        root_parameter_index = vkd3d_bitmask_iter64(&root_constant_mask);
-        root_constant = root_signature_get_32bit_constants(root_signature, root_parameter_index);
-
-        memcpy(&dst_data->root_constants[root_constant->constant_index],
-                &src_data[root_constant->constant_index],
-                root_constant->constant_count * sizeof(uint32_t));
+        constant_op = &program->constant_ops[i];
+        memcpy(&dst_data->root_constants[constant_op->word_offset],
+                &src_data[constant_op->word_offset],
+                constant_op->word_count * sizeof(uint32_t));
     }
 
-    first_table_offset = root_signature->descriptor_table_offset / sizeof(uint32_t);
-    descriptor_table_mask = root_signature->descriptor_table_mask & bindings->descriptor_table_active_mask;
+    dst_tables = &dst_data->root_constants[root_signature->descriptor_table_offset / sizeof(uint32_t)];
 
-    while (descriptor_table_mask)
+    for (i = 0; i < program->table_op_count; i++)
     {
-        root_parameter_index = vkd3d_bitmask_iter64(&descriptor_table_mask);
-        table = root_signature_get_descriptor_table(root_signature, root_parameter_index);
-        dst_data->root_constants[first_table_offset + table->table_index] =
-                bindings->descriptor_tables[root_parameter_index];
+        table_op = &program->table_ops[i];
+        if (descriptor_table_active_mask & (1ull << table_op->parameter_index))
+            dst_tables[table_op->table_index] = bindings->descriptor_tables[table_op->parameter_index];
     }
 }
 
@@ -5826,7 +7106,9 @@ static void d3d12_command_list_update_root_descriptors(struct d3d12_command_list
         /* Reset dirty flags to avoid redundant updates in the future.
          * We consume all constants / tables here regardless of dirty state. */
         bindings->dirty_flags &= ~VKD3D_PIPELINE_DIRTY_DESCRIPTOR_TABLE_OFFSETS;
+        bindings->descriptor_table_dirty_mask = 0;
         bindings->root_constant_dirty_mask = 0;
+        bindings->root_constant_word_dirty_mask = 0;
 
         vk_write_descriptor_set_from_scratch_push_ubo(&descriptor_writes[descriptor_write_count],
                 &buffer_info, &alloc, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT,
@@ -5850,55 +7132,40 @@ static void d3d12_command_list_update_root_descriptors(struct d3d12_command_list
     }
 }
 
-static void d3d12_command_list_update_hoisted_descriptors(struct d3d12_command_list *list,
-        struct vkd3d_pipeline_bindings *bindings)
+static void d3d12_command_list_resolve_hoisted_descriptor(struct d3d12_command_list *list,
+        struct vkd3d_pipeline_bindings *bindings, const struct vkd3d_descriptor_hoist_desc *hoist_desc,
+        uint32_t heap_offset)
 {
-    const struct d3d12_root_signature *rs = bindings->root_signature;
-    const struct vkd3d_descriptor_hoist_desc *hoist_desc;
     const struct vkd3d_descriptor_metadata_types *types;
     struct vkd3d_root_descriptor_info *root_parameter;
     const struct vkd3d_descriptor_metadata_view *view;
     const struct vkd3d_unique_resource *resource;
     union vkd3d_descriptor_info *info;
-    unsigned int i;
 
-    /* We don't track dirty table index, just update every hoisted descriptor.
-     * Uniform buffers tend to be updated all the time anyways, so this should be fine. */
-    for (i = 0; i < rs->hoist_info.num_desc; i++)
+    view = list->cbv_srv_uav_descriptors_view;
+    types = list->cbv_srv_uav_descriptors_types;
+    if (view)
     {
-        hoist_desc = &rs->hoist_info.desc[i];
-
-        view = list->cbv_srv_uav_descriptors_view;
-        types = list->cbv_srv_uav_descriptors_types;
-        if (view)
-        {
-            view += bindings->descriptor_tables[hoist_desc->table_index] + hoist_desc->table_offset;
-            types += bindings->descriptor_tables[hoist_desc->table_index] + hoist_desc->table_offset;
-        }
+        view += heap_offset;
+        types += heap_offset;
+    }
 
-        root_parameter = &bindings->root_descriptors[hoist_desc->parameter_index];
+    root_parameter = &bindings->root_descriptors[hoist_desc->parameter_index];
 
-        bindings->root_descriptor_dirty_mask |= 1ull << hoist_desc->parameter_index;
-        bindings->root_descriptor_active_mask |= 1ull << hoist_desc->parameter_index;
-        root_parameter->vk_descriptor_type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        info = &root_parameter->info;
+    bindings->root_descriptor_dirty_mask |= 1ull << hoist_desc->parameter_index;
+    bindings->root_descriptor_active_mask |= 1ull << hoist_desc->parameter_index;
+    root_parameter->vk_descriptor_type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    info = &root_parameter->info;
 
-        if (types && (types->flags & VKD3D_DESCRIPTOR_FLAG_BUFFER_VA_RANGE))
+    if (types && (types->flags & VKD3D_DESCRIPTOR_FLAG_BUFFER_VA_RANGE))
+    {
+        /* Buffer descriptors must be valid on recording time. */
+        resource = vkd3d_va_map_deref(&list->device->memory_allocator.va_map, view->info.buffer.va);
+        if (resource)
         {
-            /* Buffer descriptors must be valid on recording time. */
-            resource = vkd3d_va_map_deref(&list->device->memory_allocator.va_map, view->info.buffer.va);
-            if (resource)
-            {
-                info->buffer.buffer = resource->vk_buffer;
-                info->buffer.offset = view->info.buffer.va - resource->va;
-                info->buffer.range = min(view->info.buffer.range, resource->size - info->buffer.offset);
-            }
-            else
-            {
-                info->buffer.buffer = VK_NULL_HANDLE;
-                info->buffer.offset = 0;
-                info->buffer.range = VK_WHOLE_SIZE;
-            }
+            info->buffer.buffer = resource->vk_buffer;
+            info->buffer.offset = view->info.buffer.va - resource->va;
+            info->buffer.range = min(view->info.buffer.range, resource->size - info->buffer.offset);
         }
         else
         {
@@ -5907,6 +7174,91 @@ static void d3d12_command_list_update_hoisted_descriptors(struct d3d12_command_l
             info->buffer.range = VK_WHOLE_SIZE;
         }
     }
+    else
+    {
+        info->buffer.buffer = VK_NULL_HANDLE;
+        info->buffer.offset = 0;
+        info->buffer.range = VK_WHOLE_SIZE;
+    }
+}
+
+static void d3d12_descriptor_hoist_feedback_record(struct vkd3d_descriptor_hoist_feedback *feedback,
+        unsigned int update_count, unsigned int skip_count, bool table_rebind)
+{
+    uint32_t flush_count;
+
+    if (table_rebind)
+        vkd3d_atomic_uint32_increment(&feedback->table_rebind_count, vkd3d_memory_order_relaxed);
+    if (update_count)
+        vkd3d_atomic_uint32_add(&feedback->descriptor_update_count, update_count, vkd3d_memory_order_relaxed);
+    if (skip_count)
+        vkd3d_atomic_uint32_add(&feedback->descriptor_skip_count, skip_count, vkd3d_memory_order_relaxed);
+
+    flush_count = vkd3d_atomic_uint32_increment(&feedback->flush_count, vkd3d_memory_order_relaxed);
+    if (flush_count != VKD3D_DESCRIPTOR_HOIST_FEEDBACK_WARMUP)
+        return;
+
+    /* Exactly one thread observes the end of the warm-up window. If offset tracking
+     * barely ever avoided a descriptor refresh, comparing is pure overhead, go eager. */
+    update_count = vkd3d_atomic_uint32_load_explicit(&feedback->descriptor_update_count, vkd3d_memory_order_relaxed);
+    skip_count = vkd3d_atomic_uint32_load_explicit(&feedback->descriptor_skip_count, vkd3d_memory_order_relaxed);
+
+    if (skip_count * 16u < update_count + skip_count)
+    {
+        TRACE("Hoisted descriptors skipped %u / %u refreshes over %u rebinds, switching to eager mode.\n",
+                skip_count, update_count + skip_count, feedback->table_rebind_count);
+        vkd3d_atomic_uint32_store_explicit(&feedback->mode, VKD3D_DESCRIPTOR_HOIST_MODE_EAGER,
+                vkd3d_memory_order_relaxed);
+    }
+    else
+    {
+        TRACE("Hoisted descriptors skipped %u / %u refreshes over %u rebinds, keeping offset tracking.\n",
+                skip_count, update_count + skip_count, feedback->table_rebind_count);
+        vkd3d_atomic_uint32_store_explicit(&feedback->mode, VKD3D_DESCRIPTOR_HOIST_MODE_TRACKED,
+                vkd3d_memory_order_relaxed);
+    }
+}
+
+static void d3d12_command_list_update_hoisted_descriptors(struct d3d12_command_list *list,
+        struct vkd3d_pipeline_bindings *bindings)
+{
+    const struct d3d12_root_signature *rs = bindings->root_signature;
+    struct vkd3d_descriptor_hoist_feedback *feedback = rs->hoist_info.feedback;
+    const struct vkd3d_descriptor_hoist_desc *hoist_desc;
+    unsigned int update_count = 0, skip_count = 0;
+    uint32_t heap_offset;
+    uint32_t mode;
+    unsigned int i;
+
+    mode = vkd3d_atomic_uint32_load_explicit(&feedback->mode, vkd3d_memory_order_relaxed);
+
+    /* Descriptors in hoisted ranges are static, so they cannot change while the table
+     * remains bound. Unless feedback told us otherwise, only refresh the hoisted
+     * descriptors whose heap offset actually moved since they were last resolved. */
+    for (i = 0; i < rs->hoist_info.num_desc; i++)
+    {
+        hoist_desc = &rs->hoist_info.desc[i];
+        heap_offset = bindings->descriptor_tables[hoist_desc->table_index] + hoist_desc->table_offset;
+
+        if (mode != VKD3D_DESCRIPTOR_HOIST_MODE_EAGER &&
+                (bindings->hoisted_descriptor_valid_mask & (1u << i)) &&
+                bindings->hoisted_descriptor_offsets[i] == heap_offset)
+        {
+            skip_count++;
+            continue;
+        }
+
+        d3d12_command_list_resolve_hoisted_descriptor(list, bindings, hoist_desc, heap_offset);
+        bindings->hoisted_descriptor_offsets[i] = heap_offset;
+        bindings->hoisted_descriptor_valid_mask |= 1u << i;
+        update_count++;
+    }
+
+    if (mode == VKD3D_DESCRIPTOR_HOIST_MODE_WARMUP)
+    {
+        d3d12_descriptor_hoist_feedback_record(feedback, update_count, skip_count,
+                !!(bindings->descriptor_table_dirty_mask & rs->hoist_info.table_mask));
+    }
 
     bindings->dirty_flags &= ~VKD3D_PIPELINE_DIRTY_HOISTED_DESCRIPTORS;
 }
@@ -5965,11 +7317,11 @@ static void d3d12_command_list_update_descriptors(struct d3d12_command_list *lis
     }
 }
 
-static bool d3d12_command_list_update_compute_state(struct d3d12_command_list *list)
+static bool d3d12_command_list_update_compute_state(struct d3d12_command_list *list, bool allow_specialization)
 {
     d3d12_command_list_end_current_render_pass(list, false);
 
-    if (!d3d12_command_list_update_compute_pipeline(list))
+    if (!d3d12_command_list_update_compute_pipeline(list, allow_specialization))
         return false;
 
     d3d12_command_list_update_descriptors(list);
@@ -6026,6 +7378,9 @@ static void d3d12_command_list_update_dynamic_state(struct d3d12_command_list *l
     /* Make sure we only update states that are dynamic in the pipeline */
     dyn_state->dirty_flags &= list->dynamic_state.active_flags;
 
+    if (dyn_state->dirty_flags)
+        d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DYNAMIC_STATE_EMIT);
+
     if (dyn_state->viewport_count)
     {
         if (dyn_state->dirty_flags & VKD3D_DYNAMIC_STATE_VIEWPORT)
@@ -6182,7 +7537,10 @@ static bool d3d12_command_list_begin_render_pass(struct d3d12_command_list *list
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     struct d3d12_graphics_pipeline_state *graphics;
+    uint32_t load_op_mask = 0;
+    unsigned int i;
 
+    d3d12_command_list_flush_deferred_barriers(list);
     d3d12_command_list_end_transfer_batch(list);
 
     d3d12_command_list_promote_dsv_layout(list);
@@ -6202,11 +7560,22 @@ static bool d3d12_command_list_begin_render_pass(struct d3d12_command_list *list
         return true;
     }
 
+    if (list->rendering_info.clear_rtv_mask)
+        load_op_mask = d3d12_command_list_resolve_pending_clears(list);
+
     if (!(list->rendering_info.state_flags & VKD3D_RENDERING_SUSPENDED))
         d3d12_command_list_emit_render_pass_transition(list, VKD3D_RENDER_PASS_TRANSITION_MODE_BEGIN);
 
     d3d12_command_list_debug_mark_begin_region(list, "RenderPass");
     VK_CALL(vkCmdBeginRendering(list->vk_command_buffer, &list->rendering_info.info));
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_RENDER_PASS_BEGIN);
+
+    /* Resuming the render pass later must not clear again. */
+    while (load_op_mask)
+    {
+        i = vkd3d_bitmask_iter32(&load_op_mask);
+        list->rendering_info.rtv[i].loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    }
 
     list->rendering_info.state_flags |= VKD3D_RENDERING_ACTIVE;
     list->rendering_info.state_flags &= ~VKD3D_RENDERING_SUSPENDED;
@@ -6446,18 +7815,23 @@ static bool d3d12_command_list_emit_predicated_command(struct d3d12_command_list
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     struct vkd3d_predicate_command_info pipeline_info;
+    struct vkd3d_meta_timing_scope timing_scope;
     struct vkd3d_predicate_command_args args;
     VkMemoryBarrier2 vk_barrier;
     VkDependencyInfo dep_info;
 
     vkd3d_meta_get_predicate_pipeline(&list->device->meta_ops, command_type, &pipeline_info);
 
+    if (!pipeline_info.vk_pipeline)
+        return false;
+
     if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
             VKD3D_SCRATCH_POOL_KIND_DEVICE_STORAGE,
             pipeline_info.data_size, sizeof(uint32_t), ~0u, scratch))
         return false;
 
     d3d12_command_list_end_current_render_pass(list, true);
+    d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
 
     d3d12_command_list_invalidate_current_pipeline(list, true);
     d3d12_command_list_invalidate_root_parameters(list, &list->compute_bindings, true);
@@ -6487,6 +7861,26 @@ static bool d3d12_command_list_emit_predicated_command(struct d3d12_command_list
     dep_info.pMemoryBarriers = &vk_barrier;
 
     VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+    d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_PREDICATION);
+    return true;
+}
+
+static bool d3d12_command_list_can_predicate_draw_with_count(struct d3d12_command_list *list)
+{
+    /* The resolved predicate is either 0 or 1, so it can be used as the draw count of an
+     * indirect count draw. That avoids a patch dispatch, barrier and render pass split per draw. */
+    return list->device->device_info.vulkan_1_2_features.drawIndirectCount;
+}
+
+static bool d3d12_command_list_upload_predicated_draw_args(struct d3d12_command_list *list,
+        const void *args, size_t size, struct vkd3d_scratch_allocation *scratch)
+{
+    if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_UNIFORM_UPLOAD,
+            size, sizeof(uint32_t), ~0u, scratch))
+        return false;
+
+    memcpy(scratch->host_ptr, args, size);
     return true;
 }
 
@@ -6511,7 +7905,12 @@ static void STDMETHODCALLTYPE d3d12_command_list_DrawInstanced(d3d12_command_lis
         args.draw.firstVertex = start_vertex_location;
         args.draw.firstInstance = start_instance_location;
 
-        if (!d3d12_command_list_emit_predicated_command(list, VKD3D_PREDICATE_COMMAND_DRAW, 0, &args, &scratch))
+        if (d3d12_command_list_can_predicate_draw_with_count(list))
+        {
+            if (!d3d12_command_list_upload_predicated_draw_args(list, &args.draw, sizeof(args.draw), &scratch))
+                return;
+        }
+        else if (!d3d12_command_list_emit_predicated_command(list, VKD3D_PREDICATE_COMMAND_DRAW, 0, &args, &scratch))
             return;
     }
 
@@ -6521,9 +7920,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_DrawInstanced(d3d12_command_lis
         return;
     }
 
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DRAW);
+
     if (!list->predicate_va)
         VK_CALL(vkCmdDraw(list->vk_command_buffer, vertex_count_per_instance,
                 instance_count, start_vertex_location, start_instance_location));
+    else if (d3d12_command_list_can_predicate_draw_with_count(list))
+        VK_CALL(vkCmdDrawIndirectCount(list->vk_command_buffer, scratch.buffer, scratch.offset,
+                list->predicate_vk_buffer, list->predicate_vk_offset, 1, sizeof(VkDrawIndirectCommand)));
     else
         VK_CALL(vkCmdDrawIndirect(list->vk_command_buffer, scratch.buffer, scratch.offset, 1, 0));
 
@@ -6586,7 +7990,13 @@ static void STDMETHODCALLTYPE d3d12_command_list_DrawIndexedInstanced(d3d12_comm
         args.draw_indexed.vertexOffset = base_vertex_location;
         args.draw_indexed.firstInstance = start_instance_location;
 
-        if (!d3d12_command_list_emit_predicated_command(list, VKD3D_PREDICATE_COMMAND_DRAW_INDEXED, 0, &args, &scratch))
+        if (d3d12_command_list_can_predicate_draw_with_count(list))
+        {
+            if (!d3d12_command_list_upload_predicated_draw_args(list, &args.draw_indexed,
+                    sizeof(args.draw_indexed), &scratch))
+                return;
+        }
+        else if (!d3d12_command_list_emit_predicated_command(list, VKD3D_PREDICATE_COMMAND_DRAW_INDEXED, 0, &args, &scratch))
             return;
     }
 
@@ -6597,10 +8007,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_DrawIndexedInstanced(d3d12_comm
     }
 
     d3d12_command_list_check_index_buffer_strip_cut_value(list);
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DRAW);
 
     if (!list->predicate_va)
         VK_CALL(vkCmdDrawIndexed(list->vk_command_buffer, index_count_per_instance,
                 instance_count, start_vertex_location, base_vertex_location, start_instance_location));
+    else if (d3d12_command_list_can_predicate_draw_with_count(list))
+        VK_CALL(vkCmdDrawIndexedIndirectCount(list->vk_command_buffer, scratch.buffer, scratch.offset,
+                list->predicate_vk_buffer, list->predicate_vk_offset, 1, sizeof(VkDrawIndexedIndirectCommand)));
     else
         VK_CALL(vkCmdDrawIndexedIndirect(list->vk_command_buffer, scratch.buffer, scratch.offset, 1, 0));
 
@@ -6634,12 +8048,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_Dispatch(d3d12_command_list_ifa
 
     d3d12_command_list_end_transfer_batch(list);
 
-    if (!d3d12_command_list_update_compute_state(list))
+    if (!d3d12_command_list_update_compute_state(list, true))
     {
         WARN("Failed to update compute state, ignoring dispatch.\n");
         return;
     }
 
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DISPATCH);
+
     if (!list->predicate_va)
         VK_CALL(vkCmdDispatch(list->vk_command_buffer, x, y, z));
     else
@@ -6673,6 +8089,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyBufferRegion(d3d12_command_
 
     d3d12_command_list_track_resource_usage(list, dst_resource, true);
     d3d12_command_list_track_resource_usage(list, src_resource, true);
+    d3d12_resource_invalidate_indirect_cache(dst_resource);
 
     d3d12_command_list_end_current_render_pass(list, true);
     d3d12_command_list_end_transfer_batch(list);
@@ -7376,17 +8793,39 @@ static void d3d12_command_list_before_copy_texture_region(struct d3d12_command_l
     {
         d3d12_command_list_track_resource_usage(list, dst_resource, !info->writes_full_resource);
     }
+    else if (info->batch_type == VKD3D_BATCH_TYPE_RESOLVE)
+    {
+        d3d12_command_list_track_resource_usage(list, dst_resource, !info->writes_full_resource);
+
+        d3d12_command_list_transition_image_layout(list, batch, dst_resource->res.vk_image,
+                &info->copy.resolve.dstSubresource, VK_PIPELINE_STAGE_2_RESOLVE_BIT, VK_ACCESS_2_NONE,
+                info->writes_full_subresource ? VK_IMAGE_LAYOUT_UNDEFINED : dst_resource->common_layout,
+                VK_PIPELINE_STAGE_2_RESOLVE_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, info->dst_layout);
+
+        d3d12_command_list_transition_image_layout(list, batch, src_resource->res.vk_image,
+                &info->copy.resolve.srcSubresource, VK_PIPELINE_STAGE_2_RESOLVE_BIT, VK_ACCESS_2_NONE,
+                src_resource->common_layout, VK_PIPELINE_STAGE_2_RESOLVE_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
+                info->src_layout);
+    }
 }
 
 static void d3d12_command_list_copy_texture_region(struct d3d12_command_list *list,
         struct d3d12_command_list_barrier_batch *batch,
-        struct vkd3d_image_copy_info *info)
+        struct vkd3d_image_copy_info *infos, size_t count)
 {
+    VkBufferImageCopy2 regions[VKD3D_COPY_TEXTURE_REGION_MAX_MERGED_REGIONS];
     struct d3d12_resource *dst_resource, *src_resource;
     const struct vkd3d_vk_device_procs *vk_procs;
     VkAccessFlags2 global_transfer_access;
+    struct vkd3d_image_copy_info *info;
+    size_t i;
 
     vk_procs = &list->device->vk_procs;
+    info = &infos[0];
+
+    /* All infos share the same source and destination, see count_mergeable_copies. */
+    assert(count <= ARRAY_SIZE(regions));
+    assert(count == 1 || info->batch_type != VKD3D_BATCH_TYPE_COPY_IMAGE);
 
     dst_resource = impl_from_ID3D12Resource(info->dst.pResource);
     src_resource = impl_from_ID3D12Resource(info->src.pResource);
@@ -7402,20 +8841,28 @@ static void d3d12_command_list_copy_texture_region(struct d3d12_command_list *li
         copy_info.srcImage = src_resource->res.vk_image;
         copy_info.srcImageLayout = info->src_layout;
         copy_info.dstBuffer = dst_resource->res.vk_buffer;
-        copy_info.regionCount = 1;
-        copy_info.pRegions = &info->copy.buffer_image;
+        copy_info.regionCount = count;
+        copy_info.pRegions = regions;
 
         VKD3D_BREADCRUMB_TAG("Image -> Buffer");
         VKD3D_BREADCRUMB_RESOURCE(src_resource);
         VKD3D_BREADCRUMB_RESOURCE(dst_resource);
-        VKD3D_BREADCRUMB_BUFFER_IMAGE_COPY(&info->copy.buffer_image);
+
+        for (i = 0; i < count; i++)
+        {
+            regions[i] = infos[i].copy.buffer_image;
+            VKD3D_BREADCRUMB_BUFFER_IMAGE_COPY(&regions[i]);
+        }
 
         VK_CALL(vkCmdCopyImageToBuffer2(list->vk_command_buffer, &copy_info));
 
-        d3d12_command_list_transition_image_layout_with_global_memory_barrier(list, batch, src_resource->res.vk_image,
-                &info->copy.buffer_image.imageSubresource, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE,
-                info->src_layout, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE, src_resource->common_layout,
-                global_transfer_access, global_transfer_access);
+        for (i = 0; i < count; i++)
+        {
+            d3d12_command_list_transition_image_layout_with_global_memory_barrier(list, batch, src_resource->res.vk_image,
+                    &infos[i].copy.buffer_image.imageSubresource, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE,
+                    info->src_layout, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_NONE, src_resource->common_layout,
+                    global_transfer_access, global_transfer_access);
+        }
     }
     else if (info->batch_type == VKD3D_BATCH_TYPE_COPY_BUFFER_TO_IMAGE)
     {
@@ -7426,29 +8873,76 @@ static void d3d12_command_list_copy_texture_region(struct d3d12_command_list *li
         copy_info.srcBuffer = src_resource->res.vk_buffer;
         copy_info.dstImage = dst_resource->res.vk_image;
         copy_info.dstImageLayout = info->dst_layout;
-        copy_info.regionCount = 1;
-        copy_info.pRegions = &info->copy.buffer_image;
+        copy_info.regionCount = count;
+        copy_info.pRegions = regions;
 
         VKD3D_BREADCRUMB_TAG("Buffer -> Image");
         VKD3D_BREADCRUMB_RESOURCE(src_resource);
         VKD3D_BREADCRUMB_RESOURCE(dst_resource);
-        VKD3D_BREADCRUMB_BUFFER_IMAGE_COPY(&info->copy.buffer_image);
+
+        for (i = 0; i < count; i++)
+        {
+            regions[i] = infos[i].copy.buffer_image;
+            VKD3D_BREADCRUMB_BUFFER_IMAGE_COPY(&regions[i]);
+        }
 
         VK_CALL(vkCmdCopyBufferToImage2(list->vk_command_buffer, &copy_info));
 
-        d3d12_command_list_transition_image_layout(list, batch, dst_resource->res.vk_image,
-                &info->copy.buffer_image.imageSubresource, VK_PIPELINE_STAGE_2_COPY_BIT,
-                VK_ACCESS_2_TRANSFER_WRITE_BIT, info->dst_layout, VK_PIPELINE_STAGE_2_COPY_BIT,
-                VK_ACCESS_2_NONE, dst_resource->common_layout);
+        for (i = 0; i < count; i++)
+        {
+            d3d12_command_list_transition_image_layout(list, batch, dst_resource->res.vk_image,
+                    &infos[i].copy.buffer_image.imageSubresource, VK_PIPELINE_STAGE_2_COPY_BIT,
+                    VK_ACCESS_2_TRANSFER_WRITE_BIT, info->dst_layout, VK_PIPELINE_STAGE_2_COPY_BIT,
+                    VK_ACCESS_2_NONE, dst_resource->common_layout);
 
-        if (dst_resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY)
-            d3d12_command_list_update_subresource_data(list, dst_resource, info->copy.buffer_image.imageSubresource);
+            if (dst_resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY)
+                d3d12_command_list_update_subresource_data(list, dst_resource, infos[i].copy.buffer_image.imageSubresource);
+        }
     }
     else if (info->batch_type == VKD3D_BATCH_TYPE_COPY_IMAGE)
     {
         d3d12_command_list_copy_image(list, dst_resource, info->dst_format,
                 src_resource, info->src_format, &info->copy.image, info->writes_full_subresource, false);
     }
+    else if (info->batch_type == VKD3D_BATCH_TYPE_RESOLVE)
+    {
+        VkImageResolve2 resolves[VKD3D_COPY_TEXTURE_REGION_MAX_MERGED_REGIONS];
+        VkResolveImageInfo2 resolve_info;
+
+        resolve_info.sType = VK_STRUCTURE_TYPE_RESOLVE_IMAGE_INFO_2;
+        resolve_info.pNext = NULL;
+        resolve_info.srcImage = src_resource->res.vk_image;
+        resolve_info.srcImageLayout = info->src_layout;
+        resolve_info.dstImage = dst_resource->res.vk_image;
+        resolve_info.dstImageLayout = info->dst_layout;
+        resolve_info.regionCount = count;
+        resolve_info.pRegions = resolves;
+
+        VKD3D_BREADCRUMB_TAG("Resolve");
+        VKD3D_BREADCRUMB_RESOURCE(src_resource);
+        VKD3D_BREADCRUMB_RESOURCE(dst_resource);
+
+        for (i = 0; i < count; i++)
+            resolves[i] = infos[i].copy.resolve;
+
+        VK_CALL(vkCmdResolveImage2(list->vk_command_buffer, &resolve_info));
+
+        for (i = 0; i < count; i++)
+        {
+            d3d12_command_list_transition_image_layout(list, batch, dst_resource->res.vk_image,
+                    &infos[i].copy.resolve.dstSubresource, VK_PIPELINE_STAGE_2_RESOLVE_BIT,
+                    VK_ACCESS_2_TRANSFER_WRITE_BIT, info->dst_layout, VK_PIPELINE_STAGE_2_RESOLVE_BIT,
+                    VK_ACCESS_2_NONE, dst_resource->common_layout);
+
+            d3d12_command_list_transition_image_layout(list, batch, src_resource->res.vk_image,
+                    &infos[i].copy.resolve.srcSubresource, VK_PIPELINE_STAGE_2_RESOLVE_BIT,
+                    VK_ACCESS_2_NONE, info->src_layout, VK_PIPELINE_STAGE_2_RESOLVE_BIT,
+                    VK_ACCESS_2_NONE, src_resource->common_layout);
+
+            if (dst_resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY)
+                d3d12_command_list_update_subresource_data(list, dst_resource, infos[i].copy.resolve.dstSubresource);
+        }
+    }
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_CopyTextureRegion(d3d12_command_list_iface *iface,
@@ -7472,7 +8966,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyTextureRegion(d3d12_command
     if (!d3d12_command_list_init_copy_texture_region(list, dst, dst_x, dst_y, dst_z, src, src_box, &copy_info))
         return;
 
-    d3d12_command_list_ensure_transfer_batch(list, copy_info.batch_type);
+    if (!d3d12_command_list_ensure_transfer_batch(list, copy_info.batch_type))
+        return;
 
     alias = false;
     for (i = 0; !alias && i < list->transfer_batch.batch_len; i++)
@@ -7544,6 +9039,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyResource(d3d12_command_list
 
     d3d12_command_list_track_resource_usage(list, dst_resource, false);
     d3d12_command_list_track_resource_usage(list, src_resource, true);
+    d3d12_resource_invalidate_indirect_cache(dst_resource);
 
     d3d12_command_list_end_current_render_pass(list, false);
     d3d12_command_list_end_transfer_batch(list);
@@ -7607,10 +9103,47 @@ static void STDMETHODCALLTYPE d3d12_command_list_CopyResource(d3d12_command_list
     VKD3D_BREADCRUMB_COMMAND(COPY);
 }
 
+static int vkd3d_image_copy_info_compare(const void *a, const void *b)
+{
+    const struct vkd3d_image_copy_info *info_a = a;
+    const struct vkd3d_image_copy_info *info_b = b;
+
+    if (info_a->src.pResource != info_b->src.pResource)
+        return (uintptr_t)info_a->src.pResource < (uintptr_t)info_b->src.pResource ? -1 : 1;
+    if (info_a->dst.pResource != info_b->dst.pResource)
+        return (uintptr_t)info_a->dst.pResource < (uintptr_t)info_b->dst.pResource ? -1 : 1;
+    return 0;
+}
+
+static size_t d3d12_command_list_count_mergeable_copies(const struct vkd3d_image_copy_info *infos, size_t count)
+{
+    size_t i;
+
+    /* Image -> image copies may go through fallback render passes, keep those separate. */
+    if (infos[0].batch_type == VKD3D_BATCH_TYPE_COPY_IMAGE)
+        return 1;
+
+    count = min(count, VKD3D_COPY_TEXTURE_REGION_MAX_MERGED_REGIONS);
+
+    for (i = 1; i < count; i++)
+    {
+        if (infos[i].src.pResource != infos[0].src.pResource ||
+                infos[i].dst.pResource != infos[0].dst.pResource ||
+                infos[i].src_layout != infos[0].src_layout ||
+                infos[i].dst_layout != infos[0].dst_layout)
+            break;
+    }
+
+    return i;
+}
+
 static void d3d12_command_list_end_transfer_batch(struct d3d12_command_list *list)
 {
     struct d3d12_command_list_barrier_batch barriers;
-    size_t i;
+    size_t i, count;
+
+    /* Pending RTAS builds were recorded before anything that ends up in this batch. */
+    d3d12_command_list_flush_rtas_batch(list);
 
     switch (list->transfer_batch.batch_type)
     {
@@ -7619,15 +9152,29 @@ static void d3d12_command_list_end_transfer_batch(struct d3d12_command_list *lis
         case VKD3D_BATCH_TYPE_COPY_BUFFER_TO_IMAGE:
         case VKD3D_BATCH_TYPE_COPY_IMAGE_TO_BUFFER:
         case VKD3D_BATCH_TYPE_COPY_IMAGE:
+        case VKD3D_BATCH_TYPE_RESOLVE:
             d3d12_command_list_end_current_render_pass(list, false);
             d3d12_command_list_debug_mark_begin_region(list, "CopyBatch");
+
+            /* Copies within a buffer <-> image or resolve batch never write the same destination,
+             * so they can be grouped per resource pair and issued with multiple regions. */
+            if (list->transfer_batch.batch_type != VKD3D_BATCH_TYPE_COPY_IMAGE)
+            {
+                qsort(list->transfer_batch.batch, list->transfer_batch.batch_len,
+                        sizeof(*list->transfer_batch.batch), vkd3d_image_copy_info_compare);
+            }
+
             d3d12_command_list_barrier_batch_init(&barriers);
             for (i = 0; i < list->transfer_batch.batch_len; i++)
                 d3d12_command_list_before_copy_texture_region(list, &barriers, &list->transfer_batch.batch[i]);
             d3d12_command_list_barrier_batch_end(list, &barriers);
             d3d12_command_list_barrier_batch_init(&barriers);
-            for (i = 0; i < list->transfer_batch.batch_len; i++)
-                d3d12_command_list_copy_texture_region(list, &barriers, &list->transfer_batch.batch[i]);
+            for (i = 0; i < list->transfer_batch.batch_len; i += count)
+            {
+                count = d3d12_command_list_count_mergeable_copies(&list->transfer_batch.batch[i],
+                        list->transfer_batch.batch_len - i);
+                d3d12_command_list_copy_texture_region(list, &barriers, &list->transfer_batch.batch[i], count);
+            }
             d3d12_command_list_barrier_batch_end(list, &barriers);
             d3d12_command_list_debug_mark_end_region(list);
             list->transfer_batch.batch_len = 0;
@@ -7638,6 +9185,95 @@ static void d3d12_command_list_end_transfer_batch(struct d3d12_command_list *lis
     list->transfer_batch.batch_type = VKD3D_BATCH_TYPE_NONE;
 }
 
+static bool d3d12_command_list_end_wbi_batch_compute(struct d3d12_command_list *list)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct d3d12_wbi_batch_state *wbi_batch = &list->wbi_batch;
+    struct vkd3d_write_buffer_immediate_entry *entries;
+    struct vkd3d_write_buffer_immediate_info pipeline_info;
+    struct vkd3d_write_buffer_immediate_args args;
+    struct vkd3d_scratch_allocation scratch;
+    unsigned int update_count = 0;
+    VkMemoryBarrier2 vk_barrier;
+    VkExtent3D workgroup_size;
+    VkDependencyInfo dep_info;
+    size_t i;
+
+    /* Dispatches are subject to conditional rendering and need a compute-capable queue. */
+    if (!(list->vk_queue_flags & VK_QUEUE_COMPUTE_BIT) || list->predicate_enabled)
+        return false;
+
+    for (i = 0; i < wbi_batch->batch_len; i++)
+    {
+        /* Markers must be written at their pipeline stage, which a dispatch cannot express. */
+        if (wbi_batch->stages[i] != VK_PIPELINE_STAGE_TRANSFER_BIT && list->device->vk_info.AMD_buffer_marker)
+            return false;
+
+        if (!i || wbi_batch->buffers[i] != wbi_batch->buffers[i - 1] ||
+                wbi_batch->offsets[i] != wbi_batch->offsets[i - 1] + sizeof(uint32_t))
+            update_count++;
+    }
+
+    if (update_count < VKD3D_MIN_WBI_COMPUTE_UPDATE_COUNT)
+        return false;
+
+    if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_UNIFORM_UPLOAD, wbi_batch->batch_len * sizeof(*entries),
+            sizeof(*entries), ~0u, &scratch))
+        return false;
+
+    entries = scratch.host_ptr;
+
+    for (i = 0; i < wbi_batch->batch_len; i++)
+    {
+        entries[i].va = wbi_batch->vas[i];
+        entries[i].value = wbi_batch->values[i];
+        entries[i].padding = 0;
+    }
+
+    /* WBI in default mode behaves like a copy, so order the dispatch against
+     * other transfer writes and make its results look like a transfer write in turn. */
+    memset(&vk_barrier, 0, sizeof(vk_barrier));
+    vk_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    vk_barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    vk_barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    vk_barrier.dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.memoryBarrierCount = 1;
+    dep_info.pMemoryBarriers = &vk_barrier;
+
+    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+
+    d3d12_command_list_invalidate_current_pipeline(list, true);
+    d3d12_command_list_invalidate_root_parameters(list, &list->compute_bindings, true);
+
+    vkd3d_meta_get_write_buffer_immediate_pipeline(&list->device->meta_ops, &pipeline_info);
+    workgroup_size = vkd3d_meta_get_write_buffer_immediate_workgroup_size();
+
+    args.entries_va = scratch.va;
+    args.entry_count = wbi_batch->batch_len;
+
+    VK_CALL(vkCmdBindPipeline(list->vk_command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+            pipeline_info.vk_pipeline));
+    VK_CALL(vkCmdPushConstants(list->vk_command_buffer, pipeline_info.vk_pipeline_layout,
+            VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(args), &args));
+    VK_CALL(vkCmdDispatch(list->vk_command_buffer,
+            vkd3d_compute_workgroup_count(wbi_batch->batch_len, workgroup_size.width), 1, 1));
+
+    vk_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    vk_barrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+    vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    vk_barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+
+    wbi_batch->batch_len = 0;
+    return true;
+}
+
 static void d3d12_command_list_end_wbi_batch(struct d3d12_command_list *list)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
@@ -7647,6 +9283,9 @@ static void d3d12_command_list_end_wbi_batch(struct d3d12_command_list *list)
     if (!list->wbi_batch.batch_len)
         return;
 
+    if (d3d12_command_list_end_wbi_batch_compute(list))
+        return;
+
     first = 0;
 
     for (i = 0; i < list->wbi_batch.batch_len; i++)
@@ -7682,13 +9321,32 @@ static void d3d12_command_list_end_wbi_batch(struct d3d12_command_list *list)
     list->wbi_batch.batch_len = 0;
 }
 
-static void d3d12_command_list_ensure_transfer_batch(struct d3d12_command_list *list, enum vkd3d_batch_type type)
+static bool d3d12_command_list_ensure_transfer_batch(struct d3d12_command_list *list, enum vkd3d_batch_type type)
 {
-    if (list->transfer_batch.batch_type != type || list->transfer_batch.batch_len == ARRAY_SIZE(list->transfer_batch.batch))
+    struct d3d12_transfer_batch_state *batch = &list->transfer_batch;
+
+    if (batch->batch_type != type || batch->batch_len == VKD3D_COPY_TEXTURE_REGION_MAX_BATCH_SIZE)
+    {
+        d3d12_command_list_end_transfer_batch(list);
+        batch->batch_type = type;
+    }
+
+    if (!vkd3d_array_reserve((void **)&batch->batch, &batch->batch_size,
+            batch->batch_len + 1, sizeof(*batch->batch)))
     {
+        if (!batch->batch_len)
+        {
+            ERR("Failed to allocate copy batch.\n");
+            batch->batch_type = VKD3D_BATCH_TYPE_NONE;
+            return false;
+        }
+
+        /* Flush what we have and keep using the existing allocation. */
         d3d12_command_list_end_transfer_batch(list);
-        list->transfer_batch.batch_type = type;
+        batch->batch_type = type;
     }
+
+    return true;
 }
 
 static unsigned int vkd3d_get_tile_index_from_region(const struct d3d12_sparse_info *sparse,
@@ -7878,16 +9536,10 @@ static void d3d12_command_list_resolve_subresource(struct d3d12_command_list *li
         struct d3d12_resource *dst_resource, struct d3d12_resource *src_resource,
         const VkImageResolve2KHR *resolve, DXGI_FORMAT format, D3D12_RESOLVE_MODE mode)
 {
-    const struct vkd3d_vk_device_procs *vk_procs;
-    VkImageMemoryBarrier2 vk_image_barriers[2];
+    struct vkd3d_image_copy_info resolve_info;
     const struct vkd3d_format *vk_format;
-    VkImageLayout dst_layout, src_layout;
     const struct d3d12_device *device;
-    VkResolveImageInfo2 resolve_info;
-    bool writes_full_subresource;
-    bool writes_full_resource;
-    VkDependencyInfo dep_info;
-    unsigned int i;
+    size_t i;
 
     if (mode != D3D12_RESOLVE_MODE_AVERAGE)
     {
@@ -7902,9 +9554,6 @@ static void d3d12_command_list_resolve_subresource(struct d3d12_command_list *li
     }
 
     device = list->device;
-    vk_procs = &device->vk_procs;
-    d3d12_command_list_end_current_render_pass(list, false);
-    d3d12_command_list_end_transfer_batch(list);
 
     if (dst_resource->format->type == VKD3D_FORMAT_TYPE_TYPELESS || src_resource->format->type == VKD3D_FORMAT_TYPE_TYPELESS)
     {
@@ -7928,73 +9577,44 @@ static void d3d12_command_list_resolve_subresource(struct d3d12_command_list *li
         return;
     }
 
-    dst_layout = d3d12_resource_pick_layout(dst_resource, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    src_layout = d3d12_resource_pick_layout(src_resource, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-    memset(vk_image_barriers, 0, sizeof(vk_image_barriers));
-
-    for (i = 0; i < ARRAY_SIZE(vk_image_barriers); i++)
-    {
-        vk_image_barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-        vk_image_barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        vk_image_barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        vk_image_barriers[i].srcStageMask = VK_PIPELINE_STAGE_2_RESOLVE_BIT;
-        vk_image_barriers[i].dstStageMask = VK_PIPELINE_STAGE_2_RESOLVE_BIT;
-    }
-
-    writes_full_subresource = d3d12_image_copy_writes_full_subresource(dst_resource,
+    memset(&resolve_info, 0, sizeof(resolve_info));
+    resolve_info.batch_type = VKD3D_BATCH_TYPE_RESOLVE;
+    resolve_info.dst.pResource = (ID3D12Resource *)&dst_resource->ID3D12Resource_iface;
+    resolve_info.src.pResource = (ID3D12Resource *)&src_resource->ID3D12Resource_iface;
+    resolve_info.copy.resolve = *resolve;
+    resolve_info.dst_layout = d3d12_resource_pick_layout(dst_resource, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    resolve_info.src_layout = d3d12_resource_pick_layout(src_resource, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    resolve_info.writes_full_subresource = d3d12_image_copy_writes_full_subresource(dst_resource,
             &resolve->extent, &resolve->dstSubresource);
+    resolve_info.writes_full_resource = resolve_info.writes_full_subresource &&
+            d3d12_resource_get_sub_resource_count(dst_resource) == 1;
 
-    writes_full_resource = writes_full_subresource && d3d12_resource_get_sub_resource_count(dst_resource) == 1;
-
-    d3d12_command_list_track_resource_usage(list, dst_resource, !writes_full_resource);
-    d3d12_command_list_track_resource_usage(list, src_resource, true);
-
-    vk_image_barriers[0].dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-    vk_image_barriers[0].oldLayout = writes_full_subresource ? VK_IMAGE_LAYOUT_UNDEFINED : dst_resource->common_layout;
-    vk_image_barriers[0].newLayout = dst_layout;
-    vk_image_barriers[0].image = dst_resource->res.vk_image;
-    vk_image_barriers[0].subresourceRange = vk_subresource_range_from_layers(&resolve->dstSubresource);
-
-    vk_image_barriers[1].dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
-    vk_image_barriers[1].oldLayout = src_resource->common_layout;
-    vk_image_barriers[1].newLayout = src_layout;
-    vk_image_barriers[1].image = src_resource->res.vk_image;
-    vk_image_barriers[1].subresourceRange = vk_subresource_range_from_layers(&resolve->srcSubresource);
-
-    memset(&dep_info, 0, sizeof(dep_info));
-    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-    dep_info.imageMemoryBarrierCount = ARRAY_SIZE(vk_image_barriers);
-    dep_info.pImageMemoryBarriers = vk_image_barriers;
-
-    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
-
-    resolve_info.sType = VK_STRUCTURE_TYPE_RESOLVE_IMAGE_INFO_2;
-    resolve_info.pNext = NULL;
-    resolve_info.srcImage = src_resource->res.vk_image;
-    resolve_info.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    resolve_info.dstImage = dst_resource->res.vk_image;
-    resolve_info.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    resolve_info.regionCount = 1;
-    resolve_info.pRegions = resolve;
-
-    VK_CALL(vkCmdResolveImage2(list->vk_command_buffer, &resolve_info));
-
-    vk_image_barriers[0].srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-    vk_image_barriers[0].dstAccessMask = VK_ACCESS_2_NONE;
-    vk_image_barriers[0].oldLayout = dst_layout;
-    vk_image_barriers[0].newLayout = dst_resource->common_layout;
+    /* Deferred renderers tend to resolve several targets back to back,
+     * batch them so that they share their layout transitions. */
+    if (!d3d12_command_list_ensure_transfer_batch(list, VKD3D_BATCH_TYPE_RESOLVE))
+        return;
 
-    vk_image_barriers[1].srcAccessMask = VK_ACCESS_2_NONE;
-    vk_image_barriers[1].dstAccessMask = VK_ACCESS_2_NONE;
-    vk_image_barriers[1].oldLayout = src_layout;
-    vk_image_barriers[1].newLayout = src_resource->common_layout;
+    /* Resolves into the same destination subresource must be serialized (WAW hazard).
+     * Sources are multisampled and can never be the destination of another resolve. */
+    for (i = 0; i < list->transfer_batch.batch_len; i++)
+    {
+        const VkImageSubresourceLayers *other_subres = &list->transfer_batch.batch[i].copy.resolve.dstSubresource;
 
-    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+        if (list->transfer_batch.batch[i].dst.pResource == resolve_info.dst.pResource &&
+                other_subres->mipLevel == resolve->dstSubresource.mipLevel &&
+                other_subres->baseArrayLayer < resolve->dstSubresource.baseArrayLayer + resolve->dstSubresource.layerCount &&
+                resolve->dstSubresource.baseArrayLayer < other_subres->baseArrayLayer + other_subres->layerCount)
+        {
+            d3d12_command_list_end_transfer_batch(list);
+            /* end_transfer_batch resets the batch_type to NONE, so we need to restore it here. */
+            list->transfer_batch.batch_type = VKD3D_BATCH_TYPE_RESOLVE;
+            break;
+        }
+    }
 
-    if (dst_resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY)
-        d3d12_command_list_update_subresource_data(list, dst_resource, resolve->dstSubresource);
+    list->transfer_batch.batch[list->transfer_batch.batch_len++] = resolve_info;
 
+    VKD3D_BREADCRUMB_FLUSH_BATCHES(list);
     VKD3D_BREADCRUMB_COMMAND(RESOLVE);
 }
 
@@ -8064,6 +9684,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetPrimitiveTopology(d3d12_co
 static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(d3d12_command_list_iface *iface,
         UINT viewport_count, const D3D12_VIEWPORT *viewports)
 {
+    VkViewport vk_viewports[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList(iface);
     struct vkd3d_dynamic_state *dyn_state = &list->dynamic_state;
     unsigned int i;
@@ -8078,7 +9699,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(d3d12_command_li
 
     for (i = 0; i < viewport_count; ++i)
     {
-        VkViewport *vk_viewport = &dyn_state->viewports[i];
+        VkViewport *vk_viewport = &vk_viewports[i];
         vk_viewport->x = viewports[i].TopLeftX;
         vk_viewport->y = viewports[i].TopLeftY + viewports[i].Height;
         vk_viewport->width = viewports[i].Width;
@@ -8093,6 +9714,13 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(d3d12_command_li
         }
     }
 
+    /* Applications tend to set the same viewports for every draw. */
+    if (dyn_state->viewport_count == viewport_count &&
+            !memcmp(dyn_state->viewports, vk_viewports, viewport_count * sizeof(*vk_viewports)))
+        return;
+
+    memcpy(dyn_state->viewports, vk_viewports, viewport_count * sizeof(*vk_viewports));
+
     if (dyn_state->viewport_count != viewport_count)
     {
         dyn_state->viewport_count = viewport_count;
@@ -8106,6 +9734,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetViewports(d3d12_command_li
 static void STDMETHODCALLTYPE d3d12_command_list_RSSetScissorRects(d3d12_command_list_iface *iface,
         UINT rect_count, const D3D12_RECT *rects)
 {
+    VkRect2D vk_rects[D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList(iface);
     struct vkd3d_dynamic_state *dyn_state = &list->dynamic_state;
     unsigned int i;
@@ -8120,13 +9749,17 @@ static void STDMETHODCALLTYPE d3d12_command_list_RSSetScissorRects(d3d12_command
 
     for (i = 0; i < rect_count; ++i)
     {
-        VkRect2D *vk_rect = &dyn_state->scissors[i];
+        VkRect2D *vk_rect = &vk_rects[i];
         vk_rect->offset.x = max(rects[i].left, 0);
         vk_rect->offset.y = max(rects[i].top, 0);
         vk_rect->extent.width = max(vk_rect->offset.x, rects[i].right) - vk_rect->offset.x;
         vk_rect->extent.height = max(vk_rect->offset.y, rects[i].bottom) - vk_rect->offset.y;
     }
 
+    if (!memcmp(dyn_state->scissors, vk_rects, rect_count * sizeof(*vk_rects)))
+        return;
+
+    memcpy(dyn_state->scissors, vk_rects, rect_count * sizeof(*vk_rects));
     dyn_state->dirty_flags |= VKD3D_DYNAMIC_STATE_SCISSOR;
 }
 
@@ -8459,6 +10092,10 @@ static void d3d12_command_list_barrier_batch_end(struct d3d12_command_list *list
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     VkDependencyInfo dep_info;
 
+    /* Deferred barriers were recorded first, so they must be emitted first. */
+    if (batch != &list->deferred_barriers)
+        d3d12_command_list_flush_deferred_barriers(list);
+
     memset(&dep_info, 0, sizeof(dep_info));
     dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
     dep_info.imageMemoryBarrierCount = batch->image_barrier_count;
@@ -8473,6 +10110,7 @@ static void d3d12_command_list_barrier_batch_end(struct d3d12_command_list *list
     if (dep_info.imageMemoryBarrierCount || dep_info.memoryBarrierCount)
     {
         VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+        d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_BARRIER_BATCH);
 
         batch->vk_memory_barrier.srcStageMask = 0;
         batch->vk_memory_barrier.srcAccessMask = 0;
@@ -8483,6 +10121,20 @@ static void d3d12_command_list_barrier_batch_end(struct d3d12_command_list *list
     }
 }
 
+static bool d3d12_command_list_has_deferred_barriers(const struct d3d12_command_list *list)
+{
+    const struct d3d12_command_list_barrier_batch *batch = &list->deferred_barriers;
+
+    return batch->image_barrier_count ||
+            (batch->vk_memory_barrier.srcStageMask && batch->vk_memory_barrier.dstStageMask);
+}
+
+static void d3d12_command_list_flush_deferred_barriers(struct d3d12_command_list *list)
+{
+    if (d3d12_command_list_has_deferred_barriers(list))
+        d3d12_command_list_barrier_batch_end(list, &list->deferred_barriers);
+}
+
 static bool vk_subresource_range_overlaps(uint32_t base_a, uint32_t count_a, uint32_t base_b, uint32_t count_b)
 {
     uint32_t end_a, end_b;
@@ -8573,17 +10225,166 @@ static void d3d12_command_list_barrier_batch_add_global_transition(
     batch->vk_memory_barrier.dstAccessMask |= dstAccessMask;
 }
 
+static bool vk_image_barrier_is_inverse_transition(const VkImageMemoryBarrier2 *a, const VkImageMemoryBarrier2 *b)
+{
+    /* A transition away from UNDEFINED discards contents and cannot be undone. */
+    return a->oldLayout != VK_IMAGE_LAYOUT_UNDEFINED && b->oldLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+            a->oldLayout == b->newLayout && a->newLayout == b->oldLayout;
+}
+
+static void d3d12_command_list_defer_barrier_batch(struct d3d12_command_list *list,
+        struct d3d12_command_list_barrier_batch *batch)
+{
+    struct d3d12_command_list_barrier_batch *deferred = &list->deferred_barriers;
+    const VkMemoryBarrier2 *memory_barrier = &batch->vk_memory_barrier;
+    VkPipelineStageFlags2 deferred_src_stages;
+    VkImageMemoryBarrier2 *image_barrier;
+    VkAccessFlags2 deferred_src_access;
+    bool exact_match, undone;
+    uint32_t i, j;
+
+    if (!d3d12_command_list_has_deferred_barriers(list))
+    {
+        *deferred = *batch;
+        return;
+    }
+
+    /* D3D12 executes barriers from separate calls in order, while everything in one
+     * vkCmdPipelineBarrier2 is unordered. Widen stage masks so that merged barriers still chain:
+     * earlier layout transitions complete before anything a later memory barrier waits on,
+     * and later layout transitions wait for anything an earlier memory barrier waited for. */
+    deferred_src_stages = deferred->vk_memory_barrier.srcStageMask;
+    deferred_src_access = deferred->vk_memory_barrier.srcAccessMask;
+
+    if (memory_barrier->srcStageMask && memory_barrier->dstStageMask)
+    {
+        for (j = 0; j < deferred->image_barrier_count; j++)
+        {
+            deferred->vk_image_barriers[j].dstStageMask |= memory_barrier->dstStageMask;
+            deferred->vk_image_barriers[j].dstAccessMask |= memory_barrier->dstAccessMask;
+        }
+
+        d3d12_command_list_barrier_batch_add_global_transition(list, deferred,
+                memory_barrier->srcStageMask, memory_barrier->srcAccessMask,
+                memory_barrier->dstStageMask, memory_barrier->dstAccessMask);
+    }
+
+    for (i = 0; i < batch->image_barrier_count; i++)
+    {
+        image_barrier = &batch->vk_image_barriers[i];
+        image_barrier->srcStageMask |= deferred_src_stages;
+        image_barrier->srcAccessMask |= deferred_src_access;
+        undone = false;
+
+        for (j = 0; j < deferred->image_barrier_count; j++)
+        {
+            if (!vk_image_barrier_overlaps_subresource(image_barrier, &deferred->vk_image_barriers[j], &exact_match))
+                continue;
+
+            if (exact_match && vk_image_barrier_is_inverse_transition(image_barrier, &deferred->vk_image_barriers[j]))
+            {
+                /* The transition is undone before anything used the new layout.
+                 * Only the memory dependency between the outer states remains. */
+                d3d12_command_list_barrier_batch_add_global_transition(list, deferred,
+                        deferred->vk_image_barriers[j].srcStageMask, deferred->vk_image_barriers[j].srcAccessMask,
+                        image_barrier->dstStageMask, image_barrier->dstAccessMask);
+                deferred->vk_image_barriers[j] = deferred->vk_image_barriers[--deferred->image_barrier_count];
+                undone = true;
+            }
+            else
+            {
+                /* Dependent transition, the earlier barriers have to complete first. */
+                d3d12_command_list_flush_deferred_barriers(list);
+            }
+            break;
+        }
+
+        if (undone)
+            continue;
+
+        if (deferred->image_barrier_count == ARRAY_SIZE(deferred->vk_image_barriers))
+            d3d12_command_list_flush_deferred_barriers(list);
+        deferred->vk_image_barriers[deferred->image_barrier_count++] = *image_barrier;
+    }
+}
+
+static bool d3d12_command_list_resource_is_bound_attachment(const struct d3d12_command_list *list,
+        const struct d3d12_resource *resource, uint32_t rtv_mask)
+{
+    unsigned int i;
+
+    while (rtv_mask)
+    {
+        i = vkd3d_bitmask_iter32(&rtv_mask);
+        if (list->rtvs[i].resource == resource)
+            return true;
+    }
+
+    return false;
+}
+
+static void d3d12_command_list_classify_barriers(const struct d3d12_command_list *list,
+        UINT barrier_count, const D3D12_RESOURCE_BARRIER *barriers,
+        bool *touches_attachments, bool *touches_pending_clears)
+{
+    uint32_t clear_mask = list->rendering_info.clear_rtv_mask;
+    const struct d3d12_resource *resource;
+    uint32_t rtv_mask = 0;
+    unsigned int i;
+
+    *touches_attachments = false;
+    *touches_pending_clears = false;
+
+    for (i = 0; i < ARRAY_SIZE(list->rtvs); i++)
+        if (list->rtvs[i].view)
+            rtv_mask |= 1u << i;
+
+    for (i = 0; i < barrier_count; i++)
+    {
+        /* Only transitions name a single resource. Anything else may act like a global barrier. */
+        if (barriers[i].Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ||
+                !(resource = impl_from_ID3D12Resource(barriers[i].Transition.pResource)))
+        {
+            *touches_attachments = true;
+            *touches_pending_clears = !!clear_mask;
+            return;
+        }
+
+        if (resource == list->dsv.resource || d3d12_command_list_resource_is_bound_attachment(list, resource, rtv_mask))
+            *touches_attachments = true;
+        if (d3d12_command_list_resource_is_bound_attachment(list, resource, clear_mask))
+            *touches_pending_clears = true;
+    }
+}
+
 static void STDMETHODCALLTYPE d3d12_command_list_ResourceBarrier(d3d12_command_list_iface *iface,
         UINT barrier_count, const D3D12_RESOURCE_BARRIER *barriers)
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList(iface);
+    bool touches_attachments, touches_pending_clears;
     struct d3d12_command_list_barrier_batch batch;
     bool have_split_barriers = false;
     unsigned int i, j;
+    bool suspend;
 
     TRACE("iface %p, barrier_count %u, barriers %p.\n", iface, barrier_count, barriers);
 
-    d3d12_command_list_end_current_render_pass(list, false);
+    /* Transition and aliasing barriers record image barriers without tracking resource usage. */
+    vkd3d_memory_bind_queue_flush_if_pending(&list->device->memory_binds, list->device);
+
+    d3d12_command_list_classify_barriers(list, barrier_count, barriers,
+            &touches_attachments, &touches_pending_clears);
+
+    if (touches_pending_clears)
+        d3d12_command_list_flush_pending_clears(list);
+
+    /* Barriers which leave bound attachments alone only need to suspend the render pass,
+     * which skips the end-of-pass and resume layout transitions.
+     * If there is nothing to end, skip the call so barriers deferred by an earlier
+     * ResourceBarrier() and pending clears stay pending. */
+    suspend = !touches_attachments;
+    if (!d3d12_command_list_render_pass_is_idle(list, suspend))
+        d3d12_command_list_end_current_render_pass(list, suspend);
     d3d12_command_list_end_transfer_batch(list);
     d3d12_command_list_barrier_batch_init(&batch);
 
@@ -8645,6 +10446,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResourceBarrier(d3d12_command_l
                 VKD3D_BREADCRUMB_AUX32(transition->StateAfter);
                 VKD3D_BREADCRUMB_TAG("Resource Transition");
 
+                /* Transitioning back to indirect arguments is the point where new arguments become visible. */
+                if (transition->StateAfter & D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT)
+                    d3d12_resource_invalidate_indirect_cache(preserve_resource);
+
                 /* If the resource is a host-visible image and has been used as a UAV, schedule a
                  * subresource update since we cannot know when it is being written in a shader. */
                 if (transition->StateBefore == D3D12_RESOURCE_STATE_UNORDERED_ACCESS &&
@@ -8783,7 +10588,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResourceBarrier(d3d12_command_l
 
                 VKD3D_BREADCRUMB_TAG("Aliasing Barrier");
 
-                if (d3d12_resource_may_alias_other_resources(before) && d3d12_resource_may_alias_other_resources(after))
+                if (d3d12_resource_may_alias(before, after))
                 {
                     /* Aliasing barriers in D3D12 are extremely weird and don't behavior like you would expect.
                      * For buffer aliasing, it is basically a global memory barrier, but for images it gets
@@ -8826,7 +10631,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResourceBarrier(d3d12_command_l
             d3d12_command_list_track_resource_usage(list, preserve_resource, true);
     }
 
-    d3d12_command_list_barrier_batch_end(list, &batch);
+    d3d12_command_list_defer_barrier_batch(list, &batch);
 
     /* Vulkan doesn't support split barriers. */
     if (have_split_barriers)
@@ -8857,11 +10662,13 @@ static void vkd3d_pipeline_bindings_set_dirty_sets(struct vkd3d_pipeline_binding
 {
     bindings->descriptor_heap_dirty_mask = dirty_mask;
     bindings->dirty_flags |= VKD3D_PIPELINE_DIRTY_HOISTED_DESCRIPTORS;
+    bindings->hoisted_descriptor_valid_mask = 0;
 }
 
 static void d3d12_command_list_set_descriptor_heaps_buffers(struct d3d12_command_list *list,
         unsigned int heap_count, ID3D12DescriptorHeap *const *heaps)
 {
+    VkDeviceSize current_offsets[VKD3D_MAX_BINDLESS_DESCRIPTOR_SETS];
     struct vkd3d_bindless_state *bindless_state = &list->device->bindless_state;
     VkDeviceAddress current_resource_va, current_sampler_va;
     struct d3d12_desc_split d;
@@ -8869,6 +10676,7 @@ static void d3d12_command_list_set_descriptor_heaps_buffers(struct d3d12_command
 
     current_resource_va = list->descriptor_heap.buffers.heap_va_resource;
     current_sampler_va = list->descriptor_heap.buffers.heap_va_sampler;
+    memcpy(current_offsets, list->descriptor_heap.buffers.vk_offsets, sizeof(current_offsets));
 
     for (i = 0; i < heap_count; i++)
     {
@@ -8903,7 +10711,16 @@ static void d3d12_command_list_set_descriptor_heaps_buffers(struct d3d12_command
 
     if (current_resource_va == list->descriptor_heap.buffers.heap_va_resource &&
             current_sampler_va == list->descriptor_heap.buffers.heap_va_sampler)
+    {
+        if (!memcmp(current_offsets, list->descriptor_heap.buffers.vk_offsets, sizeof(current_offsets)))
+            return;
+
+        /* Suballocated heaps sharing a descriptor buffer block only need new set offsets,
+         * we can skip rebinding the descriptor buffers themselves. */
+        d3d12_command_list_invalidate_root_parameters(list, &list->graphics_bindings, true);
+        d3d12_command_list_invalidate_root_parameters(list, &list->compute_bindings, true);
         return;
+    }
 
     list->descriptor_heap.buffers.heap_dirty = true;
     /* Invalidation is a bit more aggressive for descriptor buffers.
@@ -8963,12 +10780,32 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetDescriptorHeaps(d3d12_comman
         d3d12_command_list_set_descriptor_heaps_sets(list, heap_count, heaps);
 }
 
+static bool d3d12_root_signature_static_sampler_set_is_compatible(const struct d3d12_root_signature *a,
+        const struct d3d12_root_signature *b)
+{
+    /* A bound set survives a pipeline layout switch if the layouts are compatible for that set,
+     * i.e. all set layouts up to and including it and the push constant ranges are identical.
+     * Sets below the static sampler set are the bindless sets, which are global to the device. */
+    return a->static_sampler_set && a->static_sampler_set == b->static_sampler_set &&
+            a->sampler_descriptor_set == b->sampler_descriptor_set &&
+            !memcmp(&a->graphics.push_constant_range, &b->graphics.push_constant_range, sizeof(VkPushConstantRange)) &&
+            !memcmp(&a->mesh.push_constant_range, &b->mesh.push_constant_range, sizeof(VkPushConstantRange)) &&
+            !memcmp(&a->compute.push_constant_range, &b->compute.push_constant_range, sizeof(VkPushConstantRange)) &&
+            !memcmp(&a->raygen.push_constant_range, &b->raygen.push_constant_range, sizeof(VkPushConstantRange));
+}
+
 static void d3d12_command_list_set_root_signature(struct d3d12_command_list *list,
         struct vkd3d_pipeline_bindings *bindings, const struct d3d12_root_signature *root_signature)
 {
+    bool keep_static_sampler_set;
+
     if (bindings->root_signature == root_signature)
         return;
 
+    keep_static_sampler_set = bindings->root_signature && root_signature &&
+            !(bindings->dirty_flags & VKD3D_PIPELINE_DIRTY_STATIC_SAMPLER_SET) &&
+            d3d12_root_signature_static_sampler_set_is_compatible(bindings->root_signature, root_signature);
+
     bindings->root_signature = root_signature;
     bindings->static_sampler_set = VK_NULL_HANDLE;
 
@@ -8976,6 +10813,9 @@ static void d3d12_command_list_set_root_signature(struct d3d12_command_list *lis
         bindings->static_sampler_set = root_signature->vk_sampler_set;
 
     d3d12_command_list_invalidate_root_parameters(list, bindings, true);
+
+    if (keep_static_sampler_set)
+        bindings->dirty_flags &= ~VKD3D_PIPELINE_DIRTY_STATIC_SAMPLER_SET;
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_SetComputeRootSignature(d3d12_command_list_iface *iface,
@@ -9012,12 +10852,13 @@ static inline void d3d12_command_list_set_descriptor_table_embedded(struct d3d12
     bindings->descriptor_tables[index] = d3d12_desc_heap_offset_from_embedded_gpu_handle(
             base_descriptor, cbv_srv_uav_size_log2, sampler_size_log2);
     bindings->descriptor_table_active_mask |= (uint64_t)1 << index;
+    bindings->descriptor_table_dirty_mask |= (uint64_t)1 << index;
 
     if (root_signature)
     {
         if (root_signature->descriptor_table_count)
             bindings->dirty_flags |= VKD3D_PIPELINE_DIRTY_DESCRIPTOR_TABLE_OFFSETS;
-        if (root_signature->hoist_info.num_desc)
+        if (root_signature->hoist_info.table_mask & (1ull << index))
             bindings->dirty_flags |= VKD3D_PIPELINE_DIRTY_HOISTED_DESCRIPTORS;
     }
 }
@@ -9030,12 +10871,13 @@ static inline void d3d12_command_list_set_descriptor_table(struct d3d12_command_
     assert(index < ARRAY_SIZE(bindings->descriptor_tables));
     bindings->descriptor_tables[index] = d3d12_desc_heap_offset_from_gpu_handle(base_descriptor);
     bindings->descriptor_table_active_mask |= (uint64_t)1 << index;
+    bindings->descriptor_table_dirty_mask |= (uint64_t)1 << index;
 
     if (root_signature)
     {
         if (root_signature->descriptor_table_count)
             bindings->dirty_flags |= VKD3D_PIPELINE_DIRTY_DESCRIPTOR_TABLE_OFFSETS;
-        if (root_signature->hoist_info.num_desc)
+        if (root_signature->hoist_info.table_mask & (1ull << index))
             bindings->dirty_flags |= VKD3D_PIPELINE_DIRTY_HOISTED_DESCRIPTORS;
     }
 }
@@ -9160,6 +11002,7 @@ static void d3d12_command_list_set_root_constants(struct d3d12_command_list *lis
     memcpy(&bindings->root_constants[c->constant_index + offset], data, count * sizeof(uint32_t));
 
     bindings->root_constant_dirty_mask |= 1ull << index;
+    bindings->root_constant_word_dirty_mask |= vkd3d_root_constant_word_mask(c->constant_index + offset, count);
 
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     for (i = 0; i < count; i++)
@@ -9224,13 +11067,12 @@ static void d3d12_command_list_set_push_descriptor_info(struct d3d12_command_lis
         struct vkd3d_pipeline_bindings *bindings, unsigned int index, D3D12_GPU_VIRTUAL_ADDRESS gpu_address)
 {
     const struct d3d12_root_signature *root_signature = bindings->root_signature;
-    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     const struct vkd3d_vulkan_info *vk_info = &list->device->vk_info;
     const struct vkd3d_shader_root_parameter *root_parameter;
     struct vkd3d_root_descriptor_info *descriptor;
     const struct vkd3d_unique_resource *resource;
+    VkDeviceSize max_range, offset, range;
     VkBufferView vk_buffer_view;
-    VkDeviceSize max_range;
     bool ssbo;
 
     ssbo = d3d12_device_use_ssbo_root_descriptors(list->device);
@@ -9267,16 +11109,14 @@ static void d3d12_command_list_set_push_descriptor_info(struct d3d12_command_lis
 
         if (gpu_address)
         {
-            if (!vkd3d_create_raw_buffer_view(list->device, gpu_address, &vk_buffer_view))
-            {
-                ERR("Failed to create buffer view.\n");
-                return;
-            }
+            resource = vkd3d_va_map_deref(&list->device->memory_allocator.va_map, gpu_address);
+            offset = gpu_address - resource->va;
+            range = min(resource->size - offset, vk_info->device_limits.maxStorageBufferRange);
 
-            if (!(d3d12_command_allocator_add_buffer_view(list->allocator, vk_buffer_view)))
+            if (!d3d12_command_allocator_get_buffer_view(list->allocator, resource->vk_buffer, resource->cookie,
+                    offset, range, NULL, &vk_buffer_view))
             {
-                ERR("Failed to add buffer view.\n");
-                VK_CALL(vkDestroyBufferView(list->device->vk_device, vk_buffer_view, NULL));
+                ERR("Failed to create buffer view.\n");
                 return;
             }
 
@@ -9440,9 +11280,9 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetVertexBuffers(d3d12_comman
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList(iface);
     struct vkd3d_dynamic_state *dyn_state = &list->dynamic_state;
     const struct vkd3d_unique_resource *resource;
-    uint32_t vbo_invalidate_mask;
+    uint32_t vbo_invalidate_mask = 0;
     bool invalidate = false;
-    unsigned int i;
+    unsigned int i, slot;
 
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
 
@@ -9497,16 +11337,25 @@ static void STDMETHODCALLTYPE d3d12_command_list_IASetVertexBuffers(d3d12_comman
             stride = VKD3D_NULL_BUFFER_SIZE;
         }
 
-        invalidate |= dyn_state->vertex_strides[start_slot + i] != stride;
-        dyn_state->vertex_strides[start_slot + i] = stride;
-        dyn_state->vertex_buffers[start_slot + i] = buffer;
-        dyn_state->vertex_offsets[start_slot + i] = offset;
-        dyn_state->vertex_sizes[start_slot + i] = size;
+        slot = start_slot + i;
+
+        /* Rebinding the same VBO is common, only rebind slots which actually changed. */
+        if (dyn_state->vertex_strides[slot] == stride && dyn_state->vertex_buffers[slot] == buffer &&
+                dyn_state->vertex_offsets[slot] == offset && dyn_state->vertex_sizes[slot] == size)
+            continue;
+
+        invalidate |= dyn_state->vertex_strides[slot] != stride;
+        dyn_state->vertex_strides[slot] = stride;
+        dyn_state->vertex_buffers[slot] = buffer;
+        dyn_state->vertex_offsets[slot] = offset;
+        dyn_state->vertex_sizes[slot] = size;
+        vbo_invalidate_mask |= 1u << slot;
     }
 
-    dyn_state->dirty_flags |= VKD3D_DYNAMIC_STATE_VERTEX_BUFFER_STRIDE;
+    if (!vbo_invalidate_mask)
+        return;
 
-    vbo_invalidate_mask = ((1u << view_count) - 1u) << start_slot;
+    dyn_state->dirty_flags |= VKD3D_DYNAMIC_STATE_VERTEX_BUFFER_STRIDE;
     dyn_state->dirty_vbos |= vbo_invalidate_mask;
 
     if (invalidate)
@@ -9574,6 +11423,21 @@ static void STDMETHODCALLTYPE d3d12_command_list_SOSetTargets(d3d12_command_list
         VK_CALL(vkCmdBindTransformFeedbackBuffersEXT(list->vk_command_buffer, first, count, buffers, offsets, sizes));
 }
 
+static void d3d12_command_list_mark_residency_use(struct d3d12_command_list *list,
+        struct d3d12_resource *resource)
+{
+    struct vkd3d_residency_manager *manager = &list->device->residency_manager;
+
+    if (!manager->demotion_enabled)
+        return;
+
+    /* Placed resources share the residency of their heap. */
+    if (resource->priority.allows_dynamic_residency)
+        vkd3d_residency_manager_mark_use(manager, &resource->priority);
+    else if (resource->heap)
+        vkd3d_residency_manager_mark_use(manager, &resource->heap->priority);
+}
+
 static void STDMETHODCALLTYPE d3d12_command_list_OMSetRenderTargets(d3d12_command_list_iface *iface,
         UINT render_target_descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE *render_target_descriptors,
         BOOL single_descriptor_handle, const D3D12_CPU_DESCRIPTOR_HANDLE *depth_stencil_descriptor)
@@ -9639,6 +11503,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_OMSetRenderTargets(d3d12_comman
         VKD3D_BREADCRUMB_TAG("RTV bind");
 
         list->rtvs[i] = *rtv_desc;
+        d3d12_command_list_mark_residency_use(list, rtv_desc->resource);
         list->fb_width = min(list->fb_width, rtv_desc->width);
         list->fb_height = min(list->fb_height, rtv_desc->height);
         list->fb_layer_count = min(list->fb_layer_count, rtv_desc->layer_count);
@@ -9650,6 +11515,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_OMSetRenderTargets(d3d12_comman
                 && rtv_desc->resource)
         {
             list->dsv = *rtv_desc;
+            d3d12_command_list_mark_residency_use(list, rtv_desc->resource);
             list->fb_width = min(list->fb_width, rtv_desc->width);
             list->fb_height = min(list->fb_height, rtv_desc->height);
             list->fb_layer_count = min(list->fb_layer_count, rtv_desc->layer_count);
@@ -9745,9 +11611,13 @@ static void d3d12_command_list_clear_attachment(struct d3d12_command_list *list,
          * the render pass isn't active and we're only going to clear
          * a sub-region of the image, or one of the aspects to clear
          * uses a read-only layout in the current render pass */
-        d3d12_command_list_end_current_render_pass(list, false);
-        d3d12_command_list_clear_attachment_pass(list, resource, view,
-                clear_aspects, clear_value, rect_count, rects, false);
+        if (!d3d12_command_list_defer_clear_attachment(list, resource, view,
+                clear_aspects, clear_value, rect_count))
+        {
+            d3d12_command_list_end_current_render_pass(list, false);
+            d3d12_command_list_clear_attachment_pass(list, resource, view,
+                    clear_aspects, clear_value, rect_count, rects, false);
+        }
     }
     else
     {
@@ -9845,11 +11715,159 @@ struct vkd3d_clear_uav_info
     } u;
 };
 
+/* Beyond this, coalescing is unlikely to pay for itself. */
+#define VKD3D_CLEAR_UAV_MAX_COALESCED_RECTS 64
+/* Clearing through the transfer path costs two extra barriers, so only do it where
+ * a fast clear can win that back. */
+#define VKD3D_CLEAR_UAV_TRANSFER_MIN_TEXELS (256u * 256u)
+
+static bool vkd3d_clear_uav_try_merge_rects(D3D12_RECT *a, const D3D12_RECT *b)
+{
+    if (b->left >= a->left && b->right <= a->right && b->top >= a->top && b->bottom <= a->bottom)
+        return true;
+
+    if (a->left >= b->left && a->right <= b->right && a->top >= b->top && a->bottom <= b->bottom)
+    {
+        *a = *b;
+        return true;
+    }
+
+    /* Same rows, and the column ranges touch or overlap. */
+    if (a->top == b->top && a->bottom == b->bottom && b->left <= a->right && a->left <= b->right)
+    {
+        a->left = min(a->left, b->left);
+        a->right = max(a->right, b->right);
+        return true;
+    }
+
+    /* Same columns, and the row ranges touch or overlap. */
+    if (a->left == b->left && a->right == b->right && b->top <= a->bottom && a->top <= b->bottom)
+    {
+        a->top = min(a->top, b->top);
+        a->bottom = max(a->bottom, b->bottom);
+        return true;
+    }
+
+    return false;
+}
+
+static unsigned int vkd3d_clear_uav_coalesce_rects(const D3D12_RECT *full_rect,
+        const D3D12_RECT *rects, unsigned int rect_count, D3D12_RECT *coalesced_rects)
+{
+    unsigned int i, j, count = 0;
+    bool progress;
+
+    /* Clamp to the resource and drop empty rects first, so that they cannot block merges. */
+    for (i = 0; i < rect_count; i++)
+    {
+        D3D12_RECT *rect = &coalesced_rects[count];
+
+        rect->left = max(rects[i].left, full_rect->left);
+        rect->top = max(rects[i].top, full_rect->top);
+        rect->right = min(rects[i].right, full_rect->right);
+        rect->bottom = min(rects[i].bottom, full_rect->bottom);
+
+        if (rect->left < rect->right && rect->top < rect->bottom)
+            count++;
+    }
+
+    /* Every rect is cleared to the same value, so order does not matter. */
+    do
+    {
+        progress = false;
+
+        for (i = 0; i < count; i++)
+        {
+            for (j = i + 1; j < count; )
+            {
+                if (vkd3d_clear_uav_try_merge_rects(&coalesced_rects[i], &coalesced_rects[j]))
+                {
+                    coalesced_rects[j] = coalesced_rects[--count];
+                    progress = true;
+                }
+                else
+                    j++;
+            }
+        }
+    } while (progress);
+
+    return count;
+}
+
+static bool d3d12_command_list_clear_uav_image_with_transfer(struct d3d12_command_list *list,
+        struct d3d12_resource *resource, const struct vkd3d_view *view,
+        const VkClearColorValue *clear_color, const D3D12_RECT *full_rect, unsigned int layer_count)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    VkImageSubresourceRange vk_range;
+    VkDependencyInfo dep_info;
+    VkMemoryBarrier2 barrier;
+
+    /* vkCmdClearColorImage interprets the clear value based on the image format,
+     * which only matches what the shader would write if the view does not reinterpret. */
+    if (view->format->vk_format != resource->format->vk_format ||
+            view->format->type == VKD3D_FORMAT_TYPE_SINT ||
+            view->format->vk_aspect_mask != VK_IMAGE_ASPECT_COLOR_BIT)
+        return false;
+
+    /* Transfer clears cannot target a subset of 3D slices. */
+    if (view->info.texture.vk_view_type == VK_IMAGE_VIEW_TYPE_3D &&
+            (view->info.texture.w_offset ||
+            layer_count != d3d12_resource_desc_get_depth(&resource->desc, view->info.texture.miplevel_idx)))
+        return false;
+
+    if ((uint64_t)(full_rect->right - full_rect->left) * (full_rect->bottom - full_rect->top) * layer_count <
+            VKD3D_CLEAR_UAV_TRANSFER_MIN_TEXELS)
+        return false;
+
+    vk_range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    vk_range.baseMipLevel = view->info.texture.miplevel_idx;
+    vk_range.levelCount = 1;
+
+    if (view->info.texture.vk_view_type == VK_IMAGE_VIEW_TYPE_3D)
+    {
+        vk_range.baseArrayLayer = 0;
+        vk_range.layerCount = 1;
+    }
+    else
+    {
+        vk_range.baseArrayLayer = view->info.texture.layer_idx;
+        vk_range.layerCount = view->info.texture.layer_count;
+    }
+
+    /* App UAV barriers only cover shader stages, so order against those ourselves. */
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.memoryBarrierCount = 1;
+    dep_info.pMemoryBarriers = &barrier;
+
+    memset(&barrier, 0, sizeof(barrier));
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = vk_queue_shader_stages(list->vk_queue_flags);
+    barrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+
+    VK_CALL(vkCmdClearColorImage(list->vk_command_buffer, resource->res.vk_image,
+            VK_IMAGE_LAYOUT_GENERAL, clear_color, 1, &vk_range));
+
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask = vk_queue_shader_stages(list->vk_queue_flags);
+    barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+
+    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+    return true;
+}
+
 static void d3d12_command_list_clear_uav(struct d3d12_command_list *list,
         struct d3d12_resource *resource, const struct vkd3d_clear_uav_info *args,
         const VkClearColorValue *clear_color, UINT rect_count, const D3D12_RECT *rects)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    D3D12_RECT coalesced_rects[VKD3D_CLEAR_UAV_MAX_COALESCED_RECTS];
     VkExtent3D workgroup_size, workgroup_count;
     unsigned int i, j, miplevel_idx, layer_count;
     struct vkd3d_clear_uav_pipeline pipeline;
@@ -9958,6 +11976,37 @@ static void d3d12_command_list_clear_uav(struct d3d12_command_list *list,
             full_rect.right = args->u.buffer.range / sizeof(uint32_t);
     }
 
+    /* Apps commonly clear tiles of a larger region with separate rects. Merging them saves dispatches,
+     * and might turn the clear into a full clear. */
+    if (rect_count > 1 && rect_count <= ARRAY_SIZE(coalesced_rects))
+    {
+        rect_count = vkd3d_clear_uav_coalesce_rects(&full_rect, rects, rect_count, coalesced_rects);
+        rects = coalesced_rects;
+
+        if (!rect_count)
+        {
+            d3d12_command_list_debug_mark_end_region(list);
+            return;
+        }
+    }
+
+    if (d3d12_resource_is_texture(resource) && (!rect_count || (rect_count == 1 &&
+            rects[0].left <= full_rect.left && rects[0].top <= full_rect.top &&
+            rects[0].right >= full_rect.right && rects[0].bottom >= full_rect.bottom)) &&
+            d3d12_command_list_clear_uav_image_with_transfer(list, resource, args->u.view,
+                    clear_color, &full_rect, layer_count))
+    {
+        d3d12_command_list_debug_mark_end_region(list);
+        return;
+    }
+
+    if (!pipeline.vk_pipeline)
+    {
+        ERR("No pipeline for UAV clear.\n");
+        d3d12_command_list_debug_mark_end_region(list);
+        return;
+    }
+
     /* clear full resource if no rects are specified */
     curr_rect = full_rect;
 
@@ -10079,16 +12128,16 @@ static void d3d12_command_list_clear_uav_with_copy(struct d3d12_command_list *li
     pipeline = vkd3d_meta_get_clear_buffer_uav_pipeline(&list->device->meta_ops, true, false);
     workgroup_size = vkd3d_meta_get_clear_buffer_uav_workgroup_size();
 
-    if (!vkd3d_create_vk_buffer_view(list->device, scratch.buffer, format, scratch.offset, scratch_buffer_size, &vk_buffer_view))
+    if (!pipeline.vk_pipeline)
     {
-        ERR("Failed to create buffer view for UAV clear.\n");
+        ERR("No pipeline for UAV clear.\n");
         return;
     }
 
-    if (!(d3d12_command_allocator_add_buffer_view(list->allocator, vk_buffer_view)))
+    if (!d3d12_command_allocator_get_buffer_view(list->allocator, scratch.buffer, scratch.cookie,
+            scratch.offset, scratch_buffer_size, format, &vk_buffer_view))
     {
-        ERR("Failed to add buffer view.\n");
-        VK_CALL(vkDestroyBufferView(list->device->vk_device, vk_buffer_view, NULL));
+        ERR("Failed to create buffer view for UAV clear.\n");
         return;
     }
 
@@ -10398,6 +12447,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewUint(d3
     const struct vkd3d_format *uint_format;
     struct vkd3d_view *inline_view = NULL;
     struct d3d12_resource *resource_impl;
+    struct vkd3d_meta_timing_scope timing_scope;
     struct vkd3d_clear_uav_info args;
     VkClearColorValue color;
 
@@ -10498,8 +12548,12 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewUint(d3
              * with the packed clear value and perform a buffer to image copy. */
             if (color.uint32[0] || color.uint32[1] || color.uint32[2] || color.uint32[3])
             {
+                /* The clear ends the render pass regardless, do it up front so the clear can be timed. */
+                d3d12_command_list_end_current_render_pass(list, false);
+                d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
                 d3d12_command_list_clear_uav_with_copy(list, resource_impl,
                         &args, &color, uint_format, rect_count, rects);
+                d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_CLEAR_UAV);
                 return;
             }
         }
@@ -10509,7 +12563,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewUint(d3
         vkd3d_mask_uint_clear_color(color.uint32, clear_format->vk_format);
     }
 
+    d3d12_command_list_end_current_render_pass(list, false);
+    d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
     d3d12_command_list_clear_uav(list, resource_impl, &args, &color, rect_count, rects);
+    d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_CLEAR_UAV);
 
     if (inline_view)
     {
@@ -10526,6 +12583,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewFloat(d
     struct d3d12_desc_split_metadata metadata;
     struct vkd3d_view *inline_view = NULL;
     struct d3d12_resource *resource_impl;
+    struct vkd3d_meta_timing_scope timing_scope;
     struct vkd3d_clear_uav_info args;
     VkClearColorValue color;
 
@@ -10562,7 +12620,11 @@ static void STDMETHODCALLTYPE d3d12_command_list_ClearUnorderedAccessViewFloat(d
         args.has_view = true;
     }
 
+    /* Clearing ends the render pass anyway. */
+    d3d12_command_list_end_current_render_pass(list, false);
+    d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
     d3d12_command_list_clear_uav(list, resource_impl, &args, &color, rect_count, rects);
+    d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_CLEAR_UAV);
 
     if (inline_view)
     {
@@ -10754,7 +12816,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_DiscardResource(d3d12_command_l
 }
 
 static void d3d12_command_list_resolve_binary_occlusion_queries(struct d3d12_command_list *list,
-        VkDeviceAddress src_va, VkDeviceAddress dst_va, uint32_t count);
+        const struct vkd3d_query_resolve_range *ranges, unsigned int range_count);
 
 static uint32_t vkd3d_query_lookup_entry_hash(const void *key)
 {
@@ -10843,57 +12905,180 @@ static void d3d12_command_list_add_query_lookup_range(struct d3d12_command_list
     }
 }
 
-static void d3d12_command_list_execute_query_resolve(struct d3d12_command_list *list,
-        const struct vkd3d_query_resolve_entry *entry)
+static void d3d12_command_list_flush_query_resolve_copies(struct d3d12_command_list *list,
+        VkCopyBufferInfo2 *copy_info, const struct d3d12_resource *dst_buffer)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
-    size_t stride = d3d12_query_heap_type_get_data_size(entry->query_heap->desc.Type);
-    VkCopyBufferInfo2 copy_info;
-    VkBufferCopy2 copy_region;
+    VkDeviceSize dst_begin, dst_end;
+    unsigned int i;
 
-    if (!d3d12_command_list_gather_pending_queries(list))
-    {
-        d3d12_command_list_mark_as_invalid(list, "Failed to gather virtual queries.\n");
+    if (!copy_info->regionCount)
         return;
-    }
 
-    if (entry->query_type != D3D12_QUERY_TYPE_BINARY_OCCLUSION)
+    dst_begin = copy_info->pRegions[0].dstOffset;
+    dst_end = dst_begin + copy_info->pRegions[0].size;
+
+    for (i = 1; i < copy_info->regionCount; i++)
     {
-        copy_region.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
-        copy_region.pNext = NULL;
-        copy_region.srcOffset = stride * entry->query_index;
-        copy_region.dstOffset = entry->dst_buffer->mem.offset + entry->dst_offset;
-        copy_region.size = stride * entry->query_count;
+        dst_begin = min(dst_begin, copy_info->pRegions[i].dstOffset);
+        dst_end = max(dst_end, copy_info->pRegions[i].dstOffset + copy_info->pRegions[i].size);
+    }
 
-        copy_info.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
-        copy_info.pNext = NULL;
-        copy_info.srcBuffer = entry->query_heap->vk_buffer;
-        copy_info.dstBuffer = entry->dst_buffer->res.vk_buffer;
-        copy_info.regionCount = 1;
-        copy_info.pRegions = &copy_region;
+    /* Track the combined range, regions within a single copy never overlap. */
+    d3d12_command_list_mark_copy_buffer_write(list, copy_info->dstBuffer, dst_begin, dst_end - dst_begin,
+            !!(dst_buffer->flags & VKD3D_RESOURCE_RESERVED));
+    VK_CALL(vkCmdCopyBuffer2(list->vk_command_buffer, copy_info));
 
-        d3d12_command_list_mark_copy_buffer_write(list, copy_info.dstBuffer, copy_region.dstOffset, copy_region.size,
-                !!(entry->dst_buffer->flags & VKD3D_RESOURCE_RESERVED));
-        VK_CALL(vkCmdCopyBuffer2(list->vk_command_buffer, &copy_info));
-    }
-    else
+    copy_info->regionCount = 0;
+}
+
+static bool vk_buffer_copy_regions_overlap_dst(const VkBufferCopy2 *regions, unsigned int count,
+        VkDeviceSize offset, VkDeviceSize size)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
     {
-        d3d12_command_list_resolve_binary_occlusion_queries(list,
-                entry->query_heap->va + entry->query_index * sizeof(uint64_t),
-                entry->dst_buffer->res.va + entry->dst_offset, entry->query_count);
+        if (offset < regions[i].dstOffset + regions[i].size && regions[i].dstOffset < offset + size)
+            return true;
     }
+
+    return false;
 }
 
 static void d3d12_command_list_flush_query_resolves(struct d3d12_command_list *list)
 {
+    struct vkd3d_query_resolve_range binary_ranges[VKD3D_QUERY_RESOLVE_MAX_BINARY_RANGES];
+    VkBufferCopy2 copy_regions[VKD3D_QUERY_RESOLVE_MAX_MERGED_COPIES];
+    VkDeviceAddress binary_dst_begin = 0, binary_dst_end = 0;
+    const struct vkd3d_query_resolve_entry *entry;
+    struct vkd3d_query_resolve_range *binary_range;
+    const struct d3d12_resource *copy_dst = NULL;
+    VkDeviceSize src_offset, dst_offset, size;
+    unsigned int binary_range_count = 0;
+    VkDeviceAddress dst_va, src_va;
+    VkCopyBufferInfo2 copy_info;
+    VkBufferCopy2 *region;
     unsigned int i;
+    size_t stride;
 
     if (!list->query_resolve_count)
         return;
 
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_QUERY_RESOLVE_FLUSH);
+
+    /* Inline query resolves can be recorded without ending a render pass first. */
+    d3d12_command_list_flush_deferred_barriers(list);
+
+    if (!d3d12_command_list_gather_pending_queries(list))
+    {
+        d3d12_command_list_mark_as_invalid(list, "Failed to gather virtual queries.\n");
+        goto done;
+    }
+
+    copy_info.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
+    copy_info.pNext = NULL;
+    copy_info.srcBuffer = VK_NULL_HANDLE;
+    copy_info.dstBuffer = VK_NULL_HANDLE;
+    copy_info.regionCount = 0;
+    copy_info.pRegions = copy_regions;
+
+    /* Resolves are recorded in API order, but consecutive resolves share
+     * copy commands and consecutive binary occlusion resolves share one dispatch,
+     * regardless of which query heap they come from. */
     for (i = 0; i < list->query_resolve_count; i++)
-        d3d12_command_list_execute_query_resolve(list, &list->query_resolves[i]);
+    {
+        entry = &list->query_resolves[i];
+
+        if (entry->query_type == D3D12_QUERY_TYPE_BINARY_OCCLUSION)
+        {
+            d3d12_command_list_flush_query_resolve_copies(list, &copy_info, copy_dst);
+
+            src_va = entry->query_heap->va + entry->query_index * sizeof(uint64_t);
+            dst_va = entry->dst_buffer->res.va + entry->dst_offset;
+            size = entry->query_count * sizeof(uint64_t);
+
+            /* Overlapping resolves need to be serialized like any other copy. */
+            if (binary_range_count && ((dst_va < binary_dst_end && binary_dst_begin < dst_va + size) ||
+                    binary_range_count == ARRAY_SIZE(binary_ranges)))
+            {
+                d3d12_command_list_resolve_binary_occlusion_queries(list, binary_ranges, binary_range_count);
+                binary_range_count = 0;
+            }
+
+            if (!binary_range_count)
+            {
+                binary_dst_begin = dst_va;
+                binary_dst_end = dst_va + size;
+            }
+
+            binary_dst_begin = min(binary_dst_begin, dst_va);
+            binary_dst_end = max(binary_dst_end, dst_va + size);
+
+            /* Resolving consecutive ranges of the same heap into consecutive memory is common. */
+            binary_range = binary_range_count ? &binary_ranges[binary_range_count - 1] : NULL;
+
+            if (binary_range && binary_range->src_va + binary_range->query_count * sizeof(uint64_t) == src_va &&
+                    binary_range->dst_va + binary_range->query_count * sizeof(uint64_t) == dst_va)
+            {
+                binary_range->query_count += entry->query_count;
+            }
+            else
+            {
+                binary_range = &binary_ranges[binary_range_count++];
+                binary_range->dst_va = dst_va;
+                binary_range->src_va = src_va;
+                binary_range->query_count = entry->query_count;
+                binary_range->padding = 0;
+            }
+            continue;
+        }
+
+        if (binary_range_count)
+        {
+            d3d12_command_list_resolve_binary_occlusion_queries(list, binary_ranges, binary_range_count);
+            binary_range_count = 0;
+        }
+
+        stride = d3d12_query_heap_type_get_data_size(entry->query_heap->desc.Type);
+        src_offset = stride * entry->query_index;
+        dst_offset = entry->dst_buffer->mem.offset + entry->dst_offset;
+        size = stride * entry->query_count;
+
+        if (copy_info.regionCount && (copy_info.srcBuffer != entry->query_heap->vk_buffer ||
+                copy_info.dstBuffer != entry->dst_buffer->res.vk_buffer ||
+                copy_info.regionCount == ARRAY_SIZE(copy_regions) ||
+                vk_buffer_copy_regions_overlap_dst(copy_regions, copy_info.regionCount, dst_offset, size)))
+            d3d12_command_list_flush_query_resolve_copies(list, &copy_info, copy_dst);
 
+        copy_info.srcBuffer = entry->query_heap->vk_buffer;
+        copy_info.dstBuffer = entry->dst_buffer->res.vk_buffer;
+        copy_dst = entry->dst_buffer;
+
+        /* Resolving consecutive ranges of the same heap is common, extend the previous region if possible. */
+        region = copy_info.regionCount ? &copy_regions[copy_info.regionCount - 1] : NULL;
+
+        if (region && region->srcOffset + region->size == src_offset && region->dstOffset + region->size == dst_offset)
+        {
+            region->size += size;
+        }
+        else
+        {
+            region = &copy_regions[copy_info.regionCount++];
+            region->sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
+            region->pNext = NULL;
+            region->srcOffset = src_offset;
+            region->dstOffset = dst_offset;
+            region->size = size;
+        }
+    }
+
+    d3d12_command_list_flush_query_resolve_copies(list, &copy_info, copy_dst);
+
+    if (binary_range_count)
+        d3d12_command_list_resolve_binary_occlusion_queries(list, binary_ranges, binary_range_count);
+
+done:
     list->query_resolve_count = 0;
 
     hash_map_clear(&list->query_resolve_lut);
@@ -11013,13 +13198,9 @@ static void STDMETHODCALLTYPE d3d12_command_list_EndQuery(d3d12_command_list_ifa
         FIXME("Unhandled query type %u.\n", type);
 }
 
-static void d3d12_command_list_resolve_binary_occlusion_queries(struct d3d12_command_list *list,
-        VkDeviceAddress src_va, VkDeviceAddress dst_va, uint32_t count)
+static void d3d12_command_list_begin_binary_occlusion_resolves(struct d3d12_command_list *list)
 {
-    const struct vkd3d_query_ops *query_ops = &list->device->meta_ops.query;
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
-    struct vkd3d_query_resolve_args args;
-    unsigned int workgroup_count;
     VkMemoryBarrier2 vk_barrier;
     VkDependencyInfo dep_info;
 
@@ -11044,10 +13225,15 @@ static void d3d12_command_list_resolve_binary_occlusion_queries(struct d3d12_com
     d3d12_command_list_reset_buffer_copy_tracking(list);
 
     VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+}
 
-    VK_CALL(vkCmdBindPipeline(list->vk_command_buffer,
-            VK_PIPELINE_BIND_POINT_COMPUTE,
-            query_ops->vk_resolve_binary_pipeline));
+static void d3d12_command_list_dispatch_binary_occlusion_resolve(struct d3d12_command_list *list,
+        VkDeviceAddress src_va, VkDeviceAddress dst_va, uint32_t count)
+{
+    const struct vkd3d_query_ops *query_ops = &list->device->meta_ops.query;
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct vkd3d_query_resolve_args args;
+    unsigned int workgroup_count;
 
     args.dst_va = dst_va;
     args.src_va = src_va;
@@ -11059,13 +13245,76 @@ static void d3d12_command_list_resolve_binary_occlusion_queries(struct d3d12_com
 
     workgroup_count = vkd3d_compute_workgroup_count(count, VKD3D_QUERY_OP_WORKGROUP_SIZE);
     VK_CALL(vkCmdDispatch(list->vk_command_buffer, workgroup_count, 1, 1));
+}
+
+static void d3d12_command_list_end_binary_occlusion_resolves(struct d3d12_command_list *list)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    VkMemoryBarrier2 vk_barrier;
+    VkDependencyInfo dep_info;
 
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.memoryBarrierCount = 1;
+    dep_info.pMemoryBarriers = &vk_barrier;
+
+    memset(&vk_barrier, 0, sizeof(vk_barrier));
+    vk_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
     vk_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
     vk_barrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
     vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
     vk_barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
 
-    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+    VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+}
+
+static void d3d12_command_list_resolve_binary_occlusion_queries(struct d3d12_command_list *list,
+        const struct vkd3d_query_resolve_range *ranges, unsigned int range_count)
+{
+    const struct vkd3d_query_ops *query_ops = &list->device->meta_ops.query;
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct vkd3d_query_resolve_batch_args args;
+    struct vkd3d_scratch_allocation scratch;
+    uint32_t max_query_count = 0;
+    unsigned int i;
+
+    d3d12_command_list_begin_binary_occlusion_resolves(list);
+
+    if (range_count > 1 && d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_UNIFORM_UPLOAD, range_count * sizeof(*ranges),
+            sizeof(*ranges), ~0u, &scratch))
+    {
+        memcpy(scratch.host_ptr, ranges, range_count * sizeof(*ranges));
+
+        for (i = 0; i < range_count; i++)
+            max_query_count = max(max_query_count, ranges[i].query_count);
+
+        args.ranges_va = scratch.va;
+        args.range_count = range_count;
+
+        VK_CALL(vkCmdBindPipeline(list->vk_command_buffer,
+                VK_PIPELINE_BIND_POINT_COMPUTE,
+                query_ops->vk_resolve_binary_batch_pipeline));
+        VK_CALL(vkCmdPushConstants(list->vk_command_buffer,
+                query_ops->vk_resolve_batch_pipeline_layout,
+                VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(args), &args));
+        VK_CALL(vkCmdDispatch(list->vk_command_buffer,
+                vkd3d_compute_workgroup_count(max_query_count, VKD3D_QUERY_OP_WORKGROUP_SIZE), range_count, 1));
+    }
+    else
+    {
+        VK_CALL(vkCmdBindPipeline(list->vk_command_buffer,
+                VK_PIPELINE_BIND_POINT_COMPUTE,
+                query_ops->vk_resolve_binary_pipeline));
+
+        for (i = 0; i < range_count; i++)
+        {
+            d3d12_command_list_dispatch_binary_occlusion_resolve(list,
+                    ranges[i].src_va, ranges[i].dst_va, ranges[i].query_count);
+        }
+    }
+
+    d3d12_command_list_end_binary_occlusion_resolves(list);
 }
 
 static void STDMETHODCALLTYPE d3d12_command_list_ResolveQueryData(d3d12_command_list_iface *iface,
@@ -11106,10 +13355,10 @@ static void STDMETHODCALLTYPE d3d12_command_list_ResolveQueryData(d3d12_command_
         entry.dst_buffer = buffer;
         entry.dst_offset = aligned_dst_buffer_offset;
 
-        if (list->rendering_info.state_flags & VKD3D_RENDERING_ACTIVE)
-            d3d12_command_list_add_query_resolve(list, &entry);
-        else
-            d3d12_command_list_execute_query_resolve(list, &entry);
+        /* Defer the resolve even outside a render pass so that resolves recorded back to back
+         * are flushed together. Anything which may consume the results ends the render pass,
+         * and reusing a query with a pending resolve flushes explicitly. */
+        d3d12_command_list_add_query_resolve(list, &entry);
     }
     else
     {
@@ -11135,6 +13384,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(d3d12_command_li
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     const struct vkd3d_predicate_ops *predicate_ops = &list->device->meta_ops.predicate;
     struct vkd3d_predicate_resolve_args resolve_args;
+    struct vkd3d_meta_timing_scope timing_scope;
     VkConditionalRenderingBeginInfoEXT begin_info;
     struct vkd3d_scratch_allocation scratch;
     VkMemoryBarrier2 vk_barrier;
@@ -11167,6 +13417,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(d3d12_command_li
         /* Resolve 64-bit predicate into a 32-bit location so that this works with
          * VK_EXT_conditional_rendering. We'll handle the predicate operation here
          * so setting VK_CONDITIONAL_RENDERING_INVERTED_BIT_EXT is not necessary. */
+        d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
         d3d12_command_list_invalidate_current_pipeline(list, true);
         d3d12_command_list_invalidate_root_parameters(list, &list->compute_bindings, true);
 
@@ -11193,9 +13444,12 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(d3d12_command_li
         }
         else
         {
-            vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-            vk_barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+            /* Predicated draws read the resolved predicate directly as their draw count. */
+            vk_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+            vk_barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
             list->predicate_va = scratch.va;
+            list->predicate_vk_buffer = scratch.buffer;
+            list->predicate_vk_offset = scratch.offset;
         }
 
         memset(&dep_info, 0, sizeof(dep_info));
@@ -11204,6 +13458,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(d3d12_command_li
         dep_info.pMemoryBarriers = &vk_barrier;
 
         VK_CALL(vkCmdPipelineBarrier2(list->vk_command_buffer, &dep_info));
+        d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_PREDICATION);
 
         if (list->predicate_enabled)
             VK_CALL(vkCmdBeginConditionalRenderingEXT(list->vk_command_buffer, &begin_info));
@@ -11212,6 +13467,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPredication(d3d12_command_li
     {
         list->predicate_enabled = false;
         list->predicate_va = 0;
+        list->predicate_vk_buffer = VK_NULL_HANDLE;
+        list->predicate_vk_offset = 0;
     }
 }
 
@@ -11410,6 +13667,13 @@ static HRESULT d3d12_command_signature_allocate_preprocess_memory_for_list(
         uint32_t max_command_count,
         struct vkd3d_scratch_allocation *allocation, VkDeviceSize *size);
 
+static bool d3d12_command_signature_acquire_cached_stream(struct d3d12_command_signature *signature,
+        uint32_t max_command_count,
+        struct d3d12_resource *arg_buffer, UINT64 arg_buffer_offset,
+        struct d3d12_resource *count_buffer, UINT64 count_buffer_offset,
+        struct vkd3d_scratch_allocation *stream_allocation,
+        struct vkd3d_scratch_allocation *count_allocation, bool *needs_patch);
+
 static void d3d12_command_list_execute_indirect_state_template_compute(
         struct d3d12_command_list *list, struct d3d12_command_signature *signature,
         uint32_t max_command_count,
@@ -11419,6 +13683,7 @@ static void d3d12_command_list_execute_indirect_state_template_compute(
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     VkDeviceAddress arg_va = arg_buffer->res.va + arg_buffer_offset;
     struct vkd3d_scratch_allocation dispatch_scratch, ubo_scratch;
+    struct vkd3d_meta_timing_scope timing_scope;
     VkDeviceAddress count_va = 0;
     VkWriteDescriptorSet write;
     VkDescriptorBufferInfo buf;
@@ -11432,13 +13697,15 @@ static void d3d12_command_list_execute_indirect_state_template_compute(
     if (count_buffer)
         count_va = count_buffer->res.va + count_buffer_offset;
 
+    d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
     if (!d3d12_command_list_emit_multi_dispatch_indirect_count_state(list,
             signature,
             arg_va, signature->desc.ByteStride, max_command_count,
             count_va, &dispatch_scratch, &ubo_scratch))
         return;
+    d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope, VKD3D_META_TIMING_EXECUTE_INDIRECT);
 
-    if (!d3d12_command_list_update_compute_state(list))
+    if (!d3d12_command_list_update_compute_state(list, false))
     {
         WARN("Failed to update compute state, ignoring dispatch.\n");
         return;
@@ -11501,6 +13768,84 @@ static void d3d12_command_list_execute_indirect_state_template_compute(
     /* No need to implicitly invalidate anything here, since we used the normal APIs. */
 }
 
+/* Below this, the extra dispatch and barrier are not worth it compared to just
+ * letting the generated commands skip empty draws. */
+#define VKD3D_EXECUTE_INDIRECT_COMPACTION_MIN_COMMAND_COUNT 64
+
+static bool d3d12_command_list_emit_execute_indirect_compaction(struct d3d12_command_list *list,
+        VkCommandBuffer vk_cmd_buffer, struct d3d12_command_signature *signature,
+        uint32_t max_command_count, struct vkd3d_execute_indirect_args *patch_args)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct vkd3d_execute_indirect_compact_args args;
+    struct vkd3d_scratch_allocation index_allocation;
+    struct vkd3d_scratch_allocation count_allocation;
+    struct vkd3d_multi_dispatch_indirect_info info;
+    VkDependencyInfo dep_info;
+    VkMemoryBarrier2 barrier;
+
+    switch (signature->desc.pArgumentDescs[signature->desc.NumArgumentDescs - 1].Type)
+    {
+        case D3D12_INDIRECT_ARGUMENT_TYPE_DRAW:
+        case D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED:
+            /* Vertex or index count, and instance count. */
+            args.action_word_count = 2;
+            break;
+
+        case D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH_MESH:
+            args.action_word_count = 3;
+            break;
+
+        default:
+            return false;
+    }
+
+    if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_DEVICE_STORAGE,
+            max_command_count * sizeof(uint32_t), sizeof(uint32_t), ~0u, &index_allocation) ||
+            !d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_DEVICE_STORAGE,
+            sizeof(uint32_t), sizeof(uint32_t), ~0u, &count_allocation))
+    {
+        WARN("Failed to allocate compaction memory.\n");
+        return false;
+    }
+
+    args.indirect_va = patch_args->api_buffer_va;
+    args.count_va = patch_args->indirect_count_va;
+    args.sequence_indices_va = index_allocation.va;
+    args.sequence_count_va = count_allocation.va;
+    args.stride_words = patch_args->api_buffer_word_stride;
+    args.action_offset_words = signature->argument_buffer_offset / sizeof(uint32_t);
+    args.max_commands = max_command_count;
+
+    vkd3d_meta_get_execute_indirect_compact_pipeline(&list->device->meta_ops, &info);
+
+    VK_CALL(vkCmdBindPipeline(vk_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, info.vk_pipeline));
+    VK_CALL(vkCmdPushConstants(vk_cmd_buffer, info.vk_pipeline_layout,
+            VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(args), &args));
+    /* A single workgroup walks the whole stream so that the output stays in API order. */
+    VK_CALL(vkCmdDispatch(vk_cmd_buffer, 1, 1, 1));
+
+    memset(&barrier, 0, sizeof(barrier));
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.memoryBarrierCount = 1;
+    dep_info.pMemoryBarriers = &barrier;
+    VK_CALL(vkCmdPipelineBarrier2(vk_cmd_buffer, &dep_info));
+
+    /* The patcher now reads the compacted count, and forwards it to the generated commands as usual. */
+    patch_args->indirect_count_va = count_allocation.va;
+    patch_args->sequence_indices_va = index_allocation.va;
+    return true;
+}
+
 static void d3d12_command_list_execute_indirect_state_template_graphics(
         struct d3d12_command_list *list, struct d3d12_command_signature *signature,
         uint32_t max_command_count,
@@ -11513,6 +13858,7 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
     struct vkd3d_scratch_allocation stream_allocation;
     struct vkd3d_scratch_allocation count_allocation;
     struct vkd3d_execute_indirect_args patch_args;
+    struct vkd3d_meta_timing_scope timing_scope;
     VkGeneratedCommandsInfoNV generated;
     VkCommandBuffer vk_patch_cmd_buffer;
     VkIndirectCommandsStreamNV stream;
@@ -11520,8 +13866,10 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
     VkPipeline current_pipeline;
     VkDependencyInfo dep_info;
     VkMemoryBarrier2 barrier;
+    bool require_patch_dispatch;
     bool require_ibo_update;
     bool require_patch;
+    bool compact;
     unsigned int i;
     HRESULT hr;
 
@@ -11570,7 +13918,22 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
         require_patch = true;
     }
 
-    if (require_patch)
+    /* With a count buffer, apps commonly allocate for the worst case and leave most commands
+     * zeroed out, e.g. after GPU culling. Compacting the live commands up front means the
+     * generated command stream and its preprocessing only scale with the useful work.
+     * Dropping commands is fine since every command rewrites the same state anyway,
+     * and that state is reset after ExecuteIndirect. */
+    compact = count_buffer && max_command_count >= VKD3D_EXECUTE_INDIRECT_COMPACTION_MIN_COMMAND_COUNT &&
+            !patch_args.debug_tag;
+    if (compact)
+        require_patch = true;
+
+    require_patch_dispatch = require_patch;
+
+    /* If the same arguments were patched before and have not been rewritten since, reuse the stream as-is. */
+    if (require_patch && !d3d12_command_signature_acquire_cached_stream(signature, max_command_count,
+            arg_buffer, arg_buffer_offset, count_buffer, count_buffer_offset,
+            &stream_allocation, &count_allocation, &require_patch_dispatch))
     {
         if (FAILED(hr = d3d12_command_signature_allocate_stream_memory_for_list(
                 list, signature, max_command_count, &stream_allocation)))
@@ -11591,7 +13954,10 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
                 return;
             }
         }
+    }
 
+    if (require_patch_dispatch)
+    {
         patch_args.template_va = signature->state_template.graphics.buffer_va;
         patch_args.api_buffer_va = arg_buffer->res.va + arg_buffer_offset;
         patch_args.device_generated_commands_va = stream_allocation.va;
@@ -11638,6 +14004,19 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
             d3d12_command_list_invalidate_current_pipeline(list, true);
         }
 
+        /* Only time the patch when it lands in the command buffer proper, timestamps in the
+         * init command buffer would execute ahead of the batched query resets. */
+        if (vk_patch_cmd_buffer == list->vk_command_buffer)
+            d3d12_command_list_begin_meta_timing(list, vk_patch_cmd_buffer, &timing_scope);
+        else
+            timing_scope.vk_query_pool = VK_NULL_HANDLE;
+
+        if (compact)
+        {
+            d3d12_command_list_emit_execute_indirect_compaction(list, vk_patch_cmd_buffer,
+                    signature, max_command_count, &patch_args);
+        }
+
         VK_CALL(vkCmdPushConstants(vk_patch_cmd_buffer, signature->state_template.graphics.pipeline.vk_pipeline_layout,
                 VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(patch_args), &patch_args));
         VK_CALL(vkCmdBindPipeline(vk_patch_cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
@@ -11647,6 +14026,7 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
          * to restrict the patching work to just the indirect count, but meh, just more barriers.
          * We'll nop out the workgroup early based on direct count, and the number of threads should be trivial either way. */
         VK_CALL(vkCmdDispatch(vk_patch_cmd_buffer, max_command_count, 1, 1));
+        d3d12_command_list_end_meta_timing(list, vk_patch_cmd_buffer, &timing_scope, VKD3D_META_TIMING_EXECUTE_INDIRECT);
 
         if (vk_patch_cmd_buffer == list->vk_command_buffer)
         {
@@ -11718,7 +14098,7 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
         stream.offset = arg_buffer->mem.offset + arg_buffer_offset;
     }
 
-    if (require_patch)
+    if (require_patch_dispatch && !compact)
         WARN("Template requires patching :(\n");
 
     VK_CALL(vkCmdExecuteGeneratedCommandsNV(list->vk_command_buffer, VK_FALSE, &generated));
@@ -11777,6 +14157,150 @@ static void d3d12_command_list_execute_indirect_state_template_graphics(
     d3d12_command_list_invalidate_all_state(list);
 }
 
+static void d3d12_command_list_execute_indirect_state_template_ext(
+        struct d3d12_command_list *list, struct d3d12_command_signature *signature,
+        uint32_t max_command_count,
+        struct d3d12_resource *arg_buffer, UINT64 arg_buffer_offset,
+        struct d3d12_resource *count_buffer, UINT64 count_buffer_offset)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct vkd3d_scratch_allocation preprocess_allocation;
+    VkGeneratedCommandsPipelineInfoEXT pipeline_info;
+    struct vkd3d_pipeline_bindings *bindings;
+    VkGeneratedCommandsInfoEXT generated;
+    VkDeviceSize preprocess_size;
+    bool require_ibo_update;
+    unsigned int i;
+    HRESULT hr;
+
+    require_ibo_update = false;
+
+    if (signature->pipeline_type == VKD3D_PIPELINE_TYPE_COMPUTE)
+    {
+        bindings = &list->compute_bindings;
+
+        d3d12_command_list_end_transfer_batch(list);
+
+        if (!d3d12_command_list_update_compute_state(list, false))
+        {
+            WARN("Failed to update compute state, ignoring dispatch.\n");
+            return;
+        }
+    }
+    else
+    {
+        bindings = &list->graphics_bindings;
+
+        /* To build device generated commands, we need to know the pipeline we're going to render with. */
+        if (!d3d12_command_list_update_graphics_pipeline(list, signature->pipeline_type))
+            return;
+
+        for (i = 0; i < signature->desc.NumArgumentDescs; i++)
+        {
+            if (signature->desc.pArgumentDescs[i].Type == D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW)
+            {
+                require_ibo_update = true;
+                break;
+            }
+        }
+    }
+
+    if (FAILED(hr = d3d12_command_signature_allocate_preprocess_memory_for_list_ext(
+            list, signature, list->current_pipeline,
+            max_command_count, &preprocess_allocation, &preprocess_size)))
+    {
+        WARN("Failed to allocate preprocess memory.\n");
+        return;
+    }
+
+    if (signature->pipeline_type != VKD3D_PIPELINE_TYPE_COMPUTE)
+    {
+        if (!d3d12_command_list_begin_render_pass(list, signature->pipeline_type))
+        {
+            WARN("Failed to begin render pass, ignoring draw.\n");
+            return;
+        }
+
+        if (!require_ibo_update &&
+                signature->desc.pArgumentDescs[signature->desc.NumArgumentDescs - 1].Type ==
+                        D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED &&
+                !d3d12_command_list_update_index_buffer(list))
+        {
+            return;
+        }
+    }
+
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GENERATED_COMMANDS_PIPELINE_INFO_EXT;
+    pipeline_info.pNext = NULL;
+    pipeline_info.pipeline = list->current_pipeline;
+
+    generated.sType = VK_STRUCTURE_TYPE_GENERATED_COMMANDS_INFO_EXT;
+    generated.pNext = &pipeline_info;
+    generated.shaderStages = signature->state_template.ext.stages;
+    generated.indirectExecutionSet = VK_NULL_HANDLE;
+    generated.indirectCommandsLayout = signature->state_template.ext.layout;
+    generated.indirectAddress = arg_buffer->res.va + arg_buffer_offset;
+    generated.indirectAddressSize = min((VkDeviceSize)max_command_count * signature->desc.ByteStride,
+            arg_buffer->desc.Width - arg_buffer_offset);
+    generated.preprocessAddress = preprocess_allocation.va;
+    generated.preprocessSize = preprocess_size;
+    generated.maxSequenceCount = max_command_count;
+    generated.sequenceCountAddress = count_buffer ? count_buffer->res.va + count_buffer_offset : 0;
+    generated.maxDrawCount = 0;
+
+    /* The argument buffer is consumed in place with implicit preprocessing, which is covered
+     * by the regular INDIRECT_ARGUMENT state, so no extra barriers are needed. */
+    VK_CALL(vkCmdExecuteGeneratedCommandsEXT(list->vk_command_buffer, VK_FALSE, &generated));
+
+    /* Need to clear state to zero if it was part of a command signature. */
+    for (i = 0; i < signature->desc.NumArgumentDescs; i++)
+    {
+        const D3D12_INDIRECT_ARGUMENT_DESC *arg = &signature->desc.pArgumentDescs[i];
+        switch (arg->Type)
+        {
+            case D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW:
+                /* Null IBO */
+                list->index_buffer.buffer = VK_NULL_HANDLE;
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW:
+            {
+                /* Null VBO */
+                uint32_t slot = arg->VertexBuffer.Slot;
+                list->dynamic_state.vertex_buffers[slot] = VK_NULL_HANDLE;
+                list->dynamic_state.vertex_strides[slot] = 0;
+                list->dynamic_state.vertex_offsets[slot] = 0;
+                list->dynamic_state.vertex_sizes[slot] = 0;
+                break;
+            }
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW:
+            case D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW:
+            case D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW:
+                d3d12_command_list_set_root_descriptor(list, bindings,
+                        arg->ConstantBufferView.RootParameterIndex, 0);
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT:
+            {
+                uint32_t zeroes[D3D12_MAX_ROOT_COST];
+                memset(zeroes, 0, sizeof(uint32_t) * arg->Constant.Num32BitValuesToSet);
+                d3d12_command_list_set_root_constants(list, bindings,
+                        arg->Constant.RootParameterIndex,
+                        arg->Constant.DestOffsetIn32BitValues,
+                        arg->Constant.Num32BitValuesToSet, zeroes);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    /* All state related to the bind point is undefined after executing generated commands. */
+    d3d12_command_list_invalidate_all_state(list);
+}
+
 static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_list_iface *iface,
         ID3D12CommandSignature *command_signature, UINT max_command_count, ID3D12Resource *arg_buffer,
         UINT64 arg_buffer_offset, ID3D12Resource *count_buffer, UINT64 count_buffer_offset)
@@ -11787,6 +14311,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList(iface);
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
     const D3D12_COMMAND_SIGNATURE_DESC *signature_desc = &sig_impl->desc;
+    struct vkd3d_meta_timing_scope timing_scope;
     struct vkd3d_scratch_allocation scratch;
     uint32_t unrolled_stride;
     unsigned int i;
@@ -11820,7 +14345,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
         if (list->predicate_va)
             FIXME("Predicated ExecuteIndirect with state template not supported yet. Ignoring predicate.\n");
 
-        if (sig_impl->pipeline_type == VKD3D_PIPELINE_TYPE_GRAPHICS ||
+        if (sig_impl->uses_ext_state_template)
+        {
+            d3d12_command_list_execute_indirect_state_template_ext(list, sig_impl,
+                    max_command_count,
+                    arg_impl, arg_buffer_offset,
+                    count_impl, count_buffer_offset);
+        }
+        else if (sig_impl->pipeline_type == VKD3D_PIPELINE_TYPE_GRAPHICS ||
                 sig_impl->pipeline_type == VKD3D_PIPELINE_TYPE_MESH_GRAPHICS)
         {
             d3d12_command_list_execute_indirect_state_template_graphics(list, sig_impl,
@@ -11848,7 +14380,16 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
     {
         const D3D12_INDIRECT_ARGUMENT_DESC *arg_desc = &signature_desc->pArgumentDescs[i];
 
-        if (list->predicate_va)
+        if (list->predicate_va && !count_buffer && max_command_count == 1 &&
+                (arg_desc->Type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW ||
+                arg_desc->Type == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED))
+        {
+            /* The resolved predicate is already the draw count we need. */
+            scratch.buffer = list->predicate_vk_buffer;
+            scratch.offset = list->predicate_vk_offset;
+            scratch.va = list->predicate_va;
+        }
+        else if (list->predicate_va)
         {
             union vkd3d_predicate_command_direct_args args;
             enum vkd3d_predicate_command_type type;
@@ -11891,11 +14432,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
              * Can use this path for indirect trace rays as well since as needed. */
             if (arg_desc->Type == D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH)
             {
+                d3d12_command_list_begin_meta_timing(list, list->vk_command_buffer, &timing_scope);
                 if (!d3d12_command_list_emit_multi_dispatch_indirect_count(list,
                         arg_impl->res.va + arg_buffer_offset,
                         unrolled_stride, max_command_count,
                         count_impl->res.va + count_buffer_offset, &scratch))
                     return;
+                d3d12_command_list_end_meta_timing(list, list->vk_command_buffer, &timing_scope,
+                        VKD3D_META_TIMING_EXECUTE_INDIRECT);
 
                 unrolled_stride = sizeof(VkDispatchIndirectCommand);
             }
@@ -11923,6 +14467,9 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
                     break;
                 }
 
+                /* The GPU decides how many draws this turns into, count the indirect command itself. */
+                d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DRAW);
+
                 if (count_buffer || list->predicate_va)
                 {
                     VK_CALL(vkCmdDrawIndirectCount(list->vk_command_buffer, arg_impl->res.vk_buffer,
@@ -11948,6 +14495,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
 
                 d3d12_command_list_check_index_buffer_strip_cut_value(list);
 
+                d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DRAW);
+
                 if (count_buffer || list->predicate_va)
                 {
                     VK_CALL(vkCmdDrawIndexedIndirectCount(list->vk_command_buffer, arg_impl->res.vk_buffer,
@@ -11968,6 +14517,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
                     break;
                 }
 
+                d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DRAW);
+
                 if (count_buffer || list->predicate_va)
                 {
                     VK_CALL(vkCmdDrawMeshTasksIndirectCountEXT(list->vk_command_buffer, arg_impl->res.vk_buffer,
@@ -11982,12 +14533,14 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
                 break;
 
             case D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH:
-                if (!d3d12_command_list_update_compute_state(list))
+                if (!d3d12_command_list_update_compute_state(list, false))
                 {
                     WARN("Failed to update compute state, ignoring dispatch.\n");
                     break;
                 }
 
+                d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DISPATCH);
+
                 /* Without state changes, we can always just unroll the dispatches.
                  * Not the most useful feature ever, but it has to work. */
                 for (i = 0; i < max_command_count; i++)
@@ -12021,6 +14574,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteIndirect(d3d12_command_l
                     break;
                 }
 
+                d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DISPATCH);
                 VK_CALL(vkCmdTraceRaysIndirect2KHR(list->vk_command_buffer, scratch.va));
                 break;
 
@@ -12266,6 +14820,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_WriteBufferImmediate(d3d12_comm
         {
             batch_entry = list->wbi_batch.batch_len++;
 
+            list->wbi_batch.vas[batch_entry] = parameters[i].Dest;
             list->wbi_batch.buffers[batch_entry] = resource->vk_buffer;
             list->wbi_batch.offsets[batch_entry] = offset;
             list->wbi_batch.stages[batch_entry] = stage;
@@ -12336,13 +14891,101 @@ static void STDMETHODCALLTYPE d3d12_command_list_ExecuteMetaCommand(d3d12_comman
             iface, meta_command, parameter_data, parameter_size);
 }
 
+static void d3d12_command_list_discard_rtas_batch(struct d3d12_command_list *list)
+{
+    size_t i;
+
+    for (i = 0; i < list->rtas_batch.build_count; i++)
+        vkd3d_acceleration_structure_build_info_cleanup(&list->rtas_batch.build_infos[i]);
+    list->rtas_batch.build_count = 0;
+
+    /* Vulkan has consumed all build inputs by now. */
+    if (list->rtas_batch.arena)
+        vkd3d_acceleration_structure_build_arena_reset(list->rtas_batch.arena);
+}
+
+static void d3d12_command_list_flush_rtas_batch(struct d3d12_command_list *list)
+{
+    const VkAccelerationStructureBuildRangeInfoKHR *range_ptrs[VKD3D_RTAS_BUILD_BATCH_SIZE];
+    VkAccelerationStructureBuildGeometryInfoKHR geometry_infos[VKD3D_RTAS_BUILD_BATCH_SIZE];
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    struct d3d12_rtas_batch_state *batch = &list->rtas_batch;
+    size_t i;
+
+    if (!batch->build_count)
+        return;
+
+    for (i = 0; i < batch->build_count; i++)
+    {
+        geometry_infos[i] = batch->build_infos[i].build_info;
+        /* Ranges for all geometries of one build are contiguous. */
+        range_ptrs[i] = batch->build_infos[i].build_range_ptrs[0];
+    }
+
+    VK_CALL(vkCmdBuildAccelerationStructuresKHR(list->vk_command_buffer, batch->build_count,
+            geometry_infos, range_ptrs));
+
+    d3d12_command_list_discard_rtas_batch(list);
+}
+
+static bool d3d12_command_list_rtas_batch_conflicts(const struct d3d12_command_list *list,
+        VkAccelerationStructureKHR vk_dst, VkAccelerationStructureKHR vk_src, VkDeviceAddress scratch_va)
+{
+    const struct d3d12_rtas_batch_state *batch = &list->rtas_batch;
+    const VkAccelerationStructureBuildGeometryInfoKHR *pending;
+    size_t i;
+
+    /* Builds within one call must not alias. D3D12 requires a barrier in these cases as well,
+     * but rather than tripping over broken apps, keep them in separate calls like before. */
+    for (i = 0; i < batch->build_count; i++)
+    {
+        pending = &batch->build_infos[i].build_info;
+
+        if ((vk_dst && pending->dstAccelerationStructure == vk_dst) ||
+                (vk_src && pending->dstAccelerationStructure == vk_src) ||
+                (pending->srcAccelerationStructure && pending->srcAccelerationStructure == vk_dst) ||
+                batch->scratch_vas[i] == scratch_va)
+            return true;
+    }
+
+    return false;
+}
+
+static struct vkd3d_acceleration_structure_build_info *d3d12_command_list_allocate_rtas_batch_entry(
+        struct d3d12_command_list *list, VkAccelerationStructureKHR vk_dst, VkAccelerationStructureKHR vk_src,
+        VkDeviceAddress scratch_va)
+{
+    struct d3d12_rtas_batch_state *batch = &list->rtas_batch;
+
+    /* Breadcrumbs want to observe every build individually. */
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_BREADCRUMBS)
+        return NULL;
+
+    if (!batch->build_infos && !(batch->build_infos = vkd3d_calloc(VKD3D_RTAS_BUILD_BATCH_SIZE,
+            sizeof(*batch->build_infos))))
+        return NULL;
+    if (!batch->arena && !(batch->arena = vkd3d_calloc(1, sizeof(*batch->arena))))
+        return NULL;
+
+    if (batch->build_count == VKD3D_RTAS_BUILD_BATCH_SIZE ||
+            d3d12_command_list_rtas_batch_conflicts(list, vk_dst, vk_src, scratch_va))
+        d3d12_command_list_flush_rtas_batch(list);
+
+    /* Slots are never moved, since build infos point into themselves. */
+    batch->scratch_vas[batch->build_count] = scratch_va;
+    return &batch->build_infos[batch->build_count];
+}
+
 static void STDMETHODCALLTYPE d3d12_command_list_BuildRaytracingAccelerationStructure(d3d12_command_list_iface *iface,
         const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC *desc, UINT num_postbuild_info_descs,
         const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC *postbuild_info_descs)
 {
     struct d3d12_command_list *list = impl_from_ID3D12GraphicsCommandList(iface);
     const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
-    struct vkd3d_acceleration_structure_build_info build_info;
+    VkAccelerationStructureKHR vk_dst = VK_NULL_HANDLE, vk_src = VK_NULL_HANDLE;
+    struct vkd3d_acceleration_structure_build_info local_build_info;
+    struct vkd3d_acceleration_structure_build_info *build_info;
+    bool batched;
 
     TRACE("iface %p, desc %p, num_postbuild_info_descs %u, postbuild_info_descs %p\n",
             iface, desc, num_postbuild_info_descs, postbuild_info_descs);
@@ -12353,44 +14996,64 @@ static void STDMETHODCALLTYPE d3d12_command_list_BuildRaytracingAccelerationStru
         return;
     }
 
-    if (!vkd3d_acceleration_structure_convert_inputs(list->device, &build_info, &desc->Inputs))
-    {
-        ERR("Failed to convert inputs.\n");
-        return;
-    }
-
     if (desc->DestAccelerationStructureData)
     {
-        build_info.build_info.dstAccelerationStructure =
-                vkd3d_va_map_place_acceleration_structure(&list->device->memory_allocator.va_map,
-                        list->device, desc->DestAccelerationStructureData);
-        if (build_info.build_info.dstAccelerationStructure == VK_NULL_HANDLE)
+        vk_dst = vkd3d_va_map_place_acceleration_structure(&list->device->memory_allocator.va_map,
+                list->device, desc->DestAccelerationStructureData);
+        if (vk_dst == VK_NULL_HANDLE)
         {
             ERR("Failed to place destAccelerationStructure. Dropping call.\n");
             return;
         }
     }
 
-    if (build_info.build_info.mode == VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR &&
+    if ((desc->Inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE) &&
             desc->SourceAccelerationStructureData)
     {
-        build_info.build_info.srcAccelerationStructure =
-                vkd3d_va_map_place_acceleration_structure(&list->device->memory_allocator.va_map,
-                        list->device, desc->SourceAccelerationStructureData);
-        if (build_info.build_info.srcAccelerationStructure == VK_NULL_HANDLE)
+        vk_src = vkd3d_va_map_place_acceleration_structure(&list->device->memory_allocator.va_map,
+                list->device, desc->SourceAccelerationStructureData);
+        if (vk_src == VK_NULL_HANDLE)
         {
             ERR("Failed to place srcAccelerationStructure. Dropping call.\n");
             return;
         }
     }
 
-    build_info.build_info.scratchData.deviceAddress = desc->ScratchAccelerationStructureData;
-
     d3d12_command_list_end_current_render_pass(list, true);
-    d3d12_command_list_end_transfer_batch(list);
+    /* Only flush pending copies here, since that also flushes the RTAS batch. */
+    if (list->transfer_batch.batch_type != VKD3D_BATCH_TYPE_NONE)
+        d3d12_command_list_end_transfer_batch(list);
+
+    build_info = d3d12_command_list_allocate_rtas_batch_entry(list,
+            vk_dst, vk_src, desc->ScratchAccelerationStructureData);
+    batched = !!build_info;
+    if (!batched)
+        build_info = &local_build_info;
+
+    if (!vkd3d_acceleration_structure_convert_inputs(list->device, build_info, &desc->Inputs,
+            batched ? list->rtas_batch.arena : NULL))
+    {
+        ERR("Failed to convert inputs.\n");
+        return;
+    }
 
-    VK_CALL(vkCmdBuildAccelerationStructuresKHR(list->vk_command_buffer, 1,
-            &build_info.build_info, build_info.build_range_ptrs));
+    build_info->build_info.dstAccelerationStructure = vk_dst;
+    build_info->build_info.srcAccelerationStructure = vk_src;
+    build_info->build_info.scratchData.deviceAddress = desc->ScratchAccelerationStructureData;
+
+    if (batched)
+    {
+        list->rtas_batch.build_count++;
+
+        /* Postbuild info has to observe the build. */
+        if (num_postbuild_info_descs)
+            d3d12_command_list_flush_rtas_batch(list);
+    }
+    else
+    {
+        VK_CALL(vkCmdBuildAccelerationStructuresKHR(list->vk_command_buffer, 1,
+                &build_info->build_info, build_info->build_range_ptrs));
+    }
 
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     VKD3D_BREADCRUMB_TAG("RTAS build [Dest VA, Source VA, Scratch VA]");
@@ -12400,6 +15063,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_BuildRaytracingAccelerationStru
     VKD3D_BREADCRUMB_TAG((desc->Inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE) ?
             "Update" : "Create");
     VKD3D_BREADCRUMB_TAG(desc->Inputs.Type == D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL ? "Top" : "Bottom");
+    /* Batched builds are only possible without breadcrumbs, and must not be modified here. */
+    if (!batched)
     {
         VkAccelerationStructureBuildSizesInfoKHR size_info;
 
@@ -12408,12 +15073,12 @@ static void STDMETHODCALLTYPE d3d12_command_list_BuildRaytracingAccelerationStru
 
         if (desc->Inputs.Flags & D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE)
         {
-            build_info.build_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-            build_info.build_info.flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+            build_info->build_info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+            build_info->build_info.flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
         }
         VK_CALL(vkGetAccelerationStructureBuildSizesKHR(list->device->vk_device,
-                VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &build_info.build_info,
-                build_info.primitive_counts, &size_info));
+                VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &build_info->build_info,
+                build_info->primitive_counts, &size_info));
         VKD3D_BREADCRUMB_TAG("Build requirements [Size, Build Scratch, Update Scratch]");
         VKD3D_BREADCRUMB_AUX64(size_info.accelerationStructureSize);
         VKD3D_BREADCRUMB_AUX64(size_info.buildScratchSize);
@@ -12461,13 +15126,13 @@ static void STDMETHODCALLTYPE d3d12_command_list_BuildRaytracingAccelerationStru
     }
 #endif
 
-    vkd3d_acceleration_structure_build_info_cleanup(&build_info);
+    if (!batched)
+        vkd3d_acceleration_structure_build_info_cleanup(build_info);
 
     if (num_postbuild_info_descs)
     {
         vkd3d_acceleration_structure_emit_immediate_postbuild_info(list,
-                num_postbuild_info_descs, postbuild_info_descs,
-                build_info.build_info.dstAccelerationStructure);
+                num_postbuild_info_descs, postbuild_info_descs, vk_dst);
     }
 
     VKD3D_BREADCRUMB_COMMAND(BUILD_RTAS);
@@ -12488,6 +15153,7 @@ static void STDMETHODCALLTYPE d3d12_command_list_EmitRaytracingAccelerationStruc
     }
 
     d3d12_command_list_end_current_render_pass(list, true);
+    d3d12_command_list_flush_rtas_batch(list);
     vkd3d_acceleration_structure_emit_postbuild_info(list,
             desc, num_acceleration_structures, src_data);
 
@@ -12551,8 +15217,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_SetPipelineState1(d3d12_command
         for (i = 0; i < state->breadcrumb_shaders_count; i++)
         {
             cmd.type = VKD3D_BREADCRUMB_COMMAND_SET_SHADER_HASH;
-            cmd.shader.stage = state->breadcrumb_shaders[i].stage;
-            cmd.shader.hash = state->breadcrumb_shaders[i].hash;
+            cmd.shader_stage = state->breadcrumb_shaders[i].stage;
+            cmd.shader_hash = state->breadcrumb_shaders[i].hash;
             vkd3d_breadcrumb_tracer_add_command(list, &cmd);
 
             VKD3D_BREADCRUMB_TAG(state->breadcrumb_shaders[i].name);
@@ -12604,6 +15270,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_DispatchRays(d3d12_command_list
         return;
     }
 
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DISPATCH);
+
     /* TODO: Is DispatchRays predicated? */
     VK_CALL(vkCmdTraceRaysKHR(list->vk_command_buffer,
             &raygen_table, &miss_table, &hit_table, &callable_table,
@@ -12746,6 +15414,8 @@ static void STDMETHODCALLTYPE d3d12_command_list_DispatchMesh(d3d12_command_list
         return;
     }
 
+    d3d12_command_list_count_stat(list, VKD3D_COMMAND_LIST_STAT_DRAW);
+
     if (!list->predicate_va)
         VK_CALL(vkCmdDrawMeshTasksEXT(list->vk_command_buffer, x, y, z));
     else
@@ -12884,9 +15554,7 @@ VKD3D_DECLARE_D3D12_GRAPHICS_COMMAND_LIST_VARIANT(embedded_64_16, embedded_64_16
 VKD3D_DECLARE_D3D12_GRAPHICS_COMMAND_LIST_VARIANT(embedded_32_16, embedded_32_16);
 VKD3D_DECLARE_D3D12_GRAPHICS_COMMAND_LIST_VARIANT(embedded_default, embedded_default);
 
-#ifdef VKD3D_ENABLE_PROFILING
 #include "command_list_profiled.h"
-#endif
 
 static struct d3d12_command_list *unsafe_impl_from_ID3D12CommandList(ID3D12CommandList *iface)
 {
@@ -12895,7 +15563,28 @@ static struct d3d12_command_list *unsafe_impl_from_ID3D12CommandList(ID3D12Comma
     return CONTAINING_RECORD(iface, struct d3d12_command_list, ID3D12GraphicsCommandList_iface);
 }
 
-extern CONST_VTBL struct ID3D12GraphicsCommandListExtVtbl d3d12_command_list_vkd3d_ext_vtbl;
+static void vkd3d_command_list_stats_report_accumulate(struct vkd3d_command_list_stats_report *report,
+        ID3D12CommandList * const *command_lists, UINT command_list_count)
+{
+    uint64_t totals[VKD3D_COMMAND_LIST_STAT_COUNT];
+    struct d3d12_command_list *list;
+    unsigned int i, j;
+
+    memset(totals, 0, sizeof(totals));
+
+    for (i = 0; i < command_list_count; i++)
+    {
+        list = unsafe_impl_from_ID3D12CommandList(command_lists[i]);
+        for (j = 0; j < VKD3D_COMMAND_LIST_STAT_COUNT; j++)
+            totals[j] += list->stats.counts[j];
+    }
+
+    for (j = 0; j < VKD3D_COMMAND_LIST_STAT_COUNT; j++)
+        vkd3d_atomic_uint64_add(&report->totals[j], totals[j], vkd3d_memory_order_relaxed);
+    vkd3d_atomic_uint64_add(&report->list_count, command_list_count, vkd3d_memory_order_relaxed);
+}
+
+extern CONST_VTBL struct ID3D12GraphicsCommandListExt1Vtbl d3d12_command_list_vkd3d_ext_vtbl;
 
 static void d3d12_command_list_init_attachment_info(VkRenderingAttachmentInfo *attachment_info)
 {
@@ -12939,11 +15628,9 @@ static HRESULT d3d12_command_list_init(struct d3d12_command_list *list, struct d
 
     memset(list, 0, sizeof(*list));
 
-#ifdef VKD3D_ENABLE_PROFILING
     if (vkd3d_uses_profiling())
         list->ID3D12GraphicsCommandList_iface.lpVtbl = &d3d12_command_list_vtbl_profiled;
     else
-#endif
     {
         list->ID3D12GraphicsCommandList_iface.lpVtbl = &d3d12_command_list_vtbl_default;
 
@@ -13020,9 +15707,7 @@ static struct d3d12_command_list *d3d12_command_list_from_iface(ID3D12CommandLis
     if (!iface)
         return NULL;
 
-#ifdef VKD3D_ENABLE_PROFILING
     is_valid |= iface->lpVtbl == (struct ID3D12CommandListVtbl *)&d3d12_command_list_vtbl_profiled;
-#endif
 
     /* A little annoying, but we only have to validate this on submission,
      * so the overhead is irrelevant. */
@@ -13039,11 +15724,6 @@ static struct d3d12_command_list *d3d12_command_list_from_iface(ID3D12CommandLis
 }
 
 /* ID3D12CommandQueue */
-static inline struct d3d12_command_queue *impl_from_ID3D12CommandQueue(ID3D12CommandQueue *iface)
-{
-    return CONTAINING_RECORD(iface, struct d3d12_command_queue, ID3D12CommandQueue_iface);
-}
-
 static HRESULT STDMETHODCALLTYPE d3d12_command_queue_QueryInterface(ID3D12CommandQueue *iface,
         REFIID riid, void **object)
 {
@@ -13099,12 +15779,13 @@ static ULONG STDMETHODCALLTYPE d3d12_command_queue_Release(ID3D12CommandQueue *i
 
         d3d12_command_queue_submit_stop(command_queue);
         vkd3d_fence_worker_stop(&command_queue->fence_worker, device);
+        vkd3d_queue_watchdog_cleanup(&command_queue->watchdog, command_queue);
         d3d12_device_unmap_vkd3d_queue(device, command_queue->vkd3d_queue);
         pthread_join(command_queue->submission_thread, NULL);
         pthread_mutex_destroy(&command_queue->queue_lock);
         pthread_cond_destroy(&command_queue->queue_cond);
 
-        vkd3d_free(command_queue->submissions);
+        vkd3d_free(command_queue->submission_ring);
         vkd3d_free(command_queue);
 
         d3d12_device_release(device);
@@ -13215,12 +15896,18 @@ static void STDMETHODCALLTYPE d3d12_command_queue_UpdateTileMappings(ID3D12Comma
     if (!region_count || !range_count)
         return;
 
+    /* Tile mappings alias placed resources behind the back of the heap's placed resource index. */
+    if (memory_heap)
+        vkd3d_atomic_uint32_store_explicit(&memory_heap->has_tile_mappings, 1, vkd3d_memory_order_relaxed);
+
     sub.type = VKD3D_SUBMISSION_BIND_SPARSE;
     sub.bind_sparse.mode = VKD3D_SPARSE_MEMORY_BIND_MODE_UPDATE;
     sub.bind_sparse.bind_count = 0;
     sub.bind_sparse.bind_infos = NULL;
     sub.bind_sparse.dst_resource = res;
     sub.bind_sparse.src_resource = NULL;
+    sub.bind_sparse.bind_ranges = NULL;
+    sub.bind_sparse.range_count = 0;
 
     if (region_coords)
         region_coord = region_coords[0];
@@ -13295,6 +15982,7 @@ static void STDMETHODCALLTYPE d3d12_command_queue_UpdateTileMappings(ID3D12Comma
 
             bind->dst_tile = tile_index;
             bind->src_tile = 0;
+            bind->tile_count = 1;
 
             if (range_flag == D3D12_TILE_RANGE_FLAG_NULL)
             {
@@ -13324,7 +16012,22 @@ static void STDMETHODCALLTYPE d3d12_command_queue_UpdateTileMappings(ID3D12Comma
         }
     }
 
-    vkd3d_free(bound_tiles);
+    vkd3d_free(bound_tiles);
+
+    /* Plain updates do not depend on any state owned by the submission thread, so compact here
+     * rather than on the submission thread, which is on the critical path for the whole queue. */
+    if (!vkd3d_compact_sparse_bind_ranges(NULL, sub.bind_sparse.bind_infos, sub.bind_sparse.bind_count,
+            VKD3D_SPARSE_MEMORY_BIND_MODE_UPDATE, vkd3d_sparse_binds_can_compact(command_queue->device),
+            &sub.bind_sparse.bind_ranges, &sub.bind_sparse.range_count))
+    {
+        ERR("Failed to allocate bind range info.\n");
+        vkd3d_free(sub.bind_sparse.bind_infos);
+        return;
+    }
+
+    vkd3d_free(sub.bind_sparse.bind_infos);
+    sub.bind_sparse.bind_infos = NULL;
+
     d3d12_command_queue_add_submission(command_queue, &sub);
     return;
 
@@ -13352,10 +16055,13 @@ static void STDMETHODCALLTYPE d3d12_command_queue_CopyTileMappings(ID3D12Command
 
     sub.type = VKD3D_SUBMISSION_BIND_SPARSE;
     sub.bind_sparse.mode = VKD3D_SPARSE_MEMORY_BIND_MODE_COPY;
-    sub.bind_sparse.bind_count = region_size->NumTiles;
-    sub.bind_sparse.bind_infos = vkd3d_malloc(region_size->NumTiles * sizeof(*sub.bind_sparse.bind_infos));
+    /* Without a box, both regions are linear tile ranges, so a single bind describes the copy. */
+    sub.bind_sparse.bind_count = region_size->UseBox ? region_size->NumTiles : 1;
+    sub.bind_sparse.bind_infos = vkd3d_malloc(sub.bind_sparse.bind_count * sizeof(*sub.bind_sparse.bind_infos));
     sub.bind_sparse.dst_resource = dst_res;
     sub.bind_sparse.src_resource = src_res;
+    sub.bind_sparse.bind_ranges = NULL;
+    sub.bind_sparse.range_count = 0;
 
     if (!sub.bind_sparse.bind_infos)
     {
@@ -13363,11 +16069,12 @@ static void STDMETHODCALLTYPE d3d12_command_queue_CopyTileMappings(ID3D12Command
         return;
     }
 
-    for (i = 0; i < region_size->NumTiles; i++)
+    for (i = 0; i < sub.bind_sparse.bind_count; i++)
     {
         bind = &sub.bind_sparse.bind_infos[i];
         bind->dst_tile = vkd3d_get_tile_index_from_region(&dst_res->sparse, dst_region_start_coordinate, region_size, i);
         bind->src_tile = vkd3d_get_tile_index_from_region(&src_res->sparse, src_region_start_coordinate, region_size, i);
+        bind->tile_count = region_size->UseBox ? 1 : region_size->NumTiles;
         bind->vk_memory = VK_NULL_HANDLE;
         bind->vk_offset = 0;
     }
@@ -13375,6 +16082,42 @@ static void STDMETHODCALLTYPE d3d12_command_queue_CopyTileMappings(ID3D12Command
     d3d12_command_queue_add_submission(command_queue, &sub);
 }
 
+static void d3d12_command_queue_resolve_lazy_clears(struct d3d12_command_queue *command_queue,
+        UINT command_list_count, ID3D12CommandList * const *command_lists)
+{
+    const struct vkd3d_initial_transition *transition;
+    struct d3d12_command_list *cmd_list;
+    struct d3d12_resource *resource;
+    unsigned int i;
+    size_t j;
+
+    /* Pending clears of committed textures are still in the transfer queue at this point.
+     * The first command list to reference a texture decides its fate: if that use
+     * does not need the initial contents, the clear is redundant and can be dropped. */
+    for (i = 0; i < command_list_count; i++)
+    {
+        if (!(cmd_list = d3d12_command_list_from_iface(command_lists[i])))
+            continue;
+
+        for (j = 0; j < cmd_list->init_transitions_count; j++)
+        {
+            transition = &cmd_list->init_transitions[j];
+
+            if (transition->type != VKD3D_INITIAL_TRANSITION_TYPE_RESOURCE)
+                continue;
+
+            resource = transition->resource.resource;
+
+            if (!vkd3d_atomic_uint32_load_explicit(&resource->lazy_clear, vkd3d_memory_order_relaxed) ||
+                    !vkd3d_atomic_uint32_exchange_explicit(&resource->lazy_clear, 0, vkd3d_memory_order_relaxed))
+                continue;
+
+            if (!transition->resource.perform_initial_transition)
+                vkd3d_memory_transfer_queue_cancel_clear(&command_queue->device->memory_transfers, &resource->mem);
+        }
+    }
+}
+
 static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12CommandQueue *iface,
         UINT command_list_count, ID3D12CommandList * const *command_lists)
 {
@@ -13397,6 +16140,8 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
     if (!command_list_count)
         return;
 
+    d3d12_command_queue_resolve_lazy_clears(command_queue, command_list_count, command_lists);
+
     if (FAILED(hr = vkd3d_memory_transfer_queue_flush(&command_queue->device->memory_transfers)))
     {
         d3d12_device_mark_as_removed(command_queue->device, hr,
@@ -13495,6 +16240,12 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
 #endif
     }
 
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_COMMAND_LIST_STATS)
+    {
+        vkd3d_command_list_stats_report_accumulate(&command_queue->device->command_list_stats,
+                command_lists, command_list_count);
+    }
+
     /* Append a full GPU barrier between submissions.
      * This command buffer is SIMULTANEOUS_BIT. */
     buffer = &buffers[j++];
@@ -13536,6 +16287,9 @@ static void STDMETHODCALLTYPE d3d12_command_queue_ExecuteCommandLists(ID3D12Comm
     sub.execute.cmd_count = num_command_buffers;
     sub.execute.outstanding_submissions_counters = outstanding;
     sub.execute.outstanding_submissions_counter_count = command_list_count;
+    /* Tags the submission with the frame it belongs to, so low latency can track GPU work per frame. */
+    sub.execute.low_latency_frame_id = vkd3d_atomic_uint64_load_explicit(
+            &command_queue->device->low_latency.frame_id, vkd3d_memory_order_relaxed);
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     sub.execute.breadcrumb_indices = breadcrumb_indices;
     sub.execute.breadcrumb_indices_count = breadcrumb_indices ? command_list_count : 0;
@@ -13623,8 +16377,9 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_queue_GetClockCalibration(ID3D12C
     struct d3d12_device *device = command_queue->device;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     VkCalibratedTimestampInfoEXT timestamp_infos[2], *timestamp_info;
+    LARGE_INTEGER qpc_begin, qpc_end, qpc_frequency;
     uint64_t max_deviation, timestamps[2];
-    LARGE_INTEGER qpc_begin, qpc_end;
+    uint64_t host_ns;
     uint32_t count = 0;
     VkResult vr;
 
@@ -13645,6 +16400,21 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_queue_GetClockCalibration(ID3D12C
         return S_OK;
     }
 
+    /* vkd3d_get_current_time_ns() is derived from QPC, so the background calibration
+     * can answer this without a driver round-trip. */
+    QueryPerformanceCounter(&qpc_begin);
+    QueryPerformanceFrequency(&qpc_frequency);
+    host_ns = (qpc_begin.QuadPart / qpc_frequency.QuadPart) * 1000000000 +
+            ((qpc_begin.QuadPart % qpc_frequency.QuadPart) * 1000000000) / qpc_frequency.QuadPart;
+
+    if (vkd3d_clock_calibration_get_gpu_ticks(&device->clock_calibration, host_ns, gpu_timestamp))
+    {
+        if (command_queue->vkd3d_queue->timestamp_bits < 64)
+            *gpu_timestamp &= (1ull << command_queue->vkd3d_queue->timestamp_bits) - 1;
+        *cpu_timestamp = qpc_begin.QuadPart;
+        return S_OK;
+    }
+
     timestamp_info = &timestamp_infos[count++];
     timestamp_info->sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
     timestamp_info->pNext = NULL;
@@ -13909,6 +16679,9 @@ static void d3d12_command_queue_signal_shared(struct d3d12_command_queue *comman
 }
 
 #define VKD3D_COMMAND_QUEUE_NUM_TRANSITION_BUFFERS 16
+/* Every coalesced execute may consume one transition buffer before anything is submitted. */
+#define VKD3D_MAX_COALESCED_EXECUTES 8
+STATIC_ASSERT(VKD3D_MAX_COALESCED_EXECUTES <= VKD3D_COMMAND_QUEUE_NUM_TRANSITION_BUFFERS);
 struct d3d12_command_queue_transition_pool
 {
     VkCommandBuffer cmd[VKD3D_COMMAND_QUEUE_NUM_TRANSITION_BUFFERS];
@@ -14128,72 +16901,397 @@ static void d3d12_command_queue_transition_pool_build(struct d3d12_command_queue
     *timeline_value = pool->timeline_value;
 }
 
+static void d3d12_command_queue_release_execute_submissions(
+        const struct d3d12_command_queue_submission_execute *executes, unsigned int execute_count)
+{
+    unsigned int i, j;
+
+    for (i = 0; i < execute_count; i++)
+    {
+        for (j = 0; j < executes[i].outstanding_submissions_counter_count; j++)
+            InterlockedDecrement(executes[i].outstanding_submissions_counters[j]);
+        vkd3d_free(executes[i].outstanding_submissions_counters);
+    }
+}
+
+static void vkd3d_queue_watchdog_report(struct vkd3d_queue_watchdog *watchdog,
+        struct d3d12_command_queue *command_queue, uint64_t now_ns)
+{
+    uint64_t interval_ns = now_ns - watchdog->interval_start_ns;
+
+    if (watchdog->interval_batch_count && interval_ns)
+    {
+        INFO("Queue %p (type %u): %u batches, GPU busy %.1f%%, avg batch %.3f ms, max batch %.3f ms, "
+                "avg submit latency %s%.3f ms, %u slow.\n",
+                command_queue, command_queue->desc.Type, watchdog->interval_batch_count,
+                min(100.0, 100.0 * (double)watchdog->interval_busy_ns / (double)interval_ns),
+                1e-6 * (double)watchdog->interval_busy_ns / watchdog->interval_batch_count,
+                1e-6 * (double)watchdog->interval_max_batch_ns,
+                watchdog->interval_latency_count ? "" : "(n/a) ",
+                1e-6 * (double)watchdog->interval_latency_ns / max(watchdog->interval_latency_count, 1u),
+                watchdog->interval_slow_count);
+    }
+
+    watchdog->interval_start_ns = now_ns;
+    watchdog->interval_busy_ns = 0;
+    watchdog->interval_latency_ns = 0;
+    watchdog->interval_latency_count = 0;
+    watchdog->interval_max_batch_ns = 0;
+    watchdog->interval_batch_count = 0;
+    watchdog->interval_slow_count = 0;
+}
+
+static void vkd3d_queue_watchdog_resolve(struct vkd3d_queue_watchdog *watchdog,
+        struct d3d12_command_queue *command_queue)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &command_queue->device->vk_procs;
+    struct d3d12_device *device = command_queue->device;
+    uint64_t completed_value, now_ns, duration_ns;
+    struct vkd3d_queue_watchdog_slot *slot;
+    uint64_t timestamps[2];
+    uint64_t start_ns;
+    uint32_t index;
+    VkResult vr;
+
+    if (watchdog->read_index == watchdog->write_index)
+        return;
+
+    if ((vr = VK_CALL(vkGetSemaphoreCounterValue(device->vk_device,
+            command_queue->vkd3d_queue->submission_timeline, &completed_value))))
+    {
+        ERR("Failed to query timeline semaphore value, vr %d.\n", vr);
+        return;
+    }
+
+    now_ns = vkd3d_get_current_time_ns();
+
+    while (watchdog->read_index != watchdog->write_index)
+    {
+        index = watchdog->read_index % VKD3D_QUEUE_WATCHDOG_SLOT_COUNT;
+        slot = &watchdog->slots[index];
+
+        if (slot->timeline_value > completed_value)
+        {
+            /* The oldest batch is still running, this is our hang indicator. */
+            if (!slot->reported && now_ns - slot->submit_time_ns > watchdog->threshold_ns)
+            {
+                WARN("Queue %p: batch submitted %.3f ms ago has not completed yet.\n",
+                        command_queue, 1e-6 * (double)(now_ns - slot->submit_time_ns));
+                slot->reported = true;
+            }
+            break;
+        }
+
+        vr = VK_CALL(vkGetQueryPoolResults(device->vk_device, watchdog->vk_query_pool,
+                2 * index, 2, sizeof(timestamps), timestamps, sizeof(timestamps[0]), VK_QUERY_RESULT_64_BIT));
+
+        if (vr == VK_SUCCESS)
+        {
+            duration_ns = (uint64_t)((double)((timestamps[1] - timestamps[0]) & watchdog->timestamp_mask) *
+                    watchdog->ns_per_tick);
+
+            watchdog->interval_busy_ns += duration_ns;
+            watchdog->interval_max_batch_ns = max(watchdog->interval_max_batch_ns, duration_ns);
+            watchdog->interval_batch_count++;
+
+            if (duration_ns > watchdog->threshold_ns)
+            {
+                WARN("Queue %p: batch took %.3f ms on the GPU.\n", command_queue, 1e-6 * (double)duration_ns);
+                watchdog->interval_slow_count++;
+            }
+
+            if (vkd3d_clock_calibration_get_host_ns(&device->clock_calibration, timestamps[0], &start_ns) &&
+                    start_ns > slot->submit_time_ns)
+            {
+                watchdog->interval_latency_ns += start_ns - slot->submit_time_ns;
+                watchdog->interval_latency_count++;
+            }
+        }
+        else if (vr != VK_NOT_READY)
+            ERR("Failed to read back batch timestamps, vr %d.\n", vr);
+
+        watchdog->read_index++;
+    }
+
+    if (now_ns - watchdog->interval_start_ns >= 1000000000ull)
+        vkd3d_queue_watchdog_report(watchdog, command_queue, now_ns);
+}
+
+static uint32_t vkd3d_queue_watchdog_begin(struct vkd3d_queue_watchdog *watchdog,
+        struct d3d12_command_queue *command_queue)
+{
+    if (!watchdog->enabled)
+        return UINT32_MAX;
+
+    vkd3d_queue_watchdog_resolve(watchdog, command_queue);
+
+    /* Never block on the GPU here, just leave the batch untimed. */
+    if (watchdog->write_index - watchdog->read_index >= VKD3D_QUEUE_WATCHDOG_SLOT_COUNT)
+        return UINT32_MAX;
+
+    return watchdog->write_index % VKD3D_QUEUE_WATCHDOG_SLOT_COUNT;
+}
+
+static void vkd3d_queue_watchdog_commit(struct vkd3d_queue_watchdog *watchdog, uint64_t timeline_value)
+{
+    struct vkd3d_queue_watchdog_slot *slot;
+
+    slot = &watchdog->slots[watchdog->write_index % VKD3D_QUEUE_WATCHDOG_SLOT_COUNT];
+    slot->timeline_value = timeline_value;
+    slot->submit_time_ns = vkd3d_get_current_time_ns();
+    slot->reported = false;
+    watchdog->write_index++;
+}
+
+static void vkd3d_queue_watchdog_cleanup(struct vkd3d_queue_watchdog *watchdog,
+        struct d3d12_command_queue *command_queue)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &command_queue->device->vk_procs;
+    struct d3d12_device *device = command_queue->device;
+
+    if (watchdog->enabled)
+    {
+        vkd3d_queue_watchdog_resolve(watchdog, command_queue);
+        vkd3d_queue_watchdog_report(watchdog, command_queue, vkd3d_get_current_time_ns());
+    }
+
+    VK_CALL(vkDestroyCommandPool(device->vk_device, watchdog->vk_command_pool, NULL));
+    VK_CALL(vkDestroyQueryPool(device->vk_device, watchdog->vk_query_pool, NULL));
+}
+
+static HRESULT vkd3d_queue_watchdog_record_timestamp(struct vkd3d_queue_watchdog *watchdog,
+        struct d3d12_device *device, VkCommandBuffer vk_command_buffer, uint32_t query, bool reset)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkCommandBufferBeginInfo begin_info;
+    VkResult vr;
+
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext = NULL;
+    begin_info.flags = 0;
+    begin_info.pInheritanceInfo = NULL;
+
+    if ((vr = VK_CALL(vkBeginCommandBuffer(vk_command_buffer, &begin_info))) < 0)
+        return hresult_from_vk_result(vr);
+
+    if (reset)
+        VK_CALL(vkCmdResetQueryPool(vk_command_buffer, watchdog->vk_query_pool, query, 2));
+
+    VK_CALL(vkCmdWriteTimestamp2(vk_command_buffer, reset ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            watchdog->vk_query_pool, reset ? query : query + 1));
+
+    if ((vr = VK_CALL(vkEndCommandBuffer(vk_command_buffer))) < 0)
+        return hresult_from_vk_result(vr);
+
+    return S_OK;
+}
+
+static HRESULT vkd3d_queue_watchdog_init(struct vkd3d_queue_watchdog *watchdog,
+        struct d3d12_command_queue *command_queue)
+{
+    struct d3d12_device *device = command_queue->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_queue *vkd3d_queue = command_queue->vkd3d_queue;
+    VkCommandBufferAllocateInfo allocate_info;
+    VkCommandPoolCreateInfo pool_info;
+    VkQueryPoolCreateInfo query_info;
+    char env[VKD3D_PATH_MAX];
+    unsigned int i;
+    double value;
+    VkResult vr;
+    HRESULT hr;
+
+    memset(watchdog, 0, sizeof(*watchdog));
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_QUEUE_WATCHDOG))
+        return S_OK;
+
+    if (!vkd3d_queue->timestamp_bits)
+    {
+        WARN("Queue family %u does not support timestamps, disabling watchdog for queue %p.\n",
+                vkd3d_queue->vk_family_index, command_queue);
+        return S_OK;
+    }
+
+    memset(&query_info, 0, sizeof(query_info));
+    query_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_info.queryCount = 2 * VKD3D_QUEUE_WATCHDOG_SLOT_COUNT;
+
+    if ((vr = VK_CALL(vkCreateQueryPool(device->vk_device, &query_info, NULL, &watchdog->vk_query_pool))) < 0)
+    {
+        ERR("Failed to create query pool, vr %d.\n", vr);
+        return hresult_from_vk_result(vr);
+    }
+
+    memset(&pool_info, 0, sizeof(pool_info));
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.queueFamilyIndex = vkd3d_queue->vk_family_index;
+
+    if ((vr = VK_CALL(vkCreateCommandPool(device->vk_device, &pool_info, NULL, &watchdog->vk_command_pool))) < 0)
+    {
+        ERR("Failed to create command pool, vr %d.\n", vr);
+        hr = hresult_from_vk_result(vr);
+        goto fail;
+    }
+
+    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocate_info.pNext = NULL;
+    allocate_info.commandPool = watchdog->vk_command_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = VKD3D_QUEUE_WATCHDOG_SLOT_COUNT;
+
+    if ((vr = VK_CALL(vkAllocateCommandBuffers(device->vk_device, &allocate_info, watchdog->vk_begin_commands))) < 0 ||
+            (vr = VK_CALL(vkAllocateCommandBuffers(device->vk_device, &allocate_info, watchdog->vk_end_commands))) < 0)
+    {
+        ERR("Failed to allocate command buffers, vr %d.\n", vr);
+        hr = hresult_from_vk_result(vr);
+        goto fail;
+    }
+
+    /* Every slot owns a pair of queries, the command buffers are recorded once and resubmitted. */
+    for (i = 0; i < VKD3D_QUEUE_WATCHDOG_SLOT_COUNT; i++)
+    {
+        if (FAILED(hr = vkd3d_queue_watchdog_record_timestamp(watchdog, device, watchdog->vk_begin_commands[i], 2 * i, true)) ||
+                FAILED(hr = vkd3d_queue_watchdog_record_timestamp(watchdog, device, watchdog->vk_end_commands[i], 2 * i, false)))
+        {
+            ERR("Failed to record timestamp commands, hr %#x.\n", hr);
+            goto fail;
+        }
+    }
+
+    watchdog->threshold_ns = 100000000ull;
+    if (vkd3d_get_env_var("VKD3D_QUEUE_WATCHDOG_THRESHOLD_MS", env, sizeof(env)) &&
+            (value = strtod(env, NULL)) > 0.0)
+        watchdog->threshold_ns = (uint64_t)(value * 1e6);
+
+    watchdog->ns_per_tick = device->vk_info.device_limits.timestampPeriod;
+    watchdog->timestamp_mask = vkd3d_queue->timestamp_bits >= 64 ? UINT64_MAX : (1ull << vkd3d_queue->timestamp_bits) - 1;
+
+    watchdog->interval_start_ns = vkd3d_get_current_time_ns();
+    watchdog->enabled = true;
+
+    INFO("Enabling watchdog for queue %p, threshold %.3f ms.\n", command_queue, 1e-6 * (double)watchdog->threshold_ns);
+    return S_OK;
+
+fail:
+    VK_CALL(vkDestroyCommandPool(device->vk_device, watchdog->vk_command_pool, NULL));
+    VK_CALL(vkDestroyQueryPool(device->vk_device, watchdog->vk_query_pool, NULL));
+    memset(watchdog, 0, sizeof(*watchdog));
+    return hr;
+}
+
 static void d3d12_command_queue_execute(struct d3d12_command_queue *command_queue,
-        const VkCommandBufferSubmitInfo *cmd, UINT count,
-        const VkCommandBufferSubmitInfo *transition_cmd,
-        const VkSemaphoreSubmitInfo *transition_semaphore,
-        LONG **submission_counters, size_t num_submission_counters,
-        bool debug_capture)
+        const struct d3d12_command_queue_submission_execute *executes,
+        const VkCommandBufferSubmitInfo *transition_cmds,
+        const VkSemaphoreSubmitInfo *transition_semaphores,
+        unsigned int execute_count)
 {
+    VkLatencySubmissionPresentIdNV latency_submit_desc[VKD3D_MAX_COALESCED_EXECUTES];
     const struct vkd3d_vk_device_procs *vk_procs = &command_queue->device->vk_procs;
+    VkSubmitInfo2 submit_desc[2 * VKD3D_MAX_COALESCED_EXECUTES + 2];
     struct vkd3d_queue *vkd3d_queue = command_queue->vkd3d_queue;
+    VkCommandBufferSubmitInfo watchdog_cmds[2];
+    uint32_t watchdog_slot;
+    bool low_latency;
     VkSemaphoreSubmitInfo signal_semaphore_info;
-    VkSubmitInfo2 submit_desc[2];
+    bool debug_capture = false;
     uint32_t num_submits;
     VkQueue vk_queue;
     unsigned int i;
     VkResult vr;
     HRESULT hr;
 
-    TRACE("queue %p, command_list_count %u, command_lists %p.\n",
-          command_queue, count, cmd);
+    TRACE("queue %p, executes %p, execute_count %u.\n",
+          command_queue, executes, execute_count);
+
+    assert(execute_count && execute_count <= VKD3D_MAX_COALESCED_EXECUTES);
+
+    memset(submit_desc, 0, sizeof(*submit_desc) * (2 * execute_count + 2));
+    num_submits = 0;
+
+    low_latency = d3d12_device_supports_nv_low_latency(command_queue->device) &&
+            command_queue->device->low_latency.swapchain;
 
-    memset(submit_desc, 0, sizeof(submit_desc));
+    /* Bracket the whole batch with timestamps in separate submits, so the application's
+     * command buffers are left untouched. */
+    if ((watchdog_slot = vkd3d_queue_watchdog_begin(&command_queue->watchdog, command_queue)) != UINT32_MAX)
+    {
+        memset(watchdog_cmds, 0, sizeof(watchdog_cmds));
+        watchdog_cmds[0].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+        watchdog_cmds[0].commandBuffer = command_queue->watchdog.vk_begin_commands[watchdog_slot];
+        watchdog_cmds[1].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+        watchdog_cmds[1].commandBuffer = command_queue->watchdog.vk_end_commands[watchdog_slot];
+
+        submit_desc[num_submits].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submit_desc[num_submits].commandBufferInfoCount = 1;
+        submit_desc[num_submits].pCommandBufferInfos = &watchdog_cmds[0];
+        num_submits++;
+    }
 
-    if (transition_cmd->commandBuffer)
+    for (i = 0; i < execute_count; i++)
     {
-        /* The transition cmd must happen in-order, since with the advanced aliasing model in D3D12,
-         * it is enough to separate aliases with an ExecuteCommandLists.
-         * A clear-like operation must still happen though in the application which would acquire the alias,
-         * but we must still be somewhat careful about when we emit initial state transitions.
-         * The clear requirement only exists for render targets. */
-        num_submits = 2;
+        if (transition_cmds[i].commandBuffer)
+        {
+            /* The transition cmd must happen in-order, since with the advanced aliasing model in D3D12,
+             * it is enough to separate aliases with an ExecuteCommandLists.
+             * A clear-like operation must still happen though in the application which would acquire the alias,
+             * but we must still be somewhat careful about when we emit initial state transitions.
+             * The clear requirement only exists for render targets.
+             * When several ExecuteCommandLists are coalesced, each one keeps its own transition submit
+             * placed in front of its command buffers, which preserves that ordering. */
+
+            /* Could use the serializing binary semaphore here,
+             * but we need to keep track of the timeline on CPU as well
+             * to know when we can reset the barrier command buffer. */
+            submit_desc[num_submits].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+            submit_desc[num_submits].signalSemaphoreInfoCount = 1;
+            submit_desc[num_submits].pSignalSemaphoreInfos = &transition_semaphores[i];
+            submit_desc[num_submits].commandBufferInfoCount = 1;
+            submit_desc[num_submits].pCommandBufferInfos = &transition_cmds[i];
+            num_submits++;
+
+            submit_desc[num_submits].waitSemaphoreInfoCount = 1;
+            submit_desc[num_submits].pWaitSemaphoreInfos = &transition_semaphores[i];
+        }
+
+        submit_desc[num_submits].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submit_desc[num_submits].commandBufferInfoCount = executes[i].cmd_count;
+        submit_desc[num_submits].pCommandBufferInfos = executes[i].cmd;
 
-        /* Could use the serializing binary semaphore here,
-         * but we need to keep track of the timeline on CPU as well
-         * to know when we can reset the barrier command buffer. */
-        submit_desc[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
-        submit_desc[0].signalSemaphoreInfoCount = 1;
-        submit_desc[0].pSignalSemaphoreInfos = transition_semaphore;
-        submit_desc[0].commandBufferInfoCount = 1;
-        submit_desc[0].pCommandBufferInfos = transition_cmd;
+        if (low_latency && executes[i].low_latency_frame_id)
+        {
+            latency_submit_desc[i].sType = VK_STRUCTURE_TYPE_LATENCY_SUBMISSION_PRESENT_ID_NV;
+            latency_submit_desc[i].pNext = NULL;
+            latency_submit_desc[i].presentID = executes[i].low_latency_frame_id;
+            submit_desc[num_submits].pNext = &latency_submit_desc[i];
+        }
 
-        submit_desc[1].waitSemaphoreInfoCount = 1;
-        submit_desc[1].pWaitSemaphoreInfos = transition_semaphore;
+        num_submits++;
     }
-    else
+
+    if (watchdog_slot != UINT32_MAX)
     {
-        num_submits = 1;
+        submit_desc[num_submits].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+        submit_desc[num_submits].commandBufferInfoCount = 1;
+        submit_desc[num_submits].pCommandBufferInfos = &watchdog_cmds[1];
+        num_submits++;
     }
 
     if (!(vk_queue = vkd3d_queue_acquire(vkd3d_queue)))
     {
         ERR("Failed to acquire queue %p.\n", vkd3d_queue);
-        for (i = 0; i < num_submission_counters; i++)
-            InterlockedDecrement(submission_counters[i]);
-        vkd3d_free(submission_counters);
+        d3d12_command_queue_release_execute_submissions(executes, execute_count);
         return;
     }
 
+    /* Only the final batch needs to signal, since submissions on a queue retire in order. */
     memset(&signal_semaphore_info, 0, sizeof(signal_semaphore_info));
     signal_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
     signal_semaphore_info.semaphore = vkd3d_queue->submission_timeline;
     signal_semaphore_info.value = ++vkd3d_queue->submission_timeline_count;
     signal_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
-    submit_desc[num_submits - 1].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
-    submit_desc[num_submits - 1].commandBufferInfoCount = count;
-    submit_desc[num_submits - 1].pCommandBufferInfos = cmd;
     submit_desc[num_submits - 1].signalSemaphoreInfoCount = 1;
     submit_desc[num_submits - 1].pSignalSemaphoreInfos = &signal_semaphore_info;
 
@@ -14202,21 +17300,28 @@ static void d3d12_command_queue_execute(struct d3d12_command_queue *command_queu
      * based on VKD3D_AUTO_CAPTURE_COUNTS.
      * If a submission index is not marked to be captured after all, we drop any capture here.
      * Deciding this in the submission thread is more robust than the alternative, since the submission
-     * threads are mostly serialized. */
-    if (debug_capture)
+     * threads are mostly serialized. Captured submissions are never coalesced. */
+    if (execute_count == 1 && executes[0].debug_capture)
         debug_capture = vkd3d_renderdoc_command_queue_begin_capture(command_queue);
-#else
-    (void)debug_capture;
 #endif
 
     if ((vr = VK_CALL(vkQueueSubmit2(vk_queue, num_submits, submit_desc, VK_NULL_HANDLE))) < 0)
         ERR("Failed to submit queue(s), vr %d.\n", vr);
+    else
+    {
+        vkd3d_atomic_uint64_increment(&vkd3d_queue->execute_count, vkd3d_memory_order_relaxed);
+
+        if (watchdog_slot != UINT32_MAX)
+            vkd3d_queue_watchdog_commit(&command_queue->watchdog, signal_semaphore_info.value);
+    }
 
     VKD3D_DEVICE_REPORT_BREADCRUMB_IF(command_queue->device, vr == VK_ERROR_DEVICE_LOST);
 
 #ifdef VKD3D_ENABLE_RENDERDOC
     if (debug_capture)
         vkd3d_renderdoc_command_queue_end_capture(command_queue);
+#else
+    (void)debug_capture;
 #endif
 
     vkd3d_queue_release(vkd3d_queue);
@@ -14227,120 +17332,224 @@ static void d3d12_command_queue_execute(struct d3d12_command_queue *command_queu
      * - Decrementing counters for submissions. This allows us to track when it's safe to reset a command pool.
      *   If there are pending submissions waiting, we are expected to ignore the reset.
      *   We will report a failure in this case. Some games run into this.
+     * Counters are kept per ExecuteCommandLists, they all retire on the same timeline value.
      */
-    if (vr == VK_SUCCESS && num_submission_counters)
+    for (i = 0; vr == VK_SUCCESS && i < execute_count; i++)
     {
+        if (!executes[i].outstanding_submissions_counter_count)
+            continue;
+
         if (FAILED(hr = vkd3d_enqueue_timeline_semaphore(&command_queue->fence_worker,
                 NULL, vkd3d_queue->submission_timeline,
                 signal_semaphore_info.value, false,
-                submission_counters, num_submission_counters)))
+                executes[i].outstanding_submissions_counters,
+                executes[i].outstanding_submissions_counter_count)))
         {
             ERR("Failed to enqueue timeline semaphore.\n");
         }
     }
 }
 
-static unsigned int vkd3d_compact_sparse_bind_ranges(const struct d3d12_resource *src_resource,
-        struct vkd3d_sparse_memory_bind_range *bind_ranges, struct vkd3d_sparse_memory_bind *bind_infos,
-        unsigned int count, enum vkd3d_sparse_memory_bind_mode mode, bool can_compact)
+static bool vkd3d_sparse_bind_ranges_append(struct vkd3d_sparse_memory_bind_range **bind_ranges,
+        size_t *bind_ranges_size, uint32_t *range_count, uint32_t tile_index, uint32_t tile_count,
+        VkDeviceMemory vk_memory, VkDeviceSize vk_offset, bool can_compact)
+{
+    struct vkd3d_sparse_memory_bind_range *range;
+    uint32_t i, new_count;
+
+    if (can_compact && *range_count)
+    {
+        range = &(*bind_ranges)[*range_count - 1];
+
+        if (tile_index == range->tile_index + range->tile_count && vk_memory == range->vk_memory &&
+                (vk_offset == range->vk_offset + range->tile_count * VKD3D_TILE_SIZE || !vk_memory))
+        {
+            range->tile_count += tile_count;
+            return true;
+        }
+    }
+
+    new_count = can_compact ? 1 : tile_count;
+
+    if (!vkd3d_array_reserve((void **)bind_ranges, bind_ranges_size,
+            *range_count + new_count, sizeof(**bind_ranges)))
+        return false;
+
+    for (i = 0; i < new_count; i++)
+    {
+        range = &(*bind_ranges)[(*range_count)++];
+        range->tile_index = tile_index + i;
+        range->tile_count = can_compact ? tile_count : 1;
+        range->vk_memory = vk_memory;
+        range->vk_offset = vk_memory ? vk_offset + i * VKD3D_TILE_SIZE : 0;
+    }
+
+    return true;
+}
+
+static bool vkd3d_compact_sparse_bind_ranges(const struct d3d12_resource *src_resource,
+        const struct vkd3d_sparse_memory_bind *bind_infos, unsigned int count,
+        enum vkd3d_sparse_memory_bind_mode mode, bool can_compact,
+        struct vkd3d_sparse_memory_bind_range **bind_ranges, uint32_t *range_count)
 {
-    struct vkd3d_sparse_memory_bind_range *range = NULL;
-    VkDeviceMemory vk_memory;
+    uint32_t src_tile, dst_tile, tile_count, run_tile_count;
+    const struct d3d12_sparse_tile_run *run;
+    size_t bind_ranges_size = 0;
     VkDeviceSize vk_offset;
-    unsigned int i, j;
+    unsigned int i;
 
-    for (i = 0, j = 0; i < count; i++)
+    *bind_ranges = NULL;
+    *range_count = 0;
+
+    for (i = 0; i < count; i++)
     {
-        struct vkd3d_sparse_memory_bind *bind = &bind_infos[i];
+        const struct vkd3d_sparse_memory_bind *bind = &bind_infos[i];
 
         if (mode == VKD3D_SPARSE_MEMORY_BIND_MODE_UPDATE)
         {
-            vk_memory = bind->vk_memory;
-            vk_offset = bind->vk_offset;
+            if (!vkd3d_sparse_bind_ranges_append(bind_ranges, &bind_ranges_size, range_count,
+                    bind->dst_tile, bind->tile_count, bind->vk_memory, bind->vk_offset, can_compact))
+                goto fail;
         }
         else /* if (mode == VKD3D_SPARSE_MEMORY_BIND_MODE_COPY) */
         {
-            struct d3d12_sparse_tile *src_tile = &src_resource->sparse.tiles[bind->src_tile];
-            vk_memory = src_tile->vk_memory;
-            vk_offset = src_tile->vk_offset;
-        }
+            /* Walk the source mapping run by run rather than tile by tile. */
+            src_tile = bind->src_tile;
+            dst_tile = bind->dst_tile;
+            tile_count = bind->tile_count;
 
-        if (can_compact && range && bind->dst_tile == range->tile_index + range->tile_count && vk_memory == range->vk_memory &&
-                (vk_offset == range->vk_offset + range->tile_count * VKD3D_TILE_SIZE || !vk_memory))
-        {
-            range->tile_count++;
-        }
-        else
-        {
-            range = &bind_ranges[j++];
-            range->tile_index = bind->dst_tile;
-            range->tile_count = 1;
-            range->vk_memory = vk_memory;
-            range->vk_offset = vk_offset;
+            while (tile_count)
+            {
+                if (!(run = d3d12_sparse_info_find_run(&src_resource->sparse, src_tile)))
+                {
+                    ERR("Source tile %u out of range.\n", src_tile);
+                    break;
+                }
+
+                run_tile_count = min(run->tile_index + run->tile_count - src_tile, tile_count);
+                vk_offset = run->vk_memory ? run->vk_offset + (VkDeviceSize)(src_tile - run->tile_index) * VKD3D_TILE_SIZE : 0;
+
+                if (!vkd3d_sparse_bind_ranges_append(bind_ranges, &bind_ranges_size, range_count,
+                        dst_tile, run_tile_count, run->vk_memory, vk_offset, can_compact))
+                    goto fail;
+
+                src_tile += run_tile_count;
+                dst_tile += run_tile_count;
+                tile_count -= run_tile_count;
+            }
         }
     }
 
-    return j;
+    return true;
+
+fail:
+    vkd3d_free(*bind_ranges);
+    *bind_ranges = NULL;
+    *range_count = 0;
+    return false;
+}
+
+static bool vkd3d_sparse_binds_can_compact(struct d3d12_device *device)
+{
+    /* NV driver is buggy and test_update_tile_mappings fails (bug 3274618). */
+    return device->device_info.properties2.properties.vendorID != VKD3D_VENDOR_ID_NVIDIA;
+}
+
+/* Must not exceed the number of resources which can be bound in one VkBindSparseInfo by us. */
+#define VKD3D_MAX_COALESCED_SPARSE_BINDS 16
+
+struct vkd3d_sparse_bind_batch
+{
+    VkSparseBufferMemoryBindInfo buffer_infos[VKD3D_MAX_COALESCED_SPARSE_BINDS];
+    VkSparseImageOpaqueMemoryBindInfo opaque_infos[VKD3D_MAX_COALESCED_SPARSE_BINDS];
+    VkSparseImageMemoryBindInfo image_infos[VKD3D_MAX_COALESCED_SPARSE_BINDS];
+    unsigned int buffer_info_count;
+    unsigned int opaque_info_count;
+    unsigned int image_info_count;
+
+    /* Allocations backing the bind infos above. */
+    void *allocations[VKD3D_MAX_COALESCED_SPARSE_BINDS * 2];
+    unsigned int allocation_count;
+};
+
+static bool vkd3d_sparse_bind_conflicts(const struct d3d12_command_queue_submission_bind_sparse *binds,
+        unsigned int bind_count, const struct d3d12_command_queue_submission_bind_sparse *bind)
+{
+    unsigned int i;
+
+    /* A batch must not bind the same range more than once, and binds within a batch are unordered,
+     * so only coalesce binds to distinct resources. */
+    for (i = 0; i < bind_count; i++)
+    {
+        if (binds[i].dst_resource == bind->dst_resource)
+            return true;
+    }
+
+    return false;
 }
 
-static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_queue,
-        enum vkd3d_sparse_memory_bind_mode mode, struct d3d12_resource *dst_resource,
-        struct d3d12_resource *src_resource, unsigned int count,
-        struct vkd3d_sparse_memory_bind *bind_infos)
+static void *vkd3d_sparse_bind_batch_alloc(struct vkd3d_sparse_bind_batch *batch, size_t size)
+{
+    void *ptr;
+
+    assert(batch->allocation_count < ARRAY_SIZE(batch->allocations));
+
+    if ((ptr = vkd3d_malloc(size)))
+        batch->allocations[batch->allocation_count++] = ptr;
+
+    return ptr;
+}
+
+static void d3d12_command_queue_add_sparse_bind(struct d3d12_command_queue *command_queue,
+        struct vkd3d_sparse_bind_batch *batch, const struct d3d12_command_queue_submission_bind_sparse *sparse_bind)
 {
-    struct vkd3d_sparse_memory_bind_range *bind_ranges = NULL;
+    struct vkd3d_sparse_memory_bind_range *bind_ranges = sparse_bind->bind_ranges;
+    struct d3d12_resource *dst_resource = sparse_bind->dst_resource;
+    VkSparseImageOpaqueMemoryBindInfo *opaque_info = NULL;
+    VkSparseBufferMemoryBindInfo *buffer_info = NULL;
+    VkSparseImageMemoryBindInfo *image_info = NULL;
     unsigned int first_packed_tile, processed_tiles;
-    VkSparseImageOpaqueMemoryBindInfo opaque_info;
-    const struct vkd3d_vk_device_procs *vk_procs;
     VkSparseImageMemoryBind *image_binds = NULL;
-    VkSparseBufferMemoryBindInfo buffer_info;
     VkSparseMemoryBind *memory_binds = NULL;
-    VkSparseImageMemoryBindInfo image_info;
-    VkSemaphoreSubmitInfo semaphore_info;
-    VkBindSparseInfo bind_sparse_info;
-    struct vkd3d_queue *queue_sparse;
-    struct vkd3d_queue *queue;
-    VkSubmitInfo2 submit_info;
-    VkQueue vk_queue_sparse;
-    unsigned int i, j, k;
-    VkQueue vk_queue;
-    bool can_compact;
-    VkResult vr;
+    uint32_t count = sparse_bind->range_count;
+    bool owns_bind_ranges = false;
+    unsigned int i, k;
 
     TRACE("queue %p, dst_resource %p, src_resource %p, count %u, bind_infos %p.\n",
-          command_queue, dst_resource, src_resource, count, bind_infos);
-
-    vk_procs = &command_queue->device->vk_procs;
+          command_queue, dst_resource, sparse_bind->src_resource, sparse_bind->bind_count, sparse_bind->bind_infos);
 
-    memset(&bind_sparse_info, 0, sizeof(bind_sparse_info));
-    bind_sparse_info.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
+    if (!sparse_bind->bind_count)
+        return;
 
-    if (!(bind_ranges = vkd3d_malloc(count * sizeof(*bind_ranges))))
+    /* Tile mapping copies depend on the state of the source resource at the time of execution,
+     * so they can only be compacted here. Updates are compacted up front. */
+    if (!bind_ranges)
     {
-        ERR("Failed to allocate bind range info.\n");
-        goto cleanup;
-    }
+        if (!vkd3d_compact_sparse_bind_ranges(sparse_bind->src_resource, sparse_bind->bind_infos,
+                sparse_bind->bind_count, sparse_bind->mode, vkd3d_sparse_binds_can_compact(command_queue->device),
+                &bind_ranges, &count))
+        {
+            ERR("Failed to allocate bind range info.\n");
+            return;
+        }
 
-    /* NV driver is buggy and test_update_tile_mappings fails (bug 3274618). */
-    can_compact = command_queue->device->device_info.properties2.properties.vendorID != VKD3D_VENDOR_ID_NVIDIA;
-    count = vkd3d_compact_sparse_bind_ranges(src_resource, bind_ranges, bind_infos, count, mode, can_compact);
+        owns_bind_ranges = true;
+    }
 
     first_packed_tile = dst_resource->sparse.tile_count;
 
     if (d3d12_resource_is_buffer(dst_resource))
     {
-        if (!(memory_binds = vkd3d_malloc(count * sizeof(*memory_binds))))
+        if (!(memory_binds = vkd3d_sparse_bind_batch_alloc(batch, count * sizeof(*memory_binds))))
         {
             ERR("Failed to allocate sparse memory bind info.\n");
             goto cleanup;
         }
 
-        buffer_info.buffer = dst_resource->res.vk_buffer;
-        buffer_info.bindCount = count;
-        buffer_info.pBinds = memory_binds;
-
-        bind_sparse_info.bufferBindCount = 1;
-        bind_sparse_info.pBufferBinds = &buffer_info;
+        buffer_info = &batch->buffer_infos[batch->buffer_info_count++];
+        buffer_info->buffer = dst_resource->res.vk_buffer;
+        buffer_info->bindCount = count;
+        buffer_info->pBinds = memory_binds;
     }
     else
     {
@@ -14362,36 +17571,38 @@ static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_
 
         if (opaque_bind_count)
         {
-            if (!(memory_binds = vkd3d_malloc(opaque_bind_count * sizeof(*memory_binds))))
+            if (!(memory_binds = vkd3d_sparse_bind_batch_alloc(batch, opaque_bind_count * sizeof(*memory_binds))))
             {
                 ERR("Failed to allocate sparse memory bind info.\n");
                 goto cleanup;
             }
-
-            opaque_info.image = dst_resource->res.vk_image;
-            opaque_info.bindCount = opaque_bind_count;
-            opaque_info.pBinds = memory_binds;
-
-            bind_sparse_info.imageOpaqueBindCount = 1;
-            bind_sparse_info.pImageOpaqueBinds = &opaque_info;
         }
 
         if (image_bind_count)
         {
-            if (!(image_binds = vkd3d_malloc(image_bind_count * sizeof(*image_binds))))
+            if (!(image_binds = vkd3d_sparse_bind_batch_alloc(batch, image_bind_count * sizeof(*image_binds))))
             {
                 ERR("Failed to allocate sparse memory bind info.\n");
                 goto cleanup;
             }
+        }
+
+        if (opaque_bind_count)
+        {
+            opaque_info = &batch->opaque_infos[batch->opaque_info_count++];
+            opaque_info->image = dst_resource->res.vk_image;
+            opaque_info->bindCount = opaque_bind_count;
+            opaque_info->pBinds = memory_binds;
+        }
 
+        if (image_bind_count)
+        {
             /* The image bind count is not exact but only an upper limit,
              * so do the actual counting while filling in bind infos */
-            image_info.image = dst_resource->res.vk_image;
-            image_info.bindCount = 0;
-            image_info.pBinds = image_binds;
-
-            bind_sparse_info.imageBindCount = 1;
-            bind_sparse_info.pImageBinds = &image_info;
+            image_info = &batch->image_infos[batch->image_info_count++];
+            image_info->image = dst_resource->res.vk_image;
+            image_info->bindCount = 0;
+            image_info->pBinds = image_binds;
         }
     }
 
@@ -14399,6 +17610,10 @@ static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_
     {
         struct vkd3d_sparse_memory_bind_range *bind = &bind_ranges[i];
 
+        if (!d3d12_sparse_info_map_tiles(&dst_resource->sparse, bind->tile_index,
+                bind->tile_count, bind->vk_memory, bind->vk_offset))
+            ERR("Failed to update tile mappings for resource %p.\n", dst_resource);
+
         while (bind->tile_count)
         {
             struct d3d12_sparse_tile *tile = &dst_resource->sparse.tiles[bind->tile_index];
@@ -14413,7 +17628,7 @@ static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_
                     /* Bind entire subresource at once to reduce overhead */
                     const struct d3d12_sparse_tile *last_tile = &tile[tile_count - 1];
 
-                    VkSparseImageMemoryBind *vk_bind = &image_binds[image_info.bindCount++];
+                    VkSparseImageMemoryBind *vk_bind = &image_binds[image_info->bindCount++];
                     vk_bind->subresource = tile->image.subresource;
                     vk_bind->offset = tile->image.offset;
                     vk_bind->extent.width = last_tile->image.offset.x + last_tile->image.extent.width;
@@ -14427,7 +17642,7 @@ static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_
                 }
                 else
                 {
-                    VkSparseImageMemoryBind *vk_bind = &image_binds[image_info.bindCount++];
+                    VkSparseImageMemoryBind *vk_bind = &image_binds[image_info->bindCount++];
                     vk_bind->subresource = tile->image.subresource;
                     vk_bind->offset = tile->image.offset;
                     vk_bind->extent = tile->image.extent;
@@ -14454,18 +17669,53 @@ static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_
                 processed_tiles = bind->tile_count;
             }
 
-            for (j = 0; j < processed_tiles; j++)
-            {
-                tile[j].vk_memory = bind->vk_memory;
-                tile[j].vk_offset = bind->vk_offset + j * VKD3D_TILE_SIZE;
-            }
-
             bind->tile_index += processed_tiles;
             bind->tile_count -= processed_tiles;
             bind->vk_offset += processed_tiles * VKD3D_TILE_SIZE;
         }
     }
 
+cleanup:
+    if (owns_bind_ranges)
+        vkd3d_free(bind_ranges);
+}
+
+static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_queue,
+        const struct d3d12_command_queue_submission_bind_sparse *sparse_binds, unsigned int sparse_bind_count)
+{
+    const struct vkd3d_vk_device_procs *vk_procs;
+    struct vkd3d_sparse_bind_batch batch;
+    VkSemaphoreSubmitInfo semaphore_info;
+    VkBindSparseInfo bind_sparse_info;
+    struct vkd3d_queue *queue_sparse;
+    struct vkd3d_queue *queue;
+    VkSubmitInfo2 submit_info;
+    VkQueue vk_queue_sparse;
+    VkQueue vk_queue;
+    unsigned int i;
+    VkResult vr;
+
+    vk_procs = &command_queue->device->vk_procs;
+
+    batch.buffer_info_count = 0;
+    batch.opaque_info_count = 0;
+    batch.image_info_count = 0;
+    batch.allocation_count = 0;
+
+    assert(sparse_bind_count <= VKD3D_MAX_COALESCED_SPARSE_BINDS);
+
+    for (i = 0; i < sparse_bind_count; i++)
+        d3d12_command_queue_add_sparse_bind(command_queue, &batch, &sparse_binds[i]);
+
+    memset(&bind_sparse_info, 0, sizeof(bind_sparse_info));
+    bind_sparse_info.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
+    bind_sparse_info.bufferBindCount = batch.buffer_info_count;
+    bind_sparse_info.pBufferBinds = batch.buffer_infos;
+    bind_sparse_info.imageOpaqueBindCount = batch.opaque_info_count;
+    bind_sparse_info.pImageOpaqueBinds = batch.opaque_infos;
+    bind_sparse_info.imageBindCount = batch.image_info_count;
+    bind_sparse_info.pImageBinds = batch.image_infos;
+
     /* Ensure that we use a queue that supports sparse binding */
     queue = command_queue->vkd3d_queue;
 
@@ -14537,9 +17787,8 @@ static void d3d12_command_queue_bind_sparse(struct d3d12_command_queue *command_
     VKD3D_DEVICE_REPORT_BREADCRUMB_IF(command_queue->device, vr == VK_ERROR_DEVICE_LOST);
 
 cleanup:
-    vkd3d_free(memory_binds);
-    vkd3d_free(image_binds);
-    vkd3d_free(bind_ranges);
+    for (i = 0; i < batch.allocation_count; i++)
+        vkd3d_free(batch.allocations[i]);
 }
 
 void d3d12_command_queue_submit_stop(struct d3d12_command_queue *queue)
@@ -14558,26 +17807,94 @@ void d3d12_command_queue_enqueue_callback(struct d3d12_command_queue *queue, voi
     d3d12_command_queue_add_submission(queue, &sub);
 }
 
-static void d3d12_command_queue_add_submission_locked(struct d3d12_command_queue *queue,
-                                                      const struct d3d12_command_queue_submission *sub)
-{
-    vkd3d_array_reserve((void**)&queue->submissions, &queue->submissions_size,
-                        queue->submissions_count + 1, sizeof(*queue->submissions));
-    queue->submissions[queue->submissions_count++] = *sub;
-    pthread_cond_signal(&queue->queue_cond);
-}
-
 static void d3d12_command_queue_add_submission(struct d3d12_command_queue *queue,
         const struct d3d12_command_queue_submission *sub)
 {
+    struct d3d12_command_queue_submission_slot *slot;
+    uint32_t pos, seq, expected;
+    int32_t diff;
+
     /* Ensure that any non-temporal writes from CopyDescriptors are ordered properly
      * with the submission thread that calls vkQueueSubmit. */
     if (d3d12_device_use_embedded_mutable_descriptors(queue->device))
         vkd3d_memcpy_non_temporal_barrier();
 
-    pthread_mutex_lock(&queue->queue_lock);
-    d3d12_command_queue_add_submission_locked(queue, sub);
-    pthread_mutex_unlock(&queue->queue_lock);
+    pos = vkd3d_atomic_uint32_load_explicit(&queue->submission_ring_write, vkd3d_memory_order_relaxed);
+
+    for (;;)
+    {
+        slot = &queue->submission_ring[pos & VKD3D_SUBMISSION_RING_MASK];
+        seq = vkd3d_atomic_uint32_load_explicit(&slot->sequence, vkd3d_memory_order_acquire);
+        diff = (int32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            expected = pos;
+            pos = vkd3d_atomic_uint32_compare_exchange(&queue->submission_ring_write, expected, expected + 1,
+                    vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed);
+            if (pos == expected)
+                break;
+        }
+        else
+        {
+            /* If diff < 0, the ring is full and the submission thread has fallen far behind.
+             * It is guaranteed to be busy, so just spin until it frees up a slot. */
+            if (diff < 0)
+                vkd3d_pause();
+            pos = vkd3d_atomic_uint32_load_explicit(&queue->submission_ring_write, vkd3d_memory_order_relaxed);
+        }
+    }
+
+    slot->submission = *sub;
+
+    /* Sequentially consistent so that either we observe the parked flag,
+     * or the submission thread observes the published slot before sleeping. */
+    vkd3d_atomic_uint32_store_explicit(&slot->sequence, pos + 1, vkd3d_memory_order_seq_cst);
+
+    if (vkd3d_atomic_uint32_load_explicit(&queue->submission_thread_parked, vkd3d_memory_order_seq_cst) &&
+            vkd3d_atomic_uint32_exchange_explicit(&queue->submission_thread_parked, 0, vkd3d_memory_order_seq_cst))
+        vkd3d_futex_wake_one(&queue->submission_thread_parked);
+}
+
+static size_t d3d12_command_queue_dequeue_submissions(struct d3d12_command_queue *queue,
+        struct d3d12_command_queue_submission *submissions, size_t max_count)
+{
+    struct d3d12_command_queue_submission_slot *slot;
+    uint32_t pos = queue->submission_ring_read;
+    size_t count = 0;
+
+    while (count < max_count)
+    {
+        slot = &queue->submission_ring[pos & VKD3D_SUBMISSION_RING_MASK];
+        if (vkd3d_atomic_uint32_load_explicit(&slot->sequence, vkd3d_memory_order_acquire) != pos + 1)
+            break;
+
+        submissions[count++] = slot->submission;
+        vkd3d_atomic_uint32_store_explicit(&slot->sequence, pos + VKD3D_SUBMISSION_RING_SIZE,
+                vkd3d_memory_order_release);
+        pos++;
+    }
+
+    queue->submission_ring_read = pos;
+    return count;
+}
+
+static void d3d12_command_queue_wait_for_submissions(struct d3d12_command_queue *queue)
+{
+    struct d3d12_command_queue_submission_slot *slot;
+    uint32_t pos = queue->submission_ring_read;
+
+    slot = &queue->submission_ring[pos & VKD3D_SUBMISSION_RING_MASK];
+
+    for (;;)
+    {
+        vkd3d_atomic_uint32_store_explicit(&queue->submission_thread_parked, 1, vkd3d_memory_order_seq_cst);
+        if (vkd3d_atomic_uint32_load_explicit(&slot->sequence, vkd3d_memory_order_seq_cst) == pos + 1)
+            break;
+        vkd3d_futex_wait(&queue->submission_thread_parked, 1);
+    }
+
+    vkd3d_atomic_uint32_store_explicit(&queue->submission_thread_parked, 0, vkd3d_memory_order_relaxed);
 }
 
 static void d3d12_command_queue_acquire_serialized(struct d3d12_command_queue *queue)
@@ -14592,7 +17909,7 @@ static void d3d12_command_queue_acquire_serialized(struct d3d12_command_queue *q
     pthread_mutex_lock(&queue->queue_lock);
 
     current_drain = ++queue->drain_count;
-    d3d12_command_queue_add_submission_locked(queue, &sub);
+    d3d12_command_queue_add_submission(queue, &sub);
 
     while (current_drain != queue->queue_drain_count)
         pthread_cond_wait(&queue->queue_cond, &queue->queue_lock);
@@ -14611,13 +17928,20 @@ void d3d12_command_queue_signal_inline(struct d3d12_command_queue *queue, d3d12_
         d3d12_command_queue_signal(queue, impl_from_ID3D12Fence1(fence), value);
 }
 
+#define VKD3D_SUBMISSION_BATCH_SIZE 32
+
 static void *d3d12_command_queue_submission_worker_main(void *userdata)
 {
+    struct d3d12_command_queue_submission_bind_sparse sparse_binds[VKD3D_MAX_COALESCED_SPARSE_BINDS];
+    struct d3d12_command_queue_submission_execute executes[VKD3D_MAX_COALESCED_EXECUTES];
+    VkSemaphoreSubmitInfo transition_semaphores[VKD3D_MAX_COALESCED_EXECUTES];
+    VkCommandBufferSubmitInfo transition_cmds[VKD3D_MAX_COALESCED_EXECUTES];
+    struct d3d12_command_queue_submission batch[VKD3D_SUBMISSION_BATCH_SIZE];
     struct d3d12_command_queue_submission submission;
     struct d3d12_command_queue_transition_pool pool;
     struct d3d12_command_queue *queue = userdata;
-    VkSemaphoreSubmitInfo transition_semaphore;
-    VkCommandBufferSubmitInfo transition_cmd;
+    unsigned int execute_count, sparse_bind_count, j;
+    size_t batch_count, batch_index;
     VKD3D_UNUSED unsigned int i;
     HRESULT hr;
 
@@ -14626,20 +17950,25 @@ static void *d3d12_command_queue_submission_worker_main(void *userdata)
     VKD3D_REGION_DECL(queue_execute);
 
     vkd3d_set_thread_name("vkd3d_queue");
+    vkd3d_set_thread_role(VKD3D_THREAD_ROLE_SUBMISSION);
 
     if (FAILED(hr = d3d12_command_queue_transition_pool_init(&pool, queue)))
         ERR("Failed to initialize transition pool.\n");
 
+    batch_count = 0;
+    batch_index = 0;
+
     for (;;)
     {
-        pthread_mutex_lock(&queue->queue_lock);
-        while (queue->submissions_count == 0)
-            pthread_cond_wait(&queue->queue_cond, &queue->queue_lock);
+        if (batch_index == batch_count)
+        {
+            /* Only park when the ring is empty. Claim as much as we can in one go. */
+            while (!(batch_count = d3d12_command_queue_dequeue_submissions(queue, batch, ARRAY_SIZE(batch))))
+                d3d12_command_queue_wait_for_submissions(queue);
+            batch_index = 0;
+        }
 
-        queue->submissions_count--;
-        submission = queue->submissions[0];
-        memmove(queue->submissions, queue->submissions + 1, queue->submissions_count * sizeof(submission));
-        pthread_mutex_unlock(&queue->queue_lock);
+        submission = batch[batch_index++];
 
         if (submission.type != VKD3D_SUBMISSION_WAIT)
         {
@@ -14676,52 +18005,86 @@ static void *d3d12_command_queue_submission_worker_main(void *userdata)
         case VKD3D_SUBMISSION_EXECUTE:
             VKD3D_REGION_BEGIN(queue_execute);
 
-            memset(&transition_cmd, 0, sizeof(transition_cmd));
-            transition_cmd.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
-
-            memset(&transition_semaphore, 0, sizeof(transition_semaphore));
-            transition_semaphore.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-            transition_semaphore.semaphore = pool.timeline;
-            transition_semaphore.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-
-            d3d12_command_queue_transition_pool_build(&pool, queue->device,
-                    submission.execute.transitions,
-                    submission.execute.transition_count,
-                    &transition_cmd.commandBuffer,
-                    &transition_semaphore.value);
-
-            d3d12_command_queue_execute(queue, submission.execute.cmd,
-                    submission.execute.cmd_count,
-                    &transition_cmd, &transition_semaphore,
-                    submission.execute.outstanding_submissions_counters,
-                    submission.execute.outstanding_submissions_counter_count,
-                    submission.execute.debug_capture);
-
-            /* command_queue_execute takes ownership of the outstanding_submission_counters allocation.
-             * The atomic counters are decremented when the submission is observed to be freed.
-             * On error, the counters are freed early, so there is no risk of leak. */
-            vkd3d_free(submission.execute.cmd);
-            vkd3d_free(submission.execute.transitions);
-#ifdef VKD3D_ENABLE_BREADCRUMBS
-            for (i = 0; i < submission.execute.breadcrumb_indices_count; i++)
+            /* Coalesce back-to-back ExecuteCommandLists into a single vkQueueSubmit2.
+             * Anything which is not an EXECUTE acts as a barrier to merging.
+             * The transition pool can only have a limited number of command buffers in flight
+             * which have not been submitted yet, which bounds how much we can merge. */
+            executes[0] = submission.execute;
+            execute_count = 1;
+
+            while (!executes[0].debug_capture &&
+                    execute_count < VKD3D_MAX_COALESCED_EXECUTES &&
+                    batch_index < batch_count &&
+                    batch[batch_index].type == VKD3D_SUBMISSION_EXECUTE &&
+                    !batch[batch_index].execute.debug_capture)
+            {
+                executes[execute_count++] = batch[batch_index++].execute;
+            }
+
+            for (j = 0; j < execute_count; j++)
             {
-                INFO("=== Executing command list %u (context %u) on VkQueue %p, queue family %u ===\n",
-                        i, submission.execute.breadcrumb_indices[i],
-                        (void*)queue->vkd3d_queue->vk_queue, queue->vkd3d_queue->vk_family_index);
-                vkd3d_breadcrumb_tracer_dump_command_list(&queue->device->breadcrumb_tracer,
-                        submission.execute.breadcrumb_indices[i]);
-                INFO("============================\n");
+                memset(&transition_cmds[j], 0, sizeof(transition_cmds[j]));
+                transition_cmds[j].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+
+                memset(&transition_semaphores[j], 0, sizeof(transition_semaphores[j]));
+                transition_semaphores[j].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+                transition_semaphores[j].semaphore = pool.timeline;
+                transition_semaphores[j].stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+                d3d12_command_queue_transition_pool_build(&pool, queue->device,
+                        executes[j].transitions,
+                        executes[j].transition_count,
+                        &transition_cmds[j].commandBuffer,
+                        &transition_semaphores[j].value);
             }
-            vkd3d_free(submission.execute.breadcrumb_indices);
+
+            d3d12_command_queue_execute(queue, executes,
+                    transition_cmds, transition_semaphores, execute_count);
+
+            for (j = 0; j < execute_count; j++)
+            {
+                /* command_queue_execute takes ownership of the outstanding_submission_counters allocation.
+                 * The atomic counters are decremented when the submission is observed to be freed.
+                 * On error, the counters are freed early, so there is no risk of leak. */
+                vkd3d_free(executes[j].cmd);
+                vkd3d_free(executes[j].transitions);
+#ifdef VKD3D_ENABLE_BREADCRUMBS
+                for (i = 0; i < executes[j].breadcrumb_indices_count; i++)
+                {
+                    INFO("=== Executing command list %u (context %u) on VkQueue %p, queue family %u ===\n",
+                            i, executes[j].breadcrumb_indices[i],
+                            (void*)queue->vkd3d_queue->vk_queue, queue->vkd3d_queue->vk_family_index);
+                    vkd3d_breadcrumb_tracer_dump_command_list(&queue->device->breadcrumb_tracer,
+                            executes[j].breadcrumb_indices[i]);
+                    INFO("============================\n");
+                }
+                vkd3d_free(executes[j].breadcrumb_indices);
 #endif
-            VKD3D_REGION_END(queue_execute);
+            }
+            VKD3D_REGION_END_ITERATIONS(queue_execute, execute_count);
             break;
 
         case VKD3D_SUBMISSION_BIND_SPARSE:
-            d3d12_command_queue_bind_sparse(queue, submission.bind_sparse.mode,
-                    submission.bind_sparse.dst_resource, submission.bind_sparse.src_resource,
-                    submission.bind_sparse.bind_count, submission.bind_sparse.bind_infos);
-            vkd3d_free(submission.bind_sparse.bind_infos);
+            /* Coalesce back-to-back tile mapping updates into a single vkQueueBindSparse,
+             * since every bind costs a semaphore roundtrip with the submission queue. */
+            sparse_binds[0] = submission.bind_sparse;
+            sparse_bind_count = 1;
+
+            while (sparse_bind_count < VKD3D_MAX_COALESCED_SPARSE_BINDS &&
+                    batch_index < batch_count &&
+                    batch[batch_index].type == VKD3D_SUBMISSION_BIND_SPARSE &&
+                    !vkd3d_sparse_bind_conflicts(sparse_binds, sparse_bind_count, &batch[batch_index].bind_sparse))
+            {
+                sparse_binds[sparse_bind_count++] = batch[batch_index++].bind_sparse;
+            }
+
+            d3d12_command_queue_bind_sparse(queue, sparse_binds, sparse_bind_count);
+
+            for (j = 0; j < sparse_bind_count; j++)
+            {
+                vkd3d_free(sparse_binds[j].bind_infos);
+                vkd3d_free(sparse_binds[j].bind_ranges);
+            }
             break;
 
         case VKD3D_SUBMISSION_DRAIN:
@@ -14753,6 +18116,7 @@ cleanup:
 static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
         struct d3d12_device *device, const D3D12_COMMAND_QUEUE_DESC *desc)
 {
+    unsigned int i;
     HRESULT hr;
     int rc;
 
@@ -14764,17 +18128,27 @@ static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
         queue->desc.NodeMask = 0x1;
 
     queue->vkd3d_queue = d3d12_device_allocate_vkd3d_queue(device,
-            d3d12_device_get_vkd3d_queue_family(device, desc->Type));
-    queue->submissions = NULL;
-    queue->submissions_count = 0;
-    queue->submissions_size = 0;
+            d3d12_device_get_vkd3d_queue_family(device, desc->Type),
+            desc->Priority >= D3D12_COMMAND_QUEUE_PRIORITY_HIGH);
+    queue->submission_ring_write = 0;
+    queue->submission_ring_read = 0;
+    queue->submission_thread_parked = 0;
     queue->drain_count = 0;
     queue->queue_drain_count = 0;
 
+    if (!(queue->submission_ring = vkd3d_malloc(VKD3D_SUBMISSION_RING_SIZE * sizeof(*queue->submission_ring))))
+    {
+        hr = E_OUTOFMEMORY;
+        goto fail;
+    }
+
+    for (i = 0; i < VKD3D_SUBMISSION_RING_SIZE; i++)
+        queue->submission_ring[i].sequence = i;
+
     if ((rc = pthread_mutex_init(&queue->queue_lock, NULL)) < 0)
     {
         hr = hresult_from_errno(rc);
-        goto fail;
+        goto fail_pthread_mutex;
     }
 
     if ((rc = pthread_cond_init(&queue->queue_cond, NULL)) < 0)
@@ -14784,9 +18158,12 @@ static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
     }
 
     if (desc->Priority == D3D12_COMMAND_QUEUE_PRIORITY_GLOBAL_REALTIME)
-        FIXME("Global realtime priority is not implemented.\n");
-    if (desc->Priority)
+        FIXME("Global realtime priority is not implemented, treating as high priority.\n");
+    else if (desc->Priority && desc->Priority != D3D12_COMMAND_QUEUE_PRIORITY_HIGH)
         FIXME("Ignoring priority %#x.\n", desc->Priority);
+
+    if (desc->Priority >= D3D12_COMMAND_QUEUE_PRIORITY_HIGH && !queue->vkd3d_queue->high_priority)
+        WARN("No high priority queue available for queue type %#x.\n", desc->Type);
     if (desc->Flags)
         FIXME("Ignoring flags %#x.\n", desc->Flags);
 
@@ -14798,6 +18175,10 @@ static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
 
     d3d12_device_add_ref(queue->device = device);
 
+    /* The watchdog is a debugging aid, never fail queue creation because of it. */
+    if (FAILED(hr = vkd3d_queue_watchdog_init(&queue->watchdog, queue)))
+        WARN("Failed to initialize queue watchdog, hr %#x.\n", hr);
+
     if (FAILED(hr = vkd3d_fence_worker_start(&queue->fence_worker, device)))
         goto fail_fence_worker_start;
 
@@ -14812,13 +18193,16 @@ static HRESULT d3d12_command_queue_init(struct d3d12_command_queue *queue,
 
 fail_pthread_create:
     vkd3d_fence_worker_stop(&queue->fence_worker, device);
-fail_fence_worker_start:;
+fail_fence_worker_start:
+    vkd3d_queue_watchdog_cleanup(&queue->watchdog, queue);
 fail_swapchain_factory:
     vkd3d_private_store_destroy(&queue->private_store);
 fail_private_store:
     pthread_cond_destroy(&queue->queue_cond);
 fail_pthread_cond:
     pthread_mutex_destroy(&queue->queue_lock);
+fail_pthread_mutex:
+    vkd3d_free(queue->submission_ring);
 fail:
     d3d12_device_unmap_vkd3d_queue(device, queue->vkd3d_queue);
     return hr;
@@ -14930,7 +18314,12 @@ static void d3d12_command_signature_cleanup(struct d3d12_command_signature *sign
 {
     const struct vkd3d_vk_device_procs *vk_procs = &signature->device->vk_procs;
 
-    if ((signature->pipeline_type == VKD3D_PIPELINE_TYPE_GRAPHICS ||
+    if (signature->uses_ext_state_template)
+    {
+        VK_CALL(vkDestroyIndirectCommandsLayoutEXT(signature->device->vk_device,
+                signature->state_template.ext.layout, NULL));
+    }
+    else if ((signature->pipeline_type == VKD3D_PIPELINE_TYPE_GRAPHICS ||
             signature->pipeline_type == VKD3D_PIPELINE_TYPE_MESH_GRAPHICS) &&
             signature->device->device_info.device_generated_commands_features_nv.deviceGeneratedCommands)
     {
@@ -14939,6 +18328,8 @@ static void d3d12_command_signature_cleanup(struct d3d12_command_signature *sign
         VK_CALL(vkDestroyIndirectCommandsLayoutNV(signature->device->vk_device, signature->state_template.graphics.layout, NULL));
     }
 
+    d3d12_command_signature_cleanup_indirect_cache(signature);
+
     vkd3d_private_store_destroy(&signature->private_store);
     vkd3d_free((void *)signature->desc.pArgumentDescs);
     vkd3d_free(signature);
@@ -15046,74 +18437,267 @@ static HRESULT d3d12_command_signature_init_patch_commands_buffer(struct d3d12_c
     buffer_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
     buffer_desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-    if (FAILED(hr = vkd3d_create_buffer(device, &heap_info, D3D12_HEAP_FLAG_NONE,
-            &buffer_desc, &signature->state_template.graphics.buffer)))
-        return hr;
+    if (FAILED(hr = vkd3d_create_buffer(device, &heap_info, D3D12_HEAP_FLAG_NONE,
+            &buffer_desc, &signature->state_template.graphics.buffer)))
+        return hr;
+
+    if (FAILED(hr = vkd3d_allocate_internal_buffer_memory(device, signature->state_template.graphics.buffer,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            &signature->state_template.graphics.memory)))
+        return hr;
+
+    signature->state_template.graphics.buffer_va = vkd3d_get_buffer_device_address(device,
+            signature->state_template.graphics.buffer);
+
+    if ((vr = VK_CALL(vkMapMemory(device->vk_device, signature->state_template.graphics.memory.vk_memory,
+            0, VK_WHOLE_SIZE, 0, (void**)&ptr))))
+        return hr;
+
+    memcpy(ptr, commands, command_count * sizeof(struct vkd3d_patch_command));
+    VK_CALL(vkUnmapMemory(device->vk_device, signature->state_template.graphics.memory.vk_memory));
+
+    return hr;
+}
+
+static HRESULT d3d12_command_signature_init_indirect_commands_layout(
+        struct d3d12_command_signature *signature, struct d3d12_device *device,
+        const VkIndirectCommandsLayoutTokenNV *tokens, uint32_t token_count,
+        uint32_t stream_stride)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkIndirectCommandsLayoutCreateInfoNV create_info;
+    VkResult vr;
+
+    create_info.sType = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_CREATE_INFO_NV;
+    create_info.pNext = NULL;
+    create_info.flags = 0;
+    create_info.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    create_info.streamCount = 1;
+    create_info.pStreamStrides = &stream_stride;
+    create_info.tokenCount = token_count;
+    create_info.pTokens = tokens;
+
+    signature->state_template.graphics.stride = stream_stride;
+
+    if (token_count > device->device_info.device_generated_commands_properties_nv.maxIndirectCommandsTokenCount)
+    {
+        FIXME("Token count %u is too large (max %u).\n",
+                token_count, device->device_info.device_generated_commands_properties_nv.maxIndirectCommandsTokenCount);
+        return E_NOTIMPL;
+    }
+
+    vr = VK_CALL(vkCreateIndirectCommandsLayoutNV(device->vk_device, &create_info, NULL,
+            &signature->state_template.graphics.layout));
+    return hresult_from_vk_result(vr);
+}
+
+static HRESULT d3d12_command_signature_allocate_stream_memory_for_list(
+        struct d3d12_command_list *list,
+        struct d3d12_command_signature *signature,
+        uint32_t max_command_count,
+        struct vkd3d_scratch_allocation *allocation)
+{
+    if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_DEVICE_STORAGE,
+            max_command_count * signature->state_template.graphics.stride,
+            list->device->device_info.device_generated_commands_properties_nv.minIndirectCommandsBufferOffsetAlignment,
+            ~0u, allocation))
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
+static HRESULT d3d12_command_signature_create_cache_buffer(struct d3d12_command_signature *signature,
+        VkDeviceSize size, struct vkd3d_execute_indirect_cache_buffer *buffer)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &signature->device->vk_procs;
+    struct d3d12_device *device = signature->device;
+    D3D12_RESOURCE_DESC1 buffer_desc;
+    D3D12_HEAP_PROPERTIES heap_info;
+    HRESULT hr;
+
+    memset(&heap_info, 0, sizeof(heap_info));
+    heap_info.Type = D3D12_HEAP_TYPE_DEFAULT;
+    memset(&buffer_desc, 0, sizeof(buffer_desc));
+    buffer_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    buffer_desc.Width = size;
+    buffer_desc.Height = 1;
+    buffer_desc.DepthOrArraySize = 1;
+    buffer_desc.SampleDesc.Count = 1;
+    buffer_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    buffer_desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    if (FAILED(hr = vkd3d_create_buffer(device, &heap_info, D3D12_HEAP_FLAG_NONE,
+            &buffer_desc, &buffer->vk_buffer)))
+        return hr;
+
+    if (FAILED(hr = vkd3d_allocate_internal_buffer_memory(device, buffer->vk_buffer,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &buffer->memory)))
+    {
+        VK_CALL(vkDestroyBuffer(device->vk_device, buffer->vk_buffer, NULL));
+        buffer->vk_buffer = VK_NULL_HANDLE;
+        return hr;
+    }
+
+    buffer->va = vkd3d_get_buffer_device_address(device, buffer->vk_buffer);
+    return S_OK;
+}
+
+static void d3d12_command_signature_destroy_cache_buffer(struct d3d12_command_signature *signature,
+        struct vkd3d_execute_indirect_cache_buffer *buffer)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &signature->device->vk_procs;
+
+    if (!buffer->vk_buffer)
+        return;
+
+    VK_CALL(vkDestroyBuffer(signature->device->vk_device, buffer->vk_buffer, NULL));
+    vkd3d_free_device_memory(signature->device, &buffer->memory);
+}
+
+static bool d3d12_command_signature_acquire_cached_stream(struct d3d12_command_signature *signature,
+        uint32_t max_command_count,
+        struct d3d12_resource *arg_buffer, UINT64 arg_buffer_offset,
+        struct d3d12_resource *count_buffer, UINT64 count_buffer_offset,
+        struct vkd3d_scratch_allocation *stream_allocation,
+        struct vkd3d_scratch_allocation *count_allocation, bool *needs_patch)
+{
+    const VkPhysicalDeviceDeviceGeneratedCommandsPropertiesNV *props;
+    struct vkd3d_execute_indirect_cache *cache = &signature->indirect_cache;
+    struct vkd3d_execute_indirect_cache_entry *entry = NULL;
+    struct vkd3d_execute_indirect_cache_entry *free_entry = NULL;
+    uint32_t arg_generation, count_generation;
+    uint64_t count_cookie;
+    VkDeviceSize size;
+    bool ret = false;
+    unsigned int i;
+
+    if (!cache->enabled)
+        return false;
+
+    /* Host-visible arguments can be rewritten at any time without us noticing. */
+    if (d3d12_resource_is_cpu_accessible(arg_buffer) ||
+            (count_buffer && d3d12_resource_is_cpu_accessible(count_buffer)))
+        return false;
 
-    if (FAILED(hr = vkd3d_allocate_internal_buffer_memory(device, signature->state_template.graphics.buffer,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            &signature->state_template.graphics.memory)))
-        return hr;
+    arg_generation = vkd3d_atomic_uint32_load_explicit(&arg_buffer->indirect_generation, vkd3d_memory_order_relaxed);
+    count_generation = count_buffer ?
+            vkd3d_atomic_uint32_load_explicit(&count_buffer->indirect_generation, vkd3d_memory_order_relaxed) : 0;
+    count_cookie = count_buffer ? count_buffer->res.cookie : 0;
 
-    signature->state_template.graphics.buffer_va = vkd3d_get_buffer_device_address(device,
-            signature->state_template.graphics.buffer);
+    props = &signature->device->device_info.device_generated_commands_properties_nv;
+    size = align(max_command_count * signature->state_template.graphics.stride,
+            props->minSequencesCountBufferOffsetAlignment) + sizeof(uint32_t);
 
-    if ((vr = VK_CALL(vkMapMemory(device->vk_device, signature->state_template.graphics.memory.vk_memory,
-            0, VK_WHOLE_SIZE, 0, (void**)&ptr))))
-        return hr;
+    pthread_mutex_lock(&cache->mutex);
 
-    memcpy(ptr, commands, command_count * sizeof(struct vkd3d_patch_command));
-    VK_CALL(vkUnmapMemory(device->vk_device, signature->state_template.graphics.memory.vk_memory));
+    for (i = 0; i < ARRAY_SIZE(cache->entries); i++)
+    {
+        struct vkd3d_execute_indirect_cache_entry *e = &cache->entries[i];
 
-    return hr;
+        if (!e->buffer.vk_buffer)
+        {
+            if (!free_entry)
+                free_entry = e;
+        }
+        else if (e->arg_cookie == arg_buffer->res.cookie && e->arg_offset == arg_buffer_offset &&
+                e->count_cookie == count_cookie && e->count_offset == count_buffer_offset &&
+                e->max_command_count == max_command_count)
+        {
+            entry = e;
+            break;
+        }
+    }
+
+    if (entry)
+    {
+        if (entry->arg_generation == arg_generation && entry->count_generation == count_generation)
+        {
+            *needs_patch = false;
+            ret = true;
+        }
+        else if (entry->invalidation_count < VKD3D_EXECUTE_INDIRECT_CACHE_MAX_INVALIDATIONS &&
+                vkd3d_array_reserve((void **)&cache->retired_buffers, &cache->retired_buffers_size,
+                        cache->retired_buffer_count + 1, sizeof(*cache->retired_buffers)))
+        {
+            /* Earlier submissions may still read the old stream, so patch into a fresh buffer. */
+            cache->retired_buffers[cache->retired_buffer_count++] = entry->buffer;
+            memset(&entry->buffer, 0, sizeof(entry->buffer));
+
+            if (SUCCEEDED(d3d12_command_signature_create_cache_buffer(signature, size, &entry->buffer)))
+            {
+                entry->arg_generation = arg_generation;
+                entry->count_generation = count_generation;
+                entry->invalidation_count++;
+                *needs_patch = true;
+                ret = true;
+            }
+        }
+    }
+    else if (free_entry && SUCCEEDED(d3d12_command_signature_create_cache_buffer(signature, size, &free_entry->buffer)))
+    {
+        entry = free_entry;
+        entry->arg_cookie = arg_buffer->res.cookie;
+        entry->arg_offset = arg_buffer_offset;
+        entry->count_cookie = count_cookie;
+        entry->count_offset = count_buffer_offset;
+        entry->max_command_count = max_command_count;
+        entry->arg_generation = arg_generation;
+        entry->count_generation = count_generation;
+        entry->invalidation_count = 0;
+        entry->count_buffer_offset = size - sizeof(uint32_t);
+        *needs_patch = true;
+        ret = true;
+    }
+
+    if (ret)
+    {
+        stream_allocation->buffer = entry->buffer.vk_buffer;
+        stream_allocation->offset = 0;
+        stream_allocation->va = entry->buffer.va;
+        stream_allocation->host_ptr = NULL;
+
+        count_allocation->buffer = entry->buffer.vk_buffer;
+        count_allocation->offset = entry->count_buffer_offset;
+        count_allocation->va = entry->buffer.va + entry->count_buffer_offset;
+        count_allocation->host_ptr = NULL;
+    }
+
+    pthread_mutex_unlock(&cache->mutex);
+    return ret;
 }
 
-static HRESULT d3d12_command_signature_init_indirect_commands_layout(
-        struct d3d12_command_signature *signature, struct d3d12_device *device,
-        const VkIndirectCommandsLayoutTokenNV *tokens, uint32_t token_count,
-        uint32_t stream_stride)
+static void d3d12_command_signature_init_indirect_cache(struct d3d12_command_signature *signature)
 {
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
-    VkIndirectCommandsLayoutCreateInfoNV create_info;
-    VkResult vr;
-
-    create_info.sType = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_CREATE_INFO_NV;
-    create_info.pNext = NULL;
-    create_info.flags = 0;
-    create_info.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    create_info.streamCount = 1;
-    create_info.pStreamStrides = &stream_stride;
-    create_info.tokenCount = token_count;
-    create_info.pTokens = tokens;
+    int rc;
 
-    signature->state_template.graphics.stride = stream_stride;
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_EXECUTE_INDIRECT_CACHE))
+        return;
 
-    if (token_count > device->device_info.device_generated_commands_properties_nv.maxIndirectCommandsTokenCount)
+    if ((rc = pthread_mutex_init(&signature->indirect_cache.mutex, NULL)))
     {
-        FIXME("Token count %u is too large (max %u).\n",
-                token_count, device->device_info.device_generated_commands_properties_nv.maxIndirectCommandsTokenCount);
-        return E_NOTIMPL;
+        WARN("Failed to initialize mutex, rc %d. Not caching patched streams.\n", rc);
+        return;
     }
 
-    vr = VK_CALL(vkCreateIndirectCommandsLayoutNV(device->vk_device, &create_info, NULL,
-            &signature->state_template.graphics.layout));
-    return hresult_from_vk_result(vr);
+    signature->indirect_cache.enabled = true;
 }
 
-static HRESULT d3d12_command_signature_allocate_stream_memory_for_list(
-        struct d3d12_command_list *list,
-        struct d3d12_command_signature *signature,
-        uint32_t max_command_count,
-        struct vkd3d_scratch_allocation *allocation)
+static void d3d12_command_signature_cleanup_indirect_cache(struct d3d12_command_signature *signature)
 {
-    if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
-            VKD3D_SCRATCH_POOL_KIND_DEVICE_STORAGE,
-            max_command_count * signature->state_template.graphics.stride,
-            list->device->device_info.device_generated_commands_properties_nv.minIndirectCommandsBufferOffsetAlignment,
-            ~0u, allocation))
-        return E_OUTOFMEMORY;
+    struct vkd3d_execute_indirect_cache *cache = &signature->indirect_cache;
+    size_t i;
 
-    return S_OK;
+    if (!cache->enabled)
+        return;
+
+    for (i = 0; i < ARRAY_SIZE(cache->entries); i++)
+        d3d12_command_signature_destroy_cache_buffer(signature, &cache->entries[i].buffer);
+    for (i = 0; i < cache->retired_buffer_count; i++)
+        d3d12_command_signature_destroy_cache_buffer(signature, &cache->retired_buffers[i]);
+
+    vkd3d_free(cache->retired_buffers);
+    pthread_mutex_destroy(&cache->mutex);
 }
 
 static HRESULT d3d12_command_signature_allocate_preprocess_memory_for_list(
@@ -15162,6 +18746,59 @@ static HRESULT d3d12_command_signature_allocate_preprocess_memory_for_list(
     return S_OK;
 }
 
+static HRESULT d3d12_command_signature_allocate_preprocess_memory_for_list_ext(
+        struct d3d12_command_list *list,
+        struct d3d12_command_signature *signature, VkPipeline pipeline,
+        uint32_t max_command_count,
+        struct vkd3d_scratch_allocation *allocation, VkDeviceSize *size)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &list->device->vk_procs;
+    VkGeneratedCommandsMemoryRequirementsInfoEXT info;
+    VkGeneratedCommandsPipelineInfoEXT pipeline_info;
+    VkMemoryRequirements2 memory_info;
+
+    memory_info.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    memory_info.pNext = NULL;
+
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GENERATED_COMMANDS_PIPELINE_INFO_EXT;
+    pipeline_info.pNext = NULL;
+    pipeline_info.pipeline = pipeline;
+
+    info.sType = VK_STRUCTURE_TYPE_GENERATED_COMMANDS_MEMORY_REQUIREMENTS_INFO_EXT;
+    info.pNext = &pipeline_info;
+    info.indirectExecutionSet = VK_NULL_HANDLE;
+    info.indirectCommandsLayout = signature->state_template.ext.layout;
+    info.maxSequenceCount = max_command_count;
+    info.maxDrawCount = 0;
+
+    if (max_command_count > list->device->device_info.device_generated_commands_properties_ext.maxIndirectSequenceCount)
+    {
+        FIXME("max_command_count %u exceeds device limit %u.\n",
+                max_command_count,
+                list->device->device_info.device_generated_commands_properties_ext.maxIndirectSequenceCount);
+        return E_NOTIMPL;
+    }
+
+    VK_CALL(vkGetGeneratedCommandsMemoryRequirementsEXT(list->device->vk_device, &info, &memory_info));
+
+    *size = memory_info.memoryRequirements.size;
+
+    if (!*size)
+    {
+        memset(allocation, 0, sizeof(*allocation));
+        return S_OK;
+    }
+
+    if (!d3d12_command_allocator_allocate_scratch_memory(list->allocator,
+            VKD3D_SCRATCH_POOL_KIND_INDIRECT_PREPROCESS,
+            memory_info.memoryRequirements.size,
+            memory_info.memoryRequirements.alignment,
+            memory_info.memoryRequirements.memoryTypeBits, allocation))
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
 static HRESULT d3d12_command_signature_init_state_template_compute(struct d3d12_command_signature *signature,
         const D3D12_COMMAND_SIGNATURE_DESC *desc,
         struct d3d12_root_signature *root_signature,
@@ -15497,6 +19134,231 @@ end:
     return hr;
 }
 
+union vkd3d_indirect_commands_token_data_ext
+{
+    VkIndirectCommandsPushConstantTokenEXT push_constant;
+    VkIndirectCommandsVertexBufferTokenEXT vertex_buffer;
+    VkIndirectCommandsIndexBufferTokenEXT index_buffer;
+};
+
+static HRESULT d3d12_command_signature_init_state_template_ext(struct d3d12_command_signature *signature,
+        const D3D12_COMMAND_SIGNATURE_DESC *desc,
+        struct d3d12_root_signature *root_signature,
+        struct d3d12_device *device)
+{
+    const VkPhysicalDeviceDeviceGeneratedCommandsPropertiesEXT *props =
+            &device->device_info.device_generated_commands_properties_ext;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    union vkd3d_indirect_commands_token_data_ext *token_data = NULL;
+    const struct d3d12_bind_point_layout *bind_point_layout = NULL;
+    const struct vkd3d_shader_root_parameter *root_parameter;
+    const struct vkd3d_shader_root_constant *root_constant;
+    VkIndirectCommandsLayoutTokenEXT *tokens = NULL;
+    VkIndirectCommandsLayoutCreateInfoEXT create_info;
+    VkShaderStageFlags required_stages;
+    bool uses_push_constants = false;
+    uint32_t root_parameter_index;
+    uint32_t src_offset = 0;
+    HRESULT hr = S_OK;
+    VkResult vr;
+    uint32_t i;
+
+    /* Unlike the NV path, tokens can point straight into the application's argument
+     * buffer. All D3D12 argument structures match their Vulkan counterparts, so no
+     * patching is required and the layout also covers compute and mesh signatures. */
+    switch (signature->pipeline_type)
+    {
+        case VKD3D_PIPELINE_TYPE_GRAPHICS:
+            signature->state_template.ext.stages = VK_SHADER_STAGE_VERTEX_BIT |
+                    VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT |
+                    VK_SHADER_STAGE_GEOMETRY_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+            required_stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+            break;
+
+        case VKD3D_PIPELINE_TYPE_MESH_GRAPHICS:
+            signature->state_template.ext.stages = VK_SHADER_STAGE_TASK_BIT_EXT |
+                    VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+            required_stages = VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT;
+            break;
+
+        case VKD3D_PIPELINE_TYPE_COMPUTE:
+            signature->state_template.ext.stages = VK_SHADER_STAGE_COMPUTE_BIT;
+            required_stages = VK_SHADER_STAGE_COMPUTE_BIT;
+            break;
+
+        default:
+            return E_NOTIMPL;
+    }
+
+    signature->state_template.ext.stages &= props->supportedIndirectCommandsShaderStages;
+
+    if ((signature->state_template.ext.stages & required_stages) != required_stages)
+    {
+        WARN("Shader stages %#x are not supported for device generated commands.\n", required_stages);
+        return E_NOTIMPL;
+    }
+
+    if (desc->NumArgumentDescs > props->maxIndirectCommandsTokenCount)
+    {
+        WARN("Token count %u is too large (max %u).\n", desc->NumArgumentDescs, props->maxIndirectCommandsTokenCount);
+        return E_NOTIMPL;
+    }
+
+    if (desc->ByteStride > props->maxIndirectCommandsIndirectStride)
+    {
+        WARN("Stride %u is too large (max %u).\n", desc->ByteStride, props->maxIndirectCommandsIndirectStride);
+        return E_NOTIMPL;
+    }
+
+    if (root_signature)
+        bind_point_layout = d3d12_root_signature_get_layout(root_signature, signature->pipeline_type);
+
+    if (!(tokens = vkd3d_calloc(desc->NumArgumentDescs, sizeof(*tokens))) ||
+            !(token_data = vkd3d_calloc(desc->NumArgumentDescs, sizeof(*token_data))))
+    {
+        hr = E_OUTOFMEMORY;
+        goto end;
+    }
+
+    for (i = 0; i < desc->NumArgumentDescs; i++)
+    {
+        const D3D12_INDIRECT_ARGUMENT_DESC *argument_desc = &desc->pArgumentDescs[i];
+        VkIndirectCommandsLayoutTokenEXT *token = &tokens[i];
+
+        token->sType = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_TOKEN_EXT;
+        token->pNext = NULL;
+        token->offset = src_offset;
+
+        if (src_offset > props->maxIndirectCommandsTokenOffset)
+        {
+            WARN("Token offset %u is too large (max %u).\n", src_offset, props->maxIndirectCommandsTokenOffset);
+            hr = E_NOTIMPL;
+            goto end;
+        }
+
+        switch (argument_desc->Type)
+        {
+            case D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT:
+                root_parameter_index = argument_desc->Constant.RootParameterIndex;
+                root_constant = root_signature_get_32bit_constants(root_signature, root_parameter_index);
+
+                if (bind_point_layout->flags & VKD3D_ROOT_SIGNATURE_USE_PUSH_CONSTANT_UNIFORM_BLOCK)
+                {
+                    WARN("Root signature uses push UBO for root parameters, but this feature requires push constant path.\n");
+                    hr = E_NOTIMPL;
+                    goto end;
+                }
+
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_PUSH_CONSTANT_EXT;
+                token->data.pPushConstant = &token_data[i].push_constant;
+                token_data[i].push_constant.updateRange.stageFlags = bind_point_layout->vk_push_stages;
+                token_data[i].push_constant.updateRange.offset = sizeof(uint32_t) *
+                        (root_constant->constant_index + argument_desc->Constant.DestOffsetIn32BitValues);
+                token_data[i].push_constant.updateRange.size =
+                        sizeof(uint32_t) * argument_desc->Constant.Num32BitValuesToSet;
+                src_offset += token_data[i].push_constant.updateRange.size;
+                uses_push_constants = true;
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_UNORDERED_ACCESS_VIEW:
+            case D3D12_INDIRECT_ARGUMENT_TYPE_SHADER_RESOURCE_VIEW:
+            case D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW:
+                root_parameter_index = argument_desc->ShaderResourceView.RootParameterIndex;
+                root_parameter = root_signature_get_parameter(root_signature, root_parameter_index);
+
+                if (bind_point_layout->flags & VKD3D_ROOT_SIGNATURE_USE_PUSH_CONSTANT_UNIFORM_BLOCK)
+                {
+                    WARN("Root signature uses push UBO for root parameters, but this feature requires push constant path.\n");
+                    hr = E_NOTIMPL;
+                    goto end;
+                }
+
+                if (!(root_signature->root_descriptor_raw_va_mask & (1ull << root_parameter_index)))
+                {
+                    ERR("Root parameter %u is not a raw VA. Cannot implement command signature which updates root descriptor.\n",
+                            root_parameter_index);
+                    hr = E_NOTIMPL;
+                    goto end;
+                }
+
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_PUSH_CONSTANT_EXT;
+                token->data.pPushConstant = &token_data[i].push_constant;
+                token_data[i].push_constant.updateRange.stageFlags = bind_point_layout->vk_push_stages;
+                token_data[i].push_constant.updateRange.offset =
+                        root_parameter->descriptor.raw_va_root_descriptor_index * sizeof(VkDeviceAddress);
+                token_data[i].push_constant.updateRange.size = sizeof(VkDeviceAddress);
+                src_offset += sizeof(D3D12_GPU_VIRTUAL_ADDRESS);
+                uses_push_constants = true;
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_VERTEX_BUFFER_VIEW:
+                /* D3D12_VERTEX_BUFFER_VIEW matches VkBindVertexBufferIndirectCommandEXT. */
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_VERTEX_BUFFER_EXT;
+                token->data.pVertexBuffer = &token_data[i].vertex_buffer;
+                token_data[i].vertex_buffer.vertexBindingUnit = argument_desc->VertexBuffer.Slot;
+                src_offset += sizeof(D3D12_VERTEX_BUFFER_VIEW);
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_INDEX_BUFFER_VIEW:
+                if (!(props->supportedIndirectCommandsInputModes & VK_INDIRECT_COMMANDS_INPUT_MODE_DXGI_INDEX_BUFFER_EXT))
+                {
+                    WARN("DXGI index buffer input mode is not supported.\n");
+                    hr = E_NOTIMPL;
+                    goto end;
+                }
+
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_INDEX_BUFFER_EXT;
+                token->data.pIndexBuffer = &token_data[i].index_buffer;
+                token_data[i].index_buffer.mode = VK_INDIRECT_COMMANDS_INPUT_MODE_DXGI_INDEX_BUFFER_EXT;
+                src_offset += sizeof(D3D12_INDEX_BUFFER_VIEW);
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_DRAW:
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_DRAW_EXT;
+                src_offset += sizeof(D3D12_DRAW_ARGUMENTS);
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED:
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_DRAW_INDEXED_EXT;
+                src_offset += sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH:
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_DISPATCH_EXT;
+                src_offset += sizeof(D3D12_DISPATCH_ARGUMENTS);
+                break;
+
+            case D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH_MESH:
+                token->type = VK_INDIRECT_COMMANDS_TOKEN_TYPE_DRAW_MESH_TASKS_EXT;
+                src_offset += sizeof(D3D12_DISPATCH_MESH_ARGUMENTS);
+                break;
+
+            default:
+                FIXME("Unsupported token type %u.\n", argument_desc->Type);
+                hr = E_NOTIMPL;
+                goto end;
+        }
+    }
+
+    create_info.sType = VK_STRUCTURE_TYPE_INDIRECT_COMMANDS_LAYOUT_CREATE_INFO_EXT;
+    create_info.pNext = NULL;
+    create_info.flags = 0;
+    create_info.shaderStages = signature->state_template.ext.stages;
+    create_info.indirectStride = desc->ByteStride;
+    create_info.pipelineLayout = uses_push_constants ? bind_point_layout->vk_pipeline_layout : VK_NULL_HANDLE;
+    create_info.tokenCount = desc->NumArgumentDescs;
+    create_info.pTokens = tokens;
+
+    vr = VK_CALL(vkCreateIndirectCommandsLayoutEXT(device->vk_device, &create_info, NULL,
+            &signature->state_template.ext.layout));
+    hr = hresult_from_vk_result(vr);
+
+end:
+    vkd3d_free(token_data);
+    vkd3d_free(tokens);
+    return hr;
+}
+
 HRESULT d3d12_command_signature_create(struct d3d12_device *device, struct d3d12_root_signature *root_signature,
         const D3D12_COMMAND_SIGNATURE_DESC *desc,
         struct d3d12_command_signature **signature)
@@ -15648,12 +19510,26 @@ HRESULT d3d12_command_signature_create(struct d3d12_device *device, struct d3d12
     if (FAILED(hr = vkd3d_private_store_init(&object->private_store)))
         goto err;
 
-    if ((object->requires_state_template = requires_state_template))
+    object->pipeline_type = pipeline_type;
+
+    if ((object->requires_state_template = requires_state_template) &&
+            device->device_info.device_generated_commands_features_ext.deviceGeneratedCommands)
+    {
+        if (SUCCEEDED(hr = d3d12_command_signature_init_state_template_ext(object, desc, root_signature, device)))
+            object->uses_ext_state_template = true;
+        else
+        {
+            WARN("Failed to create EXT state template, hr %#x. Falling back.\n", hr);
+            memset(&object->state_template, 0, sizeof(object->state_template));
+        }
+    }
+
+    if (requires_state_template && !object->uses_ext_state_template)
     {
         if ((pipeline_type == VKD3D_PIPELINE_TYPE_GRAPHICS || pipeline_type == VKD3D_PIPELINE_TYPE_MESH_GRAPHICS) &&
                 !device->device_info.device_generated_commands_features_nv.deviceGeneratedCommands)
         {
-            FIXME("VK_NV_device_generated_commands is not supported by implementation.\n");
+            FIXME("Neither VK_EXT_device_generated_commands nor VK_NV_device_generated_commands is usable.\n");
             hr = E_NOTIMPL;
             goto err;
         }
@@ -15683,10 +19559,12 @@ HRESULT d3d12_command_signature_create(struct d3d12_device *device, struct d3d12
                 goto err;
         }
     }
-    else
-        object->argument_buffer_offset = argument_buffer_offset;
 
-    object->pipeline_type = pipeline_type;
+    /* State template paths only use this to locate the action arguments when compacting. */
+    object->argument_buffer_offset = argument_buffer_offset;
+
+    if (requires_state_template && !object->uses_ext_state_template && pipeline_type != VKD3D_PIPELINE_TYPE_COMPUTE)
+        d3d12_command_signature_init_indirect_cache(object);
 
     d3d12_device_add_ref(object->device = device);
 
@@ -20,10 +20,10 @@
 #define __VKD3D_COMMAND_LIST_PROFILED
 
 #define COMMAND_LIST_PROFILED_CALL(name, ...) \
-    VKD3D_REGION_DECL(name); \
-    VKD3D_REGION_BEGIN(name); \
+    VKD3D_API_REGION_DECL(name); \
+    VKD3D_API_REGION_BEGIN(name); \
     d3d12_command_list_##name(__VA_ARGS__); \
-    VKD3D_REGION_END(name)
+    VKD3D_API_REGION_END(name)
 
 static void STDMETHODCALLTYPE d3d12_command_list_DrawInstanced_profiled(d3d12_command_list_iface *iface,
         UINT vertex_count_per_instance, UINT instance_count, UINT start_vertex_location,
@@ -20,14 +20,14 @@
 
 #include "vkd3d_private.h"
 
-static inline struct d3d12_command_list *d3d12_command_list_from_ID3D12GraphicsCommandListExt(ID3D12GraphicsCommandListExt *iface)
+static inline struct d3d12_command_list *d3d12_command_list_from_ID3D12GraphicsCommandListExt(ID3D12GraphicsCommandListExt1 *iface)
 {
     return CONTAINING_RECORD(iface, struct d3d12_command_list, ID3D12GraphicsCommandListExt_iface);
 }
 
 extern ULONG STDMETHODCALLTYPE d3d12_command_list_AddRef(d3d12_command_list_iface *iface);
 
-ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_AddRef(ID3D12GraphicsCommandListExt *iface)
+ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_AddRef(ID3D12GraphicsCommandListExt1 *iface)
 {
     struct d3d12_command_list *command_list = d3d12_command_list_from_ID3D12GraphicsCommandListExt(iface);
     return d3d12_command_list_AddRef(&command_list->ID3D12GraphicsCommandList_iface);
@@ -35,7 +35,7 @@ ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_AddRef(ID3D12GraphicsComman
 
 extern ULONG STDMETHODCALLTYPE d3d12_command_list_Release(d3d12_command_list_iface *iface);
 
-static ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_Release(ID3D12GraphicsCommandListExt *iface)
+static ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_Release(ID3D12GraphicsCommandListExt1 *iface)
 {
     struct d3d12_command_list *command_list = d3d12_command_list_from_ID3D12GraphicsCommandListExt(iface);
     return d3d12_command_list_Release(&command_list->ID3D12GraphicsCommandList_iface);
@@ -44,7 +44,7 @@ static ULONG STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_Release(ID3D12Graphi
 extern HRESULT STDMETHODCALLTYPE d3d12_command_list_QueryInterface(d3d12_command_list_iface *iface,
         REFIID iid, void **object);
 
-static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_QueryInterface(ID3D12GraphicsCommandListExt *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_QueryInterface(ID3D12GraphicsCommandListExt1 *iface,
         REFIID iid, void **out)
 {
     struct d3d12_command_list *command_list = d3d12_command_list_from_ID3D12GraphicsCommandListExt(iface);
@@ -52,7 +52,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_QueryInterface(ID3
     return d3d12_command_list_QueryInterface(&command_list->ID3D12GraphicsCommandList_iface, iid, out);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_GetVulkanHandle(ID3D12GraphicsCommandListExt *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_GetVulkanHandle(ID3D12GraphicsCommandListExt1 *iface,
         VkCommandBuffer *pVkCommandBuffer)
 {
     struct d3d12_command_list *command_list = d3d12_command_list_from_ID3D12GraphicsCommandListExt(iface);
@@ -68,7 +68,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_GetVulkanHandle(ID
 #define CU_LAUNCH_PARAM_BUFFER_SIZE    (const void*)0x02
 #define CU_LAUNCH_PARAM_END            (const void*)0x00
 
-static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_LaunchCubinShader(ID3D12GraphicsCommandListExt *iface, D3D12_CUBIN_DATA_HANDLE *handle, UINT32 block_x, UINT32 block_y, UINT32 block_z, const void *params, UINT32 param_size)
+static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_LaunchCubinShader(ID3D12GraphicsCommandListExt1 *iface, D3D12_CUBIN_DATA_HANDLE *handle, UINT32 block_x, UINT32 block_y, UINT32 block_z, const void *params, UINT32 param_size)
 {
     VkCuLaunchInfoNVX launchInfo = { VK_STRUCTURE_TYPE_CU_LAUNCH_INFO_NVX };
     const struct vkd3d_vk_device_procs *vk_procs;
@@ -102,7 +102,31 @@ static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_LaunchCubinShader(
     return S_OK;
 }
 
-CONST_VTBL struct ID3D12GraphicsCommandListExtVtbl d3d12_command_list_vkd3d_ext_vtbl =
+static HRESULT STDMETHODCALLTYPE d3d12_command_list_vkd3d_ext_GetStatistics(ID3D12GraphicsCommandListExt1 *iface,
+        D3D12_COMMAND_LIST_STATISTICS *statistics)
+{
+    struct d3d12_command_list *command_list = d3d12_command_list_from_ID3D12GraphicsCommandListExt(iface);
+    const uint32_t *counts = command_list->stats.counts;
+
+    TRACE("iface %p, statistics %p.\n", iface, statistics);
+
+    if (!statistics)
+        return E_INVALIDARG;
+
+    statistics->drawCount = counts[VKD3D_COMMAND_LIST_STAT_DRAW];
+    statistics->dispatchCount = counts[VKD3D_COMMAND_LIST_STAT_DISPATCH];
+    statistics->renderPassBeginCount = counts[VKD3D_COMMAND_LIST_STAT_RENDER_PASS_BEGIN];
+    statistics->renderPassSuspendCount = counts[VKD3D_COMMAND_LIST_STAT_RENDER_PASS_SUSPEND];
+    statistics->renderPassEndCount = counts[VKD3D_COMMAND_LIST_STAT_RENDER_PASS_END];
+    statistics->barrierBatchCount = counts[VKD3D_COMMAND_LIST_STAT_BARRIER_BATCH];
+    statistics->descriptorBufferBindCount = counts[VKD3D_COMMAND_LIST_STAT_DESCRIPTOR_BUFFER_BIND];
+    statistics->dynamicStateEmitCount = counts[VKD3D_COMMAND_LIST_STAT_DYNAMIC_STATE_EMIT];
+    statistics->metaOperationCount = counts[VKD3D_COMMAND_LIST_STAT_META_OPERATION];
+    statistics->queryResolveFlushCount = counts[VKD3D_COMMAND_LIST_STAT_QUERY_RESOLVE_FLUSH];
+    return S_OK;
+}
+
+CONST_VTBL struct ID3D12GraphicsCommandListExt1Vtbl d3d12_command_list_vkd3d_ext_vtbl =
 {
     /* IUnknown methods */
     d3d12_command_list_vkd3d_ext_QueryInterface,
@@ -111,6 +135,9 @@ CONST_VTBL struct ID3D12GraphicsCommandListExtVtbl d3d12_command_list_vkd3d_ext_
 
     /* ID3D12GraphicsCommandListExt methods */
     d3d12_command_list_vkd3d_ext_GetVulkanHandle,
-    d3d12_command_list_vkd3d_ext_LaunchCubinShader
+    d3d12_command_list_vkd3d_ext_LaunchCubinShader,
+
+    /* ID3D12GraphicsCommandListExt1 methods */
+    d3d12_command_list_vkd3d_ext_GetStatistics
 };
 
@@ -232,16 +232,49 @@ static bool vkd3d_shader_debug_ring_print_message(struct vkd3d_shader_debug_ring
     return true;
 }
 
+/* Binary log layout: this header, followed by messages exactly as the shader wrote them into the ring,
+ * i.e. a cookie | word count word followed by the payload. Formatting is left to offline tools. */
+#define VKD3D_SHADER_DEBUG_RING_BINARY_LOG_MAGIC 0x474f4c52u /* "RLOG" */
+#define VKD3D_SHADER_DEBUG_RING_BINARY_LOG_VERSION 1u
+
+struct vkd3d_shader_debug_ring_binary_log_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cookie;
+    uint32_t reserved;
+};
+
+static void vkd3d_shader_debug_ring_write_binary_log(struct vkd3d_shader_debug_ring *ring,
+        uint32_t word_offset, uint32_t word_count)
+{
+    size_t ring_words = ring->ring_size / sizeof(uint32_t);
+    size_t first_words, begin;
+
+    /* Write straight out of the mapped ring, split in two if the span wraps. */
+    begin = word_offset & (ring_words - 1);
+    first_words = min(word_count, ring_words - begin);
+    fwrite(ring->mapped_ring + begin, sizeof(uint32_t), first_words, ring->binary_log);
+    if (first_words < word_count)
+        fwrite(ring->mapped_ring, sizeof(uint32_t), word_count - first_words, ring->binary_log);
+}
+
+/* Poll without waiting for a kick while the GPU keeps producing,
+ * so that heavy output does not have to wait for the next submission. */
+#define VKD3D_SHADER_DEBUG_RING_POLL_INTERVAL_NS 1000000ull
+
 void *vkd3d_shader_debug_ring_thread_main(void *arg)
 {
     uint32_t last_counter, new_counter, count, i, cookie_word_count;
     volatile const uint32_t *ring_counter; /* Atomic updated by the GPU. */
     struct vkd3d_shader_debug_ring *ring;
     struct d3d12_device *device = arg;
+    uint32_t consumed_words = 0;
     bool is_active = true;
     uint32_t *ring_base;
     uint32_t word_count;
     size_t ring_mask;
+    uint32_t delta;
 
     ring = &device->debug_ring;
     ring_mask = (ring->ring_size / sizeof(uint32_t)) - 1;
@@ -253,21 +286,35 @@ void *vkd3d_shader_debug_ring_thread_main(void *arg)
 
     while (is_active)
     {
+        /* Heavy traffic: go again right away. Some traffic: poll shortly. Idle: wait for a kick. */
+        if (consumed_words && consumed_words < ring->ring_size / (16 * sizeof(uint32_t)))
+            vkd3d_sleep_until_ns(vkd3d_get_current_time_ns() + VKD3D_SHADER_DEBUG_RING_POLL_INTERVAL_NS);
+
         pthread_mutex_lock(&ring->ring_lock);
-        if (ring->active)
+        if (ring->active && !consumed_words)
             pthread_cond_wait(&ring->ring_cond, &ring->ring_lock);
         is_active = ring->active;
         pthread_mutex_unlock(&ring->ring_lock);
 
         new_counter = *ring_counter;
+        consumed_words = 0;
 
         if (last_counter != new_counter)
         {
-            count = (new_counter - last_counter) & ring_mask;
+            delta = new_counter - last_counter;
+            count = delta & ring_mask;
+
+            if (delta > ring_mask)
+            {
+                ring->stats.overflow_count++;
+                ring->stats.dropped_word_count += delta - count;
+                ERR("Debug ring overflowed, dropped at least %u words.\n", delta - count);
+            }
 
             /* Assume that each iteration can safely use 1/4th of the buffer to avoid WAR hazards. */
             if (count > (ring->ring_size / 16))
             {
+                ring->stats.pressure_count++;
                 ERR("Debug ring is probably too small (%u new words this iteration), increase size to avoid risk of dropping messages.\n",
                     count);
             }
@@ -281,6 +328,7 @@ void *vkd3d_shader_debug_ring_thread_main(void *arg)
 
                 if (cookie_word_count == 0)
                 {
+                    ring->stats.incomplete_count++;
                     ERR("Message was allocated, but write did not complete. last_counter = %u, rewrite new_counter = %u -> %u\n",
                             last_counter, new_counter, last_counter + i);
                     /* Rewind the counter, and try again later. */
@@ -302,23 +350,19 @@ void *vkd3d_shader_debug_ring_thread_main(void *arg)
                     break;
                 }
 
-                if (!vkd3d_shader_debug_ring_print_message(ring, last_counter + i, word_count))
+                /* The binary log takes all validated messages in one go below. */
+                if (!ring->binary_log && !vkd3d_shader_debug_ring_print_message(ring, last_counter + i, word_count))
                     break;
 
+                ring->stats.message_count++;
                 i += word_count;
             }
-        }
 
-        /* Make sure to clear out any messages we read so that when the ring gets around to
-         * this point again, we can detect unwritten memory.
-         * This relies on having a ring that is large enough, but in practice, if we just make the ring
-         * large enough, there is nothing to worry about. */
-        while (last_counter != new_counter)
-        {
-            ring_base[last_counter & ring_mask] = 0;
-            last_counter++;
+            if (ring->binary_log && i)
+                vkd3d_shader_debug_ring_write_binary_log(ring, last_counter, i);
+
+            consumed_words = i;
         }
-    }
 
     if (ring->device_lost)
     {
@@ -334,9 +378,12 @@ void *vkd3d_shader_debug_ring_thread_main(void *arg)
 
                 /* This is considered a message if it has the marker and a word count that is in-range. */
                 if ((cookie_word_count & DEBUG_CHANNEL_WORD_MASK) == DEBUG_CHANNEL_WORD_COOKIE &&
-                        i + word_count <= count &&
-                        vkd3d_shader_debug_ring_print_message(ring, last_counter + i, word_count))
+                        i + word_count <= count && word_count >= 8)
                 {
+                    if (ring->binary_log)
+                        vkd3d_shader_debug_ring_write_binary_log(ring, last_counter + i, word_count);
+                    else
+                        vkd3d_shader_debug_ring_print_message(ring, last_counter + i, word_count);
                     i += word_count;
                 }
                 else
@@ -455,6 +502,23 @@ HRESULT vkd3d_shader_debug_ring_init(struct vkd3d_shader_debug_ring *ring,
     memset(ring->mapped_control_block, 0, ring->control_block_size);
     memset(ring->mapped_ring, 0, ring->ring_size);
 
+    if (vkd3d_get_env_var("VKD3D_SHADER_DEBUG_RING_BINARY_LOG", env, sizeof(env)))
+    {
+        struct vkd3d_shader_debug_ring_binary_log_header header;
+
+        if ((ring->binary_log = fopen(env, "wb")))
+        {
+            INFO("Writing shader debug ring messages to binary log \"%s\".\n", env);
+            header.magic = VKD3D_SHADER_DEBUG_RING_BINARY_LOG_MAGIC;
+            header.version = VKD3D_SHADER_DEBUG_RING_BINARY_LOG_VERSION;
+            header.cookie = DEBUG_CHANNEL_WORD_COOKIE;
+            header.reserved = 0;
+            fwrite(&header, sizeof(header), 1, ring->binary_log);
+        }
+        else
+            ERR("Failed to open binary log \"%s\", falling back to text logging.\n", env);
+    }
+
     if (pthread_mutex_init(&ring->ring_lock, NULL) != 0)
         goto err_free_buffers;
     if (pthread_cond_init(&ring->ring_cond, NULL) != 0)
@@ -473,6 +537,8 @@ err_destroy_mutex:
 err_destroy_cond:
     pthread_cond_destroy(&ring->ring_cond);
 err_free_buffers:
+    if (ring->binary_log)
+        fclose(ring->binary_log);
     VK_CALL(vkDestroyBuffer(device->vk_device, ring->host_buffer, NULL));
     VK_CALL(vkDestroyBuffer(device->vk_device, ring->device_atomic_buffer, NULL));
     vkd3d_free_device_memory(device, &ring->host_buffer_memory);
@@ -496,6 +562,17 @@ void vkd3d_shader_debug_ring_cleanup(struct vkd3d_shader_debug_ring *ring,
     pthread_mutex_destroy(&ring->ring_lock);
     pthread_cond_destroy(&ring->ring_cond);
 
+    if (ring->binary_log)
+    {
+        fclose(ring->binary_log);
+        ring->binary_log = NULL;
+    }
+
+    INFO("Debug ring: %"PRIu64" messages, %"PRIu64" overflows (%"PRIu64" words dropped), "
+            "%"PRIu64" high pressure iterations, %"PRIu64" incomplete writes.\n",
+            ring->stats.message_count, ring->stats.overflow_count, ring->stats.dropped_word_count,
+            ring->stats.pressure_count, ring->stats.incomplete_count);
+
     VK_CALL(vkDestroyBuffer(device->vk_device, ring->host_buffer, NULL));
     VK_CALL(vkDestroyBuffer(device->vk_device, ring->device_atomic_buffer, NULL));
     vkd3d_free_device_memory(device, &ring->host_buffer_memory);
@@ -21,6 +21,7 @@
 #include "vkd3d_descriptor_debug.h"
 #include "vkd3d_threads.h"
 #include <stdio.h>
+#include <errno.h>
 #include <string.h>
 #include <inttypes.h>
 
@@ -30,6 +31,12 @@ static bool descriptor_debug_active_qa_checks;
 static bool descriptor_debug_active_log;
 static FILE *descriptor_debug_file;
 
+/* Sampling of instrumented shaders. A shader is instrumented if its hash is in the explicit
+ * list, or, if no list is given, if its hash falls within the sampled fraction. */
+static uint32_t descriptor_debug_qa_sample_rate = 100;
+static uint64_t *descriptor_debug_qa_shader_hashes;
+static size_t descriptor_debug_qa_shader_hash_count;
+
 struct vkd3d_descriptor_qa_global_info
 {
     struct vkd3d_descriptor_qa_global_buffer_data *data;
@@ -74,6 +81,40 @@ static const char *debug_descriptor_type(vkd3d_descriptor_qa_flags type_flags)
     }
 }
 
+static void vkd3d_descriptor_debug_init_qa_shader_hashes(const char *env)
+{
+    size_t array_size = 0;
+    uint64_t hash;
+    char *endp;
+
+    while (*env != '\0')
+    {
+        errno = 0;
+        hash = strtoull(env, &endp, 16);
+        if (errno != 0 || endp == env)
+        {
+            ERR("Error parsing shader hash list.\n");
+            break;
+        }
+
+        vkd3d_array_reserve((void **)&descriptor_debug_qa_shader_hashes, &array_size,
+                descriptor_debug_qa_shader_hash_count + 1, sizeof(*descriptor_debug_qa_shader_hashes));
+
+        INFO("Enabling descriptor QA checks for shader %016"PRIx64".\n", hash);
+        descriptor_debug_qa_shader_hashes[descriptor_debug_qa_shader_hash_count++] = hash;
+
+        if (*endp == ',')
+            env = endp + 1;
+        else if (*endp != '\0')
+        {
+            ERR("Unexpected character %c.\n", *endp);
+            break;
+        }
+        else
+            env = endp;
+    }
+}
+
 static void vkd3d_descriptor_debug_init_once(void)
 {
     char env[VKD3D_PATH_MAX];
@@ -93,6 +134,17 @@ static void vkd3d_descriptor_debug_init_once(void)
     {
         INFO("Enabling descriptor QA checks!\n");
         descriptor_debug_active_qa_checks = true;
+
+        vkd3d_get_env_var("VKD3D_DESCRIPTOR_QA_SHADER_HASHES", env, sizeof(env));
+        if (strlen(env) > 0)
+            vkd3d_descriptor_debug_init_qa_shader_hashes(env);
+
+        vkd3d_get_env_var("VKD3D_DESCRIPTOR_QA_SAMPLE_RATE", env, sizeof(env));
+        if (strlen(env) > 0)
+        {
+            descriptor_debug_qa_sample_rate = min(strtoul(env, NULL, 0), 100u);
+            INFO("Instrumenting %u%% of shaders for descriptor QA checks.\n", descriptor_debug_qa_sample_rate);
+        }
     }
 }
 
@@ -111,6 +163,27 @@ bool vkd3d_descriptor_debug_active_qa_checks(void)
     return descriptor_debug_active_qa_checks;
 }
 
+bool vkd3d_descriptor_debug_qa_check_shader(uint64_t shader_hash)
+{
+    size_t i;
+
+    if (!descriptor_debug_active_qa_checks)
+        return false;
+
+    if (descriptor_debug_qa_shader_hash_count)
+    {
+        for (i = 0; i < descriptor_debug_qa_shader_hash_count; i++)
+            if (descriptor_debug_qa_shader_hashes[i] == shader_hash)
+                return true;
+        return false;
+    }
+
+    /* The decision only depends on the hash, so the same subset of shaders
+     * is instrumented on every run, which keeps faults reproducible. */
+    return descriptor_debug_qa_sample_rate >= 100 ||
+            (hash_uint64(shader_hash) % 100) < descriptor_debug_qa_sample_rate;
+}
+
 VkDeviceSize vkd3d_descriptor_debug_heap_info_size(unsigned int num_descriptors)
 {
     return offsetof(struct vkd3d_descriptor_qa_heap_buffer_data, desc) + num_descriptors *
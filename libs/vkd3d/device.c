@@ -69,6 +69,7 @@ static const struct vkd3d_optional_extension_info optional_device_extensions[] =
     VK_EXTENSION(KHR_FRAGMENT_SHADER_BARYCENTRIC, KHR_fragment_shader_barycentric),
     VK_EXTENSION(KHR_PRESENT_ID, KHR_present_id),
     VK_EXTENSION(KHR_PRESENT_WAIT, KHR_present_wait),
+    VK_EXTENSION(KHR_MAINTENANCE_5, KHR_maintenance5),
 #ifdef _WIN32
     VK_EXTENSION(KHR_EXTERNAL_MEMORY_WIN32, KHR_external_memory_win32),
     VK_EXTENSION(KHR_EXTERNAL_SEMAPHORE_WIN32, KHR_external_semaphore_win32),
@@ -98,11 +99,14 @@ static const struct vkd3d_optional_extension_info optional_device_extensions[] =
     VK_EXTENSION(EXT_FRAGMENT_SHADER_INTERLOCK, EXT_fragment_shader_interlock),
     VK_EXTENSION(EXT_PAGEABLE_DEVICE_LOCAL_MEMORY, EXT_pageable_device_local_memory),
     VK_EXTENSION(EXT_MEMORY_PRIORITY, EXT_memory_priority),
+    VK_EXTENSION(EXT_MEMORY_BUDGET, EXT_memory_budget),
+    VK_EXTENSION(EXT_DEVICE_GENERATED_COMMANDS, EXT_device_generated_commands),
     /* AMD extensions */
     VK_EXTENSION(AMD_BUFFER_MARKER, AMD_buffer_marker),
     VK_EXTENSION(AMD_DEVICE_COHERENT_MEMORY, AMD_device_coherent_memory),
     VK_EXTENSION(AMD_SHADER_CORE_PROPERTIES, AMD_shader_core_properties),
     VK_EXTENSION(AMD_SHADER_CORE_PROPERTIES_2, AMD_shader_core_properties2),
+    VK_EXTENSION(AMD_ANTI_LAG, AMD_anti_lag),
     /* NV extensions */
     VK_EXTENSION(NV_SHADER_SM_BUILTINS, NV_shader_sm_builtins),
     VK_EXTENSION(NVX_BINARY_IMPORT, NVX_binary_import),
@@ -111,6 +115,7 @@ static const struct vkd3d_optional_extension_info optional_device_extensions[] =
     VK_EXTENSION(NV_COMPUTE_SHADER_DERIVATIVES, NV_compute_shader_derivatives),
     VK_EXTENSION_COND(NV_DEVICE_DIAGNOSTIC_CHECKPOINTS, NV_device_diagnostic_checkpoints, VKD3D_CONFIG_FLAG_BREADCRUMBS | VKD3D_CONFIG_FLAG_BREADCRUMBS_TRACE),
     VK_EXTENSION(NV_DEVICE_GENERATED_COMMANDS, NV_device_generated_commands),
+    VK_EXTENSION(NV_LOW_LATENCY_2, NV_low_latency2),
     /* VALVE extensions */
     VK_EXTENSION(VALVE_MUTABLE_DESCRIPTOR_TYPE, VALVE_mutable_descriptor_type),
     VK_EXTENSION(VALVE_DESCRIPTOR_SET_HOST_MAPPING, VALVE_descriptor_set_host_mapping),
@@ -599,6 +604,40 @@ static const struct vkd3d_shader_quirk_meta application_shader_quirks[] = {
     { VKD3D_STRING_COMPARE_NEVER, NULL, NULL },
 };
 
+static int vkd3d_shader_quirk_hash_compare(const void *a, const void *b)
+{
+    const struct vkd3d_shader_quirk_hash *x = a;
+    const struct vkd3d_shader_quirk_hash *y = b;
+
+    if (x->shader_hash != y->shader_hash)
+        return x->shader_hash < y->shader_hash ? -1 : 1;
+    return 0;
+}
+
+static void vkd3d_instance_apply_shader_quirks(const struct vkd3d_shader_quirk_info *info)
+{
+    struct vkd3d_shader_quirk_hash *hashes;
+
+    vkd3d_shader_quirk_info = *info;
+
+    if (!info->num_hashes)
+        return;
+
+    /* The shader compiler binary searches the table for every shader it compiles.
+     * Config flags are only initialized once, so the sorted copy lives for the whole process. */
+    if (!(hashes = vkd3d_malloc(info->num_hashes * sizeof(*hashes))))
+    {
+        ERR("Failed to allocate shader quirk table, ignoring per-shader quirks.\n");
+        vkd3d_shader_quirk_info.hashes = NULL;
+        vkd3d_shader_quirk_info.num_hashes = 0;
+        return;
+    }
+
+    memcpy(hashes, info->hashes, info->num_hashes * sizeof(*hashes));
+    qsort(hashes, info->num_hashes, sizeof(*hashes), vkd3d_shader_quirk_hash_compare);
+    vkd3d_shader_quirk_info.hashes = hashes;
+}
+
 static void vkd3d_instance_apply_application_workarounds(void)
 {
     char app[VKD3D_PATH_MAX];
@@ -625,7 +664,7 @@ static void vkd3d_instance_apply_application_workarounds(void)
     {
         if (vkd3d_string_compare(application_shader_quirks[i].mode, app, application_shader_quirks[i].name))
         {
-            vkd3d_shader_quirk_info = *application_shader_quirks[i].info;
+            vkd3d_instance_apply_shader_quirks(application_shader_quirks[i].info);
             INFO("Detected game %s, adding shader quirks for specific shaders.\n", app);
             break;
         }
@@ -780,8 +819,31 @@ static const struct vkd3d_debug_option vkd3d_config_options[] =
     {"force_compute_root_parameters_push_ubo", VKD3D_CONFIG_FLAG_FORCE_COMPUTE_ROOT_PARAMETERS_PUSH_UBO},
     {"skip_driver_workarounds", VKD3D_CONFIG_FLAG_SKIP_DRIVER_WORKAROUNDS},
     {"curb_memory_pso_cache", VKD3D_CONFIG_FLAG_CURB_MEMORY_PSO_CACHE},
+    {"fence_worker_wait_any", VKD3D_CONFIG_FLAG_FENCE_WORKER_WAIT_ANY},
+    {"pipeline_async_compile", VKD3D_CONFIG_FLAG_PIPELINE_ASYNC_COMPILE},
+    {"pipeline_parallel_compile", VKD3D_CONFIG_FLAG_PIPELINE_PARALLEL_COMPILE},
+    {"residency_demotion", VKD3D_CONFIG_FLAG_RESIDENCY_DEMOTION},
+    {"memory_allocator_pack", VKD3D_CONFIG_FLAG_MEMORY_ALLOCATOR_PACK},
+    {"recycle_committed_resources", VKD3D_CONFIG_FLAG_RECYCLE_COMMITTED_RESOURCES},
+    {"descriptor_copy_dedup", VKD3D_CONFIG_FLAG_DESCRIPTOR_COPY_DEDUP},
+    {"execute_indirect_cache", VKD3D_CONFIG_FLAG_EXECUTE_INDIRECT_CACHE},
+    {"specialize_root_constants", VKD3D_CONFIG_FLAG_SPECIALIZE_ROOT_CONSTANTS},
+    {"pipeline_library_warm_up", VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_WARM_UP},
+    {"pipeline_library_compress", VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_COMPRESS},
+    {"pipeline_telemetry", VKD3D_CONFIG_FLAG_PIPELINE_TELEMETRY},
+    {"low_latency", VKD3D_CONFIG_FLAG_LOW_LATENCY},
+    {"swapchain_async_compute", VKD3D_CONFIG_FLAG_SWAPCHAIN_ASYNC_COMPUTE},
+    {"queue_watchdog", VKD3D_CONFIG_FLAG_QUEUE_WATCHDOG},
+    {"meta_timing", VKD3D_CONFIG_FLAG_META_TIMING},
+    {"command_list_stats", VKD3D_CONFIG_FLAG_COMMAND_LIST_STATS},
+    {"deferred_resource_destroy", VKD3D_CONFIG_FLAG_DEFERRED_RESOURCE_DESTROY},
+    {"default_buffer_hvv", VKD3D_CONFIG_FLAG_DEFAULT_BUFFER_HVV},
+    {"thread_priority", VKD3D_CONFIG_FLAG_THREAD_PRIORITY},
+    {"deferred_memory_bind", VKD3D_CONFIG_FLAG_DEFERRED_MEMORY_BIND},
 };
 
+static uint64_t vkd3d_thread_affinity_mask;
+
 static void vkd3d_config_flags_init_once(void)
 {
     char config[VKD3D_PATH_MAX];
@@ -801,6 +863,12 @@ static void vkd3d_config_flags_init_once(void)
 
     if (vkd3d_config_flags)
         INFO("VKD3D_CONFIG='%s'.\n", config);
+
+    if (vkd3d_get_env_var("VKD3D_THREAD_AFFINITY", config, sizeof(config)))
+    {
+        vkd3d_thread_affinity_mask = strtoull(config, NULL, 16);
+        INFO("Restricting latency critical threads to CPU mask 0x%"PRIx64".\n", vkd3d_thread_affinity_mask);
+    }
 }
 
 static pthread_once_t vkd3d_config_flags_once = PTHREAD_ONCE_INIT;
@@ -810,6 +878,19 @@ static void vkd3d_config_flags_init(void)
     pthread_once(&vkd3d_config_flags_once, vkd3d_config_flags_init_once);
 }
 
+void vkd3d_set_thread_role(enum vkd3d_thread_role role)
+{
+    /* Only latency critical threads have a role for now, so they all share one policy.
+     * The game's own worker threads would otherwise preempt them or push them to
+     * efficiency cores, which directly adds to submit and present latency. */
+    if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_THREAD_PRIORITY) &&
+            !vkd3d_set_current_thread_priority(VKD3D_THREAD_PRIORITY_HIGH))
+        WARN("Failed to raise priority of thread role %u.\n", role);
+
+    if (vkd3d_thread_affinity_mask && !vkd3d_set_current_thread_affinity(vkd3d_thread_affinity_mask))
+        WARN("Failed to set CPU affinity of thread role %u to 0x%"PRIx64".\n", role, vkd3d_thread_affinity_mask);
+}
+
 static HRESULT vkd3d_instance_init(struct vkd3d_instance *instance,
         const struct vkd3d_instance_create_info *create_info)
 {
@@ -1000,6 +1081,7 @@ HRESULT vkd3d_create_instance(const struct vkd3d_instance_create_info *create_in
     TRACE("create_info %p, instance %p.\n", create_info, instance);
 
     vkd3d_init_profiling();
+    vkd3d_init_capture();
 
     if (!create_info || !instance)
     {
@@ -1272,9 +1354,15 @@ static void vkd3d_physical_device_info_apply_workarounds(struct vkd3d_physical_d
         {
             WARN("Disabling VK_KHR_present_wait on NV drivers due to spurious failure to create swapchains.\n");
             device->vk_info.KHR_present_wait = false;
-            device->vk_info.KHR_present_id = false;
             device->device_info.present_wait_features.presentWait = false;
-            device->device_info.present_id_features.presentId = false;
+
+            /* Present IDs are only consumed by present wait, except for low latency
+             * which needs them to line up latency markers with presents. */
+            if (!device->vk_info.NV_low_latency2)
+            {
+                device->vk_info.KHR_present_id = false;
+                device->device_info.present_id_features.presentId = false;
+            }
         }
 
         if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_GLOBAL_PIPELINE_CACHE)
@@ -1489,6 +1577,22 @@ static void vkd3d_physical_device_info_init(struct vkd3d_physical_device_info *i
         vk_prepend_struct(&info->properties2, &info->device_generated_commands_properties_nv);
     }
 
+    if (vulkan_info->EXT_device_generated_commands)
+    {
+        info->device_generated_commands_features_ext.sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEVICE_GENERATED_COMMANDS_FEATURES_EXT;
+        info->device_generated_commands_properties_ext.sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEVICE_GENERATED_COMMANDS_PROPERTIES_EXT;
+        vk_prepend_struct(&info->features2, &info->device_generated_commands_features_ext);
+        vk_prepend_struct(&info->properties2, &info->device_generated_commands_properties_ext);
+    }
+
+    if (vulkan_info->KHR_maintenance5)
+    {
+        info->maintenance5_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR;
+        vk_prepend_struct(&info->features2, &info->maintenance5_features);
+    }
+
     if (vulkan_info->EXT_shader_image_atomic_int64)
     {
         info->shader_image_atomic_int64_features.sType =
@@ -1510,6 +1614,12 @@ static void vkd3d_physical_device_info_init(struct vkd3d_physical_device_info *i
         vk_prepend_struct(&info->features2, &info->device_coherent_memory_features_amd);
     }
 
+    if (vulkan_info->AMD_anti_lag)
+    {
+        info->anti_lag_features_amd.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ANTI_LAG_FEATURES_AMD;
+        vk_prepend_struct(&info->features2, &info->anti_lag_features_amd);
+    }
+
     if (vulkan_info->EXT_mesh_shader)
     {
         info->mesh_shader_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
@@ -2086,6 +2196,16 @@ static HRESULT vkd3d_init_device_caps(struct d3d12_device *device,
 
     if (!physical_device_info->conditional_rendering_features.conditionalRendering)
         vulkan_info->EXT_conditional_rendering = false;
+
+    /* Preprocess buffers are tagged through VkBufferUsageFlags2CreateInfoKHR. */
+    if (!physical_device_info->maintenance5_features.maintenance5)
+    {
+        vulkan_info->EXT_device_generated_commands = false;
+        physical_device_info->device_generated_commands_features_ext.deviceGeneratedCommands = VK_FALSE;
+    }
+
+    /* Push constant tokens always reference the root signature's pipeline layout. */
+    physical_device_info->device_generated_commands_features_ext.dynamicGeneratedPipelineLayout = VK_FALSE;
     if (!physical_device_info->depth_clip_features.depthClipEnable)
         vulkan_info->EXT_depth_clip_enable = false;
 
@@ -2371,6 +2491,9 @@ static HRESULT d3d12_device_create_vkd3d_queues(struct d3d12_device *device,
             if (FAILED((hr = vkd3d_queue_create(device, queue_info->family_index[i],
                     j, &queue_info->vk_properties[i], &info->queues[j]))))
                 goto out_destroy_queues;
+
+            /* Matches queue_priorities. */
+            info->queues[j]->high_priority = info->queue_count > 1 && j == info->queue_count - 1;
         }
 
         info->vk_family_index = queue_info->family_index[i];
@@ -2392,7 +2515,16 @@ out_destroy_queues:
 }
 
 #define VKD3D_MAX_QUEUE_COUNT_PER_FAMILY (4u)
-static float queue_priorities[] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+/* If a family has more than one queue, the last one is reserved for high priority D3D12 queues.
+ * Queue priorities are only relative to other queues on the same device. */
+static const float queue_priorities[VKD3D_MAX_QUEUE_COUNT_PER_FAMILY][VKD3D_MAX_QUEUE_COUNT_PER_FAMILY] =
+{
+    {1.0f},
+    {0.5f, 1.0f},
+    {0.5f, 0.5f, 1.0f},
+    {0.5f, 0.5f, 0.5f, 1.0f},
+};
 
 static uint32_t vkd3d_find_queue(unsigned int count, const VkQueueFamilyProperties *properties,
         VkQueueFlags mask, VkQueueFlags flags)
@@ -2470,10 +2602,11 @@ static HRESULT vkd3d_select_queues(const struct vkd3d_instance *vkd3d_instance,
         queue_info->flags = 0;
         queue_info->queueFamilyIndex = info->family_index[i];
         queue_info->queueCount = min(info->vk_properties[i].queueCount, VKD3D_MAX_QUEUE_COUNT_PER_FAMILY);
-        queue_info->pQueuePriorities = queue_priorities;
 
         if (single_queue)
             queue_info->queueCount = 1;
+
+        queue_info->pQueuePriorities = queue_priorities[queue_info->queueCount - 1];
     }
 
     vkd3d_free(queue_properties);
@@ -2609,6 +2742,8 @@ static HRESULT vkd3d_create_vk_device(struct d3d12_device *device,
         return hr;
     }
 
+    vkd3d_command_pool_cache_init(&device->command_pool_cache);
+
     device->vk_info.extension_count = device_info.enabledExtensionCount;
     device->vk_info.extension_names = extensions;
 
@@ -2738,6 +2873,8 @@ static HRESULT d3d12_device_create_scratch_buffer(struct d3d12_device *device, e
         return E_INVALIDARG;
     }
 
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_SCRATCH_POOL,
+            scratch->allocation.resource.size);
     scratch->offset = 0;
     return S_OK;
 }
@@ -2746,6 +2883,8 @@ static void d3d12_device_destroy_scratch_buffer(struct d3d12_device *device, con
 {
     TRACE("device %p, scratch %p.\n", device, scratch);
 
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_SCRATCH_POOL,
+            -(int64_t)scratch->allocation.resource.size);
     vkd3d_free_memory(device, &device->memory_allocator, &scratch->allocation);
 }
 
@@ -2780,22 +2919,31 @@ HRESULT d3d12_device_get_scratch_buffer(struct d3d12_device *device, enum vkd3d_
     return d3d12_device_create_scratch_buffer(device, kind, VKD3D_SCRATCH_BUFFER_SIZE, memory_types, scratch);
 }
 
-void d3d12_device_return_scratch_buffer(struct d3d12_device *device, enum vkd3d_scratch_pool_kind kind,
-        const struct vkd3d_scratch_buffer *scratch)
+void d3d12_device_return_scratch_buffers(struct d3d12_device *device, enum vkd3d_scratch_pool_kind kind,
+        const struct vkd3d_scratch_buffer *scratch_buffers, size_t count)
 {
     struct d3d12_device_scratch_pool *pool = &device->scratch_pools[kind];
+    size_t accepted_count, i;
+
+    if (!count)
+        return;
+
     pthread_mutex_lock(&device->mutex);
 
-    if (scratch->allocation.resource.size == VKD3D_SCRATCH_BUFFER_SIZE &&
-            pool->scratch_buffer_count < VKD3D_SCRATCH_BUFFER_COUNT)
+    for (i = 0; i < count && pool->scratch_buffer_count < VKD3D_SCRATCH_BUFFER_COUNT; i++)
     {
-        pool->scratch_buffers[pool->scratch_buffer_count++] = *scratch;
-        pthread_mutex_unlock(&device->mutex);
+        if (scratch_buffers[i].allocation.resource.size == VKD3D_SCRATCH_BUFFER_SIZE)
+            pool->scratch_buffers[pool->scratch_buffer_count++] = scratch_buffers[i];
     }
-    else
+
+    pthread_mutex_unlock(&device->mutex);
+    accepted_count = i;
+
+    /* Free anything the pool did not take outside the lock. */
+    for (i = 0; i < count; i++)
     {
-        pthread_mutex_unlock(&device->mutex);
-        d3d12_device_destroy_scratch_buffer(device, scratch);
+        if (i >= accepted_count || scratch_buffers[i].allocation.resource.size != VKD3D_SCRATCH_BUFFER_SIZE)
+            d3d12_device_destroy_scratch_buffer(device, &scratch_buffers[i]);
     }
 }
 
@@ -2841,6 +2989,22 @@ void d3d12_device_return_descriptor_heap_gpu_va(struct d3d12_device *device, uin
     pthread_mutex_unlock(&device->mutex);
 }
 
+static uint64_t vkd3d_query_pool_get_footprint(const struct vkd3d_query_pool *pool)
+{
+    /* Query pool storage is owned by the driver, so estimate it from the size of a result. */
+    switch (pool->type_index)
+    {
+        case VKD3D_QUERY_TYPE_INDEX_PIPELINE_STATISTICS:
+            return pool->query_count * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
+
+        case VKD3D_QUERY_TYPE_INDEX_TRANSFORM_FEEDBACK:
+            return pool->query_count * sizeof(D3D12_QUERY_DATA_SO_STATISTICS);
+
+        default:
+            return pool->query_count * sizeof(uint64_t);
+    }
+}
+
 static HRESULT d3d12_device_create_query_pool(struct d3d12_device *device, uint32_t type_index, struct vkd3d_query_pool *pool)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
@@ -2905,6 +3069,12 @@ static HRESULT d3d12_device_create_query_pool(struct d3d12_device *device, uint3
             pool_info.queryCount = 128;
             break;
 
+        case VKD3D_QUERY_TYPE_INDEX_TIMESTAMP:
+            /* Only used for internal GPU timing, two queries per meta operation. */
+            pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            pool_info.queryCount = 256;
+            break;
+
         default:
             ERR("Unhandled query type %u.\n", type_index);
             return E_INVALIDARG;
@@ -2919,6 +3089,9 @@ static HRESULT d3d12_device_create_query_pool(struct d3d12_device *device, uint3
     pool->type_index = type_index;
     pool->query_count = pool_info.queryCount;
     pool->next_index = 0;
+
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_QUERY_POOL,
+            vkd3d_query_pool_get_footprint(pool));
     return S_OK;
 }
 
@@ -2928,6 +3101,8 @@ static void d3d12_device_destroy_query_pool(struct d3d12_device *device, const s
 
     TRACE("device %p, pool %p.\n", device, pool);
 
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_QUERY_POOL,
+            -(int64_t)vkd3d_query_pool_get_footprint(pool));
     VK_CALL(vkDestroyQueryPool(device->vk_device, pool->vk_query_pool, NULL));
 }
 
@@ -2954,25 +3129,28 @@ HRESULT d3d12_device_get_query_pool(struct d3d12_device *device, uint32_t type_i
     return d3d12_device_create_query_pool(device, type_index, pool);
 }
 
-void d3d12_device_return_query_pool(struct d3d12_device *device, const struct vkd3d_query_pool *pool)
+void d3d12_device_return_query_pools(struct d3d12_device *device, const struct vkd3d_query_pool *pools, size_t count)
 {
+    size_t accepted_count;
+    size_t i;
+
+    if (!count)
+        return;
+
     pthread_mutex_lock(&device->mutex);
+    accepted_count = min(count, VKD3D_VIRTUAL_QUERY_POOL_COUNT - device->query_pool_count);
+    memcpy(&device->query_pools[device->query_pool_count], pools, accepted_count * sizeof(*pools));
+    device->query_pool_count += accepted_count;
+    pthread_mutex_unlock(&device->mutex);
 
-    if (device->query_pool_count < VKD3D_VIRTUAL_QUERY_POOL_COUNT)
-    {
-        device->query_pools[device->query_pool_count++] = *pool;
-        pthread_mutex_unlock(&device->mutex);
-    }
-    else
-    {
-        pthread_mutex_unlock(&device->mutex);
-        d3d12_device_destroy_query_pool(device, pool);
-    }
+    for (i = accepted_count; i < count; i++)
+        d3d12_device_destroy_query_pool(device, &pools[i]);
 }
 
 /* ID3D12Device */
-extern ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_AddRef(ID3D12DeviceExt *iface);
-extern ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_AddRef(ID3D12DXVKInteropDevice *iface);
+extern ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_AddRef(ID3D12DeviceExt2 *iface);
+extern ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_AddRef(ID3D12DXVKInteropDevice1 *iface);
+extern ULONG STDMETHODCALLTYPE d3d_low_latency_device_AddRef(ID3DLowLatencyDevice *iface);
 
 HRESULT STDMETHODCALLTYPE d3d12_device_QueryInterface(d3d12_device_iface *iface,
         REFIID riid, void **object)
@@ -2998,7 +3176,9 @@ HRESULT STDMETHODCALLTYPE d3d12_device_QueryInterface(d3d12_device_iface *iface,
         return S_OK;
     }
 
-    if (IsEqualGUID(riid, &IID_ID3D12DeviceExt))
+    if (IsEqualGUID(riid, &IID_ID3D12DeviceExt)
+            || IsEqualGUID(riid, &IID_ID3D12DeviceExt1)
+            || IsEqualGUID(riid, &IID_ID3D12DeviceExt2))
     {
         struct d3d12_device *device = impl_from_ID3D12Device(iface);
         d3d12_device_vkd3d_ext_AddRef(&device->ID3D12DeviceExt_iface);
@@ -3006,7 +3186,8 @@ HRESULT STDMETHODCALLTYPE d3d12_device_QueryInterface(d3d12_device_iface *iface,
         return S_OK;
     }
 
-    if (IsEqualGUID(riid, &IID_ID3D12DXVKInteropDevice))
+    if (IsEqualGUID(riid, &IID_ID3D12DXVKInteropDevice)
+            || IsEqualGUID(riid, &IID_ID3D12DXVKInteropDevice1))
     {
         struct d3d12_device *device = impl_from_ID3D12Device(iface);
         d3d12_dxvk_interop_device_AddRef(&device->ID3D12DXVKInteropDevice_iface);
@@ -3014,6 +3195,14 @@ HRESULT STDMETHODCALLTYPE d3d12_device_QueryInterface(d3d12_device_iface *iface,
         return S_OK;
     }
 
+    if (IsEqualGUID(riid, &IID_ID3DLowLatencyDevice))
+    {
+        struct d3d12_device *device = impl_from_ID3D12Device(iface);
+        d3d_low_latency_device_AddRef(&device->ID3DLowLatencyDevice_iface);
+        *object = &device->ID3DLowLatencyDevice_iface;
+        return S_OK;
+    }
+
     WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
 
     *object = NULL;
@@ -3030,8 +3219,23 @@ static ULONG STDMETHODCALLTYPE d3d12_device_AddRef(d3d12_device_iface *iface)
     return refcount;
 }
 
+static void vkd3d_pipeline_library_lookup_cache_log_stats(const struct vkd3d_pipeline_library_lookup_cache *cache,
+        const char *tag, uint32_t entry_count)
+{
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
+    {
+        INFO("%s pipeline libraries: %u entries, %u lock-free hits, %u locked hits, %u misses.\n",
+                tag, entry_count, cache->fast_hit_count, cache->hit_count, cache->miss_count);
+    }
+}
+
 static void d3d12_device_free_pipeline_libraries(struct d3d12_device *device)
 {
+    vkd3d_pipeline_library_lookup_cache_log_stats(&device->vertex_input_lookup,
+            "Vertex input", device->vertex_input_pipelines.used_count);
+    vkd3d_pipeline_library_lookup_cache_log_stats(&device->fragment_output_lookup,
+            "Fragment output", device->fragment_output_pipelines.used_count);
+
     hash_map_iter(&device->vertex_input_pipelines, vkd3d_vertex_input_pipeline_free, device);
     hash_map_free(&device->vertex_input_pipelines);
 
@@ -3045,6 +3249,15 @@ static void d3d12_device_destroy(struct d3d12_device *device)
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     size_t i, j;
 
+    /* Drain pending background jobs first, pipeline compiles may still push work to the disk cache. */
+    vkd3d_job_pool_cleanup(&device->job_pool);
+    vkd3d_shader_spirv_cache_cleanup(&device->spirv_cache);
+    /* Resources torn down by the worker may still end up in the recycle pool. */
+    vkd3d_resource_destroy_queue_cleanup(&device->resource_destroy_queue);
+    vkd3d_resource_recycle_pool_cleanup(&device->resource_recycle_pool, device);
+    vkd3d_memory_bind_queue_cleanup(&device->memory_binds, device);
+    vkd3d_shared_fence_worker_cleanup(&device->shared_fence_worker);
+
     for (i = 0; i < VKD3D_SCRATCH_POOL_KIND_COUNT; i++)
         for (j = 0; j < device->scratch_pools[i].scratch_buffer_count; j++)
             d3d12_device_destroy_scratch_buffer(device, &device->scratch_pools[i].scratch_buffers[j]);
@@ -3052,8 +3265,7 @@ static void d3d12_device_destroy(struct d3d12_device *device)
     for (i = 0; i < device->query_pool_count; i++)
         d3d12_device_destroy_query_pool(device, &device->query_pools[i]);
 
-    for (i = 0; i < device->cached_command_allocator_count; i++)
-        VK_CALL(vkDestroyCommandPool(device->vk_device, device->cached_command_allocators[i].vk_command_pool, NULL));
+    vkd3d_command_pool_cache_cleanup(&device->command_pool_cache, device);
 
     vkd3d_free(device->descriptor_heap_gpu_vas);
 
@@ -3067,13 +3279,24 @@ static void d3d12_device_destroy(struct d3d12_device *device)
         vkd3d_breadcrumb_tracer_cleanup(&device->breadcrumb_tracer, device);
 #endif
     vkd3d_pipeline_library_flush_disk_cache(&device->disk_cache);
+    vkd3d_pipeline_telemetry_cleanup(&device->pipeline_telemetry);
+    vkd3d_meta_timing_cleanup(&device->meta_timing, device);
+    vkd3d_shader_hash_cache_cleanup(&device->shader_hash_cache);
+    vkd3d_image_allocation_info_cache_cleanup(&device->image_allocation_info_cache);
+    vkd3d_image_create_info_cache_cleanup(&device->image_create_info_cache);
+    vkd3d_low_latency_state_cleanup(&device->low_latency, device);
+    vkd3d_pipeline_blob_store_cleanup(&device->pipeline_blob_store);
+    vkd3d_root_signature_cache_cleanup(&device->root_signature_cache);
     vkd3d_sampler_state_cleanup(&device->sampler_state, device);
+    vkd3d_sampler_payload_cache_cleanup(&device->sampler_payload_cache);
     vkd3d_view_map_destroy(&device->sampler_map, device);
     vkd3d_meta_ops_cleanup(&device->meta_ops, device);
     vkd3d_bindless_state_cleanup(&device->bindless_state, device);
     d3d12_device_destroy_vkd3d_queues(device);
     vkd3d_memory_allocator_cleanup(&device->memory_allocator, device);
     vkd3d_memory_transfer_queue_cleanup(&device->memory_transfers);
+    vkd3d_clock_calibration_cleanup(&device->clock_calibration);
+    vkd3d_residency_manager_cleanup(&device->residency_manager);
     vkd3d_global_descriptor_buffer_cleanup(&device->global_descriptor_buffer, device);
     d3d12_device_free_pipeline_libraries(device);
     /* Tear down descriptor global info late, so we catch last minute faults after we drain the queues. */
@@ -3086,6 +3309,8 @@ static void d3d12_device_destroy(struct d3d12_device *device)
 
     vkd3d_free((void *)device->vk_info.extension_names);
     VK_CALL(vkDestroyDevice(device->vk_device, NULL));
+    vkd3d_profiling_flush();
+    vkd3d_capture_flush();
     rwlock_destroy(&device->fragment_output_lock);
     rwlock_destroy(&device->vertex_input_lock);
     pthread_mutex_destroy(&device->mutex);
@@ -4429,7 +4654,7 @@ static inline void d3d12_device_copy_descriptors(struct d3d12_device *device,
     }
 }
 
-static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors(d3d12_device_iface *iface,
+static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors_default(d3d12_device_iface *iface,
         UINT dst_descriptor_range_count, const D3D12_CPU_DESCRIPTOR_HANDLE *dst_descriptor_range_offsets,
         const UINT *dst_descriptor_range_sizes,
         UINT src_descriptor_range_count, const D3D12_CPU_DESCRIPTOR_HANDLE *src_descriptor_range_offsets,
@@ -4452,7 +4677,99 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors(d3d12_device_iface *i
             descriptor_heap_type);
 }
 
-static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buffer_16_16_4(d3d12_device_iface *iface,
+#define VKD3D_COPY_DESCRIPTORS_METADATA_MEMCPY_THRESHOLD 16
+
+typedef void (*pfn_d3d12_device_copy_descriptors_simple)(d3d12_device_iface *iface,
+        UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
+        const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type);
+
+/* Splits the range lists into runs which are contiguous in both source and destination
+ * and hands each run to one of the specialized CopyDescriptorsSimple kernels.
+ * This is always inlined with a constant kernel, so there is no indirect call per run. */
+static inline void d3d12_device_copy_descriptor_ranges(d3d12_device_iface *iface,
+        UINT dst_descriptor_range_count, const D3D12_CPU_DESCRIPTOR_HANDLE *dst_descriptor_range_offsets,
+        const UINT *dst_descriptor_range_sizes,
+        UINT src_descriptor_range_count, const D3D12_CPU_DESCRIPTOR_HANDLE *src_descriptor_range_offsets,
+        const UINT *src_descriptor_range_sizes,
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type,
+        pfn_d3d12_device_copy_descriptors_simple copy_run)
+{
+    unsigned int dst_range_idx, dst_idx, src_range_idx, src_idx;
+    unsigned int dst_range_size, src_range_size, copy_count;
+    struct d3d12_device *device;
+    unsigned int increment;
+
+    device = unsafe_impl_from_ID3D12Device(iface);
+
+    if (VKD3D_EXPECT_FALSE(descriptor_heap_type != D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV &&
+            descriptor_heap_type != D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER))
+    {
+        d3d12_device_copy_descriptors(device,
+                dst_descriptor_range_count, dst_descriptor_range_offsets,
+                dst_descriptor_range_sizes,
+                src_descriptor_range_count, src_descriptor_range_offsets,
+                src_descriptor_range_sizes,
+                descriptor_heap_type);
+        return;
+    }
+
+    increment = d3d12_device_get_descriptor_handle_increment_size(device, descriptor_heap_type);
+
+    dst_range_idx = dst_idx = 0;
+    src_range_idx = src_idx = 0;
+    while (dst_range_idx < dst_descriptor_range_count && src_range_idx < src_descriptor_range_count)
+    {
+        dst_range_size = dst_descriptor_range_sizes ? dst_descriptor_range_sizes[dst_range_idx] : 1;
+        src_range_size = src_descriptor_range_sizes ? src_descriptor_range_sizes[src_range_idx] : 1;
+        copy_count = min(dst_range_size - dst_idx, src_range_size - src_idx);
+
+        if (copy_count)
+        {
+            copy_run(iface, copy_count,
+                    d3d12_advance_cpu_descriptor_handle(dst_descriptor_range_offsets[dst_range_idx], increment, dst_idx),
+                    d3d12_advance_cpu_descriptor_handle(src_descriptor_range_offsets[src_range_idx], increment, src_idx),
+                    descriptor_heap_type);
+        }
+
+        dst_idx += copy_count;
+        src_idx += copy_count;
+
+        if (dst_idx >= dst_range_size)
+        {
+            ++dst_range_idx;
+            dst_idx = 0;
+        }
+        if (src_idx >= src_range_size)
+        {
+            ++src_range_idx;
+            src_idx = 0;
+        }
+    }
+}
+
+#define VKD3D_DECLARE_COPY_DESCRIPTORS_VARIANT(variant) \
+static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors_##variant(d3d12_device_iface *iface, \
+        UINT dst_descriptor_range_count, const D3D12_CPU_DESCRIPTOR_HANDLE *dst_descriptor_range_offsets, \
+        const UINT *dst_descriptor_range_sizes, \
+        UINT src_descriptor_range_count, const D3D12_CPU_DESCRIPTOR_HANDLE *src_descriptor_range_offsets, \
+        const UINT *src_descriptor_range_sizes, \
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type) \
+{ \
+    TRACE("iface %p, dst_descriptor_range_count %u, dst_descriptor_range_offsets %p, " \
+            "dst_descriptor_range_sizes %p, src_descriptor_range_count %u, " \
+            "src_descriptor_range_offsets %p, src_descriptor_range_sizes %p, " \
+            "descriptor_heap_type %#x.\n", \
+            iface, dst_descriptor_range_count, dst_descriptor_range_offsets, \
+            dst_descriptor_range_sizes, src_descriptor_range_count, src_descriptor_range_offsets, \
+            src_descriptor_range_sizes, descriptor_heap_type); \
+    d3d12_device_copy_descriptor_ranges(iface, \
+            dst_descriptor_range_count, dst_descriptor_range_offsets, dst_descriptor_range_sizes, \
+            src_descriptor_range_count, src_descriptor_range_offsets, src_descriptor_range_sizes, \
+            descriptor_heap_type, d3d12_device_copy_descriptors_simple_##variant); \
+}
+
+static inline void d3d12_device_copy_descriptors_simple_descriptor_buffer_16_16_4(d3d12_device_iface *iface,
         UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
         const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
         D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
@@ -4465,11 +4782,6 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buff
     struct d3d12_desc_split src;
     size_t i, n;
 
-    TRACE("iface %p, descriptor_count %u, dst_descriptor_range_offset %#lx, "
-          "src_descriptor_range_offset %#lx, descriptor_heap_type %#x.\n",
-            iface, descriptor_count, dst_descriptor_range_offset.ptr, src_descriptor_range_offset.ptr,
-            descriptor_heap_type);
-
     if (VKD3D_EXPECT_TRUE(descriptor_heap_type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ||
             descriptor_heap_type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER))
     {
@@ -4496,7 +4808,21 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buff
         src_set0 += src.offset * 16;
         src_set1 += src.offset * 16;
 
-        if (VKD3D_EXPECT_TRUE(descriptor_count == 1))
+        if (VKD3D_EXPECT_FALSE(dst.heap->copy_fingerprints))
+        {
+            for (i = 0, n = descriptor_count; i < n; i++)
+            {
+                if (d3d12_desc_copy_is_redundant(&dst, &src, i))
+                    continue;
+
+                vkd3d_memcpy_aligned_16_cached(dst_set0 + 16 * i, src_set0 + 16 * i);
+                vkd3d_memcpy_aligned_16_cached(dst_set1 + 16 * i, src_set1 + 16 * i);
+                dst.view[i] = src.view[i];
+                dst.types[i] = src.types[i];
+                dst_va[dst.offset + i] = src_va[src.offset + i];
+            }
+        }
+        else if (VKD3D_EXPECT_TRUE(descriptor_count == 1))
         {
             vkd3d_memcpy_aligned_16_cached(dst_set0, src_set0);
             vkd3d_memcpy_aligned_16_cached(dst_set1, src_set1);
@@ -4511,13 +4837,24 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buff
             dst_va += dst.offset;
             src_va += src.offset;
 
-            /* Enforce size_t for better x86 addressing.
-             * Avoid memcpy since we need to optimize for small descriptor count. */
-            for (i = 0, n = descriptor_count; i < n; i++)
+            if (descriptor_count >= VKD3D_COPY_DESCRIPTORS_METADATA_MEMCPY_THRESHOLD)
             {
-                dst_va[i] = src_va[i];
-                dst.view[i] = src.view[i];
-                dst.types[i] = src.types[i];
+                /* Long runs are common when copying tables from multiple ranges,
+                 * let memcpy use wide loads and stores for the metadata. */
+                memcpy(dst_va, src_va, descriptor_count * sizeof(*dst_va));
+                memcpy(dst.view, src.view, descriptor_count * sizeof(*dst.view));
+                memcpy(dst.types, src.types, descriptor_count * sizeof(*dst.types));
+            }
+            else
+            {
+                /* Enforce size_t for better x86 addressing.
+                 * Avoid memcpy since we need to optimize for small descriptor count. */
+                for (i = 0, n = descriptor_count; i < n; i++)
+                {
+                    dst_va[i] = src_va[i];
+                    dst.view[i] = src.view[i];
+                    dst.types[i] = src.types[i];
+                }
             }
         }
     }
@@ -4529,7 +4866,19 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buff
         src_sampler += src.offset;
         dst_sampler += dst.offset;
 
-        if (VKD3D_EXPECT_TRUE(descriptor_count == 1))
+        if (VKD3D_EXPECT_FALSE(dst.heap->copy_fingerprints))
+        {
+            for (i = 0, n = descriptor_count; i < n; i++)
+            {
+                if (d3d12_desc_copy_is_redundant(&dst, &src, i))
+                    continue;
+
+                dst_sampler[i] = src_sampler[i];
+                dst.view[i] = src.view[i];
+                dst.types[i] = src.types[i];
+            }
+        }
+        else if (VKD3D_EXPECT_TRUE(descriptor_count == 1))
         {
             *dst_sampler = *src_sampler;
             *dst.view = *src.view;
@@ -4537,13 +4886,22 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buff
         }
         else
         {
-            /* Enforce size_t for better x86 addressing.
-             * Avoid memcpy since we need to optimize for small descriptor count. */
-            for (i = 0, n = descriptor_count; i < n; i++)
+            if (descriptor_count >= VKD3D_COPY_DESCRIPTORS_METADATA_MEMCPY_THRESHOLD)
             {
-                dst_sampler[i] = src_sampler[i];
-                dst.view[i] = src.view[i];
-                dst.types[i] = src.types[i];
+                memcpy(dst_sampler, src_sampler, descriptor_count * sizeof(*dst_sampler));
+                memcpy(dst.view, src.view, descriptor_count * sizeof(*dst.view));
+                memcpy(dst.types, src.types, descriptor_count * sizeof(*dst.types));
+            }
+            else
+            {
+                /* Enforce size_t for better x86 addressing.
+                 * Avoid memcpy since we need to optimize for small descriptor count. */
+                for (i = 0, n = descriptor_count; i < n; i++)
+                {
+                    dst_sampler[i] = src_sampler[i];
+                    dst.view[i] = src.view[i];
+                    dst.types[i] = src.types[i];
+                }
             }
         }
     }
@@ -4557,17 +4915,29 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buff
     }
 }
 
-static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_64_16_packed(d3d12_device_iface *iface,
+static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_descriptor_buffer_16_16_4(d3d12_device_iface *iface,
         UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
         const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
         D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
 {
-    struct d3d12_device *device;
     TRACE("iface %p, descriptor_count %u, dst_descriptor_range_offset %#lx, "
           "src_descriptor_range_offset %#lx, descriptor_heap_type %#x.\n",
             iface, descriptor_count, dst_descriptor_range_offset.ptr, src_descriptor_range_offset.ptr,
             descriptor_heap_type);
 
+    d3d12_device_copy_descriptors_simple_descriptor_buffer_16_16_4(iface, descriptor_count,
+            dst_descriptor_range_offset, src_descriptor_range_offset, descriptor_heap_type);
+}
+
+VKD3D_DECLARE_COPY_DESCRIPTORS_VARIANT(descriptor_buffer_16_16_4)
+
+static inline void d3d12_device_copy_descriptors_simple_embedded_64_16_packed(d3d12_device_iface *iface,
+        UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
+        const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
+{
+    struct d3d12_device *device;
+
     if (VKD3D_EXPECT_TRUE(descriptor_heap_type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV))
     {
         /* If metadata is packed, this collapses to pure memcpy. */
@@ -4650,17 +5020,29 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_64_16_
     }
 }
 
-static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_32_16_planar(d3d12_device_iface *iface,
+static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_64_16_packed(d3d12_device_iface *iface,
         UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
         const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
         D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
 {
-    struct d3d12_device *device;
     TRACE("iface %p, descriptor_count %u, dst_descriptor_range_offset %#lx, "
           "src_descriptor_range_offset %#lx, descriptor_heap_type %#x.\n",
             iface, descriptor_count, dst_descriptor_range_offset.ptr, src_descriptor_range_offset.ptr,
             descriptor_heap_type);
 
+    d3d12_device_copy_descriptors_simple_embedded_64_16_packed(iface, descriptor_count,
+            dst_descriptor_range_offset, src_descriptor_range_offset, descriptor_heap_type);
+}
+
+VKD3D_DECLARE_COPY_DESCRIPTORS_VARIANT(embedded_64_16_packed)
+
+static inline void d3d12_device_copy_descriptors_simple_embedded_32_16_planar(d3d12_device_iface *iface,
+        UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
+        const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
+{
+    struct d3d12_device *device;
+
     if (VKD3D_EXPECT_TRUE(descriptor_heap_type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV))
     {
         if (VKD3D_EXPECT_TRUE(descriptor_count == 1))
@@ -4707,17 +5089,29 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_32_16_
     }
 }
 
-static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_generic(d3d12_device_iface *iface,
+static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_32_16_planar(d3d12_device_iface *iface,
         UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
         const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
         D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
 {
-    struct d3d12_device *device;
     TRACE("iface %p, descriptor_count %u, dst_descriptor_range_offset %#lx, "
           "src_descriptor_range_offset %#lx, descriptor_heap_type %#x.\n",
             iface, descriptor_count, dst_descriptor_range_offset.ptr, src_descriptor_range_offset.ptr,
             descriptor_heap_type);
 
+    d3d12_device_copy_descriptors_simple_embedded_32_16_planar(iface, descriptor_count,
+            dst_descriptor_range_offset, src_descriptor_range_offset, descriptor_heap_type);
+}
+
+VKD3D_DECLARE_COPY_DESCRIPTORS_VARIANT(embedded_32_16_planar)
+
+static inline void d3d12_device_copy_descriptors_simple_embedded_generic(d3d12_device_iface *iface,
+        UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
+        const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
+{
+    struct d3d12_device *device;
+
     device = unsafe_impl_from_ID3D12Device(iface);
 
     if (VKD3D_EXPECT_TRUE(descriptor_heap_type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV))
@@ -4743,6 +5137,22 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_generi
     }
 }
 
+static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_embedded_generic(d3d12_device_iface *iface,
+        UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
+        const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
+        D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
+{
+    TRACE("iface %p, descriptor_count %u, dst_descriptor_range_offset %#lx, "
+          "src_descriptor_range_offset %#lx, descriptor_heap_type %#x.\n",
+            iface, descriptor_count, dst_descriptor_range_offset.ptr, src_descriptor_range_offset.ptr,
+            descriptor_heap_type);
+
+    d3d12_device_copy_descriptors_simple_embedded_generic(iface, descriptor_count,
+            dst_descriptor_range_offset, src_descriptor_range_offset, descriptor_heap_type);
+}
+
+VKD3D_DECLARE_COPY_DESCRIPTORS_VARIANT(embedded_generic)
+
 static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_default(d3d12_device_iface *iface,
         UINT descriptor_count, const D3D12_CPU_DESCRIPTOR_HANDLE dst_descriptor_range_offset,
         const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
@@ -5175,60 +5585,798 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_OpenSharedHandleByName(d3d12_devic
     return E_NOTIMPL;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_MakeResident(d3d12_device_iface *iface,
-        UINT object_count, ID3D12Pageable * const *objects)
+static bool d3d12_device_get_residency_object(ID3D12Pageable *pageable, struct vkd3d_residency_object *object)
 {
-    struct d3d12_device *device = impl_from_ID3D12Device(iface);
-    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    ID3D12Resource *resource_iface;
+    ID3D12Heap *heap_iface;
 
-    TRACE("iface %p, object_count %u, objects %p\n",
-            iface, object_count, objects);
+    /* On success, the returned object holds a reference until vkd3d_residency_object_release(). */
+    memset(object, 0, sizeof(*object));
 
-    if (device->device_info.pageable_device_memory_features.pageableDeviceLocalMemory)
+    if (SUCCEEDED(ID3D12Pageable_QueryInterface(pageable, &IID_ID3D12Heap, (void**)&heap_iface)))
     {
-        uint32_t i;
+        object->heap = impl_from_ID3D12Heap(heap_iface);
 
-        for (i = 0; i < object_count; i++)
-        {
-            VkDeviceMemory memory = VK_NULL_HANDLE;
-            D3D12_RESIDENCY_PRIORITY priority;
-            ID3D12Resource *resource_iface;
-            ID3D12Heap *heap_iface;
+        if (object->heap->priority.allows_dynamic_residency)
+            return true;
 
-            if (SUCCEEDED(ID3D12Pageable_QueryInterface(objects[i], &IID_ID3D12Heap, (void**)&heap_iface)))
-            {
-                struct d3d12_heap *heap_object = impl_from_ID3D12Heap(heap_iface);
+        ID3D12Heap_Release(heap_iface);
+        object->heap = NULL;
+    }
+    else if (SUCCEEDED(ID3D12Pageable_QueryInterface(pageable, &IID_ID3D12Resource, (void**)&resource_iface)))
+    {
+        object->resource = impl_from_ID3D12Resource(resource_iface);
 
-                if (heap_object->priority.allows_dynamic_residency)
-                {
-                    memory = heap_object->allocation.device_allocation.vk_memory;
-                    spinlock_acquire(&heap_object->priority.spinlock);
-                    priority = heap_object->priority.d3d12priority;
-                    heap_object->priority.residency_count++;
-                    spinlock_release(&heap_object->priority.spinlock);
-                }
+        if (object->resource->priority.allows_dynamic_residency)
+            return true;
 
-                ID3D12Heap_Release(heap_iface);
-            }
-            else if (SUCCEEDED(ID3D12Pageable_QueryInterface(objects[i], &IID_ID3D12Resource, (void**)&resource_iface)))
-            {
-                struct d3d12_resource *resource_object = impl_from_ID3D12Resource(resource_iface);
+        ID3D12Resource_Release(resource_iface);
+        object->resource = NULL;
+    }
 
-                if (resource_object->priority.allows_dynamic_residency)
-                {
-                    memory = resource_object->mem.device_allocation.vk_memory;
-                    spinlock_acquire(&resource_object->priority.spinlock);
-                    priority = resource_object->priority.d3d12priority;
-                    resource_object->priority.residency_count++;
-                    spinlock_release(&resource_object->priority.spinlock);
-                }
+    return false;
+}
 
-                ID3D12Resource_Release(resource_iface);
+static void vkd3d_residency_object_release(struct vkd3d_residency_object *object)
+{
+    if (object->heap)
+        ID3D12Heap1_Release(&object->heap->ID3D12Heap_iface);
+    else if (object->resource)
+        ID3D12Resource2_Release(&object->resource->ID3D12Resource_iface);
+}
+
+static priority_info *vkd3d_residency_object_get_priority(const struct vkd3d_residency_object *object,
+        const struct vkd3d_device_memory_allocation **allocation)
+{
+    if (object->heap)
+    {
+        *allocation = &object->heap->allocation.device_allocation;
+        return &object->heap->priority;
+    }
+    else
+    {
+        *allocation = &object->resource->mem.device_allocation;
+        return &object->resource->priority;
+    }
+}
+
+static void d3d12_device_make_object_resident(struct d3d12_device *device,
+        const struct vkd3d_residency_object *object)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    const struct vkd3d_device_memory_allocation *allocation;
+    D3D12_RESIDENCY_PRIORITY priority;
+    priority_info *info;
+
+    info = vkd3d_residency_object_get_priority(object, &allocation);
+
+    spinlock_acquire(&info->spinlock);
+    priority = info->d3d12priority;
+    info->residency_count++;
+    info->demoted = false;
+    spinlock_release(&info->spinlock);
+
+    vkd3d_residency_manager_mark_use(&device->residency_manager, info);
+    VK_CALL(vkSetDeviceMemoryPriorityEXT(device->vk_device, allocation->vk_memory, vkd3d_convert_to_vk_prio(priority)));
+}
+
+static bool d3d12_device_residency_fits_budget(struct d3d12_device *device,
+        const struct vkd3d_residency_object *objects, size_t object_count)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkDeviceSize required_size[VK_MAX_MEMORY_HEAPS] = { 0 };
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties;
+    const struct vkd3d_device_memory_allocation *allocation;
+    VkPhysicalDeviceMemoryProperties2 memory_properties;
+    priority_info *info;
+    uint32_t heap_index;
+    bool is_evicted;
+    size_t i;
+
+    if (!device->vk_info.EXT_memory_budget)
+        return true;
+
+    /* Evicted allocations are only demoted in priority, so they are not necessarily accounted for
+     * in the current usage if the driver has paged them out. Conservatively assume that
+     * everything which is currently evicted has to fit within the remaining budget. */
+    for (i = 0; i < object_count; i++)
+    {
+        info = vkd3d_residency_object_get_priority(&objects[i], &allocation);
+
+        spinlock_acquire(&info->spinlock);
+        is_evicted = !info->residency_count;
+        spinlock_release(&info->spinlock);
+
+        if (is_evicted)
+        {
+            heap_index = device->memory_properties.memoryTypes[allocation->vk_memory_type].heapIndex;
+            required_size[heap_index] += allocation->size;
+        }
+    }
+
+    memset(&budget_properties, 0, sizeof(budget_properties));
+    budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    memory_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memory_properties.pNext = &budget_properties;
+
+    VK_CALL(vkGetPhysicalDeviceMemoryProperties2(device->vk_physical_device, &memory_properties));
+
+    for (i = 0; i < memory_properties.memoryProperties.memoryHeapCount; i++)
+    {
+        if (!required_size[i])
+            continue;
+
+        if (budget_properties.heapUsage[i] + required_size[i] > budget_properties.heapBudget[i])
+        {
+            if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET)
+            {
+                INFO("Denying residency request for heap %zu, usage %"PRIu64" MiB, "
+                        "required %"PRIu64" MiB, budget %"PRIu64" MiB.\n", i,
+                        budget_properties.heapUsage[i] / (1024 * 1024),
+                        required_size[i] / (1024 * 1024),
+                        budget_properties.heapBudget[i] / (1024 * 1024));
             }
+            return false;
+        }
+    }
 
-            if (memory)
+    return true;
+}
+
+static void vkd3d_residency_manager_process_request(struct vkd3d_residency_manager *manager,
+        struct vkd3d_residency_request *request)
+{
+    HRESULT hr;
+    size_t i;
+
+    for (i = 0; i < request->object_count; i++)
+    {
+        d3d12_device_make_object_resident(manager->device, &request->objects[i]);
+        vkd3d_residency_object_release(&request->objects[i]);
+    }
+
+    /* Only signal once all priority changes have been applied. */
+    if (FAILED(hr = ID3D12Fence_Signal(request->fence, request->fence_value)))
+        ERR("Failed to signal residency fence, hr #%x.\n", hr);
+
+    ID3D12Fence_Release(request->fence);
+    vkd3d_free(request->objects);
+}
+
+struct vkd3d_residency_candidate
+{
+    priority_info *info;
+    D3D12_RESIDENCY_PRIORITY priority;
+    uint64_t last_use_frame;
+};
+
+/* Coldest first: lowest priority, then least recently used. */
+static int vkd3d_residency_candidate_compare(const void *a, const void *b)
+{
+    const struct vkd3d_residency_candidate *x = a;
+    const struct vkd3d_residency_candidate *y = b;
+
+    if (x->priority != y->priority)
+        return x->priority < y->priority ? -1 : 1;
+    if (x->last_use_frame != y->last_use_frame)
+        return x->last_use_frame < y->last_use_frame ? -1 : 1;
+    return 0;
+}
+
+static size_t vkd3d_residency_manager_gather_candidates_locked(struct vkd3d_residency_manager *manager,
+        uint32_t heap_index, bool demoted, struct vkd3d_residency_candidate **candidates, size_t *candidates_size)
+{
+    const VkPhysicalDeviceMemoryProperties *memory_props = &manager->device->memory_properties;
+    uint64_t frame_index = vkd3d_atomic_uint64_load_explicit(&manager->frame_index, vkd3d_memory_order_relaxed);
+    struct vkd3d_residency_candidate candidate;
+    size_t count = 0;
+    priority_info *info;
+    bool is_candidate;
+
+    LIST_FOR_EACH_ENTRY(info, &manager->tracked_objects, priority_info, entry)
+    {
+        if (memory_props->memoryTypes[info->allocation->vk_memory_type].heapIndex != heap_index)
+            continue;
+
+        spinlock_acquire(&info->spinlock);
+        is_candidate = info->residency_count && info->demoted == demoted;
+        candidate.priority = info->d3d12priority;
+        spinlock_release(&info->spinlock);
+
+        if (!is_candidate)
+            continue;
+
+        candidate.info = info;
+        candidate.last_use_frame = vkd3d_atomic_uint64_load_explicit(&info->last_use_frame,
+                vkd3d_memory_order_relaxed);
+
+        /* Never demote what the application is actively rendering to. */
+        if (!demoted && candidate.last_use_frame + VKD3D_RESIDENCY_HOT_FRAME_COUNT > frame_index)
+            continue;
+
+        if (!vkd3d_array_reserve((void **)candidates, candidates_size, count + 1, sizeof(**candidates)))
+            break;
+        (*candidates)[count++] = candidate;
+    }
+
+    qsort(*candidates, count, sizeof(**candidates), vkd3d_residency_candidate_compare);
+    return count;
+}
+
+static void vkd3d_residency_manager_demote_locked(struct vkd3d_residency_manager *manager,
+        uint32_t heap_index, VkDeviceSize required_size,
+        struct vkd3d_residency_candidate **candidates, size_t *candidates_size)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &manager->device->vk_procs;
+    VkDeviceSize demoted_size = 0;
+    size_t count, i;
+    priority_info *info;
+    bool demote;
+
+    count = vkd3d_residency_manager_gather_candidates_locked(manager, heap_index, false,
+            candidates, candidates_size);
+
+    for (i = 0; i < count && demoted_size < required_size; i++)
+    {
+        info = (*candidates)[i].info;
+
+        /* The application might have changed residency in the meantime. */
+        spinlock_acquire(&info->spinlock);
+        if ((demote = info->residency_count && !info->demoted))
+            info->demoted = true;
+        spinlock_release(&info->spinlock);
+
+        if (demote)
+        {
+            VK_CALL(vkSetDeviceMemoryPriorityEXT(manager->device->vk_device, info->allocation->vk_memory,
+                    vkd3d_convert_to_vk_prio(0)));
+            demoted_size += info->allocation->size;
+        }
+    }
+
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET)
+    {
+        INFO("Demoted %"PRIu64" MiB in memory heap %u, %"PRIu64" MiB over target.\n",
+                demoted_size / (1024 * 1024), heap_index, required_size / (1024 * 1024));
+    }
+}
+
+static void vkd3d_residency_manager_promote_locked(struct vkd3d_residency_manager *manager,
+        uint32_t heap_index, VkDeviceSize available_size,
+        struct vkd3d_residency_candidate **candidates, size_t *candidates_size)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &manager->device->vk_procs;
+    VkDeviceSize promoted_size = 0;
+    D3D12_RESIDENCY_PRIORITY priority;
+    priority_info *info;
+    bool is_resident;
+    bool promote;
+    size_t count;
+
+    count = vkd3d_residency_manager_gather_candidates_locked(manager, heap_index, true,
+            candidates, candidates_size);
+
+    /* Restore the hottest allocations first. */
+    while (count--)
+    {
+        info = (*candidates)[count].info;
+        if (promoted_size + info->allocation->size > available_size)
+            break;
+
+        spinlock_acquire(&info->spinlock);
+        if ((promote = info->demoted))
+            info->demoted = false;
+        priority = info->d3d12priority;
+        is_resident = !!info->residency_count;
+        spinlock_release(&info->spinlock);
+
+        if (promote)
+        {
+            VK_CALL(vkSetDeviceMemoryPriorityEXT(manager->device->vk_device, info->allocation->vk_memory,
+                    is_resident ? vkd3d_convert_to_vk_prio(priority) : 0.0f));
+            promoted_size += info->allocation->size;
+        }
+    }
+
+    if (promoted_size && (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET))
+        INFO("Promoted %"PRIu64" MiB in memory heap %u.\n", promoted_size / (1024 * 1024), heap_index);
+}
+
+static void vkd3d_residency_manager_balance(struct vkd3d_residency_manager *manager)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &manager->device->vk_procs;
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties;
+    struct vkd3d_residency_candidate *candidates = NULL;
+    VkPhysicalDeviceMemoryProperties2 memory_properties;
+    VkDeviceSize usage, budget;
+    size_t candidates_size = 0;
+    uint32_t i;
+
+    memset(&budget_properties, 0, sizeof(budget_properties));
+    budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    memory_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memory_properties.pNext = &budget_properties;
+
+    VK_CALL(vkGetPhysicalDeviceMemoryProperties2(manager->device->vk_physical_device, &memory_properties));
+
+    pthread_mutex_lock(&manager->mutex);
+
+    for (i = 0; i < memory_properties.memoryProperties.memoryHeapCount; i++)
+    {
+        if (!(memory_properties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+            continue;
+
+        usage = budget_properties.heapUsage[i];
+        budget = budget_properties.heapBudget[i];
+
+        /* Leave some hysteresis between demotion and promotion so we don't ping-pong every frame. */
+        if (usage > budget / 100 * 95)
+        {
+            vkd3d_residency_manager_demote_locked(manager, i, usage - budget / 100 * 90,
+                    &candidates, &candidates_size);
+        }
+        else if (usage < budget / 100 * 85)
+        {
+            vkd3d_residency_manager_promote_locked(manager, i, budget / 100 * 85 - usage,
+                    &candidates, &candidates_size);
+        }
+    }
+
+    pthread_mutex_unlock(&manager->mutex);
+    vkd3d_free(candidates);
+}
+
+void vkd3d_residency_manager_register(struct vkd3d_residency_manager *manager,
+        priority_info *info, const struct vkd3d_device_memory_allocation *allocation)
+{
+    if (!manager->demotion_enabled)
+        return;
+
+    info->allocation = allocation;
+    info->last_use_frame = vkd3d_atomic_uint64_load_explicit(&manager->frame_index, vkd3d_memory_order_relaxed);
+
+    pthread_mutex_lock(&manager->mutex);
+    list_add_tail(&manager->tracked_objects, &info->entry);
+    info->tracked = true;
+    pthread_mutex_unlock(&manager->mutex);
+}
+
+void vkd3d_residency_manager_unregister(struct vkd3d_residency_manager *manager, priority_info *info)
+{
+    if (!info->tracked)
+        return;
+
+    pthread_mutex_lock(&manager->mutex);
+    list_remove(&info->entry);
+    info->tracked = false;
+    pthread_mutex_unlock(&manager->mutex);
+}
+
+static void vkd3d_residency_manager_request_balance_locked(struct vkd3d_residency_manager *manager)
+{
+    manager->allocated_since_balance = 0;
+    manager->balance_requested = true;
+    pthread_cond_signal(&manager->cond);
+}
+
+void vkd3d_residency_manager_notify_allocation(struct vkd3d_residency_manager *manager,
+        uint32_t vk_memory_type, VkDeviceSize size, bool failed)
+{
+    const VkPhysicalDeviceMemoryProperties *memory_props = &manager->device->memory_properties;
+
+    if (!manager->demotion_enabled ||
+            !(memory_props->memoryTypes[vk_memory_type].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+        return;
+
+    pthread_mutex_lock(&manager->mutex);
+    manager->allocated_since_balance += size;
+    if (failed || manager->allocated_since_balance >= VKD3D_RESIDENCY_BALANCE_ALLOCATION_THRESHOLD)
+        vkd3d_residency_manager_request_balance_locked(manager);
+    pthread_mutex_unlock(&manager->mutex);
+}
+
+void vkd3d_residency_manager_notify_frame(struct vkd3d_residency_manager *manager)
+{
+    uint64_t frame_index;
+
+    if (!manager->demotion_enabled)
+        return;
+
+    frame_index = vkd3d_atomic_uint64_increment(&manager->frame_index, vkd3d_memory_order_relaxed);
+
+    if (frame_index % VKD3D_RESIDENCY_BALANCE_FRAME_INTERVAL == 0)
+    {
+        pthread_mutex_lock(&manager->mutex);
+        vkd3d_residency_manager_request_balance_locked(manager);
+        pthread_mutex_unlock(&manager->mutex);
+    }
+}
+
+static void *vkd3d_residency_manager_main(void *userdata)
+{
+    struct vkd3d_residency_manager *manager = userdata;
+    struct vkd3d_residency_request *old_requests;
+    struct vkd3d_residency_request *requests;
+    size_t requests_size, requests_count;
+    size_t old_requests_size;
+    bool balance;
+    size_t i;
+
+    vkd3d_set_thread_name("vkd3d-residency");
+
+    requests = NULL;
+    requests_size = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&manager->mutex);
+
+        while (!manager->requests_count && !manager->balance_requested && !manager->should_exit)
+            pthread_cond_wait(&manager->cond, &manager->mutex);
+
+        /* Drain everything that is still pending before exiting, so that no fence is left unsignaled. */
+        if (!manager->requests_count && manager->should_exit)
+        {
+            pthread_mutex_unlock(&manager->mutex);
+            break;
+        }
+
+        balance = manager->balance_requested;
+        manager->balance_requested = false;
+
+        old_requests = requests;
+        old_requests_size = requests_size;
+
+        requests = manager->requests;
+        requests_size = manager->requests_size;
+        requests_count = manager->requests_count;
+
+        manager->requests = old_requests;
+        manager->requests_size = old_requests_size;
+        manager->requests_count = 0;
+
+        pthread_mutex_unlock(&manager->mutex);
+
+        for (i = 0; i < requests_count; i++)
+            vkd3d_residency_manager_process_request(manager, &requests[i]);
+
+        if (balance)
+            vkd3d_residency_manager_balance(manager);
+    }
+
+    vkd3d_free(requests);
+    return NULL;
+}
+
+static HRESULT vkd3d_residency_manager_enqueue(struct vkd3d_residency_manager *manager,
+        struct vkd3d_residency_object *objects, size_t object_count,
+        ID3D12Fence *fence, UINT64 fence_value)
+{
+    struct vkd3d_residency_request request;
+
+    request.objects = objects;
+    request.object_count = object_count;
+    request.fence = fence;
+    request.fence_value = fence_value;
+    ID3D12Fence_AddRef(fence);
+
+    if (manager->thread_active)
+    {
+        pthread_mutex_lock(&manager->mutex);
+        if (vkd3d_array_reserve((void **)&manager->requests, &manager->requests_size,
+                manager->requests_count + 1, sizeof(*manager->requests)))
+        {
+            manager->requests[manager->requests_count++] = request;
+            pthread_cond_signal(&manager->cond);
+            pthread_mutex_unlock(&manager->mutex);
+            return S_OK;
+        }
+        pthread_mutex_unlock(&manager->mutex);
+        ERR("Failed to enqueue residency request, processing it synchronously.\n");
+    }
+
+    vkd3d_residency_manager_process_request(manager, &request);
+    return S_OK;
+}
+
+HRESULT vkd3d_residency_manager_init(struct vkd3d_residency_manager *manager, struct d3d12_device *device)
+{
+    int rc;
+
+    memset(manager, 0, sizeof(*manager));
+    manager->device = device;
+    list_init(&manager->tracked_objects);
+
+    /* Without pageable memory, residency is a no-op and EnqueueMakeResident signals right away. */
+    if (!device->device_info.pageable_device_memory_features.pageableDeviceLocalMemory)
+        return S_OK;
+
+    if ((rc = pthread_mutex_init(&manager->mutex, NULL)))
+        return hresult_from_errno(rc);
+
+    if ((rc = pthread_cond_init(&manager->cond, NULL)))
+    {
+        pthread_mutex_destroy(&manager->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    if ((rc = pthread_create(&manager->thread, NULL, vkd3d_residency_manager_main, manager)))
+    {
+        pthread_cond_destroy(&manager->cond);
+        pthread_mutex_destroy(&manager->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    manager->thread_active = true;
+
+    /* Budget-driven demotion needs to know the budget. */
+    manager->demotion_enabled = device->vk_info.EXT_memory_budget &&
+            (vkd3d_config_flags & VKD3D_CONFIG_FLAG_RESIDENCY_DEMOTION);
+    if (manager->demotion_enabled)
+        INFO("Enabling automatic residency demotion.\n");
+
+    return S_OK;
+}
+
+void vkd3d_residency_manager_cleanup(struct vkd3d_residency_manager *manager)
+{
+    if (!manager->thread_active)
+        return;
+
+    pthread_mutex_lock(&manager->mutex);
+    manager->should_exit = true;
+    pthread_cond_signal(&manager->cond);
+    pthread_mutex_unlock(&manager->mutex);
+
+    pthread_join(manager->thread, NULL);
+
+    vkd3d_free(manager->requests);
+    pthread_cond_destroy(&manager->cond);
+    pthread_mutex_destroy(&manager->mutex);
+}
+
+/* Samples with a wider bracket than this are likely preempted and not worth keeping. */
+#define VKD3D_CLOCK_CALIBRATION_MAX_BRACKET_NS 50000ull
+#define VKD3D_CLOCK_CALIBRATION_ATTEMPTS 4
+/* A sample this far off the model means the device clock was reset, e.g. after suspend. */
+#define VKD3D_CLOCK_CALIBRATION_RESET_THRESHOLD_NS 1000000.0
+
+static bool vkd3d_clock_calibration_sample(struct vkd3d_clock_calibration *calibration,
+        struct vkd3d_clock_calibration_sample *sample)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &calibration->device->vk_procs;
+    uint64_t begin_ns, end_ns, timestamp, max_deviation;
+    VkCalibratedTimestampInfoEXT timestamp_info;
+    uint64_t best_bracket_ns = UINT64_MAX;
+    unsigned int i;
+    VkResult vr;
+
+    timestamp_info.sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    timestamp_info.pNext = NULL;
+    timestamp_info.timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+
+    /* Bracketing the device sample with our own clock works with any host time domain.
+     * Keep the tightest of a few attempts to filter out preemption. */
+    for (i = 0; i < VKD3D_CLOCK_CALIBRATION_ATTEMPTS; i++)
+    {
+        begin_ns = vkd3d_get_current_time_ns();
+        vr = VK_CALL(vkGetCalibratedTimestampsEXT(calibration->device->vk_device,
+                1, &timestamp_info, &timestamp, &max_deviation));
+        end_ns = vkd3d_get_current_time_ns();
+
+        if (vr < 0)
+        {
+            ERR("Failed to query calibrated timestamps, vr %d.\n", vr);
+            return false;
+        }
+
+        if (end_ns - begin_ns < best_bracket_ns)
+        {
+            best_bracket_ns = end_ns - begin_ns;
+            sample->host_ns = begin_ns + best_bracket_ns / 2;
+            sample->gpu_ticks = timestamp;
+        }
+
+        if (best_bracket_ns <= VKD3D_CLOCK_CALIBRATION_MAX_BRACKET_NS)
+            break;
+    }
+
+    return true;
+}
+
+static void vkd3d_clock_calibration_add_sample(struct vkd3d_clock_calibration *calibration,
+        const struct vkd3d_clock_calibration_sample *sample)
+{
+    const struct vkd3d_clock_calibration_sample *s;
+    double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+    double ticks_per_ns, x, y, n, denom, error_ns, ratio;
+    unsigned int i;
+
+    if (calibration->valid)
+    {
+        error_ns = (double)(int64_t)(sample->gpu_ticks - calibration->anchor.gpu_ticks) / calibration->ticks_per_ns -
+                (double)(int64_t)(sample->host_ns - calibration->anchor.host_ns);
+        if (error_ns > VKD3D_CLOCK_CALIBRATION_RESET_THRESHOLD_NS || error_ns < -VKD3D_CLOCK_CALIBRATION_RESET_THRESHOLD_NS)
+        {
+            WARN("Device timestamp is %.3f ms off the calibration model, resetting.\n", 1e-6 * error_ns);
+            calibration->sample_count = 0;
+            calibration->sample_index = 0;
+        }
+    }
+
+    calibration->samples[calibration->sample_index] = *sample;
+    calibration->sample_index = (calibration->sample_index + 1) % VKD3D_CLOCK_CALIBRATION_SAMPLE_COUNT;
+    calibration->sample_count = min(calibration->sample_count + 1, VKD3D_CLOCK_CALIBRATION_SAMPLE_COUNT);
+
+    /* Least-squares fit relative to the newest sample to keep the doubles precise. */
+    ticks_per_ns = calibration->nominal_ticks_per_ns;
+    if (calibration->sample_count >= 2)
+    {
+        for (i = 0; i < calibration->sample_count; i++)
+        {
+            s = &calibration->samples[i];
+            x = (double)(int64_t)(s->host_ns - sample->host_ns);
+            y = (double)(int64_t)(s->gpu_ticks - sample->gpu_ticks);
+            sum_x += x;
+            sum_y += y;
+            sum_xx += x * x;
+            sum_xy += x * y;
+        }
+
+        n = (double)calibration->sample_count;
+        denom = n * sum_xx - sum_x * sum_x;
+        if (denom > 0.0)
+        {
+            ticks_per_ns = (n * sum_xy - sum_x * sum_y) / denom;
+
+            /* Real clock drift is in the order of ppm, anything else is noise. */
+            ratio = ticks_per_ns / calibration->nominal_ticks_per_ns;
+            if (ratio > 1.001 || ratio < 0.999)
+                ticks_per_ns = calibration->nominal_ticks_per_ns;
+        }
+    }
+
+    spinlock_acquire(&calibration->model_lock);
+    calibration->anchor = *sample;
+    calibration->ticks_per_ns = ticks_per_ns;
+    calibration->valid = true;
+    spinlock_release(&calibration->model_lock);
+}
+
+static void *vkd3d_clock_calibration_main(void *userdata)
+{
+    struct vkd3d_clock_calibration *calibration = userdata;
+    struct vkd3d_clock_calibration_sample sample;
+
+    vkd3d_set_thread_name("vkd3d-clock");
+
+    pthread_mutex_lock(&calibration->mutex);
+
+    while (!calibration->should_exit)
+    {
+        if (condvar_reltime_wait_timeout_seconds(&calibration->cond, &calibration->mutex, 1) < 0)
+        {
+            ERR("Failed to wait on condition variable.\n");
+            break;
+        }
+
+        if (calibration->should_exit)
+            break;
+
+        pthread_mutex_unlock(&calibration->mutex);
+        if (vkd3d_clock_calibration_sample(calibration, &sample))
+            vkd3d_clock_calibration_add_sample(calibration, &sample);
+        pthread_mutex_lock(&calibration->mutex);
+    }
+
+    pthread_mutex_unlock(&calibration->mutex);
+    return NULL;
+}
+
+HRESULT vkd3d_clock_calibration_init(struct vkd3d_clock_calibration *calibration, struct d3d12_device *device)
+{
+    struct vkd3d_clock_calibration_sample sample;
+    int rc;
+
+    memset(calibration, 0, sizeof(*calibration));
+    calibration->device = device;
+    spinlock_init(&calibration->model_lock);
+
+    if (!device->vk_info.EXT_calibrated_timestamps || !(device->device_info.time_domains & VKD3D_TIME_DOMAIN_DEVICE))
+        return S_OK;
+
+    calibration->nominal_ticks_per_ns = 1.0 / device->vk_info.device_limits.timestampPeriod;
+
+    /* Take the first sample right away so that the model is usable immediately. */
+    if (vkd3d_clock_calibration_sample(calibration, &sample))
+        vkd3d_clock_calibration_add_sample(calibration, &sample);
+
+    if ((rc = pthread_mutex_init(&calibration->mutex, NULL)))
+        return hresult_from_errno(rc);
+
+    if ((rc = condvar_reltime_init(&calibration->cond)))
+    {
+        pthread_mutex_destroy(&calibration->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    if ((rc = pthread_create(&calibration->thread, NULL, vkd3d_clock_calibration_main, calibration)))
+    {
+        condvar_reltime_destroy(&calibration->cond);
+        pthread_mutex_destroy(&calibration->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    calibration->thread_active = true;
+    return S_OK;
+}
+
+void vkd3d_clock_calibration_cleanup(struct vkd3d_clock_calibration *calibration)
+{
+    if (!calibration->thread_active)
+        return;
+
+    pthread_mutex_lock(&calibration->mutex);
+    calibration->should_exit = true;
+    condvar_reltime_signal(&calibration->cond);
+    pthread_mutex_unlock(&calibration->mutex);
+
+    pthread_join(calibration->thread, NULL);
+
+    condvar_reltime_destroy(&calibration->cond);
+    pthread_mutex_destroy(&calibration->mutex);
+}
+
+bool vkd3d_clock_calibration_get_gpu_ticks(struct vkd3d_clock_calibration *calibration,
+        uint64_t host_ns, uint64_t *gpu_ticks)
+{
+    bool valid;
+
+    spinlock_acquire(&calibration->model_lock);
+    if ((valid = calibration->valid))
+    {
+        *gpu_ticks = calibration->anchor.gpu_ticks + (int64_t)((double)(int64_t)
+                (host_ns - calibration->anchor.host_ns) * calibration->ticks_per_ns);
+    }
+    spinlock_release(&calibration->model_lock);
+    return valid;
+}
+
+bool vkd3d_clock_calibration_get_host_ns(struct vkd3d_clock_calibration *calibration,
+        uint64_t gpu_ticks, uint64_t *host_ns)
+{
+    bool valid;
+
+    spinlock_acquire(&calibration->model_lock);
+    if ((valid = calibration->valid))
+    {
+        *host_ns = calibration->anchor.host_ns + (int64_t)((double)(int64_t)
+                (gpu_ticks - calibration->anchor.gpu_ticks) / calibration->ticks_per_ns);
+    }
+    spinlock_release(&calibration->model_lock);
+    return valid;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_MakeResident(d3d12_device_iface *iface,
+        UINT object_count, ID3D12Pageable * const *objects)
+{
+    struct d3d12_device *device = impl_from_ID3D12Device(iface);
+    struct vkd3d_residency_object object;
+    uint32_t i;
+
+    TRACE("iface %p, object_count %u, objects %p\n",
+            iface, object_count, objects);
+
+    if (device->device_info.pageable_device_memory_features.pageableDeviceLocalMemory)
+    {
+        for (i = 0; i < object_count; i++)
+        {
+            if (d3d12_device_get_residency_object(objects[i], &object))
             {
-                VK_CALL(vkSetDeviceMemoryPriorityEXT(device->vk_device, memory, vkd3d_convert_to_vk_prio(priority)));
+                d3d12_device_make_object_resident(device, &object);
+                vkd3d_residency_object_release(&object);
             }
         }
     }
@@ -5240,16 +6388,45 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_EnqueueMakeResident(d3d12_device_i
         D3D12_RESIDENCY_FLAGS flags, UINT num_objects, ID3D12Pageable *const *objects,
         ID3D12Fence *fence_to_signal, UINT64 fence_value_to_signal)
 {
+    struct d3d12_device *device = impl_from_ID3D12Device(iface);
+    struct vkd3d_residency_object *residency_objects = NULL;
+    size_t residency_object_count = 0;
+    size_t i;
+
     TRACE("iface %p, flags %#x, num_objects %u, objects %p, fence_to_signal %p, fence_value_to_signal %"PRIu64"\n",
             iface, flags, num_objects, objects, fence_to_signal, fence_value_to_signal);
 
-    /* note: we ignore flags/D3D12_RESIDENCY_FLAG_DENY_OVERBUDGET; it involves
-       knowing if the app will be made over-budget.  We act as if it won't.  Could perhaps
-       use VK_EXT_memory_budget but don't have an app in-hand that clearly cares. */
-    d3d12_device_MakeResident(iface, num_objects, objects);
+    if (num_objects && device->device_info.pageable_device_memory_features.pageableDeviceLocalMemory)
+    {
+        if (!(residency_objects = vkd3d_malloc(num_objects * sizeof(*residency_objects))))
+            return E_OUTOFMEMORY;
+
+        for (i = 0; i < num_objects; i++)
+        {
+            if (d3d12_device_get_residency_object(objects[i], &residency_objects[residency_object_count]))
+                residency_object_count++;
+        }
+    }
+
+    if ((flags & D3D12_RESIDENCY_FLAG_DENY_OVERBUDGET) &&
+            !d3d12_device_residency_fits_budget(device, residency_objects, residency_object_count))
+    {
+        for (i = 0; i < residency_object_count; i++)
+            vkd3d_residency_object_release(&residency_objects[i]);
+        vkd3d_free(residency_objects);
+        return E_OUTOFMEMORY;
+    }
+
+    /* Nothing to page in, no need to involve the residency thread. */
+    if (!residency_object_count)
+    {
+        vkd3d_free(residency_objects);
+        return ID3D12Fence_Signal(fence_to_signal, fence_value_to_signal);
+    }
 
-    /* we don't block anyway - signal the fence immediately */
-    return ID3D12Fence_Signal(fence_to_signal, fence_value_to_signal);
+    /* The residency manager takes ownership of the objects. */
+    return vkd3d_residency_manager_enqueue(&device->residency_manager,
+            residency_objects, residency_object_count, fence_to_signal, fence_value_to_signal);
 }
 
 static HRESULT STDMETHODCALLTYPE d3d12_device_Evict(d3d12_device_iface *iface,
@@ -5469,23 +6646,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_CreatePipelineLibrary(d3d12_device
     TRACE("iface %p, blob %p, blob_size %lu, iid %s, lib %p.\n",
             iface, blob, blob_size, debugstr_guid(iid), lib);
 
-    flags = 0;
-
-    /* If we use a disk cache, it is somewhat meaningless to use application pipeline libraries
-     * to store SPIR-V / blob.
-     * We only need to store metadata so we can implement the API correctly w.r.t. return values, and
-     * PSO reload. */
-    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_NO_SERIALIZE_SPIRV) &&
-            !device->disk_cache.library)
-        flags |= VKD3D_PIPELINE_LIBRARY_FLAG_SAVE_FULL_SPIRV;
-
-    /* If we're using global pipeline caches, these are irrelevant.
-     * Do not use pipeline library blobs at all. */
-    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_GLOBAL_PIPELINE_CACHE))
-    {
-        flags |= VKD3D_PIPELINE_LIBRARY_FLAG_SAVE_PSO_BLOB |
-                VKD3D_PIPELINE_LIBRARY_FLAG_USE_PIPELINE_CACHE_UUID;
-    }
+    flags = vkd3d_pipeline_library_get_application_flags(device);
 
     if (FAILED(hr = d3d12_pipeline_library_create(device, blob, blob_size,
             flags, &pipeline_library)))
@@ -5625,6 +6786,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_SetResidencyPriority(d3d12_device_
                 {
                     spinlock_acquire(&heap_object->priority.spinlock);
                     heap_object->priority.d3d12priority = priority;
+                    heap_object->priority.demoted = false;
                     if (heap_object->priority.residency_count)
                     {
                         memory = heap_object->allocation.device_allocation.vk_memory;
@@ -5642,6 +6804,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_SetResidencyPriority(d3d12_device_
                 {
                     spinlock_acquire(&resource_object->priority.spinlock);
                     resource_object->priority.d3d12priority = priority;
+                    resource_object->priority.demoted = false;
                     if (resource_object->priority.residency_count)
                     {
                         memory = resource_object->mem.device_allocation.vk_memory;
@@ -6000,7 +7163,7 @@ static void STDMETHODCALLTYPE d3d12_device_GetRaytracingAccelerationStructurePre
         return;
     }
 
-    if (!vkd3d_acceleration_structure_convert_inputs(device, &build_info, desc))
+    if (!vkd3d_acceleration_structure_convert_inputs(device, &build_info, desc, NULL))
     {
         ERR("Failed to convert inputs.\n");
         memset(info, 0, sizeof(*info));
@@ -6206,6 +7369,33 @@ static void STDMETHODCALLTYPE d3d12_device_CreateSamplerFeedbackUnorderedAccessV
             iface, target_resource, feedback_resource, descriptor.ptr);
 }
 
+struct d3d12_mip_footprint
+{
+    unsigned int width, height, depth;
+    unsigned int row_count, row_size, row_pitch;
+    uint64_t size;
+};
+
+static void d3d12_mip_footprint_init(struct d3d12_mip_footprint *mip, const D3D12_RESOURCE_DESC1 *desc,
+        const struct vkd3d_format_footprint *plane_footprint, unsigned int num_planes, unsigned int miplevel_idx)
+{
+    uint64_t size;
+
+    mip->width = align(d3d12_resource_desc_get_width(desc, miplevel_idx), plane_footprint->block_width);
+    mip->height = align(d3d12_resource_desc_get_height(desc, miplevel_idx), plane_footprint->block_height);
+    mip->depth = d3d12_resource_desc_get_depth(desc, miplevel_idx);
+    mip->row_count = mip->height / plane_footprint->block_height;
+    mip->row_size = (mip->width / plane_footprint->block_width) * plane_footprint->block_byte_count;
+
+    /* For whatever reason, we need to use 512 bytes of alignment for depth-stencil formats.
+     * This is not documented, but it is observed behavior on both NV and WARP drivers.
+     * See test_get_copyable_footprints_planar(). */
+    mip->row_pitch = align(mip->row_size, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * num_planes);
+
+    size = max(0, mip->row_count - 1) * mip->row_pitch + mip->row_size;
+    mip->size = max(0, mip->depth - 1) * align(size, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * num_planes) + size;
+}
+
 static void STDMETHODCALLTYPE d3d12_device_GetCopyableFootprints1(d3d12_device_iface *iface,
         const D3D12_RESOURCE_DESC1 *desc, UINT first_sub_resource, UINT sub_resource_count,
         UINT64 base_offset, D3D12_PLACED_SUBRESOURCE_FOOTPRINT *layouts, UINT *row_counts,
@@ -6215,12 +7405,15 @@ static void STDMETHODCALLTYPE d3d12_device_GetCopyableFootprints1(d3d12_device_i
     static const struct vkd3d_format vkd3d_format_unknown
             = {DXGI_FORMAT_UNKNOWN, VK_FORMAT_UNDEFINED, 1, 1, 1, 1, 0, 1};
 
-    unsigned int i, sub_resource_idx, miplevel_idx, row_count, row_size, row_pitch;
-    unsigned int width, height, depth, num_planes, num_subresources;
-    unsigned int num_subresources_per_plane, plane_idx;
+    unsigned int i, sub_resource_idx, miplevel_idx, num_planes, num_subresources;
+    unsigned int num_subresources_per_plane, plane_idx, cached_plane_idx;
+    struct d3d12_mip_footprint mips[D3D12_REQ_MIP_LEVELS];
     struct vkd3d_format_footprint plane_footprint;
+    const struct d3d12_mip_footprint *mip;
+    struct d3d12_mip_footprint mip_scratch;
     const struct vkd3d_format *format;
-    uint64_t offset, size, total;
+    uint64_t offset, total;
+    uint32_t mip_mask;
 
     TRACE("iface %p, desc %p, first_sub_resource %u, sub_resource_count %u, base_offset %#"PRIx64", "
             "layouts %p, row_counts %p, row_sizes %p, total_bytes %p.\n",
@@ -6263,6 +7456,10 @@ static void STDMETHODCALLTYPE d3d12_device_GetCopyableFootprints1(d3d12_device_i
         goto end;
     }
 
+    /* Every array layer of a plane has the same mip chain, so only compute each level once. */
+    cached_plane_idx = ~0u;
+    mip_mask = 0;
+
     offset = 0;
     total = 0;
     for (i = 0; i < sub_resource_count; ++i)
@@ -6270,38 +7467,46 @@ static void STDMETHODCALLTYPE d3d12_device_GetCopyableFootprints1(d3d12_device_i
         sub_resource_idx = first_sub_resource + i;
         plane_idx = sub_resource_idx / num_subresources_per_plane;
 
-        plane_footprint = vkd3d_format_footprint_for_plane(format, plane_idx);
+        if (plane_idx != cached_plane_idx)
+        {
+            plane_footprint = vkd3d_format_footprint_for_plane(format, plane_idx);
+            cached_plane_idx = plane_idx;
+            mip_mask = 0;
+        }
 
         miplevel_idx = sub_resource_idx % desc->MipLevels;
-        width = align(d3d12_resource_desc_get_width(desc, miplevel_idx), plane_footprint.block_width);
-        height = align(d3d12_resource_desc_get_height(desc, miplevel_idx), plane_footprint.block_height);
-        depth = d3d12_resource_desc_get_depth(desc, miplevel_idx);
-        row_count = height / plane_footprint.block_height;
-        row_size = (width / plane_footprint.block_width) * plane_footprint.block_byte_count;
 
-        /* For whatever reason, we need to use 512 bytes of alignment for depth-stencil formats.
-         * This is not documented, but it is observed behavior on both NV and WARP drivers.
-         * See test_get_copyable_footprints_planar(). */
-        row_pitch = align(row_size, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * num_planes);
+        if (miplevel_idx < ARRAY_SIZE(mips))
+        {
+            if (!(mip_mask & (1u << miplevel_idx)))
+            {
+                d3d12_mip_footprint_init(&mips[miplevel_idx], desc, &plane_footprint, num_planes, miplevel_idx);
+                mip_mask |= 1u << miplevel_idx;
+            }
+
+            mip = &mips[miplevel_idx];
+        }
+        else
+        {
+            d3d12_mip_footprint_init(&mip_scratch, desc, &plane_footprint, num_planes, miplevel_idx);
+            mip = &mip_scratch;
+        }
 
         if (layouts)
         {
             layouts[i].Offset = base_offset + offset;
             layouts[i].Footprint.Format = plane_footprint.dxgi_format;
-            layouts[i].Footprint.Width = width;
-            layouts[i].Footprint.Height = height;
-            layouts[i].Footprint.Depth = depth;
-            layouts[i].Footprint.RowPitch = row_pitch;
+            layouts[i].Footprint.Width = mip->width;
+            layouts[i].Footprint.Height = mip->height;
+            layouts[i].Footprint.Depth = mip->depth;
+            layouts[i].Footprint.RowPitch = mip->row_pitch;
         }
         if (row_counts)
-            row_counts[i] = row_count;
+            row_counts[i] = mip->row_count;
         if (row_sizes)
-            row_sizes[i] = row_size;
+            row_sizes[i] = mip->row_size;
 
-        size = max(0, row_count - 1) * row_pitch + row_size;
-        size = max(0, depth - 1) * align(size, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * num_planes) + size;
-
-        total = offset + size;
+        total = offset + mip->size;
         offset = align(total, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
     }
 
@@ -6409,7 +7614,7 @@ CONST_VTBL struct ID3D12Device10Vtbl d3d12_device_vtbl_##name = \
     d3d12_device_CreateRenderTargetView, \
     d3d12_device_CreateDepthStencilView, \
     d3d12_device_CreateSampler_##create_desc, \
-    d3d12_device_CopyDescriptors, \
+    d3d12_device_CopyDescriptors_##copy_desc_variant, \
     d3d12_device_CopyDescriptorsSimple_##copy_desc_variant, \
     d3d12_device_GetResourceAllocationInfo, \
     d3d12_device_GetCustomHeapProperties, \
@@ -6483,9 +7688,8 @@ VKD3D_DECLARE_D3D12_DEVICE_VARIANT(embedded_32_16_planar, embedded, embedded_32_
 VKD3D_DECLARE_D3D12_DEVICE_VARIANT(embedded_generic, embedded, embedded_generic);
 VKD3D_DECLARE_D3D12_DEVICE_VARIANT(descriptor_buffer_16_16_4, default, descriptor_buffer_16_16_4);
 
-#ifdef VKD3D_ENABLE_PROFILING
 #include "device_profiled.h"
-#endif
+#include "device_captured.h"
 
 static D3D12_TILED_RESOURCES_TIER d3d12_device_determine_tiled_resources_tier(struct d3d12_device *device)
 {
@@ -7381,19 +8585,21 @@ static void d3d12_device_replace_vtable(struct d3d12_device *device)
     if (vkd3d_descriptor_debug_active_qa_checks())
         return;
 
-#ifdef VKD3D_ENABLE_PROFILING
     /* For now, we don't do vtable variant shenanigans for profiled devices.
      * This can be fixed, but it's not that important at this time. */
     if (vkd3d_uses_profiling())
         return;
-#endif
+
+    /* Captures are meant to be replayed, not to measure descriptor throughput. */
+    if (vkd3d_uses_capture())
+        return;
 
     /* Add special optimized paths that are tailored for known configurations.
      * If we don't find any, fall back to the generic path
      * (which is still very fast, but every nanosecond counts in these functions). */
 
-    /* Don't bother modifying CopyDescriptors path, its main overhead is chasing other pointers anyway,
-     * and that code path handles embedded mutable descriptors. */
+    /* Each variant also provides a CopyDescriptors which splits the ranges into
+     * contiguous runs and feeds them to the matching CopyDescriptorsSimple kernel. */
 
     if (d3d12_device_use_embedded_mutable_descriptors(device))
     {
@@ -7429,24 +8635,113 @@ static void d3d12_device_replace_vtable(struct d3d12_device *device)
     }
 }
 
-extern CONST_VTBL struct ID3D12DeviceExtVtbl d3d12_device_vkd3d_ext_vtbl;
-extern CONST_VTBL struct ID3D12DXVKInteropDeviceVtbl d3d12_dxvk_interop_device_vtbl;
+extern CONST_VTBL struct ID3D12DeviceExt2Vtbl d3d12_device_vkd3d_ext_vtbl;
+extern CONST_VTBL struct ID3D12DXVKInteropDevice1Vtbl d3d12_dxvk_interop_device_vtbl;
+extern CONST_VTBL struct ID3DLowLatencyDeviceVtbl d3d_low_latency_device_vtbl;
+
+/* Meta ops only depend on the Vulkan device, the global descriptor buffer and the sampler map,
+ * and spend most of their time creating Vulkan objects, so they are initialized on a worker thread
+ * while the rest of the device is set up. */
+struct d3d12_device_meta_ops_init_job
+{
+    struct d3d12_device *device;
+    pthread_t thread;
+    bool has_thread;
+    bool pending;
+    HRESULT hr;
+    uint64_t duration_ns;
+};
+
+static void *d3d12_device_meta_ops_init_main(void *userdata)
+{
+    struct d3d12_device_meta_ops_init_job *job = userdata;
+    uint64_t start_ns;
+
+    vkd3d_set_thread_name("vkd3d_meta_init");
+
+    start_ns = vkd3d_get_current_time_ns();
+    job->hr = vkd3d_meta_ops_init(&job->device->meta_ops, job->device);
+    job->duration_ns = vkd3d_get_current_time_ns() - start_ns;
+    return NULL;
+}
+
+static void d3d12_device_begin_meta_ops_init(struct d3d12_device_meta_ops_init_job *job,
+        struct d3d12_device *device)
+{
+    job->device = device;
+    job->pending = true;
+
+    if (!(job->has_thread = !pthread_create(&job->thread, NULL, d3d12_device_meta_ops_init_main, job)))
+    {
+        WARN("Failed to create meta ops init thread, initializing inline.\n");
+        d3d12_device_meta_ops_init_main(job);
+    }
+}
+
+static HRESULT d3d12_device_end_meta_ops_init(struct d3d12_device_meta_ops_init_job *job)
+{
+    if (job->has_thread)
+        pthread_join(job->thread, NULL);
+
+    job->has_thread = false;
+    job->pending = false;
+    return job->hr;
+}
+
+static HRESULT d3d12_device_init_job_pool(struct d3d12_device *device)
+{
+    uint32_t thread_count, copy_thread_count = 0;
+    char env[16];
+    int rc;
+
+    thread_count = vkd3d_job_pool_get_default_thread_count();
+    /* With thread_priority, background work yields to the latency critical threads. */
+    if ((rc = vkd3d_job_pool_init(&device->job_pool, thread_count, "vkd3d-worker",
+            (vkd3d_config_flags & VKD3D_CONFIG_FLAG_THREAD_PRIORITY) ?
+            VKD3D_THREAD_PRIORITY_LOW : VKD3D_THREAD_PRIORITY_NORMAL)))
+    {
+        ERR("Failed to initialize worker pool, rc %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
+
+    if (vkd3d_get_env_var("VKD3D_SUBRESOURCE_COPY_THREADS", env, sizeof(env)))
+        copy_thread_count = strtoul(env, NULL, 0);
+
+    if (copy_thread_count > 1)
+    {
+        device->subresource_copy_thread_count = min(copy_thread_count, device->job_pool.thread_count + 1);
+        INFO("Splitting large subresource copies across %u threads.\n", device->subresource_copy_thread_count);
+    }
+
+    TRACE("Running background work on %u worker threads.\n", device->job_pool.thread_count);
+    return S_OK;
+}
+
+static void d3d12_device_init_stage_done(uint64_t *stage_time_ns, const char *stage)
+{
+    uint64_t now_ns = vkd3d_get_current_time_ns();
+
+    TRACE("Device init stage %s: %.3f ms.\n", stage, 1e-6 * (double)(now_ns - *stage_time_ns));
+    *stage_time_ns = now_ns;
+}
 
 static HRESULT d3d12_device_init(struct d3d12_device *device,
         struct vkd3d_instance *instance, const struct vkd3d_device_create_info *create_info)
 {
+    struct d3d12_device_meta_ops_init_job meta_ops_job;
     const struct vkd3d_vk_device_procs *vk_procs;
+    uint64_t start_time_ns, stage_time_ns;
     HRESULT hr;
     int rc;
 
-#ifdef VKD3D_ENABLE_PROFILING
-    if (vkd3d_uses_profiling())
+    start_time_ns = stage_time_ns = vkd3d_get_current_time_ns();
+
+    if (vkd3d_uses_capture())
+        device->ID3D12Device_iface.lpVtbl = &d3d12_device_vtbl_captured;
+    else if (vkd3d_uses_profiling())
         device->ID3D12Device_iface.lpVtbl = &d3d12_device_vtbl_profiled;
     else
         device->ID3D12Device_iface.lpVtbl = &d3d12_device_vtbl_default;
-#else
-    device->ID3D12Device_iface.lpVtbl = &d3d12_device_vtbl_default;
-#endif
 
     device->refcount = 1;
 
@@ -7476,6 +8771,7 @@ static HRESULT d3d12_device_init(struct d3d12_device *device,
 
     device->ID3D12DeviceExt_iface.lpVtbl = &d3d12_device_vkd3d_ext_vtbl;
     device->ID3D12DXVKInteropDevice_iface.lpVtbl = &d3d12_dxvk_interop_device_vtbl;
+    device->ID3DLowLatencyDevice_iface.lpVtbl = &d3d_low_latency_device_vtbl;
 
     if ((rc = rwlock_init(&device->vertex_input_lock)))
     {
@@ -7492,36 +8788,98 @@ static HRESULT d3d12_device_init(struct d3d12_device *device,
     if (FAILED(hr = vkd3d_create_vk_device(device, create_info)))
         goto out_free_fragment_output_lock;
 
+    d3d12_device_init_stage_done(&stage_time_ns, "Vulkan device");
+
     if (FAILED(hr = vkd3d_private_store_init(&device->private_store)))
         goto out_free_vk_resources;
 
-    if (FAILED(hr = vkd3d_memory_transfer_queue_init(&device->memory_transfers, device)))
+    vkd3d_memory_footprint_init(&device->memory_footprint);
+    vkd3d_command_list_stats_report_init(&device->command_list_stats);
+
+    /* Memory allocation reports to the residency manager, so it must exist before any allocation happens. */
+    if (FAILED(hr = vkd3d_residency_manager_init(&device->residency_manager, device)))
         goto out_free_private_store;
 
+    if (FAILED(hr = vkd3d_clock_calibration_init(&device->clock_calibration, device)))
+        goto out_cleanup_residency_manager;
+
+    if (FAILED(hr = vkd3d_memory_transfer_queue_init(&device->memory_transfers, device)))
+        goto out_cleanup_clock_calibration;
+
     if (FAILED(hr = vkd3d_memory_allocator_init(&device->memory_allocator, device)))
         goto out_free_memory_transfers;
 
-    if (FAILED(hr = vkd3d_init_format_info(device)))
+    if (FAILED(hr = vkd3d_resource_recycle_pool_init(&device->resource_recycle_pool)))
         goto out_free_memory_allocator;
 
+    if (FAILED(hr = vkd3d_resource_destroy_queue_init(&device->resource_destroy_queue, device)))
+        goto out_cleanup_resource_recycle_pool;
+
+    if (FAILED(hr = vkd3d_memory_bind_queue_init(&device->memory_binds)))
+        goto out_cleanup_resource_destroy_queue;
+
+    if (FAILED(hr = vkd3d_init_format_info(device)))
+        goto out_cleanup_memory_binds;
+
     if (FAILED(hr = vkd3d_memory_info_init(&device->memory_info, device)))
         goto out_cleanup_format_info;
 
     if (FAILED(hr = vkd3d_global_descriptor_buffer_init(&device->global_descriptor_buffer, device)))
         goto out_cleanup_memory_info;
 
-    if (FAILED(hr = vkd3d_bindless_state_init(&device->bindless_state, device)))
+    if (FAILED(hr = vkd3d_view_map_init(&device->sampler_map)))
         goto out_cleanup_global_descriptor_buffer;
 
-    if (FAILED(hr = vkd3d_view_map_init(&device->sampler_map)))
+    /* Meta ops prewarm their pipelines on the pool. */
+    if (FAILED(hr = d3d12_device_init_job_pool(device)))
+        goto out_destroy_sampler_map;
+
+    d3d12_device_init_stage_done(&stage_time_ns, "memory and formats");
+
+    d3d12_device_begin_meta_ops_init(&meta_ops_job, device);
+
+    if (FAILED(hr = vkd3d_bindless_state_init(&device->bindless_state, device)))
+        goto out_join_meta_ops;
+
+    d3d12_device_init_stage_done(&stage_time_ns, "bindless state");
+
+    if (FAILED(hr = vkd3d_sampler_payload_cache_init(&device->sampler_payload_cache, device)))
         goto out_cleanup_bindless_state;
 
     if (FAILED(hr = vkd3d_sampler_state_init(&device->sampler_state, device)))
-        goto out_cleanup_view_map;
+        goto out_cleanup_sampler_payload_cache;
 
-    if (FAILED(hr = vkd3d_meta_ops_init(&device->meta_ops, device)))
+    if (FAILED(hr = vkd3d_root_signature_cache_init(&device->root_signature_cache)))
         goto out_cleanup_sampler_state;
 
+    if (FAILED(hr = vkd3d_pipeline_blob_store_init(&device->pipeline_blob_store)))
+        goto out_cleanup_root_signature_cache;
+
+    if (FAILED(hr = vkd3d_pipeline_telemetry_init(&device->pipeline_telemetry)))
+        goto out_cleanup_pipeline_blob_store;
+
+    vkd3d_meta_timing_init(&device->meta_timing, device);
+
+    if (FAILED(hr = vkd3d_shader_hash_cache_init(&device->shader_hash_cache)))
+        goto out_cleanup_pipeline_telemetry;
+
+    if (FAILED(hr = vkd3d_image_allocation_info_cache_init(&device->image_allocation_info_cache)))
+        goto out_cleanup_shader_hash_cache;
+
+    if (FAILED(hr = vkd3d_image_create_info_cache_init(&device->image_create_info_cache)))
+        goto out_cleanup_image_allocation_info_cache;
+
+    if (FAILED(hr = vkd3d_low_latency_state_init(&device->low_latency, device)))
+        goto out_cleanup_image_create_info_cache;
+
+    d3d12_device_init_stage_done(&stage_time_ns, "samplers and caches");
+
+    if (FAILED(hr = d3d12_device_end_meta_ops_init(&meta_ops_job)))
+        goto out_cleanup_low_latency;
+
+    TRACE("Meta ops took %.3f ms on a worker thread.\n", 1e-6 * (double)meta_ops_job.duration_ns);
+    d3d12_device_init_stage_done(&stage_time_ns, "waiting for meta ops");
+
     if (FAILED(hr = vkd3d_shader_debug_ring_init(&device->debug_ring, device)))
         goto out_cleanup_meta_ops;
 
@@ -7556,9 +8914,20 @@ static HRESULT d3d12_device_init(struct d3d12_device *device,
     vkd3d_init_shader_extensions(device);
     vkd3d_compute_shader_interface_key(device);
 
+    if (FAILED(hr = vkd3d_shader_spirv_cache_init(&device->spirv_cache)))
+        goto out_cleanup_descriptor_qa_global_info;
+
+    if (FAILED(hr = vkd3d_shared_fence_worker_init(&device->shared_fence_worker, device)))
+        goto out_cleanup_spirv_cache;
+
+    d3d12_device_init_stage_done(&stage_time_ns, "debug, caps and workers");
+
     /* Make sure all extensions and shader interface keys are computed. */
     if (FAILED(hr = vkd3d_pipeline_library_init_disk_cache(&device->disk_cache, device)))
-        goto out_cleanup_descriptor_qa_global_info;
+        goto out_cleanup_shared_fence_worker;
+
+    d3d12_device_init_stage_done(&stage_time_ns, "disk cache");
+    TRACE("Device init took %.3f ms.\n", 1e-6 * (double)(stage_time_ns - start_time_ns));
 
     d3d12_device_replace_vtable(device);
 
@@ -7569,6 +8938,10 @@ static HRESULT d3d12_device_init(struct d3d12_device *device,
 
     return S_OK;
 
+out_cleanup_shared_fence_worker:
+    vkd3d_shared_fence_worker_cleanup(&device->shared_fence_worker);
+out_cleanup_spirv_cache:
+    vkd3d_shader_spirv_cache_cleanup(&device->spirv_cache);
 out_cleanup_descriptor_qa_global_info:
     vkd3d_descriptor_debug_free_global_info(device->descriptor_qa_global_info, device);
 out_cleanup_breadcrumb_tracer:
@@ -7580,22 +8953,54 @@ out_cleanup_debug_ring:
     vkd3d_shader_debug_ring_cleanup(&device->debug_ring, device);
 out_cleanup_meta_ops:
     vkd3d_meta_ops_cleanup(&device->meta_ops, device);
+out_cleanup_low_latency:
+    vkd3d_low_latency_state_cleanup(&device->low_latency, device);
+out_cleanup_image_create_info_cache:
+    vkd3d_image_create_info_cache_cleanup(&device->image_create_info_cache);
+out_cleanup_image_allocation_info_cache:
+    vkd3d_image_allocation_info_cache_cleanup(&device->image_allocation_info_cache);
+out_cleanup_shader_hash_cache:
+    vkd3d_shader_hash_cache_cleanup(&device->shader_hash_cache);
+out_cleanup_pipeline_telemetry:
+    vkd3d_meta_timing_cleanup(&device->meta_timing, device);
+    vkd3d_pipeline_telemetry_cleanup(&device->pipeline_telemetry);
+out_cleanup_pipeline_blob_store:
+    vkd3d_pipeline_blob_store_cleanup(&device->pipeline_blob_store);
+out_cleanup_root_signature_cache:
+    vkd3d_root_signature_cache_cleanup(&device->root_signature_cache);
 out_cleanup_sampler_state:
     vkd3d_sampler_state_cleanup(&device->sampler_state, device);
-out_cleanup_view_map:
-    vkd3d_view_map_destroy(&device->sampler_map, device);
+out_cleanup_sampler_payload_cache:
+    vkd3d_sampler_payload_cache_cleanup(&device->sampler_payload_cache);
 out_cleanup_bindless_state:
     vkd3d_bindless_state_cleanup(&device->bindless_state, device);
+out_join_meta_ops:
+    /* Once joined, meta ops are cleaned up at out_cleanup_meta_ops instead. */
+    if (meta_ops_job.pending && SUCCEEDED(d3d12_device_end_meta_ops_init(&meta_ops_job)))
+        vkd3d_meta_ops_cleanup(&device->meta_ops, device);
+    vkd3d_job_pool_cleanup(&device->job_pool);
+out_destroy_sampler_map:
+    vkd3d_view_map_destroy(&device->sampler_map, device);
 out_cleanup_global_descriptor_buffer:
     vkd3d_global_descriptor_buffer_cleanup(&device->global_descriptor_buffer, device);
 out_cleanup_memory_info:
     vkd3d_memory_info_cleanup(&device->memory_info, device);
 out_cleanup_format_info:
     vkd3d_cleanup_format_info(device);
+out_cleanup_memory_binds:
+    vkd3d_memory_bind_queue_cleanup(&device->memory_binds, device);
+out_cleanup_resource_destroy_queue:
+    vkd3d_resource_destroy_queue_cleanup(&device->resource_destroy_queue);
+out_cleanup_resource_recycle_pool:
+    vkd3d_resource_recycle_pool_cleanup(&device->resource_recycle_pool, device);
 out_free_memory_allocator:
     vkd3d_memory_allocator_cleanup(&device->memory_allocator, device);
 out_free_memory_transfers:
     vkd3d_memory_transfer_queue_cleanup(&device->memory_transfers);
+out_cleanup_clock_calibration:
+    vkd3d_clock_calibration_cleanup(&device->clock_calibration);
+out_cleanup_residency_manager:
+    vkd3d_residency_manager_cleanup(&device->residency_manager);
 out_free_private_store:
     vkd3d_private_store_destroy(&device->private_store);
 out_free_vk_resources:
@@ -7787,10 +9192,68 @@ void d3d12_device_mark_as_removed(struct d3d12_device *device, HRESULT reason,
     device->removed_reason = reason;
 }
 
+static void vkd3d_pipeline_library_lookup_cache_count(uint32_t *counter)
+{
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
+        vkd3d_atomic_uint32_increment(counter, vkd3d_memory_order_relaxed);
+}
+
+static VkPipeline vkd3d_pipeline_library_lookup_cache_find(struct vkd3d_pipeline_library_lookup_cache *cache,
+        uint32_t hash, const void *desc, size_t desc_size)
+{
+    const struct vkd3d_pipeline_library_lookup_record *record;
+
+    /* Records are never freed or modified after publication, so an acquire load is all we need. */
+    record = vkd3d_atomic_ptr_load_explicit(&cache->slots[hash % VKD3D_PIPELINE_LIBRARY_LOOKUP_SLOT_COUNT],
+            vkd3d_memory_order_acquire);
+
+    if (record && record->hash == hash && !memcmp(record->desc, desc, desc_size))
+    {
+        vkd3d_pipeline_library_lookup_cache_count(&cache->fast_hit_count);
+        return record->vk_pipeline;
+    }
+
+    return VK_NULL_HANDLE;
+}
+
+static void vkd3d_pipeline_library_lookup_cache_publish(struct vkd3d_pipeline_library_lookup_cache *cache,
+        struct vkd3d_pipeline_library_lookup_record *record)
+{
+    /* Last writer wins on collisions. The displaced record is still owned by its map entry. */
+    if (record)
+    {
+        vkd3d_atomic_ptr_store_explicit(&cache->slots[record->hash % VKD3D_PIPELINE_LIBRARY_LOOKUP_SLOT_COUNT],
+                record, vkd3d_memory_order_release);
+    }
+}
+
+static struct vkd3d_pipeline_library_lookup_record *vkd3d_pipeline_library_lookup_record_create(
+        uint32_t hash, const void *desc, size_t desc_size, VkPipeline vk_pipeline)
+{
+    struct vkd3d_pipeline_library_lookup_record *record;
+
+    if (!vk_pipeline)
+        return NULL;
+
+    if (!(record = vkd3d_malloc(offsetof(struct vkd3d_pipeline_library_lookup_record, desc) + desc_size)))
+        return NULL;
+
+    record->vk_pipeline = vk_pipeline;
+    record->hash = hash;
+    memcpy(record->desc, desc, desc_size);
+    return record;
+}
+
 VkPipeline d3d12_device_get_or_create_vertex_input_pipeline(struct d3d12_device *device,
         const struct vkd3d_vertex_input_pipeline_desc *desc)
 {
+    struct vkd3d_pipeline_library_lookup_cache *lookup = &device->vertex_input_lookup;
     struct vkd3d_vertex_input_pipeline pipeline, *entry;
+    uint32_t hash;
+
+    hash = vkd3d_vertex_input_pipeline_desc_hash(desc);
+    if ((pipeline.vk_pipeline = vkd3d_pipeline_library_lookup_cache_find(lookup, hash, desc, sizeof(*desc))))
+        return pipeline.vk_pipeline;
 
     memset(&pipeline, 0, sizeof(pipeline));
 
@@ -7798,7 +9261,10 @@ VkPipeline d3d12_device_get_or_create_vertex_input_pipeline(struct d3d12_device
     entry = (void*)hash_map_find(&device->vertex_input_pipelines, desc);
 
     if (entry)
+    {
         pipeline.vk_pipeline = entry->vk_pipeline;
+        vkd3d_pipeline_library_lookup_cache_publish(lookup, entry->lookup_record);
+    }
 
     rwlock_unlock_read(&device->vertex_input_lock);
 
@@ -7810,11 +9276,19 @@ VkPipeline d3d12_device_get_or_create_vertex_input_pipeline(struct d3d12_device
         entry = (void*)hash_map_insert(&device->vertex_input_pipelines, desc, &pipeline.entry);
 
         if (!entry->vk_pipeline)
+        {
             entry->vk_pipeline = vkd3d_vertex_input_pipeline_create(device, desc);
+            entry->lookup_record = vkd3d_pipeline_library_lookup_record_create(hash,
+                    desc, sizeof(*desc), entry->vk_pipeline);
+            vkd3d_pipeline_library_lookup_cache_count(&lookup->miss_count);
+        }
 
+        vkd3d_pipeline_library_lookup_cache_publish(lookup, entry->lookup_record);
         pipeline.vk_pipeline = entry->vk_pipeline;
         rwlock_unlock_write(&device->vertex_input_lock);
     }
+    else
+        vkd3d_pipeline_library_lookup_cache_count(&lookup->hit_count);
 
     return pipeline.vk_pipeline;
 }
@@ -7822,7 +9296,13 @@ VkPipeline d3d12_device_get_or_create_vertex_input_pipeline(struct d3d12_device
 VkPipeline d3d12_device_get_or_create_fragment_output_pipeline(struct d3d12_device *device,
         const struct vkd3d_fragment_output_pipeline_desc *desc)
 {
+    struct vkd3d_pipeline_library_lookup_cache *lookup = &device->fragment_output_lookup;
     struct vkd3d_fragment_output_pipeline pipeline, *entry;
+    uint32_t hash;
+
+    hash = vkd3d_fragment_output_pipeline_desc_hash(desc);
+    if ((pipeline.vk_pipeline = vkd3d_pipeline_library_lookup_cache_find(lookup, hash, desc, sizeof(*desc))))
+        return pipeline.vk_pipeline;
 
     memset(&pipeline, 0, sizeof(pipeline));
 
@@ -7830,7 +9310,10 @@ VkPipeline d3d12_device_get_or_create_fragment_output_pipeline(struct d3d12_devi
     entry = (void*)hash_map_find(&device->fragment_output_pipelines, desc);
 
     if (entry)
+    {
         pipeline.vk_pipeline = entry->vk_pipeline;
+        vkd3d_pipeline_library_lookup_cache_publish(lookup, entry->lookup_record);
+    }
 
     rwlock_unlock_read(&device->fragment_output_lock);
 
@@ -7842,11 +9325,19 @@ VkPipeline d3d12_device_get_or_create_fragment_output_pipeline(struct d3d12_devi
         entry = (void*)hash_map_insert(&device->fragment_output_pipelines, desc, &pipeline.entry);
 
         if (!entry->vk_pipeline)
+        {
             entry->vk_pipeline = vkd3d_fragment_output_pipeline_create(device, desc);
+            entry->lookup_record = vkd3d_pipeline_library_lookup_record_create(hash,
+                    desc, sizeof(*desc), entry->vk_pipeline);
+            vkd3d_pipeline_library_lookup_cache_count(&lookup->miss_count);
+        }
 
+        vkd3d_pipeline_library_lookup_cache_publish(lookup, entry->lookup_record);
         pipeline.vk_pipeline = entry->vk_pipeline;
         rwlock_unlock_write(&device->fragment_output_lock);
     }
+    else
+        vkd3d_pipeline_library_lookup_cache_count(&lookup->hit_count);
 
     return pipeline.vk_pipeline;
 }
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __VKD3D_DEVICE_CAPTURED_H
+#define __VKD3D_DEVICE_CAPTURED_H
+
+/* Only record calls which vkd3d-proton-replay knows how to reissue.
+ * Calls are recorded after they succeed, so that a trace always replays cleanly. */
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_CreateGraphicsPipelineState_captured(d3d12_device_iface *iface,
+        const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, REFIID riid, void **pipeline_state)
+{
+    HRESULT hr;
+
+    if (SUCCEEDED(hr = d3d12_device_CreateGraphicsPipelineState(iface, desc, riid, pipeline_state)))
+        vkd3d_capture_graphics_pipeline(desc);
+    return hr;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_CreateComputePipelineState_captured(d3d12_device_iface *iface,
+        const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc, REFIID riid, void **pipeline_state)
+{
+    HRESULT hr;
+
+    if (SUCCEEDED(hr = d3d12_device_CreateComputePipelineState(iface, desc, riid, pipeline_state)))
+        vkd3d_capture_compute_pipeline(desc);
+    return hr;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_CreateRootSignature_captured(d3d12_device_iface *iface,
+        UINT node_mask, const void *bytecode, SIZE_T bytecode_length,
+        REFIID riid, void **root_signature)
+{
+    struct d3d12_device *device = impl_from_ID3D12Device(iface);
+    struct d3d12_root_signature *object;
+    HRESULT hr;
+
+    TRACE("iface %p, node_mask 0x%08x, bytecode %p, bytecode_length %lu, riid %s, root_signature %p.\n",
+            iface, node_mask, bytecode, bytecode_length, debugstr_guid(riid), root_signature);
+
+    debug_ignored_node_mask(node_mask);
+
+    /* Open-coded so that we can get at the object regardless of riid. */
+    if (FAILED(hr = d3d12_root_signature_create(device, bytecode, bytecode_length, &object)))
+        return hr;
+
+    vkd3d_capture_root_signature(object, node_mask, bytecode, bytecode_length);
+
+    return return_interface(&object->ID3D12RootSignature_iface,
+            &IID_ID3D12RootSignature, riid, root_signature);
+}
+
+CONST_VTBL struct ID3D12Device10Vtbl d3d12_device_vtbl =
+{
+    /* IUnknown methods */
+    d3d12_device_QueryInterface,
+    d3d12_device_AddRef,
+    d3d12_device_Release,
+    /* ID3D12Object methods */
+    d3d12_device_GetPrivateData,
+    d3d12_device_SetPrivateData,
+    d3d12_device_SetPrivateDataInterface,
+    (void *)d3d12_object_SetName,
+    /* ID3D12Device methods */
+    d3d12_device_GetNodeCount,
+    d3d12_device_CreateCommandQueue,
+    d3d12_device_CreateCommandAllocator,
+    d3d12_device_CreateGraphicsPipelineState_captured,
+    d3d12_device_CreateComputePipelineState_captured,
+    d3d12_device_CreateCommandList,
+    d3d12_device_CheckFeatureSupport,
+    d3d12_device_CreateDescriptorHeap,
+    d3d12_device_GetDescriptorHandleIncrementSize,
+    d3d12_device_CreateRootSignature_captured,
+    d3d12_device_CreateConstantBufferView_default,
+    d3d12_device_CreateShaderResourceView_default,
+    d3d12_device_CreateUnorderedAccessView_default,
+    d3d12_device_CreateRenderTargetView,
+    d3d12_device_CreateDepthStencilView,
+    d3d12_device_CreateSampler_default,
+    d3d12_device_CopyDescriptors_default,
+    d3d12_device_CopyDescriptorsSimple_default,
+    d3d12_device_GetResourceAllocationInfo,
+    d3d12_device_GetCustomHeapProperties,
+    d3d12_device_CreateCommittedResource,
+    d3d12_device_CreateHeap,
+    d3d12_device_CreatePlacedResource,
+    d3d12_device_CreateReservedResource,
+    d3d12_device_CreateSharedHandle,
+    d3d12_device_OpenSharedHandle,
+    d3d12_device_OpenSharedHandleByName,
+    d3d12_device_MakeResident,
+    d3d12_device_Evict,
+    d3d12_device_CreateFence,
+    d3d12_device_GetDeviceRemovedReason,
+    d3d12_device_GetCopyableFootprints,
+    d3d12_device_CreateQueryHeap,
+    d3d12_device_SetStablePowerState,
+    d3d12_device_CreateCommandSignature,
+    d3d12_device_GetResourceTiling,
+    d3d12_device_GetAdapterLuid,
+    /* ID3D12Device1 methods */
+    d3d12_device_CreatePipelineLibrary,
+    d3d12_device_SetEventOnMultipleFenceCompletion,
+    d3d12_device_SetResidencyPriority,
+    /* ID3D12Device2 methods */
+    d3d12_device_CreatePipelineState,
+    /* ID3D12Device3 methods */
+    d3d12_device_OpenExistingHeapFromAddress,
+    d3d12_device_OpenExistingHeapFromFileMapping,
+    d3d12_device_EnqueueMakeResident,
+    /* ID3D12Device4 methods */
+    d3d12_device_CreateCommandList1,
+    d3d12_device_CreateProtectedResourceSession,
+    d3d12_device_CreateCommittedResource1,
+    d3d12_device_CreateHeap1,
+    d3d12_device_CreateReservedResource1,
+    d3d12_device_GetResourceAllocationInfo1,
+    /* ID3D12Device5 methods */
+    d3d12_device_CreateLifetimeTracker,
+    d3d12_device_RemoveDevice,
+    d3d12_device_EnumerateMetaCommands,
+    d3d12_device_EnumerateMetaCommandParameters,
+    d3d12_device_CreateMetaCommand,
+    d3d12_device_CreateStateObject,
+    d3d12_device_GetRaytracingAccelerationStructurePrebuildInfo,
+    d3d12_device_CheckDriverMatchingIdentifier,
+    /* ID3D12Device6 methods */
+    d3d12_device_SetBackgroundProcessingMode,
+    /* ID3D12Device7 methods */
+    d3d12_device_AddToStateObject,
+    d3d12_device_CreateProtectedResourceSession1,
+    /* ID3D12Device8 methods */
+    d3d12_device_GetResourceAllocationInfo2,
+    d3d12_device_CreateCommittedResource2,
+    d3d12_device_CreatePlacedResource1,
+    d3d12_device_CreateSamplerFeedbackUnorderedAccessView,
+    d3d12_device_GetCopyableFootprints1,
+    /* ID3D12Device9 methods */
+    d3d12_device_CreateShaderCacheSession,
+    d3d12_device_ShaderCacheControl,
+    d3d12_device_CreateCommandQueue1,
+    /* ID3D12Device10 methods */
+    d3d12_device_CreateCommittedResource3,
+    d3d12_device_CreatePlacedResource2,
+    d3d12_device_CreateReservedResource2,
+};
+
+#endif
@@ -23,17 +23,17 @@
 
 #define DEVICE_PROFILED_CALL_HRESULT(name, ...) \
     HRESULT hr; \
-    VKD3D_REGION_DECL(name); \
-    VKD3D_REGION_BEGIN(name); \
+    VKD3D_API_REGION_DECL(name); \
+    VKD3D_API_REGION_BEGIN(name); \
     hr = d3d12_device_##name(__VA_ARGS__); \
-    VKD3D_REGION_END(name); \
+    VKD3D_API_REGION_END(name); \
     return hr
 
 #define DEVICE_PROFILED_CALL(name, ...) \
-    VKD3D_REGION_DECL(name); \
-    VKD3D_REGION_BEGIN(name); \
+    VKD3D_API_REGION_DECL(name); \
+    VKD3D_API_REGION_BEGIN(name); \
     d3d12_device_##name(__VA_ARGS__); \
-    VKD3D_REGION_END(name)
+    VKD3D_API_REGION_END(name)
 
 static HRESULT STDMETHODCALLTYPE d3d12_device_CreateGraphicsPipelineState_profiled(d3d12_device_iface *iface,
         const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc, REFIID riid, void **pipeline_state)
@@ -108,7 +108,7 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors_profiled(d3d12_device
         const UINT *src_descriptor_range_sizes,
         D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
 {
-    VKD3D_REGION_DECL(CopyDescriptors);
+    VKD3D_API_REGION_DECL(CopyDescriptors);
     unsigned int total_descriptors, total_descriptors_src, total_descriptors_dst, i;
 
     if (src_descriptor_range_sizes)
@@ -127,8 +127,8 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors_profiled(d3d12_device
     else
         total_descriptors_dst = dst_descriptor_range_count;
 
-    VKD3D_REGION_BEGIN(CopyDescriptors);
-    d3d12_device_CopyDescriptors(iface,
+    VKD3D_API_REGION_BEGIN(CopyDescriptors);
+    d3d12_device_CopyDescriptors_default(iface,
             dst_descriptor_range_count, dst_descriptor_range_offsets,
             dst_descriptor_range_sizes,
             src_descriptor_range_count, src_descriptor_range_offsets,
@@ -136,7 +136,7 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptors_profiled(d3d12_device
             descriptor_heap_type);
 
     total_descriptors = total_descriptors_src < total_descriptors_dst ? total_descriptors_src : total_descriptors_dst;
-    VKD3D_REGION_END_ITERATIONS(CopyDescriptors, total_descriptors);
+    VKD3D_API_REGION_END_ITERATIONS(CopyDescriptors, total_descriptors);
 }
 
 static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_profiled(d3d12_device_iface *iface,
@@ -144,11 +144,11 @@ static void STDMETHODCALLTYPE d3d12_device_CopyDescriptorsSimple_profiled(d3d12_
         const D3D12_CPU_DESCRIPTOR_HANDLE src_descriptor_range_offset,
         D3D12_DESCRIPTOR_HEAP_TYPE descriptor_heap_type)
 {
-    VKD3D_REGION_DECL(CopyDescriptorsSimple);
-    VKD3D_REGION_BEGIN(CopyDescriptorsSimple);
+    VKD3D_API_REGION_DECL(CopyDescriptorsSimple);
+    VKD3D_API_REGION_BEGIN(CopyDescriptorsSimple);
     d3d12_device_CopyDescriptorsSimple_default(iface, descriptor_count, dst_descriptor_range_offset,
             src_descriptor_range_offset, descriptor_heap_type);
-    VKD3D_REGION_END_ITERATIONS(CopyDescriptorsSimple, descriptor_count);
+    VKD3D_API_REGION_END_ITERATIONS(CopyDescriptorsSimple, descriptor_count);
 }
 
 static HRESULT STDMETHODCALLTYPE d3d12_device_CreateCommittedResource_profiled(d3d12_device_iface *iface,
@@ -20,18 +20,18 @@
 
 #include "vkd3d_private.h"
 
-static inline struct d3d12_device *d3d12_device_from_ID3D12DeviceExt(ID3D12DeviceExt *iface)
+static inline struct d3d12_device *d3d12_device_from_ID3D12DeviceExt(ID3D12DeviceExt2 *iface)
 {
     return CONTAINING_RECORD(iface, struct d3d12_device, ID3D12DeviceExt_iface);
 }
 
-ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_AddRef(ID3D12DeviceExt *iface)
+ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_AddRef(ID3D12DeviceExt2 *iface)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
     return d3d12_device_add_ref(device);
 }
 
-static ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_Release(ID3D12DeviceExt *iface)
+static ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_Release(ID3D12DeviceExt2 *iface)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
     return d3d12_device_release(device);
@@ -40,7 +40,7 @@ static ULONG STDMETHODCALLTYPE d3d12_device_vkd3d_ext_Release(ID3D12DeviceExt *i
 extern HRESULT STDMETHODCALLTYPE d3d12_device_QueryInterface(d3d12_device_iface *iface,
         REFIID riid, void **object);
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_QueryInterface(ID3D12DeviceExt *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_QueryInterface(ID3D12DeviceExt2 *iface,
         REFIID iid, void **out)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
@@ -48,7 +48,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_QueryInterface(ID3D12Dev
     return d3d12_device_QueryInterface(&device->ID3D12Device_iface, iid, out);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetVulkanHandles(ID3D12DeviceExt *iface, VkInstance *vk_instance, VkPhysicalDevice *vk_physical_device, VkDevice *vk_device)
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetVulkanHandles(ID3D12DeviceExt2 *iface, VkInstance *vk_instance, VkPhysicalDevice *vk_physical_device, VkDevice *vk_device)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
     TRACE("iface %p, vk_instance %p, vk_physical_device %p, vk_device %p \n", iface, vk_instance, vk_physical_device, vk_device);
@@ -61,7 +61,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetVulkanHandles(ID3D12D
     return S_OK;
 }
 
-static BOOL STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetExtensionSupport(ID3D12DeviceExt *iface, D3D12_VK_EXTENSION extension)
+static BOOL STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetExtensionSupport(ID3D12DeviceExt2 *iface, D3D12_VK_EXTENSION extension)
 {
     const struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
     bool ret_val = false;
@@ -82,7 +82,7 @@ static BOOL STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetExtensionSupport(ID3D12D
     return ret_val;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CreateCubinComputeShaderWithName(ID3D12DeviceExt *iface, const void *cubin_data,
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CreateCubinComputeShaderWithName(ID3D12DeviceExt2 *iface, const void *cubin_data,
        UINT32 cubin_size, UINT32 block_x, UINT32 block_y, UINT32 block_z, const char *shader_name, D3D12_CUBIN_DATA_HANDLE **out_handle)
 {
     VkCuFunctionCreateInfoNVX functionCreateInfo = { VK_STRUCTURE_TYPE_CU_FUNCTION_CREATE_INFO_NVX };
@@ -129,7 +129,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CreateCubinComputeShader
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_DestroyCubinComputeShader(ID3D12DeviceExt *iface, D3D12_CUBIN_DATA_HANDLE *handle)
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_DestroyCubinComputeShader(ID3D12DeviceExt2 *iface, D3D12_CUBIN_DATA_HANDLE *handle)
 {   
     const struct vkd3d_vk_device_procs *vk_procs;
     struct d3d12_device *device;
@@ -149,11 +149,57 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_DestroyCubinComputeShade
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetCudaTextureObject(ID3D12DeviceExt *iface, D3D12_CPU_DESCRIPTOR_HANDLE srv_handle,
-       D3D12_CPU_DESCRIPTOR_HANDLE sampler_handle, UINT32 *cuda_texture_handle)
+static uint32_t d3d12_device_get_cuda_view_handle(struct d3d12_device *device,
+        const struct vkd3d_view *view, const struct vkd3d_view *sampler, VkDescriptorType vk_descriptor_type)
 {
+    struct vkd3d_cuda_handle_cache *cache = &device->cuda_handle_cache;
     VkImageViewHandleInfoNVX imageViewHandleInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_HANDLE_INFO_NVX };
-    const struct vkd3d_vk_device_procs *vk_procs;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_cuda_handle_cache_entry *entry;
+    uint64_t sampler_cookie;
+    bool hit = false;
+    uint32_t handle = 0;
+
+    /* The entry is unlocked with zero-initialized device memory. */
+    sampler_cookie = sampler ? sampler->cookie : 0;
+    entry = &cache->entries[hash_combine(hash_uint64(view->cookie), hash_uint64(sampler_cookie))
+            % VKD3D_CUDA_HANDLE_CACHE_SIZE];
+
+    if (spinlock_try_acquire(&entry->lock))
+    {
+        if ((hit = entry->valid && entry->view_cookie == view->cookie &&
+                entry->sampler_cookie == sampler_cookie && entry->vk_descriptor_type == vk_descriptor_type))
+            handle = entry->handle;
+        spinlock_release(&entry->lock);
+    }
+
+    vkd3d_atomic_uint64_increment(hit ? &cache->hit_count : &cache->miss_count, vkd3d_memory_order_relaxed);
+
+    if (hit)
+        return handle;
+
+    imageViewHandleInfo.imageView = view->vk_image_view;
+    imageViewHandleInfo.sampler = sampler ? sampler->vk_sampler : VK_NULL_HANDLE;
+    imageViewHandleInfo.descriptorType = vk_descriptor_type;
+    handle = VK_CALL(vkGetImageViewHandleNVX(device->vk_device, &imageViewHandleInfo));
+
+    /* If another thread holds the slot, it is likely filling it in, just drop ours. */
+    if (spinlock_try_acquire(&entry->lock))
+    {
+        entry->view_cookie = view->cookie;
+        entry->sampler_cookie = sampler_cookie;
+        entry->vk_descriptor_type = vk_descriptor_type;
+        entry->handle = handle;
+        entry->valid = true;
+        spinlock_release(&entry->lock);
+    }
+
+    return handle;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetCudaTextureObject(ID3D12DeviceExt2 *iface, D3D12_CPU_DESCRIPTOR_HANDLE srv_handle,
+       D3D12_CPU_DESCRIPTOR_HANDLE sampler_handle, UINT32 *cuda_texture_handle)
+{
     struct d3d12_desc_split sampler_desc;
     struct d3d12_desc_split srv_desc;
     struct d3d12_device *device;
@@ -168,20 +214,14 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetCudaTextureObject(ID3
     srv_desc = d3d12_desc_decode_va(srv_handle.ptr);
     sampler_desc = d3d12_desc_decode_va(sampler_handle.ptr);
 
-    imageViewHandleInfo.imageView = srv_desc.view->info.view->vk_image_view;
-    imageViewHandleInfo.sampler = sampler_desc.view->info.view->vk_sampler;
-    imageViewHandleInfo.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-
-    vk_procs = &device->vk_procs;
-    *cuda_texture_handle = VK_CALL(vkGetImageViewHandleNVX(device->vk_device, &imageViewHandleInfo));
+    *cuda_texture_handle = d3d12_device_get_cuda_view_handle(device, srv_desc.view->info.view,
+            sampler_desc.view->info.view, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetCudaSurfaceObject(ID3D12DeviceExt *iface, D3D12_CPU_DESCRIPTOR_HANDLE uav_handle, 
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetCudaSurfaceObject(ID3D12DeviceExt2 *iface, D3D12_CPU_DESCRIPTOR_HANDLE uav_handle, 
         UINT32 *cuda_surface_handle)
 {
-    VkImageViewHandleInfoNVX imageViewHandleInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_HANDLE_INFO_NVX };
-    const struct vkd3d_vk_device_procs *vk_procs;
     struct d3d12_desc_split uav_desc;
     struct d3d12_device *device;
 
@@ -192,17 +232,14 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetCudaSurfaceObject(ID3
     device = d3d12_device_from_ID3D12DeviceExt(iface);
     uav_desc = d3d12_desc_decode_va(uav_handle.ptr);
 
-    imageViewHandleInfo.imageView = uav_desc.view->info.view->vk_image_view;
-    imageViewHandleInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-
-    vk_procs = &device->vk_procs;
-    *cuda_surface_handle = VK_CALL(vkGetImageViewHandleNVX(device->vk_device, &imageViewHandleInfo));
-    return S_OK; 
+    *cuda_surface_handle = d3d12_device_get_cuda_view_handle(device, uav_desc.view->info.view,
+            NULL, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+    return S_OK;
 }
 
 extern VKD3D_THREAD_LOCAL struct D3D12_UAV_INFO *d3d12_uav_info;
 
-static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CaptureUAVInfo(ID3D12DeviceExt *iface, D3D12_UAV_INFO *uav_info)
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CaptureUAVInfo(ID3D12DeviceExt2 *iface, D3D12_UAV_INFO *uav_info)
 {
     if (!uav_info)
        return E_INVALIDARG;
@@ -215,7 +252,117 @@ static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CaptureUAVInfo(ID3D12Dev
     return S_OK;
 }
 
-CONST_VTBL struct ID3D12DeviceExtVtbl d3d12_device_vkd3d_ext_vtbl =
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetMemoryFootprint(ID3D12DeviceExt2 *iface,
+        D3D12_MEMORY_FOOTPRINT *footprint)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
+    uint64_t bytes[VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT];
+
+    TRACE("iface %p, footprint %p.\n", iface, footprint);
+
+    if (!footprint)
+        return E_INVALIDARG;
+
+    vkd3d_memory_footprint_get(&device->memory_footprint, bytes);
+    footprint->descriptorHeapBytes = bytes[VKD3D_MEMORY_FOOTPRINT_DESCRIPTOR_HEAP];
+    footprint->memoryChunkSlackBytes = bytes[VKD3D_MEMORY_FOOTPRINT_MEMORY_CHUNK_SLACK];
+    footprint->scratchPoolBytes = bytes[VKD3D_MEMORY_FOOTPRINT_SCRATCH_POOL];
+    footprint->queryPoolBytes = bytes[VKD3D_MEMORY_FOOTPRINT_QUERY_POOL];
+    footprint->pipelineSpirvBytes = bytes[VKD3D_MEMORY_FOOTPRINT_PIPELINE_SPIRV];
+    footprint->pipelineLibraryBytes = bytes[VKD3D_MEMORY_FOOTPRINT_PIPELINE_LIBRARY];
+    footprint->viewMapBytes = bytes[VKD3D_MEMORY_FOOTPRINT_VIEW_MAP];
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_GetResourceWriteWatch(ID3D12DeviceExt2 *iface,
+        ID3D12Resource *resource, BOOL reset, UINT64 offset, UINT64 size,
+        UINT64 *page_offsets, UINT64 *page_count, UINT32 *page_size)
+{
+    struct d3d12_resource *resource_impl;
+    size_t count;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, reset %u, offset %#"PRIx64", size %#"PRIx64", page_offsets %p, page_count %p, page_size %p.\n",
+            iface, resource, reset, offset, size, page_offsets, page_count, page_size);
+
+    if (!resource || !page_count || !page_size || (*page_count && !page_offsets))
+        return E_INVALIDARG;
+
+    resource_impl = impl_from_ID3D12Resource(resource);
+
+    if (!d3d12_resource_is_buffer(resource_impl) || !resource_impl->mem.cpu_address ||
+            !(resource_impl->mem.flags & VKD3D_ALLOCATION_FLAG_ALLOW_WRITE_WATCH))
+    {
+        WARN("Resource %p was not placed in a WRITE_WATCH heap.\n", resource);
+        return E_INVALIDARG;
+    }
+
+    if (offset > resource_impl->desc.Width || size > resource_impl->desc.Width - offset)
+    {
+        WARN("Range %#"PRIx64" + %#"PRIx64" is out of bounds.\n", offset, size);
+        return E_INVALIDARG;
+    }
+
+    count = *page_count;
+    if (FAILED(hr = vkd3d_memory_allocation_get_write_watch(&resource_impl->mem,
+            reset, offset, size, page_offsets, &count, page_size)))
+        return hr;
+
+    *page_count = count;
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_device_vkd3d_ext_CreateTransientResourceSlots(ID3D12DeviceExt2 *iface,
+        ID3D12Heap *heap, UINT slot_count, const D3D12_TRANSIENT_RESOURCE_SLOT_DESC *slot_descs,
+        REFIID iid, void **resources)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3D12DeviceExt(iface);
+    unsigned int i, queried_count;
+    struct d3d12_resource **objects;
+    HRESULT hr = S_OK;
+
+    TRACE("iface %p, heap %p, slot_count %u, slot_descs %p, iid %s, resources %p.\n",
+            iface, heap, slot_count, slot_descs, debugstr_guid(iid), resources);
+
+    if (!heap || !slot_count || !slot_descs || !resources)
+        return E_INVALIDARG;
+
+    if (!(objects = vkd3d_malloc(slot_count * sizeof(*objects))))
+        return E_OUTOFMEMORY;
+
+    if (FAILED(hr = d3d12_resource_create_transient_slots(device, impl_from_ID3D12Heap(heap),
+            slot_count, slot_descs, objects)))
+    {
+        vkd3d_free(objects);
+        return hr;
+    }
+
+    for (queried_count = 0; queried_count < slot_count; queried_count++)
+    {
+        if (FAILED(hr = ID3D12Resource2_QueryInterface(&objects[queried_count]->ID3D12Resource_iface,
+                iid, &resources[queried_count])))
+            break;
+    }
+
+    /* The returned interfaces hold their own references. */
+    for (i = 0; i < slot_count; i++)
+        ID3D12Resource2_Release(&objects[i]->ID3D12Resource_iface);
+
+    if (FAILED(hr))
+    {
+        WARN("Failed to query %s, hr %#x.\n", debugstr_guid(iid), hr);
+        for (i = 0; i < queried_count; i++)
+        {
+            IUnknown_Release((IUnknown *)resources[i]);
+            resources[i] = NULL;
+        }
+    }
+
+    vkd3d_free(objects);
+    return hr;
+}
+
+CONST_VTBL struct ID3D12DeviceExt2Vtbl d3d12_device_vkd3d_ext_vtbl =
 {
     /* IUnknown methods */
     d3d12_device_vkd3d_ext_QueryInterface,
@@ -229,22 +376,29 @@ CONST_VTBL struct ID3D12DeviceExtVtbl d3d12_device_vkd3d_ext_vtbl =
     d3d12_device_vkd3d_ext_DestroyCubinComputeShader,
     d3d12_device_vkd3d_ext_GetCudaTextureObject,
     d3d12_device_vkd3d_ext_GetCudaSurfaceObject,
-    d3d12_device_vkd3d_ext_CaptureUAVInfo
+    d3d12_device_vkd3d_ext_CaptureUAVInfo,
+
+    /* ID3D12DeviceExt1 methods */
+    d3d12_device_vkd3d_ext_GetMemoryFootprint,
+    d3d12_device_vkd3d_ext_GetResourceWriteWatch,
+
+    /* ID3D12DeviceExt2 methods */
+    d3d12_device_vkd3d_ext_CreateTransientResourceSlots,
 };
 
 
-static inline struct d3d12_device *d3d12_device_from_ID3D12DXVKInteropDevice(ID3D12DXVKInteropDevice *iface)
+static inline struct d3d12_device *d3d12_device_from_ID3D12DXVKInteropDevice(ID3D12DXVKInteropDevice1 *iface)
 {
     return CONTAINING_RECORD(iface, struct d3d12_device, ID3D12DXVKInteropDevice_iface);
 }
 
-ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_AddRef(ID3D12DXVKInteropDevice *iface)
+ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_AddRef(ID3D12DXVKInteropDevice1 *iface)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
     return d3d12_device_add_ref(device);
 }
 
-static ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_Release(ID3D12DXVKInteropDevice *iface)
+static ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_Release(ID3D12DXVKInteropDevice1 *iface)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
     return d3d12_device_release(device);
@@ -253,7 +407,7 @@ static ULONG STDMETHODCALLTYPE d3d12_dxvk_interop_device_Release(ID3D12DXVKInter
 extern HRESULT STDMETHODCALLTYPE d3d12_device_QueryInterface(d3d12_device_iface *iface,
         REFIID riid, void **object);
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_QueryInterface(ID3D12DXVKInteropDevice *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_QueryInterface(ID3D12DXVKInteropDevice1 *iface,
         REFIID iid, void **out)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
@@ -261,7 +415,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_QueryInterface(ID3D12
     return d3d12_device_QueryInterface(&device->ID3D12Device_iface, iid, out);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDXGIAdapter(ID3D12DXVKInteropDevice *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDXGIAdapter(ID3D12DXVKInteropDevice1 *iface,
         REFIID iid, void **object)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
@@ -269,7 +423,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDXGIAdapter(ID3D12
     return IUnknown_QueryInterface(device->parent, iid, object);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanHandles(ID3D12DXVKInteropDevice *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanHandles(ID3D12DXVKInteropDevice1 *iface,
         VkInstance *vk_instance, VkPhysicalDevice *vk_physical_device, VkDevice *vk_device)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
@@ -283,7 +437,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanHandles(ID3D
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetInstanceExtensions(ID3D12DXVKInteropDevice *iface, UINT *extension_count, const char **extensions)
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetInstanceExtensions(ID3D12DXVKInteropDevice1 *iface, UINT *extension_count, const char **extensions)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
     struct vkd3d_instance *instance = device->vkd3d_instance;
@@ -303,7 +457,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetInstanceExtensions
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDeviceExtensions(ID3D12DXVKInteropDevice *iface, UINT *extension_count, const char **extensions)
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDeviceExtensions(ID3D12DXVKInteropDevice1 *iface, UINT *extension_count, const char **extensions)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
 
@@ -322,7 +476,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDeviceExtensions(I
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDeviceFeatures(ID3D12DXVKInteropDevice *iface, const VkPhysicalDeviceFeatures2 **features)
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDeviceFeatures(ID3D12DXVKInteropDevice1 *iface, const VkPhysicalDeviceFeatures2 **features)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
 
@@ -332,7 +486,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetDeviceFeatures(ID3
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanQueueInfo(ID3D12DXVKInteropDevice *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanQueueInfo(ID3D12DXVKInteropDevice1 *iface,
         ID3D12CommandQueue *queue, VkQueue *vk_queue, UINT32 *vk_queue_family)
 {
     TRACE("iface %p, queue %p, vk_queue %p, vk_queue_family %p.\n", iface, queue, vk_queue, vk_queue_family);
@@ -345,7 +499,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanQueueInfo(ID
     return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanImageLayout(ID3D12DXVKInteropDevice *iface,
+static void STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanImageLayout(ID3D12DXVKInteropDevice1 *iface,
         ID3D12Resource *resource, D3D12_RESOURCE_STATES state, VkImageLayout *vk_layout)
 {
     struct d3d12_resource *resource_impl = impl_from_ID3D12Resource(resource);
@@ -355,13 +509,17 @@ static void STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanImageLayout(ID3
     *vk_layout = vk_image_layout_from_d3d12_resource_state(NULL, resource_impl, state);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanResourceInfo(ID3D12DXVKInteropDevice *iface,
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanResourceInfo(ID3D12DXVKInteropDevice1 *iface,
         ID3D12Resource *resource, UINT64 *vk_handle, UINT64 *buffer_offset)
 {
     struct d3d12_resource *resource_impl = impl_from_ID3D12Resource(resource);
 
     TRACE("iface %p, resource %p, vk_handle %p.\n", iface, resource, vk_handle);
 
+    /* The caller may use the image directly. */
+    if (resource_impl->flags & VKD3D_RESOURCE_DEFERRED_BIND)
+        vkd3d_memory_bind_queue_flush_if_pending(&resource_impl->device->memory_binds, resource_impl->device);
+
     if (resource_impl->desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
     {
         *vk_handle = (UINT64)resource_impl->res.vk_buffer;
@@ -376,7 +534,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_GetVulkanResourceInfo
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_LockCommandQueue(ID3D12DXVKInteropDevice *iface, ID3D12CommandQueue *queue)
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_LockCommandQueue(ID3D12DXVKInteropDevice1 *iface, ID3D12CommandQueue *queue)
 {
     struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
 
@@ -390,7 +548,7 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_LockCommandQueue(ID3D
     return S_OK;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_UnlockCommandQueue(ID3D12DXVKInteropDevice *iface, ID3D12CommandQueue *queue)
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_UnlockCommandQueue(ID3D12DXVKInteropDevice1 *iface, ID3D12CommandQueue *queue)
 {
     TRACE("iface %p, queue %p.\n", iface, queue);
 
@@ -398,7 +556,56 @@ static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_UnlockCommandQueue(ID
     return S_OK;
 }
 
-CONST_VTBL struct ID3D12DXVKInteropDeviceVtbl d3d12_dxvk_interop_device_vtbl =
+struct d3d12_dxvk_interop_submission
+{
+    struct d3d12_command_queue *queue;
+    PFN_D3D12_DXVK_INTEROP_SUBMISSION_CALLBACK callback;
+    void *userdata;
+};
+
+static void d3d12_dxvk_interop_submission_callback(void *userdata)
+{
+    struct d3d12_dxvk_interop_submission *submission = userdata;
+    VkQueue vk_queue;
+
+    /* Pending waits have already been flushed by the submission thread at this point. */
+    if ((vk_queue = vkd3d_queue_acquire(submission->queue->vkd3d_queue)))
+    {
+        submission->callback(vk_queue, submission->userdata);
+        vkd3d_queue_release(submission->queue->vkd3d_queue);
+    }
+    else
+        ERR("Failed to acquire queue for interop submission.\n");
+
+    vkd3d_free(submission);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d12_dxvk_interop_device_EnqueueSubmissionCallback(ID3D12DXVKInteropDevice1 *iface,
+        ID3D12CommandQueue *queue, PFN_D3D12_DXVK_INTEROP_SUBMISSION_CALLBACK callback, void *userdata)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3D12DXVKInteropDevice(iface);
+    struct d3d12_dxvk_interop_submission *submission;
+
+    TRACE("iface %p, queue %p, callback %p, userdata %p.\n", iface, queue, callback, userdata);
+
+    if (!queue || !callback)
+        return E_INVALIDARG;
+
+    if (!(submission = vkd3d_malloc(sizeof(*submission))))
+        return E_OUTOFMEMORY;
+
+    submission->queue = impl_from_ID3D12CommandQueue(queue);
+    submission->callback = callback;
+    submission->userdata = userdata;
+
+    /* Same as LockCommandQueue, except that ordering with D3D12 work on this queue
+     * comes from the submission stream, so the caller never waits for the queue. */
+    vkd3d_memory_transfer_queue_flush(&device->memory_transfers);
+    d3d12_command_queue_enqueue_callback(submission->queue, d3d12_dxvk_interop_submission_callback, submission);
+    return S_OK;
+}
+
+CONST_VTBL struct ID3D12DXVKInteropDevice1Vtbl d3d12_dxvk_interop_device_vtbl =
 {
     /* IUnknown methods */
     d3d12_dxvk_interop_device_QueryInterface,
@@ -416,4 +623,355 @@ CONST_VTBL struct ID3D12DXVKInteropDeviceVtbl d3d12_dxvk_interop_device_vtbl =
     d3d12_dxvk_interop_device_GetVulkanResourceInfo,
     d3d12_dxvk_interop_device_LockCommandQueue,
     d3d12_dxvk_interop_device_UnlockCommandQueue,
+
+    /* ID3D12DXVKInteropDevice1 methods */
+    d3d12_dxvk_interop_device_EnqueueSubmissionCallback,
+};
+
+static void vkd3d_low_latency_update_anti_lag(struct d3d12_device *device, bool mode_enabled,
+        uint32_t minimum_interval_us, uint64_t frame_id, const VkAntiLagStageAMD *stage)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkAntiLagPresentationInfoAMD presentation_info;
+    VkAntiLagDataAMD anti_lag_data;
+
+    memset(&presentation_info, 0, sizeof(presentation_info));
+    presentation_info.sType = VK_STRUCTURE_TYPE_ANTI_LAG_PRESENTATION_INFO_AMD;
+    presentation_info.stage = stage ? *stage : VK_ANTI_LAG_STAGE_INPUT_AMD;
+    presentation_info.frameIndex = frame_id;
+
+    memset(&anti_lag_data, 0, sizeof(anti_lag_data));
+    anti_lag_data.sType = VK_STRUCTURE_TYPE_ANTI_LAG_DATA_AMD;
+    anti_lag_data.mode = mode_enabled ? VK_ANTI_LAG_MODE_ON_AMD : VK_ANTI_LAG_MODE_OFF_AMD;
+    anti_lag_data.maxFPS = minimum_interval_us ? max(1u, 1000000u / minimum_interval_us) : 0;
+    anti_lag_data.pPresentationInfo = stage ? &presentation_info : NULL;
+
+    VK_CALL(vkAntiLagUpdateAMD(device->vk_device, &anti_lag_data));
+}
+
+HRESULT vkd3d_low_latency_state_init(struct vkd3d_low_latency_state *state, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkSemaphoreTypeCreateInfo type_info;
+    VkSemaphoreCreateInfo create_info;
+    VkResult vr;
+    int rc;
+
+    memset(state, 0, sizeof(*state));
+
+    if ((rc = pthread_mutex_init(&state->lock, NULL)))
+        return hresult_from_errno(rc);
+
+    /* Lets us turn on low latency for titles which do not drive it themselves.
+     * Present() then acts as the sleep point. */
+    state->mode_enabled = !!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOW_LATENCY);
+
+    if (d3d12_device_supports_nv_low_latency(device))
+    {
+        type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        type_info.pNext = NULL;
+        type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        type_info.initialValue = 0;
+
+        create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        create_info.pNext = &type_info;
+        create_info.flags = 0;
+
+        if ((vr = VK_CALL(vkCreateSemaphore(device->vk_device, &create_info, NULL, &state->vk_sleep_semaphore))) < 0)
+        {
+            ERR("Failed to create latency sleep semaphore, vr %d.\n", vr);
+            pthread_mutex_destroy(&state->lock);
+            return hresult_from_vk_result(vr);
+        }
+    }
+    else if (d3d12_device_supports_amd_anti_lag(device) && state->mode_enabled)
+        vkd3d_low_latency_update_anti_lag(device, true, 0, 0, NULL);
+
+    if (state->mode_enabled)
+        INFO("Enabling low latency mode.\n");
+
+    return S_OK;
+}
+
+void vkd3d_low_latency_state_cleanup(struct vkd3d_low_latency_state *state, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VK_CALL(vkDestroySemaphore(device->vk_device, state->vk_sleep_semaphore, NULL));
+    pthread_mutex_destroy(&state->lock);
+}
+
+void vkd3d_low_latency_register_swapchain(struct d3d12_device *device, struct dxgi_vk_swap_chain *chain)
+{
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+
+    if (!d3d12_device_supports_nv_low_latency(device))
+        return;
+
+    /* Latency markers are tracked per VkSwapchainKHR. Like native drivers,
+     * only the first swapchain created on a device takes part. */
+    pthread_mutex_lock(&state->lock);
+    if (!state->swapchain)
+        state->swapchain = chain;
+    pthread_mutex_unlock(&state->lock);
+}
+
+void vkd3d_low_latency_unregister_swapchain(struct d3d12_device *device, struct dxgi_vk_swap_chain *chain)
+{
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+
+    if (!d3d12_device_supports_nv_low_latency(device))
+        return;
+
+    pthread_mutex_lock(&state->lock);
+    if (state->swapchain == chain)
+        state->swapchain = NULL;
+    pthread_mutex_unlock(&state->lock);
+}
+
+HRESULT vkd3d_low_latency_sleep(struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    const VkAntiLagStageAMD anti_lag_stage = VK_ANTI_LAG_STAGE_INPUT_AMD;
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+    uint32_t minimum_interval_us;
+    VkSemaphoreWaitInfo wait_info;
+    uint64_t sleep_value = 0;
+    bool anti_lag = false;
+    uint64_t frame_id;
+    VkResult vr;
+
+    pthread_mutex_lock(&state->lock);
+
+    if (state->mode_enabled)
+    {
+        if (state->swapchain)
+        {
+            if (dxgi_vk_swap_chain_low_latency_sleep(state->swapchain,
+                    state->vk_sleep_semaphore, state->sleep_count + 1))
+                sleep_value = ++state->sleep_count;
+        }
+        else if (d3d12_device_supports_amd_anti_lag(device))
+        {
+            minimum_interval_us = state->minimum_interval_us;
+            anti_lag = true;
+        }
+    }
+
+    pthread_mutex_unlock(&state->lock);
+
+    /* The anti-lag update sleeps internally, so avoid holding the lock
+     * which the present task needs to make progress. */
+    if (anti_lag)
+    {
+        frame_id = vkd3d_atomic_uint64_load_explicit(&state->frame_id, vkd3d_memory_order_relaxed);
+        vkd3d_low_latency_update_anti_lag(device, true, minimum_interval_us, frame_id, &anti_lag_stage);
+    }
+
+    if (!sleep_value)
+        return S_OK;
+
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.pNext = NULL;
+    wait_info.flags = 0;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &state->vk_sleep_semaphore;
+    wait_info.pValues = &sleep_value;
+
+    /* The semaphore is owned by the device, so it is fine if the swapchain goes away while we sleep.
+     * Don't block forever in that case. */
+    vr = VK_CALL(vkWaitSemaphores(device->vk_device, &wait_info, 1000000000ull));
+    if (vr == VK_TIMEOUT)
+        WARN("Timed out waiting for latency sleep.\n");
+    else if (vr < 0)
+        ERR("Failed to wait for latency sleep, vr %d.\n", vr);
+
+    return hresult_from_vk_result(vr < 0 ? vr : VK_SUCCESS);
+}
+
+void vkd3d_low_latency_notify_present(struct d3d12_device *device, uint64_t frame_id)
+{
+    const VkAntiLagStageAMD anti_lag_stage = VK_ANTI_LAG_STAGE_PRESENT_AMD;
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+    uint32_t minimum_interval_us;
+    bool mode_enabled;
+
+    if (!d3d12_device_supports_amd_anti_lag(device))
+        return;
+
+    pthread_mutex_lock(&state->lock);
+    mode_enabled = state->mode_enabled;
+    minimum_interval_us = state->minimum_interval_us;
+    pthread_mutex_unlock(&state->lock);
+
+    if (mode_enabled)
+        vkd3d_low_latency_update_anti_lag(device, true, minimum_interval_us, frame_id, &anti_lag_stage);
+}
+
+void vkd3d_low_latency_begin_implicit_frame(struct d3d12_device *device)
+{
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+    bool application_markers, application_sleeps, mode_enabled;
+
+    pthread_mutex_lock(&state->lock);
+    application_markers = state->application_markers;
+    application_sleeps = state->application_sleeps;
+    mode_enabled = state->mode_enabled;
+    pthread_mutex_unlock(&state->lock);
+
+    /* For titles which are not aware of low latency, every Present() starts a new frame. */
+    if (!application_markers)
+        vkd3d_atomic_uint64_increment(&state->frame_id, vkd3d_memory_order_relaxed);
+
+    if (mode_enabled && !application_sleeps)
+        vkd3d_low_latency_sleep(device);
+}
+
+static inline struct d3d12_device *d3d12_device_from_ID3DLowLatencyDevice(ID3DLowLatencyDevice *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d12_device, ID3DLowLatencyDevice_iface);
+}
+
+ULONG STDMETHODCALLTYPE d3d_low_latency_device_AddRef(ID3DLowLatencyDevice *iface)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    return d3d12_device_add_ref(device);
+}
+
+static ULONG STDMETHODCALLTYPE d3d_low_latency_device_Release(ID3DLowLatencyDevice *iface)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    return d3d12_device_release(device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d_low_latency_device_QueryInterface(ID3DLowLatencyDevice *iface,
+        REFIID iid, void **out)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+    return d3d12_device_query_interface(device, iid, out);
+}
+
+static BOOL STDMETHODCALLTYPE d3d_low_latency_device_SupportsLowLatency(ID3DLowLatencyDevice *iface)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    return d3d12_device_supports_nv_low_latency(device) || d3d12_device_supports_amd_anti_lag(device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d_low_latency_device_LatencySleep(ID3DLowLatencyDevice *iface)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+
+    TRACE("iface %p.\n", iface);
+
+    pthread_mutex_lock(&state->lock);
+    state->application_sleeps = true;
+    pthread_mutex_unlock(&state->lock);
+
+    return vkd3d_low_latency_sleep(device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d_low_latency_device_SetLatencySleepMode(ID3DLowLatencyDevice *iface,
+        BOOL low_latency_mode, BOOL low_latency_boost, UINT32 minimum_interval_us)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+
+    TRACE("iface %p, low_latency_mode %u, low_latency_boost %u, minimum_interval_us %u.\n",
+            iface, low_latency_mode, low_latency_boost, minimum_interval_us);
+
+    pthread_mutex_lock(&state->lock);
+
+    state->mode_enabled = !!low_latency_mode;
+    state->boost = !!low_latency_boost;
+    state->minimum_interval_us = minimum_interval_us;
+
+    if (state->swapchain)
+        dxgi_vk_swap_chain_low_latency_apply_sleep_mode(state->swapchain);
+    else if (d3d12_device_supports_amd_anti_lag(device))
+        vkd3d_low_latency_update_anti_lag(device, state->mode_enabled, state->minimum_interval_us, 0, NULL);
+
+    pthread_mutex_unlock(&state->lock);
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d_low_latency_device_SetLatencyMarker(ID3DLowLatencyDevice *iface,
+        UINT64 frameID, UINT32 markerType)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+    VkLatencyMarkerNV vk_marker;
+
+    TRACE("iface %p, frameID %"PRIu64", markerType %u.\n", iface, frameID, markerType);
+
+    /* Marker types follow NVAPI, which matches Vulkan except for PC_LATENCY_PING,
+     * which has no Vulkan equivalent. */
+    if (markerType <= VK_LATENCY_MARKER_TRIGGER_FLASH_NV)
+        vk_marker = (VkLatencyMarkerNV)markerType;
+    else if (markerType >= 9 && markerType <= 12)
+        vk_marker = (VkLatencyMarkerNV)(markerType - 1);
+    else
+    {
+        WARN("Ignoring latency marker %u.\n", markerType);
+        return S_OK;
+    }
+
+    pthread_mutex_lock(&state->lock);
+
+    state->application_markers = true;
+    vkd3d_atomic_uint64_store_explicit(&state->frame_id, frameID, vkd3d_memory_order_relaxed);
+
+    /* Present markers are emitted by the present task around the actual vkQueuePresentKHR,
+     * since Present() only queues up the request. */
+    if (state->swapchain && vk_marker != VK_LATENCY_MARKER_PRESENT_START_NV &&
+            vk_marker != VK_LATENCY_MARKER_PRESENT_END_NV)
+    {
+        dxgi_vk_swap_chain_low_latency_set_marker(state->swapchain, frameID, vk_marker);
+    }
+
+    pthread_mutex_unlock(&state->lock);
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d_low_latency_device_GetLatencyInfo(ID3DLowLatencyDevice *iface,
+        D3D12_LATENCY_RESULTS *latency_results)
+{
+    struct d3d12_device *device = d3d12_device_from_ID3DLowLatencyDevice(iface);
+    struct vkd3d_low_latency_state *state = &device->low_latency;
+    HRESULT hr;
+
+    TRACE("iface %p, latency_results %p.\n", iface, latency_results);
+
+    if (!latency_results)
+        return E_INVALIDARG;
+
+    memset(latency_results->frame_reports, 0, sizeof(latency_results->frame_reports));
+
+    pthread_mutex_lock(&state->lock);
+    if (state->swapchain)
+        hr = dxgi_vk_swap_chain_low_latency_get_timings(state->swapchain, latency_results);
+    else
+        hr = DXGI_ERROR_INVALID_CALL;
+    pthread_mutex_unlock(&state->lock);
+
+    return hr;
+}
+
+CONST_VTBL struct ID3DLowLatencyDeviceVtbl d3d_low_latency_device_vtbl =
+{
+    /* IUnknown methods */
+    d3d_low_latency_device_QueryInterface,
+    d3d_low_latency_device_AddRef,
+    d3d_low_latency_device_Release,
+
+    /* ID3DLowLatencyDevice methods */
+    d3d_low_latency_device_SupportsLowLatency,
+    d3d_low_latency_device_LatencySleep,
+    d3d_low_latency_device_SetLatencySleepMode,
+    d3d_low_latency_device_SetLatencyMarker,
+    d3d_low_latency_device_GetLatencyInfo,
 };
@@ -61,10 +61,91 @@ static ULONG STDMETHODCALLTYPE d3d12_heap_AddRef(d3d12_heap_iface *iface)
     return refcount;
 }
 
+static int d3d12_heap_compare_placed_resource(const void *key, const struct rb_entry *entry)
+{
+    const struct d3d12_resource *resource = RB_ENTRY_VALUE(entry, const struct d3d12_resource, heap_range.entry);
+    const struct d3d12_resource *k = key;
+
+    if (k->heap_range.offset != resource->heap_range.offset)
+        return k->heap_range.offset < resource->heap_range.offset ? -1 : 1;
+    if (k != resource)
+        return k < resource ? -1 : 1;
+    return 0;
+}
+
+static void d3d12_heap_update_placed_resource_aliases(struct d3d12_heap *heap,
+        struct d3d12_resource *resource, int delta)
+{
+    VkDeviceSize begin = resource->heap_range.offset;
+    VkDeviceSize end = begin + resource->heap_range.size;
+    struct rb_entry *iter, *first = NULL;
+    struct d3d12_resource *other;
+    VkDeviceSize lower_bound;
+
+    /* Nothing that starts below this bound can reach into our range. */
+    lower_bound = begin > heap->placed_resource_max_size ? begin - heap->placed_resource_max_size : 0;
+
+    iter = heap->placed_resources.root;
+    while (iter)
+    {
+        other = RB_ENTRY_VALUE(iter, struct d3d12_resource, heap_range.entry);
+
+        if (other->heap_range.offset >= lower_bound)
+        {
+            first = iter;
+            iter = iter->left;
+        }
+        else
+            iter = iter->right;
+    }
+
+    for (iter = first; iter; iter = rb_next(iter))
+    {
+        other = RB_ENTRY_VALUE(iter, struct d3d12_resource, heap_range.entry);
+
+        if (other->heap_range.offset >= end)
+            break;
+
+        if (other == resource || other->heap_range.offset + other->heap_range.size <= begin)
+            continue;
+
+        other->heap_range.alias_count += delta;
+        resource->heap_range.alias_count += delta;
+    }
+}
+
+void d3d12_heap_register_placed_resource(struct d3d12_heap *heap, struct d3d12_resource *resource,
+        VkDeviceSize offset, VkDeviceSize size)
+{
+    resource->heap_range.offset = offset;
+    resource->heap_range.size = size;
+    resource->heap_range.alias_count = 0;
+
+    spinlock_acquire(&heap->placed_resources_lock);
+    heap->placed_resource_max_size = max(heap->placed_resource_max_size, size);
+    d3d12_heap_update_placed_resource_aliases(heap, resource, 1);
+    rb_put(&heap->placed_resources, resource, &resource->heap_range.entry);
+    resource->heap_range.registered = true;
+    spinlock_release(&heap->placed_resources_lock);
+}
+
+void d3d12_heap_unregister_placed_resource(struct d3d12_heap *heap, struct d3d12_resource *resource)
+{
+    if (!resource->heap_range.registered)
+        return;
+
+    spinlock_acquire(&heap->placed_resources_lock);
+    rb_remove(&heap->placed_resources, &resource->heap_range.entry);
+    d3d12_heap_update_placed_resource_aliases(heap, resource, -1);
+    resource->heap_range.registered = false;
+    spinlock_release(&heap->placed_resources_lock);
+}
+
 static void d3d12_heap_destroy(struct d3d12_heap *heap)
 {
     TRACE("Destroying heap %p.\n", heap);
 
+    vkd3d_residency_manager_unregister(&heap->device->residency_manager, &heap->priority);
     vkd3d_free_memory(heap->device, &heap->device->memory_allocator, &heap->allocation);
     vkd3d_private_store_destroy(&heap->private_store);
     vkd3d_free(heap);
@@ -263,6 +344,10 @@ static HRESULT d3d12_heap_init(struct d3d12_heap *heap, struct d3d12_device *dev
     spinlock_init(&heap->priority.spinlock);
     heap->priority.d3d12priority = D3D12_RESIDENCY_PRIORITY_NORMAL;
     heap->priority.residency_count = 1;
+    heap->priority.demoted = false;
+    heap->priority.tracked = false;
+    spinlock_init(&heap->placed_resources_lock);
+    rb_init(&heap->placed_resources, d3d12_heap_compare_placed_resource);
 
     if (!heap->desc.Properties.CreationNodeMask)
         heap->desc.Properties.CreationNodeMask = 1;
@@ -314,6 +399,12 @@ static HRESULT d3d12_heap_init(struct d3d12_heap *heap, struct d3d12_device *dev
         heap->allocation.chunk == NULL /* not suballocated */ &&
         (device->memory_properties.memoryTypes[heap->allocation.device_allocation.vk_memory_type].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
+    if (heap->priority.allows_dynamic_residency)
+    {
+        vkd3d_residency_manager_register(&device->residency_manager,
+                &heap->priority, &heap->allocation.device_allocation);
+    }
+
     d3d12_device_add_ref(heap->device);
     return S_OK;
 }
@@ -21,6 +21,24 @@
 #include "vkd3d_private.h"
 #include "vkd3d_descriptor_debug.h"
 
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#include <linux/userfaultfd.h>
+
+/* Asynchronous userfaultfd write protection lets the kernel resolve write faults on its own,
+ * and PAGEMAP_SCAN reports and re-protects written pages in one go, so there is no fault
+ * handler thread and no signal handling involved. Needs Linux 6.7. */
+#if defined(UFFD_FEATURE_WP_ASYNC) && defined(UFFD_FEATURE_WP_UNPOPULATED) && defined(PAGEMAP_SCAN)
+#define VKD3D_WRITE_WATCH_USERFAULTFD
+#endif
+#endif
+
 static bool vkd3d_memory_transfer_queue_wait_semaphore(struct vkd3d_memory_transfer_queue *queue,
         uint64_t wait_value, uint64_t timeout);
 
@@ -125,6 +143,9 @@ void vkd3d_memory_transfer_queue_cleanup(struct vkd3d_memory_transfer_queue *que
 
     vkd3d_free(queue->tracked_resources);
     vkd3d_free(queue->transfers);
+    vkd3d_free(queue->clear_ranges);
+    vkd3d_free(queue->image_barriers);
+    vkd3d_free(queue->command_buffers);
 
     pthread_cond_destroy(&queue->cond);
     pthread_mutex_destroy(&queue->mutex);
@@ -132,6 +153,7 @@ void vkd3d_memory_transfer_queue_cleanup(struct vkd3d_memory_transfer_queue *que
 
 HRESULT vkd3d_memory_transfer_queue_init(struct vkd3d_memory_transfer_queue *queue, struct d3d12_device *device)
 {
+    VkCommandBuffer vk_command_buffers[VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT];
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     VkSemaphoreTypeCreateInfoKHR semaphore_type_info;
     VkCommandBufferAllocateInfo command_buffer_info;
@@ -139,13 +161,14 @@ HRESULT vkd3d_memory_transfer_queue_init(struct vkd3d_memory_transfer_queue *que
     VkSemaphoreCreateInfo semaphore_info;
     VkResult vr;
     HRESULT hr;
+    size_t i;
     int rc;
 
     memset(queue, 0, sizeof(*queue));
 
     queue->device = device;
     queue->vkd3d_queue = d3d12_device_allocate_vkd3d_queue(device,
-            device->queue_families[VKD3D_QUEUE_FAMILY_INTERNAL_COMPUTE]);
+            device->queue_families[VKD3D_QUEUE_FAMILY_INTERNAL_COMPUTE], false);
 
     queue->last_known_value = VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT;
     queue->next_signal_value = VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT + 1;
@@ -186,14 +209,29 @@ HRESULT vkd3d_memory_transfer_queue_init(struct vkd3d_memory_transfer_queue *que
     command_buffer_info.commandPool = queue->vk_command_pool;
     command_buffer_info.commandBufferCount = VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT;
 
+    if (!vkd3d_array_reserve((void **)&queue->command_buffers, &queue->command_buffers_size,
+            VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT, sizeof(*queue->command_buffers)))
+    {
+        hr = E_OUTOFMEMORY;
+        goto fail;
+    }
+
     if ((vr = VK_CALL(vkAllocateCommandBuffers(device->vk_device,
-            &command_buffer_info, queue->vk_command_buffers))) < 0)
+            &command_buffer_info, vk_command_buffers))) < 0)
     {
         ERR("Failed to allocate command buffer, vr %d.\n", vr);
         hr = hresult_from_vk_result(vr);
         goto fail;
     }
 
+    /* The timeline starts out at VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT, so these are all idle. */
+    for (i = 0; i < VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT; i++)
+    {
+        queue->command_buffers[i].vk_command_buffer = vk_command_buffers[i];
+        queue->command_buffers[i].signal_value = 0;
+    }
+    queue->command_buffer_count = VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT;
+
     semaphore_type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
     semaphore_type_info.pNext = NULL;
     semaphore_type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
@@ -271,8 +309,182 @@ static bool vkd3d_memory_transfer_queue_wait_semaphore(struct vkd3d_memory_trans
     return new_value >= wait_value;
 }
 
+static struct vkd3d_memory_transfer_command_buffer *vkd3d_memory_transfer_queue_acquire_command_buffer_locked(
+        struct vkd3d_memory_transfer_queue *queue)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
+    struct vkd3d_memory_transfer_command_buffer *command_buffer;
+    VkCommandBufferAllocateInfo command_buffer_info;
+    VkCommandBuffer vk_command_buffer;
+    size_t index;
+
+    index = queue->command_buffer_index;
+    command_buffer = &queue->command_buffers[index];
+
+    /* If even the oldest command buffer is still busy, we are in a burst of clears.
+     * Rather than stalling on the GPU, grow the ring. The new command buffer is inserted
+     * at the current position so that the ring stays in submission order. */
+    if (!vkd3d_memory_transfer_queue_wait_semaphore(queue, command_buffer->signal_value, 0) &&
+            queue->command_buffer_count < VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_MAX_COUNT &&
+            vkd3d_array_reserve((void **)&queue->command_buffers, &queue->command_buffers_size,
+                    queue->command_buffer_count + 1, sizeof(*queue->command_buffers)))
+    {
+        command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        command_buffer_info.pNext = NULL;
+        command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        command_buffer_info.commandPool = queue->vk_command_pool;
+        command_buffer_info.commandBufferCount = 1;
+
+        if (VK_CALL(vkAllocateCommandBuffers(queue->device->vk_device,
+                &command_buffer_info, &vk_command_buffer)) == VK_SUCCESS)
+        {
+            memmove(&queue->command_buffers[index + 1], &queue->command_buffers[index],
+                    (queue->command_buffer_count - index) * sizeof(*queue->command_buffers));
+            queue->command_buffers[index].vk_command_buffer = vk_command_buffer;
+            queue->command_buffers[index].signal_value = 0;
+            queue->command_buffer_count++;
+
+            if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET)
+                INFO("Growing clear command buffer ring to %zu.\n", queue->command_buffer_count);
+        }
+
+        command_buffer = &queue->command_buffers[index];
+    }
+
+    /* Only wait for exactly the submission which last used this command buffer. */
+    vkd3d_memory_transfer_queue_wait_semaphore(queue, command_buffer->signal_value, UINT64_MAX);
+    return command_buffer;
+}
+
+static int vkd3d_memory_transfer_clear_range_compare(const void *a, const void *b)
+{
+    const struct vkd3d_memory_transfer_clear_range *x = a;
+    const struct vkd3d_memory_transfer_clear_range *y = b;
+
+    if (x->vk_buffer != y->vk_buffer)
+        return (uint64_t)x->vk_buffer < (uint64_t)y->vk_buffer ? -1 : 1;
+    if (x->offset != y->offset)
+        return x->offset < y->offset ? -1 : 1;
+    return 0;
+}
+
+static void vkd3d_memory_transfer_queue_record_clears_locked(struct vkd3d_memory_transfer_queue *queue,
+        VkCommandBuffer vk_cmd_buffer)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
+    struct vkd3d_memory_transfer_clear_range *ranges, *range;
+    size_t range_count = 0, fill_count = 0;
+    size_t i;
+
+    for (i = 0; i < queue->transfer_count; i++)
+    {
+        const struct vkd3d_memory_transfer_info *transfer = &queue->transfers[i];
+
+        if (transfer->op != VKD3D_MEMORY_TRANSFER_OP_CLEAR_ALLOCATION)
+            continue;
+
+        if (!vkd3d_array_reserve((void **)&queue->clear_ranges, &queue->clear_ranges_size,
+                range_count + 1, sizeof(*queue->clear_ranges)))
+        {
+            /* Not fatal, just fall back to clearing this allocation on its own. */
+            VK_CALL(vkCmdFillBuffer(vk_cmd_buffer, transfer->allocation->resource.vk_buffer,
+                    transfer->allocation->offset, transfer->allocation->resource.size, 0));
+            continue;
+        }
+
+        range = &queue->clear_ranges[range_count++];
+        range->vk_buffer = transfer->allocation->resource.vk_buffer;
+        range->offset = transfer->allocation->offset;
+        range->size = transfer->allocation->resource.size;
+    }
+
+    if (!range_count)
+        return;
+
+    /* Sub-allocations from the same chunk share a VkBuffer, so clears of neighbouring
+     * allocations, which is the common case when loading many resources at once,
+     * collapse into a single fill. */
+    ranges = queue->clear_ranges;
+    qsort(ranges, range_count, sizeof(*ranges), vkd3d_memory_transfer_clear_range_compare);
+
+    range = &ranges[0];
+    for (i = 1; i <= range_count; i++)
+    {
+        if (i < range_count && ranges[i].vk_buffer == range->vk_buffer &&
+                ranges[i].offset == range->offset + range->size)
+        {
+            range->size += ranges[i].size;
+            continue;
+        }
+
+        VK_CALL(vkCmdFillBuffer(vk_cmd_buffer, range->vk_buffer, range->offset, range->size, 0));
+        fill_count++;
+
+        if (i < range_count)
+            range = &ranges[i];
+    }
+
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET)
+        INFO("Merged %zu allocation clears into %zu fills.\n", range_count, fill_count);
+}
+
+static void vkd3d_memory_transfer_queue_record_initial_transitions_locked(struct vkd3d_memory_transfer_queue *queue,
+        VkCommandBuffer vk_cmd_buffer)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
+    VkImageMemoryBarrier2 *barrier;
+    size_t barrier_count = 0;
+    VkDependencyInfo dep_info;
+    size_t i;
+
+    for (i = 0; i < queue->transfer_count; i++)
+    {
+        const struct vkd3d_memory_transfer_info *transfer = &queue->transfers[i];
+
+        if (transfer->op != VKD3D_MEMORY_TRANSFER_OP_INITIAL_TRANSITION)
+            continue;
+
+        /* Leave the transition to the first submission using the resource if we cannot record it here. */
+        if (!vkd3d_array_reserve((void **)&queue->image_barriers, &queue->image_barriers_size,
+                barrier_count + 1, sizeof(*queue->image_barriers)))
+            continue;
+
+        /* A submission may already have performed the transition. Otherwise, this will
+         * execute before any other command buffer that could use the resource. */
+        if (!vkd3d_atomic_uint32_load_explicit(&transfer->resource->initial_layout_transition, vkd3d_memory_order_relaxed) ||
+                !vkd3d_atomic_uint32_exchange_explicit(&transfer->resource->initial_layout_transition, 0, vkd3d_memory_order_relaxed))
+            continue;
+
+        barrier = &queue->image_barriers[barrier_count];
+
+        if (!vk_image_memory_barrier_for_initial_transition(transfer->resource, barrier))
+            continue;
+
+        /* The memory may have been cleared through an aliasing buffer earlier in this command buffer. */
+        barrier->srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+        barrier->srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier->dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier_count++;
+
+        transfer->resource->initial_transition_semaphore_value = queue->next_signal_value;
+    }
+
+    if (!barrier_count)
+        return;
+
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.imageMemoryBarrierCount = barrier_count;
+    dep_info.pImageMemoryBarriers = queue->image_barriers;
+
+    VK_CALL(vkCmdPipelineBarrier2(vk_cmd_buffer, &dep_info));
+
+    TRACE("Recorded %zu initial layout transitions.\n", barrier_count);
+}
+
 static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_transfer_queue *queue)
 {
+    struct vkd3d_memory_transfer_command_buffer *command_buffer;
     const struct vkd3d_vk_device_procs *vk_procs = &queue->device->vk_procs;
     const struct vkd3d_subresource_layout *subresource_layout;
     VkCopyBufferToImageInfo2 buffer_to_image_copy;
@@ -301,7 +513,8 @@ static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_tran
     /* Record commands late so that we can simply remove allocations from
      * the queue if they got freed before the clear commands got dispatched,
      * rather than rewriting the command buffer or dispatching the clear */
-    vk_cmd_buffer = queue->vk_command_buffers[queue->command_buffer_index];
+    command_buffer = vkd3d_memory_transfer_queue_acquire_command_buffer_locked(queue);
+    vk_cmd_buffer = command_buffer->vk_command_buffer;
 
     if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET)
     {
@@ -313,9 +526,6 @@ static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_tran
         }
     }
 
-    vkd3d_memory_transfer_queue_wait_semaphore(queue,
-            queue->next_signal_value - VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT, UINT64_MAX);
-
     if ((vr = VK_CALL(vkResetCommandBuffer(vk_cmd_buffer, 0))))
     {
         ERR("Failed to reset command pool, vr %d.\n", vr);
@@ -338,6 +548,14 @@ static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_tran
     dep_info.imageMemoryBarrierCount = 1;
     dep_info.pImageMemoryBarriers = &image_barrier;
 
+    /* Clears only target freshly allocated memory, so they can all go first.
+     * Subresource writes keep their submission order. */
+    vkd3d_memory_transfer_queue_record_clears_locked(queue, vk_cmd_buffer);
+
+    /* Textures created since the last flush get all their initial transitions in one
+     * barrier, so that submissions using them do not have to carry any. */
+    vkd3d_memory_transfer_queue_record_initial_transitions_locked(queue, vk_cmd_buffer);
+
     for (i = 0; i < queue->transfer_count; i++)
     {
         const struct vkd3d_memory_transfer_info *transfer = &queue->transfers[i];
@@ -345,10 +563,7 @@ static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_tran
         switch (transfer->op)
         {
             case VKD3D_MEMORY_TRANSFER_OP_CLEAR_ALLOCATION:
-                VK_CALL(vkCmdFillBuffer(vk_cmd_buffer,
-                        transfer->allocation->resource.vk_buffer,
-                        transfer->allocation->offset,
-                        transfer->allocation->resource.size, 0));
+            case VKD3D_MEMORY_TRANSFER_OP_INITIAL_TRANSITION:
                 break;
 
             case VKD3D_MEMORY_TRANSFER_OP_WRITE_SUBRESOURCE:
@@ -415,7 +630,8 @@ static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_tran
     signal_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
     signal_semaphore_info.semaphore = queue->vk_semaphore;
     signal_semaphore_info.value = queue->next_signal_value;
-    signal_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    /* Layout transitions must be complete as well before other queues may use the images. */
+    signal_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
     memset(&submit_info, 0, sizeof(submit_info));
     submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
@@ -452,12 +668,14 @@ static HRESULT vkd3d_memory_transfer_queue_flush_locked(struct vkd3d_memory_tran
         }
     }
 
+    command_buffer->signal_value = queue->next_signal_value;
+
     /* Keep next_signal always one ahead of the last signaled value */
     queue->next_signal_value += 1;
     queue->num_bytes_pending = 0;
     queue->transfer_count = 0;
     queue->command_buffer_index += 1;
-    queue->command_buffer_index %= VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT;
+    queue->command_buffer_index %= queue->command_buffer_count;
     return S_OK;
 }
 
@@ -538,6 +756,96 @@ HRESULT vkd3d_memory_transfer_queue_write_subresource(struct vkd3d_memory_transf
     return S_OK;
 }
 
+void vkd3d_memory_transfer_queue_initial_transition(struct vkd3d_memory_transfer_queue *queue,
+        struct d3d12_resource *resource)
+{
+    struct vkd3d_memory_transfer_info transfer;
+
+    memset(&transfer, 0, sizeof(transfer));
+    transfer.op = VKD3D_MEMORY_TRANSFER_OP_INITIAL_TRANSITION;
+    transfer.resource = resource;
+
+    pthread_mutex_lock(&queue->mutex);
+    resource->initial_transition_queued = true;
+    vkd3d_memory_transfer_queue_execute_transfer_locked(queue, &transfer);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void vkd3d_memory_transfer_queue_cancel_initial_transition(struct vkd3d_memory_transfer_queue *queue,
+        struct d3d12_resource *resource)
+{
+    uint64_t wait_value;
+    size_t i;
+
+    if (!resource->initial_transition_queued)
+        return;
+
+    pthread_mutex_lock(&queue->mutex);
+
+    for (i = 0; i < queue->transfer_count; i++)
+    {
+        if (queue->transfers[i].op == VKD3D_MEMORY_TRANSFER_OP_INITIAL_TRANSITION &&
+                queue->transfers[i].resource == resource)
+        {
+            /* Subresource writes must stay in order. */
+            memmove(&queue->transfers[i], &queue->transfers[i + 1],
+                    (queue->transfer_count - i - 1) * sizeof(*queue->transfers));
+            queue->transfer_count--;
+            break;
+        }
+    }
+
+    wait_value = resource->initial_transition_semaphore_value;
+    resource->initial_transition_queued = false;
+    resource->initial_transition_semaphore_value = 0;
+
+    pthread_mutex_unlock(&queue->mutex);
+
+    /* The image must not be destroyed or recycled while the barrier may still be in flight. */
+    if (wait_value)
+        vkd3d_memory_transfer_queue_wait_semaphore(queue, wait_value, UINT64_MAX);
+}
+
+bool vkd3d_memory_transfer_queue_cancel_clear(struct vkd3d_memory_transfer_queue *queue,
+        struct vkd3d_memory_allocation *allocation)
+{
+    bool cancelled = false;
+    size_t i;
+
+    if (vkd3d_memory_transfer_queue_wait_semaphore(queue, allocation->clear_semaphore_value, 0))
+        return false;
+
+    pthread_mutex_lock(&queue->mutex);
+
+    for (i = 0; i < queue->transfer_count; i++)
+    {
+        if (queue->transfers[i].op == VKD3D_MEMORY_TRANSFER_OP_CLEAR_ALLOCATION &&
+                queue->transfers[i].allocation == allocation)
+        {
+            queue->transfers[i] = queue->transfers[--queue->transfer_count];
+            queue->num_bytes_pending -= allocation->resource.size;
+            allocation->clear_semaphore_value = 0;
+            cancelled = true;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&queue->mutex);
+
+    if (cancelled)
+        TRACE("Dropped redundant clear of allocation %p.\n", allocation);
+
+    return cancelled;
+}
+
+void vkd3d_memory_transfer_queue_reclear_allocation(struct vkd3d_memory_transfer_queue *queue,
+        struct vkd3d_memory_allocation *allocation)
+{
+    /* An allocation must be in the clear queue at most once. */
+    vkd3d_memory_transfer_queue_cancel_clear(queue, allocation);
+    vkd3d_memory_transfer_queue_clear_allocation(queue, allocation);
+}
+
 static void vkd3d_memory_transfer_queue_wait_allocation(struct vkd3d_memory_transfer_queue *queue,
         const struct vkd3d_memory_allocation *allocation)
 {
@@ -626,13 +934,16 @@ static uint32_t vkd3d_find_memory_types_with_flags(struct d3d12_device *device,
     return mask;
 }
 
-static HRESULT vkd3d_select_memory_flags(struct d3d12_device *device, const D3D12_HEAP_PROPERTIES *heap_properties, VkMemoryPropertyFlags *type_flags)
+static HRESULT vkd3d_select_memory_flags(struct d3d12_device *device, const D3D12_HEAP_PROPERTIES *heap_properties,
+        uint32_t allocation_flags, VkMemoryPropertyFlags *type_flags)
 {
     HRESULT hr;
     switch (heap_properties->Type)
     {
         case D3D12_HEAP_TYPE_DEFAULT:
             *type_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            if (allocation_flags & VKD3D_ALLOCATION_FLAG_HOST_VISIBLE_VRAM)
+                *type_flags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
             break;
 
         case D3D12_HEAP_TYPE_UPLOAD:
@@ -824,6 +1135,8 @@ static HRESULT vkd3d_try_allocate_device_memory(struct d3d12_device *device,
     }
 
     vr = VK_CALL(vkAllocateMemory(device->vk_device, &allocate_info, NULL, &allocation->vk_memory));
+    vkd3d_residency_manager_notify_allocation(&device->residency_manager,
+            allocate_info.memoryTypeIndex, size, vr != VK_SUCCESS);
 
     if (budget_sensitive)
     {
@@ -956,10 +1269,101 @@ static HRESULT vkd3d_allocation_assign_gpu_address(struct vkd3d_memory_allocatio
     return S_OK;
 }
 
+#ifdef VKD3D_WRITE_WATCH_USERFAULTFD
+struct vkd3d_write_watch_tracker
+{
+    int uffd;
+    int pagemap_fd;
+    size_t page_size;
+};
+
+static struct vkd3d_write_watch_tracker vkd3d_write_watch = { -1, -1, 0 };
+static pthread_once_t vkd3d_write_watch_once = PTHREAD_ONCE_INIT;
+
+static void vkd3d_write_watch_init_once(void)
+{
+    struct uffdio_api api;
+    int flags;
+    int uffd;
+
+    flags = O_CLOEXEC | O_NONBLOCK;
+#ifdef UFFD_USER_MODE_ONLY
+    /* Required for unprivileged use when vm.unprivileged_userfaultfd is 0. */
+    flags |= UFFD_USER_MODE_ONLY;
+#endif
+
+    if ((uffd = syscall(__NR_userfaultfd, flags)) < 0)
+    {
+        WARN("userfaultfd is not available, errno %d.\n", errno);
+        return;
+    }
+
+    memset(&api, 0, sizeof(api));
+    api.api = UFFD_API;
+    api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+
+    if (ioctl(uffd, UFFDIO_API, &api) < 0)
+    {
+        WARN("Asynchronous userfaultfd write protection is not supported, errno %d.\n", errno);
+        close(uffd);
+        return;
+    }
+
+    if ((vkd3d_write_watch.pagemap_fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC)) < 0)
+    {
+        WARN("Failed to open pagemap, errno %d.\n", errno);
+        close(uffd);
+        return;
+    }
+
+    vkd3d_write_watch.page_size = sysconf(_SC_PAGESIZE);
+    vkd3d_write_watch.uffd = uffd;
+    INFO("Using userfaultfd write protection for WRITE_WATCH heaps.\n");
+}
+
+static bool vkd3d_write_watch_is_supported(void)
+{
+    pthread_once(&vkd3d_write_watch_once, vkd3d_write_watch_init_once);
+    return vkd3d_write_watch.uffd >= 0;
+}
+
+static bool vkd3d_write_watch_protect(void *ptr, VkDeviceSize size)
+{
+    struct uffdio_writeprotect writeprotect;
+    struct uffdio_register reg;
+
+    memset(&reg, 0, sizeof(reg));
+    reg.range.start = (uintptr_t)ptr;
+    reg.range.len = size;
+    reg.mode = UFFDIO_REGISTER_MODE_WP;
+
+    if (ioctl(vkd3d_write_watch.uffd, UFFDIO_REGISTER, &reg) < 0)
+    {
+        ERR("Failed to register write watch range, errno %d.\n", errno);
+        return false;
+    }
+
+    /* Start out with every page clean, like a fresh MEM_WRITE_WATCH allocation. */
+    memset(&writeprotect, 0, sizeof(writeprotect));
+    writeprotect.range = reg.range;
+    writeprotect.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+
+    if (ioctl(vkd3d_write_watch.uffd, UFFDIO_WRITEPROTECT, &writeprotect) < 0)
+    {
+        ERR("Failed to write protect write watch range, errno %d.\n", errno);
+        return false;
+    }
+
+    return true;
+}
+#endif
+
 static void *vkd3d_allocate_write_watch_pointer(const D3D12_HEAP_PROPERTIES *properties, VkDeviceSize size)
 {
+#if defined(_WIN32) || defined(VKD3D_WRITE_WATCH_USERFAULTFD)
 #ifdef _WIN32
     DWORD protect;
+#endif
     void *ptr;
 
     switch (properties->Type)
@@ -967,7 +1371,9 @@ static void *vkd3d_allocate_write_watch_pointer(const D3D12_HEAP_PROPERTIES *pro
     case D3D12_HEAP_TYPE_DEFAULT:
         return NULL;
     case D3D12_HEAP_TYPE_UPLOAD:
+#ifdef _WIN32
         protect = PAGE_READWRITE | PAGE_WRITECOMBINE;
+#endif
         break;
     case D3D12_HEAP_TYPE_READBACK:
         /* WRITE_WATCH fails for this type in native D3D12,
@@ -981,10 +1387,14 @@ static void *vkd3d_allocate_write_watch_pointer(const D3D12_HEAP_PROPERTIES *pro
         case D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE:
             return NULL;
         case D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE:
+#ifdef _WIN32
             protect = PAGE_READWRITE | PAGE_WRITECOMBINE;
+#endif
             break;
         case D3D12_CPU_PAGE_PROPERTY_WRITE_BACK:
+#ifdef _WIN32
             protect = PAGE_READWRITE;
+#endif
             break;
         default:
             ERR("Invalid CPU page property %#x.\n", properties->CPUPageProperty);
@@ -996,11 +1406,32 @@ static void *vkd3d_allocate_write_watch_pointer(const D3D12_HEAP_PROPERTIES *pro
         return NULL;
     }
 
+#ifdef _WIN32
     if (!(ptr = VirtualAlloc(NULL, (SIZE_T)size, MEM_COMMIT | MEM_RESERVE | MEM_WRITE_WATCH, protect)))
     {
         ERR("Failed to allocate write watch pointer %#x.\n", GetLastError());
         return NULL;
     }
+#else
+    if (!vkd3d_write_watch_is_supported())
+    {
+        ERR("WRITE_WATCH requires asynchronous userfaultfd write protection.\n");
+        return NULL;
+    }
+
+    /* Write combining is a property of the imported VkDeviceMemory, it cannot be requested here. */
+    if ((ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+    {
+        ERR("Failed to allocate write watch pointer, errno %d.\n", errno);
+        return NULL;
+    }
+
+    if (!vkd3d_write_watch_protect(ptr, size))
+    {
+        munmap(ptr, size);
+        return NULL;
+    }
+#endif
 
     return ptr;
 #else
@@ -1012,14 +1443,112 @@ static void *vkd3d_allocate_write_watch_pointer(const D3D12_HEAP_PROPERTIES *pro
 #endif
 }
 
-static void vkd3d_free_write_watch_pointer(void *pointer)
+static void vkd3d_free_write_watch_pointer(void *pointer, VkDeviceSize size)
 {
 #ifdef _WIN32
+    (void)size;
     if (!VirtualFree(pointer, 0, MEM_RELEASE))
         ERR("Failed to free write watch pointer %#x.\n", GetLastError());
+#elif defined(VKD3D_WRITE_WATCH_USERFAULTFD)
+    /* Unmapping also drops the userfaultfd registration. */
+    if (munmap(pointer, size))
+        ERR("Failed to free write watch pointer, errno %d.\n", errno);
 #else
     /* Not supported on other platforms. */
     (void)pointer;
+    (void)size;
+#endif
+}
+
+HRESULT vkd3d_memory_allocation_get_write_watch(const struct vkd3d_memory_allocation *allocation,
+        bool reset, VkDeviceSize offset, VkDeviceSize size,
+        uint64_t *page_offsets, size_t *page_count, uint32_t *page_size)
+{
+#ifdef _WIN32
+    ULONG_PTR count = *page_count;
+    DWORD granularity;
+    void **addresses;
+    size_t i;
+
+    if (!(allocation->flags & VKD3D_ALLOCATION_FLAG_ALLOW_WRITE_WATCH))
+        return E_INVALIDARG;
+
+    if (!(addresses = vkd3d_malloc(max(count, 1) * sizeof(*addresses))))
+        return E_OUTOFMEMORY;
+
+    if (GetWriteWatch(reset ? WRITE_WATCH_FLAG_RESET : 0, void_ptr_offset(allocation->cpu_address, offset),
+            (SIZE_T)size, addresses, &count, &granularity))
+    {
+        ERR("Failed to query write watch %#x.\n", GetLastError());
+        vkd3d_free(addresses);
+        return E_FAIL;
+    }
+
+    for (i = 0; i < count; i++)
+        page_offsets[i] = (uintptr_t)addresses[i] - (uintptr_t)allocation->cpu_address;
+
+    vkd3d_free(addresses);
+    *page_count = count;
+    *page_size = granularity;
+    return S_OK;
+#elif defined(VKD3D_WRITE_WATCH_USERFAULTFD)
+    const uintptr_t base = (uintptr_t)allocation->cpu_address;
+    struct page_region regions[64];
+    size_t count = 0, max_count;
+    struct pm_scan_arg arg;
+    uint64_t start, end;
+    uint64_t address;
+    long i, ret;
+
+    if (!(allocation->flags & VKD3D_ALLOCATION_FLAG_ALLOW_WRITE_WATCH))
+        return E_INVALIDARG;
+
+    max_count = *page_count;
+    start = (base + offset) & ~(uint64_t)(vkd3d_write_watch.page_size - 1);
+    end = base + offset + size;
+
+    while (start < end && count < max_count)
+    {
+        memset(&arg, 0, sizeof(arg));
+        arg.size = sizeof(arg);
+        arg.flags = reset ? (PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC) : 0;
+        arg.start = start;
+        arg.end = end;
+        arg.vec = (uintptr_t)regions;
+        arg.vec_len = ARRAY_SIZE(regions);
+        /* Pages which do not fit in the output are left protected, matching GetWriteWatch(). */
+        arg.max_pages = max_count - count;
+        arg.category_mask = PAGE_IS_WRITTEN;
+        arg.return_mask = PAGE_IS_WRITTEN;
+
+        if ((ret = ioctl(vkd3d_write_watch.pagemap_fd, PAGEMAP_SCAN, &arg)) < 0)
+        {
+            ERR("Failed to scan write watch range, errno %d.\n", errno);
+            return E_FAIL;
+        }
+
+        for (i = 0; i < ret; i++)
+        {
+            for (address = regions[i].start; address < regions[i].end && count < max_count;
+                    address += vkd3d_write_watch.page_size)
+                page_offsets[count++] = address - base;
+        }
+
+        start = arg.walk_end;
+    }
+
+    *page_count = count;
+    *page_size = vkd3d_write_watch.page_size;
+    return S_OK;
+#else
+    (void)allocation;
+    (void)reset;
+    (void)offset;
+    (void)size;
+    (void)page_offsets;
+    (void)page_count;
+    (void)page_size;
+    return E_NOTIMPL;
 #endif
 }
 
@@ -1032,7 +1561,7 @@ static void vkd3d_memory_allocation_free(const struct vkd3d_memory_allocation *a
     vkd3d_descriptor_debug_unregister_cookie(device->descriptor_qa_global_info, allocation->resource.cookie);
 
     if (allocation->flags & VKD3D_ALLOCATION_FLAG_ALLOW_WRITE_WATCH)
-        vkd3d_free_write_watch_pointer(allocation->cpu_address);
+        vkd3d_free_write_watch_pointer(allocation->cpu_address, allocation->device_allocation.size);
 
     if ((allocation->flags & VKD3D_ALLOCATION_FLAG_GPU_ADDRESS) && allocation->resource.va &&
             !(allocation->flags & VKD3D_ALLOCATION_FLAG_INTERNAL_SCRATCH))
@@ -1077,7 +1606,7 @@ static HRESULT vkd3d_memory_allocation_init(struct vkd3d_memory_allocation *allo
 
     /* This also sort of validates the heap description,
      * so we want to do this before creating any objects */
-    if (FAILED(hr = vkd3d_select_memory_flags(device, &info->heap_properties, &type_flags)))
+    if (FAILED(hr = vkd3d_select_memory_flags(device, &info->heap_properties, info->flags, &type_flags)))
         return hr;
 
     /* Mask out optional memory properties as needed.
@@ -1260,30 +1789,143 @@ static HRESULT vkd3d_memory_allocation_init(struct vkd3d_memory_allocation *allo
     return S_OK;
 }
 
+struct vkd3d_memory_free_range_size_key
+{
+    VkDeviceSize length;
+    VkDeviceSize offset;
+};
+
+static int vkd3d_memory_free_range_compare_offset(const void *key, const struct rb_entry *entry)
+{
+    const struct vkd3d_memory_free_range *range = RB_ENTRY_VALUE(entry, const struct vkd3d_memory_free_range, offset_entry);
+    VkDeviceSize offset = *(const VkDeviceSize *)key;
+
+    if (offset != range->offset)
+        return offset < range->offset ? -1 : 1;
+    return 0;
+}
+
+static int vkd3d_memory_free_range_compare_size(const void *key, const struct rb_entry *entry)
+{
+    const struct vkd3d_memory_free_range *range = RB_ENTRY_VALUE(entry, const struct vkd3d_memory_free_range, size_entry);
+    const struct vkd3d_memory_free_range_size_key *k = key;
+
+    if (k->length != range->length)
+        return k->length < range->length ? -1 : 1;
+    if (k->offset != range->offset)
+        return k->offset < range->offset ? -1 : 1;
+    return 0;
+}
+
+static void vkd3d_memory_chunk_init_ranges(struct vkd3d_memory_chunk *chunk)
+{
+    rb_init(&chunk->free_ranges_by_offset, vkd3d_memory_free_range_compare_offset);
+    rb_init(&chunk->free_ranges_by_size, vkd3d_memory_free_range_compare_size);
+    list_init(&chunk->spare_ranges);
+    chunk->free_ranges_count = 0;
+    chunk->free_size = 0;
+}
+
+static void vkd3d_memory_free_range_destroy(struct rb_entry *entry, void *context)
+{
+    vkd3d_free(RB_ENTRY_VALUE(entry, struct vkd3d_memory_free_range, offset_entry));
+}
+
+static void vkd3d_memory_chunk_cleanup_ranges(struct vkd3d_memory_chunk *chunk)
+{
+    struct vkd3d_memory_free_range *range, *next;
+
+    rb_destroy(&chunk->free_ranges_by_offset, vkd3d_memory_free_range_destroy, NULL);
+    rb_init(&chunk->free_ranges_by_size, vkd3d_memory_free_range_compare_size);
+
+    LIST_FOR_EACH_ENTRY_SAFE(range, next, &chunk->spare_ranges, struct vkd3d_memory_free_range, spare_entry)
+        vkd3d_free(range);
+    list_init(&chunk->spare_ranges);
+}
+
+static void vkd3d_memory_chunk_insert_range_by_size(struct vkd3d_memory_chunk *chunk,
+        struct vkd3d_memory_free_range *range)
+{
+    struct vkd3d_memory_free_range_size_key key;
+
+    key.length = range->length;
+    key.offset = range->offset;
+    rb_put(&chunk->free_ranges_by_size, &key, &range->size_entry);
+}
+
 static void vkd3d_memory_chunk_insert_range(struct vkd3d_memory_chunk *chunk,
-        size_t index, VkDeviceSize offset, VkDeviceSize length)
+        VkDeviceSize offset, VkDeviceSize length)
 {
-    if (!vkd3d_array_reserve((void**)&chunk->free_ranges, &chunk->free_ranges_size,
-            chunk->free_ranges_count + 1, sizeof(*chunk->free_ranges)))
+    struct vkd3d_memory_free_range *range;
+
+    if (!list_empty(&chunk->spare_ranges))
+    {
+        range = LIST_ENTRY(list_head(&chunk->spare_ranges), struct vkd3d_memory_free_range, spare_entry);
+        list_remove(&range->spare_entry);
+    }
+    else if (!(range = vkd3d_malloc(sizeof(*range))))
     {
         ERR("Failed to insert free range.\n");
         return;
     }
 
-    memmove(&chunk->free_ranges[index + 1], &chunk->free_ranges[index],
-            sizeof(*chunk->free_ranges) * (chunk->free_ranges_count - index));
+    range->offset = offset;
+    range->length = length;
+
+    rb_put(&chunk->free_ranges_by_offset, &range->offset, &range->offset_entry);
+    vkd3d_memory_chunk_insert_range_by_size(chunk, range);
 
-    chunk->free_ranges[index].offset = offset;
-    chunk->free_ranges[index].length = length;
     chunk->free_ranges_count++;
+    chunk->free_size += length;
 }
 
-static void vkd3d_memory_chunk_remove_range(struct vkd3d_memory_chunk *chunk, size_t index)
+static void vkd3d_memory_chunk_remove_range(struct vkd3d_memory_chunk *chunk, struct vkd3d_memory_free_range *range)
 {
+    rb_remove(&chunk->free_ranges_by_offset, &range->offset_entry);
+    rb_remove(&chunk->free_ranges_by_size, &range->size_entry);
+
     chunk->free_ranges_count--;
+    chunk->free_size -= range->length;
+
+    list_add_head(&chunk->spare_ranges, &range->spare_entry);
+}
+
+static void vkd3d_memory_chunk_resize_range(struct vkd3d_memory_chunk *chunk, struct vkd3d_memory_free_range *range,
+        VkDeviceSize offset, VkDeviceSize length)
+{
+    /* The offset order is unaffected since a range never grows past its neighbours,
+     * but the size tree has to be re-keyed. */
+    rb_remove(&chunk->free_ranges_by_size, &range->size_entry);
+
+    chunk->free_size += length;
+    chunk->free_size -= range->length;
+    range->offset = offset;
+    range->length = length;
 
-    memmove(&chunk->free_ranges[index], &chunk->free_ranges[index + 1],
-            sizeof(*chunk->free_ranges) * (chunk->free_ranges_count - index));
+    vkd3d_memory_chunk_insert_range_by_size(chunk, range);
+}
+
+static struct vkd3d_memory_free_range *vkd3d_memory_chunk_find_best_fit(struct vkd3d_memory_chunk *chunk,
+        VkDeviceSize size)
+{
+    struct vkd3d_memory_free_range *range, *best = NULL;
+    struct rb_entry *entry = chunk->free_ranges_by_size.root;
+
+    /* Smallest free range which is at least as large as the requested size. */
+    while (entry)
+    {
+        range = RB_ENTRY_VALUE(entry, struct vkd3d_memory_free_range, size_entry);
+
+        if (range->length >= size)
+        {
+            best = range;
+            entry = entry->left;
+        }
+        else
+            entry = entry->right;
+    }
+
+    return best;
 }
 
 static HRESULT vkd3d_memory_chunk_allocate_range(struct vkd3d_memory_chunk *chunk, const VkMemoryRequirements *memory_requirements,
@@ -1291,36 +1933,20 @@ static HRESULT vkd3d_memory_chunk_allocate_range(struct vkd3d_memory_chunk *chun
 {
     struct vkd3d_memory_free_range *pick_range;
     VkDeviceSize l_length, r_length;
-    size_t i, pick_index;
+    struct rb_entry *entry;
 
-    if (!chunk->free_ranges_count)
+    if (chunk->free_size < memory_requirements->size)
         return E_OUTOFMEMORY;
 
-    pick_index = chunk->free_ranges_count;
-    pick_range = NULL;
+    /* Alignment is almost always going to be 64 KiB, so the first candidate
+     * will fit in practically all cases. Otherwise, keep walking to larger ranges. */
+    pick_range = vkd3d_memory_chunk_find_best_fit(chunk, memory_requirements->size);
 
-    for (i = 0; i < chunk->free_ranges_count; i++)
+    while (pick_range && pick_range->offset + pick_range->length <
+            align(pick_range->offset, memory_requirements->alignment) + memory_requirements->size)
     {
-        struct vkd3d_memory_free_range *range = &chunk->free_ranges[i];
-
-        if (range->offset + range->length < align(range->offset, memory_requirements->alignment) + memory_requirements->size)
-            continue;
-
-        /* Exact fit leaving no gaps */
-        if (range->length == memory_requirements->size)
-        {
-            pick_index = i;
-            pick_range = range;
-            break;
-        }
-
-        /* Alignment is almost always going to be 64 KiB, so
-         * don't worry too much about misalignment gaps here */
-        if (!pick_range || range->length > pick_range->length)
-        {
-            pick_index = i;
-            pick_range = range;
-        }
+        entry = rb_next(&pick_range->size_entry);
+        pick_range = entry ? RB_ENTRY_VALUE(entry, struct vkd3d_memory_free_range, size_entry) : NULL;
     }
 
     if (!pick_range)
@@ -1339,99 +1965,212 @@ static HRESULT vkd3d_memory_chunk_allocate_range(struct vkd3d_memory_chunk *chun
 
     if (l_length)
     {
-        pick_range->length = l_length;
+        vkd3d_memory_chunk_resize_range(chunk, pick_range, pick_range->offset, l_length);
 
         if (r_length)
         {
-            vkd3d_memory_chunk_insert_range(chunk, pick_index + 1,
+            vkd3d_memory_chunk_insert_range(chunk,
                 allocation->offset + allocation->resource.size, r_length);
         }
     }
     else if (r_length)
     {
-        pick_range->offset = allocation->offset + allocation->resource.size;
-        pick_range->length = r_length;
+        vkd3d_memory_chunk_resize_range(chunk, pick_range,
+                allocation->offset + allocation->resource.size, r_length);
     }
     else
     {
-        vkd3d_memory_chunk_remove_range(chunk, pick_index);
+        vkd3d_memory_chunk_remove_range(chunk, pick_range);
     }
 
     return S_OK;
 }
 
-static size_t vkd3d_memory_chunk_find_range(struct vkd3d_memory_chunk *chunk, VkDeviceSize offset)
+static void vkd3d_memory_chunk_find_neighbours(struct vkd3d_memory_chunk *chunk, VkDeviceSize offset,
+        struct vkd3d_memory_free_range **prev, struct vkd3d_memory_free_range **next)
 {
+    struct rb_entry *entry = chunk->free_ranges_by_offset.root;
     struct vkd3d_memory_free_range *range;
-    size_t index, hi, lo;
 
-    lo = 0;
-    hi = chunk->free_ranges_count;
+    *prev = NULL;
+    *next = NULL;
 
-    while (lo < hi)
+    while (entry)
     {
-        index = lo + (hi - lo) / 2;
-        range = &chunk->free_ranges[index];
+        range = RB_ENTRY_VALUE(entry, struct vkd3d_memory_free_range, offset_entry);
 
         if (range->offset > offset)
-            hi = index;
+        {
+            *next = range;
+            entry = entry->left;
+        }
         else
-            lo = index + 1;
+        {
+            *prev = range;
+            entry = entry->right;
+        }
     }
-
-    return lo;
 }
 
 static void vkd3d_memory_chunk_free_range(struct vkd3d_memory_chunk *chunk, const struct vkd3d_memory_allocation *allocation)
 {
-    struct vkd3d_memory_free_range *range;
+    struct vkd3d_memory_free_range *range_l, *range_r;
     bool adjacent_l, adjacent_r;
-    size_t index;
-
-    index = vkd3d_memory_chunk_find_range(chunk, allocation->offset);
-
-    adjacent_l = false;
-    adjacent_r = false;
 
-    if (index > 0)
-    {
-        range = &chunk->free_ranges[index - 1];
-        adjacent_l = range->offset + range->length == allocation->offset;
-    }
+    vkd3d_memory_chunk_find_neighbours(chunk, allocation->offset, &range_l, &range_r);
 
-    if (index < chunk->free_ranges_count)
-    {
-        range = &chunk->free_ranges[index];
-        adjacent_r = range->offset == allocation->offset + allocation->resource.size;
-    }
+    adjacent_l = range_l && range_l->offset + range_l->length == allocation->offset;
+    adjacent_r = range_r && range_r->offset == allocation->offset + allocation->resource.size;
 
     if (adjacent_l)
     {
-        range = &chunk->free_ranges[index - 1];
-        range->length += allocation->resource.size;
-
         if (adjacent_r)
         {
-            range->length += chunk->free_ranges[index].length;
-            vkd3d_memory_chunk_remove_range(chunk, index);
+            VkDeviceSize length = range_l->length + allocation->resource.size + range_r->length;
+            vkd3d_memory_chunk_remove_range(chunk, range_r);
+            vkd3d_memory_chunk_resize_range(chunk, range_l, range_l->offset, length);
+        }
+        else
+        {
+            vkd3d_memory_chunk_resize_range(chunk, range_l, range_l->offset,
+                    range_l->length + allocation->resource.size);
         }
     }
     else if (adjacent_r)
     {
-        range = &chunk->free_ranges[index];
-        range->offset = allocation->offset;
-        range->length += allocation->resource.size;
+        vkd3d_memory_chunk_resize_range(chunk, range_r, allocation->offset,
+                range_r->length + allocation->resource.size);
     }
     else
     {
-        vkd3d_memory_chunk_insert_range(chunk, index,
+        vkd3d_memory_chunk_insert_range(chunk,
                 allocation->offset, allocation->resource.size);
     }
 }
 
 static bool vkd3d_memory_chunk_is_free(struct vkd3d_memory_chunk *chunk)
 {
-    return chunk->free_ranges_count == 1 && chunk->free_ranges[0].length == chunk->allocation.resource.size;
+    return chunk->free_ranges_count == 1 && chunk->free_size == chunk->allocation.resource.size;
+}
+
+static VkDeviceSize vkd3d_memory_chunk_get_largest_free_range(struct vkd3d_memory_chunk *chunk)
+{
+    struct rb_entry *entry = chunk->free_ranges_by_size.root;
+
+    if (!entry)
+        return 0;
+
+    while (entry->right)
+        entry = entry->right;
+
+    return RB_ENTRY_VALUE(entry, struct vkd3d_memory_free_range, size_entry)->length;
+}
+
+static void vkd3d_memory_allocator_shard_accumulate_stats(struct vkd3d_memory_allocator_shard *shard,
+        struct vkd3d_memory_allocator_stats *stats)
+{
+    struct vkd3d_memory_chunk *chunk;
+    VkDeviceSize largest;
+    size_t i;
+
+    stats->chunk_count += shard->chunks_count;
+
+    for (i = 0; i < shard->chunks_count; i++)
+    {
+        chunk = shard->chunks[i];
+        stats->total_size += chunk->allocation.resource.size;
+        stats->free_size += chunk->free_size;
+        stats->free_range_count += chunk->free_ranges_count;
+
+        largest = vkd3d_memory_chunk_get_largest_free_range(chunk);
+        stats->largest_free_range = max(stats->largest_free_range, largest);
+    }
+}
+
+void vkd3d_memory_allocator_get_stats(struct vkd3d_memory_allocator *allocator,
+        struct vkd3d_memory_allocator_stats *stats)
+{
+    struct vkd3d_memory_allocator_shard *shard;
+    size_t i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (i = 0; i < ARRAY_SIZE(allocator->shards); i++)
+    {
+        shard = &allocator->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        vkd3d_memory_allocator_shard_accumulate_stats(shard, stats);
+        pthread_mutex_unlock(&shard->mutex);
+    }
+}
+
+static void vkd3d_memory_allocator_shard_log_stats_locked(struct vkd3d_memory_allocator *allocator,
+        struct vkd3d_memory_allocator_shard *shard)
+{
+    struct vkd3d_memory_allocator_stats stats;
+
+    memset(&stats, 0, sizeof(stats));
+    vkd3d_memory_allocator_shard_accumulate_stats(shard, &stats);
+
+    /* The ratio of free memory that is not part of the largest free range
+     * is a reasonable approximation of external fragmentation. */
+    INFO("Sub-allocator shard %u: %zu chunks, %"PRIu64" KiB free of %"PRIu64" KiB, %zu free ranges, "
+            "largest free range %"PRIu64" KiB, fragmentation %.1f%%.\n",
+            (unsigned int)(shard - allocator->shards),
+            stats.chunk_count, stats.free_size / 1024, stats.total_size / 1024,
+            stats.free_range_count, stats.largest_free_range / 1024,
+            stats.free_size ? 100.0 * (double)(stats.free_size - stats.largest_free_range) / (double)stats.free_size : 0.0);
+}
+
+static const char * const vkd3d_memory_footprint_category_names[VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT] =
+{
+    "descriptor heaps", "memory chunk slack", "scratch pools", "query pools",
+    "pipeline SPIR-V", "pipeline libraries", "view maps",
+};
+
+void vkd3d_memory_footprint_init(struct vkd3d_memory_footprint *footprint)
+{
+    memset(footprint, 0, sizeof(*footprint));
+    footprint->report_time_ns = vkd3d_get_current_time_ns();
+}
+
+void vkd3d_memory_footprint_get(struct vkd3d_memory_footprint *footprint, uint64_t *bytes)
+{
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT; i++)
+        bytes[i] = vkd3d_atomic_uint64_load_explicit(&footprint->bytes[i], vkd3d_memory_order_relaxed);
+}
+
+void vkd3d_memory_footprint_notify_frame(struct vkd3d_memory_footprint *footprint)
+{
+    uint64_t bytes[VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT];
+    uint64_t now_ns, report_time_ns;
+    unsigned int i;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET))
+        return;
+
+    now_ns = vkd3d_get_current_time_ns();
+    report_time_ns = vkd3d_atomic_uint64_load_explicit(&footprint->report_time_ns, vkd3d_memory_order_relaxed);
+    if (now_ns - report_time_ns < 1000000000ull)
+        return;
+
+    /* Multiple swapchains may present concurrently, only one of them gets to report. */
+    if (vkd3d_atomic_uint64_compare_exchange(&footprint->report_time_ns, report_time_ns, now_ns,
+            vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed) != report_time_ns)
+        return;
+
+    vkd3d_memory_footprint_get(footprint, bytes);
+    for (i = 0; i < VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT; i++)
+        INFO("Memory footprint (%s): %"PRIu64" KiB.\n", vkd3d_memory_footprint_category_names[i], bytes[i] / 1024);
+}
+
+static void vkd3d_memory_chunk_update_footprint(struct d3d12_device *device,
+        const struct vkd3d_memory_chunk *chunk, VkDeviceSize old_free_size)
+{
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_MEMORY_CHUNK_SLACK,
+            (int64_t)chunk->free_size - (int64_t)old_free_size);
 }
 
 static HRESULT vkd3d_memory_chunk_create(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
@@ -1446,6 +2185,7 @@ static HRESULT vkd3d_memory_chunk_create(struct d3d12_device *device, struct vkd
         return E_OUTOFMEMORY;
 
     memset(object, 0, sizeof(*object));
+    vkd3d_memory_chunk_init_ranges(object);
 
     if (FAILED(hr = vkd3d_memory_allocation_init(&object->allocation, device, allocator, info)))
     {
@@ -1462,7 +2202,8 @@ static HRESULT vkd3d_memory_chunk_create(struct d3d12_device *device, struct vkd
                 VK_OBJECT_TYPE_DEVICE_MEMORY, name_buffer);
     }
 
-    vkd3d_memory_chunk_insert_range(object, 0, 0, object->allocation.resource.size);
+    vkd3d_memory_chunk_insert_range(object, 0, object->allocation.resource.size);
+    vkd3d_memory_chunk_update_footprint(device, object, 0);
     *chunk = object;
 
     TRACE("Created chunk %p (allocation %p).\n", object, &object->allocation);
@@ -1477,19 +2218,22 @@ static void vkd3d_memory_chunk_destroy(struct vkd3d_memory_chunk *chunk, struct
         vkd3d_memory_transfer_queue_wait_allocation(&device->memory_transfers, &chunk->allocation);
 
     vkd3d_memory_allocation_free(&chunk->allocation, device, allocator);
-    vkd3d_free(chunk->free_ranges);
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_MEMORY_CHUNK_SLACK,
+            -(int64_t)chunk->free_size);
+    vkd3d_memory_chunk_cleanup_ranges(chunk);
     vkd3d_free(chunk);
 }
 
-static void vkd3d_memory_allocator_remove_chunk(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device, struct vkd3d_memory_chunk *chunk)
+static void vkd3d_memory_allocator_remove_chunk(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device,
+        struct vkd3d_memory_allocator_shard *shard, struct vkd3d_memory_chunk *chunk)
 {
     size_t i;
 
-    for (i = 0; i < allocator->chunks_count; i++)
+    for (i = 0; i < shard->chunks_count; i++)
     {
-        if (allocator->chunks[i] == chunk)
+        if (shard->chunks[i] == chunk)
         {
-            allocator->chunks[i] = allocator->chunks[--allocator->chunks_count];
+            shard->chunks[i] = shard->chunks[--shard->chunks_count];
             break;
         }
     }
@@ -1499,12 +2243,20 @@ static void vkd3d_memory_allocator_remove_chunk(struct vkd3d_memory_allocator *a
 
 HRESULT vkd3d_memory_allocator_init(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device)
 {
+    size_t i;
     int rc;
 
     memset(allocator, 0, sizeof(*allocator));
 
-    if ((rc = pthread_mutex_init(&allocator->mutex, NULL)))
-        return hresult_from_errno(rc);
+    for (i = 0; i < ARRAY_SIZE(allocator->shards); i++)
+    {
+        if ((rc = pthread_mutex_init(&allocator->shards[i].mutex, NULL)))
+        {
+            while (i--)
+                pthread_mutex_destroy(&allocator->shards[i].mutex);
+            return hresult_from_errno(rc);
+        }
+    }
 
     vkd3d_va_map_init(&allocator->va_map);
     return S_OK;
@@ -1512,20 +2264,49 @@ HRESULT vkd3d_memory_allocator_init(struct vkd3d_memory_allocator *allocator, st
 
 void vkd3d_memory_allocator_cleanup(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device)
 {
-    size_t i;
+    struct vkd3d_memory_allocator_shard *shard;
+    size_t i, j;
+
+    for (i = 0; i < ARRAY_SIZE(allocator->shards); i++)
+    {
+        shard = &allocator->shards[i];
 
-    for (i = 0; i < allocator->chunks_count; i++)
-        vkd3d_memory_chunk_destroy(allocator->chunks[i], device, allocator);
+        for (j = 0; j < shard->chunks_count; j++)
+            vkd3d_memory_chunk_destroy(shard->chunks[j], device, allocator);
+
+        vkd3d_free(shard->chunks);
+        pthread_mutex_destroy(&shard->mutex);
+    }
 
-    vkd3d_free(allocator->chunks);
     vkd3d_va_map_cleanup(&allocator->va_map);
-    pthread_mutex_destroy(&allocator->mutex);
+}
+
+static struct vkd3d_memory_allocator_shard *vkd3d_memory_allocator_get_shard(struct vkd3d_memory_allocator *allocator,
+        D3D12_HEAP_TYPE heap_type, VkDeviceSize size)
+{
+    unsigned int heap_index, size_class;
+
+    /* Chunks are never shared between heap types anyway, so splitting on heap type is free.
+     * Splitting on size class lets small streaming allocations on worker threads avoid
+     * contending with larger ones, and keeps small allocations from fragmenting chunks
+     * which larger allocations would otherwise be able to use. */
+    switch (heap_type)
+    {
+        case D3D12_HEAP_TYPE_DEFAULT: heap_index = 0; break;
+        case D3D12_HEAP_TYPE_UPLOAD: heap_index = 1; break;
+        case D3D12_HEAP_TYPE_READBACK: heap_index = 2; break;
+        default: heap_index = 3; break;
+    }
+
+    size_class = size > VKD3D_MEMORY_ALLOCATOR_SMALL_ALLOCATION_SIZE ? 1 : 0;
+    return &allocator->shards[heap_index * VKD3D_MEMORY_ALLOCATOR_SIZE_CLASS_COUNT + size_class];
 }
 
 static HRESULT vkd3d_memory_allocator_try_add_chunk(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device,
+        struct vkd3d_memory_allocator_shard *shard,
         const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags, uint32_t type_mask,
         VkMemoryPropertyFlags optional_properties,
-        VkBufferUsageFlags explicit_global_buffer_usage,
+        VkBufferUsageFlags explicit_global_buffer_usage, uint32_t allocation_flags,
         struct vkd3d_memory_chunk **chunk)
 {
     struct vkd3d_allocate_memory_info alloc_info;
@@ -1538,7 +2319,7 @@ static HRESULT vkd3d_memory_allocator_try_add_chunk(struct vkd3d_memory_allocato
     alloc_info.memory_requirements.memoryTypeBits = type_mask;
     alloc_info.heap_properties = *heap_properties;
     alloc_info.heap_flags = heap_flags;
-    alloc_info.flags = VKD3D_ALLOCATION_FLAG_NO_FALLBACK;
+    alloc_info.flags = VKD3D_ALLOCATION_FLAG_NO_FALLBACK | allocation_flags;
     alloc_info.optional_memory_properties = optional_properties;
     alloc_info.vk_memory_priority = vkd3d_convert_to_vk_prio(D3D12_RESIDENCY_PRIORITY_NORMAL);
 
@@ -1548,8 +2329,8 @@ static HRESULT vkd3d_memory_allocator_try_add_chunk(struct vkd3d_memory_allocato
         alloc_info.explicit_global_buffer_usage = explicit_global_buffer_usage;
     }
 
-    if (!vkd3d_array_reserve((void**)&allocator->chunks, &allocator->chunks_size,
-            allocator->chunks_count + 1, sizeof(*allocator->chunks)))
+    if (!vkd3d_array_reserve((void**)&shard->chunks, &shard->chunks_size,
+            shard->chunks_count + 1, sizeof(*shard->chunks)))
     {
         ERR("Failed to allocate space for new chunk.\n");
         return E_OUTOFMEMORY;
@@ -1558,56 +2339,103 @@ static HRESULT vkd3d_memory_allocator_try_add_chunk(struct vkd3d_memory_allocato
     if (FAILED(hr = vkd3d_memory_chunk_create(device, allocator, &alloc_info, &object)))
         return hr;
 
-    allocator->chunks[allocator->chunks_count++] = *chunk = object;
+    object->shard = shard;
+    shard->chunks[shard->chunks_count++] = *chunk = object;
+
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_LOG_MEMORY_BUDGET)
+        vkd3d_memory_allocator_shard_log_stats_locked(allocator, shard);
     return S_OK;
 }
 
+static int vkd3d_memory_chunk_compare_free_size(const void *a, const void *b)
+{
+    const struct vkd3d_memory_chunk *x = *(const struct vkd3d_memory_chunk * const *)a;
+    const struct vkd3d_memory_chunk *y = *(const struct vkd3d_memory_chunk * const *)b;
+
+    if (x->free_size != y->free_size)
+        return x->free_size < y->free_size ? -1 : 1;
+    return 0;
+}
+
 static HRESULT vkd3d_memory_allocator_try_suballocate_memory(struct vkd3d_memory_allocator *allocator,
-        struct d3d12_device *device, const VkMemoryRequirements *memory_requirements, uint32_t type_mask,
+        struct d3d12_device *device, struct vkd3d_memory_allocator_shard *shard,
+        const VkMemoryRequirements *memory_requirements, uint32_t type_mask,
         VkMemoryPropertyFlags optional_properties,
         const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags,
-        VkBufferUsageFlags explicit_global_buffer_usage,
+        VkBufferUsageFlags explicit_global_buffer_usage, uint32_t allocation_flags,
         struct vkd3d_memory_allocation *allocation)
 {
     const D3D12_HEAP_FLAGS heap_flag_mask = ~(D3D12_HEAP_FLAG_CREATE_NOT_ZEROED | D3D12_HEAP_FLAG_CREATE_NOT_RESIDENT);
     struct vkd3d_memory_chunk *chunk;
+    VkDeviceSize old_free_size;
     HRESULT hr;
     size_t i;
 
     type_mask &= memory_requirements->memoryTypeBits;
 
-    for (i = 0; i < allocator->chunks_count; i++)
+    /* Committed sub-allocations cannot be moved once created since their GPU VA is visible to the application.
+     * Instead, pack new allocations into the fullest chunks first, so that lightly used chunks
+     * are given the chance to drain completely and be released back to the driver. */
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_MEMORY_ALLOCATOR_PACK)
+        qsort(shard->chunks, shard->chunks_count, sizeof(*shard->chunks), vkd3d_memory_chunk_compare_free_size);
+
+    for (i = 0; i < shard->chunks_count; i++)
     {
-        chunk = allocator->chunks[i];
+        chunk = shard->chunks[i];
 
         /* Match flags since otherwise the backing buffer
          * may not support our required usage flags */
         if (chunk->allocation.heap_type != heap_properties->Type ||
                 chunk->allocation.explicit_global_buffer_usage != explicit_global_buffer_usage ||
-                chunk->allocation.heap_flags != (heap_flags & heap_flag_mask))
+                chunk->allocation.heap_flags != (heap_flags & heap_flag_mask) ||
+                (chunk->allocation.flags & VKD3D_ALLOCATION_FLAG_HOST_VISIBLE_VRAM) != allocation_flags)
             continue;
 
         /* Filter out unsupported memory types */
         if (!(type_mask & (1u << chunk->allocation.device_allocation.vk_memory_type)))
             continue;
 
+        old_free_size = chunk->free_size;
         if (SUCCEEDED(hr = vkd3d_memory_chunk_allocate_range(chunk, memory_requirements, allocation)))
+        {
+            vkd3d_memory_chunk_update_footprint(device, chunk, old_free_size);
             return hr;
+        }
     }
 
     /* Try allocating a new chunk on one of the supported memory type
      * before the caller falls back to potentially slower memory */
-    if (FAILED(hr = vkd3d_memory_allocator_try_add_chunk(allocator, device, heap_properties,
+    if (FAILED(hr = vkd3d_memory_allocator_try_add_chunk(allocator, device, shard, heap_properties,
             heap_flags & heap_flag_mask, type_mask, optional_properties,
-            explicit_global_buffer_usage, &chunk)))
+            explicit_global_buffer_usage, allocation_flags, &chunk)))
         return hr;
 
-    return vkd3d_memory_chunk_allocate_range(chunk, memory_requirements, allocation);
+    old_free_size = chunk->free_size;
+    if (SUCCEEDED(hr = vkd3d_memory_chunk_allocate_range(chunk, memory_requirements, allocation)))
+        vkd3d_memory_chunk_update_footprint(device, chunk, old_free_size);
+    return hr;
+}
+
+bool vkd3d_memory_allocation_is_write_combined(struct d3d12_device *device,
+        const struct vkd3d_memory_allocation *allocation)
+{
+    VkMemoryPropertyFlags flags;
+
+    if (!allocation->cpu_address)
+        return false;
+
+    /* Host-visible memory which is not host-cached is write-combined in practice.
+     * Plain stores to it are fine, but anything which reads cache lines back is not. */
+    flags = device->memory_properties.memoryTypes[allocation->device_allocation.vk_memory_type].propertyFlags;
+    return (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
 }
 
 void vkd3d_free_memory(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
         const struct vkd3d_memory_allocation *allocation)
 {
+    struct vkd3d_memory_allocator_shard *shard;
+    VkDeviceSize old_free_size;
+
     if (allocation->device_allocation.vk_memory == VK_NULL_HANDLE)
         return;
 
@@ -1616,49 +2444,116 @@ void vkd3d_free_memory(struct d3d12_device *device, struct vkd3d_memory_allocato
 
     if (allocation->chunk)
     {
-        pthread_mutex_lock(&allocator->mutex);
+        shard = allocation->chunk->shard;
+        pthread_mutex_lock(&shard->mutex);
+        old_free_size = allocation->chunk->free_size;
         vkd3d_memory_chunk_free_range(allocation->chunk, allocation);
+        vkd3d_memory_chunk_update_footprint(device, allocation->chunk, old_free_size);
 
         if (vkd3d_memory_chunk_is_free(allocation->chunk))
-            vkd3d_memory_allocator_remove_chunk(allocator, device, allocation->chunk);
-        pthread_mutex_unlock(&allocator->mutex);
+            vkd3d_memory_allocator_remove_chunk(allocator, device, shard, allocation->chunk);
+        pthread_mutex_unlock(&shard->mutex);
     }
     else
         vkd3d_memory_allocation_free(allocation, device, allocator);
 }
 
+/* Same as vkd3d_free_memory for every allocation, but keeps the shard lock held
+ * across consecutive allocations coming from the same shard. */
+void vkd3d_free_memory_batch(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
+        const struct vkd3d_memory_allocation * const *allocations, size_t count)
+{
+    struct vkd3d_memory_allocator_shard *locked_shard = NULL;
+    const struct vkd3d_memory_allocation *allocation;
+    VkDeviceSize old_free_size;
+    size_t i;
+
+    /* Wait for pending clears up front so that no shard lock is held while waiting. */
+    for (i = 0; i < count; i++)
+    {
+        allocation = allocations[i];
+
+        if (allocation->device_allocation.vk_memory != VK_NULL_HANDLE && allocation->clear_semaphore_value)
+            vkd3d_memory_transfer_queue_wait_allocation(&device->memory_transfers, allocation);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        allocation = allocations[i];
+
+        if (allocation->device_allocation.vk_memory == VK_NULL_HANDLE)
+            continue;
+
+        if (allocation->chunk)
+        {
+            if (locked_shard != allocation->chunk->shard)
+            {
+                if (locked_shard)
+                    pthread_mutex_unlock(&locked_shard->mutex);
+                locked_shard = allocation->chunk->shard;
+                pthread_mutex_lock(&locked_shard->mutex);
+            }
+
+            old_free_size = allocation->chunk->free_size;
+            vkd3d_memory_chunk_free_range(allocation->chunk, allocation);
+            vkd3d_memory_chunk_update_footprint(device, allocation->chunk, old_free_size);
+
+            if (vkd3d_memory_chunk_is_free(allocation->chunk))
+                vkd3d_memory_allocator_remove_chunk(allocator, device, locked_shard, allocation->chunk);
+        }
+        else
+        {
+            if (locked_shard)
+            {
+                pthread_mutex_unlock(&locked_shard->mutex);
+                locked_shard = NULL;
+            }
+
+            vkd3d_memory_allocation_free(allocation, device, allocator);
+        }
+    }
+
+    if (locked_shard)
+        pthread_mutex_unlock(&locked_shard->mutex);
+}
+
 static HRESULT vkd3d_suballocate_memory(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
         const struct vkd3d_allocate_memory_info *info, struct vkd3d_memory_allocation *allocation)
 {
+    const uint32_t allocation_flags = info->flags & VKD3D_ALLOCATION_FLAG_HOST_VISIBLE_VRAM;
     const VkMemoryPropertyFlags optional_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     VkMemoryRequirements memory_requirements = info->memory_requirements;
+    struct vkd3d_memory_allocator_shard *shard;
     uint32_t required_mask, optional_mask;
     VkMemoryPropertyFlags type_flags;
     HRESULT hr;
 
-    if (FAILED(hr = vkd3d_select_memory_flags(device, &info->heap_properties, &type_flags)))
+    if (FAILED(hr = vkd3d_select_memory_flags(device, &info->heap_properties, allocation_flags, &type_flags)))
         return hr;
 
     /* Prefer device-local memory if allowed for this allocation */
     required_mask = vkd3d_find_memory_types_with_flags(device, type_flags & ~optional_flags);
     optional_mask = vkd3d_find_memory_types_with_flags(device, type_flags);
 
-    pthread_mutex_lock(&allocator->mutex);
+    shard = vkd3d_memory_allocator_get_shard(allocator, info->heap_properties.Type, memory_requirements.size);
+    pthread_mutex_lock(&shard->mutex);
 
-    hr = vkd3d_memory_allocator_try_suballocate_memory(allocator, device,
+    hr = vkd3d_memory_allocator_try_suballocate_memory(allocator, device, shard,
             &memory_requirements, optional_mask, 0, &info->heap_properties,
-            info->heap_flags, info->explicit_global_buffer_usage, allocation);
+            info->heap_flags, info->explicit_global_buffer_usage, allocation_flags, allocation);
 
-    if (FAILED(hr) && (required_mask & ~optional_mask))
+    /* Host-visible VRAM is purely an optimization, the caller retries with
+     * plain DEFAULT memory rather than have us land in system memory. */
+    if (FAILED(hr) && (required_mask & ~optional_mask) && !allocation_flags)
     {
-        hr = vkd3d_memory_allocator_try_suballocate_memory(allocator, device,
+        hr = vkd3d_memory_allocator_try_suballocate_memory(allocator, device, shard,
                 &memory_requirements, required_mask & ~optional_mask,
                 optional_flags,
                 &info->heap_properties, info->heap_flags, info->explicit_global_buffer_usage,
-                allocation);
+                0, allocation);
     }
 
-    pthread_mutex_unlock(&allocator->mutex);
+    pthread_mutex_unlock(&shard->mutex);
     return hr;
 }
 
@@ -1792,7 +2687,8 @@ HRESULT vkd3d_allocate_heap_memory(struct d3d12_device *device, struct vkd3d_mem
     }
 
     hr = vkd3d_allocate_memory(device, allocator, &alloc_info, allocation);
-    if (hr == E_OUTOFMEMORY && vkd3d_heap_allocation_accept_deferred_resource_placements(device,
+    if (hr == E_OUTOFMEMORY && !(alloc_info.flags & VKD3D_ALLOCATION_FLAG_HOST_VISIBLE_VRAM) &&
+            vkd3d_heap_allocation_accept_deferred_resource_placements(device,
             &info->heap_desc.Properties, info->heap_desc.Flags))
     {
         /* It's okay and sometimes expected that we fail here.
@@ -279,6 +279,70 @@ static VkResult vkd3d_meta_create_graphics_pipeline(struct vkd3d_meta_ops *meta_
 }
 
 
+enum vkd3d_meta_pipeline_slot_state
+{
+    VKD3D_META_PIPELINE_SLOT_EMPTY = 0,
+    VKD3D_META_PIPELINE_SLOT_BUSY,
+    VKD3D_META_PIPELINE_SLOT_READY,
+};
+
+static void vkd3d_meta_pipeline_slot_init(struct vkd3d_meta_pipeline_slot *slot,
+        VkPipelineLayout vk_pipeline_layout, size_t code_size, const uint32_t *code,
+        const VkSpecializationInfo *spec_info)
+{
+    memset(slot, 0, sizeof(*slot));
+    slot->vk_pipeline_layout = vk_pipeline_layout;
+    slot->code = code;
+    slot->code_size = code_size;
+
+    /* Specialization data must outlive the slot. */
+    if ((slot->has_spec_info = !!spec_info))
+        slot->spec_info = *spec_info;
+}
+
+static VkPipeline vkd3d_meta_pipeline_slot_get(struct vkd3d_meta_pipeline_slot *slot,
+        struct d3d12_device *device)
+{
+    uint32_t state;
+    VkResult vr;
+
+    if (vkd3d_atomic_uint32_load_explicit(&slot->state, vkd3d_memory_order_acquire) == VKD3D_META_PIPELINE_SLOT_READY)
+        return slot->vk_pipeline;
+
+    state = vkd3d_atomic_uint32_compare_exchange(&slot->state,
+            VKD3D_META_PIPELINE_SLOT_EMPTY, VKD3D_META_PIPELINE_SLOT_BUSY,
+            vkd3d_memory_order_acquire, vkd3d_memory_order_acquire);
+
+    if (state == VKD3D_META_PIPELINE_SLOT_EMPTY)
+    {
+        if ((vr = vkd3d_meta_create_compute_pipeline(device, slot->code_size, slot->code, slot->vk_pipeline_layout,
+                slot->has_spec_info ? &slot->spec_info : NULL, true, &slot->vk_pipeline)) < 0)
+        {
+            /* Don't retry on every use, the driver is unlikely to change its mind. */
+            ERR("Failed to create meta pipeline, vr %d.\n", vr);
+            slot->vk_pipeline = VK_NULL_HANDLE;
+        }
+
+        vkd3d_atomic_uint32_store_explicit(&slot->state, VKD3D_META_PIPELINE_SLOT_READY, vkd3d_memory_order_release);
+    }
+    else
+    {
+        /* Another thread is compiling this pipeline right now. */
+        while (vkd3d_atomic_uint32_load_explicit(&slot->state, vkd3d_memory_order_acquire) != VKD3D_META_PIPELINE_SLOT_READY)
+            vkd3d_pause();
+    }
+
+    return slot->vk_pipeline;
+}
+
+static void vkd3d_meta_pipeline_slot_cleanup(struct vkd3d_meta_pipeline_slot *slot,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VK_CALL(vkDestroyPipeline(device->vk_device, slot->vk_pipeline, NULL));
+}
+
 HRESULT vkd3d_clear_uav_ops_init(struct vkd3d_clear_uav_ops *meta_clear_uav_ops,
         struct d3d12_device *device)
 {
@@ -300,7 +364,7 @@ HRESULT vkd3d_clear_uav_ops_init(struct vkd3d_clear_uav_ops *meta_clear_uav_ops,
     };
 
     struct {
-      VkPipeline *pipeline;
+      struct vkd3d_meta_pipeline_slot *pipeline;
       VkPipelineLayout *pipeline_layout;
       const uint32_t *code;
       size_t code_size;
@@ -381,14 +445,11 @@ HRESULT vkd3d_clear_uav_ops_init(struct vkd3d_clear_uav_ops *meta_clear_uav_ops,
         }
     }
 
+    /* Most applications only ever use a few of these, so compile them on demand. */
     for (i = 0; i < ARRAY_SIZE(pipelines); i++)
     {
-        if ((vr = vkd3d_meta_create_compute_pipeline(device, pipelines[i].code_size, pipelines[i].code,
-                *pipelines[i].pipeline_layout, NULL, true, pipelines[i].pipeline)) < 0)
-        {
-            ERR("Failed to create compute pipeline %u, vr %d.", i, vr);
-            goto fail;
-        }
+        vkd3d_meta_pipeline_slot_init(pipelines[i].pipeline, *pipelines[i].pipeline_layout,
+                pipelines[i].code_size, pipelines[i].code, NULL);
     }
 
     return S_OK;
@@ -418,13 +479,13 @@ void vkd3d_clear_uav_ops_cleanup(struct vkd3d_clear_uav_ops *meta_clear_uav_ops,
 
     for (i = 0; i < ARRAY_SIZE(pipeline_sets); i++)
     {
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->buffer, NULL));
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->buffer_raw, NULL));
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->image_1d, NULL));
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->image_2d, NULL));
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->image_3d, NULL));
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->image_1d_array, NULL));
-        VK_CALL(vkDestroyPipeline(device->vk_device, pipeline_sets[i]->image_2d_array, NULL));
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->buffer, device);
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->buffer_raw, device);
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->image_1d, device);
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->image_2d, device);
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->image_3d, device);
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->image_1d_array, device);
+        vkd3d_meta_pipeline_slot_cleanup(&pipeline_sets[i]->image_2d_array, device);
     }
 }
 
@@ -434,13 +495,14 @@ struct vkd3d_clear_uav_pipeline vkd3d_meta_get_clear_buffer_uav_pipeline(struct
     struct vkd3d_clear_uav_ops *meta_clear_uav_ops = &meta_ops->clear_uav;
     struct vkd3d_clear_uav_pipeline info;
 
-    const struct vkd3d_clear_uav_pipelines *pipelines = (as_uint || raw)
+    struct vkd3d_clear_uav_pipelines *pipelines = (as_uint || raw)
             ? &meta_clear_uav_ops->clear_uint
             : &meta_clear_uav_ops->clear_float;
 
     info.vk_set_layout = raw ? meta_clear_uav_ops->vk_set_layout_buffer_raw : meta_clear_uav_ops->vk_set_layout_buffer;
     info.vk_pipeline_layout = raw ? meta_clear_uav_ops->vk_pipeline_layout_buffer_raw : meta_clear_uav_ops->vk_pipeline_layout_buffer;
-    info.vk_pipeline = raw ? pipelines->buffer_raw : pipelines->buffer;
+    info.vk_pipeline = vkd3d_meta_pipeline_slot_get(raw ? &pipelines->buffer_raw : &pipelines->buffer,
+            meta_ops->device);
     return info;
 }
 
@@ -450,9 +512,10 @@ struct vkd3d_clear_uav_pipeline vkd3d_meta_get_clear_image_uav_pipeline(struct v
     struct vkd3d_clear_uav_ops *meta_clear_uav_ops = &meta_ops->clear_uav;
     struct vkd3d_clear_uav_pipeline info;
 
-    const struct vkd3d_clear_uav_pipelines *pipelines = as_uint
+    struct vkd3d_clear_uav_pipelines *pipelines = as_uint
             ? &meta_clear_uav_ops->clear_uint
             : &meta_clear_uav_ops->clear_float;
+    struct vkd3d_meta_pipeline_slot *slot;
 
     info.vk_set_layout = meta_clear_uav_ops->vk_set_layout_image;
     info.vk_pipeline_layout = meta_clear_uav_ops->vk_pipeline_layout_image;
@@ -460,25 +523,27 @@ struct vkd3d_clear_uav_pipeline vkd3d_meta_get_clear_image_uav_pipeline(struct v
     switch (image_view_type)
     {
         case VK_IMAGE_VIEW_TYPE_1D:
-            info.vk_pipeline = pipelines->image_1d;
+            slot = &pipelines->image_1d;
             break;
         case VK_IMAGE_VIEW_TYPE_2D:
-            info.vk_pipeline = pipelines->image_2d;
+            slot = &pipelines->image_2d;
             break;
         case VK_IMAGE_VIEW_TYPE_3D:
-            info.vk_pipeline = pipelines->image_3d;
+            slot = &pipelines->image_3d;
             break;
         case VK_IMAGE_VIEW_TYPE_1D_ARRAY:
-            info.vk_pipeline = pipelines->image_1d_array;
+            slot = &pipelines->image_1d_array;
             break;
         case VK_IMAGE_VIEW_TYPE_2D_ARRAY:
-            info.vk_pipeline = pipelines->image_2d_array;
+            slot = &pipelines->image_2d_array;
             break;
         default:
             ERR("Unhandled view type %d.\n", image_view_type);
             info.vk_pipeline = VK_NULL_HANDLE;
+            return info;
     }
 
+    info.vk_pipeline = vkd3d_meta_pipeline_slot_get(slot, meta_ops->device);
     return info;
 }
 
@@ -614,6 +679,18 @@ static HRESULT vkd3d_meta_create_swapchain_pipeline(struct vkd3d_meta_ops *meta_
     VkPipelineColorBlendStateCreateInfo cb_state;
     VkResult vr;
 
+    if (key->bind_point == VK_PIPELINE_BIND_POINT_COMPUTE)
+    {
+        /* The output format is implied by the storage image view, so one pipeline covers every format. */
+        if ((vr = vkd3d_meta_create_compute_pipeline(meta_ops->device,
+                sizeof(cs_swapchain_fullscreen), cs_swapchain_fullscreen,
+                meta_swapchain_ops->vk_compute_pipeline_layouts[key->filter], NULL, false, &pipeline->vk_pipeline)) < 0)
+            return hresult_from_vk_result(vr);
+
+        pipeline->key = *key;
+        return S_OK;
+    }
+
     memset(&cb_state, 0, sizeof(cb_state));
     memset(&blend_att, 0, sizeof(blend_att));
     cb_state.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -756,6 +833,17 @@ static HRESULT vkd3d_meta_create_copy_image_pipeline(struct vkd3d_meta_ops *meta
     return S_OK;
 }
 
+static bool vkd3d_copy_image_pipeline_key_equal(const struct vkd3d_copy_image_pipeline_key *a,
+        const struct vkd3d_copy_image_pipeline_key *b)
+{
+    /* Pipelines only depend on the Vulkan format, and different DXGI formats
+     * (e.g. typeless and typed depth formats) share the same one. */
+    return a->format->vk_format == b->format->vk_format &&
+            a->view_type == b->view_type &&
+            a->sample_count == b->sample_count &&
+            a->dst_aspect_mask == b->dst_aspect_mask;
+}
+
 HRESULT vkd3d_meta_get_copy_image_pipeline(struct vkd3d_meta_ops *meta_ops,
         const struct vkd3d_copy_image_pipeline_key *key, struct vkd3d_copy_image_info *info)
 {
@@ -778,7 +866,7 @@ HRESULT vkd3d_meta_get_copy_image_pipeline(struct vkd3d_meta_ops *meta_ops,
     {
         pipeline = &meta_copy_image_ops->pipelines[i];
 
-        if (!memcmp(key, &pipeline->key, sizeof(*key)))
+        if (vkd3d_copy_image_pipeline_key_equal(key, &pipeline->key))
         {
             info->vk_pipeline = pipeline->vk_pipeline;
             pthread_mutex_unlock(&meta_copy_image_ops->mutex);
@@ -790,10 +878,11 @@ HRESULT vkd3d_meta_get_copy_image_pipeline(struct vkd3d_meta_ops *meta_ops,
             meta_copy_image_ops->pipeline_count + 1, sizeof(*meta_copy_image_ops->pipelines)))
     {
         ERR("Failed to reserve space for pipeline.\n");
+        pthread_mutex_unlock(&meta_copy_image_ops->mutex);
         return E_OUTOFMEMORY;
     }
 
-    pipeline = &meta_copy_image_ops->pipelines[meta_copy_image_ops->pipeline_count++];
+    pipeline = &meta_copy_image_ops->pipelines[meta_copy_image_ops->pipeline_count];
 
     if (FAILED(hr = vkd3d_meta_create_copy_image_pipeline(meta_ops, key, pipeline)))
     {
@@ -801,6 +890,7 @@ HRESULT vkd3d_meta_get_copy_image_pipeline(struct vkd3d_meta_ops *meta_ops,
         return hr;
     }
 
+    meta_copy_image_ops->pipeline_count++;
     info->vk_pipeline = pipeline->vk_pipeline;
 
     pthread_mutex_unlock(&meta_copy_image_ops->mutex);
@@ -892,6 +982,8 @@ static void vkd3d_meta_ops_common_cleanup(struct vkd3d_meta_ops_common *meta_ops
 
 HRESULT vkd3d_swapchain_ops_init(struct vkd3d_swapchain_ops *meta_swapchain_ops, struct d3d12_device *device)
 {
+    VkDescriptorSetLayoutBinding compute_set_bindings[2];
+    VkPushConstantRange push_constant_range;
     VkDescriptorSetLayoutBinding set_binding;
     unsigned int i;
     VkResult vr;
@@ -932,6 +1024,31 @@ HRESULT vkd3d_swapchain_ops_init(struct vkd3d_swapchain_ops *meta_swapchain_ops,
             ERR("Failed to create pipeline layout, vr %d.\n", vr);
             goto fail;
         }
+
+        compute_set_bindings[0] = set_binding;
+        compute_set_bindings[1].binding = 1;
+        compute_set_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        compute_set_bindings[1].descriptorCount = 1;
+        compute_set_bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        compute_set_bindings[1].pImmutableSamplers = NULL;
+
+        if ((vr = vkd3d_meta_create_descriptor_set_layout(device, ARRAY_SIZE(compute_set_bindings), compute_set_bindings,
+                false, &meta_swapchain_ops->vk_compute_set_layouts[i])) < 0)
+        {
+            ERR("Failed to create descriptor set layout, vr %d.\n", vr);
+            goto fail;
+        }
+
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        push_constant_range.offset = 0;
+        push_constant_range.size = sizeof(struct vkd3d_swapchain_compute_args);
+
+        if ((vr = vkd3d_meta_create_pipeline_layout(device, 1, &meta_swapchain_ops->vk_compute_set_layouts[i],
+                1, &push_constant_range, &meta_swapchain_ops->vk_compute_pipeline_layouts[i])))
+        {
+            ERR("Failed to create pipeline layout, vr %d.\n", vr);
+            goto fail;
+        }
     }
 
     if ((vr = vkd3d_meta_create_shader_module(device, SPIRV_CODE(vs_swapchain_fullscreen), &meta_swapchain_ops->vk_vs_module)) < 0)
@@ -969,6 +1086,8 @@ void vkd3d_swapchain_ops_cleanup(struct vkd3d_swapchain_ops *meta_swapchain_ops,
     {
         VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, meta_swapchain_ops->vk_set_layouts[i], NULL));
         VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_swapchain_ops->vk_pipeline_layouts[i], NULL));
+        VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, meta_swapchain_ops->vk_compute_set_layouts[i], NULL));
+        VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_swapchain_ops->vk_compute_pipeline_layouts[i], NULL));
     }
 
     VK_CALL(vkDestroyShaderModule(device->vk_device, meta_swapchain_ops->vk_vs_module, NULL));
@@ -993,8 +1112,16 @@ HRESULT vkd3d_meta_get_swapchain_pipeline(struct vkd3d_meta_ops *meta_ops,
         return hresult_from_errno(rc);
     }
 
-    info->vk_set_layout = meta_swapchain_ops->vk_set_layouts[key->filter];
-    info->vk_pipeline_layout = meta_swapchain_ops->vk_pipeline_layouts[key->filter];
+    if (key->bind_point == VK_PIPELINE_BIND_POINT_COMPUTE)
+    {
+        info->vk_set_layout = meta_swapchain_ops->vk_compute_set_layouts[key->filter];
+        info->vk_pipeline_layout = meta_swapchain_ops->vk_compute_pipeline_layouts[key->filter];
+    }
+    else
+    {
+        info->vk_set_layout = meta_swapchain_ops->vk_set_layouts[key->filter];
+        info->vk_pipeline_layout = meta_swapchain_ops->vk_pipeline_layouts[key->filter];
+    }
 
     for (i = 0; i < meta_swapchain_ops->pipeline_count; i++)
     {
@@ -1072,6 +1199,16 @@ HRESULT vkd3d_query_ops_init(struct vkd3d_query_ops *meta_query_ops,
             meta_query_ops->vk_resolve_pipeline_layout, NULL, true, &meta_query_ops->vk_resolve_binary_pipeline)) < 0)
         goto fail;
 
+    push_constant_range.size = sizeof(struct vkd3d_query_resolve_batch_args);
+
+    if ((vr = vkd3d_meta_create_pipeline_layout(device, 0, NULL,
+            1, &push_constant_range, &meta_query_ops->vk_resolve_batch_pipeline_layout)) < 0)
+        goto fail;
+
+    if ((vr = vkd3d_meta_create_compute_pipeline(device, sizeof(cs_resolve_binary_queries_batch), cs_resolve_binary_queries_batch,
+            meta_query_ops->vk_resolve_batch_pipeline_layout, NULL, true, &meta_query_ops->vk_resolve_binary_batch_pipeline)) < 0)
+        goto fail;
+
     return S_OK;
 
 fail:
@@ -1090,6 +1227,8 @@ void vkd3d_query_ops_cleanup(struct vkd3d_query_ops *meta_query_ops,
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_query_ops->vk_gather_pipeline_layout, NULL));
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_query_ops->vk_resolve_pipeline_layout, NULL));
     VK_CALL(vkDestroyPipeline(device->vk_device, meta_query_ops->vk_resolve_binary_pipeline, NULL));
+    VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_query_ops->vk_resolve_batch_pipeline_layout, NULL));
+    VK_CALL(vkDestroyPipeline(device->vk_device, meta_query_ops->vk_resolve_binary_batch_pipeline, NULL));
 }
 
 bool vkd3d_meta_get_query_gather_pipeline(struct vkd3d_meta_ops *meta_ops,
@@ -1134,6 +1273,12 @@ HRESULT vkd3d_multi_dispatch_indirect_ops_init(
             &push_constant_range, &meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_state_layout)) < 0)
         goto fail;
 
+    push_constant_range.size = sizeof(struct vkd3d_execute_indirect_compact_args);
+
+    if ((vr = vkd3d_meta_create_pipeline_layout(device, 0, NULL, 1,
+            &push_constant_range, &meta_multi_dispatch_indirect_ops->vk_execute_indirect_compact_layout)) < 0)
+        goto fail;
+
     if ((vr = vkd3d_meta_create_compute_pipeline(device,
             sizeof(cs_execute_indirect_multi_dispatch), cs_execute_indirect_multi_dispatch,
             meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_layout, NULL, true,
@@ -1146,6 +1291,12 @@ HRESULT vkd3d_multi_dispatch_indirect_ops_init(
             &meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_state_pipeline)) < 0)
         goto fail;
 
+    if ((vr = vkd3d_meta_create_compute_pipeline(device,
+            sizeof(cs_execute_indirect_compact), cs_execute_indirect_compact,
+            meta_multi_dispatch_indirect_ops->vk_execute_indirect_compact_layout, NULL, true,
+            &meta_multi_dispatch_indirect_ops->vk_execute_indirect_compact_pipeline)) < 0)
+        goto fail;
+
     return S_OK;
 
 fail:
@@ -1162,10 +1313,14 @@ void vkd3d_multi_dispatch_indirect_ops_cleanup(
             meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_pipeline, NULL));
     VK_CALL(vkDestroyPipeline(device->vk_device,
             meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_state_pipeline, NULL));
+    VK_CALL(vkDestroyPipeline(device->vk_device,
+            meta_multi_dispatch_indirect_ops->vk_execute_indirect_compact_pipeline, NULL));
     VK_CALL(vkDestroyPipelineLayout(device->vk_device,
             meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_layout, NULL));
     VK_CALL(vkDestroyPipelineLayout(device->vk_device,
             meta_multi_dispatch_indirect_ops->vk_multi_dispatch_indirect_state_layout, NULL));
+    VK_CALL(vkDestroyPipelineLayout(device->vk_device,
+            meta_multi_dispatch_indirect_ops->vk_execute_indirect_compact_layout, NULL));
 }
 
 HRESULT vkd3d_predicate_ops_init(struct vkd3d_predicate_ops *meta_predicate_ops,
@@ -1215,13 +1370,14 @@ HRESULT vkd3d_predicate_ops_init(struct vkd3d_predicate_ops *meta_predicate_ops,
     spec_info.pMapEntries = spec_map;
     spec_info.dataSize = sizeof(struct spec_data);
 
+    /* Only needed when predication is emulated, so compile on demand. */
     for (i = 0; i < ARRAY_SIZE(spec_data); i++)
     {
         spec_info.pData = &spec_data[i];
 
-        if ((vr = vkd3d_meta_create_compute_pipeline(device, sizeof(cs_predicate_command), cs_predicate_command,
-                meta_predicate_ops->vk_command_pipeline_layout, &spec_info, true, &meta_predicate_ops->vk_command_pipelines[i])) < 0)
-            goto fail;
+        vkd3d_meta_pipeline_slot_init(&meta_predicate_ops->command_pipelines[i],
+                meta_predicate_ops->vk_command_pipeline_layout,
+                sizeof(cs_predicate_command), cs_predicate_command, &spec_info);
 
         meta_predicate_ops->data_sizes[i] = spec_data[i].arg_count * sizeof(uint32_t);
     }
@@ -1244,7 +1400,7 @@ void vkd3d_predicate_ops_cleanup(struct vkd3d_predicate_ops *meta_predicate_ops,
     size_t i;
 
     for (i = 0; i < VKD3D_PREDICATE_COMMAND_COUNT; i++)
-        VK_CALL(vkDestroyPipeline(device->vk_device, meta_predicate_ops->vk_command_pipelines[i], NULL));
+        vkd3d_meta_pipeline_slot_cleanup(&meta_predicate_ops->command_pipelines[i], device);
     VK_CALL(vkDestroyPipeline(device->vk_device, meta_predicate_ops->vk_resolve_pipeline, NULL));
 
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_predicate_ops->vk_command_pipeline_layout, NULL));
@@ -1254,10 +1410,11 @@ void vkd3d_predicate_ops_cleanup(struct vkd3d_predicate_ops *meta_predicate_ops,
 void vkd3d_meta_get_predicate_pipeline(struct vkd3d_meta_ops *meta_ops,
         enum vkd3d_predicate_command_type command_type, struct vkd3d_predicate_command_info *info)
 {
-    const struct vkd3d_predicate_ops *predicate_ops = &meta_ops->predicate;
+    struct vkd3d_predicate_ops *predicate_ops = &meta_ops->predicate;
 
     info->vk_pipeline_layout = predicate_ops->vk_command_pipeline_layout;
-    info->vk_pipeline = predicate_ops->vk_command_pipelines[command_type];
+    info->vk_pipeline = vkd3d_meta_pipeline_slot_get(&predicate_ops->command_pipelines[command_type],
+            meta_ops->device);
     info->data_size = predicate_ops->data_sizes[command_type];
 }
 
@@ -1275,6 +1432,54 @@ void vkd3d_meta_get_multi_dispatch_indirect_state_pipeline(struct vkd3d_meta_ops
     info->vk_pipeline_layout = meta_ops->multi_dispatch_indirect.vk_multi_dispatch_indirect_state_layout;
 }
 
+void vkd3d_meta_get_execute_indirect_compact_pipeline(struct vkd3d_meta_ops *meta_ops,
+        struct vkd3d_multi_dispatch_indirect_info *info)
+{
+    info->vk_pipeline = meta_ops->multi_dispatch_indirect.vk_execute_indirect_compact_pipeline;
+    info->vk_pipeline_layout = meta_ops->multi_dispatch_indirect.vk_execute_indirect_compact_layout;
+}
+
+HRESULT vkd3d_write_buffer_immediate_ops_init(struct vkd3d_write_buffer_immediate_ops *meta_wbi_ops,
+        struct d3d12_device *device)
+{
+    VkPushConstantRange push_constant_range;
+    VkResult vr;
+
+    memset(meta_wbi_ops, 0, sizeof(*meta_wbi_ops));
+    push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = sizeof(struct vkd3d_write_buffer_immediate_args);
+
+    if ((vr = vkd3d_meta_create_pipeline_layout(device, 0, NULL, 1,
+            &push_constant_range, &meta_wbi_ops->vk_pipeline_layout)) < 0)
+        return hresult_from_vk_result(vr);
+
+    if ((vr = vkd3d_meta_create_compute_pipeline(device, sizeof(cs_write_buffer_immediate), cs_write_buffer_immediate,
+            meta_wbi_ops->vk_pipeline_layout, NULL, true, &meta_wbi_ops->vk_pipeline)) < 0)
+    {
+        vkd3d_write_buffer_immediate_ops_cleanup(meta_wbi_ops, device);
+        return hresult_from_vk_result(vr);
+    }
+
+    return S_OK;
+}
+
+void vkd3d_write_buffer_immediate_ops_cleanup(struct vkd3d_write_buffer_immediate_ops *meta_wbi_ops,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VK_CALL(vkDestroyPipeline(device->vk_device, meta_wbi_ops->vk_pipeline, NULL));
+    VK_CALL(vkDestroyPipelineLayout(device->vk_device, meta_wbi_ops->vk_pipeline_layout, NULL));
+}
+
+void vkd3d_meta_get_write_buffer_immediate_pipeline(struct vkd3d_meta_ops *meta_ops,
+        struct vkd3d_write_buffer_immediate_info *info)
+{
+    info->vk_pipeline = meta_ops->write_buffer_immediate.vk_pipeline;
+    info->vk_pipeline_layout = meta_ops->write_buffer_immediate.vk_pipeline_layout;
+}
+
 HRESULT vkd3d_execute_indirect_ops_init(struct vkd3d_execute_indirect_ops *meta_indirect_ops,
         struct d3d12_device *device)
 {
@@ -1413,6 +1618,56 @@ void vkd3d_execute_indirect_ops_cleanup(struct vkd3d_execute_indirect_ops *meta_
     pthread_mutex_destroy(&meta_indirect_ops->mutex);
 }
 
+static void vkd3d_meta_prewarm_copy_image_pipelines(struct vkd3d_meta_ops *meta_ops)
+{
+    struct vkd3d_copy_image_pipeline_key key;
+    struct vkd3d_copy_image_info info;
+    unsigned int i;
+
+    /* Depth <-> color copies go through a draw, and single-sampled 2D ones are
+     * by far the most common, e.g. for depth readback or depth pyramids. */
+    static const struct
+    {
+        DXGI_FORMAT dxgi_format;
+        bool depth_stencil;
+        VkImageAspectFlags dst_aspect_mask;
+    }
+    copies[] =
+    {
+        { DXGI_FORMAT_R32_FLOAT, false, VK_IMAGE_ASPECT_COLOR_BIT },
+        { DXGI_FORMAT_R16_UNORM, false, VK_IMAGE_ASPECT_COLOR_BIT },
+        { DXGI_FORMAT_R8_UINT, false, VK_IMAGE_ASPECT_COLOR_BIT },
+        { DXGI_FORMAT_D32_FLOAT, true, VK_IMAGE_ASPECT_DEPTH_BIT },
+        { DXGI_FORMAT_D16_UNORM, true, VK_IMAGE_ASPECT_DEPTH_BIT },
+    };
+
+    for (i = 0; i < ARRAY_SIZE(copies); i++)
+    {
+        memset(&key, 0, sizeof(key));
+        if (!(key.format = vkd3d_get_format(meta_ops->device, copies[i].dxgi_format, copies[i].depth_stencil)))
+            continue;
+
+        key.view_type = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+        key.sample_count = VK_SAMPLE_COUNT_1_BIT;
+        key.dst_aspect_mask = copies[i].dst_aspect_mask;
+        vkd3d_meta_get_copy_image_pipeline(meta_ops, &key, &info);
+    }
+}
+
+static void vkd3d_meta_ops_prewarm_job(void *userdata)
+{
+    struct vkd3d_meta_ops *meta_ops = userdata;
+
+    /* Buffer clears are used by nearly every application, both for ClearUAV and
+     * internally, and 2D clears are by far the most common image clears. */
+    vkd3d_meta_get_clear_buffer_uav_pipeline(meta_ops, true, false);
+    vkd3d_meta_get_clear_buffer_uav_pipeline(meta_ops, true, true);
+    vkd3d_meta_get_clear_buffer_uav_pipeline(meta_ops, false, false);
+    vkd3d_meta_get_clear_image_uav_pipeline(meta_ops, VK_IMAGE_VIEW_TYPE_2D, false);
+    vkd3d_meta_get_clear_image_uav_pipeline(meta_ops, VK_IMAGE_VIEW_TYPE_2D, true);
+    vkd3d_meta_prewarm_copy_image_pipelines(meta_ops);
+}
+
 HRESULT vkd3d_meta_ops_init(struct vkd3d_meta_ops *meta_ops, struct d3d12_device *device)
 {
     HRESULT hr;
@@ -1444,8 +1699,19 @@ HRESULT vkd3d_meta_ops_init(struct vkd3d_meta_ops *meta_ops, struct d3d12_device
     if (FAILED(hr = vkd3d_multi_dispatch_indirect_ops_init(&meta_ops->multi_dispatch_indirect, device)))
         goto fail_multi_dispatch_indirect_ops;
 
+    if (FAILED(hr = vkd3d_write_buffer_immediate_ops_init(&meta_ops->write_buffer_immediate, device)))
+        goto fail_write_buffer_immediate_ops;
+
+    /* Pipelines are compiled on first use anyway, prewarming just moves that off the critical path. */
+    memset(&meta_ops->prewarm_job, 0, sizeof(meta_ops->prewarm_job));
+    meta_ops->prewarm_job.callback = vkd3d_meta_ops_prewarm_job;
+    meta_ops->prewarm_job.userdata = meta_ops;
+    vkd3d_job_pool_enqueue(&device->job_pool, &meta_ops->prewarm_job);
+
     return S_OK;
 
+fail_write_buffer_immediate_ops:
+    vkd3d_multi_dispatch_indirect_ops_cleanup(&meta_ops->multi_dispatch_indirect, device);
 fail_multi_dispatch_indirect_ops:
     vkd3d_execute_indirect_ops_cleanup(&meta_ops->execute_indirect, device);
 fail_execute_indirect_ops:
@@ -1466,6 +1732,9 @@ fail_common:
 
 HRESULT vkd3d_meta_ops_cleanup(struct vkd3d_meta_ops *meta_ops, struct d3d12_device *device)
 {
+    vkd3d_job_pool_wait(&device->job_pool, &meta_ops->prewarm_job);
+
+    vkd3d_write_buffer_immediate_ops_cleanup(&meta_ops->write_buffer_immediate, device);
     vkd3d_multi_dispatch_indirect_ops_cleanup(&meta_ops->multi_dispatch_indirect, device);
     vkd3d_execute_indirect_ops_cleanup(&meta_ops->execute_indirect, device);
     vkd3d_predicate_ops_cleanup(&meta_ops->predicate, device);
@@ -119,6 +119,7 @@ static void d3d12_state_object_cleanup(struct d3d12_state_object *object)
     }
     vkd3d_free(object->exports);
     vkd3d_free(object->entry_points);
+    hash_map_free(&object->export_map);
 
     for (i = 0; i < object->collections_count; i++)
         d3d12_state_object_dec_ref(object->collections[i]);
@@ -219,9 +220,81 @@ static bool vkd3d_export_equal(LPCWSTR export, const struct vkd3d_shader_library
             vkd3d_export_strequal(export, entry->plain_entry_point);
 }
 
+struct d3d12_state_object_export_key
+{
+    const WCHAR *name;
+    size_t length;
+};
+
+struct d3d12_state_object_export_entry
+{
+    struct hash_map_entry entry;
+    struct d3d12_state_object_export_key key;
+    uint32_t index;
+};
+
+static uint32_t d3d12_state_object_export_key_hash(const void *key)
+{
+    const struct d3d12_state_object_export_key *k = key;
+    uint64_t hash = hash_fnv1_init();
+    size_t i;
+
+    for (i = 0; i < k->length; i++)
+        hash = hash_fnv1_iterate_u32(hash, k->name[i]);
+
+    return hash_uint64(hash);
+}
+
+static bool d3d12_state_object_export_key_compare(const void *key, const struct hash_map_entry *entry)
+{
+    const struct d3d12_state_object_export_entry *e = (const struct d3d12_state_object_export_entry *)entry;
+    const struct d3d12_state_object_export_key *k = key;
+
+    return k->length == e->key.length && !memcmp(k->name, e->key.name, k->length * sizeof(*k->name));
+}
+
+static bool d3d12_state_object_export_map_insert(struct d3d12_state_object *object,
+        const WCHAR *name, uint32_t index)
+{
+    struct d3d12_state_object_export_entry entry;
+
+    if (!name)
+        return true;
+
+    entry.key.name = name;
+    entry.key.length = 0;
+    while (name[entry.key.length])
+        entry.key.length++;
+    entry.index = index;
+
+    /* If a name is exported more than once, the first export wins, like the linear scan. */
+    return !!hash_map_insert(&object->export_map, &entry.key, &entry.entry);
+}
+
+static void d3d12_state_object_build_export_map(struct d3d12_state_object *object)
+{
+    size_t i;
+
+    hash_map_init(&object->export_map, d3d12_state_object_export_key_hash,
+            d3d12_state_object_export_key_compare, sizeof(struct d3d12_state_object_export_entry));
+
+    for (i = 0; i < object->exports_count; i++)
+    {
+        if (!d3d12_state_object_export_map_insert(object, object->exports[i].mangled_export, i) ||
+                !d3d12_state_object_export_map_insert(object, object->exports[i].plain_export, i))
+        {
+            ERR("Failed to build export map, falling back to linear lookup.\n");
+            hash_map_free(&object->export_map);
+            return;
+        }
+    }
+}
+
 static uint32_t d3d12_state_object_get_export_index(struct d3d12_state_object *object,
         const WCHAR *export_name, const WCHAR **out_subtype)
 {
+    const struct d3d12_state_object_export_entry *entry;
+    struct d3d12_state_object_export_key key;
     const WCHAR *subtype = NULL;
     size_t i, n;
 
@@ -233,6 +306,20 @@ static uint32_t d3d12_state_object_get_export_index(struct d3d12_state_object *o
     if (export_name[n] == ':')
         subtype = export_name + n;
 
+    if (object->export_map.used_count)
+    {
+        key.name = export_name;
+        key.length = n;
+
+        if ((entry = (const struct d3d12_state_object_export_entry *)hash_map_find(&object->export_map, &key)))
+        {
+            *out_subtype = subtype;
+            return entry->index;
+        }
+
+        return UINT32_MAX;
+    }
+
     for (i = 0; i < object->exports_count; i++)
     {
         if (vkd3d_export_strequal_substr(export_name, n, object->exports[i].mangled_export) ||
@@ -1419,6 +1506,25 @@ static HRESULT d3d12_state_object_get_group_handles(struct d3d12_state_object *o
     for (i = 0; i < data->exports_count; i++)
     {
         group_index = data->exports[i].group_index;
+        collection_export = data->exports[i].inherited_collection_export_index;
+        collection_index = data->exports[i].inherited_collection_index;
+
+        /* With VK_EXT_pipeline_library_group_handles, handles of linked groups are guaranteed
+         * to be invariant, and stack sizes belong to shaders which were already compiled in the parent.
+         * Growing a pipeline through AddToStateObject() then only has to query what was actually added. */
+        if (collection_index >= 0 &&
+                object->device->device_info.pipeline_library_group_handles_features.pipelineLibraryGroupHandles)
+        {
+            const struct d3d12_state_object_identifier *parent_export;
+
+            parent_export = &data->collections[collection_index].object->exports[collection_export];
+            memcpy(data->exports[i].identifier, parent_export->identifier, sizeof(data->exports[i].identifier));
+            data->exports[i].stack_size_general = parent_export->stack_size_general;
+            data->exports[i].stack_size_any = parent_export->stack_size_any;
+            data->exports[i].stack_size_closest = parent_export->stack_size_closest;
+            data->exports[i].stack_size_intersection = parent_export->stack_size_intersection;
+            continue;
+        }
 
         if (vk_pipeline)
         {
@@ -1443,9 +1549,6 @@ static HRESULT d3d12_state_object_get_group_handles(struct d3d12_state_object *o
                 *(const uint64_t *)(data->exports[i].identifier + 16),
                 *(const uint64_t *)(data->exports[i].identifier + 24));
 
-        collection_export = data->exports[i].inherited_collection_export_index;
-        collection_index = data->exports[i].inherited_collection_index;
-
         if (collection_index >= 0)
         {
             const uint8_t *parent_identifier;
@@ -1657,6 +1760,221 @@ static bool d3d12_state_object_pipeline_data_find_global_state_objects(
     return true;
 }
 
+#define VKD3D_STATE_OBJECT_MAX_COMPILE_WORKERS 8
+
+struct d3d12_state_object_export_compile_job
+{
+    struct vkd3d_shader_interface_info shader_interface_info;
+    struct vkd3d_shader_interface_local_info shader_interface_local_info;
+    const struct vkd3d_shader_compile_arguments *compile_args;
+    struct vkd3d_shader_resource_binding *local_bindings;
+    const char *real_entry_point;
+    const char *debug_entry_point;
+    struct vkd3d_shader_code dxil;
+    struct vkd3d_shader_code spirv;
+    size_t stage_index;
+    int result;
+};
+
+struct d3d12_state_object_export_compile_pool
+{
+    struct d3d12_state_object_export_compile_job *jobs;
+    uint32_t job_count;
+    uint32_t next_job;
+};
+
+struct d3d12_state_object_deferred_join
+{
+    const struct vkd3d_vk_device_procs *vk_procs;
+    VkDevice vk_device;
+    VkDeferredOperationKHR vk_deferred_op;
+};
+
+struct d3d12_state_object_dxil_library_entry
+{
+    const void *code;
+    struct vkd3d_shader_dxil_library *library;
+};
+
+/* Parsed DXIL libraries are bound to the thread which parsed them,
+ * so every worker keeps its own set and reuses it across jobs. */
+struct d3d12_state_object_dxil_library_cache
+{
+    struct d3d12_state_object_dxil_library_entry *entries;
+    size_t entries_size;
+    size_t entry_count;
+};
+
+static struct vkd3d_shader_dxil_library *d3d12_state_object_dxil_library_cache_get(
+        struct d3d12_state_object_dxil_library_cache *cache, const struct vkd3d_shader_code *dxil)
+{
+    struct d3d12_state_object_dxil_library_entry *entry;
+    size_t i;
+
+    for (i = 0; i < cache->entry_count; i++)
+        if (cache->entries[i].code == dxil->code)
+            return cache->entries[i].library;
+
+    if (!vkd3d_array_reserve((void **)&cache->entries, &cache->entries_size,
+            cache->entry_count + 1, sizeof(*cache->entries)))
+        return NULL;
+
+    entry = &cache->entries[cache->entry_count];
+    entry->code = dxil->code;
+    if (vkd3d_shader_dxil_library_create(dxil, &entry->library) < 0)
+        entry->library = NULL;
+
+    /* Remember failures too, so we don't attempt to parse a broken library for every export. */
+    cache->entry_count++;
+    return entry->library;
+}
+
+static void d3d12_state_object_dxil_library_cache_cleanup(struct d3d12_state_object_dxil_library_cache *cache)
+{
+    size_t i;
+
+    for (i = 0; i < cache->entry_count; i++)
+        vkd3d_shader_dxil_library_destroy(cache->entries[i].library);
+    vkd3d_free(cache->entries);
+}
+
+static void *d3d12_state_object_export_compile_worker_main(void *userdata)
+{
+    struct d3d12_state_object_export_compile_pool *pool = userdata;
+    struct d3d12_state_object_dxil_library_cache library_cache;
+    struct d3d12_state_object_export_compile_job *job;
+    struct vkd3d_shader_dxil_library *library;
+    uint32_t index;
+
+    memset(&library_cache, 0, sizeof(library_cache));
+
+    while ((index = vkd3d_atomic_uint32_increment(&pool->next_job, vkd3d_memory_order_relaxed) - 1) < pool->job_count)
+    {
+        job = &pool->jobs[index];
+
+        if ((library = d3d12_state_object_dxil_library_cache_get(&library_cache, &job->dxil)))
+        {
+            job->result = vkd3d_shader_compile_dxil_library_export(library,
+                    job->real_entry_point, job->debug_entry_point,
+                    &job->spirv, NULL,
+                    &job->shader_interface_info, &job->shader_interface_local_info, job->compile_args);
+        }
+        else
+        {
+            job->result = vkd3d_shader_compile_dxil_export(&job->dxil,
+                    job->real_entry_point, job->debug_entry_point,
+                    &job->spirv, NULL,
+                    &job->shader_interface_info, &job->shader_interface_local_info, job->compile_args);
+        }
+    }
+
+    d3d12_state_object_dxil_library_cache_cleanup(&library_cache);
+    return NULL;
+}
+
+static void *d3d12_state_object_deferred_join_worker_main(void *userdata)
+{
+    struct d3d12_state_object_deferred_join *join = userdata;
+    const struct vkd3d_vk_device_procs *vk_procs = join->vk_procs;
+    VkResult vr;
+
+    /* THREAD_IDLE means more work might show up later, THREAD_DONE means this thread is no longer needed. */
+    while ((vr = VK_CALL(vkDeferredOperationJoinKHR(join->vk_device, join->vk_deferred_op))) == VK_THREAD_IDLE_KHR)
+        vkd3d_pause();
+
+    return NULL;
+}
+
+static void d3d12_state_object_run_compile_workers(void *(*worker_main)(void *), void *userdata,
+        unsigned int worker_count)
+{
+    pthread_t threads[VKD3D_STATE_OBJECT_MAX_COMPILE_WORKERS - 1];
+    unsigned int thread_count = 0;
+    unsigned int i;
+
+    /* The calling thread participates, so only spawn helpers for the remainder.
+     * If we fail to spawn threads, the work just ends up more serialized. */
+    worker_count = min(worker_count, VKD3D_STATE_OBJECT_MAX_COMPILE_WORKERS);
+    for (i = 1; i < worker_count; i++)
+    {
+        if (pthread_create(&threads[thread_count], NULL, worker_main, userdata) != 0)
+        {
+            WARN("Failed to create compile worker thread.\n");
+            break;
+        }
+        thread_count++;
+    }
+
+    worker_main(userdata);
+
+    for (i = 0; i < thread_count; i++)
+        pthread_join(threads[i], NULL);
+}
+
+static void d3d12_state_object_free_compile_jobs(struct d3d12_state_object_export_compile_job *jobs,
+        size_t job_count)
+{
+    size_t i;
+
+    if (!jobs)
+        return;
+
+    for (i = 0; i < job_count; i++)
+    {
+        vkd3d_shader_free_shader_code(&jobs[i].spirv);
+        vkd3d_free(jobs[i].local_bindings);
+    }
+
+    vkd3d_free(jobs);
+}
+
+static VkResult d3d12_state_object_create_vk_pipeline(struct d3d12_state_object *object,
+        const VkRayTracingPipelineCreateInfoKHR *create_info, VkPipeline *vk_pipeline)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &object->device->vk_procs;
+    struct d3d12_state_object_deferred_join join;
+    uint32_t concurrency;
+    VkResult vr;
+
+    if (!object->device->vk_info.KHR_deferred_host_operations)
+    {
+        return VK_CALL(vkCreateRayTracingPipelinesKHR(object->device->vk_device, VK_NULL_HANDLE,
+                VK_NULL_HANDLE, 1, create_info, NULL, vk_pipeline));
+    }
+
+    join.vk_procs = vk_procs;
+    join.vk_device = object->device->vk_device;
+
+    if ((vr = VK_CALL(vkCreateDeferredOperationKHR(join.vk_device, NULL, &join.vk_deferred_op))) < 0)
+    {
+        WARN("Failed to create deferred operation, vr %d.\n", vr);
+        return VK_CALL(vkCreateRayTracingPipelinesKHR(object->device->vk_device, VK_NULL_HANDLE,
+                VK_NULL_HANDLE, 1, create_info, NULL, vk_pipeline));
+    }
+
+    vr = VK_CALL(vkCreateRayTracingPipelinesKHR(object->device->vk_device, join.vk_deferred_op,
+            VK_NULL_HANDLE, 1, create_info, NULL, vk_pipeline));
+
+    if (vr == VK_OPERATION_DEFERRED_KHR)
+    {
+        concurrency = VK_CALL(vkGetDeferredOperationMaxConcurrencyKHR(join.vk_device, join.vk_deferred_op));
+        TRACE("Joining deferred pipeline compile with %u threads.\n",
+                min(max(concurrency, 1u), VKD3D_STATE_OBJECT_MAX_COMPILE_WORKERS));
+        d3d12_state_object_run_compile_workers(d3d12_state_object_deferred_join_worker_main, &join,
+                max(concurrency, 1u));
+
+        /* Every joined thread has returned, but be defensive in case the implementation
+         * still reports the operation as pending. */
+        while ((vr = VK_CALL(vkGetDeferredOperationResultKHR(join.vk_device, join.vk_deferred_op))) == VK_NOT_READY)
+            d3d12_state_object_deferred_join_worker_main(&join);
+    }
+    else if (vr == VK_OPERATION_NOT_DEFERRED_KHR)
+        vr = VK_SUCCESS;
+
+    VK_CALL(vkDestroyDeferredOperationKHR(join.vk_device, join.vk_deferred_op, NULL));
+    return vr;
+}
+
 static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *object,
         struct d3d12_state_object_pipeline_data *data)
 {
@@ -1684,8 +2002,10 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
     VkPipelineShaderStageCreateInfo *stage;
     uint32_t pgroup_offset, pstage_offset;
     unsigned int num_groups_to_export;
+    struct d3d12_state_object_export_compile_job *jobs = NULL;
+    struct d3d12_state_object_export_compile_job *job;
+    struct d3d12_state_object_export_compile_pool pool;
     struct vkd3d_shader_code spirv;
-    struct vkd3d_shader_code dxil;
     size_t i, j;
     VkResult vr;
     HRESULT hr;
@@ -1759,6 +2079,9 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
     if (object->device->debug_ring.active)
         data->spec_info_buffer = vkd3d_calloc(data->entry_points_count, sizeof(*data->spec_info_buffer));
 
+    if (data->entry_points_count && !(jobs = vkd3d_calloc(data->entry_points_count, sizeof(*jobs))))
+        return E_OUTOFMEMORY;
+
     for (i = 0; i < data->entry_points_count; i++)
     {
         entry = &data->entry_points[i];
@@ -1854,24 +2177,48 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
         stage->pName = "main";
         stage->pSpecializationInfo = NULL;
 
-        memset(&dxil, 0, sizeof(dxil));
-        memset(&spirv, 0, sizeof(spirv));
+        job = &jobs[i];
+        job->stage_index = data->stages_count;
+        job->real_entry_point = entry->real_entry_point;
+        job->debug_entry_point = entry->debug_entry_point;
+        job->shader_interface_info = shader_interface_info;
+        job->shader_interface_local_info = shader_interface_local_info;
+        job->local_bindings = local_bindings;
+        job->compile_args = &compile_args;
 
         /* TODO: If we're exporting multiple entry points from one DXIL library,
          * we can amortize the parsing cost. */
-        dxil.code = data->dxil_libraries[entry->identifier]->DXILLibrary.pShaderBytecode;
-        dxil.size = data->dxil_libraries[entry->identifier]->DXILLibrary.BytecodeLength;
+        job->dxil.code = data->dxil_libraries[entry->identifier]->DXILLibrary.pShaderBytecode;
+        job->dxil.size = data->dxil_libraries[entry->identifier]->DXILLibrary.BytecodeLength;
+
+        /* The module is filled in once the export is compiled. */
+        data->stages_count++;
+    }
+
+    /* Exports are independent of each other, so they can be translated concurrently.
+     * Everything that touches the state object itself happens in order afterwards. */
+    pool.jobs = jobs;
+    pool.job_count = data->entry_points_count;
+    pool.next_job = 0;
+    d3d12_state_object_run_compile_workers(d3d12_state_object_export_compile_worker_main, &pool,
+            min(pool.job_count, VKD3D_STATE_OBJECT_MAX_COMPILE_WORKERS));
+
+    for (i = 0; i < data->entry_points_count; i++)
+    {
+        job = &jobs[i];
+        entry = &data->entry_points[i];
+        stage = &data->stages[job->stage_index];
 
-        if (vkd3d_shader_compile_dxil_export(&dxil, entry->real_entry_point, entry->debug_entry_point,
-                &spirv, NULL,
-                &shader_interface_info, &shader_interface_local_info, &compile_args) != VKD3D_OK)
+        if (job->result != VKD3D_OK)
         {
             ERR("Failed to convert DXIL export: %s (%s)\n",
                     entry->real_entry_point, entry->debug_entry_point);
-            vkd3d_free(local_bindings);
+            d3d12_state_object_free_compile_jobs(jobs, data->entry_points_count);
             return E_OUTOFMEMORY;
         }
 
+        spirv = job->spirv;
+
         if ((spirv.meta.flags & VKD3D_SHADER_META_FLAG_REPLACED) && data->spec_info_buffer)
         {
             vkd3d_shader_debug_ring_init_spec_constant(object->device, &data->spec_info_buffer[i], spirv.meta.hash);
@@ -1891,9 +2238,11 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
         object->breadcrumb_shaders_count++;
 #endif
 
-        vkd3d_free(local_bindings);
         if (!d3d12_device_validate_shader_meta(object->device, &spirv.meta))
+        {
+            d3d12_state_object_free_compile_jobs(jobs, data->entry_points_count);
             return E_INVALIDARG;
+        }
 
         stage->module = create_shader_module(object->device, spirv.code, spirv.size);
 
@@ -1902,13 +2251,16 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
             stage->flags |= VK_PIPELINE_SHADER_STAGE_CREATE_ALLOW_VARYING_SUBGROUP_SIZE_BIT;
         }
 
-        vkd3d_shader_free_shader_code(&spirv);
         if (!stage->module)
+        {
+            d3d12_state_object_free_compile_jobs(jobs, data->entry_points_count);
             return E_OUTOFMEMORY;
-
-        data->stages_count++;
+        }
     }
 
+    d3d12_state_object_free_compile_jobs(jobs, data->entry_points_count);
+    jobs = NULL;
+
     for (i = 0; i < data->hit_groups_count; i++)
     {
         hit_group = data->hit_groups[i];
@@ -2189,10 +2541,9 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
 
     TRACE("Calling vkCreateRayTracingPipelinesKHR.\n");
 
-    vr = VK_CALL(vkCreateRayTracingPipelinesKHR(object->device->vk_device, VK_NULL_HANDLE,
-            VK_NULL_HANDLE, 1, &pipeline_create_info, NULL,
+    vr = d3d12_state_object_create_vk_pipeline(object, &pipeline_create_info,
             (pipeline_create_info.flags & VK_PIPELINE_CREATE_LIBRARY_BIT_KHR) ?
-                    &object->pipeline_library : &object->pipeline));
+                    &object->pipeline_library : &object->pipeline);
 
     if (vr == VK_SUCCESS && (object->flags & D3D12_STATE_OBJECT_FLAG_ALLOW_STATE_OBJECT_ADDITIONS) &&
             object->type == D3D12_STATE_OBJECT_TYPE_RAYTRACING_PIPELINE)
@@ -2239,6 +2590,8 @@ static HRESULT d3d12_state_object_compile_pipeline(struct d3d12_state_object *ob
     data->exports_size = 0;
     data->exports_count = 0;
 
+    d3d12_state_object_build_export_map(object);
+
     object->shader_config = shader_config;
     object->pipeline_config = pipeline_config;
 
@@ -128,6 +128,7 @@ HRESULT vkd3d_create_buffer(struct d3d12_device *device,
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     VkExternalMemoryBufferCreateInfo external_info;
+    VkBufferUsageFlags2CreateInfoKHR usage_info;
     const bool sparse_resource = !heap_properties;
     VkBufferCreateInfo buffer_info;
     D3D12_HEAP_TYPE heap_type;
@@ -228,6 +229,16 @@ HRESULT vkd3d_create_buffer(struct d3d12_device *device,
     if (desc->Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
         FIXME("Unsupported resource flags %#x.\n", desc->Flags);
 
+    /* Indirect preprocess scratch is suballocated from default heap buffers. */
+    if (heap_type == D3D12_HEAP_TYPE_DEFAULT && !sparse_resource &&
+            device->device_info.device_generated_commands_features_ext.deviceGeneratedCommands)
+    {
+        usage_info.sType = VK_STRUCTURE_TYPE_BUFFER_USAGE_FLAGS_2_CREATE_INFO_KHR;
+        usage_info.pNext = NULL;
+        usage_info.usage = buffer_info.usage | VK_BUFFER_USAGE_2_PREPROCESS_BUFFER_BIT_EXT;
+        vk_prepend_struct(&buffer_info, &usage_info);
+    }
+
     if ((vr = VK_CALL(vkCreateBuffer(device->vk_device, &buffer_info, NULL, vk_buffer))) < 0)
     {
         WARN("Failed to create Vulkan buffer, vr %d.\n", vr);
@@ -493,10 +504,9 @@ struct vkd3d_image_create_info
     VkImageCreateInfo image_info;
 };
 
-static HRESULT vkd3d_get_image_create_info(struct d3d12_device *device,
-        const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags,
-        const D3D12_RESOURCE_DESC1 *desc, struct d3d12_resource *resource,
-        struct vkd3d_image_create_info *create_info)
+static HRESULT vkd3d_get_image_create_info_uncached(struct d3d12_device *device,
+        const D3D12_HEAP_PROPERTIES *heap_properties, const D3D12_RESOURCE_DESC1 *desc,
+        struct d3d12_resource *resource, struct vkd3d_image_create_info *create_info)
 {
     struct vkd3d_format_compatibility_list *compat_list = &create_info->format_compat_list;
     VkExternalMemoryImageCreateInfo *external_info = &create_info->external_info;
@@ -720,6 +730,101 @@ static HRESULT vkd3d_get_image_create_info(struct d3d12_device *device,
         }
     }
 
+    return S_OK;
+}
+
+struct vkd3d_image_create_info_cache_key
+{
+    D3D12_RESOURCE_DESC1 desc;
+    uint32_t cpu_accessible;
+};
+
+struct vkd3d_image_create_info_cache_entry
+{
+    spinlock_t lock;
+    bool valid;
+    struct vkd3d_image_create_info_cache_key key;
+    struct vkd3d_image_create_info create_info;
+};
+
+HRESULT vkd3d_image_create_info_cache_init(struct vkd3d_image_create_info_cache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    /* Zeroed entries are unlocked and invalid. */
+    if (!(cache->entries = vkd3d_calloc(VKD3D_IMAGE_CREATE_INFO_CACHE_SIZE, sizeof(*cache->entries))))
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
+void vkd3d_image_create_info_cache_cleanup(struct vkd3d_image_create_info_cache *cache)
+{
+    TRACE("Image create info cache: %"PRIu64" hits, %"PRIu64" misses.\n",
+            cache->hit_count, cache->miss_count);
+
+    vkd3d_free(cache->entries);
+}
+
+static void vkd3d_image_allocation_info_cache_normalize_desc(D3D12_RESOURCE_DESC1 *key,
+        const D3D12_RESOURCE_DESC1 *desc);
+
+static void vkd3d_image_create_info_copy(struct vkd3d_image_create_info *dst,
+        const struct vkd3d_image_create_info *src)
+{
+    bool has_format_list = src->image_info.pNext == &src->format_list;
+
+    /* The chain points into the struct itself, so it has to be relocated. Cached
+     * infos never carry external memory info, so the format list is all there is. */
+    *dst = *src;
+    dst->image_info.pNext = has_format_list ? &dst->format_list : NULL;
+    dst->format_list.pViewFormats = dst->format_compat_list.vk_formats;
+}
+
+static HRESULT vkd3d_get_image_create_info(struct d3d12_device *device,
+        const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags,
+        const D3D12_RESOURCE_DESC1 *desc, struct d3d12_resource *resource,
+        struct vkd3d_image_create_info *create_info)
+{
+    struct vkd3d_image_create_info_cache *cache = &device->image_create_info_cache;
+    struct vkd3d_image_create_info_cache_entry *entry = NULL;
+    struct vkd3d_image_create_info_cache_key key;
+    bool hit = false;
+    HRESULT hr;
+
+    if (heap_properties && !(resource && (resource->heap_flags & D3D12_HEAP_FLAG_SHARED)))
+    {
+        /* Keys are hashed and compared as raw bytes, including trailing padding. */
+        memset(&key, 0, sizeof(key));
+        vkd3d_image_allocation_info_cache_normalize_desc(&key.desc, desc);
+        key.cpu_accessible = is_cpu_accessible_heap(heap_properties);
+        entry = &cache->entries[hash_data(&key, sizeof(key)) % VKD3D_IMAGE_CREATE_INFO_CACHE_SIZE];
+
+        if (spinlock_try_acquire(&entry->lock))
+        {
+            if ((hit = entry->valid && !memcmp(&entry->key, &key, sizeof(key))))
+                vkd3d_image_create_info_copy(create_info, &entry->create_info);
+            spinlock_release(&entry->lock);
+        }
+
+        vkd3d_atomic_uint64_increment(hit ? &cache->hit_count : &cache->miss_count, vkd3d_memory_order_relaxed);
+    }
+
+    if (!hit)
+    {
+        if (FAILED(hr = vkd3d_get_image_create_info_uncached(device, heap_properties, desc, resource, create_info)))
+            return hr;
+
+        /* If another thread holds the slot, it is likely filling it in, just drop ours. */
+        if (entry && spinlock_try_acquire(&entry->lock))
+        {
+            entry->key = key;
+            vkd3d_image_create_info_copy(&entry->create_info, create_info);
+            entry->valid = true;
+            spinlock_release(&entry->lock);
+        }
+    }
+
     if (resource)
     {
         if (heap_properties && is_cpu_accessible_heap(heap_properties))
@@ -760,28 +865,84 @@ static HRESULT vkd3d_create_image(struct d3d12_device *device,
 static size_t vkd3d_compute_resource_layouts_from_desc(struct d3d12_device *device,
         const D3D12_RESOURCE_DESC1 *desc, struct vkd3d_subresource_layout *layouts);
 
-HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
+HRESULT vkd3d_image_allocation_info_cache_init(struct vkd3d_image_allocation_info_cache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    /* Zeroed entries are unlocked and invalid. */
+    if (!(cache->entries = vkd3d_calloc(VKD3D_IMAGE_ALLOCATION_INFO_CACHE_SIZE, sizeof(*cache->entries))))
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
+void vkd3d_image_allocation_info_cache_cleanup(struct vkd3d_image_allocation_info_cache *cache)
+{
+    TRACE("Image allocation info cache: %"PRIu64" hits, %"PRIu64" misses.\n",
+            cache->hit_count, cache->miss_count);
+
+    vkd3d_free(cache->entries);
+}
+
+static void vkd3d_image_allocation_info_cache_normalize_desc(D3D12_RESOURCE_DESC1 *key,
+        const D3D12_RESOURCE_DESC1 *desc)
+{
+    /* Keys are compared with memcmp, so padding must be zero. */
+    memset(key, 0, sizeof(*key));
+    key->Dimension = desc->Dimension;
+    key->Alignment = desc->Alignment;
+    key->Width = desc->Width;
+    key->Height = desc->Height;
+    key->DepthOrArraySize = desc->DepthOrArraySize;
+    key->MipLevels = desc->MipLevels;
+    key->Format = desc->Format;
+    key->SampleDesc = desc->SampleDesc;
+    key->Layout = desc->Layout;
+    key->Flags = desc->Flags;
+    key->SamplerFeedbackMipRegion = desc->SamplerFeedbackMipRegion;
+}
+
+static bool vkd3d_image_allocation_info_cache_lookup(struct vkd3d_image_allocation_info_cache *cache,
+        struct vkd3d_image_allocation_info_cache_entry *entry, const D3D12_RESOURCE_DESC1 *key,
+        D3D12_RESOURCE_ALLOCATION_INFO *allocation_info)
+{
+    bool hit = false;
+
+    if (spinlock_try_acquire(&entry->lock))
+    {
+        if ((hit = entry->valid && !memcmp(&entry->desc, key, sizeof(*key))))
+            *allocation_info = entry->info;
+        spinlock_release(&entry->lock);
+    }
+
+    vkd3d_atomic_uint64_increment(hit ? &cache->hit_count : &cache->miss_count, vkd3d_memory_order_relaxed);
+    return hit;
+}
+
+static void vkd3d_image_allocation_info_cache_insert(struct vkd3d_image_allocation_info_cache_entry *entry,
+        const D3D12_RESOURCE_DESC1 *key, const D3D12_RESOURCE_ALLOCATION_INFO *allocation_info)
+{
+    /* If another thread holds the slot, it is likely filling it in, just drop ours. */
+    if (spinlock_try_acquire(&entry->lock))
+    {
+        entry->desc = *key;
+        entry->info = *allocation_info;
+        entry->valid = true;
+        spinlock_release(&entry->lock);
+    }
+}
+
+static HRESULT vkd3d_get_image_allocation_info_uncached(struct d3d12_device *device,
         const D3D12_RESOURCE_DESC1 *desc, D3D12_RESOURCE_ALLOCATION_INFO *allocation_info)
 {
     static const D3D12_HEAP_PROPERTIES heap_properties = {D3D12_HEAP_TYPE_DEFAULT};
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     VkDeviceImageMemoryRequirementsKHR requirement_info;
     struct vkd3d_image_create_info create_info;
-    D3D12_RESOURCE_DESC1 validated_desc;
     VkMemoryRequirements2 requirements;
     VkDeviceSize target_alignment;
     HRESULT hr;
 
-    assert(desc->Dimension != D3D12_RESOURCE_DIMENSION_BUFFER);
-    assert(d3d12_resource_validate_desc(desc, device) == S_OK);
-
-    if (!desc->MipLevels)
-    {
-        validated_desc = *desc;
-        validated_desc.MipLevels = max_miplevel_count(desc);
-        desc = &validated_desc;
-    }
-
     if (FAILED(hr = vkd3d_get_image_create_info(device, &heap_properties, 0, desc, NULL, &create_info)))
         return hr;
 
@@ -822,6 +983,31 @@ HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
     return hr;
 }
 
+HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
+        const D3D12_RESOURCE_DESC1 *desc, D3D12_RESOURCE_ALLOCATION_INFO *allocation_info)
+{
+    struct vkd3d_image_allocation_info_cache *cache = &device->image_allocation_info_cache;
+    struct vkd3d_image_allocation_info_cache_entry *entry;
+    D3D12_RESOURCE_DESC1 key;
+    HRESULT hr;
+
+    assert(desc->Dimension != D3D12_RESOURCE_DIMENSION_BUFFER);
+    assert(d3d12_resource_validate_desc(desc, device) == S_OK);
+
+    vkd3d_image_allocation_info_cache_normalize_desc(&key, desc);
+    if (!key.MipLevels)
+        key.MipLevels = max_miplevel_count(desc);
+
+    entry = &cache->entries[hash_data(&key, sizeof(key)) % VKD3D_IMAGE_ALLOCATION_INFO_CACHE_SIZE];
+    if (vkd3d_image_allocation_info_cache_lookup(cache, entry, &key, allocation_info))
+        return S_OK;
+
+    if (SUCCEEDED(hr = vkd3d_get_image_allocation_info_uncached(device, &key, allocation_info)))
+        vkd3d_image_allocation_info_cache_insert(entry, &key, allocation_info);
+
+    return hr;
+}
+
 struct vkd3d_view_entry
 {
     struct hash_map_entry entry;
@@ -951,15 +1137,37 @@ static bool vkd3d_view_entry_compare(const void *key, const struct hash_map_entr
     }
 }
 
+/* Small direct-mapped cache of recent view map hits per thread, so that the
+ * steady state lookup does not touch the shared spinlock cache line.
+ * Views live until their view map is destroyed, and a destroyed map's epoch is
+ * never reused, so stale entries simply stop matching. */
+#define VKD3D_VIEW_MAP_THREAD_CACHE_SIZE 32
+
+struct vkd3d_view_map_thread_cache_entry
+{
+    uint64_t epoch;
+    struct vkd3d_view_entry entry;
+};
+
+static VKD3D_THREAD_LOCAL struct vkd3d_view_map_thread_cache_entry
+        vkd3d_view_map_thread_cache[VKD3D_VIEW_MAP_THREAD_CACHE_SIZE];
+static uint64_t vkd3d_view_map_epoch_counter;
+
 HRESULT vkd3d_view_map_init(struct vkd3d_view_map *view_map)
 {
     view_map->spinlock = 0;
+    view_map->epoch = vkd3d_atomic_uint64_increment(&vkd3d_view_map_epoch_counter, vkd3d_memory_order_relaxed);
     hash_map_init(&view_map->map, &vkd3d_view_entry_hash, &vkd3d_view_entry_compare, sizeof(struct vkd3d_view_entry));
     return S_OK;
 }
 
 static void vkd3d_view_destroy(struct vkd3d_view *view, struct d3d12_device *device);
 
+static size_t vkd3d_view_map_get_footprint(const struct vkd3d_view_map *view_map)
+{
+    return hash_map_get_allocated_size(&view_map->map) + view_map->map.used_count * sizeof(struct vkd3d_view);
+}
+
 void vkd3d_view_map_destroy(struct vkd3d_view_map *view_map, struct d3d12_device *device)
 {
     uint32_t i;
@@ -972,6 +1180,8 @@ void vkd3d_view_map_destroy(struct vkd3d_view_map *view_map, struct d3d12_device
             vkd3d_view_destroy(e->view, device);
     }
 
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_VIEW_MAP,
+            -(int64_t)vkd3d_view_map_get_footprint(view_map));
     hash_map_free(&view_map->map);
 }
 
@@ -1020,11 +1230,20 @@ static void vkd3d_view_tag_debug_name(struct vkd3d_view *view, struct d3d12_devi
 struct vkd3d_view *vkd3d_view_map_create_view(struct vkd3d_view_map *view_map,
         struct d3d12_device *device, const struct vkd3d_view_key *key)
 {
+    struct vkd3d_view_map_thread_cache_entry *cache_entry;
     struct vkd3d_view_entry entry, *e;
     struct vkd3d_view *redundant_view;
     struct vkd3d_view *view;
+    size_t footprint;
+    uint32_t hash;
     bool success;
 
+    hash = vkd3d_view_entry_hash(key);
+    cache_entry = &vkd3d_view_map_thread_cache[(hash ^ (uint32_t)view_map->epoch) % VKD3D_VIEW_MAP_THREAD_CACHE_SIZE];
+
+    if (cache_entry->epoch == view_map->epoch && vkd3d_view_entry_compare(key, &cache_entry->entry.entry))
+        return cache_entry->entry.view;
+
     /* In the steady state, we will be reading existing entries from a view map.
      * Prefer read-write spinlocks here to reduce contention as much as possible. */
     rw_spinlock_acquire_read(&view_map->spinlock);
@@ -1033,6 +1252,9 @@ struct vkd3d_view *vkd3d_view_map_create_view(struct vkd3d_view_map *view_map,
     {
         view = e->view;
         rw_spinlock_release_read(&view_map->spinlock);
+        cache_entry->epoch = view_map->epoch;
+        cache_entry->entry.key = *key;
+        cache_entry->entry.view = view;
         return view;
     }
 
@@ -1077,8 +1299,11 @@ struct vkd3d_view *vkd3d_view_map_create_view(struct vkd3d_view_map *view_map,
 
     rw_spinlock_acquire_write(&view_map->spinlock);
 
+    footprint = vkd3d_view_map_get_footprint(view_map);
     if (!(e = (struct vkd3d_view_entry *)hash_map_insert(&view_map->map, key, &entry.entry)))
         ERR("Failed to insert view into hash map.\n");
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_VIEW_MAP,
+            (int64_t)vkd3d_view_map_get_footprint(view_map) - (int64_t)footprint);
 
     if (e->view != view)
     {
@@ -1150,6 +1375,57 @@ static bool vkd3d_sampler_entry_compare(const void *key, const struct hash_map_e
             k->desc.MaxLOD == e->desc.MaxLOD;
 }
 
+struct vkd3d_static_sampler_set_key
+{
+    unsigned int binding_count;
+    const VkDescriptorSetLayoutBinding *bindings;
+};
+
+struct vkd3d_static_sampler_set_entry
+{
+    struct hash_map_entry entry;
+    struct vkd3d_static_sampler_set *set;
+};
+
+static uint32_t vkd3d_static_sampler_set_entry_hash(const void *key)
+{
+    const struct vkd3d_static_sampler_set_key *k = key;
+    unsigned int i;
+    uint32_t hash;
+
+    hash = k->binding_count;
+
+    for (i = 0; i < k->binding_count; i++)
+    {
+        hash = hash_combine(hash, k->bindings[i].binding);
+        hash = hash_combine(hash, k->bindings[i].stageFlags);
+        hash = hash_combine(hash, hash_uint64((uint64_t)*k->bindings[i].pImmutableSamplers));
+    }
+
+    return hash;
+}
+
+static bool vkd3d_static_sampler_set_entry_compare(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_static_sampler_set_entry *e = (const struct vkd3d_static_sampler_set_entry *)entry;
+    const struct vkd3d_static_sampler_set_key *k = key;
+    unsigned int i;
+
+    if (k->binding_count != e->set->binding_count)
+        return false;
+
+    /* Samplers are already deduplicated by description, so comparing handles is sufficient. */
+    for (i = 0; i < k->binding_count; i++)
+    {
+        if (k->bindings[i].binding != e->set->bindings[i].binding ||
+                k->bindings[i].stageFlags != e->set->bindings[i].stageFlags ||
+                *k->bindings[i].pImmutableSamplers != e->set->vk_samplers[i])
+            return false;
+    }
+
+    return true;
+}
+
 HRESULT vkd3d_sampler_state_init(struct vkd3d_sampler_state *state,
         struct d3d12_device *device)
 {
@@ -1161,15 +1437,40 @@ HRESULT vkd3d_sampler_state_init(struct vkd3d_sampler_state *state,
         return hresult_from_errno(rc);
 
     hash_map_init(&state->map, &vkd3d_sampler_entry_hash, &vkd3d_sampler_entry_compare, sizeof(struct vkd3d_sampler_entry));
+    hash_map_init(&state->set_map, &vkd3d_static_sampler_set_entry_hash, &vkd3d_static_sampler_set_entry_compare,
+            sizeof(struct vkd3d_static_sampler_set_entry));
     return S_OK;
 }
 
+static void vkd3d_static_sampler_set_destroy(struct vkd3d_static_sampler_set *set, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    /* Pools are destroyed along with the sampler state, so only free the set here. */
+    if (set->vk_pool && set->vk_set)
+        VK_CALL(vkFreeDescriptorSets(device->vk_device, set->vk_pool, 1, &set->vk_set));
+    VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, set->vk_set_layout, NULL));
+    vkd3d_free(set->bindings);
+    vkd3d_free(set->vk_samplers);
+    vkd3d_free(set);
+}
+
 void vkd3d_sampler_state_cleanup(struct vkd3d_sampler_state *state,
         struct d3d12_device *device)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     uint32_t i;
 
+    for (i = 0; i < state->set_map.entry_count; i++)
+    {
+        struct vkd3d_static_sampler_set_entry *e = (struct vkd3d_static_sampler_set_entry *)hash_map_get_entry(&state->set_map, i);
+
+        if (e->entry.flags & HASH_MAP_ENTRY_OCCUPIED)
+            vkd3d_static_sampler_set_destroy(e->set, device);
+    }
+
+    hash_map_free(&state->set_map);
+
     for (i = 0; i < state->vk_descriptor_pool_count; i++)
         VK_CALL(vkDestroyDescriptorPool(device->vk_device, state->vk_descriptor_pools[i], NULL));
 
@@ -1246,7 +1547,7 @@ static VkResult vkd3d_sampler_state_create_descriptor_pool(struct d3d12_device *
     return VK_CALL(vkCreateDescriptorPool(device->vk_device, &pool_info, NULL, vk_pool));
 }
 
-HRESULT vkd3d_sampler_state_allocate_descriptor_set(struct vkd3d_sampler_state *state,
+static HRESULT vkd3d_sampler_state_allocate_descriptor_set_locked(struct vkd3d_sampler_state *state,
         struct d3d12_device *device, VkDescriptorSetLayout vk_layout, VkDescriptorSet *vk_set,
         VkDescriptorPool *vk_pool)
 {
@@ -1254,13 +1555,6 @@ HRESULT vkd3d_sampler_state_allocate_descriptor_set(struct vkd3d_sampler_state *
     VkResult vr = VK_ERROR_OUT_OF_POOL_MEMORY;
     VkDescriptorSetAllocateInfo alloc_info;
     size_t i;
-    int rc;
-
-    if ((rc = pthread_mutex_lock(&state->mutex)))
-    {
-        ERR("Failed to lock mutex, rc %d.\n", rc);
-        return hresult_from_errno(rc);
-    }
 
     alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     alloc_info.pNext = NULL;
@@ -1284,16 +1578,12 @@ HRESULT vkd3d_sampler_state_allocate_descriptor_set(struct vkd3d_sampler_state *
         vr = vkd3d_sampler_state_create_descriptor_pool(device, &alloc_info.descriptorPool);
 
         if (vr != VK_SUCCESS)
-        {
-            pthread_mutex_unlock(&state->mutex);
             return hresult_from_vk_result(vr);
-        }
 
         if (!vkd3d_array_reserve((void **)&state->vk_descriptor_pools, &state->vk_descriptor_pools_size,
                 state->vk_descriptor_pool_count + 1, sizeof(*state->vk_descriptor_pools)))
         {
             VK_CALL(vkDestroyDescriptorPool(device->vk_device, alloc_info.descriptorPool, NULL));
-            pthread_mutex_unlock(&state->mutex);
             return E_OUTOFMEMORY;
         }
 
@@ -1302,10 +1592,27 @@ HRESULT vkd3d_sampler_state_allocate_descriptor_set(struct vkd3d_sampler_state *
         *vk_pool = alloc_info.descriptorPool;
     }
 
-    pthread_mutex_unlock(&state->mutex);
     return hresult_from_vk_result(vr);
 }
 
+HRESULT vkd3d_sampler_state_allocate_descriptor_set(struct vkd3d_sampler_state *state,
+        struct d3d12_device *device, VkDescriptorSetLayout vk_layout, VkDescriptorSet *vk_set,
+        VkDescriptorPool *vk_pool)
+{
+    HRESULT hr;
+    int rc;
+
+    if ((rc = pthread_mutex_lock(&state->mutex)))
+    {
+        ERR("Failed to lock mutex, rc %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
+
+    hr = vkd3d_sampler_state_allocate_descriptor_set_locked(state, device, vk_layout, vk_set, vk_pool);
+    pthread_mutex_unlock(&state->mutex);
+    return hr;
+}
+
 void vkd3d_sampler_state_free_descriptor_set(struct vkd3d_sampler_state *state,
         struct d3d12_device *device, VkDescriptorSet vk_set, VkDescriptorPool vk_pool)
 {
@@ -1320,6 +1627,125 @@ void vkd3d_sampler_state_free_descriptor_set(struct vkd3d_sampler_state *state,
     pthread_mutex_unlock(&state->mutex);
 }
 
+static HRESULT vkd3d_static_sampler_set_create_locked(struct vkd3d_sampler_state *state,
+        struct d3d12_device *device, unsigned int binding_count, const VkDescriptorSetLayoutBinding *bindings,
+        struct vkd3d_static_sampler_set **out_set)
+{
+    struct vkd3d_static_sampler_set *set;
+    unsigned int i;
+    HRESULT hr;
+
+    if (!(set = vkd3d_calloc(1, sizeof(*set))))
+        return E_OUTOFMEMORY;
+
+    if (!(set->bindings = vkd3d_malloc(binding_count * sizeof(*set->bindings))) ||
+            !(set->vk_samplers = vkd3d_malloc(binding_count * sizeof(*set->vk_samplers))))
+    {
+        hr = E_OUTOFMEMORY;
+        goto fail;
+    }
+
+    set->refcount = 1;
+    set->binding_count = binding_count;
+
+    for (i = 0; i < binding_count; i++)
+    {
+        set->bindings[i] = bindings[i];
+        set->vk_samplers[i] = *bindings[i].pImmutableSamplers;
+        set->bindings[i].pImmutableSamplers = &set->vk_samplers[i];
+    }
+
+    if (FAILED(hr = vkd3d_create_descriptor_set_layout(device, 0, binding_count, set->bindings,
+            VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT |
+                    VK_DESCRIPTOR_SET_LAYOUT_CREATE_EMBEDDED_IMMUTABLE_SAMPLERS_BIT_EXT,
+            &set->vk_set_layout)))
+        goto fail;
+
+    /* With descriptor buffers we can implicitly bind immutable samplers, and no descriptors are necessary. */
+    if (!d3d12_device_uses_descriptor_buffers(device))
+    {
+        if (FAILED(hr = vkd3d_sampler_state_allocate_descriptor_set_locked(state, device,
+                set->vk_set_layout, &set->vk_set, &set->vk_pool)))
+            goto fail;
+    }
+
+    *out_set = set;
+    return S_OK;
+
+fail:
+    vkd3d_static_sampler_set_destroy(set, device);
+    return hr;
+}
+
+HRESULT vkd3d_sampler_state_acquire_static_sampler_set(struct vkd3d_sampler_state *state,
+        struct d3d12_device *device, unsigned int binding_count, const VkDescriptorSetLayoutBinding *bindings,
+        struct vkd3d_static_sampler_set **set)
+{
+    struct vkd3d_static_sampler_set_entry entry, *e;
+    struct vkd3d_static_sampler_set_key key;
+    HRESULT hr;
+    int rc;
+
+    key.binding_count = binding_count;
+    key.bindings = bindings;
+
+    if ((rc = pthread_mutex_lock(&state->mutex)))
+    {
+        ERR("Failed to lock mutex, rc %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
+
+    if ((e = (struct vkd3d_static_sampler_set_entry *)hash_map_find(&state->set_map, &key)))
+    {
+        e->set->refcount++;
+        *set = e->set;
+        pthread_mutex_unlock(&state->mutex);
+        return S_OK;
+    }
+
+    if (FAILED(hr = vkd3d_static_sampler_set_create_locked(state, device, binding_count, bindings, set)))
+    {
+        pthread_mutex_unlock(&state->mutex);
+        return hr;
+    }
+
+    entry.set = *set;
+
+    /* Failing to insert only means that this set is not shared. */
+    if (!hash_map_insert(&state->set_map, &key, &entry.entry))
+        ERR("Failed to insert static sampler set into hash map.\n");
+
+    pthread_mutex_unlock(&state->mutex);
+    return S_OK;
+}
+
+void vkd3d_sampler_state_release_static_sampler_set(struct vkd3d_sampler_state *state,
+        struct d3d12_device *device, struct vkd3d_static_sampler_set *set)
+{
+    struct vkd3d_static_sampler_set_entry *e;
+    struct vkd3d_static_sampler_set_key key;
+    int rc;
+
+    if (!set)
+        return;
+
+    if ((rc = pthread_mutex_lock(&state->mutex)))
+        ERR("Failed to lock mutex, rc %d.\n", rc);
+
+    if (!--set->refcount)
+    {
+        key.binding_count = set->binding_count;
+        key.bindings = set->bindings;
+
+        if ((e = (struct vkd3d_static_sampler_set_entry *)hash_map_find(&state->set_map, &key)) && e->set == set)
+            hash_map_remove(&state->set_map, &e->entry);
+
+        vkd3d_static_sampler_set_destroy(set, device);
+    }
+
+    pthread_mutex_unlock(&state->mutex);
+}
+
 static void d3d12_resource_get_tiling(struct d3d12_device *device, struct d3d12_resource *resource,
         UINT *total_tile_count, D3D12_PACKED_MIP_INFO *packed_mip_info, D3D12_TILE_SHAPE *tile_shape,
         D3D12_SUBRESOURCE_TILING *tilings, VkSparseImageMemoryRequirements *vk_info)
@@ -1337,106 +1763,504 @@ static void d3d12_resource_get_tiling(struct d3d12_device *device, struct d3d12_
     {
         tile_count = align(desc->Width, VKD3D_TILE_SIZE) / VKD3D_TILE_SIZE;
 
-        packed_mip_info->NumStandardMips = 0;
-        packed_mip_info->NumPackedMips = 0;
-        packed_mip_info->NumTilesForPackedMips = 0;
-        packed_mip_info->StartTileIndexInOverallResource = 0;
+        packed_mip_info->NumStandardMips = 0;
+        packed_mip_info->NumPackedMips = 0;
+        packed_mip_info->NumTilesForPackedMips = 0;
+        packed_mip_info->StartTileIndexInOverallResource = 0;
+
+        tile_shape->WidthInTexels = VKD3D_TILE_SIZE;
+        tile_shape->HeightInTexels = 1;
+        tile_shape->DepthInTexels = 1;
+
+        tilings[0].WidthInTiles = tile_count;
+        tilings[0].HeightInTiles = 1;
+        tilings[0].DepthInTiles = 1;
+        tilings[0].StartTileIndexInOverallResource = 0;
+
+        *total_tile_count = tile_count;
+    }
+    else
+    {
+        VK_CALL(vkGetImageSparseMemoryRequirements(device->vk_device,
+                resource->res.vk_image, &memory_requirement_count, NULL));
+
+        if (!memory_requirement_count)
+        {
+            ERR("Failed to query sparse memory requirements.\n");
+            return;
+        }
+
+        memory_requirements = vkd3d_malloc(memory_requirement_count * sizeof(*memory_requirements));
+
+        VK_CALL(vkGetImageSparseMemoryRequirements(device->vk_device,
+                resource->res.vk_image, &memory_requirement_count, memory_requirements));
+
+        for (i = 0; i < memory_requirement_count; i++)
+        {
+            if (!(memory_requirements[i].formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT))
+                *vk_info = memory_requirements[i];
+        }
+
+        vkd3d_free(memory_requirements);
+
+        /* Assume that there is no mip tail if either the size is zero or
+         * if the first LOD is out of range. It's not clear what drivers
+         * are supposed to report here if the image has no mip tail. */
+        standard_mips = vk_info->imageMipTailSize
+                ? min(desc->MipLevels, vk_info->imageMipTailFirstLod)
+                : desc->MipLevels;
+
+        packed_tiles = standard_mips < desc->MipLevels
+                ? align(vk_info->imageMipTailSize, VKD3D_TILE_SIZE) / VKD3D_TILE_SIZE
+                : 0;
+
+        if (!(vk_info->formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT))
+            packed_tiles *= d3d12_resource_desc_get_layer_count(desc);
+
+        block_extent = vk_info->formatProperties.imageGranularity;
+        tile_count = 0;
+
+        for (i = 0; i < d3d12_resource_desc_get_sub_resource_count_per_plane(desc); i++)
+        {
+            unsigned int mip_level = i % desc->MipLevels;
+            unsigned int tile_count_w = align(d3d12_resource_desc_get_width(desc, mip_level), block_extent.width) / block_extent.width;
+            unsigned int tile_count_h = align(d3d12_resource_desc_get_height(desc, mip_level), block_extent.height) / block_extent.height;
+            unsigned int tile_count_d = align(d3d12_resource_desc_get_depth(desc, mip_level), block_extent.depth) / block_extent.depth;
+
+            if (mip_level < standard_mips)
+            {
+                tilings[i].WidthInTiles = tile_count_w;
+                tilings[i].HeightInTiles = tile_count_h;
+                tilings[i].DepthInTiles = tile_count_d;
+                tilings[i].StartTileIndexInOverallResource = tile_count;
+                tile_count += tile_count_w * tile_count_h * tile_count_d;
+            }
+            else
+            {
+                tilings[i].WidthInTiles = 0;
+                tilings[i].HeightInTiles = 0;
+                tilings[i].DepthInTiles = 0;
+                tilings[i].StartTileIndexInOverallResource = ~0u;
+            }
+        }
+
+        packed_mip_info->NumStandardMips = standard_mips;
+        packed_mip_info->NumTilesForPackedMips = packed_tiles;
+        packed_mip_info->NumPackedMips = desc->MipLevels - standard_mips;
+        packed_mip_info->StartTileIndexInOverallResource = packed_tiles ? tile_count : 0;
+
+        tile_count += packed_tiles;
+
+        /* Docs say that we should clear tile_shape to zero if there are no standard mips,
+         * but this conflicts with all native drivers, so the docs are likely lying here.
+         * See test_get_resource_tiling() for info. */
+        tile_shape->WidthInTexels = block_extent.width;
+        tile_shape->HeightInTexels = block_extent.height;
+        tile_shape->DepthInTexels = block_extent.depth;
+
+        *total_tile_count = tile_count;
+    }
+}
+
+static void d3d12_resource_destroy(struct d3d12_resource *resource, struct d3d12_device *device);
+
+HRESULT vkd3d_resource_recycle_pool_init(struct vkd3d_resource_recycle_pool *pool)
+{
+    int rc;
+
+    memset(pool, 0, sizeof(*pool));
+    list_init(&pool->entries);
+
+    if ((rc = pthread_mutex_init(&pool->mutex, NULL)))
+        return hresult_from_errno(rc);
+
+    return S_OK;
+}
+
+static void vkd3d_resource_recycle_entry_destroy(struct vkd3d_resource_recycle_entry *entry,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VK_CALL(vkDestroyImageView(device->vk_device, entry->vrs_view, NULL));
+    VK_CALL(vkDestroyImage(device->vk_device, entry->vk_image, NULL));
+    vkd3d_free_memory(device, &device->memory_allocator, &entry->mem);
+    vkd3d_free(entry);
+}
+
+void vkd3d_resource_recycle_pool_cleanup(struct vkd3d_resource_recycle_pool *pool, struct d3d12_device *device)
+{
+    struct vkd3d_resource_recycle_entry *entry, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &pool->entries, struct vkd3d_resource_recycle_entry, entry)
+        vkd3d_resource_recycle_entry_destroy(entry, device);
+
+    pthread_mutex_destroy(&pool->mutex);
+}
+
+static bool vkd3d_resource_recycle_entry_matches(const struct vkd3d_resource_recycle_entry *entry,
+        const D3D12_RESOURCE_DESC1 *desc, const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags)
+{
+    /* Compare field by field, the descs come straight from the application
+     * and padding bytes are not guaranteed to match. */
+    return entry->desc.Dimension == desc->Dimension &&
+            entry->desc.Alignment == desc->Alignment &&
+            entry->desc.Width == desc->Width &&
+            entry->desc.Height == desc->Height &&
+            entry->desc.DepthOrArraySize == desc->DepthOrArraySize &&
+            entry->desc.MipLevels == desc->MipLevels &&
+            entry->desc.Format == desc->Format &&
+            entry->desc.SampleDesc.Count == desc->SampleDesc.Count &&
+            entry->desc.SampleDesc.Quality == desc->SampleDesc.Quality &&
+            entry->desc.Layout == desc->Layout &&
+            entry->desc.Flags == desc->Flags &&
+            entry->desc.SamplerFeedbackMipRegion.Width == desc->SamplerFeedbackMipRegion.Width &&
+            entry->desc.SamplerFeedbackMipRegion.Height == desc->SamplerFeedbackMipRegion.Height &&
+            entry->desc.SamplerFeedbackMipRegion.Depth == desc->SamplerFeedbackMipRegion.Depth &&
+            entry->heap_properties.Type == heap_properties->Type &&
+            entry->heap_properties.CPUPageProperty == heap_properties->CPUPageProperty &&
+            entry->heap_properties.MemoryPoolPreference == heap_properties->MemoryPoolPreference &&
+            entry->heap_properties.CreationNodeMask == heap_properties->CreationNodeMask &&
+            entry->heap_properties.VisibleNodeMask == heap_properties->VisibleNodeMask &&
+            entry->heap_flags == heap_flags;
+}
+
+static bool d3d12_resource_is_recyclable(const struct d3d12_resource *resource)
+{
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_RECYCLE_COMMITTED_RESOURCES))
+        return false;
+
+    if (!(resource->flags & VKD3D_RESOURCE_COMMITTED) || !d3d12_resource_is_texture(resource))
+        return false;
+
+    if (resource->flags & (VKD3D_RESOURCE_EXTERNAL | VKD3D_RESOURCE_LINEAR_STAGING_COPY))
+        return false;
+
+    if ((resource->heap_flags & D3D12_HEAP_FLAG_SHARED) || resource->priority.allows_dynamic_residency)
+        return false;
+
+    if (!resource->res.vk_image || !resource->mem.device_allocation.vk_memory)
+        return false;
+
+    /* Dedicated allocations registered by address cannot be moved. */
+    if (!resource->mem.chunk && resource->mem.resource.va)
+        return false;
+
+    /* Memory that must be zeroed again on reuse needs to be clearable. */
+    if (!(resource->heap_flags & D3D12_HEAP_FLAG_CREATE_NOT_ZEROED) &&
+            !resource->mem.cpu_address && !resource->mem.resource.vk_buffer)
+        return false;
+
+    return resource->mem.resource.size <= VKD3D_RESOURCE_RECYCLE_POOL_MAX_SIZE;
+}
+
+/* Called once the last reference to the resource is gone. D3D12 requires the
+ * application to keep a resource alive until the GPU is done with it, so the
+ * image and its memory can be handed out again right away. */
+static void d3d12_resource_recycle(struct d3d12_resource *resource, struct d3d12_device *device)
+{
+    struct vkd3d_resource_recycle_pool *pool = &device->resource_recycle_pool;
+    struct vkd3d_resource_recycle_entry *entry, *next;
+    struct list evicted;
+
+    /* The transfer queue references the resource until its initial transition is recorded,
+     * this must be resolved before the image is destroyed or handed to another resource. */
+    vkd3d_memory_transfer_queue_cancel_initial_transition(&device->memory_transfers, resource);
+
+    if (!d3d12_resource_is_recyclable(resource))
+        return;
+
+    if (!(entry = vkd3d_malloc(sizeof(*entry))))
+        return;
+
+    /* The clear queue references the allocation by address, so it must not
+     * hold on to it while the allocation moves. A cancelled clear is
+     * redone when the texture is reused. */
+    if (resource->mem.clear_semaphore_value)
+        vkd3d_memory_transfer_queue_cancel_clear(&device->memory_transfers, &resource->mem);
+
+    entry->desc = resource->desc;
+    entry->heap_properties = resource->heap_properties;
+    entry->heap_flags = resource->heap_flags;
+    entry->vk_image = resource->res.vk_image;
+    entry->vrs_view = resource->vrs_view;
+    entry->mem = resource->mem;
+    entry->resource_flags = resource->flags & VKD3D_RESOURCE_SIMULTANEOUS_ACCESS;
+    entry->common_layout = resource->common_layout;
+
+    resource->res.vk_image = VK_NULL_HANDLE;
+    resource->vrs_view = VK_NULL_HANDLE;
+    memset(&resource->mem, 0, sizeof(resource->mem));
+
+    list_init(&evicted);
+
+    pthread_mutex_lock(&pool->mutex);
+    list_add_head(&pool->entries, &entry->entry);
+    pool->entry_count++;
+    pool->total_size += entry->mem.resource.size;
+
+    while (pool->entry_count > VKD3D_RESOURCE_RECYCLE_POOL_MAX_COUNT ||
+            pool->total_size > VKD3D_RESOURCE_RECYCLE_POOL_MAX_SIZE)
+    {
+        entry = LIST_ENTRY(list_tail(&pool->entries), struct vkd3d_resource_recycle_entry, entry);
+        list_remove(&entry->entry);
+        pool->entry_count--;
+        pool->total_size -= entry->mem.resource.size;
+        list_add_tail(&evicted, &entry->entry);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &evicted, struct vkd3d_resource_recycle_entry, entry)
+        vkd3d_resource_recycle_entry_destroy(entry, device);
+}
+
+static bool d3d12_resource_acquire_recycled(struct d3d12_resource *resource, struct d3d12_device *device)
+{
+    struct vkd3d_resource_recycle_pool *pool = &device->resource_recycle_pool;
+    struct vkd3d_resource_recycle_entry *entry, *found = NULL;
+    D3D12_RESOURCE_DESC1 desc;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_RECYCLE_COMMITTED_RESOURCES))
+        return false;
+
+    if (resource->heap_flags & D3D12_HEAP_FLAG_SHARED)
+        return false;
+
+    desc = resource->desc;
+    if (!desc.MipLevels)
+        desc.MipLevels = max_miplevel_count(&desc);
+
+    pthread_mutex_lock(&pool->mutex);
+    LIST_FOR_EACH_ENTRY(entry, &pool->entries, struct vkd3d_resource_recycle_entry, entry)
+    {
+        if (vkd3d_resource_recycle_entry_matches(entry, &desc, &resource->heap_properties, resource->heap_flags))
+        {
+            list_remove(&entry->entry);
+            pool->entry_count--;
+            pool->total_size -= entry->mem.resource.size;
+            found = entry;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (!found)
+        return false;
+
+    resource->desc.MipLevels = desc.MipLevels;
+    resource->res.vk_image = found->vk_image;
+    resource->vrs_view = found->vrs_view;
+    resource->mem = found->mem;
+    resource->flags |= found->resource_flags;
+    resource->common_layout = found->common_layout;
+    resource->initial_layout_transition = 1;
+    vkd3d_free(found);
+
+    if (!(resource->heap_flags & D3D12_HEAP_FLAG_CREATE_NOT_ZEROED))
+    {
+        vkd3d_memory_transfer_queue_reclear_allocation(&device->memory_transfers, &resource->mem);
+
+        if (resource->mem.clear_semaphore_value && !resource->mem.cpu_address)
+            resource->lazy_clear = 1;
+    }
+
+    TRACE("Reusing recycled image for resource %p.\n", resource);
+    return true;
+}
+
+static void d3d12_resource_destroy_batch(struct d3d12_resource **resources, size_t count,
+        struct d3d12_device *device);
+
+static void *vkd3d_resource_destroy_queue_main(void *userdata)
+{
+    struct vkd3d_resource_destroy_queue *queue = userdata;
+    struct d3d12_resource **resources;
+    size_t resources_size, i, count;
+
+    vkd3d_set_thread_name("vkd3d_destroy");
+
+    pthread_mutex_lock(&queue->mutex);
+
+    for (;;)
+    {
+        while (!queue->resource_count && !queue->should_exit)
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+
+        /* Everything queued before exit was requested is still torn down. */
+        if (!queue->resource_count)
+            break;
+
+        /* Swap arrays so that new resources can be queued while this batch is destroyed. */
+        resources = queue->resources;
+        resources_size = queue->resources_size;
+        count = queue->resource_count;
+        queue->resources = queue->batch;
+        queue->resources_size = queue->batch_size;
+        queue->resource_count = 0;
+        queue->batch = resources;
+        queue->batch_size = resources_size;
+        pthread_mutex_unlock(&queue->mutex);
+
+        for (i = 0; i < count; i++)
+            d3d12_resource_recycle(resources[i], queue->device);
+        d3d12_resource_destroy_batch(resources, count, queue->device);
+
+        TRACE("Destroyed %zu resources.\n", count);
+
+        pthread_mutex_lock(&queue->mutex);
+    }
+
+    pthread_mutex_unlock(&queue->mutex);
+    return NULL;
+}
+
+HRESULT vkd3d_resource_destroy_queue_init(struct vkd3d_resource_destroy_queue *queue, struct d3d12_device *device)
+{
+    int rc;
+
+    memset(queue, 0, sizeof(*queue));
+    queue->device = device;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEFERRED_RESOURCE_DESTROY))
+        return S_OK;
+
+    if ((rc = pthread_mutex_init(&queue->mutex, NULL)))
+    {
+        ERR("Failed to initialize mutex, error %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
+
+    if ((rc = pthread_cond_init(&queue->cond, NULL)))
+    {
+        ERR("Failed to initialize condition variable, error %d.\n", rc);
+        pthread_mutex_destroy(&queue->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    if ((rc = pthread_create(&queue->thread, NULL, vkd3d_resource_destroy_queue_main, queue)))
+    {
+        ERR("Failed to create resource destroy thread, error %d.\n", rc);
+        pthread_cond_destroy(&queue->cond);
+        pthread_mutex_destroy(&queue->mutex);
+        return hresult_from_errno(rc);
+    }
+
+    queue->is_running = true;
+    return S_OK;
+}
+
+void vkd3d_resource_destroy_queue_cleanup(struct vkd3d_resource_destroy_queue *queue)
+{
+    if (!queue->is_running)
+        return;
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->should_exit = true;
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+
+    pthread_join(queue->thread, NULL);
+    queue->is_running = false;
+
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->cond);
 
-        tile_shape->WidthInTexels = VKD3D_TILE_SIZE;
-        tile_shape->HeightInTexels = 1;
-        tile_shape->DepthInTexels = 1;
+    vkd3d_free(queue->resources);
+    vkd3d_free(queue->batch);
+}
 
-        tilings[0].WidthInTiles = tile_count;
-        tilings[0].HeightInTiles = 1;
-        tilings[0].DepthInTiles = 1;
-        tilings[0].StartTileIndexInOverallResource = 0;
+HRESULT vkd3d_memory_bind_queue_init(struct vkd3d_memory_bind_queue *queue)
+{
+    int rc;
 
-        *total_tile_count = tile_count;
-    }
-    else
+    memset(queue, 0, sizeof(*queue));
+
+    if ((rc = pthread_mutex_init(&queue->mutex, NULL)))
     {
-        VK_CALL(vkGetImageSparseMemoryRequirements(device->vk_device,
-                resource->res.vk_image, &memory_requirement_count, NULL));
+        ERR("Failed to initialize mutex, error %d.\n", rc);
+        return hresult_from_errno(rc);
+    }
 
-        if (!memory_requirement_count)
-        {
-            ERR("Failed to query sparse memory requirements.\n");
-            return;
-        }
+    return S_OK;
+}
 
-        memory_requirements = vkd3d_malloc(memory_requirement_count * sizeof(*memory_requirements));
+void vkd3d_memory_bind_queue_cleanup(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device)
+{
+    /* Every pending image belongs to a live resource, and destroying it flushes. */
+    assert(!queue->bind_count);
 
-        VK_CALL(vkGetImageSparseMemoryRequirements(device->vk_device,
-                resource->res.vk_image, &memory_requirement_count, memory_requirements));
+    pthread_mutex_destroy(&queue->mutex);
+    vkd3d_free(queue->binds);
+}
 
-        for (i = 0; i < memory_requirement_count; i++)
-        {
-            if (!(memory_requirements[i].formatProperties.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT))
-                *vk_info = memory_requirements[i];
-        }
+static void vkd3d_memory_bind_queue_flush_locked(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    VkResult vr;
 
-        vkd3d_free(memory_requirements);
+    if (!queue->bind_count)
+        return;
 
-        /* Assume that there is no mip tail if either the size is zero or
-         * if the first LOD is out of range. It's not clear what drivers
-         * are supposed to report here if the image has no mip tail. */
-        standard_mips = vk_info->imageMipTailSize
-                ? min(desc->MipLevels, vk_info->imageMipTailFirstLod)
-                : desc->MipLevels;
+    /* There is nowhere to report this, the resources were already handed out.
+     * Binding only fails when the driver is out of host or device memory. */
+    if ((vr = VK_CALL(vkBindImageMemory2(device->vk_device, queue->bind_count, queue->binds))) < 0)
+        ERR("Failed to bind memory of %u images, vr %d.\n", queue->bind_count, vr);
+    else
+        TRACE("Bound memory of %u images.\n", queue->bind_count);
 
-        packed_tiles = standard_mips < desc->MipLevels
-                ? align(vk_info->imageMipTailSize, VKD3D_TILE_SIZE) / VKD3D_TILE_SIZE
-                : 0;
+    vkd3d_atomic_uint32_store_explicit(&queue->bind_count, 0, vkd3d_memory_order_release);
+}
 
-        if (!(vk_info->formatProperties.flags & VK_SPARSE_IMAGE_FORMAT_SINGLE_MIPTAIL_BIT))
-            packed_tiles *= d3d12_resource_desc_get_layer_count(desc);
+bool vkd3d_memory_bind_queue_push(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device,
+        const VkBindImageMemoryInfo *bind_info)
+{
+    pthread_mutex_lock(&queue->mutex);
 
-        block_extent = vk_info->formatProperties.imageGranularity;
-        tile_count = 0;
+    if (!vkd3d_array_reserve((void **)&queue->binds, &queue->binds_size,
+            queue->bind_count + 1, sizeof(*queue->binds)))
+    {
+        pthread_mutex_unlock(&queue->mutex);
+        return false;
+    }
 
-        for (i = 0; i < d3d12_resource_desc_get_sub_resource_count_per_plane(desc); i++)
-        {
-            unsigned int mip_level = i % desc->MipLevels;
-            unsigned int tile_count_w = align(d3d12_resource_desc_get_width(desc, mip_level), block_extent.width) / block_extent.width;
-            unsigned int tile_count_h = align(d3d12_resource_desc_get_height(desc, mip_level), block_extent.height) / block_extent.height;
-            unsigned int tile_count_d = align(d3d12_resource_desc_get_depth(desc, mip_level), block_extent.depth) / block_extent.depth;
+    queue->binds[queue->bind_count] = *bind_info;
+    vkd3d_atomic_uint32_store_explicit(&queue->bind_count, queue->bind_count + 1, vkd3d_memory_order_release);
 
-            if (mip_level < standard_mips)
-            {
-                tilings[i].WidthInTiles = tile_count_w;
-                tilings[i].HeightInTiles = tile_count_h;
-                tilings[i].DepthInTiles = tile_count_d;
-                tilings[i].StartTileIndexInOverallResource = tile_count;
-                tile_count += tile_count_w * tile_count_h * tile_count_d;
-            }
-            else
-            {
-                tilings[i].WidthInTiles = 0;
-                tilings[i].HeightInTiles = 0;
-                tilings[i].DepthInTiles = 0;
-                tilings[i].StartTileIndexInOverallResource = ~0u;
-            }
-        }
+    if (queue->bind_count >= VKD3D_MEMORY_BIND_QUEUE_THRESHOLD)
+        vkd3d_memory_bind_queue_flush_locked(queue, device);
 
-        packed_mip_info->NumStandardMips = standard_mips;
-        packed_mip_info->NumTilesForPackedMips = packed_tiles;
-        packed_mip_info->NumPackedMips = desc->MipLevels - standard_mips;
-        packed_mip_info->StartTileIndexInOverallResource = packed_tiles ? tile_count : 0;
+    pthread_mutex_unlock(&queue->mutex);
+    return true;
+}
 
-        tile_count += packed_tiles;
+void vkd3d_memory_bind_queue_flush(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device)
+{
+    pthread_mutex_lock(&queue->mutex);
+    vkd3d_memory_bind_queue_flush_locked(queue, device);
+    pthread_mutex_unlock(&queue->mutex);
+}
 
-        /* Docs say that we should clear tile_shape to zero if there are no standard mips,
-         * but this conflicts with all native drivers, so the docs are likely lying here.
-         * See test_get_resource_tiling() for info. */
-        tile_shape->WidthInTexels = block_extent.width;
-        tile_shape->HeightInTexels = block_extent.height;
-        tile_shape->DepthInTexels = block_extent.depth;
+static bool vkd3d_resource_destroy_queue_push(struct vkd3d_resource_destroy_queue *queue,
+        struct d3d12_resource *resource)
+{
+    bool queued = false;
 
-        *total_tile_count = tile_count;
+    /* Once the worker is gone, resources released during device teardown are destroyed inline. */
+    if (!queue->is_running || (resource->flags & VKD3D_RESOURCE_EXTERNAL))
+        return false;
+
+    pthread_mutex_lock(&queue->mutex);
+    if (!queue->should_exit && vkd3d_array_reserve((void **)&queue->resources, &queue->resources_size,
+            queue->resource_count + 1, sizeof(*queue->resources)))
+    {
+        queue->resources[queue->resource_count++] = resource;
+        pthread_cond_signal(&queue->cond);
+        queued = true;
     }
-}
+    pthread_mutex_unlock(&queue->mutex);
 
-static void d3d12_resource_destroy(struct d3d12_resource *resource, struct d3d12_device *device);
+    return queued;
+}
 
 ULONG d3d12_resource_incref(struct d3d12_resource *resource)
 {
@@ -1453,8 +2277,11 @@ ULONG d3d12_resource_decref(struct d3d12_resource *resource)
 
     TRACE("%p decreasing refcount to %u.\n", resource, refcount);
 
-    if (!refcount)
+    if (!refcount && !vkd3d_resource_destroy_queue_push(&resource->device->resource_destroy_queue, resource))
+    {
+        d3d12_resource_recycle(resource, resource->device);
         d3d12_resource_destroy(resource, resource->device);
+    }
 
     return refcount;
 }
@@ -1782,6 +2609,100 @@ static D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE d3d12_resource_GetGPUVirtualA
     return resource->res.va;
 }
 
+#define VKD3D_SUBRESOURCE_COPY_PARALLEL_THRESHOLD (4u * 1024u * 1024u)
+
+struct vkd3d_subresource_copy_task
+{
+    struct vkd3d_job task;
+    const struct vkd3d_format *format;
+    const uint8_t *src;
+    uint8_t *dst;
+    unsigned int src_row_pitch, src_slice_pitch;
+    unsigned int dst_row_pitch, dst_slice_pitch;
+    unsigned int width, height, depth;
+    bool dst_write_combined;
+};
+
+static void vkd3d_subresource_copy_task_run(void *userdata)
+{
+    struct vkd3d_subresource_copy_task *task = userdata;
+
+    vkd3d_format_copy_data(task->format, task->src, task->src_row_pitch, task->src_slice_pitch,
+            task->dst, task->dst_row_pitch, task->dst_slice_pitch,
+            task->width, task->height, task->depth, task->dst_write_combined);
+}
+
+/* Copies a box of texel data between application memory and a mapped subresource.
+ * Large copies are split into stripes of whole slices, or whole block rows for 2D,
+ * and handed to the device worker pool, with the calling thread taking the first stripe. */
+static void d3d12_device_copy_subresource_data(struct d3d12_device *device, const struct vkd3d_format *format,
+        const uint8_t *src, unsigned int src_row_pitch, unsigned int src_slice_pitch,
+        uint8_t *dst, unsigned int dst_row_pitch, unsigned int dst_slice_pitch,
+        unsigned int width, unsigned int height, unsigned int depth, bool dst_write_combined)
+{
+    struct vkd3d_subresource_copy_task tasks[VKD3D_JOB_POOL_MAX_THREADS + 1];
+    struct vkd3d_job_pool *pool = &device->job_pool;
+    unsigned int row_count, row_size, stripe_count, unit_count, begin, end, i;
+    struct vkd3d_subresource_copy_task *task;
+    bool split_slices;
+
+    row_count = (height + format->block_height - 1) / format->block_height;
+    row_size = ((width + format->block_width - 1) / format->block_width) * format->byte_count * format->block_byte_count;
+    stripe_count = device->subresource_copy_thread_count;
+
+    if (stripe_count <= 1 || (uint64_t)row_size * row_count * depth < VKD3D_SUBRESOURCE_COPY_PARALLEL_THRESHOLD)
+    {
+        vkd3d_format_copy_data(format, src, src_row_pitch, src_slice_pitch, dst, dst_row_pitch, dst_slice_pitch,
+                width, height, depth, dst_write_combined);
+        return;
+    }
+
+    split_slices = depth >= stripe_count;
+    unit_count = split_slices ? depth : row_count;
+    stripe_count = min(stripe_count, unit_count);
+
+    for (i = 0; i < stripe_count; i++)
+    {
+        task = &tasks[i];
+        begin = (uint64_t)unit_count * i / stripe_count;
+        end = (uint64_t)unit_count * (i + 1) / stripe_count;
+
+        memset(&task->task, 0, sizeof(task->task));
+        task->task.callback = vkd3d_subresource_copy_task_run;
+        task->task.userdata = task;
+        task->format = format;
+        task->src_row_pitch = src_row_pitch;
+        task->src_slice_pitch = src_slice_pitch;
+        task->dst_row_pitch = dst_row_pitch;
+        task->dst_slice_pitch = dst_slice_pitch;
+        task->width = width;
+        task->dst_write_combined = dst_write_combined;
+
+        if (split_slices)
+        {
+            task->src = src + (size_t)begin * src_slice_pitch;
+            task->dst = dst + (size_t)begin * dst_slice_pitch;
+            task->height = height;
+            task->depth = end - begin;
+        }
+        else
+        {
+            task->src = src + (size_t)begin * src_row_pitch;
+            task->dst = dst + (size_t)begin * dst_row_pitch;
+            task->height = min((end - begin) * format->block_height, height - begin * format->block_height);
+            task->depth = depth;
+        }
+
+        if (i)
+            vkd3d_job_pool_enqueue(pool, &task->task);
+    }
+
+    vkd3d_subresource_copy_task_run(&tasks[0]);
+
+    for (i = 1; i < stripe_count; i++)
+        vkd3d_job_pool_wait(pool, &tasks[i].task);
+}
+
 static HRESULT STDMETHODCALLTYPE d3d12_resource_WriteToSubresource(d3d12_resource_iface *iface,
         UINT dst_sub_resource, const D3D12_BOX *dst_box, const void *src_data,
         UINT src_row_pitch, UINT src_slice_pitch)
@@ -1850,8 +2771,9 @@ static HRESULT STDMETHODCALLTYPE d3d12_resource_WriteToSubresource(d3d12_resourc
     dst_data += subresource_layout->offset + vkd3d_format_get_data_offset(resource->format,
             subresource_layout->row_pitch, subresource_layout->depth_pitch, offset.x, offset.y, offset.z);
 
-    vkd3d_format_copy_data(resource->format, src_data, src_row_pitch, src_slice_pitch, dst_data,
-            subresource_layout->row_pitch, subresource_layout->depth_pitch, extent.width, extent.height, extent.depth);
+    d3d12_device_copy_subresource_data(device, resource->format, src_data, src_row_pitch, src_slice_pitch, dst_data,
+            subresource_layout->row_pitch, subresource_layout->depth_pitch, extent.width, extent.height, extent.depth,
+            vkd3d_memory_allocation_is_write_combined(device, &resource->mem));
 
     return vkd3d_memory_transfer_queue_write_subresource(&device->memory_transfers,
             resource, dst_sub_resource, offset, extent);
@@ -1914,9 +2836,9 @@ static HRESULT STDMETHODCALLTYPE d3d12_resource_ReadFromSubresource(d3d12_resour
     src_data += subresource_layout->offset + vkd3d_format_get_data_offset(resource->format,
             subresource_layout->row_pitch, subresource_layout->depth_pitch, src_box->left, src_box->top, src_box->front);
 
-    vkd3d_format_copy_data(resource->format, src_data, subresource_layout->row_pitch,
+    d3d12_device_copy_subresource_data(resource->device, resource->format, src_data, subresource_layout->row_pitch,
             subresource_layout->depth_pitch, dst_data, dst_row_pitch, dst_slice_pitch,
-            src_box->right - src_box->left, src_box->bottom - src_box->top, src_box->back - src_box->front);
+            src_box->right - src_box->left, src_box->bottom - src_box->top, src_box->back - src_box->front, false);
 
     return S_OK;
 }
@@ -2521,6 +3443,130 @@ cleanup:
     return hr;
 }
 
+const struct d3d12_sparse_tile_run *d3d12_sparse_info_find_run(const struct d3d12_sparse_info *sparse,
+        uint32_t tile_index)
+{
+    size_t lo = 0, hi = sparse->run_count;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        const struct d3d12_sparse_tile_run *run = &sparse->runs[mid];
+
+        if (tile_index < run->tile_index)
+            hi = mid;
+        else if (tile_index >= run->tile_index + run->tile_count)
+            lo = mid + 1;
+        else
+            return run;
+    }
+
+    return NULL;
+}
+
+static bool d3d12_sparse_tile_runs_can_merge(const struct d3d12_sparse_tile_run *a,
+        const struct d3d12_sparse_tile_run *b)
+{
+    return a->vk_memory == b->vk_memory &&
+            (!a->vk_memory || a->vk_offset + (VkDeviceSize)a->tile_count * VKD3D_TILE_SIZE == b->vk_offset);
+}
+
+bool d3d12_sparse_info_map_tiles(struct d3d12_sparse_info *sparse, uint32_t tile_index,
+        uint32_t tile_count, VkDeviceMemory vk_memory, VkDeviceSize vk_offset)
+{
+    struct d3d12_sparse_tile_run new_runs[3];
+    const struct d3d12_sparse_tile_run *run;
+    struct d3d12_sparse_tile_run *head;
+    size_t first, last, new_count, i;
+    uint32_t end_tile;
+
+    if (!tile_count)
+        return true;
+
+    end_tile = tile_index + tile_count;
+
+    if (!(run = d3d12_sparse_info_find_run(sparse, tile_index)))
+        return false;
+    first = run - sparse->runs;
+
+    if (!(run = d3d12_sparse_info_find_run(sparse, end_tile - 1)))
+        return false;
+    last = run - sparse->runs;
+
+    /* Split the first and last overlapping runs around the new run. */
+    new_count = 0;
+
+    if (sparse->runs[first].tile_index < tile_index)
+    {
+        new_runs[new_count] = sparse->runs[first];
+        new_runs[new_count].tile_count = tile_index - sparse->runs[first].tile_index;
+        new_count++;
+    }
+
+    new_runs[new_count].tile_index = tile_index;
+    new_runs[new_count].tile_count = tile_count;
+    new_runs[new_count].vk_memory = vk_memory;
+    new_runs[new_count].vk_offset = vk_memory ? vk_offset : 0;
+    new_count++;
+
+    run = &sparse->runs[last];
+
+    if (run->tile_index + run->tile_count > end_tile)
+    {
+        new_runs[new_count].tile_index = end_tile;
+        new_runs[new_count].tile_count = run->tile_index + run->tile_count - end_tile;
+        new_runs[new_count].vk_memory = run->vk_memory;
+        new_runs[new_count].vk_offset = run->vk_memory ?
+                run->vk_offset + (VkDeviceSize)(end_tile - run->tile_index) * VKD3D_TILE_SIZE : 0;
+        new_count++;
+    }
+
+    /* Merge with untouched neighbours so that the run count stays minimal. */
+    if (first && d3d12_sparse_tile_runs_can_merge(&sparse->runs[first - 1], &new_runs[0]))
+    {
+        first--;
+        new_runs[0].tile_index = sparse->runs[first].tile_index;
+        new_runs[0].tile_count += sparse->runs[first].tile_count;
+        new_runs[0].vk_offset = sparse->runs[first].vk_offset;
+    }
+
+    if (last + 1 < sparse->run_count && d3d12_sparse_tile_runs_can_merge(&new_runs[new_count - 1], &sparse->runs[last + 1]))
+    {
+        last++;
+        new_runs[new_count - 1].tile_count += sparse->runs[last].tile_count;
+    }
+
+    for (i = 1; i < new_count; )
+    {
+        head = &new_runs[i - 1];
+
+        if (d3d12_sparse_tile_runs_can_merge(head, &new_runs[i]))
+        {
+            head->tile_count += new_runs[i].tile_count;
+            memmove(&new_runs[i], &new_runs[i + 1], (new_count - i - 1) * sizeof(*new_runs));
+            new_count--;
+        }
+        else
+            i++;
+    }
+
+    if (new_count > last - first + 1)
+    {
+        if (!vkd3d_array_reserve((void **)&sparse->runs, &sparse->runs_size,
+                sparse->run_count + new_count - (last - first + 1), sizeof(*sparse->runs)))
+        {
+            ERR("Failed to allocate tile runs.\n");
+            return false;
+        }
+    }
+
+    memmove(&sparse->runs[first + new_count], &sparse->runs[last + 1],
+            (sparse->run_count - last - 1) * sizeof(*sparse->runs));
+    memcpy(&sparse->runs[first], new_runs, new_count * sizeof(*new_runs));
+    sparse->run_count = sparse->run_count + new_count - (last - first + 1);
+    return true;
+}
+
 static HRESULT d3d12_resource_init_sparse_info(struct d3d12_resource *resource,
         struct d3d12_device *device, struct d3d12_sparse_info *sparse)
 {
@@ -2552,6 +3598,21 @@ static HRESULT d3d12_resource_init_sparse_info(struct d3d12_resource *resource,
         return E_OUTOFMEMORY;
     }
 
+    if (sparse->tile_count)
+    {
+        if (!vkd3d_array_reserve((void **)&sparse->runs, &sparse->runs_size, 1, sizeof(*sparse->runs)))
+        {
+            ERR("Failed to allocate tile runs.\n");
+            return E_OUTOFMEMORY;
+        }
+
+        sparse->runs[0].tile_index = 0;
+        sparse->runs[0].tile_count = sparse->tile_count;
+        sparse->runs[0].vk_memory = VK_NULL_HANDLE;
+        sparse->runs[0].vk_offset = 0;
+        sparse->run_count = 1;
+    }
+
     tile_offset.x = 0;
     tile_offset.y = 0;
     tile_offset.z = 0;
@@ -2616,9 +3677,6 @@ static HRESULT d3d12_resource_init_sparse_info(struct d3d12_resource *resource,
                 }
             }
         }
-
-        sparse->tiles[i].vk_memory = VK_NULL_HANDLE;
-        sparse->tiles[i].vk_offset = 0;
     }
 
     if (FAILED(hr = d3d12_resource_bind_sparse_metadata(resource, device, sparse)))
@@ -2627,50 +3685,112 @@ static HRESULT d3d12_resource_init_sparse_info(struct d3d12_resource *resource,
     return S_OK;
 }
 
-static void d3d12_resource_destroy(struct d3d12_resource *resource, struct d3d12_device *device)
+#define VKD3D_RESOURCE_DESTROY_BATCH_SIZE 64u
+
+/* Tears down a batch of resources in phases, so that VA map and allocator
+ * updates for the whole batch are done under a single lock acquisition. */
+static void d3d12_resource_destroy_batch(struct d3d12_resource **resources, size_t count,
+        struct d3d12_device *device)
 {
+    const struct vkd3d_memory_allocation *allocations[2 * VKD3D_RESOURCE_DESTROY_BATCH_SIZE];
+    const struct vkd3d_unique_resource *va_resources[VKD3D_RESOURCE_DESTROY_BATCH_SIZE];
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    size_t i, batch_count, allocation_count, va_count;
+    struct d3d12_resource *resource;
+
+    /* Binding right before destruction is cheaper than removing the images from the queue. */
+    for (i = 0; i < count; i++)
+    {
+        if (resources[i]->flags & VKD3D_RESOURCE_DEFERRED_BIND)
+        {
+            vkd3d_memory_bind_queue_flush_if_pending(&device->memory_binds, device);
+            break;
+        }
+    }
 
-    vkd3d_view_map_destroy(&resource->view_map, resource->device);
+    while (count)
+    {
+        batch_count = min(count, VKD3D_RESOURCE_DESTROY_BATCH_SIZE);
+        allocation_count = 0;
+        va_count = 0;
 
-    vkd3d_descriptor_debug_unregister_cookie(device->descriptor_qa_global_info, resource->res.cookie);
+        for (i = 0; i < batch_count; i++)
+        {
+            resource = resources[i];
 
-    if (resource->flags & VKD3D_RESOURCE_EXTERNAL)
-        return;
+            vkd3d_view_map_destroy(&resource->view_map, resource->device);
+            vkd3d_residency_manager_unregister(&device->residency_manager, &resource->priority);
 
-    if (resource->flags & VKD3D_RESOURCE_RESERVED)
-    {
-        vkd3d_free_device_memory(device, &resource->sparse.vk_metadata_memory);
-        vkd3d_free(resource->sparse.tiles);
-        vkd3d_free(resource->sparse.tilings);
+            vkd3d_descriptor_debug_unregister_cookie(device->descriptor_qa_global_info, resource->res.cookie);
 
-        if (resource->res.va)
-            vkd3d_va_map_remove(&device->memory_allocator.va_map, &resource->res);
-    }
+            if ((resource->flags & (VKD3D_RESOURCE_EXTERNAL | VKD3D_RESOURCE_RESERVED)) == VKD3D_RESOURCE_RESERVED)
+            {
+                vkd3d_free_device_memory(device, &resource->sparse.vk_metadata_memory);
+                vkd3d_free(resource->sparse.tiles);
+                vkd3d_free(resource->sparse.runs);
+                vkd3d_free(resource->sparse.tilings);
 
-    if (d3d12_resource_is_texture(resource))
-        VK_CALL(vkDestroyImage(device->vk_device, resource->res.vk_image, NULL));
-    else if (resource->flags & VKD3D_RESOURCE_RESERVED)
-        VK_CALL(vkDestroyBuffer(device->vk_device, resource->res.vk_buffer, NULL));
+                if (resource->res.va)
+                    va_resources[va_count++] = &resource->res;
+            }
+        }
 
-    if ((resource->flags & VKD3D_RESOURCE_ALLOCATION) && resource->mem.device_allocation.vk_memory)
-        vkd3d_free_memory(device, &device->memory_allocator, &resource->mem);
+        if (va_count)
+            vkd3d_va_map_remove_batch(&device->memory_allocator.va_map, va_resources, va_count);
 
-    if (resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY)
-    {
-        if (resource->private_mem.device_allocation.vk_memory)
-            vkd3d_free_memory(device, &device->memory_allocator, &resource->private_mem);
+        for (i = 0; i < batch_count; i++)
+        {
+            resource = resources[i];
 
-        vkd3d_free(resource->subresource_layouts);
-    }
+            if (resource->flags & VKD3D_RESOURCE_EXTERNAL)
+                continue;
+
+            if (d3d12_resource_is_texture(resource))
+                VK_CALL(vkDestroyImage(device->vk_device, resource->res.vk_image, NULL));
+            else if (resource->flags & VKD3D_RESOURCE_RESERVED)
+                VK_CALL(vkDestroyBuffer(device->vk_device, resource->res.vk_buffer, NULL));
+
+            if ((resource->flags & VKD3D_RESOURCE_ALLOCATION) && resource->mem.device_allocation.vk_memory)
+                allocations[allocation_count++] = &resource->mem;
+
+            if ((resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY) &&
+                    resource->private_mem.device_allocation.vk_memory)
+                allocations[allocation_count++] = &resource->private_mem;
+
+            if (resource->vrs_view)
+                VK_CALL(vkDestroyImageView(device->vk_device, resource->vrs_view, NULL));
+        }
+
+        if (allocation_count)
+            vkd3d_free_memory_batch(device, &device->memory_allocator, allocations, allocation_count);
+
+        for (i = 0; i < batch_count; i++)
+        {
+            resource = resources[i];
+
+            if (resource->flags & VKD3D_RESOURCE_EXTERNAL)
+                continue;
+
+            if (resource->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY)
+                vkd3d_free(resource->subresource_layouts);
 
-    if (resource->vrs_view)
-        VK_CALL(vkDestroyImageView(device->vk_device, resource->vrs_view, NULL));
+            vkd3d_private_store_destroy(&resource->private_store);
+            if (resource->heap)
+            {
+                d3d12_heap_unregister_placed_resource(resource->heap, resource);
+                d3d12_heap_decref(resource->heap);
+            }
+            vkd3d_free(resource);
+        }
+
+        resources += batch_count;
+        count -= batch_count;
+    }
+}
 
-    vkd3d_private_store_destroy(&resource->private_store);
-    if (resource->heap)
-        d3d12_heap_decref(resource->heap);
-    vkd3d_free(resource);
+static void d3d12_resource_destroy(struct d3d12_resource *resource, struct d3d12_device *device)
+{
+    d3d12_resource_destroy_batch(&resource, 1, device);
 }
 
 static void d3d12_resource_destroy_and_release_device(struct d3d12_resource *resource,
@@ -2800,6 +3920,8 @@ static HRESULT d3d12_resource_create(struct d3d12_device *device, uint32_t flags
     object->priority.allows_dynamic_residency = false;
     object->priority.d3d12priority = D3D12_RESIDENCY_PRIORITY_NORMAL;
     object->priority.residency_count = 1;
+    object->priority.demoted = false;
+    object->priority.tracked = false;
 #ifdef VKD3D_ENABLE_DESCRIPTOR_QA
     object->view_map.resource_cookie = object->res.cookie;
 #endif
@@ -2866,6 +3988,25 @@ static void d3d12_resource_tag_debug_name(struct d3d12_resource *resource,
         vkd3d_set_vk_object_name(device, (uint64_t)resource->res.vk_buffer, VK_OBJECT_TYPE_BUFFER, name_buffer);
 }
 
+static bool d3d12_resource_committed_buffer_prefers_host_visible_vram(struct d3d12_device *device,
+        const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags, const D3D12_RESOURCE_DESC1 *desc)
+{
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEFAULT_BUFFER_HVV))
+        return false;
+
+    /* Only bother where UPLOAD heaps already live in host-visible VRAM, i.e. resizable BAR or UMA.
+     * On small BAR, the 256 MB window is too precious to spend on DEFAULT buffers. */
+    if (!(device->memory_info.upload_heap_memory_properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+        return false;
+
+    /* The only thing gained is that the zero-clear happens on the CPU, so only consider
+     * small buffers which are suballocated and would otherwise need a GPU clear. */
+    return heap_properties->Type == D3D12_HEAP_TYPE_DEFAULT &&
+            desc->Width < VKD3D_VA_BLOCK_SIZE &&
+            !(heap_flags & (D3D12_HEAP_FLAG_SHARED | D3D12_HEAP_FLAG_CREATE_NOT_ZEROED)) &&
+            !(desc->Flags & D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER);
+}
+
 HRESULT d3d12_resource_create_committed(struct d3d12_device *device, const D3D12_RESOURCE_DESC1 *desc,
         const D3D12_HEAP_PROPERTIES *heap_properties, D3D12_HEAP_FLAGS heap_flags, D3D12_RESOURCE_STATES initial_state,
         const D3D12_CLEAR_VALUE *optimized_clear_value, HANDLE shared_handle, struct d3d12_resource **resource)
@@ -2878,7 +4019,12 @@ HRESULT d3d12_resource_create_committed(struct d3d12_device *device, const D3D12
             desc, heap_properties, heap_flags, initial_state, optimized_clear_value, &object)))
         return hr;
 
-    if (d3d12_resource_is_texture(object))
+    if (d3d12_resource_is_texture(object) && d3d12_resource_acquire_recycled(object, device))
+    {
+        if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEBUG_UTILS)
+            d3d12_resource_tag_debug_name(object, device, "Committed Texture (recycled)");
+    }
+    else if (d3d12_resource_is_texture(object))
     {
         VkMemoryDedicatedRequirements dedicated_requirements;
         struct vkd3d_allocate_memory_info allocate_info;
@@ -2994,6 +4140,11 @@ HRESULT d3d12_resource_create_committed(struct d3d12_device *device, const D3D12
         if (FAILED(hr = vkd3d_allocate_memory(device, &device->memory_allocator, &allocate_info, allocation)))
             goto fail;
 
+        /* The clear is only flushed on the next submission, which gives
+         * the queue a chance to drop it if the texture gets overwritten. */
+        if (allocation == &object->mem && allocation->clear_semaphore_value && !allocation->cpu_address)
+            object->lazy_clear = 1;
+
         bind_info.sType = VK_STRUCTURE_TYPE_BIND_IMAGE_MEMORY_INFO;
         bind_info.pNext = NULL;
         bind_info.image = object->res.vk_image;
@@ -3054,7 +4205,17 @@ HRESULT d3d12_resource_create_committed(struct d3d12_device *device, const D3D12
             allocate_info.heap_desc.Flags &= ~D3D12_HEAP_FLAG_CREATE_NOT_ZEROED;
         }
 
-        if (FAILED(hr = vkd3d_allocate_heap_memory(device,
+        hr = E_OUTOFMEMORY;
+        if (d3d12_resource_committed_buffer_prefers_host_visible_vram(device,
+                heap_properties, allocate_info.heap_desc.Flags, desc))
+        {
+            allocate_info.extra_allocation_flags = VKD3D_ALLOCATION_FLAG_HOST_VISIBLE_VRAM;
+            hr = vkd3d_allocate_heap_memory(device, &device->memory_allocator, &allocate_info, &object->mem);
+            allocate_info.extra_allocation_flags = 0;
+        }
+
+        /* Host-visible VRAM may be exhausted or budgeted, just use normal DEFAULT memory then. */
+        if (FAILED(hr) && FAILED(hr = vkd3d_allocate_heap_memory(device,
                 &device->memory_allocator, &allocate_info, &object->mem)))
             goto fail;
 
@@ -3067,6 +4228,17 @@ HRESULT d3d12_resource_create_committed(struct d3d12_device *device, const D3D12
         object->mem.chunk == NULL /* not suballocated */ &&
         (device->memory_properties.memoryTypes[object->mem.device_allocation.vk_memory_type].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
+    if (object->priority.allows_dynamic_residency)
+    {
+        vkd3d_residency_manager_register(&device->residency_manager,
+                &object->priority, &object->mem.device_allocation);
+    }
+
+    /* Committed textures cannot alias other resources, so the initial transition can
+     * happen on the memory transfer queue together with the clear, ahead of first use. */
+    if (d3d12_resource_is_texture(object))
+        vkd3d_memory_transfer_queue_initial_transition(&device->memory_transfers, object);
+
     *resource = object;
     return S_OK;
 
@@ -3102,9 +4274,9 @@ static HRESULT d3d12_resource_validate_heap(const D3D12_RESOURCE_DESC1 *resource
     return S_OK;
 }
 
-HRESULT d3d12_resource_create_placed(struct d3d12_device *device, const D3D12_RESOURCE_DESC1 *desc,
+static HRESULT d3d12_resource_create_placed_internal(struct d3d12_device *device, const D3D12_RESOURCE_DESC1 *desc,
         struct d3d12_heap *heap, uint64_t heap_offset, D3D12_RESOURCE_STATES initial_state,
-        const D3D12_CLEAR_VALUE *optimized_clear_value, struct d3d12_resource **resource)
+        const D3D12_CLEAR_VALUE *optimized_clear_value, bool defer_bind, struct d3d12_resource **resource)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
     struct vkd3d_allocate_memory_info allocate_info;
@@ -3190,6 +4362,8 @@ HRESULT d3d12_resource_create_placed(struct d3d12_device *device, const D3D12_RE
             hr = E_INVALIDARG;
             goto fail;
         }
+
+        memory_requirements.size = desc->Width;
     }
 
     vkd3d_memory_allocation_slice(&object->mem, &heap->allocation, heap_offset, 0);
@@ -3211,7 +4385,15 @@ HRESULT d3d12_resource_create_placed(struct d3d12_device *device, const D3D12_RE
             bind_info.memoryOffset = object->mem.offset;
         }
 
-        if ((vr = VK_CALL(vkBindImageMemory2(device->vk_device, 1, &bind_info))) < 0)
+        /* Aliasing transient allocators create placed textures in bulk, so batch their binds.
+         * The implicit VRS view needs bound memory right away. */
+        if (defer_bind && !(object->flags & VKD3D_RESOURCE_LINEAR_STAGING_COPY) &&
+                !vkd3d_resource_can_be_vrs(device, &heap->desc.Properties, desc) &&
+                vkd3d_memory_bind_queue_push(&device->memory_binds, device, &bind_info))
+        {
+            object->flags |= VKD3D_RESOURCE_DEFERRED_BIND;
+        }
+        else if ((vr = VK_CALL(vkBindImageMemory2(device->vk_device, 1, &bind_info))) < 0)
         {
             ERR("Failed to bind image memory, vr %d.\n", vr);
             hr = hresult_from_vk_result(vr);
@@ -3252,6 +4434,8 @@ HRESULT d3d12_resource_create_placed(struct d3d12_device *device, const D3D12_RE
         }
     }
 
+    d3d12_heap_register_placed_resource(heap, object, heap_offset, memory_requirements.size);
+
     *resource = object;
     return S_OK;
 
@@ -3260,6 +4444,42 @@ fail:
     return hr;
 }
 
+HRESULT d3d12_resource_create_placed(struct d3d12_device *device, const D3D12_RESOURCE_DESC1 *desc,
+        struct d3d12_heap *heap, uint64_t heap_offset, D3D12_RESOURCE_STATES initial_state,
+        const D3D12_CLEAR_VALUE *optimized_clear_value, struct d3d12_resource **resource)
+{
+    return d3d12_resource_create_placed_internal(device, desc, heap, heap_offset, initial_state,
+            optimized_clear_value, !!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEFERRED_MEMORY_BIND), resource);
+}
+
+HRESULT d3d12_resource_create_transient_slots(struct d3d12_device *device, struct d3d12_heap *heap,
+        unsigned int slot_count, const D3D12_TRANSIENT_RESOURCE_SLOT_DESC *slot_descs,
+        struct d3d12_resource **resources)
+{
+    const D3D12_TRANSIENT_RESOURCE_SLOT_DESC *slot;
+    unsigned int i;
+    HRESULT hr;
+
+    /* Slots are created together, so always batch their binds. */
+    for (i = 0; i < slot_count; i++)
+    {
+        slot = &slot_descs[i];
+
+        if (FAILED(hr = d3d12_resource_create_placed_internal(device, &slot->Desc, heap, slot->HeapOffset,
+                slot->InitialState, slot->pOptimizedClearValue, true, &resources[i])))
+        {
+            WARN("Failed to create transient resource slot %u, hr %#x.\n", i, hr);
+
+            while (i--)
+                ID3D12Resource2_Release(&resources[i]->ID3D12Resource_iface);
+            return hr;
+        }
+    }
+
+    vkd3d_memory_bind_queue_flush(&device->memory_binds, device);
+    return S_OK;
+}
+
 HRESULT d3d12_resource_create_reserved(struct d3d12_device *device,
         const D3D12_RESOURCE_DESC1 *desc, D3D12_RESOURCE_STATES initial_state,
         const D3D12_CLEAR_VALUE *optimized_clear_value, struct d3d12_resource **resource)
@@ -3420,6 +4640,17 @@ void vkd3d_view_decref(struct vkd3d_view *view, struct d3d12_device *device)
         vkd3d_view_destroy(view, device);
 }
 
+static uint64_t d3d12_desc_fingerprint_counter;
+
+static inline void d3d12_desc_update_fingerprint(const struct d3d12_desc_split *d)
+{
+    if (d->heap->copy_fingerprints)
+    {
+        d->heap->copy_fingerprints[d->offset] = vkd3d_atomic_uint64_increment(
+                &d3d12_desc_fingerprint_counter, vkd3d_memory_order_relaxed);
+    }
+}
+
 void d3d12_desc_copy_single(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descriptor_va_t src_va,
         struct d3d12_device *device)
 {
@@ -3436,6 +4667,9 @@ void d3d12_desc_copy_single(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descript
     src = d3d12_desc_decode_va(src_va);
     dst = d3d12_desc_decode_va(dst_va);
 
+    if (d3d12_desc_copy_is_redundant(&dst, &src, 0))
+        return;
+
     flags = src.types->flags;
     set_mask = src.types->set_info_mask;
 
@@ -3521,7 +4755,7 @@ void d3d12_desc_copy_single(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descript
     *dst.view = *src.view;
 }
 
-void d3d12_desc_copy_range(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descriptor_va_t src_va,
+static void d3d12_desc_copy_range_unchecked(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descriptor_va_t src_va,
         unsigned int count, D3D12_DESCRIPTOR_HEAP_TYPE heap_type, struct d3d12_device *device)
 {
     VkCopyDescriptorSet vk_copies[VKD3D_MAX_BINDLESS_DESCRIPTOR_SETS];
@@ -3591,6 +4825,39 @@ void d3d12_desc_copy_range(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descripto
         VK_CALL(vkUpdateDescriptorSets(device->vk_device, 0, NULL, copy_count, vk_copies));
 }
 
+void d3d12_desc_copy_range(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descriptor_va_t src_va,
+        unsigned int count, D3D12_DESCRIPTOR_HEAP_TYPE heap_type, struct d3d12_device *device)
+{
+    struct d3d12_desc_split src, dst;
+    unsigned int i, run_start;
+
+    dst = d3d12_desc_decode_va(dst_va);
+
+    if (!dst.heap->copy_fingerprints)
+    {
+        d3d12_desc_copy_range_unchecked(dst_va, src_va, count, heap_type, device);
+        return;
+    }
+
+    src = d3d12_desc_decode_va(src_va);
+
+    /* Only copy the runs of descriptors which the destination does not already hold,
+     * which avoids rewriting unchanged descriptors in host visible VRAM. */
+    for (i = 0, run_start = 0; i <= count; i++)
+    {
+        if (i == count || d3d12_desc_copy_is_redundant(&dst, &src, i))
+        {
+            if (i > run_start)
+            {
+                d3d12_desc_copy_range_unchecked(dst_va + run_start * VKD3D_RESOURCE_DESC_INCREMENT,
+                        src_va + run_start * VKD3D_RESOURCE_DESC_INCREMENT,
+                        i - run_start, heap_type, device);
+            }
+            run_start = i + 1;
+        }
+    }
+}
+
 void d3d12_desc_copy(vkd3d_cpu_descriptor_va_t dst_va, vkd3d_cpu_descriptor_va_t src_va,
         unsigned int count, D3D12_DESCRIPTOR_HEAP_TYPE heap_type, struct d3d12_device *device)
 {
@@ -4020,6 +5287,8 @@ bool vkd3d_create_texture_view(struct d3d12_device *device, const struct vkd3d_t
     uint32_t end_level;
     VkResult vr;
 
+    vkd3d_memory_bind_queue_flush_if_pending(&device->memory_binds, device);
+
     view_desc.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     view_desc.pNext = NULL;
     view_desc.flags = 0;
@@ -4164,6 +5433,7 @@ static void d3d12_descriptor_heap_write_null_descriptor_template(vkd3d_cpu_descr
     uint8_t *dst;
 
     desc = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&desc);
 
     null_descriptor_template = &desc.heap->null_descriptor_template;
 
@@ -4324,6 +5594,7 @@ void d3d12_desc_create_cbv(vkd3d_cpu_descriptor_va_t desc_va,
     }
 
     d = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&d);
 
     info_index = vkd3d_bindless_state_find_set_info_index(&device->bindless_state, VKD3D_BINDLESS_SET_CBV);
     binding = vkd3d_bindless_state_binding_from_info_index(&device->bindless_state, info_index);
@@ -4615,6 +5886,7 @@ static void vkd3d_create_buffer_srv(vkd3d_cpu_descriptor_va_t desc_va,
     }
 
     d = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&d);
 
     if (desc->ViewDimension == D3D12_SRV_DIMENSION_RAYTRACING_ACCELERATION_STRUCTURE)
     {
@@ -5047,6 +6319,7 @@ static void vkd3d_create_texture_srv(vkd3d_cpu_descriptor_va_t desc_va,
     }
 
     d = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&d);
 
     view = vkd3d_create_texture_srv_view(device, resource, desc);
 
@@ -5322,6 +6595,7 @@ static void vkd3d_create_buffer_uav(vkd3d_cpu_descriptor_va_t desc_va, struct d3
     }
 
     d = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&d);
 
     /* Handle UAV itself */
     d.types->set_info_mask = 0;
@@ -5528,6 +6802,7 @@ static void vkd3d_create_texture_uav(vkd3d_cpu_descriptor_va_t desc_va,
     }
 
     d = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&d);
 
     view = vkd3d_create_texture_uav_view(device, resource, desc);
 
@@ -5627,23 +6902,6 @@ void d3d12_desc_create_uav(vkd3d_cpu_descriptor_va_t desc_va, struct d3d12_devic
         vkd3d_create_texture_uav(desc_va, device, resource, desc);
 }
 
-bool vkd3d_create_raw_buffer_view(struct d3d12_device *device,
-        D3D12_GPU_VIRTUAL_ADDRESS gpu_address, VkBufferView *vk_buffer_view)
-{
-    const struct vkd3d_unique_resource *resource;
-    uint64_t range;
-    uint64_t offset;
-
-    resource = vkd3d_va_map_deref(&device->memory_allocator.va_map, gpu_address);
-    assert(resource && resource->va && resource->size);
-
-    offset = gpu_address - resource->va;
-    range = min(resource->size - offset, device->vk_info.device_limits.maxStorageBufferRange);
-
-    return vkd3d_create_raw_r32ui_vk_buffer_view(device, resource->vk_buffer,
-            offset, range, vk_buffer_view);
-}
-
 /* samplers */
 static VkFilter vk_filter_from_d3d12(D3D12_FILTER_TYPE type)
 {
@@ -5869,13 +7127,89 @@ static HRESULT d3d12_create_sampler(struct d3d12_device *device,
     return hresult_from_vk_result(vr);
 }
 
+HRESULT vkd3d_sampler_payload_cache_init(struct vkd3d_sampler_payload_cache *cache, struct d3d12_device *device)
+{
+    memset(cache, 0, sizeof(*cache));
+
+    if (!d3d12_device_use_embedded_mutable_descriptors(device))
+        return S_OK;
+
+    cache->payload_size = device->device_info.descriptor_buffer_properties.samplerDescriptorSize;
+    if (cache->payload_size > VKD3D_SAMPLER_PAYLOAD_MAX_SIZE)
+        return S_OK;
+
+    if (!(cache->entries = vkd3d_calloc(VKD3D_SAMPLER_PAYLOAD_CACHE_SIZE, sizeof(*cache->entries))))
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
+void vkd3d_sampler_payload_cache_cleanup(struct vkd3d_sampler_payload_cache *cache)
+{
+    vkd3d_free(cache->entries);
+}
+
+static bool vkd3d_sampler_payload_cache_find(struct vkd3d_sampler_payload_cache *cache,
+        const D3D12_SAMPLER_DESC *desc, uint32_t hash, void *payload)
+{
+    struct vkd3d_sampler_payload_entry *entry;
+    uint32_t i, state;
+
+    for (i = 0; i < VKD3D_SAMPLER_PAYLOAD_CACHE_MAX_PROBES; i++)
+    {
+        entry = &cache->entries[(hash + i) % VKD3D_SAMPLER_PAYLOAD_CACHE_SIZE];
+        state = vkd3d_atomic_uint32_load_explicit(&entry->state, vkd3d_memory_order_acquire);
+
+        if (state == VKD3D_SAMPLER_PAYLOAD_ENTRY_EMPTY)
+            return false;
+
+        if (state == VKD3D_SAMPLER_PAYLOAD_ENTRY_READY && entry->hash == hash &&
+                !memcmp(&entry->desc, desc, sizeof(*desc)))
+        {
+            memcpy(payload, entry->payload, cache->payload_size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void vkd3d_sampler_payload_cache_insert(struct vkd3d_sampler_payload_cache *cache,
+        const D3D12_SAMPLER_DESC *desc, uint32_t hash, const void *payload)
+{
+    struct vkd3d_sampler_payload_entry *entry;
+    uint32_t i;
+
+    /* Entries are never removed. If two threads race on the same sampler,
+     * both insert identical payloads, which is harmless. */
+    for (i = 0; i < VKD3D_SAMPLER_PAYLOAD_CACHE_MAX_PROBES; i++)
+    {
+        entry = &cache->entries[(hash + i) % VKD3D_SAMPLER_PAYLOAD_CACHE_SIZE];
+
+        if (vkd3d_atomic_uint32_compare_exchange(&entry->state,
+                VKD3D_SAMPLER_PAYLOAD_ENTRY_EMPTY, VKD3D_SAMPLER_PAYLOAD_ENTRY_WRITING,
+                vkd3d_memory_order_acquire, vkd3d_memory_order_relaxed) == VKD3D_SAMPLER_PAYLOAD_ENTRY_EMPTY)
+        {
+            entry->hash = hash;
+            entry->desc = *desc;
+            memcpy(entry->payload, payload, cache->payload_size);
+            vkd3d_atomic_uint32_store_explicit(&entry->state,
+                    VKD3D_SAMPLER_PAYLOAD_ENTRY_READY, vkd3d_memory_order_release);
+            return;
+        }
+    }
+}
+
 void d3d12_desc_create_sampler_embedded(vkd3d_cpu_descriptor_va_t desc_va,
         struct d3d12_device *device, const D3D12_SAMPLER_DESC *desc)
 {
+    struct vkd3d_sampler_payload_cache *cache = &device->sampler_payload_cache;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    uint8_t payload[VKD3D_SAMPLER_PAYLOAD_MAX_SIZE];
     VkDescriptorGetInfoEXT get_info;
     struct vkd3d_view_key key;
     struct vkd3d_view *view;
+    uint32_t hash = 0;
 
     if (!desc)
     {
@@ -5886,6 +7220,13 @@ void d3d12_desc_create_sampler_embedded(vkd3d_cpu_descriptor_va_t desc_va,
     key.view_type = VKD3D_VIEW_TYPE_SAMPLER;
     key.u.sampler = *desc;
 
+    if (cache->entries)
+    {
+        hash = vkd3d_view_entry_hash(&key);
+        if (vkd3d_sampler_payload_cache_find(cache, desc, hash, (void *)desc_va))
+            return;
+    }
+
     if (!(view = vkd3d_view_map_create_view(&device->sampler_map, device, &key)))
         return;
 
@@ -5893,9 +7234,20 @@ void d3d12_desc_create_sampler_embedded(vkd3d_cpu_descriptor_va_t desc_va,
     get_info.pNext = NULL;
     get_info.type = VK_DESCRIPTOR_TYPE_SAMPLER;
     get_info.data.pSampler = &view->vk_sampler;
-    VK_CALL(vkGetDescriptorEXT(device->vk_device, &get_info,
-            device->device_info.descriptor_buffer_properties.samplerDescriptorSize,
-            (void *)desc_va));
+
+    if (cache->entries)
+    {
+        /* Don't read back from the heap, it is likely write-combined. */
+        VK_CALL(vkGetDescriptorEXT(device->vk_device, &get_info, cache->payload_size, payload));
+        memcpy((void *)desc_va, payload, cache->payload_size);
+        vkd3d_sampler_payload_cache_insert(cache, desc, hash, payload);
+    }
+    else
+    {
+        VK_CALL(vkGetDescriptorEXT(device->vk_device, &get_info,
+                device->device_info.descriptor_buffer_properties.samplerDescriptorSize,
+                (void *)desc_va));
+    }
 }
 
 void d3d12_desc_create_sampler(vkd3d_cpu_descriptor_va_t desc_va,
@@ -5919,6 +7271,7 @@ void d3d12_desc_create_sampler(vkd3d_cpu_descriptor_va_t desc_va,
     }
 
     d = d3d12_desc_decode_va(desc_va);
+    d3d12_desc_update_fingerprint(&d);
 
     key.view_type = VKD3D_VIEW_TYPE_SAMPLER;
     key.u.sampler = *desc;
@@ -6314,6 +7667,189 @@ CONST_VTBL struct ID3D12DescriptorHeapVtbl d3d12_descriptor_heap_vtbl =
     d3d12_descriptor_heap_GetGPUDescriptorHandleForHeapStart,
 };
 
+static HRESULT vkd3d_descriptor_arena_init(struct vkd3d_descriptor_arena *arena)
+{
+    int rc;
+
+    list_init(&arena->blocks);
+
+    if ((rc = pthread_mutex_init(&arena->mutex, NULL)))
+        return hresult_from_errno(rc);
+
+    return S_OK;
+}
+
+static void vkd3d_descriptor_arena_block_destroy(struct vkd3d_descriptor_arena_block *block,
+        struct d3d12_device *device)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    VK_CALL(vkDestroyBuffer(device->vk_device, block->vk_buffer, NULL));
+    vkd3d_free_device_memory(device, &block->device_allocation);
+    vkd3d_free(block);
+}
+
+static void vkd3d_descriptor_arena_cleanup(struct vkd3d_descriptor_arena *arena, struct d3d12_device *device)
+{
+    struct vkd3d_descriptor_arena_block *block, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(block, next, &arena->blocks, struct vkd3d_descriptor_arena_block, entry)
+    {
+        WARN("Destroying descriptor arena block %p with %u live allocations.\n", block, block->allocation_count);
+        vkd3d_descriptor_arena_block_destroy(block, device);
+    }
+
+    pthread_mutex_destroy(&arena->mutex);
+}
+
+static HRESULT vkd3d_descriptor_arena_block_create(struct d3d12_device *device,
+        VkBufferUsageFlags usage, struct vkd3d_descriptor_arena_block **out_block)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_descriptor_arena_block *block;
+    VkResult vr;
+    HRESULT hr;
+
+    if (!(block = vkd3d_calloc(1, sizeof(*block))))
+        return E_OUTOFMEMORY;
+
+    if (FAILED(hr = vkd3d_create_buffer_explicit_usage(device, usage,
+            VKD3D_DESCRIPTOR_ARENA_BLOCK_SIZE, &block->vk_buffer)))
+    {
+        vkd3d_free(block);
+        return hr;
+    }
+
+    if (FAILED(hr = vkd3d_allocate_internal_buffer_memory(device, block->vk_buffer,
+            device->memory_info.descriptor_heap_memory_properties, &block->device_allocation)))
+    {
+        VK_CALL(vkDestroyBuffer(device->vk_device, block->vk_buffer, NULL));
+        vkd3d_free(block);
+        return hr;
+    }
+
+    if ((vr = VK_CALL(vkMapMemory(device->vk_device, block->device_allocation.vk_memory,
+            0, VK_WHOLE_SIZE, 0, (void **)&block->host_allocation))))
+    {
+        ERR("Failed to map descriptor arena memory.\n");
+        vkd3d_descriptor_arena_block_destroy(block, device);
+        return hresult_from_vk_result(vr);
+    }
+
+    block->va = vkd3d_get_buffer_device_address(device, block->vk_buffer);
+    block->usage = usage;
+
+    TRACE("Created descriptor arena block %p, VA %#"PRIx64".\n", block, block->va);
+
+    *out_block = block;
+    return S_OK;
+}
+
+static void vkd3d_descriptor_arena_block_mark_slots(struct vkd3d_descriptor_arena_block *block,
+        unsigned int first_slot, unsigned int slot_count, bool used)
+{
+    unsigned int i;
+
+    for (i = first_slot; i < first_slot + slot_count; i++)
+    {
+        if (used)
+            block->used_slot_mask[i / 64] |= 1ull << (i % 64);
+        else
+            block->used_slot_mask[i / 64] &= ~(1ull << (i % 64));
+    }
+}
+
+static bool vkd3d_descriptor_arena_block_find_slots(const struct vkd3d_descriptor_arena_block *block,
+        unsigned int slot_count, unsigned int *first_slot)
+{
+    unsigned int i, run = 0;
+
+    for (i = 0; i < VKD3D_DESCRIPTOR_ARENA_SLOT_COUNT; i++)
+    {
+        if (block->used_slot_mask[i / 64] & (1ull << (i % 64)))
+            run = 0;
+        else if (++run == slot_count)
+        {
+            *first_slot = i + 1 - slot_count;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static HRESULT vkd3d_descriptor_arena_allocate(struct vkd3d_descriptor_arena *arena,
+        struct d3d12_device *device, VkBufferUsageFlags usage, VkDeviceSize size,
+        struct vkd3d_descriptor_arena_block **out_block, unsigned int *out_first_slot, unsigned int *out_slot_count)
+{
+    struct vkd3d_descriptor_arena_block *block;
+    unsigned int slot_count, first_slot;
+    HRESULT hr = S_OK;
+
+    slot_count = (size + VKD3D_DESCRIPTOR_ARENA_SLOT_SIZE - 1) / VKD3D_DESCRIPTOR_ARENA_SLOT_SIZE;
+    slot_count = max(slot_count, 1u);
+
+    pthread_mutex_lock(&arena->mutex);
+
+    LIST_FOR_EACH_ENTRY(block, &arena->blocks, struct vkd3d_descriptor_arena_block, entry)
+    {
+        if (block->usage == usage && vkd3d_descriptor_arena_block_find_slots(block, slot_count, &first_slot))
+            goto found;
+    }
+
+    if (FAILED(hr = vkd3d_descriptor_arena_block_create(device, usage, &block)))
+        goto out;
+
+    list_add_tail(&arena->blocks, &block->entry);
+    first_slot = 0;
+
+found:
+    vkd3d_descriptor_arena_block_mark_slots(block, first_slot, slot_count, true);
+    block->allocation_count++;
+
+    *out_block = block;
+    *out_first_slot = first_slot;
+    *out_slot_count = slot_count;
+
+out:
+    pthread_mutex_unlock(&arena->mutex);
+    return hr;
+}
+
+static void vkd3d_descriptor_arena_free(struct vkd3d_descriptor_arena *arena, struct d3d12_device *device,
+        struct vkd3d_descriptor_arena_block *block, unsigned int first_slot, unsigned int slot_count)
+{
+    pthread_mutex_lock(&arena->mutex);
+
+    vkd3d_descriptor_arena_block_mark_slots(block, first_slot, slot_count, false);
+
+    /* Don't hold on to empty blocks, the next heap may well be large enough to get a dedicated buffer. */
+    if (!--block->allocation_count)
+    {
+        list_remove(&block->entry);
+        vkd3d_descriptor_arena_block_destroy(block, device);
+    }
+
+    pthread_mutex_unlock(&arena->mutex);
+}
+
+static struct vkd3d_descriptor_arena *d3d12_descriptor_heap_get_arena(struct d3d12_descriptor_heap *descriptor_heap)
+{
+    struct vkd3d_global_descriptor_buffer *global_descriptor_buffer = &descriptor_heap->device->global_descriptor_buffer;
+
+    if (descriptor_heap->desc.Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
+        return &global_descriptor_buffer->resource_arena;
+    else
+        return &global_descriptor_buffer->sampler_arena;
+}
+
+static void d3d12_descriptor_heap_add_footprint(struct d3d12_descriptor_heap *descriptor_heap, VkDeviceSize size)
+{
+    descriptor_heap->footprint_size += size;
+    vkd3d_memory_footprint_add(&descriptor_heap->device->memory_footprint,
+            VKD3D_MEMORY_FOOTPRINT_DESCRIPTOR_HEAP, size);
+}
+
 static HRESULT d3d12_descriptor_heap_create_descriptor_buffer(struct d3d12_descriptor_heap *descriptor_heap)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &descriptor_heap->device->vk_procs;
@@ -6324,7 +7860,7 @@ static HRESULT d3d12_descriptor_heap_create_descriptor_buffer(struct d3d12_descr
     VkMemoryPropertyFlags property_flags;
     VkDeviceSize total_alloc_size = 0;
     VkDeviceSize descriptor_count;
-    unsigned int i, j, set_count;
+    unsigned int i, set_count;
     VkBufferUsageFlags usage;
     VkDeviceSize alloc_size;
     VkResult vr;
@@ -6424,6 +7960,31 @@ static HRESULT d3d12_descriptor_heap_create_descriptor_buffer(struct d3d12_descr
         else
             usage |= VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
 
+        if (total_alloc_size <= VKD3D_DESCRIPTOR_ARENA_MAX_ALLOCATION_SIZE &&
+                SUCCEEDED(vkd3d_descriptor_arena_allocate(d3d12_descriptor_heap_get_arena(descriptor_heap),
+                        device, usage, total_alloc_size, &descriptor_heap->descriptor_buffer.arena_block,
+                        &descriptor_heap->descriptor_buffer.arena_first_slot,
+                        &descriptor_heap->descriptor_buffer.arena_slot_count)))
+        {
+            const struct vkd3d_descriptor_arena_block *block = descriptor_heap->descriptor_buffer.arena_block;
+            VkDeviceSize arena_offset;
+
+            /* Bind the block itself and fold the suballocation offset into the set offsets,
+             * so that heaps sharing a block share the same descriptor buffer binding. */
+            arena_offset = (VkDeviceSize)descriptor_heap->descriptor_buffer.arena_first_slot *
+                    VKD3D_DESCRIPTOR_ARENA_SLOT_SIZE;
+            for (i = 0; i < set_count; i++)
+            {
+                descriptor_heap->descriptor_buffer.offsets[i] += arena_offset;
+                src_null_payload_offsets[i] += arena_offset;
+            }
+
+            descriptor_heap->descriptor_buffer.vk_buffer = block->vk_buffer;
+            descriptor_heap->descriptor_buffer.va = block->va;
+            descriptor_heap->descriptor_buffer.host_allocation = block->host_allocation;
+            goto clear_descriptors;
+        }
+
         if (FAILED(hr = vkd3d_create_buffer_explicit_usage(device, usage, total_alloc_size,
                 &descriptor_heap->descriptor_buffer.vk_buffer)))
             return hr;
@@ -6464,6 +8025,9 @@ static HRESULT d3d12_descriptor_heap_create_descriptor_buffer(struct d3d12_descr
         }
     }
 
+clear_descriptors:
+    d3d12_descriptor_heap_add_footprint(descriptor_heap, total_alloc_size);
+
     /* Clear all descriptors with NULL descriptors. Ideally we'd just use memset(),
      * but NULL descriptors might not be all zero in memory sadly. */
     for (i = 0; i < set_count; i++)
@@ -6479,13 +8043,12 @@ static HRESULT d3d12_descriptor_heap_create_descriptor_buffer(struct d3d12_descr
         dst = descriptor_heap->descriptor_buffer.host_allocation + src_null_payload_offsets[i];
         size = src_null_payload_sizes[i];
 
-        for (j = 0; j < descriptor_count; j++)
-        {
-            memcpy(dst, src, size);
-            dst += size;
-        }
+        /* Million descriptor heaps are common, so replicate the payload in bulk rather than
+         * copying one descriptor at a time into what is likely uncached memory. */
+        vkd3d_memcpy_replicate_non_temporal(dst, src, size, descriptor_count);
     }
 
+    vkd3d_memcpy_non_temporal_barrier();
     return S_OK;
 }
 
@@ -6797,6 +8360,7 @@ static HRESULT d3d12_descriptor_heap_init_data_buffer(struct d3d12_descriptor_he
         descriptor_heap->host_memory = vkd3d_calloc(1, buffer_size);
     }
 
+    d3d12_descriptor_heap_add_footprint(descriptor_heap, buffer_size);
     offset = 0;
 
     d3d12_descriptor_heap_get_buffer_range(descriptor_heap, &offset, raw_va_buffer_size, &descriptor_heap->raw_va_aux_buffer);
@@ -7084,6 +8648,19 @@ static HRESULT d3d12_descriptor_heap_init(struct d3d12_descriptor_heap *descript
     if (FAILED(hr = d3d12_descriptor_heap_init_data_buffer(descriptor_heap, device, desc)))
         goto fail;
 
+    if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_DESCRIPTOR_COPY_DEDUP) &&
+            (desc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ||
+            desc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER) &&
+            !d3d12_device_use_embedded_mutable_descriptors(device))
+    {
+        if (!(descriptor_heap->copy_fingerprints = vkd3d_calloc(desc->NumDescriptors,
+                sizeof(*descriptor_heap->copy_fingerprints))))
+        {
+            hr = E_OUTOFMEMORY;
+            goto fail;
+        }
+    }
+
     if (desc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
         descriptor_heap->fast_pointer_bank[fast_bank_pointer_index++] = descriptor_heap->raw_va_aux_buffer.host_ptr;
 
@@ -7103,8 +8680,7 @@ fail:
 
 static void d3d12_descriptor_heap_init_descriptors(struct d3d12_descriptor_heap *descriptor_heap)
 {
-    struct vkd3d_descriptor_metadata_types *meta;
-    unsigned int i;
+    struct vkd3d_descriptor_metadata_types meta_template;
 
     switch (descriptor_heap->desc.Type)
     {
@@ -7112,9 +8688,12 @@ static void d3d12_descriptor_heap_init_descriptors(struct d3d12_descriptor_heap
         case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER:
             if (!d3d12_device_use_embedded_mutable_descriptors(descriptor_heap->device))
             {
-                meta = (struct vkd3d_descriptor_metadata_types *) descriptor_heap->descriptors;
-                for (i = 0; i < descriptor_heap->desc.NumDescriptors; i++)
-                    meta[i].set_info_mask = descriptor_heap->null_descriptor_template.set_info_mask;
+                /* The heap is zero-initialized, so only set_info_mask differs from the template. */
+                memset(&meta_template, 0, sizeof(meta_template));
+                meta_template.set_info_mask = descriptor_heap->null_descriptor_template.set_info_mask;
+                vkd3d_memcpy_replicate_non_temporal(descriptor_heap->descriptors, &meta_template,
+                        sizeof(meta_template), descriptor_heap->desc.NumDescriptors);
+                vkd3d_memcpy_non_temporal_barrier();
             }
             break;
 
@@ -7243,6 +8822,8 @@ HRESULT d3d12_descriptor_heap_create(struct d3d12_device *device,
         return hr;
     }
 
+    d3d12_descriptor_heap_add_footprint(object, required_size);
+
     if (desc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || desc->Type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER)
     {
         if (d3d12_device_use_embedded_mutable_descriptors(device))
@@ -7328,11 +8909,25 @@ void d3d12_descriptor_heap_cleanup(struct d3d12_descriptor_heap *descriptor_heap
 
     VK_CALL(vkDestroyDescriptorPool(device->vk_device, descriptor_heap->vk_descriptor_pool, NULL));
 
-    if (!descriptor_heap->descriptor_buffer.device_allocation.vk_memory)
-        vkd3d_free_aligned(descriptor_heap->descriptor_buffer.host_allocation);
-    vkd3d_free_device_memory(device, &descriptor_heap->descriptor_buffer.device_allocation);
-    VK_CALL(vkDestroyBuffer(device->vk_device, descriptor_heap->descriptor_buffer.vk_buffer, NULL));
+    if (descriptor_heap->descriptor_buffer.arena_block)
+    {
+        vkd3d_descriptor_arena_free(d3d12_descriptor_heap_get_arena(descriptor_heap), device,
+                descriptor_heap->descriptor_buffer.arena_block,
+                descriptor_heap->descriptor_buffer.arena_first_slot,
+                descriptor_heap->descriptor_buffer.arena_slot_count);
+    }
+    else
+    {
+        if (!descriptor_heap->descriptor_buffer.device_allocation.vk_memory)
+            vkd3d_free_aligned(descriptor_heap->descriptor_buffer.host_allocation);
+        vkd3d_free_device_memory(device, &descriptor_heap->descriptor_buffer.device_allocation);
+        VK_CALL(vkDestroyBuffer(device->vk_device, descriptor_heap->descriptor_buffer.vk_buffer, NULL));
+    }
+
+    vkd3d_free(descriptor_heap->copy_fingerprints);
 
+    vkd3d_memory_footprint_add(&device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_DESCRIPTOR_HEAP,
+            -(int64_t)descriptor_heap->footprint_size);
     vkd3d_descriptor_debug_unregister_heap(descriptor_heap->cookie);
 }
 
@@ -7934,6 +9529,15 @@ HRESULT vkd3d_global_descriptor_buffer_init(struct vkd3d_global_descriptor_buffe
 
     bool requires_offset_buffer = device->device_info.properties2.properties.limits.minStorageBufferOffsetAlignment > 4;
     bool uses_ssbo = device->device_info.properties2.properties.limits.minStorageBufferOffsetAlignment <= 16;
+
+    if (FAILED(hr = vkd3d_descriptor_arena_init(&global_descriptor_buffer->resource_arena)))
+        return hr;
+    if (FAILED(hr = vkd3d_descriptor_arena_init(&global_descriptor_buffer->sampler_arena)))
+    {
+        vkd3d_descriptor_arena_cleanup(&global_descriptor_buffer->resource_arena, device);
+        return hr;
+    }
+
     if (!uses_ssbo)
         requires_offset_buffer = false;
 
@@ -8034,4 +9638,6 @@ void vkd3d_global_descriptor_buffer_cleanup(struct vkd3d_global_descriptor_buffe
     VK_CALL(vkDestroyBuffer(device->vk_device, global_descriptor_buffer->sampler.vk_buffer, NULL));
     vkd3d_free_device_memory(device, &global_descriptor_buffer->resource.device_allocation);
     vkd3d_free_device_memory(device, &global_descriptor_buffer->sampler.device_allocation);
+    vkd3d_descriptor_arena_cleanup(&global_descriptor_buffer->resource_arena, device);
+    vkd3d_descriptor_arena_cleanup(&global_descriptor_buffer->sampler_arena, device);
 }
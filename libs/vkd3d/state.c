@@ -67,14 +67,13 @@ static void d3d12_root_signature_cleanup(struct d3d12_root_signature *root_signa
 {
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
 
-    vkd3d_sampler_state_free_descriptor_set(&device->sampler_state, device,
-            root_signature->vk_sampler_set, root_signature->vk_sampler_pool);
+    vkd3d_sampler_state_release_static_sampler_set(&device->sampler_state, device,
+            root_signature->static_sampler_set);
 
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, root_signature->graphics.vk_pipeline_layout, NULL));
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, root_signature->mesh.vk_pipeline_layout, NULL));
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, root_signature->compute.vk_pipeline_layout, NULL));
     VK_CALL(vkDestroyPipelineLayout(device->vk_device, root_signature->raygen.vk_pipeline_layout, NULL));
-    VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, root_signature->vk_sampler_descriptor_layout, NULL));
     VK_CALL(vkDestroyDescriptorSetLayout(device->vk_device, root_signature->vk_root_descriptor_layout, NULL));
 
     vkd3d_free(root_signature->parameters);
@@ -82,6 +81,7 @@ static void d3d12_root_signature_cleanup(struct d3d12_root_signature *root_signa
     vkd3d_free(root_signature->root_constants);
     vkd3d_free(root_signature->static_samplers);
     vkd3d_free(root_signature->static_samplers_desc);
+    vkd3d_free(root_signature->hoist_info.feedback);
 }
 
 void d3d12_root_signature_inc_ref(struct d3d12_root_signature *root_signature)
@@ -89,6 +89,28 @@ void d3d12_root_signature_inc_ref(struct d3d12_root_signature *root_signature)
     InterlockedIncrement(&root_signature->internal_refcount);
 }
 
+bool d3d12_root_signature_try_inc_ref(struct d3d12_root_signature *root_signature)
+{
+    uint32_t *refcount = (uint32_t *)&root_signature->internal_refcount;
+    uint32_t count, old_count;
+
+    /* Cache lookups must not resurrect an object which is already being destroyed. */
+    count = vkd3d_atomic_uint32_load_explicit(refcount, vkd3d_memory_order_relaxed);
+    while (count)
+    {
+        old_count = vkd3d_atomic_uint32_compare_exchange(refcount, count, count + 1,
+                vkd3d_memory_order_acquire, vkd3d_memory_order_relaxed);
+        if (old_count == count)
+            return true;
+        count = old_count;
+    }
+
+    return false;
+}
+
+static void vkd3d_root_signature_cache_remove(struct vkd3d_root_signature_cache *cache,
+        struct d3d12_root_signature *root_signature);
+
 void d3d12_root_signature_dec_ref(struct d3d12_root_signature *root_signature)
 {
     struct d3d12_device *device = root_signature->device;
@@ -96,6 +118,9 @@ void d3d12_root_signature_dec_ref(struct d3d12_root_signature *root_signature)
 
     if (refcount == 0)
     {
+        if (root_signature->is_cached)
+            vkd3d_root_signature_cache_remove(&device->root_signature_cache, root_signature);
+
         vkd3d_private_store_destroy(&root_signature->private_store);
         d3d12_root_signature_cleanup(root_signature, device);
         vkd3d_free(root_signature);
@@ -1024,6 +1049,7 @@ static HRESULT d3d12_root_signature_init_root_descriptors(struct d3d12_root_sign
                     hoist_desc->parameter_index = hoisted_parameter_index;
                     hoist_desc->table_offset = range_descriptor_offset;
                     root_signature->hoist_info.num_desc++;
+                    root_signature->hoist_info.table_mask |= 1ull << i;
 
                     binding = &root_signature->bindings[context->binding_index];
                     binding->type = vkd3d_descriptor_type_from_d3d12_range_type(range->RangeType);
@@ -1209,22 +1235,15 @@ static HRESULT d3d12_root_signature_init_static_samplers(struct d3d12_root_signa
         context->vk_binding += 1;
     }
 
-    if (FAILED(hr = vkd3d_create_descriptor_set_layout(root_signature->device, 0,
-            desc->NumStaticSamplers, vk_binding_info,
-            VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT |
-                    VK_DESCRIPTOR_SET_LAYOUT_CREATE_EMBEDDED_IMMUTABLE_SAMPLERS_BIT_EXT,
-            &root_signature->vk_sampler_descriptor_layout)))
+    /* Unrelated root signatures commonly declare identical static samplers,
+     * so the set layout and descriptor set are shared between them. */
+    if (FAILED(hr = vkd3d_sampler_state_acquire_static_sampler_set(&root_signature->device->sampler_state,
+            root_signature->device, desc->NumStaticSamplers, vk_binding_info,
+            &root_signature->static_sampler_set)))
         goto cleanup;
 
-    /* With descriptor buffers we can implicitly bind immutable samplers, and no descriptors are necessary. */
-    if (!d3d12_device_uses_descriptor_buffers(root_signature->device))
-    {
-        hr = vkd3d_sampler_state_allocate_descriptor_set(&root_signature->device->sampler_state,
-                root_signature->device, root_signature->vk_sampler_descriptor_layout,
-                &root_signature->vk_sampler_set, &root_signature->vk_sampler_pool);
-    }
-    else
-        hr = S_OK;
+    *vk_set_layout = root_signature->static_sampler_set->vk_set_layout;
+    root_signature->vk_sampler_set = root_signature->static_sampler_set->vk_set;
 
 cleanup:
     vkd3d_free(vk_binding_info);
@@ -1307,6 +1326,59 @@ static void d3d12_root_signature_update_bind_point_layout(struct d3d12_bind_poin
         layout->push_constant_range = *push_range;
 }
 
+static void d3d12_root_signature_compile_binding_program(struct d3d12_root_signature *root_signature)
+{
+    struct vkd3d_root_binding_program *program = &root_signature->binding_program;
+    const struct vkd3d_shader_root_constant *root_constant;
+    const struct vkd3d_shader_descriptor_table *table;
+    struct vkd3d_root_binding_constant_op *op;
+    unsigned int i;
+
+    memset(program, 0, sizeof(*program));
+
+    for (i = 0; i < root_signature->parameter_count; i++)
+    {
+        if (root_signature->root_descriptor_raw_va_mask & (1ull << i))
+        {
+            program->root_descriptor_va_parameters[program->root_descriptor_va_count++] = i;
+        }
+        else if (root_signature->root_constant_mask & (1ull << i))
+        {
+            root_constant = &root_signature->parameters[i].constant;
+            if (!root_constant->constant_count)
+                continue;
+
+            program->root_constant_word_mask |= (~0ull >> (64 - root_constant->constant_count))
+                    << root_constant->constant_index;
+
+            /* Root constants are allocated back to back, so adjacent parameters
+             * can usually be merged into a single copy. */
+            op = program->constant_op_count ? &program->constant_ops[program->constant_op_count - 1] : NULL;
+            if (op && op->word_offset + op->word_count == root_constant->constant_index)
+            {
+                op->word_count += root_constant->constant_count;
+            }
+            else
+            {
+                op = &program->constant_ops[program->constant_op_count++];
+                op->word_offset = root_constant->constant_index;
+                op->word_count = root_constant->constant_count;
+            }
+        }
+        else if (root_signature->descriptor_table_mask & (1ull << i))
+        {
+            table = &root_signature->parameters[i].descriptor_table;
+            program->table_ops[program->table_op_count].parameter_index = i;
+            program->table_ops[program->table_op_count].table_index = table->table_index;
+            program->table_op_count++;
+        }
+    }
+
+    TRACE("Compiled binding program for root signature %p: %u constant ops, %u table ops, %u VAs.\n",
+            root_signature, program->constant_op_count, program->table_op_count,
+            program->root_descriptor_va_count);
+}
+
 static HRESULT d3d12_root_signature_init_global(struct d3d12_root_signature *root_signature,
         struct d3d12_device *device, const D3D12_ROOT_SIGNATURE_DESC1 *desc)
 {
@@ -1403,6 +1475,12 @@ static HRESULT d3d12_root_signature_init_global(struct d3d12_root_signature *roo
                 &root_signature->vk_root_descriptor_layout)))
         return hr;
 
+    if (root_signature->hoist_info.num_desc)
+    {
+        if (!(root_signature->hoist_info.feedback = vkd3d_calloc(1, sizeof(*root_signature->hoist_info.feedback))))
+            return E_OUTOFMEMORY;
+    }
+
     if (root_signature->vk_root_descriptor_layout)
     {
         assert(context.vk_set < VKD3D_MAX_DESCRIPTOR_SETS);
@@ -1416,6 +1494,8 @@ static HRESULT d3d12_root_signature_init_global(struct d3d12_root_signature *roo
     if (FAILED(hr = d3d12_root_signature_init_root_descriptor_tables(root_signature, desc, &info, &context)))
         return hr;
 
+    d3d12_root_signature_compile_binding_program(root_signature);
+
     /* Select push UBO style or push constants on a per-pipeline type basis. */
     d3d12_root_signature_update_bind_point_layout(&root_signature->graphics,
             &push_constant_range, &context, &info);
@@ -1630,11 +1710,149 @@ static HRESULT d3d12_root_signature_create_from_blob(struct d3d12_device *device
     return S_OK;
 }
 
+struct vkd3d_root_signature_cache_entry
+{
+    struct hash_map_entry entry;
+    struct vkd3d_root_signature_cache_key key;
+    struct d3d12_root_signature *root_signature;
+};
+
+static uint32_t vkd3d_root_signature_cache_hash_key(const void *key)
+{
+    const struct vkd3d_root_signature_cache_key *k = key;
+    return hash_combine(hash_data(k->checksum, sizeof(k->checksum)), hash_uint64(k->size));
+}
+
+static bool vkd3d_root_signature_cache_compare_key(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_root_signature_cache_entry *e = (const struct vkd3d_root_signature_cache_entry *)entry;
+    const struct vkd3d_root_signature_cache_key *k = key;
+
+    return e->key.size == k->size && !memcmp(e->key.checksum, k->checksum, sizeof(k->checksum));
+}
+
+HRESULT vkd3d_root_signature_cache_init(struct vkd3d_root_signature_cache *cache)
+{
+    int rc;
+
+    memset(cache, 0, sizeof(*cache));
+
+    if ((rc = pthread_mutex_init(&cache->mutex, NULL)))
+        return hresult_from_errno(rc);
+
+    hash_map_init(&cache->map, vkd3d_root_signature_cache_hash_key,
+            vkd3d_root_signature_cache_compare_key, sizeof(struct vkd3d_root_signature_cache_entry));
+    return S_OK;
+}
+
+void vkd3d_root_signature_cache_cleanup(struct vkd3d_root_signature_cache *cache)
+{
+    /* Every root signature removes itself on destruction, so anything left here has leaked. */
+    if (cache->map.used_count)
+        WARN("%u root signatures still alive at device destruction.\n", cache->map.used_count);
+
+    hash_map_free(&cache->map);
+    pthread_mutex_destroy(&cache->mutex);
+}
+
+static void vkd3d_root_signature_cache_remove(struct vkd3d_root_signature_cache *cache,
+        struct d3d12_root_signature *root_signature)
+{
+    struct vkd3d_root_signature_cache_entry *e;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    /* The entry may already have been taken over by a newer object with the same key. */
+    e = (struct vkd3d_root_signature_cache_entry *)hash_map_find(&cache->map, &root_signature->cache_key);
+    if (e && e->root_signature == root_signature)
+        hash_map_remove(&cache->map, &e->entry);
+
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+static struct d3d12_root_signature *vkd3d_root_signature_cache_lookup(struct vkd3d_root_signature_cache *cache,
+        const struct vkd3d_root_signature_cache_key *key)
+{
+    struct d3d12_root_signature *root_signature = NULL;
+    struct vkd3d_root_signature_cache_entry *e;
+
+    pthread_mutex_lock(&cache->mutex);
+    e = (struct vkd3d_root_signature_cache_entry *)hash_map_find(&cache->map, key);
+    if (e && d3d12_root_signature_try_inc_ref(e->root_signature))
+        root_signature = e->root_signature;
+    pthread_mutex_unlock(&cache->mutex);
+
+    if (root_signature)
+    {
+        /* Convert the temporary private reference into a public one. */
+        ID3D12RootSignature_AddRef(&root_signature->ID3D12RootSignature_iface);
+        d3d12_root_signature_dec_ref(root_signature);
+    }
+
+    return root_signature;
+}
+
+static void vkd3d_root_signature_cache_insert(struct vkd3d_root_signature_cache *cache,
+        struct d3d12_root_signature *root_signature)
+{
+    struct vkd3d_root_signature_cache_entry entry, *e;
+
+    entry.key = root_signature->cache_key;
+    entry.root_signature = root_signature;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    if ((e = (struct vkd3d_root_signature_cache_entry *)hash_map_insert(&cache->map, &entry.key, &entry.entry)))
+    {
+        if (e->root_signature == root_signature)
+        {
+            root_signature->is_cached = true;
+        }
+        else if (!vkd3d_atomic_uint32_load_explicit((uint32_t *)&e->root_signature->internal_refcount,
+                vkd3d_memory_order_acquire))
+        {
+            /* The previous object is being destroyed and will not remove our entry. */
+            e->root_signature = root_signature;
+            root_signature->is_cached = true;
+        }
+        /* Otherwise another thread won the race, and this object simply stays out of the cache. */
+    }
+
+    pthread_mutex_unlock(&cache->mutex);
+}
+
 HRESULT d3d12_root_signature_create(struct d3d12_device *device,
         const void *bytecode, size_t bytecode_length,
         struct d3d12_root_signature **root_signature)
 {
-    return d3d12_root_signature_create_from_blob(device, bytecode, bytecode_length, false, root_signature);
+    struct vkd3d_root_signature_cache_key key;
+    struct d3d12_root_signature *object;
+    HRESULT hr;
+
+    /* Engines tend to create the same root signature many times, both directly and embedded in PSOs.
+     * Native drivers return the same object for identical blobs, so skip parsing and layout creation. */
+    if (bytecode_length <= 5 * sizeof(uint32_t) || memcmp(bytecode, "DXBC", 4))
+        return d3d12_root_signature_create_from_blob(device, bytecode, bytecode_length, false, root_signature);
+
+    memset(&key, 0, sizeof(key));
+    vkd3d_compute_dxbc_checksum(bytecode, bytecode_length, key.checksum);
+    key.size = bytecode_length;
+
+    if ((object = vkd3d_root_signature_cache_lookup(&device->root_signature_cache, &key)))
+    {
+        TRACE("Reusing root signature %p.\n", object);
+        *root_signature = object;
+        return S_OK;
+    }
+
+    if (FAILED(hr = d3d12_root_signature_create_from_blob(device, bytecode, bytecode_length, false, &object)))
+        return hr;
+
+    object->cache_key = key;
+    vkd3d_root_signature_cache_insert(&device->root_signature_cache, object);
+
+    *root_signature = object;
+    return S_OK;
 }
 
 HRESULT d3d12_root_signature_create_raw(struct d3d12_device *device,
@@ -1921,12 +2139,26 @@ HRESULT vkd3d_pipeline_state_desc_from_d3d12_stream_desc(struct d3d12_pipeline_s
 
 struct vkd3d_compiled_pipeline
 {
-    struct list entry;
+    struct hash_map_entry entry;
     struct vkd3d_pipeline_key key;
     VkPipeline vk_pipeline;
+    /* Fast-linked pipeline which was replaced by an optimized link. Command lists
+     * may still reference it, so it lives as long as the PSO. */
+    VkPipeline vk_fast_link_pipeline;
     uint32_t dynamic_state_flags;
 };
 
+static uint32_t vkd3d_pipeline_key_hash(const void *key)
+{
+    return hash_data(key, sizeof(struct vkd3d_pipeline_key));
+}
+
+static bool vkd3d_pipeline_key_compare(const void *key, const struct hash_map_entry *entry)
+{
+    const struct vkd3d_compiled_pipeline *pipeline = (const struct vkd3d_compiled_pipeline *)entry;
+    return !memcmp(key, &pipeline->key, sizeof(pipeline->key));
+}
+
 /* ID3D12PipelineState */
 static HRESULT STDMETHODCALLTYPE d3d12_pipeline_state_QueryInterface(ID3D12PipelineState *iface,
         REFIID riid, void **object)
@@ -2017,6 +2249,27 @@ static void d3d12_pipeline_state_free_spirv_code_debug(struct d3d12_pipeline_sta
         vkd3d_shader_free_shader_code_debug(&state->compute.code_debug);
 }
 
+static void d3d12_pipeline_state_update_spirv_footprint(struct d3d12_pipeline_state *state)
+{
+    size_t spirv_size = 0;
+    unsigned int i;
+
+    if (d3d12_pipeline_state_is_graphics(state))
+    {
+        for (i = 0; i < state->graphics.stage_count; i++)
+            spirv_size += state->graphics.code[i].size;
+    }
+    else if (d3d12_pipeline_state_is_compute(state))
+        spirv_size = state->compute.code.size;
+
+    if (spirv_size != state->spirv_footprint_size)
+    {
+        vkd3d_memory_footprint_add(&state->device->memory_footprint, VKD3D_MEMORY_FOOTPRINT_PIPELINE_SPIRV,
+                (int64_t)spirv_size - (int64_t)state->spirv_footprint_size);
+        state->spirv_footprint_size = spirv_size;
+    }
+}
+
 static void d3d12_pipeline_state_free_spirv_code(struct d3d12_pipeline_state *state)
 {
     unsigned int i;
@@ -2037,6 +2290,8 @@ static void d3d12_pipeline_state_free_spirv_code(struct d3d12_pipeline_state *st
         state->compute.code.code = NULL;
         state->compute.code.size = 0;
     }
+
+    d3d12_pipeline_state_update_spirv_footprint(state);
 }
 
 static void d3d12_pipeline_state_destroy_shader_modules(struct d3d12_pipeline_state *state, struct d3d12_device *device)
@@ -2059,16 +2314,25 @@ static void d3d12_pipeline_state_destroy_graphics(struct d3d12_pipeline_state *s
 {
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
-    struct vkd3d_compiled_pipeline *current, *e;
+    struct vkd3d_compiled_pipeline *pipeline;
+    uint32_t i;
 
     d3d12_pipeline_state_destroy_shader_modules(state, device);
 
-    LIST_FOR_EACH_ENTRY_SAFE(current, e, &graphics->compiled_fallback_pipelines, struct vkd3d_compiled_pipeline, entry)
+    for (i = 0; i < graphics->compiled_fallback_pipelines.entry_count; i++)
     {
-        VK_CALL(vkDestroyPipeline(device->vk_device, current->vk_pipeline, NULL));
-        vkd3d_free(current);
+        pipeline = (struct vkd3d_compiled_pipeline *)hash_map_get_entry(&graphics->compiled_fallback_pipelines, i);
+
+        if (pipeline->entry.flags & HASH_MAP_ENTRY_OCCUPIED)
+        {
+            VK_CALL(vkDestroyPipeline(device->vk_device, pipeline->vk_pipeline, NULL));
+            VK_CALL(vkDestroyPipeline(device->vk_device, pipeline->vk_fast_link_pipeline, NULL));
+        }
     }
 
+    hash_map_free(&graphics->compiled_fallback_pipelines);
+
+    VK_CALL(vkDestroyPipeline(device->vk_device, graphics->async_link_pipeline, NULL));
     VK_CALL(vkDestroyPipeline(device->vk_device, graphics->pipeline, NULL));
     VK_CALL(vkDestroyPipeline(device->vk_device, graphics->library, NULL));
 }
@@ -2166,7 +2430,16 @@ void d3d12_pipeline_state_dec_ref(struct d3d12_pipeline_state *state)
         if (d3d12_pipeline_state_is_graphics(state))
             d3d12_pipeline_state_destroy_graphics(state, device);
         else if (d3d12_pipeline_state_is_compute(state))
+        {
             VK_CALL(vkDestroyPipeline(device->vk_device, state->compute.vk_pipeline, NULL));
+            if (state->compute.specialization)
+            {
+                /* The compile task holds a reference, so it cannot still be running. */
+                VK_CALL(vkDestroyPipeline(device->vk_device, state->compute.specialization->vk_pipeline, NULL));
+                vkd3d_free(state->compute.specialization->dxbc);
+                vkd3d_free(state->compute.specialization);
+            }
+        }
 
         VK_CALL(vkDestroyPipelineCache(device->vk_device, state->vk_pso_cache, NULL));
 
@@ -2295,6 +2568,229 @@ CONST_VTBL struct ID3D12PipelineStateVtbl d3d12_pipeline_state_vtbl =
     d3d12_pipeline_state_GetCachedBlob,
 };
 
+static const char * const vkd3d_pipeline_telemetry_phase_names[VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT] =
+{
+    "SPIR-V", "pipeline", "link",
+};
+
+static const char * const vkd3d_pipeline_telemetry_source_names[VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT] =
+{
+    "fresh", "memory", "application", "disk cache",
+};
+
+/* Region names are parsed by programs/vkd3d-profile.py, keep the pso_<phase>_<source> scheme. */
+static const char * const vkd3d_pipeline_telemetry_region_names
+        [VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT][VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT] =
+{
+    { "pso_spirv_fresh", "pso_spirv_memory", "pso_spirv_application", "pso_spirv_disk_cache" },
+    { "pso_pipeline_fresh", "pso_pipeline_memory", "pso_pipeline_application", "pso_pipeline_disk_cache" },
+    { "pso_link_fresh", "pso_link_memory", "pso_link_application", "pso_link_disk_cache" },
+};
+
+static uint32_t vkd3d_pipeline_telemetry_region_latches
+        [VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT][VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT];
+static spinlock_t vkd3d_pipeline_telemetry_region_locks
+        [VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT][VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT];
+
+static void vkd3d_pipeline_telemetry_notify_region(enum vkd3d_pipeline_telemetry_phase phase,
+        enum vkd3d_pipeline_telemetry_source source, uint64_t begin_ticks, uint64_t end_ticks)
+{
+    uint32_t *latch = &vkd3d_pipeline_telemetry_region_latches[phase][source];
+    unsigned int index;
+
+    if (!(index = vkd3d_atomic_uint32_load_explicit(latch, vkd3d_memory_order_acquire)))
+    {
+        index = vkd3d_profiling_register_region(vkd3d_pipeline_telemetry_region_names[phase][source],
+                &vkd3d_pipeline_telemetry_region_locks[phase][source], latch);
+    }
+
+    vkd3d_profiling_notify_work(index, begin_ticks, end_ticks, 1);
+}
+
+static bool vkd3d_pipeline_telemetry_enabled(void)
+{
+    if (vkd3d_uses_profiling())
+        return true;
+    return !!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_TELEMETRY);
+}
+
+HRESULT vkd3d_pipeline_telemetry_init(struct vkd3d_pipeline_telemetry *telemetry)
+{
+    int rc;
+
+    memset(telemetry, 0, sizeof(*telemetry));
+
+    if ((rc = pthread_mutex_init(&telemetry->lock, NULL)))
+        return hresult_from_errno(rc);
+
+    return S_OK;
+}
+
+static uint64_t vkd3d_pipeline_telemetry_record_total_ns(const struct vkd3d_pipeline_telemetry_record *record)
+{
+    uint64_t total = 0;
+    unsigned int i;
+
+    for (i = 0; i < VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT; i++)
+        total += record->phase_ns[i];
+    return total;
+}
+
+static void vkd3d_pipeline_telemetry_format_sources(uint32_t source_mask, char *buffer, size_t size)
+{
+    size_t offset = 0;
+    unsigned int i;
+
+    buffer[0] = '\0';
+
+    for (i = 0; i < VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT && offset < size; i++)
+    {
+        if (source_mask & (1u << i))
+        {
+            offset += snprintf(buffer + offset, size - offset, "%s%s",
+                    offset ? "|" : "", vkd3d_pipeline_telemetry_source_names[i]);
+        }
+    }
+}
+
+static void vkd3d_pipeline_telemetry_dump(const struct vkd3d_pipeline_telemetry *telemetry)
+{
+    const struct vkd3d_pipeline_telemetry_record *record;
+    char sources[VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT][64];
+    unsigned int i, j;
+
+    INFO("Pipeline creation telemetry (count, total ms):\n");
+    for (i = 0; i < VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT; i++)
+    {
+        INFO("  %-8s: fresh %u, %.3f / memory %u, %.3f / application %u, %.3f / disk cache %u, %.3f\n",
+                vkd3d_pipeline_telemetry_phase_names[i],
+                telemetry->total_count[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH],
+                1e-6 * telemetry->total_ns[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH],
+                telemetry->total_count[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_MEMORY],
+                1e-6 * telemetry->total_ns[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_MEMORY],
+                telemetry->total_count[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_APPLICATION],
+                1e-6 * telemetry->total_ns[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_APPLICATION],
+                telemetry->total_count[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_DISK_CACHE],
+                1e-6 * telemetry->total_ns[i][VKD3D_PIPELINE_TELEMETRY_SOURCE_DISK_CACHE]);
+    }
+
+    if (!telemetry->worst_count)
+        return;
+
+    INFO("Most expensive pipelines:\n");
+    for (i = 0; i < telemetry->worst_count; i++)
+    {
+        record = &telemetry->worst[i];
+
+        for (j = 0; j < VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT; j++)
+        {
+            vkd3d_pipeline_telemetry_format_sources(record->phase_source_mask[j],
+                    sources[j], sizeof(sources[j]));
+        }
+
+        INFO("  #%u: %s PSO #%"PRIu64" (shader %016"PRIx64"), %.3f ms: "
+                "SPIR-V %.3f ms [%s], pipeline %.3f ms [%s], link %.3f ms [%s].\n",
+                i + 1, record->pipeline_type == VKD3D_PIPELINE_TYPE_COMPUTE ? "compute" : "graphics",
+                record->id, record->dxbc_hash, 1e-6 * vkd3d_pipeline_telemetry_record_total_ns(record),
+                1e-6 * record->phase_ns[VKD3D_PIPELINE_TELEMETRY_PHASE_SPIRV],
+                sources[VKD3D_PIPELINE_TELEMETRY_PHASE_SPIRV],
+                1e-6 * record->phase_ns[VKD3D_PIPELINE_TELEMETRY_PHASE_PIPELINE],
+                sources[VKD3D_PIPELINE_TELEMETRY_PHASE_PIPELINE],
+                1e-6 * record->phase_ns[VKD3D_PIPELINE_TELEMETRY_PHASE_LINK],
+                sources[VKD3D_PIPELINE_TELEMETRY_PHASE_LINK]);
+    }
+}
+
+void vkd3d_pipeline_telemetry_cleanup(struct vkd3d_pipeline_telemetry *telemetry)
+{
+    if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_TELEMETRY)
+        vkd3d_pipeline_telemetry_dump(telemetry);
+    pthread_mutex_destroy(&telemetry->lock);
+}
+
+void vkd3d_pipeline_telemetry_begin(struct vkd3d_pipeline_telemetry_timer *timer)
+{
+    if (vkd3d_pipeline_telemetry_enabled())
+    {
+        timer->begin_ns = vkd3d_get_current_time_ns();
+        timer->begin_ticks = vkd3d_get_current_time_ticks();
+    }
+    else
+        timer->begin_ns = 0;
+}
+
+static void vkd3d_pipeline_telemetry_update_worst_locked(struct vkd3d_pipeline_telemetry *telemetry,
+        const struct vkd3d_pipeline_telemetry_record *record)
+{
+    uint64_t total_ns, min_ns, ns;
+    unsigned int i, min_index;
+
+    total_ns = vkd3d_pipeline_telemetry_record_total_ns(record);
+    min_ns = UINT64_MAX;
+    min_index = 0;
+
+    for (i = 0; i < telemetry->worst_count; i++)
+    {
+        if (telemetry->worst[i].id == record->id)
+        {
+            telemetry->worst[i] = *record;
+            goto sort;
+        }
+
+        if ((ns = vkd3d_pipeline_telemetry_record_total_ns(&telemetry->worst[i])) < min_ns)
+        {
+            min_ns = ns;
+            min_index = i;
+        }
+    }
+
+    if (telemetry->worst_count < ARRAY_SIZE(telemetry->worst))
+        i = telemetry->worst_count++;
+    else if (total_ns > min_ns)
+        i = min_index;
+    else
+        return;
+
+    telemetry->worst[i] = *record;
+
+sort:
+    /* Only the updated entry can be out of place, and its cost can only have grown. */
+    while (i && vkd3d_pipeline_telemetry_record_total_ns(&telemetry->worst[i - 1]) < total_ns)
+    {
+        telemetry->worst[i] = telemetry->worst[i - 1];
+        telemetry->worst[--i] = *record;
+    }
+}
+
+void vkd3d_pipeline_telemetry_end(struct d3d12_pipeline_state *state,
+        const struct vkd3d_pipeline_telemetry_timer *timer,
+        enum vkd3d_pipeline_telemetry_phase phase, enum vkd3d_pipeline_telemetry_source source)
+{
+    struct vkd3d_pipeline_telemetry *telemetry = &state->device->pipeline_telemetry;
+    uint64_t delta_ns;
+
+    if (!timer->begin_ns)
+        return;
+
+    delta_ns = vkd3d_get_current_time_ns() - timer->begin_ns;
+
+    if (vkd3d_uses_profiling())
+        vkd3d_pipeline_telemetry_notify_region(phase, source, timer->begin_ticks, vkd3d_get_current_time_ticks());
+
+    pthread_mutex_lock(&telemetry->lock);
+
+    if (!state->telemetry.id)
+        state->telemetry.id = ++telemetry->next_id;
+    state->telemetry.phase_ns[phase] += delta_ns;
+    state->telemetry.phase_source_mask[phase] |= 1u << source;
+
+    telemetry->total_ns[phase][source] += delta_ns;
+    telemetry->total_count[phase][source]++;
+    vkd3d_pipeline_telemetry_update_worst_locked(telemetry, &state->telemetry);
+
+    pthread_mutex_unlock(&telemetry->lock);
+}
+
 static HRESULT vkd3d_load_spirv_from_cached_state(struct d3d12_device *device,
         const struct d3d12_cached_pipeline_state *cached_state,
         VkShaderStageFlagBits stage, struct vkd3d_shader_code *spirv_code,
@@ -2379,6 +2875,16 @@ static void d3d12_pipeline_state_init_shader_interface(struct d3d12_pipeline_sta
 #endif
 }
 
+static void d3d12_pipeline_state_select_descriptor_qa(struct vkd3d_shader_interface_info *shader_interface,
+        const struct vkd3d_shader_code *dxbc)
+{
+    /* The root signature always reserves the QA bindings, so dropping instrumentation
+     * for a particular shader only affects the generated code. */
+    if ((shader_interface->flags & VKD3D_SHADER_INTERFACE_DESCRIPTOR_QA_BUFFER) &&
+            !vkd3d_descriptor_debug_qa_check_shader(vkd3d_shader_hash(dxbc)))
+        shader_interface->flags &= ~VKD3D_SHADER_INTERFACE_DESCRIPTOR_QA_BUFFER;
+}
+
 static void d3d12_pipeline_state_init_compile_arguments(struct d3d12_pipeline_state *state,
         struct d3d12_device *device, VkShaderStageFlagBits stage,
         struct vkd3d_shader_compile_arguments *compile_arguments)
@@ -2480,17 +2986,70 @@ static HRESULT vkd3d_setup_shader_stage(struct d3d12_pipeline_state *state, stru
         return S_OK;
 }
 
+static bool vkd3d_shader_spirv_cache_init_key(struct d3d12_pipeline_state *state,
+        const struct vkd3d_shader_code *dxbc, const struct vkd3d_shader_code_debug *spirv_code_debug,
+        const struct vkd3d_shader_interface_info *shader_interface,
+        const struct vkd3d_shader_compile_arguments *compile_args,
+        struct vkd3d_shader_spirv_cache_key *key)
+{
+    uint64_t h = hash_fnv1_init();
+    unsigned int i;
+
+    /* Debug output, stream output and MS -> PS linking are rare and hard to key reliably,
+     * always compile those. */
+    if (spirv_code_debug || shader_interface->xfb_info ||
+            shader_interface->stage_input_map || shader_interface->stage_output_map)
+        return false;
+
+    /* Bindings are fully derived from the root signature. */
+    h = hash_fnv1_iterate_u32(h, state->pipeline_type);
+    h = hash_fnv1_iterate_u32(h, shader_interface->stage);
+    h = hash_fnv1_iterate_u32(h, shader_interface->flags);
+    h = hash_fnv1_iterate_u32(h, compile_args->promote_wave_size_heuristics);
+    h = hash_fnv1_iterate_u32(h, compile_args->dual_source_blending);
+
+    for (i = 0; i < compile_args->parameter_count; i++)
+    {
+        h = hash_fnv1_iterate_u32(h, compile_args->parameters[i].name);
+        h = hash_fnv1_iterate_u32(h, compile_args->parameters[i].type);
+        h = hash_fnv1_iterate_u32(h, compile_args->parameters[i].data_type);
+        h = hash_fnv1_iterate_u32(h, compile_args->parameters[i].immediate_constant.u32);
+    }
+
+    h = hash_fnv1_iterate_u32(h, compile_args->output_swizzle_count);
+    for (i = 0; i < compile_args->output_swizzle_count; i++)
+        h = hash_fnv1_iterate_u32(h, compile_args->output_swizzles[i]);
+
+    h = hash_fnv1_iterate_u32(h, compile_args->root_constant_specialization_count);
+    for (i = 0; i < compile_args->root_constant_specialization_count; i++)
+    {
+        h = hash_fnv1_iterate_u32(h, compile_args->root_constant_specializations[i].offset);
+        h = hash_fnv1_iterate_u32(h, compile_args->root_constant_specializations[i].value);
+    }
+
+    key->dxbc_hash = vkd3d_shader_hash(dxbc);
+    key->root_signature_compat_hash = state->root_signature->compatibility_hash;
+    key->compile_args_hash = h;
+    return true;
+}
+
 static HRESULT vkd3d_compile_shader_stage(struct d3d12_pipeline_state *state, struct d3d12_device *device,
         VkShaderStageFlagBits stage, const D3D12_SHADER_BYTECODE *code,
         struct vkd3d_shader_code *spirv_code, struct vkd3d_shader_code_debug *spirv_code_debug)
 {
     struct vkd3d_shader_code dxbc = {code->pShaderBytecode, code->BytecodeLength};
+    enum vkd3d_pipeline_telemetry_source telemetry_source;
+    struct vkd3d_shader_spirv_cache_key spirv_cache_key;
     struct vkd3d_shader_interface_info shader_interface;
     struct vkd3d_shader_compile_arguments compile_args;
+    struct vkd3d_pipeline_telemetry_timer timer;
     vkd3d_shader_hash_t recovered_hash = 0;
     vkd3d_shader_hash_t compiled_hash = 0;
+    bool use_spirv_cache;
     int ret;
 
+    vkd3d_pipeline_telemetry_begin(&timer);
+
     if (spirv_code->code && (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_SANITIZE_SPIRV))
     {
         recovered_hash = vkd3d_shader_hash(spirv_code);
@@ -2498,20 +3057,39 @@ static HRESULT vkd3d_compile_shader_stage(struct d3d12_pipeline_state *state, st
         memset(spirv_code, 0, sizeof(*spirv_code));
     }
 
+    /* SPIR-V which is already present was loaded from the cached PSO blob. */
+    telemetry_source = state->telemetry.cached_source;
+
     if (!spirv_code->code)
     {
-        TRACE("Calling vkd3d_shader_compile_dxbc.\n");
-
         d3d12_pipeline_state_init_shader_interface(state, device, stage, &shader_interface);
+        d3d12_pipeline_state_select_descriptor_qa(&shader_interface, &dxbc);
         d3d12_pipeline_state_init_compile_arguments(state, device, stage, &compile_args);
 
-        if ((ret = vkd3d_shader_compile_dxbc(&dxbc, spirv_code, spirv_code_debug,
-                0, &shader_interface, &compile_args)) < 0)
+        use_spirv_cache = vkd3d_shader_spirv_cache_init_key(state, &dxbc, spirv_code_debug,
+                &shader_interface, &compile_args, &spirv_cache_key);
+
+        if (use_spirv_cache && vkd3d_shader_spirv_cache_lookup(&device->spirv_cache, &spirv_cache_key, spirv_code))
         {
-            WARN("Failed to compile shader, vkd3d result %d.\n", ret);
-            return hresult_from_vkd3d_result(ret);
+            TRACE("Reusing SPIR-V for shader %016"PRIx64".\n", spirv_code->meta.hash);
+            telemetry_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_MEMORY;
+        }
+        else
+        {
+            TRACE("Calling vkd3d_shader_compile_dxbc.\n");
+            telemetry_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH;
+
+            if ((ret = vkd3d_shader_compile_dxbc(&dxbc, spirv_code, spirv_code_debug,
+                    0, &shader_interface, &compile_args)) < 0)
+            {
+                WARN("Failed to compile shader, vkd3d result %d.\n", ret);
+                return hresult_from_vkd3d_result(ret);
+            }
+            TRACE("Called vkd3d_shader_compile_dxbc.\n");
+
+            if (use_spirv_cache)
+                vkd3d_shader_spirv_cache_insert(&device->spirv_cache, &spirv_cache_key, spirv_code);
         }
-        TRACE("Called vkd3d_shader_compile_dxbc.\n");
 
         if (stage == VK_SHADER_STAGE_FRAGMENT_BIT)
         {
@@ -2530,6 +3108,90 @@ static HRESULT vkd3d_compile_shader_stage(struct d3d12_pipeline_state *state, st
             INFO("SPIR-V mismatch for cache reference!\n");
     }
 
+    vkd3d_pipeline_telemetry_end(state, &timer, VKD3D_PIPELINE_TELEMETRY_PHASE_SPIRV, telemetry_source);
+    return S_OK;
+}
+
+struct vkd3d_shader_stage_compile_task
+{
+    struct vkd3d_job task;
+    struct d3d12_pipeline_state *state;
+    struct vkd3d_shader_code_debug *debug_output;
+    unsigned int stage_index;
+    HRESULT hr;
+};
+
+static void vkd3d_compile_shader_stage_task(void *userdata)
+{
+    struct vkd3d_shader_stage_compile_task *task = userdata;
+    struct d3d12_graphics_pipeline_state *graphics = &task->state->graphics;
+    unsigned int i = task->stage_index;
+
+    task->hr = vkd3d_compile_shader_stage(task->state, task->state->device,
+            graphics->cached_desc.bytecode_stages[i], &graphics->cached_desc.bytecode[i],
+            &graphics->code[i], task->debug_output);
+}
+
+/* Compiles the graphics stages in stage_mask to SPIR-V. Stages are translated concurrently
+ * if the device has a compile pool. All stages are joined before returning, and the result
+ * is that of the lowest failing stage index, so it does not depend on scheduling. */
+static HRESULT vkd3d_compile_shader_stages(struct d3d12_pipeline_state *state,
+        uint32_t stage_mask, struct vkd3d_shader_code_debug **debug_outputs)
+{
+    struct vkd3d_job_pool *pool = &state->device->job_pool;
+    struct vkd3d_shader_stage_compile_task tasks[VKD3D_MAX_SHADER_STAGES];
+    struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
+    uint32_t parallel_mask, serial_mask = 0, mask;
+    unsigned int i;
+
+    mask = stage_mask;
+    while (mask)
+    {
+        i = vkd3d_bitmask_iter32(&mask);
+        memset(&tasks[i], 0, sizeof(tasks[i]));
+        tasks[i].task.callback = vkd3d_compile_shader_stage_task;
+        tasks[i].task.userdata = &tasks[i];
+        tasks[i].state = state;
+        tasks[i].debug_output = debug_outputs ? debug_outputs[i] : NULL;
+        tasks[i].stage_index = i;
+
+        /* With mesh shaders, PS consumes the stage IO map written by MS, so it has to go last. */
+        if ((graphics->stage_flags & VK_SHADER_STAGE_MESH_BIT_EXT) &&
+                graphics->cached_desc.bytecode_stages[i] == VK_SHADER_STAGE_FRAGMENT_BIT)
+            serial_mask |= 1u << i;
+    }
+
+    parallel_mask = stage_mask & ~serial_mask;
+
+    if (pool->thread_count && (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_PARALLEL_COMPILE) &&
+            vkd3d_popcount(parallel_mask) > 1)
+    {
+        /* Hand off all but the first stage, which we compile on this thread. */
+        mask = parallel_mask & (parallel_mask - 1);
+        while (mask)
+            vkd3d_job_pool_enqueue(pool, &tasks[vkd3d_bitmask_iter32(&mask)].task);
+
+        vkd3d_compile_shader_stage_task(&tasks[vkd3d_bitmask_tzcnt32(parallel_mask)]);
+
+        mask = parallel_mask & (parallel_mask - 1);
+        while (mask)
+            vkd3d_job_pool_wait(pool, &tasks[vkd3d_bitmask_iter32(&mask)].task);
+    }
+    else
+        serial_mask = stage_mask;
+
+    mask = serial_mask;
+    while (mask)
+        vkd3d_compile_shader_stage_task(&tasks[vkd3d_bitmask_iter32(&mask)]);
+
+    mask = stage_mask;
+    while (mask)
+    {
+        i = vkd3d_bitmask_iter32(&mask);
+        if (FAILED(tasks[i].hr))
+            return tasks[i].hr;
+    }
+
     return S_OK;
 }
 
@@ -2555,6 +3217,7 @@ static HRESULT vkd3d_late_compile_shader_stages(struct d3d12_pipeline_state *sta
     /* We are at risk of having to compile pipelines late if we return from CreatePipelineState without
      * either code[i] or module being non-null. */
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
+    uint32_t compile_mask = 0;
     bool need_compile;
     unsigned int i;
     HRESULT hr;
@@ -2580,13 +3243,15 @@ static HRESULT vkd3d_late_compile_shader_stages(struct d3d12_pipeline_state *sta
     {
         if (graphics->stages[i].module == VK_NULL_HANDLE && !graphics->code[i].size &&
                 graphics->cached_desc.bytecode[i].BytecodeLength)
-        {
-            /* If we're compiling late, we don't care about debug. Debug capturing disables module identifiers. */
-            if (FAILED(hr = vkd3d_compile_shader_stage(state, state->device, graphics->cached_desc.bytecode_stages[i],
-                    &graphics->cached_desc.bytecode[i], &graphics->code[i], NULL)))
-                break;
-        }
+            compile_mask |= 1u << i;
+    }
 
+    /* If we're compiling late, we don't care about debug. Debug capturing disables module identifiers. */
+    if (FAILED(hr = vkd3d_compile_shader_stages(state, compile_mask, NULL)))
+        goto early_out;
+
+    for (i = 0; i < graphics->stage_count; i++)
+    {
         if (graphics->stages[i].module == VK_NULL_HANDLE)
         {
             if (FAILED(hr = d3d12_pipeline_state_create_shader_module(state->device,
@@ -2670,9 +3335,11 @@ static HRESULT vkd3d_create_compute_pipeline(struct d3d12_pipeline_state *state,
 {
     VkPipelineShaderStageRequiredSubgroupSizeCreateInfo required_subgroup_size_info;
     const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    enum vkd3d_pipeline_telemetry_source telemetry_source;
     VkPipelineCreationFeedbackCreateInfo feedback_info;
     struct vkd3d_shader_debug_ring_spec_info spec_info;
     struct vkd3d_shader_code_debug *spirv_code_debug;
+    struct vkd3d_pipeline_telemetry_timer timer;
     VkPipelineCreationFeedbackEXT feedbacks[1];
     VkComputePipelineCreateInfo pipeline_info;
     VkPipelineCreationFeedbackEXT feedback;
@@ -2746,8 +3413,10 @@ static HRESULT vkd3d_create_compute_pipeline(struct d3d12_pipeline_state *state,
     if (d3d12_device_uses_descriptor_buffers(device))
         pipeline_info.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
 
+    vkd3d_pipeline_telemetry_begin(&timer);
     vr = VK_CALL(vkCreateComputePipelines(device->vk_device,
             vk_cache, 1, &pipeline_info, NULL, &state->compute.vk_pipeline));
+    telemetry_source = state->telemetry.cached_source;
 
     if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
     {
@@ -2777,27 +3446,232 @@ static HRESULT vkd3d_create_compute_pipeline(struct d3d12_pipeline_state *state,
                 spirv_code)))
             return hr;
 
-        /* When a shader module is specified, VkPipelineShaderStageModuleIdentifierCreateInfoEXT must have an
-         * identifierSize of 0 or be absent. */
-        vk_remove_struct(&pipeline_info.stage,
-                VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_MODULE_IDENTIFIER_CREATE_INFO_EXT);
+        /* When a shader module is specified, VkPipelineShaderStageModuleIdentifierCreateInfoEXT must have an
+         * identifierSize of 0 or be absent. */
+        vk_remove_struct(&pipeline_info.stage,
+                VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_MODULE_IDENTIFIER_CREATE_INFO_EXT);
+
+        /* The identifier missed, so the driver has to compile from scratch. */
+        vkd3d_pipeline_telemetry_begin(&timer);
+        vr = VK_CALL(vkCreateComputePipelines(device->vk_device,
+                vk_cache, 1, &pipeline_info, NULL, &state->compute.vk_pipeline));
+        telemetry_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH;
+    }
+
+    TRACE("Called vkCreateComputePipelines.\n");
+    vkd3d_pipeline_telemetry_end(state, &timer, VKD3D_PIPELINE_TELEMETRY_PHASE_PIPELINE, telemetry_source);
+    VK_CALL(vkDestroyShaderModule(device->vk_device, pipeline_info.stage.module, NULL));
+    if (vr < 0)
+    {
+        WARN("Failed to create Vulkan compute pipeline, hr %#x.", hr);
+        return hresult_from_vk_result(vr);
+    }
+
+    if (feedback_info.pipelineStageCreationFeedbackCount)
+        vkd3d_report_pipeline_creation_feedback_results(&feedback_info);
+
+    return S_OK;
+}
+
+static void d3d12_pipeline_state_release_async(void *userdata)
+{
+    /* Drop the reference held by the task. */
+    d3d12_pipeline_state_dec_ref(userdata);
+}
+
+static void d3d12_pipeline_state_init_compute_specialization(struct d3d12_pipeline_state *state,
+        struct d3d12_device *device, const D3D12_SHADER_BYTECODE *code)
+{
+    const struct d3d12_root_signature *root_signature = state->root_signature;
+    struct d3d12_compute_pipeline_specialization *specialization;
+    unsigned int i, j, word_count;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_SPECIALIZE_ROOT_CONSTANTS))
+        return;
+
+    /* Variants are only ever compiled in the background. Replaced shaders and shaders
+     * which never load a root constant have nothing to gain. */
+    if (!device->job_pool.thread_count || !code->BytecodeLength ||
+            !(state->compute.code.meta.flags & VKD3D_SHADER_META_FLAG_USES_ROOT_CONSTANTS) ||
+            (state->compute.code.meta.flags & VKD3D_SHADER_META_FLAG_REPLACED))
+        return;
+
+    if (!(specialization = vkd3d_calloc(1, sizeof(*specialization))))
+        return;
+
+    word_count = 0;
+    for (i = 0; i < root_signature->root_constant_count; i++)
+    {
+        const struct vkd3d_shader_push_constant_buffer *root_constant = &root_signature->root_constants[i];
+
+        for (j = 0; j < root_constant->size / sizeof(uint32_t) &&
+                word_count < VKD3D_ROOT_CONSTANT_SPECIALIZATION_MAX_WORDS; j++)
+            specialization->word_offsets[word_count++] = root_constant->offset / sizeof(uint32_t) + j;
+    }
+
+    specialization->word_count = word_count;
+    specialization->dxbc_size = code->BytecodeLength;
+
+    if (!word_count || !(specialization->dxbc = vkd3d_malloc(code->BytecodeLength)))
+    {
+        vkd3d_free(specialization);
+        return;
+    }
+
+    memcpy(specialization->dxbc, code->pShaderBytecode, code->BytecodeLength);
+    state->compute.specialization = specialization;
+}
+
+static void d3d12_pipeline_state_compile_specialization_async(void *userdata)
+{
+    struct vkd3d_shader_root_constant_specialization values[VKD3D_ROOT_CONSTANT_SPECIALIZATION_MAX_WORDS];
+    struct d3d12_pipeline_state *state = userdata;
+    struct d3d12_compute_pipeline_specialization *specialization = state->compute.specialization;
+    VkPipelineShaderStageRequiredSubgroupSizeCreateInfo required_subgroup_size_info;
+    struct d3d12_device *device = state->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+    struct vkd3d_shader_code dxbc = {specialization->dxbc, specialization->dxbc_size};
+    struct vkd3d_shader_interface_info shader_interface;
+    struct vkd3d_shader_compile_arguments compile_args;
+    VkComputePipelineCreateInfo pipeline_info;
+    struct vkd3d_shader_code spirv_code;
+    VkPipeline vk_pipeline = VK_NULL_HANDLE;
+    unsigned int i;
+    VkResult vr;
+    int ret;
+
+    for (i = 0; i < specialization->word_count; i++)
+    {
+        values[i].offset = specialization->word_offsets[i] * sizeof(uint32_t);
+        values[i].value = specialization->values[i];
+    }
+
+    d3d12_pipeline_state_init_shader_interface(state, device, VK_SHADER_STAGE_COMPUTE_BIT, &shader_interface);
+    d3d12_pipeline_state_select_descriptor_qa(&shader_interface, &dxbc);
+    d3d12_pipeline_state_init_compile_arguments(state, device, VK_SHADER_STAGE_COMPUTE_BIT, &compile_args);
+    compile_args.root_constant_specialization_count = specialization->word_count;
+    compile_args.root_constant_specializations = values;
+
+    memset(&spirv_code, 0, sizeof(spirv_code));
+    memset(&pipeline_info, 0, sizeof(pipeline_info));
+
+    if ((ret = vkd3d_shader_compile_dxbc(&dxbc, &spirv_code, NULL, 0, &shader_interface, &compile_args)) < 0)
+    {
+        WARN("Failed to compile specialized shader, vkd3d result %d.\n", ret);
+        goto out;
+    }
+
+    if (FAILED(vkd3d_setup_shader_stage(state, device, &pipeline_info.stage, VK_SHADER_STAGE_COMPUTE_BIT,
+            &required_subgroup_size_info, NULL, &spirv_code)))
+        goto out;
+
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.layout = state->root_signature->compute.vk_pipeline_layout;
+    pipeline_info.basePipelineIndex = -1;
+
+    if (d3d12_device_uses_descriptor_buffers(device))
+        pipeline_info.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+
+    /* The PSO cache may be in use by other threads, and variants are not worth serializing. */
+    if ((vr = VK_CALL(vkCreateComputePipelines(device->vk_device, VK_NULL_HANDLE,
+            1, &pipeline_info, NULL, &vk_pipeline))) < 0)
+    {
+        WARN("Failed to create specialized compute pipeline, vr %d.\n", vr);
+        vk_pipeline = VK_NULL_HANDLE;
+    }
+
+    VK_CALL(vkDestroyShaderModule(device->vk_device, pipeline_info.stage.module, NULL));
+
+out:
+    vkd3d_shader_free_shader_code(&spirv_code);
+
+    if (vk_pipeline)
+        TRACE("Compiled root constant specialization for pipeline %p.\n", state);
+
+    specialization->vk_pipeline = vk_pipeline;
+    vkd3d_atomic_uint32_store_explicit(&specialization->status,
+            VKD3D_ROOT_CONSTANT_SPECIALIZATION_DONE, vkd3d_memory_order_release);
+}
+
+static uint32_t d3d12_compute_pipeline_specialization_hash_values(
+        const struct d3d12_compute_pipeline_specialization *specialization, const uint32_t *root_constants)
+{
+    uint32_t hash = 0;
+    unsigned int i;
+
+    for (i = 0; i < specialization->word_count; i++)
+        hash = hash_combine(hash, root_constants[specialization->word_offsets[i]]);
+
+    return hash;
+}
+
+static void d3d12_compute_pipeline_specialization_profile(struct d3d12_pipeline_state *state,
+        const uint32_t *root_constants)
+{
+    struct d3d12_compute_pipeline_specialization *specialization = state->compute.specialization;
+    struct vkd3d_job *task = &specialization->task;
+    uint32_t hash;
+    unsigned int i;
+
+    /* The counters are shared by all command lists recording with this PSO. Races only
+     * delay or advance the trigger, the values we compile for are taken from one list. */
+    hash = d3d12_compute_pipeline_specialization_hash_values(specialization, root_constants);
+
+    if (vkd3d_atomic_uint32_load_explicit(&specialization->observed_hash, vkd3d_memory_order_relaxed) != hash)
+    {
+        vkd3d_atomic_uint32_store_explicit(&specialization->observed_hash, hash, vkd3d_memory_order_relaxed);
+        vkd3d_atomic_uint32_store_explicit(&specialization->stable_count, 0, vkd3d_memory_order_relaxed);
+        return;
+    }
+
+    if (vkd3d_atomic_uint32_increment(&specialization->stable_count, vkd3d_memory_order_relaxed) !=
+            VKD3D_ROOT_CONSTANT_SPECIALIZATION_THRESHOLD)
+        return;
+
+    if (vkd3d_atomic_uint32_compare_exchange(&specialization->status, VKD3D_ROOT_CONSTANT_SPECIALIZATION_PROFILING,
+            VKD3D_ROOT_CONSTANT_SPECIALIZATION_QUEUED, vkd3d_memory_order_relaxed, vkd3d_memory_order_relaxed) !=
+            VKD3D_ROOT_CONSTANT_SPECIALIZATION_PROFILING)
+        return;
+
+    for (i = 0; i < specialization->word_count; i++)
+        specialization->values[i] = root_constants[specialization->word_offsets[i]];
+
+    /* Keep the PSO alive until the task completes. */
+    d3d12_pipeline_state_inc_ref(state);
+
+    task->callback = d3d12_pipeline_state_compile_specialization_async;
+    task->release = d3d12_pipeline_state_release_async;
+    task->userdata = state;
+    vkd3d_job_pool_enqueue(&state->device->job_pool, task);
+}
 
-        vr = VK_CALL(vkCreateComputePipelines(device->vk_device,
-                vk_cache, 1, &pipeline_info, NULL, &state->compute.vk_pipeline));
-    }
+VkPipeline d3d12_pipeline_state_select_compute_pipeline(struct d3d12_pipeline_state *state,
+        const uint32_t *root_constants)
+{
+    struct d3d12_compute_pipeline_specialization *specialization = state->compute.specialization;
+    unsigned int i;
 
-    TRACE("Called vkCreateComputePipelines.\n");
-    VK_CALL(vkDestroyShaderModule(device->vk_device, pipeline_info.stage.module, NULL));
-    if (vr < 0)
+    switch (vkd3d_atomic_uint32_load_explicit(&specialization->status, vkd3d_memory_order_acquire))
     {
-        WARN("Failed to create Vulkan compute pipeline, hr %#x.", hr);
-        return hresult_from_vk_result(vr);
-    }
+        case VKD3D_ROOT_CONSTANT_SPECIALIZATION_PROFILING:
+            d3d12_compute_pipeline_specialization_profile(state, root_constants);
+            return state->compute.vk_pipeline;
 
-    if (feedback_info.pipelineStageCreationFeedbackCount)
-        vkd3d_report_pipeline_creation_feedback_results(&feedback_info);
+        case VKD3D_ROOT_CONSTANT_SPECIALIZATION_DONE:
+            if (!specialization->vk_pipeline)
+                return state->compute.vk_pipeline;
 
-    return S_OK;
+            for (i = 0; i < specialization->word_count; i++)
+            {
+                if (root_constants[specialization->word_offsets[i]] != specialization->values[i])
+                    return state->compute.vk_pipeline;
+            }
+
+            return specialization->vk_pipeline;
+
+        default:
+            return state->compute.vk_pipeline;
+    }
 }
 
 static HRESULT d3d12_pipeline_state_init_compute(struct d3d12_pipeline_state *state,
@@ -2830,6 +3704,8 @@ static HRESULT d3d12_pipeline_state_init_compute(struct d3d12_pipeline_state *st
         return hr;
     }
 
+    d3d12_pipeline_state_init_compute_specialization(state, device, &desc->cs);
+
     d3d12_device_add_ref(state->device = device);
 
     return S_OK;
@@ -3628,6 +4504,7 @@ void vkd3d_vertex_input_pipeline_free(struct hash_map_entry *entry, void *userda
     vk_procs = &device->vk_procs;
 
     VK_CALL(vkDestroyPipeline(device->vk_device, pipeline->vk_pipeline, NULL));
+    vkd3d_free(pipeline->lookup_record);
 }
 
 void vkd3d_fragment_output_pipeline_desc_init(struct vkd3d_fragment_output_pipeline_desc *desc,
@@ -3748,6 +4625,7 @@ void vkd3d_fragment_output_pipeline_free(struct hash_map_entry *entry, void *use
     vk_procs = &device->vk_procs;
 
     VK_CALL(vkDestroyPipeline(device->vk_device, pipeline->vk_pipeline, NULL));
+    vkd3d_free(pipeline->lookup_record);
 }
 
 uint32_t d3d12_graphics_pipeline_state_get_dynamic_state_flags(struct d3d12_pipeline_state *state,
@@ -3943,8 +4821,9 @@ static HRESULT d3d12_pipeline_state_graphics_create_shader_stages(
         struct d3d12_pipeline_state *state, struct d3d12_device *device,
         const struct d3d12_pipeline_state_desc *desc)
 {
+    struct vkd3d_shader_code_debug *debug_outputs[VKD3D_MAX_SHADER_STAGES];
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
-    struct vkd3d_shader_code_debug *debug_output;
+    uint32_t compile_mask = 0;
     unsigned int i;
     HRESULT hr;
 
@@ -3953,21 +4832,24 @@ static HRESULT d3d12_pipeline_state_graphics_create_shader_stages(
     {
         if (graphics->identifier_create_infos[i].identifierSize == 0)
         {
+            compile_mask |= 1u << i;
+
             if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEBUG_UTILS)
             {
-                debug_output = &graphics->code_debug[i];
-                if (debug_output->debug_entry_point_name)
-                    debug_output = NULL;
+                debug_outputs[i] = &graphics->code_debug[i];
+                if (debug_outputs[i]->debug_entry_point_name)
+                    debug_outputs[i] = NULL;
             }
             else
-                debug_output = NULL;
-
-            if (FAILED(hr = vkd3d_compile_shader_stage(state, device,
-                    graphics->cached_desc.bytecode_stages[i],
-                    &graphics->cached_desc.bytecode[i], &graphics->code[i], debug_output)))
-                return hr;
+                debug_outputs[i] = NULL;
         }
+    }
+
+    if (FAILED(hr = vkd3d_compile_shader_stages(state, compile_mask, debug_outputs)))
+        return hr;
 
+    for (i = 0; i < graphics->stage_count; i++)
+    {
         if (FAILED(hr = vkd3d_setup_shader_stage(state, device,
                 &graphics->stages[i],
                 graphics->cached_desc.bytecode_stages[i],
@@ -4551,6 +5433,8 @@ static HRESULT d3d12_pipeline_state_init_static_pipeline(struct d3d12_pipeline_s
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
     bool can_compile_pipeline_early, has_gpl, create_library = false;
     VkGraphicsPipelineLibraryFlagsEXT library_flags = 0;
+    bool can_create_library = true;
+    bool async_compile;
 
     has_gpl = state->device->device_info.graphics_pipeline_library_features.graphicsPipelineLibrary;
 
@@ -4592,7 +5476,10 @@ static HRESULT d3d12_pipeline_state_init_static_pipeline(struct d3d12_pipeline_s
          * different patch vertex count, which is part of pre-rasterization state. Do not
          * create a pipeline library if dynamic patch control points are unsupported. */
         if (has_tess && !state->device->device_info.extended_dynamic_state2_features.extendedDynamicState2PatchControlPoints)
+        {
             create_library = false;
+            can_create_library = false;
+        }
 
         graphics->pipeline_layout = state->root_signature->graphics.vk_pipeline_layout;
     }
@@ -4602,6 +5489,18 @@ static HRESULT d3d12_pipeline_state_init_static_pipeline(struct d3d12_pipeline_s
     graphics->library_flags = 0;
     graphics->library_create_flags = 0;
 
+    async_compile = can_compile_pipeline_early && state->device->job_pool.thread_count &&
+            (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_ASYNC_COMPILE);
+
+    /* The primary pipeline will be compiled in the background. Make sure there is a library
+     * we can fast-link in case the pipeline is needed before the compile completes. */
+    if (async_compile && has_gpl && can_create_library && !create_library)
+    {
+        library_flags &= ~(VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT |
+                VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT);
+        create_library = true;
+    }
+
     if (create_library && has_gpl)
     {
         if (!(graphics->library = d3d12_pipeline_state_create_pipeline_variant(state, NULL, graphics->dsv_format,
@@ -4609,7 +5508,12 @@ static HRESULT d3d12_pipeline_state_init_static_pipeline(struct d3d12_pipeline_s
             return E_OUTOFMEMORY;
     }
 
-    if (can_compile_pipeline_early)
+    if (async_compile)
+    {
+        /* Queued once the PSO is fully created. */
+        graphics->async_compile_task.status = VKD3D_JOB_STATUS_QUEUED;
+    }
+    else if (can_compile_pipeline_early)
     {
         if (!(graphics->pipeline = d3d12_pipeline_state_create_pipeline_variant(state, NULL, graphics->dsv_format,
                 state->vk_pso_cache, 0, &graphics->dynamic_state_flags)))
@@ -4635,7 +5539,7 @@ static HRESULT d3d12_pipeline_state_finish_graphics(struct d3d12_pipeline_state
      * If we couldn't compile pipeline early due to e.g. UNKNOWN topology or unknown number of patch control points,
      * we have to defer the compile, but this is esoteric behavior and should never happen in practice. */
     state->pso_is_fully_dynamic =
-            graphics->pipeline &&
+            (graphics->pipeline || graphics->async_compile_task.status) &&
             !d3d12_graphics_pipeline_state_has_unknown_dsv_format_with_test(graphics);
 
     /* If we cannot adjust control points dynamically,
@@ -4665,7 +5569,9 @@ static HRESULT d3d12_pipeline_state_finish_graphics(struct d3d12_pipeline_state
         }
     }
 
-    list_init(&graphics->compiled_fallback_pipelines);
+    hash_map_init(&graphics->compiled_fallback_pipelines,
+            vkd3d_pipeline_key_hash, vkd3d_pipeline_key_compare,
+            sizeof(struct vkd3d_compiled_pipeline));
     if (FAILED(hr = vkd3d_private_store_init(&state->private_store)))
         return hr;
     d3d12_device_add_ref(state->device);
@@ -4718,6 +5624,129 @@ static HRESULT d3d12_pipeline_create_private_root_signature(struct d3d12_device
     return hr;
 }
 
+static void d3d12_pipeline_state_finish_create(struct d3d12_pipeline_state *state, bool from_cached_blob)
+{
+    struct d3d12_device *device = state->device;
+    const struct vkd3d_vk_device_procs *vk_procs = &device->vk_procs;
+
+    /* The strategy here is that we need to keep the SPIR-V alive somehow.
+     * If we don't need to serialize SPIR-V from the PSO, then we don't need to keep the code alive as pointer/size pairs.
+     * The scenarios for this case is:
+     * - When we choose to not serialize SPIR-V at all with VKD3D_CONFIG
+     * - PSO was loaded from a cached blob. It's extremely unlikely that anyone is going to try
+     *   serializing that PSO again, so there should be no need to keep it alive.
+     * - We are using a disk cache or application pipeline libraries with SHADER_IDENTIFIER support.
+     *   In this case, we'll never store the SPIR-V itself, but the identifier, so we don't need to keep the code around.
+     *
+     * The worst that would happen is a performance loss should that entry be reloaded later.
+     * For graphics pipelines, we have to keep VkShaderModules around in case we need fallback pipelines.
+     * If we keep the SPIR-V around in memory, we can always create shader modules on-demand in case we
+     * need to actually create fallback pipelines. This avoids unnecessary memory bloat. */
+    if (from_cached_blob ||
+            (device->disk_cache.library && (device->disk_cache.library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_SHADER_IDENTIFIER)) ||
+            (vkd3d_pipeline_library_get_application_flags(device) & VKD3D_PIPELINE_LIBRARY_FLAG_SHADER_IDENTIFIER) ||
+            (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_NO_SERIALIZE_SPIRV))
+        d3d12_pipeline_state_free_spirv_code(state);
+    else
+        d3d12_pipeline_state_destroy_shader_modules(state, device);
+
+    /* If it is impossible for us to recompile this shader, we can free VkShaderModules. Saves a lot of memory.
+     * If we are required to be able to serialize the SPIR-V, it will live as host pointers, not VkShaderModule. */
+    if (state->pso_is_fully_dynamic)
+        d3d12_pipeline_state_destroy_shader_modules(state, device);
+
+    /* We don't expect to serialize the PSO blob if we loaded it from cache.
+     * Free the cache now to save on memory. */
+    if (from_cached_blob)
+    {
+        VK_CALL(vkDestroyPipelineCache(device->vk_device, state->vk_pso_cache, NULL));
+        state->vk_pso_cache = VK_NULL_HANDLE;
+
+        /* Set this explicitly so we avoid attempting to touch code[i] when serializing the PSO blob.
+         * We are at risk of compiling code on the fly in some upcoming situations. */
+        state->pso_is_loaded_from_cached_blob = true;
+    }
+    else if (device->disk_cache.library)
+    {
+        /* We compiled this PSO without any cache (internal or app-provided),
+         * so we should serialize this to internal disk cache.
+         * Pushes work to disk$ thread. */
+        vkd3d_pipeline_library_store_pipeline_to_disk_cache(&device->disk_cache, state);
+    }
+
+    if (device->device_info.workarounds.force_dummy_pipeline_cache)
+    {
+        /* Throw the pipeline cache away immediately. Tricks drivers into not retaining the PSO in memory cache. */
+        VK_CALL(vkDestroyPipelineCache(device->vk_device, state->vk_pso_cache, NULL));
+        state->vk_pso_cache = VK_NULL_HANDLE;
+    }
+
+    /* Whatever SPIR-V survived the above is kept for the lifetime of the PSO. */
+    d3d12_pipeline_state_update_spirv_footprint(state);
+}
+
+static void d3d12_pipeline_state_compile_async(void *userdata)
+{
+    struct d3d12_pipeline_state *state = userdata;
+    struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
+    uint32_t dynamic_state_flags;
+    VkPipeline vk_pipeline;
+
+    if (!(vk_pipeline = d3d12_pipeline_state_create_pipeline_variant(state, NULL, graphics->dsv_format,
+            state->vk_pso_cache, 0, &dynamic_state_flags)))
+        ERR("Failed to compile pipeline %p asynchronously.\n", state);
+
+    /* Fallback pipelines may be compiled concurrently and read shader modules and code under the lock. */
+    rwlock_lock_write(&state->lock);
+    graphics->pipeline = vk_pipeline;
+    /* If we have a library, the dynamic state flags already match and may be read concurrently. */
+    if (vk_pipeline && !graphics->library)
+        graphics->dynamic_state_flags = dynamic_state_flags;
+    d3d12_pipeline_state_finish_create(state, graphics->async_compile_from_cached_blob);
+    rwlock_unlock_write(&state->lock);
+}
+
+static void d3d12_pipeline_state_enqueue_async_compile(struct vkd3d_job_pool *pool,
+        struct d3d12_pipeline_state *state)
+{
+    struct vkd3d_job *task = &state->graphics.async_compile_task;
+
+    /* Keep the PSO alive until the task completes. */
+    d3d12_pipeline_state_inc_ref(state);
+
+    task->callback = d3d12_pipeline_state_compile_async;
+    task->release = d3d12_pipeline_state_release_async;
+    task->userdata = state;
+    vkd3d_job_pool_enqueue(pool, task);
+}
+
+void d3d12_pipeline_state_wait_async_compile(struct d3d12_pipeline_state *state)
+{
+    if (d3d12_pipeline_state_is_graphics(state))
+        vkd3d_job_pool_wait(&state->device->job_pool, &state->graphics.async_compile_task);
+}
+
+static void d3d12_pipeline_state_init_telemetry(struct d3d12_pipeline_state *state, struct d3d12_device *device,
+        VkPipelineBindPoint bind_point, const struct d3d12_cached_pipeline_state *cached_pso)
+{
+    struct vkd3d_pipeline_telemetry_record *record = &state->telemetry;
+    unsigned int i;
+
+    record->pipeline_type = bind_point == VK_PIPELINE_BIND_POINT_COMPUTE ?
+            VKD3D_PIPELINE_TYPE_COMPUTE : VKD3D_PIPELINE_TYPE_GRAPHICS;
+
+    /* Identify the PSO by its first shader in the report. */
+    for (i = 0; i < ARRAY_SIZE(state->pipeline_cache_compat.dxbc_blob_hashes) && !record->dxbc_hash; i++)
+        record->dxbc_hash = state->pipeline_cache_compat.dxbc_blob_hashes[i];
+
+    if (!cached_pso->blob.CachedBlobSizeInBytes)
+        record->cached_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH;
+    else if (device->disk_cache.library && cached_pso->library == device->disk_cache.library)
+        record->cached_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_DISK_CACHE;
+    else
+        record->cached_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_APPLICATION;
+}
+
 HRESULT d3d12_pipeline_state_create(struct d3d12_device *device, VkPipelineBindPoint bind_point,
         const struct d3d12_pipeline_state_desc *desc, struct d3d12_pipeline_state **state)
 {
@@ -4756,7 +5785,7 @@ HRESULT d3d12_pipeline_state_create(struct d3d12_device *device, VkPipelineBindP
         d3d12_root_signature_inc_ref(object->root_signature);
     }
 
-    vkd3d_pipeline_cache_compat_from_state_desc(&object->pipeline_cache_compat, desc);
+    vkd3d_pipeline_cache_compat_from_state_desc(&object->pipeline_cache_compat, device, desc);
     if (object->root_signature)
         object->pipeline_cache_compat.root_signature_compat_hash = object->root_signature->compatibility_hash;
 
@@ -4811,6 +5840,8 @@ HRESULT d3d12_pipeline_state_create(struct d3d12_device *device, VkPipelineBindP
         }
     }
 
+    d3d12_pipeline_state_init_telemetry(object, device, bind_point, desc_cached_pso);
+
     object->ID3D12PipelineState_iface.lpVtbl = &d3d12_pipeline_state_vtbl;
     object->refcount = 1;
     object->internal_refcount = 1;
@@ -4878,56 +5909,13 @@ HRESULT d3d12_pipeline_state_create(struct d3d12_device *device, VkPipelineBindP
         return hr;
     }
 
-    /* The strategy here is that we need to keep the SPIR-V alive somehow.
-     * If we don't need to serialize SPIR-V from the PSO, then we don't need to keep the code alive as pointer/size pairs.
-     * The scenarios for this case is:
-     * - When we choose to not serialize SPIR-V at all with VKD3D_CONFIG
-     * - PSO was loaded from a cached blob. It's extremely unlikely that anyone is going to try
-     *   serializing that PSO again, so there should be no need to keep it alive.
-     * - We are using a disk cache with SHADER_IDENTIFIER support.
-     *   In this case, we'll never store the SPIR-V itself, but the identifier, so we don't need to keep the code around.
-     *
-     * The worst that would happen is a performance loss should that entry be reloaded later.
-     * For graphics pipelines, we have to keep VkShaderModules around in case we need fallback pipelines.
-     * If we keep the SPIR-V around in memory, we can always create shader modules on-demand in case we
-     * need to actually create fallback pipelines. This avoids unnecessary memory bloat. */
-    if (desc_cached_pso->blob.CachedBlobSizeInBytes ||
-            (device->disk_cache.library && (device->disk_cache.library->flags & VKD3D_PIPELINE_LIBRARY_FLAG_SHADER_IDENTIFIER)) ||
-            (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_NO_SERIALIZE_SPIRV))
-        d3d12_pipeline_state_free_spirv_code(object);
-    else
-        d3d12_pipeline_state_destroy_shader_modules(object, device);
-
-    /* If it is impossible for us to recompile this shader, we can free VkShaderModules. Saves a lot of memory.
-     * If we are required to be able to serialize the SPIR-V, it will live as host pointers, not VkShaderModule. */
-    if (object->pso_is_fully_dynamic)
-        d3d12_pipeline_state_destroy_shader_modules(object, device);
-
-    /* We don't expect to serialize the PSO blob if we loaded it from cache.
-     * Free the cache now to save on memory. */
-    if (desc_cached_pso->blob.CachedBlobSizeInBytes)
-    {
-        VK_CALL(vkDestroyPipelineCache(device->vk_device, object->vk_pso_cache, NULL));
-        object->vk_pso_cache = VK_NULL_HANDLE;
-
-        /* Set this explicitly so we avoid attempting to touch code[i] when serializing the PSO blob.
-         * We are at risk of compiling code on the fly in some upcoming situations. */
-        object->pso_is_loaded_from_cached_blob = true;
-    }
-    else if (device->disk_cache.library)
-    {
-        /* We compiled this PSO without any cache (internal or app-provided),
-         * so we should serialize this to internal disk cache.
-         * Pushes work to disk$ thread. */
-        vkd3d_pipeline_library_store_pipeline_to_disk_cache(&device->disk_cache, object);
-    }
-
-    if (device->device_info.workarounds.force_dummy_pipeline_cache)
+    if (d3d12_pipeline_state_is_graphics(object) && object->graphics.async_compile_task.status)
     {
-        /* Throw the pipeline cache away immediately. Tricks drivers into not retaining the PSO in memory cache. */
-        VK_CALL(vkDestroyPipelineCache(device->vk_device, object->vk_pso_cache, NULL));
-        object->vk_pso_cache = VK_NULL_HANDLE;
+        object->graphics.async_compile_from_cached_blob = !!desc_cached_pso->blob.CachedBlobSizeInBytes;
+        d3d12_pipeline_state_enqueue_async_compile(&device->job_pool, object);
     }
+    else
+        d3d12_pipeline_state_finish_create(object, !!desc_cached_pso->blob.CachedBlobSizeInBytes);
 
     TRACE("Created pipeline state %p.\n", object);
 
@@ -4939,18 +5927,14 @@ static VkPipeline d3d12_pipeline_state_find_compiled_pipeline(struct d3d12_pipel
         const struct vkd3d_pipeline_key *key, uint32_t *dynamic_state_flags)
 {
     const struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
-    struct vkd3d_compiled_pipeline *current;
+    const struct vkd3d_compiled_pipeline *pipeline;
     VkPipeline vk_pipeline = VK_NULL_HANDLE;
 
     rwlock_lock_read(&state->lock);
-    LIST_FOR_EACH_ENTRY(current, &graphics->compiled_fallback_pipelines, struct vkd3d_compiled_pipeline, entry)
+    if ((pipeline = (const struct vkd3d_compiled_pipeline *)hash_map_find(&graphics->compiled_fallback_pipelines, key)))
     {
-        if (!memcmp(&current->key, key, sizeof(*key)))
-        {
-            vk_pipeline = current->vk_pipeline;
-            *dynamic_state_flags = current->dynamic_state_flags;
-            break;
-        }
+        vk_pipeline = pipeline->vk_pipeline;
+        *dynamic_state_flags = pipeline->dynamic_state_flags;
     }
     rwlock_unlock_read(&state->lock);
 
@@ -4961,42 +5945,34 @@ static bool d3d12_pipeline_state_put_pipeline_to_cache(struct d3d12_pipeline_sta
         const struct vkd3d_pipeline_key *key, VkPipeline vk_pipeline, uint32_t dynamic_state_flags)
 {
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
-    struct vkd3d_compiled_pipeline *compiled_pipeline, *current;
-
-    if (!(compiled_pipeline = vkd3d_malloc(sizeof(*compiled_pipeline))))
-        return false;
+    struct vkd3d_compiled_pipeline compiled_pipeline, *entry;
+    bool inserted = false;
 
-    compiled_pipeline->key = *key;
-    compiled_pipeline->vk_pipeline = vk_pipeline;
-    compiled_pipeline->dynamic_state_flags = dynamic_state_flags;
+    memset(&compiled_pipeline, 0, sizeof(compiled_pipeline));
+    compiled_pipeline.key = *key;
+    compiled_pipeline.vk_pipeline = vk_pipeline;
+    compiled_pipeline.dynamic_state_flags = dynamic_state_flags;
 
     rwlock_lock_write(&state->lock);
 
-    LIST_FOR_EACH_ENTRY(current, &graphics->compiled_fallback_pipelines, struct vkd3d_compiled_pipeline, entry)
-    {
-        if (!memcmp(&current->key, key, sizeof(*key)))
-        {
-            vkd3d_free(compiled_pipeline);
-            compiled_pipeline = NULL;
-            break;
-        }
-    }
-
-    if (compiled_pipeline)
-        list_add_tail(&graphics->compiled_fallback_pipelines, &compiled_pipeline->entry);
+    /* If another thread won the race, the insert returns the existing entry. */
+    if ((entry = (struct vkd3d_compiled_pipeline *)hash_map_insert(&graphics->compiled_fallback_pipelines,
+            key, &compiled_pipeline.entry)))
+        inserted = entry->vk_pipeline == vk_pipeline;
 
     rwlock_unlock_write(&state->lock);
-    return compiled_pipeline;
+    return inserted;
 }
 
 static VkResult d3d12_pipeline_state_link_pipeline_variant(struct d3d12_pipeline_state *state,
         const struct vkd3d_pipeline_key *key, const struct vkd3d_format *dsv_format, VkPipelineCache vk_cache,
-        uint32_t dynamic_state_flags, VkPipeline *vk_pipeline)
+        uint32_t dynamic_state_flags, bool link_time_optimize, VkPipeline *vk_pipeline)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &state->device->vk_procs;
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
     struct vkd3d_fragment_output_pipeline_desc fragment_output_desc;
     struct vkd3d_vertex_input_pipeline_desc vertex_input_desc;
+    struct vkd3d_pipeline_telemetry_timer timer;
     VkPipelineLibraryCreateInfoKHR library_info;
     VkGraphicsPipelineCreateInfo create_info;
     VkPipeline vk_libraries[3];
@@ -5033,14 +6009,14 @@ static VkResult d3d12_pipeline_state_link_pipeline_variant(struct d3d12_pipeline
     if (d3d12_device_uses_descriptor_buffers(state->device))
         create_info.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
 
-    /* Only use LINK_TIME_OPTIMIZATION for the primary pipeline for now,
-     * accept a small runtime perf hit on subsequent compiles in order
-     * to avoid stutter. */
-    if (!key)
+    if (link_time_optimize)
         create_info.flags |= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
 
+    vkd3d_pipeline_telemetry_begin(&timer);
     vr = VK_CALL(vkCreateGraphicsPipelines(state->device->vk_device,
             vk_cache, 1, &create_info, NULL, vk_pipeline));
+    vkd3d_pipeline_telemetry_end(state, &timer, VKD3D_PIPELINE_TELEMETRY_PHASE_LINK,
+            state->telemetry.cached_source);
 
     if (vr != VK_SUCCESS && vr != VK_PIPELINE_COMPILE_REQUIRED)
         ERR("Failed to create link pipeline, vr %d.\n", vr);
@@ -5060,9 +6036,11 @@ VkPipeline d3d12_pipeline_state_create_pipeline_variant(struct d3d12_pipeline_st
     VkPipelineShaderStageCreateInfo stages[VKD3D_MAX_SHADER_STAGES];
     VkGraphicsPipelineLibraryCreateInfoEXT library_create_info;
     struct vkd3d_vertex_input_pipeline_desc vertex_input_desc;
+    enum vkd3d_pipeline_telemetry_source telemetry_source;
     VkPipelineTessellationStateCreateInfo tessellation_info;
     bool has_vertex_input_state, has_fragment_output_state;
     VkPipelineCreationFeedbackCreateInfoEXT feedback_info;
+    struct vkd3d_pipeline_telemetry_timer timer;
     VkPipelineDynamicStateCreateInfo dynamic_create_info;
     struct d3d12_device *device = state->device;
     VkGraphicsPipelineCreateInfo pipeline_desc;
@@ -5079,8 +6057,11 @@ VkPipeline d3d12_pipeline_state_create_pipeline_variant(struct d3d12_pipeline_st
 
     if (!library_flags && graphics->library)
     {
+        /* Only use LINK_TIME_OPTIMIZATION for the primary pipeline here. Variants are
+         * fast-linked to avoid stutter, and an optimized link is swapped in later,
+         * see d3d12_pipeline_state_enqueue_optimized_link(). */
         if (d3d12_pipeline_state_link_pipeline_variant(state, key, dsv_format,
-                vk_cache, *dynamic_state_flags, &vk_pipeline) == VK_SUCCESS)
+                vk_cache, *dynamic_state_flags, !key, &vk_pipeline) == VK_SUCCESS)
             return vk_pipeline;
     }
 
@@ -5224,7 +6205,9 @@ VkPipeline d3d12_pipeline_state_create_pipeline_variant(struct d3d12_pipeline_st
     else
         feedback_info.pipelineStageCreationFeedbackCount = 0;
 
+    vkd3d_pipeline_telemetry_begin(&timer);
     vr = VK_CALL(vkCreateGraphicsPipelines(device->vk_device, vk_cache, 1, &pipeline_desc, NULL, &vk_pipeline));
+    telemetry_source = state->telemetry.cached_source;
 
     if (vkd3d_config_flags & VKD3D_CONFIG_FLAG_PIPELINE_LIBRARY_LOG)
     {
@@ -5251,10 +6234,13 @@ VkPipeline d3d12_pipeline_state_create_pipeline_variant(struct d3d12_pipeline_st
         pipeline_desc.flags &= ~VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT;
         /* Internal modules are known to be non-null now. */
         pipeline_desc.pStages = state->graphics.stages;
+        vkd3d_pipeline_telemetry_begin(&timer);
         vr = VK_CALL(vkCreateGraphicsPipelines(device->vk_device, vk_cache, 1, &pipeline_desc, NULL, &vk_pipeline));
+        telemetry_source = VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH;
     }
 
     TRACE("Completed vkCreateGraphicsPipelines.\n");
+    vkd3d_pipeline_telemetry_end(state, &timer, VKD3D_PIPELINE_TELEMETRY_PHASE_PIPELINE, telemetry_source);
 
     if (vr < 0)
     {
@@ -5280,13 +6266,50 @@ err:
     return vk_pipeline;
 }
 
+static VkPipeline d3d12_pipeline_state_get_async_link_pipeline(struct d3d12_pipeline_state *state)
+{
+    struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
+    VkPipeline vk_pipeline;
+
+    rwlock_lock_read(&state->lock);
+    vk_pipeline = graphics->async_link_pipeline;
+    rwlock_unlock_read(&state->lock);
+
+    if (vk_pipeline)
+        return vk_pipeline;
+
+    /* Fast-link without LTO. This is expected to be cheap compared to waiting for the optimized pipeline. */
+    rwlock_lock_write(&state->lock);
+    if (!graphics->async_link_pipeline && d3d12_pipeline_state_link_pipeline_variant(state, NULL,
+            graphics->dsv_format, VK_NULL_HANDLE, graphics->dynamic_state_flags, false,
+            &graphics->async_link_pipeline) != VK_SUCCESS)
+        graphics->async_link_pipeline = VK_NULL_HANDLE;
+    vk_pipeline = graphics->async_link_pipeline;
+    rwlock_unlock_write(&state->lock);
+
+    return vk_pipeline;
+}
+
 VkPipeline d3d12_pipeline_state_get_pipeline(struct d3d12_pipeline_state *state,
         const struct vkd3d_dynamic_state *dyn_state, const struct vkd3d_format *dsv_format,
         uint32_t *dynamic_state_flags)
 {
     struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
+    VkPipeline vk_pipeline = VK_NULL_HANDLE;
+
+    if (vkd3d_job_is_pending(&graphics->async_compile_task))
+    {
+        if (graphics->library)
+            vk_pipeline = d3d12_pipeline_state_get_async_link_pipeline(state);
+
+        if (!vk_pipeline)
+            d3d12_pipeline_state_wait_async_compile(state);
+    }
+
+    if (!vk_pipeline)
+        vk_pipeline = graphics->pipeline;
 
-    if (!graphics->pipeline)
+    if (!vk_pipeline)
         return VK_NULL_HANDLE;
 
     if (d3d12_graphics_pipeline_state_has_unknown_dsv_format_with_test(graphics) && dsv_format)
@@ -5320,39 +6343,124 @@ VkPipeline d3d12_pipeline_state_get_pipeline(struct d3d12_pipeline_state *state,
     }
 
     *dynamic_state_flags = state->graphics.dynamic_state_flags;
-    return state->graphics.pipeline;
+    return vk_pipeline;
 }
 
-VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_state *state,
+void d3d12_pipeline_state_init_pipeline_key(struct d3d12_pipeline_state *state,
         const struct vkd3d_dynamic_state *dyn_state, const struct vkd3d_format *dsv_format,
-        uint32_t *dynamic_state_flags)
+        struct vkd3d_pipeline_key *key)
 {
-    const struct vkd3d_vk_device_procs *vk_procs = &state->device->vk_procs;
-    struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
-    struct d3d12_device *device = state->device;
-    struct vkd3d_pipeline_key pipeline_key;
-    VkPipeline vk_pipeline;
+    const struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
 
     assert(d3d12_pipeline_state_is_graphics(state));
 
-    /* If we have a fully dynamic PSO we have released all references to code, so this code path should never be hit. */
-    assert(!state->pso_is_fully_dynamic);
-
-    memset(&pipeline_key, 0, sizeof(pipeline_key));
+    memset(key, 0, sizeof(*key));
 
     /* Try to keep as much dynamic state as possible so we don't have to rebind state unnecessarily. */
     if (!(graphics->stage_flags & VK_SHADER_STAGE_MESH_BIT_EXT))
     {
         if (graphics->primitive_topology_type != D3D12_PRIMITIVE_TOPOLOGY_TYPE_PATCH &&
             graphics->primitive_topology_type != D3D12_PRIMITIVE_TOPOLOGY_TYPE_UNDEFINED)
-            pipeline_key.dynamic_topology = true;
+            key->dynamic_topology = true;
         else
-            pipeline_key.topology = dyn_state->primitive_topology;
+            key->topology = dyn_state->primitive_topology;
+    }
+
+    key->dsv_format = dsv_format ? dsv_format->vk_format : VK_FORMAT_UNDEFINED;
+}
+
+struct vkd3d_pipeline_optimized_link_task
+{
+    struct vkd3d_job task;
+    struct d3d12_pipeline_state *state;
+    struct vkd3d_pipeline_key key;
+    const struct vkd3d_format *dsv_format;
+    uint32_t dynamic_state_flags;
+};
+
+static void d3d12_pipeline_state_link_optimized_async(void *userdata)
+{
+    struct vkd3d_pipeline_optimized_link_task *task = userdata;
+    struct d3d12_pipeline_state *state = task->state;
+    const struct vkd3d_vk_device_procs *vk_procs = &state->device->vk_procs;
+    struct d3d12_graphics_pipeline_state *graphics = &state->graphics;
+    struct vkd3d_compiled_pipeline *pipeline;
+    VkPipeline vk_pipeline;
+
+    if (d3d12_pipeline_state_link_pipeline_variant(state, &task->key, task->dsv_format,
+            VK_NULL_HANDLE, task->dynamic_state_flags, true, &vk_pipeline) != VK_SUCCESS)
+    {
+        WARN("Failed to link optimized pipeline variant for %p, keeping fast-linked pipeline.\n", state);
+        return;
+    }
+
+    /* Readers only observe vk_pipeline under the lock, so they either get the
+     * fast-linked pipeline or the optimized one. */
+    rwlock_lock_write(&state->lock);
+    if ((pipeline = (struct vkd3d_compiled_pipeline *)hash_map_find(&graphics->compiled_fallback_pipelines, &task->key)) &&
+            !pipeline->vk_fast_link_pipeline)
+    {
+        pipeline->vk_fast_link_pipeline = pipeline->vk_pipeline;
+        pipeline->vk_pipeline = vk_pipeline;
+        vk_pipeline = VK_NULL_HANDLE;
     }
+    rwlock_unlock_write(&state->lock);
+
+    VK_CALL(vkDestroyPipeline(state->device->vk_device, vk_pipeline, NULL));
+    TRACE("Swapped in optimized pipeline variant for %p.\n", state);
+}
+
+static void d3d12_pipeline_state_release_optimized_link(void *userdata)
+{
+    struct vkd3d_pipeline_optimized_link_task *task = userdata;
+
+    d3d12_pipeline_state_dec_ref(task->state);
+    vkd3d_free(task);
+}
+
+static void d3d12_pipeline_state_enqueue_optimized_link(struct d3d12_pipeline_state *state,
+        const struct vkd3d_pipeline_key *key, const struct vkd3d_format *dsv_format, uint32_t dynamic_state_flags)
+{
+    struct vkd3d_job_pool *pool = &state->device->job_pool;
+    struct vkd3d_pipeline_optimized_link_task *task;
+
+    /* Background links used to be tied to the compile pool being enabled, keep that opt-in
+     * now that the worker pool always exists. */
+    if (!pool->thread_count || !(vkd3d_config_flags & (VKD3D_CONFIG_FLAG_PIPELINE_ASYNC_COMPILE |
+            VKD3D_CONFIG_FLAG_PIPELINE_PARALLEL_COMPILE | VKD3D_CONFIG_FLAG_SPECIALIZE_ROOT_CONSTANTS)))
+        return;
+
+    if (!(task = vkd3d_calloc(1, sizeof(*task))))
+        return;
+
+    task->state = state;
+    task->key = *key;
+    task->dsv_format = dsv_format;
+    task->dynamic_state_flags = dynamic_state_flags;
+
+    /* Keep the PSO alive until the task completes. */
+    d3d12_pipeline_state_inc_ref(state);
 
-    pipeline_key.dsv_format = dsv_format ? dsv_format->vk_format : VK_FORMAT_UNDEFINED;
+    task->task.callback = d3d12_pipeline_state_link_optimized_async;
+    task->task.release = d3d12_pipeline_state_release_optimized_link;
+    task->task.userdata = task;
+    vkd3d_job_pool_enqueue(pool, &task->task);
+}
+
+VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_state *state,
+        const struct vkd3d_pipeline_key *key, const struct vkd3d_format *dsv_format,
+        uint32_t *dynamic_state_flags)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &state->device->vk_procs;
+    struct d3d12_device *device = state->device;
+    VkPipeline vk_pipeline;
 
-    if ((vk_pipeline = d3d12_pipeline_state_find_compiled_pipeline(state, &pipeline_key, dynamic_state_flags)))
+    assert(d3d12_pipeline_state_is_graphics(state));
+
+    /* If we have a fully dynamic PSO we have released all references to code, so this code path should never be hit. */
+    assert(!state->pso_is_fully_dynamic);
+
+    if ((vk_pipeline = d3d12_pipeline_state_find_compiled_pipeline(state, key, dynamic_state_flags)))
     {
         return vk_pipeline;
     }
@@ -5360,7 +6468,7 @@ VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_sta
     FIXME("Compiling a fallback pipeline late!\n");
 
     vk_pipeline = d3d12_pipeline_state_create_pipeline_variant(state,
-            &pipeline_key, dsv_format, VK_NULL_HANDLE, 0, dynamic_state_flags);
+            key, dsv_format, VK_NULL_HANDLE, 0, dynamic_state_flags);
 
     if (!vk_pipeline)
     {
@@ -5368,12 +6476,17 @@ VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_sta
         return VK_NULL_HANDLE;
     }
 
-    if (d3d12_pipeline_state_put_pipeline_to_cache(state, &pipeline_key, vk_pipeline, *dynamic_state_flags))
+    if (d3d12_pipeline_state_put_pipeline_to_cache(state, key, vk_pipeline, *dynamic_state_flags))
+    {
+        /* With a library, the variant was fast-linked. Build the optimized one in the background. */
+        if (state->graphics.library)
+            d3d12_pipeline_state_enqueue_optimized_link(state, key, dsv_format, *dynamic_state_flags);
         return vk_pipeline;
+    }
 
     /* Other thread compiled the pipeline before us. */
     VK_CALL(vkDestroyPipeline(device->vk_device, vk_pipeline, NULL));
-    vk_pipeline = d3d12_pipeline_state_find_compiled_pipeline(state, &pipeline_key, dynamic_state_flags);
+    vk_pipeline = d3d12_pipeline_state_find_compiled_pipeline(state, key, dynamic_state_flags);
     if (!vk_pipeline)
         ERR("Could not get the pipeline compiled by other thread from the cache.\n");
     return vk_pipeline;
@@ -5821,12 +6934,10 @@ bool vkd3d_bindless_supports_embedded_mutable_type(struct d3d12_device *device,
     const VkPhysicalDeviceDescriptorBufferPropertiesEXT *props = &device->device_info.descriptor_buffer_properties;
     uint32_t max_size;
 
-#ifdef VKD3D_ENABLE_PROFILING
     /* For now, we don't do vtable variant shenanigans for profiled devices.
      * This can be fixed, but it's not that important at this time. */
     if (vkd3d_uses_profiling())
         return false;
-#endif
 
     /* If we're using descriptor QA, we need more complex CPU VA decode to decode heap, offsets, types, etc,
      * so the fast path is not feasible. */
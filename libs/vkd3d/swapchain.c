@@ -52,6 +52,8 @@ static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_factory_QueryInterface(IDXGI
 struct dxgi_vk_swap_chain_present_request
 {
     uint64_t begin_frame_time_ns;
+    uint64_t low_latency_frame_id;
+    uint64_t frame_index;
     uint32_t user_index;
     uint32_t target_min_image_count;
     DXGI_FORMAT dxgi_format;
@@ -65,11 +67,19 @@ struct present_wait_entry
 {
     uint64_t id;
     uint64_t begin_frame_time_ns;
+    uint64_t frame_index;
+    uint64_t blit_count;
 };
 
+/* Must be a power of two. */
+#define DXGI_VK_FRAME_TIMING_HISTORY 64u
+/* How often frame pacing is summarized when debugging latency. */
+#define DXGI_VK_FRAME_TIMING_REPORT_INTERVAL 256u
+
 struct dxgi_vk_swap_chain
 {
     IDXGIVkSwapChain IDXGIVkSwapChain_iface;
+    IDXGIVkSwapChainFramePacing IDXGIVkSwapChainFramePacing_iface;
     struct d3d12_command_queue *queue;
 
     LONG refcount;
@@ -124,9 +134,15 @@ struct dxgi_vk_swap_chain
         uint32_t backbuffer_height;
         uint32_t backbuffer_count;
         VkFormat backbuffer_format;
+        bool backbuffer_supports_transfer_dst;
         bool acquire_fence_pending;
 
+        /* Blits are done with a compute shader on the async queue. Decided whenever the swapchain is recreated. */
+        bool compute_blit;
+        uint32_t blit_command_pool_family_index;
+
         struct vkd3d_swapchain_info pipeline;
+        struct vkd3d_swapchain_info compute_pipeline;
 
         uint32_t is_occlusion_state; /* Updated atomically. */
 
@@ -137,6 +153,16 @@ struct dxgi_vk_swap_chain
 
     struct dxgi_vk_swap_chain_present_request request, request_ring[DXGI_MAX_SWAP_CHAIN_BUFFERS];
 
+    /* Dedicated queue for blits with VKD3D_CONFIG_FLAG_SWAPCHAIN_ASYNC_COMPUTE. */
+    struct
+    {
+        struct vkd3d_queue *vkd3d_queue;
+        /* Signalled on the application queue, so work on the async queue can wait for rendering to complete. */
+        VkSemaphore vk_user_semaphore;
+        uint64_t user_count;
+        bool supports_present;
+    } async;
+
     struct
     {
         struct d3d12_resource *backbuffers[DXGI_MAX_SWAP_CHAIN_BUFFERS];
@@ -169,6 +195,26 @@ struct dxgi_vk_swap_chain
         pthread_mutex_t lock;
         bool active;
     } wait_thread;
+
+    /* Frame pacing statistics. Frames are indexed by user.present_count. */
+    struct
+    {
+        pthread_mutex_t lock;
+        DXGI_VK_FRAME_TIMING frames[DXGI_VK_FRAME_TIMING_HISTORY];
+        /* All frames up to and including this one have completed timing. */
+        uint64_t completed_frame_index;
+        FILE *csv_file;
+
+        /* Only touched by the thread which completes frames. */
+        uint64_t report_interval_sum_ns;
+        uint64_t report_interval_max_ns;
+        uint64_t report_last_present_ns;
+        uint32_t report_count;
+
+        /* Frame pacing controller, 0 when disabled. Updated atomically. */
+        uint64_t target_interval_ns;
+        uint64_t last_deadline_ns;
+    } timing;
 };
 
 static void dxgi_vk_swap_chain_drain_queue(struct dxgi_vk_swap_chain *chain)
@@ -224,7 +270,8 @@ static void dxgi_vk_swap_chain_drain_user_images(struct dxgi_vk_swap_chain *chai
     dxgi_vk_swap_chain_drain_blit_semaphore(chain, chain->user.blit_count);
 }
 
-static void dxgi_vk_swap_chain_push_present_id(struct dxgi_vk_swap_chain *chain, uint64_t present_id, uint64_t begin_frame_time_ns)
+static void dxgi_vk_swap_chain_push_present_id(struct dxgi_vk_swap_chain *chain, uint64_t present_id,
+        uint64_t begin_frame_time_ns, uint64_t frame_index, uint64_t blit_count)
 {
     struct present_wait_entry *entry;
     pthread_mutex_lock(&chain->wait_thread.lock);
@@ -233,6 +280,8 @@ static void dxgi_vk_swap_chain_push_present_id(struct dxgi_vk_swap_chain *chain,
     entry = &chain->wait_thread.wait_queue[chain->wait_thread.wait_queue_count++];
     entry->id = present_id;
     entry->begin_frame_time_ns = begin_frame_time_ns;
+    entry->frame_index = frame_index;
+    entry->blit_count = blit_count;
     pthread_cond_signal(&chain->wait_thread.cond);
     pthread_mutex_unlock(&chain->wait_thread.lock);
 }
@@ -242,17 +291,24 @@ static void dxgi_vk_swap_chain_wait_and_reset_acquire_fence(struct dxgi_vk_swap_
 static void dxgi_vk_swap_chain_cleanup(struct dxgi_vk_swap_chain *chain)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkQueue vk_queue;
     UINT i;
 
+    vkd3d_low_latency_unregister_swapchain(chain->queue->device, chain);
+
     if (chain->wait_thread.active)
     {
-        dxgi_vk_swap_chain_push_present_id(chain, 0, 0);
+        dxgi_vk_swap_chain_push_present_id(chain, 0, 0, 0, 0);
         pthread_join(chain->wait_thread.thread, NULL);
         pthread_mutex_destroy(&chain->wait_thread.lock);
         pthread_cond_destroy(&chain->wait_thread.cond);
     }
     vkd3d_free(chain->wait_thread.wait_queue);
 
+    if (chain->timing.csv_file)
+        fclose(chain->timing.csv_file);
+    pthread_mutex_destroy(&chain->timing.lock);
+
     if (chain->present.frame_latency_fence)
         ID3D12Fence1_Release(chain->present.frame_latency_fence);
 
@@ -266,6 +322,15 @@ static void dxgi_vk_swap_chain_cleanup(struct dxgi_vk_swap_chain *chain)
     }
     vkd3d_native_sync_handle_destroy(chain->present_request_done_event);
 
+    if (chain->async.vkd3d_queue)
+    {
+        vk_queue = vkd3d_queue_acquire(chain->async.vkd3d_queue);
+        VK_CALL(vkQueueWaitIdle(vk_queue));
+        vkd3d_queue_release(chain->async.vkd3d_queue);
+        d3d12_device_unmap_vkd3d_queue(chain->queue->device, chain->async.vkd3d_queue);
+    }
+    VK_CALL(vkDestroySemaphore(chain->queue->device->vk_device, chain->async.vk_user_semaphore, NULL));
+
     VK_CALL(vkDestroySemaphore(chain->queue->device->vk_device, chain->present.vk_blit_semaphore, NULL));
     VK_CALL(vkDestroyCommandPool(chain->queue->device->vk_device, chain->present.vk_blit_command_pool, NULL));
     for (i = 0; i < ARRAY_SIZE(chain->present.vk_release_semaphores); i++)
@@ -336,6 +401,13 @@ static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_QueryInterface(IDXGIVkSwapCh
         return S_OK;
     }
 
+    if (IsEqualGUID(riid, &IID_IDXGIVkSwapChainFramePacing))
+    {
+        dxgi_vk_swap_chain_AddRef(&chain->IDXGIVkSwapChain_iface);
+        *object = &chain->IDXGIVkSwapChainFramePacing_iface;
+        return S_OK;
+    }
+
     return E_NOINTERFACE;
 }
 
@@ -722,6 +794,86 @@ static bool dxgi_vk_swap_chain_present_is_occluded(struct dxgi_vk_swap_chain *ch
 
 static void dxgi_vk_swap_chain_present_callback(void *chain);
 
+static void dxgi_vk_swap_chain_begin_frame_timing(struct dxgi_vk_swap_chain *chain, uint64_t frame_index)
+{
+    DXGI_VK_FRAME_TIMING *frame;
+
+    pthread_mutex_lock(&chain->timing.lock);
+    frame = &chain->timing.frames[frame_index & (DXGI_VK_FRAME_TIMING_HISTORY - 1)];
+    memset(frame, 0, sizeof(*frame));
+    frame->PresentCount = frame_index;
+    frame->CpuSubmitTimeNs = vkd3d_get_current_time_ns();
+    pthread_mutex_unlock(&chain->timing.lock);
+}
+
+static void dxgi_vk_swap_chain_complete_frame_timing(struct dxgi_vk_swap_chain *chain, uint64_t frame_index,
+        uint64_t gpu_complete_ns, uint64_t present_complete_ns)
+{
+    DXGI_VK_FRAME_TIMING frame;
+    uint64_t interval_ns;
+
+    pthread_mutex_lock(&chain->timing.lock);
+    chain->timing.frames[frame_index & (DXGI_VK_FRAME_TIMING_HISTORY - 1)].GpuCompleteTimeNs = gpu_complete_ns;
+    chain->timing.frames[frame_index & (DXGI_VK_FRAME_TIMING_HISTORY - 1)].PresentCompleteTimeNs = present_complete_ns;
+    frame = chain->timing.frames[frame_index & (DXGI_VK_FRAME_TIMING_HISTORY - 1)];
+    chain->timing.completed_frame_index = max(chain->timing.completed_frame_index, frame_index);
+    pthread_mutex_unlock(&chain->timing.lock);
+
+    if (chain->timing.csv_file)
+    {
+        fprintf(chain->timing.csv_file, "%"PRIu64",%"PRIu64",%"PRIu64",%"PRIu64"\n",
+                frame.PresentCount, frame.CpuSubmitTimeNs, frame.GpuCompleteTimeNs, frame.PresentCompleteTimeNs);
+    }
+
+    if (!chain->debug_latency || !present_complete_ns)
+        return;
+
+    if (chain->timing.report_last_present_ns)
+    {
+        interval_ns = present_complete_ns - chain->timing.report_last_present_ns;
+        chain->timing.report_interval_sum_ns += interval_ns;
+        chain->timing.report_interval_max_ns = max(chain->timing.report_interval_max_ns, interval_ns);
+        chain->timing.report_count++;
+    }
+    chain->timing.report_last_present_ns = present_complete_ns;
+
+    if (chain->timing.report_count == DXGI_VK_FRAME_TIMING_REPORT_INTERVAL)
+    {
+        INFO("Frame pacing over %u frames: average interval %.3f ms, worst interval %.3f ms.\n",
+                chain->timing.report_count,
+                1e-6 * (double)chain->timing.report_interval_sum_ns / chain->timing.report_count,
+                1e-6 * (double)chain->timing.report_interval_max_ns);
+        chain->timing.report_interval_sum_ns = 0;
+        chain->timing.report_interval_max_ns = 0;
+        chain->timing.report_count = 0;
+    }
+}
+
+static void dxgi_vk_swap_chain_pace_frame(struct dxgi_vk_swap_chain *chain)
+{
+    uint64_t interval_ns, deadline_ns, now_ns;
+
+    interval_ns = vkd3d_atomic_uint64_load_explicit(&chain->timing.target_interval_ns, vkd3d_memory_order_relaxed);
+    if (!interval_ns)
+    {
+        chain->timing.last_deadline_ns = 0;
+        return;
+    }
+
+    /* Advance an absolute deadline rather than sleeping for a fixed amount, so the cadence stays even
+     * regardless of how long the frame took. If we fell behind, resynchronize rather than
+     * trying to catch up with a burst of frames. */
+    now_ns = vkd3d_get_current_time_ns();
+    deadline_ns = chain->timing.last_deadline_ns + interval_ns;
+
+    if (chain->timing.last_deadline_ns && deadline_ns > now_ns)
+        vkd3d_sleep_until_ns(deadline_ns);
+    else
+        deadline_ns = now_ns;
+
+    chain->timing.last_deadline_ns = deadline_ns;
+}
+
 static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_Present(IDXGIVkSwapChain *iface, UINT SyncInterval, UINT PresentFlags, const DXGI_PRESENT_PARAMETERS *pPresentParameters)
 {
     struct dxgi_vk_swap_chain *chain = impl_from_IDXGIVkSwapChain(iface);
@@ -749,6 +901,11 @@ static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_Present(IDXGIVkSwapChain *if
     chain->user.present_count += 1;
     request = &chain->request_ring[chain->user.present_count % ARRAY_SIZE(chain->request_ring)];
 
+    /* Presents define frame boundaries for residency decisions. */
+    vkd3d_residency_manager_notify_frame(&chain->queue->device->residency_manager);
+    vkd3d_memory_footprint_notify_frame(&chain->queue->device->memory_footprint);
+    vkd3d_command_list_stats_report_notify_frame(&chain->queue->device->command_list_stats);
+
     request->swap_interval = SyncInterval;
     request->dxgi_format = chain->user.backbuffers[chain->user.index]->desc.Format;
     request->user_index = chain->user.index;
@@ -760,8 +917,13 @@ static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_Present(IDXGIVkSwapChain *if
     request->dxgi_hdr_metadata = chain->user.dxgi_hdr_metadata;
     request->modifies_hdr_metadata = chain->user.modifies_hdr_metadata;
     request->begin_frame_time_ns = chain->user.begin_frame_time_ns;
+    request->low_latency_frame_id = vkd3d_atomic_uint64_load_explicit(
+            &chain->queue->device->low_latency.frame_id, vkd3d_memory_order_relaxed);
+    request->frame_index = chain->user.present_count;
     chain->user.modifies_hdr_metadata = false;
 
+    dxgi_vk_swap_chain_begin_frame_timing(chain, request->frame_index);
+
     /* Need to process this task in queue thread to deal with wait-before-signal.
      * All interesting works happens in the callback. */
     chain->user.blit_count += 1;
@@ -791,6 +953,11 @@ static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_Present(IDXGIVkSwapChain *if
         }
     }
 
+    dxgi_vk_swap_chain_pace_frame(chain);
+
+    /* Sleep point for low latency, unless the application drives it through ID3DLowLatencyDevice. */
+    vkd3d_low_latency_begin_implicit_frame(chain->queue->device);
+
     /* For latency debug purposes. Consider a frame to begin when we return from Present() with the next user index set.
      * This isn't necessarily correct if the application does WaitSingleObject() on the latency right after this call.
      * That call can take up a frame, so the real latency will be lower than the one reported.
@@ -919,6 +1086,79 @@ static CONST_VTBL struct IDXGIVkSwapChainVtbl dxgi_vk_swap_chain_vtbl =
     dxgi_vk_swap_chain_SetHDRMetaData,
 };
 
+static inline struct dxgi_vk_swap_chain *impl_from_IDXGIVkSwapChainFramePacing(IDXGIVkSwapChainFramePacing *iface)
+{
+    return CONTAINING_RECORD(iface, struct dxgi_vk_swap_chain, IDXGIVkSwapChainFramePacing_iface);
+}
+
+static ULONG STDMETHODCALLTYPE dxgi_vk_swap_chain_frame_pacing_AddRef(IDXGIVkSwapChainFramePacing *iface)
+{
+    struct dxgi_vk_swap_chain *chain = impl_from_IDXGIVkSwapChainFramePacing(iface);
+    return dxgi_vk_swap_chain_AddRef(&chain->IDXGIVkSwapChain_iface);
+}
+
+static ULONG STDMETHODCALLTYPE dxgi_vk_swap_chain_frame_pacing_Release(IDXGIVkSwapChainFramePacing *iface)
+{
+    struct dxgi_vk_swap_chain *chain = impl_from_IDXGIVkSwapChainFramePacing(iface);
+    return dxgi_vk_swap_chain_Release(&chain->IDXGIVkSwapChain_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_frame_pacing_QueryInterface(IDXGIVkSwapChainFramePacing *iface,
+        REFIID riid, void **object)
+{
+    struct dxgi_vk_swap_chain *chain = impl_from_IDXGIVkSwapChainFramePacing(iface);
+    return dxgi_vk_swap_chain_QueryInterface(&chain->IDXGIVkSwapChain_iface, riid, object);
+}
+
+static UINT STDMETHODCALLTYPE dxgi_vk_swap_chain_frame_pacing_GetFrameTimings(IDXGIVkSwapChainFramePacing *iface,
+        UINT MaxCount, DXGI_VK_FRAME_TIMING *pTimings)
+{
+    struct dxgi_vk_swap_chain *chain = impl_from_IDXGIVkSwapChainFramePacing(iface);
+    uint64_t first_frame_index, last_frame_index, i;
+    UINT count;
+
+    TRACE("iface %p, MaxCount %u, pTimings %p.\n", iface, MaxCount, pTimings);
+
+    pthread_mutex_lock(&chain->timing.lock);
+
+    /* Only report completed frames, oldest first. */
+    last_frame_index = chain->timing.completed_frame_index;
+    count = min(MaxCount, min(DXGI_VK_FRAME_TIMING_HISTORY, last_frame_index));
+    first_frame_index = last_frame_index + 1 - count;
+
+    if (pTimings)
+    {
+        for (i = first_frame_index; i <= last_frame_index && count; i++)
+            pTimings[i - first_frame_index] = chain->timing.frames[i & (DXGI_VK_FRAME_TIMING_HISTORY - 1)];
+    }
+
+    pthread_mutex_unlock(&chain->timing.lock);
+    return count;
+}
+
+static HRESULT STDMETHODCALLTYPE dxgi_vk_swap_chain_frame_pacing_SetTargetFrameInterval(IDXGIVkSwapChainFramePacing *iface,
+        UINT64 IntervalNs)
+{
+    struct dxgi_vk_swap_chain *chain = impl_from_IDXGIVkSwapChainFramePacing(iface);
+
+    TRACE("iface %p, IntervalNs %"PRIu64".\n", iface, IntervalNs);
+
+    vkd3d_atomic_uint64_store_explicit(&chain->timing.target_interval_ns, IntervalNs, vkd3d_memory_order_relaxed);
+    return S_OK;
+}
+
+static CONST_VTBL struct IDXGIVkSwapChainFramePacingVtbl dxgi_vk_swap_chain_frame_pacing_vtbl =
+{
+    /* IUnknown methods */
+    dxgi_vk_swap_chain_frame_pacing_QueryInterface,
+    dxgi_vk_swap_chain_frame_pacing_AddRef,
+    dxgi_vk_swap_chain_frame_pacing_Release,
+
+    /* IDXGIVkSwapChainFramePacing methods */
+    dxgi_vk_swap_chain_frame_pacing_GetFrameTimings,
+    dxgi_vk_swap_chain_frame_pacing_SetTargetFrameInterval,
+};
+
 static bool dxgi_vk_swap_chain_update_formats(struct dxgi_vk_swap_chain *chain)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
@@ -983,6 +1223,60 @@ static HRESULT dxgi_vk_swap_chain_create_surface(struct dxgi_vk_swap_chain *chai
     return S_OK;
 }
 
+static void dxgi_vk_swap_chain_init_async_queue(struct dxgi_vk_swap_chain *chain)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    struct d3d12_device *device = chain->queue->device;
+    VkSemaphoreTypeCreateInfoKHR type_info;
+    VkSemaphoreCreateInfo create_info;
+    struct vkd3d_queue *vkd3d_queue;
+    VkBool32 supported;
+    VkResult vr;
+
+    if (!(vkd3d_config_flags & VKD3D_CONFIG_FLAG_SWAPCHAIN_ASYNC_COMPUTE))
+        return;
+
+    /* Storage images can be written without knowing the format up front, so one compute pipeline covers all formats. */
+    if (!device->device_info.features2.features.shaderStorageImageWriteWithoutFormat)
+    {
+        WARN("shaderStorageImageWriteWithoutFormat is not supported, cannot use async compute for swapchain blits.\n");
+        return;
+    }
+
+    /* Presentation is latency sensitive, so prefer a high priority queue. */
+    vkd3d_queue = d3d12_device_allocate_vkd3d_queue(device, device->queue_families[VKD3D_QUEUE_FAMILY_INTERNAL_COMPUTE], true);
+    if (vkd3d_queue == chain->queue->vkd3d_queue)
+    {
+        WARN("No separate compute queue available, cannot use async compute for swapchain blits.\n");
+        d3d12_device_unmap_vkd3d_queue(device, vkd3d_queue);
+        return;
+    }
+
+    create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    create_info.pNext = &type_info;
+    create_info.flags = 0;
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    type_info.pNext = NULL;
+    type_info.initialValue = 0;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+
+    if ((vr = VK_CALL(vkCreateSemaphore(device->vk_device, &create_info, NULL, &chain->async.vk_user_semaphore))) < 0)
+    {
+        ERR("Failed to create timeline semaphore, vr %d.\n", vr);
+        d3d12_device_unmap_vkd3d_queue(device, vkd3d_queue);
+        return;
+    }
+
+    /* If the compute family cannot present, the blit still runs async, but present goes through the application queue. */
+    vr = VK_CALL(vkGetPhysicalDeviceSurfaceSupportKHR(device->vk_physical_device,
+            vkd3d_queue->vk_family_index, chain->vk_surface, &supported));
+    chain->async.supports_present = vr == VK_SUCCESS && supported;
+    chain->async.vkd3d_queue = vkd3d_queue;
+
+    INFO("Using async compute for swapchain blits, presenting on %s queue.\n",
+            chain->async.supports_present ? "compute" : "application");
+}
+
 static HRESULT dxgi_vk_swap_chain_init_sync_objects(struct dxgi_vk_swap_chain *chain)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
@@ -1129,6 +1423,19 @@ static void dxgi_vk_swap_chain_wait_and_reset_acquire_fence(struct dxgi_vk_swap_
     }
 }
 
+static void dxgi_vk_swap_chain_low_latency_lock(struct dxgi_vk_swap_chain *chain)
+{
+    /* Only needed to keep the VkSwapchainKHR stable for ID3DLowLatencyDevice calls on other threads. */
+    if (d3d12_device_supports_nv_low_latency(chain->queue->device))
+        pthread_mutex_lock(&chain->queue->device->low_latency.lock);
+}
+
+static void dxgi_vk_swap_chain_low_latency_unlock(struct dxgi_vk_swap_chain *chain)
+{
+    if (d3d12_device_supports_nv_low_latency(chain->queue->device))
+        pthread_mutex_unlock(&chain->queue->device->low_latency.lock);
+}
+
 static void dxgi_vk_swap_chain_destroy_swapchain_in_present_task(struct dxgi_vk_swap_chain *chain)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
@@ -1147,6 +1454,13 @@ static void dxgi_vk_swap_chain_destroy_swapchain_in_present_task(struct dxgi_vk_
     VK_CALL(vkQueueWaitIdle(vk_queue));
     vkd3d_queue_release(chain->queue->vkd3d_queue);
 
+    if (chain->async.vkd3d_queue)
+    {
+        vk_queue = vkd3d_queue_acquire(chain->async.vkd3d_queue);
+        VK_CALL(vkQueueWaitIdle(vk_queue));
+        vkd3d_queue_release(chain->async.vkd3d_queue);
+    }
+
     dxgi_vk_swap_chain_drain_waiter(chain);
 
     for (i = 0; i < ARRAY_SIZE(chain->present.vk_backbuffer_image_views); i++)
@@ -1157,8 +1471,10 @@ static void dxgi_vk_swap_chain_destroy_swapchain_in_present_task(struct dxgi_vk_
     memset(chain->present.vk_backbuffer_image_views, 0, sizeof(chain->present.vk_backbuffer_image_views));
     memset(chain->present.vk_release_semaphores, 0, sizeof(chain->present.vk_release_semaphores));
 
+    dxgi_vk_swap_chain_low_latency_lock(chain);
     VK_CALL(vkDestroySwapchainKHR(chain->queue->device->vk_device, chain->present.vk_swapchain, NULL));
     chain->present.vk_swapchain = VK_NULL_HANDLE;
+    dxgi_vk_swap_chain_low_latency_unlock(chain);
     chain->present.backbuffer_width = 0;
     chain->present.backbuffer_height = 0;
     chain->present.backbuffer_format = VK_FORMAT_UNDEFINED;
@@ -1262,6 +1578,48 @@ static bool dxgi_vk_swap_chain_check_present_mode_support(struct dxgi_vk_swap_ch
     return false;
 }
 
+static struct vkd3d_queue *dxgi_vk_swap_chain_get_blit_queue(struct dxgi_vk_swap_chain *chain)
+{
+    return chain->present.compute_blit ? chain->async.vkd3d_queue : chain->queue->vkd3d_queue;
+}
+
+static struct vkd3d_queue *dxgi_vk_swap_chain_get_present_queue(struct dxgi_vk_swap_chain *chain)
+{
+    return chain->async.supports_present ? chain->async.vkd3d_queue : chain->queue->vkd3d_queue;
+}
+
+static void dxgi_vk_swap_chain_signal_user_semaphore(struct dxgi_vk_swap_chain *chain)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkSemaphoreSubmitInfo signal_semaphore_info;
+    VkSubmitInfo2 submit_info;
+    VkQueue vk_queue;
+    VkResult vr;
+
+    chain->async.user_count += 1;
+
+    memset(&signal_semaphore_info, 0, sizeof(signal_semaphore_info));
+    signal_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signal_semaphore_info.semaphore = chain->async.vk_user_semaphore;
+    signal_semaphore_info.value = chain->async.user_count;
+    signal_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    memset(&submit_info, 0, sizeof(submit_info));
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submit_info.signalSemaphoreInfoCount = 1;
+    submit_info.pSignalSemaphoreInfos = &signal_semaphore_info;
+
+    vk_queue = vkd3d_queue_acquire(chain->queue->vkd3d_queue);
+    vr = VK_CALL(vkQueueSubmit2(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
+    vkd3d_queue_release(chain->queue->vkd3d_queue);
+
+    if (vr)
+    {
+        ERR("Failed to signal user semaphore, vr = %d.\n", vr);
+        VKD3D_DEVICE_REPORT_BREADCRUMB_IF(chain->queue->device, vr == VK_ERROR_DEVICE_LOST);
+    }
+}
+
 static void dxgi_vk_swap_chain_init_blit_pipeline(struct dxgi_vk_swap_chain *chain)
 {
     struct d3d12_device *device = chain->queue->device;
@@ -1274,6 +1632,18 @@ static void dxgi_vk_swap_chain_init_blit_pipeline(struct dxgi_vk_swap_chain *cha
 
     if (FAILED(hr = vkd3d_meta_get_swapchain_pipeline(&device->meta_ops, &key, &chain->present.pipeline)))
         ERR("Failed to initialize swapchain pipeline.\n");
+
+    if (chain->present.compute_blit)
+    {
+        key.bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+        key.format = VK_FORMAT_UNDEFINED;
+
+        if (FAILED(hr = vkd3d_meta_get_swapchain_pipeline(&device->meta_ops, &key, &chain->present.compute_pipeline)))
+        {
+            ERR("Failed to initialize swapchain compute pipeline.\n");
+            chain->present.compute_blit = false;
+        }
+    }
 }
 
 static void dxgi_vk_swap_chain_recreate_swapchain_in_present_task(struct dxgi_vk_swap_chain *chain)
@@ -1282,11 +1652,14 @@ static void dxgi_vk_swap_chain_recreate_swapchain_in_present_task(struct dxgi_vk
     VkPhysicalDevice vk_physical_device = chain->queue->device->vk_physical_device;
     VkDevice vk_device = chain->queue->device->vk_device;
     VkCommandPoolCreateInfo command_pool_create_info;
+    VkSwapchainLatencyCreateInfoNV latency_create_info;
     VkSwapchainCreateInfoKHR swapchain_create_info;
     VkSurfaceCapabilitiesKHR surface_caps;
+    VkFormatProperties format_properties;
     VkSurfaceFormatKHR surface_format;
     VkImageViewCreateInfo view_info;
     VkPresentModeKHR present_mode;
+    uint32_t blit_family_index;
     uint32_t override_image_count;
     bool new_occlusion_state;
     char count_env[16];
@@ -1345,6 +1718,34 @@ static void dxgi_vk_swap_chain_recreate_swapchain_in_present_task(struct dxgi_vk
     swapchain_create_info.imageFormat = surface_format.format;
     swapchain_create_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     swapchain_create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    /* Allows presenting with a plain copy when the user backbuffer matches the swapchain exactly. */
+    if (surface_caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+        swapchain_create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+    /* The compute blit writes WSI images as storage images. If the surface or format cannot do that,
+     * fall back to the graphics blit on the application queue for this swapchain. */
+    chain->present.compute_blit = false;
+    if (chain->async.vkd3d_queue)
+    {
+        VK_CALL(vkGetPhysicalDeviceFormatProperties(vk_physical_device, surface_format.format, &format_properties));
+        chain->present.compute_blit = (surface_caps.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) &&
+                (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+
+        if (!chain->present.compute_blit)
+            WARN("Swapchain format %u does not support storage, using graphics queue for blits.\n", surface_format.format);
+    }
+
+    if (chain->async.vkd3d_queue && chain->queue->device->queue_family_count > 1)
+    {
+        /* Images are written and presented on different queue families. */
+        swapchain_create_info.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        swapchain_create_info.queueFamilyIndexCount = chain->queue->device->queue_family_count;
+        swapchain_create_info.pQueueFamilyIndices = chain->queue->device->queue_family_indices;
+    }
+
+    if (chain->present.compute_blit)
+        swapchain_create_info.imageUsage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
     swapchain_create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     swapchain_create_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
     swapchain_create_info.presentMode = present_mode;
@@ -1374,13 +1775,30 @@ static void dxgi_vk_swap_chain_recreate_swapchain_in_present_task(struct dxgi_vk
     swapchain_create_info.imageExtent.height = max(swapchain_create_info.imageExtent.height, surface_caps.minImageExtent.height);
     swapchain_create_info.imageExtent.height = min(swapchain_create_info.imageExtent.height, surface_caps.maxImageExtent.height);
 
+    if (d3d12_device_supports_nv_low_latency(chain->queue->device))
+    {
+        memset(&latency_create_info, 0, sizeof(latency_create_info));
+        latency_create_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_LATENCY_CREATE_INFO_NV;
+        latency_create_info.latencyModeEnable = VK_TRUE;
+        swapchain_create_info.pNext = &latency_create_info;
+    }
+
+    dxgi_vk_swap_chain_low_latency_lock(chain);
     vr = VK_CALL(vkCreateSwapchainKHR(vk_device, &swapchain_create_info, NULL, &chain->present.vk_swapchain));
     if (vr < 0)
     {
         ERR("Failed to create swapchain, vr %d.\n", vr);
         chain->present.vk_swapchain = VK_NULL_HANDLE;
-        return;
     }
+    else if (chain->queue->device->low_latency.swapchain == chain)
+    {
+        /* Sleep mode is tracked per VkSwapchainKHR, so it has to be restored after recreation. */
+        dxgi_vk_swap_chain_low_latency_apply_sleep_mode(chain);
+    }
+    dxgi_vk_swap_chain_low_latency_unlock(chain);
+
+    if (vr < 0)
+        return;
 
     chain->present.backbuffer_count = ARRAY_SIZE(chain->present.vk_backbuffer_images);
     VK_CALL(vkGetSwapchainImagesKHR(vk_device, chain->present.vk_swapchain, &chain->present.backbuffer_count, chain->present.vk_backbuffer_images));
@@ -1404,15 +1822,29 @@ static void dxgi_vk_swap_chain_recreate_swapchain_in_present_task(struct dxgi_vk
     chain->present.backbuffer_width = swapchain_create_info.imageExtent.width;
     chain->present.backbuffer_height = swapchain_create_info.imageExtent.height;
     chain->present.backbuffer_format = swapchain_create_info.imageFormat;
+    chain->present.backbuffer_supports_transfer_dst =
+            !!(swapchain_create_info.imageUsage & VK_IMAGE_USAGE_TRANSFER_DST_BIT);
     chain->present.current_backbuffer_index = UINT32_MAX;
 
+    blit_family_index = dxgi_vk_swap_chain_get_blit_queue(chain)->vk_family_index;
+
+    /* Moving between compute and graphics blits may change queue family.
+     * The old swapchain was drained on destruction, so command buffers are not in use anymore. */
+    if (chain->present.vk_blit_command_pool && chain->present.blit_command_pool_family_index != blit_family_index)
+    {
+        VK_CALL(vkDestroyCommandPool(vk_device, chain->present.vk_blit_command_pool, NULL));
+        chain->present.vk_blit_command_pool = VK_NULL_HANDLE;
+        memset(chain->present.vk_blit_command_buffers, 0, sizeof(chain->present.vk_blit_command_buffers));
+    }
+
     if (!chain->present.vk_blit_command_pool)
     {
         command_pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         command_pool_create_info.pNext = NULL;
-        command_pool_create_info.queueFamilyIndex = chain->queue->vkd3d_queue->vk_family_index;
+        command_pool_create_info.queueFamilyIndex = blit_family_index;
         command_pool_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
         VK_CALL(vkCreateCommandPool(vk_device, &command_pool_create_info, NULL, &chain->present.vk_blit_command_pool));
+        chain->present.blit_command_pool_family_index = blit_family_index;
     }
 
     dxgi_vk_swap_chain_init_blit_pipeline(chain);
@@ -1428,10 +1860,48 @@ static bool request_needs_swapchain_recreation(const struct dxgi_vk_swap_chain_p
         (!!request->swap_interval) != (!!last_request->swap_interval);
 }
 
+static void dxgi_vk_swap_chain_throttle_user_queue(struct dxgi_vk_swap_chain *chain)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkSemaphoreSubmitInfo wait_semaphore_info;
+    VkSubmitInfo2 submit_info;
+    VkQueue vk_queue;
+    VkResult vr;
+
+    /* With async blits, the application queue is free to render the next frame while we blit.
+     * The next frame renders to the user buffer which was presented BufferCount - 1 frames ago,
+     * so only that blit has to complete before the application queue moves on. */
+    if (chain->present.blit_count < chain->desc.BufferCount)
+        return;
+
+    memset(&wait_semaphore_info, 0, sizeof(wait_semaphore_info));
+    wait_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    wait_semaphore_info.semaphore = chain->present.vk_blit_semaphore;
+    wait_semaphore_info.value = chain->present.blit_count + 1 - chain->desc.BufferCount;
+    wait_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    memset(&submit_info, 0, sizeof(submit_info));
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submit_info.waitSemaphoreInfoCount = 1;
+    submit_info.pWaitSemaphoreInfos = &wait_semaphore_info;
+
+    vk_queue = vkd3d_queue_acquire(chain->queue->vkd3d_queue);
+    vr = VK_CALL(vkQueueSubmit2(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
+    vkd3d_queue_release(chain->queue->vkd3d_queue);
+
+    if (vr)
+    {
+        ERR("Failed to submit blit wait, vr = %d.\n", vr);
+        VKD3D_DEVICE_REPORT_BREADCRUMB_IF(chain->queue->device, vr == VK_ERROR_DEVICE_LOST);
+    }
+}
+
 static void dxgi_vk_swap_chain_present_signal_blit_semaphore(struct dxgi_vk_swap_chain *chain)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
     VkSemaphoreSubmitInfo signal_semaphore_info;
+    VkSemaphoreSubmitInfo wait_semaphore_info;
+    struct vkd3d_queue *vkd3d_queue;
     VkSubmitInfo2 submit_info;
     VkQueue vk_queue;
     VkResult vr;
@@ -1449,15 +1919,37 @@ static void dxgi_vk_swap_chain_present_signal_blit_semaphore(struct dxgi_vk_swap
     submit_info.signalSemaphoreInfoCount = 1;
     submit_info.pSignalSemaphoreInfos = &signal_semaphore_info;
 
-    vk_queue = vkd3d_queue_acquire(chain->queue->vkd3d_queue);
+    vkd3d_queue = chain->queue->vkd3d_queue;
+
+    if (chain->async.vkd3d_queue)
+    {
+        /* Blits may have happened on either queue, so signal from the async queue after the application queue
+         * has caught up. This keeps the timeline monotonic even if we move between compute and graphics blits. */
+        dxgi_vk_swap_chain_signal_user_semaphore(chain);
+
+        memset(&wait_semaphore_info, 0, sizeof(wait_semaphore_info));
+        wait_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        wait_semaphore_info.semaphore = chain->async.vk_user_semaphore;
+        wait_semaphore_info.value = chain->async.user_count;
+        wait_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+        submit_info.waitSemaphoreInfoCount = 1;
+        submit_info.pWaitSemaphoreInfos = &wait_semaphore_info;
+        vkd3d_queue = chain->async.vkd3d_queue;
+    }
+
+    vk_queue = vkd3d_queue_acquire(vkd3d_queue);
     vr = VK_CALL(vkQueueSubmit2(vk_queue, 1, &submit_info, VK_NULL_HANDLE));
-    vkd3d_queue_release(chain->queue->vkd3d_queue);
+    vkd3d_queue_release(vkd3d_queue);
 
     if (vr)
     {
         ERR("Failed to submit present discard, vr = %d.\n", vr);
         VKD3D_DEVICE_REPORT_BREADCRUMB_IF(chain->queue->device, vr == VK_ERROR_DEVICE_LOST);
     }
+
+    if (chain->async.vkd3d_queue)
+        dxgi_vk_swap_chain_throttle_user_queue(chain);
 }
 
 static void dxgi_vk_swap_chain_record_render_pass(struct dxgi_vk_swap_chain *chain, VkCommandBuffer vk_cmd, uint32_t swapchain_index)
@@ -1595,16 +2087,249 @@ static void dxgi_vk_swap_chain_record_render_pass(struct dxgi_vk_swap_chain *cha
     }
 }
 
+static void dxgi_vk_swap_chain_record_compute(struct dxgi_vk_swap_chain *chain, VkCommandBuffer vk_cmd, uint32_t swapchain_index)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    struct vkd3d_swapchain_compute_args args;
+    VkDescriptorImageInfo image_infos[2];
+    VkWriteDescriptorSet write_infos[2];
+    VkImageMemoryBarrier2 image_barrier;
+    struct d3d12_resource *resource;
+    VkDependencyInfo dep_info;
+    unsigned int i;
+
+    resource = chain->user.backbuffers[chain->request.user_index];
+
+    memset(&args, 0, sizeof(args));
+    args.blank = vkd3d_atomic_uint32_load_explicit(&resource->initial_layout_transition, vkd3d_memory_order_relaxed) != 0;
+    args.image_extent.width = chain->present.backbuffer_width;
+    args.image_extent.height = chain->present.backbuffer_height;
+
+    if (args.blank)
+        WARN("Application is presenting user index %u, but it has never been rendered to.\n", chain->request.user_index);
+
+    if (chain->desc.Scaling == DXGI_SCALING_NONE)
+    {
+        args.viewport_extent.width = chain->desc.Width;
+        args.viewport_extent.height = chain->desc.Height;
+    }
+    else
+        args.viewport_extent = args.image_extent;
+
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.imageMemoryBarrierCount = 1;
+    dep_info.pImageMemoryBarriers = &image_barrier;
+
+    /* srcStage = NONE since we're using fences to acquire WSI. */
+    memset(&image_barrier, 0, sizeof(image_barrier));
+    image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    image_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    image_barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    image_barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_barrier.image = chain->present.vk_backbuffer_images[swapchain_index];
+    image_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    image_barrier.subresourceRange.levelCount = 1;
+    image_barrier.subresourceRange.layerCount = 1;
+
+    if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEBUG_UTILS) &&
+            chain->queue->device->vk_info.EXT_debug_utils)
+    {
+        VkDebugUtilsLabelEXT label;
+        label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+        label.pNext = NULL;
+        label.pLabelName = "BlitSwapChainCompute";
+        label.color[0] = 1.0f;
+        label.color[1] = 1.0f;
+        label.color[2] = 1.0f;
+        label.color[3] = 1.0f;
+        VK_CALL(vkCmdBeginDebugUtilsLabelEXT(vk_cmd, &label));
+    }
+
+    VK_CALL(vkCmdPipelineBarrier2(vk_cmd, &dep_info));
+
+    VK_CALL(vkCmdBindPipeline(vk_cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+            chain->present.compute_pipeline.vk_pipeline));
+
+    for (i = 0; i < ARRAY_SIZE(write_infos); i++)
+    {
+        write_infos[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write_infos[i].pNext = NULL;
+        write_infos[i].pBufferInfo = NULL;
+        write_infos[i].dstSet = VK_NULL_HANDLE;
+        write_infos[i].pTexelBufferView = NULL;
+        write_infos[i].pImageInfo = &image_infos[i];
+        write_infos[i].dstBinding = i;
+        write_infos[i].dstArrayElement = 0;
+        write_infos[i].descriptorCount = 1;
+        image_infos[i].sampler = VK_NULL_HANDLE;
+    }
+
+    write_infos[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    image_infos[0].imageView = chain->user.vk_image_views[chain->request.user_index];
+    image_infos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    write_infos[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    image_infos[1].imageView = chain->present.vk_backbuffer_image_views[swapchain_index];
+    image_infos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VK_CALL(vkCmdPushDescriptorSetKHR(vk_cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+            chain->present.compute_pipeline.vk_pipeline_layout, 0, ARRAY_SIZE(write_infos), write_infos));
+    VK_CALL(vkCmdPushConstants(vk_cmd, chain->present.compute_pipeline.vk_pipeline_layout,
+            VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(args), &args));
+
+    VK_CALL(vkCmdDispatch(vk_cmd,
+            vkd3d_compute_workgroup_count(args.image_extent.width, VKD3D_SWAPCHAIN_COMPUTE_WORKGROUP_SIZE),
+            vkd3d_compute_workgroup_count(args.image_extent.height, VKD3D_SWAPCHAIN_COMPUTE_WORKGROUP_SIZE), 1));
+
+    image_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    image_barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    image_barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    image_barrier.dstAccessMask = VK_ACCESS_2_NONE;
+    image_barrier.oldLayout = image_barrier.newLayout;
+    image_barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VK_CALL(vkCmdPipelineBarrier2(vk_cmd, &dep_info));
+
+    if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEBUG_UTILS) &&
+            chain->queue->device->vk_info.EXT_debug_utils)
+    {
+        VK_CALL(vkCmdEndDebugUtilsLabelEXT(vk_cmd));
+    }
+}
+
+static bool dxgi_vk_swap_chain_can_copy_direct(struct dxgi_vk_swap_chain *chain)
+{
+    struct d3d12_resource *resource = chain->user.backbuffers[chain->request.user_index];
+
+    /* The fullscreen blit is only required to deal with scaling and format conversion.
+     * If the user backbuffer is an exact match for the WSI image, a plain copy is cheaper. */
+    if (!chain->present.backbuffer_supports_transfer_dst)
+        return false;
+    if (vkd3d_atomic_uint32_load_explicit(&resource->initial_layout_transition, vkd3d_memory_order_relaxed))
+        return false;
+
+    return resource->format->vk_format == chain->present.backbuffer_format &&
+            resource->desc.Width == chain->present.backbuffer_width &&
+            resource->desc.Height == chain->present.backbuffer_height;
+}
+
+static void dxgi_vk_swap_chain_record_copy(struct dxgi_vk_swap_chain *chain, VkCommandBuffer vk_cmd, uint32_t swapchain_index)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkImageMemoryBarrier2 image_barriers[2];
+    struct d3d12_resource *resource;
+    VkDependencyInfo dep_info;
+    VkImageCopy2 copy_region;
+    VkCopyImageInfo2 copy_info;
+    unsigned int i;
+
+    resource = chain->user.backbuffers[chain->request.user_index];
+
+    memset(&dep_info, 0, sizeof(dep_info));
+    dep_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dep_info.imageMemoryBarrierCount = ARRAY_SIZE(image_barriers);
+    dep_info.pImageMemoryBarriers = image_barriers;
+
+    memset(image_barriers, 0, sizeof(image_barriers));
+    for (i = 0; i < ARRAY_SIZE(image_barriers); i++)
+    {
+        image_barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        image_barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        image_barriers[i].subresourceRange.levelCount = 1;
+        image_barriers[i].subresourceRange.layerCount = 1;
+    }
+
+    /* srcStage = NONE since we're using fences to acquire WSI. */
+    image_barriers[0].dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    image_barriers[0].dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    image_barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    image_barriers[0].image = chain->present.vk_backbuffer_images[swapchain_index];
+
+    /* The user image lives in its common layout outside of command lists,
+     * same as what the blit path samples from. Rendering is ordered by the present semaphore wait. */
+    image_barriers[1].dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    image_barriers[1].dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+    image_barriers[1].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image_barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    image_barriers[1].image = resource->res.vk_image;
+
+    if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEBUG_UTILS) &&
+            chain->queue->device->vk_info.EXT_debug_utils)
+    {
+        VkDebugUtilsLabelEXT label;
+        label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+        label.pNext = NULL;
+        label.pLabelName = "CopySwapChain";
+        label.color[0] = 1.0f;
+        label.color[1] = 1.0f;
+        label.color[2] = 1.0f;
+        label.color[3] = 1.0f;
+        VK_CALL(vkCmdBeginDebugUtilsLabelEXT(vk_cmd, &label));
+    }
+
+    VK_CALL(vkCmdPipelineBarrier2(vk_cmd, &dep_info));
+
+    memset(&copy_region, 0, sizeof(copy_region));
+    copy_region.sType = VK_STRUCTURE_TYPE_IMAGE_COPY_2;
+    copy_region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy_region.srcSubresource.layerCount = 1;
+    copy_region.dstSubresource = copy_region.srcSubresource;
+    copy_region.extent.width = chain->present.backbuffer_width;
+    copy_region.extent.height = chain->present.backbuffer_height;
+    copy_region.extent.depth = 1;
+
+    memset(&copy_info, 0, sizeof(copy_info));
+    copy_info.sType = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2;
+    copy_info.srcImage = resource->res.vk_image;
+    copy_info.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    copy_info.dstImage = chain->present.vk_backbuffer_images[swapchain_index];
+    copy_info.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    copy_info.regionCount = 1;
+    copy_info.pRegions = &copy_region;
+
+    VK_CALL(vkCmdCopyImage2(vk_cmd, &copy_info));
+
+    image_barriers[0].srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    image_barriers[0].srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    image_barriers[0].dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    image_barriers[0].dstAccessMask = VK_ACCESS_2_NONE;
+    image_barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    image_barriers[0].newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    /* Subsequent command lists on the user queue are ordered by the blit semaphore,
+     * so there is no need for a destination scope here. */
+    image_barriers[1].srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    image_barriers[1].srcAccessMask = VK_ACCESS_2_NONE;
+    image_barriers[1].dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    image_barriers[1].dstAccessMask = VK_ACCESS_2_NONE;
+    image_barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    image_barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VK_CALL(vkCmdPipelineBarrier2(vk_cmd, &dep_info));
+
+    if ((vkd3d_config_flags & VKD3D_CONFIG_FLAG_DEBUG_UTILS) &&
+            chain->queue->device->vk_info.EXT_debug_utils)
+    {
+        VK_CALL(vkCmdEndDebugUtilsLabelEXT(vk_cmd));
+    }
+}
+
 static bool dxgi_vk_swap_chain_submit_blit(struct dxgi_vk_swap_chain *chain, uint32_t swapchain_index)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
     VkDevice vk_device = chain->queue->device->vk_device;
     VkSemaphoreCreateInfo semaphore_create_info;
     VkSemaphoreSubmitInfo signal_semaphore_info;
+    VkSemaphoreSubmitInfo wait_semaphore_info;
     VkCommandBufferAllocateInfo allocate_info;
     VkCommandBufferSubmitInfo cmd_buffer_info;
     VkCommandBufferBeginInfo cmd_begin_info;
     VkFenceCreateInfo fence_create_info;
+    struct vkd3d_queue *vkd3d_queue;
     VkSubmitInfo2 submit_info;
     VkCommandBuffer vk_cmd;
     VkQueue vk_queue;
@@ -1677,7 +2402,12 @@ static bool dxgi_vk_swap_chain_submit_blit(struct dxgi_vk_swap_chain *chain, uin
     cmd_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmd_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     VK_CALL(vkBeginCommandBuffer(vk_cmd, &cmd_begin_info));
-    dxgi_vk_swap_chain_record_render_pass(chain, vk_cmd, swapchain_index);
+    if (chain->present.compute_blit)
+        dxgi_vk_swap_chain_record_compute(chain, vk_cmd, swapchain_index);
+    else if (dxgi_vk_swap_chain_can_copy_direct(chain))
+        dxgi_vk_swap_chain_record_copy(chain, vk_cmd, swapchain_index);
+    else
+        dxgi_vk_swap_chain_record_render_pass(chain, vk_cmd, swapchain_index);
     VK_CALL(vkEndCommandBuffer(vk_cmd));
 
     memset(&signal_semaphore_info, 0, sizeof(signal_semaphore_info));
@@ -1696,9 +2426,24 @@ static bool dxgi_vk_swap_chain_submit_blit(struct dxgi_vk_swap_chain *chain, uin
     submit_info.signalSemaphoreInfoCount = 1;
     submit_info.pSignalSemaphoreInfos = &signal_semaphore_info;
 
-    vk_queue = vkd3d_queue_acquire(chain->queue->vkd3d_queue);
+    vkd3d_queue = dxgi_vk_swap_chain_get_blit_queue(chain);
+
+    if (chain->present.compute_blit)
+    {
+        /* Rendering to the user buffer happened on the application queue. */
+        memset(&wait_semaphore_info, 0, sizeof(wait_semaphore_info));
+        wait_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        wait_semaphore_info.semaphore = chain->async.vk_user_semaphore;
+        wait_semaphore_info.value = chain->async.user_count;
+        wait_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+        submit_info.waitSemaphoreInfoCount = 1;
+        submit_info.pWaitSemaphoreInfos = &wait_semaphore_info;
+    }
+
+    vk_queue = vkd3d_queue_acquire(vkd3d_queue);
     vr = VK_CALL(vkQueueSubmit2(vk_queue, 1, &submit_info, chain->present.vk_blit_fences[swapchain_index]));
-    vkd3d_queue_release(chain->queue->vkd3d_queue);
+    vkd3d_queue_release(vkd3d_queue);
     VKD3D_DEVICE_REPORT_BREADCRUMB_IF(chain->queue->device, vr == VK_ERROR_DEVICE_LOST);
     if (vr < 0)
         ERR("Failed to submit swapchain blit, vr %d.\n", vr);
@@ -1739,9 +2484,13 @@ static VkResult dxgi_vk_swap_chain_try_acquire_next_image(struct dxgi_vk_swap_ch
 static void dxgi_vk_swap_chain_present_iteration(struct dxgi_vk_swap_chain *chain, unsigned int retry_counter)
 {
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    struct d3d12_device *device = chain->queue->device;
+    struct vkd3d_queue *present_queue;
     VkPresentInfoKHR present_info;
+    bool uses_present_wait = false;
     VkPresentIdKHR present_id;
     uint32_t swapchain_index;
+    bool low_latency_markers;
     VkResult vk_result;
     VkQueue vk_queue;
     VkResult vr;
@@ -1795,9 +2544,17 @@ static void dxgi_vk_swap_chain_present_iteration(struct dxgi_vk_swap_chain *chai
      * Non-FIFO swapchains will pump their frame latency handles through the fallback path of blit command being done.
      * Especially on Xwayland, the present ID is updated when images actually hit on-screen due to MAILBOX behavior.
      * This would unnecessarily stall our progress. */
-    if (chain->wait_thread.active && !chain->present.present_id_valid && chain->request.swap_interval > 0)
+    uses_present_wait = chain->wait_thread.active && !chain->present.present_id_valid && chain->request.swap_interval > 0;
+
+    /* Low latency needs every present to carry an ID, which must match the frame ID used for markers. */
+    low_latency_markers = d3d12_device_supports_nv_low_latency(device) && device->low_latency.swapchain == chain;
+
+    if (uses_present_wait || low_latency_markers)
     {
         chain->present.present_id += 1;
+        if (low_latency_markers)
+            chain->present.present_id = max(chain->present.present_id, chain->request.low_latency_frame_id);
+
         present_id.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
         present_id.pNext = NULL;
         present_id.swapchainCount = 1;
@@ -1805,20 +2562,37 @@ static void dxgi_vk_swap_chain_present_iteration(struct dxgi_vk_swap_chain *chai
         present_info.pNext = &present_id;
     }
 
-    vk_queue = vkd3d_queue_acquire(chain->queue->vkd3d_queue);
+    if (low_latency_markers)
+    {
+        pthread_mutex_lock(&device->low_latency.lock);
+        dxgi_vk_swap_chain_low_latency_set_marker(chain, chain->present.present_id, VK_LATENCY_MARKER_PRESENT_START_NV);
+        pthread_mutex_unlock(&device->low_latency.lock);
+    }
+    else
+        vkd3d_low_latency_notify_present(device, chain->request.low_latency_frame_id);
+
+    present_queue = dxgi_vk_swap_chain_get_present_queue(chain);
+    vk_queue = vkd3d_queue_acquire(present_queue);
     VKD3D_REGION_BEGIN(queue_present);
     vr = VK_CALL(vkQueuePresentKHR(vk_queue, &present_info));
     VKD3D_REGION_END(queue_present);
-    vkd3d_queue_release(chain->queue->vkd3d_queue);
+    vkd3d_queue_release(present_queue);
     VKD3D_DEVICE_REPORT_BREADCRUMB_IF(chain->queue->device, vr == VK_ERROR_DEVICE_LOST);
 
+    if (low_latency_markers)
+    {
+        pthread_mutex_lock(&device->low_latency.lock);
+        dxgi_vk_swap_chain_low_latency_set_marker(chain, chain->present.present_id, VK_LATENCY_MARKER_PRESENT_END_NV);
+        pthread_mutex_unlock(&device->low_latency.lock);
+    }
+
     if (vr == VK_SUCCESS && vk_result != VK_SUCCESS)
         vr = vk_result;
 
     if (vr >= 0)
         chain->present.current_backbuffer_index = UINT32_MAX;
 
-    if (present_info.pNext && vr >= 0)
+    if (uses_present_wait && vr >= 0)
         chain->present.present_id_valid = true;
 
     /* Handle any errors and retry as needed. If we cannot make meaningful forward progress, just give up and retry later. */
@@ -1845,7 +2619,8 @@ static void dxgi_vk_swap_chain_signal_waitable_handle(struct dxgi_vk_swap_chain
 
     if (chain->present.present_id_valid)
     {
-        dxgi_vk_swap_chain_push_present_id(chain, chain->present.present_id, chain->request.begin_frame_time_ns);
+        dxgi_vk_swap_chain_push_present_id(chain, chain->present.present_id, chain->request.begin_frame_time_ns,
+                chain->request.frame_index, chain->present.blit_count);
     }
     else
     {
@@ -1884,6 +2659,8 @@ static void dxgi_vk_swap_chain_present_callback(void *chain_)
     uint32_t present_count;
     uint32_t i;
 
+    VKD3D_REGION_DECL(present_iteration);
+
     next_present_count = chain->present.present_count + 1;
     next_request = &chain->request_ring[next_present_count % ARRAY_SIZE(chain->request_ring)];
     if (request_needs_swapchain_recreation(next_request, &chain->request))
@@ -1896,6 +2673,10 @@ static void dxgi_vk_swap_chain_present_callback(void *chain_)
     /* If no QueuePresentKHRs successfully commits a present ID, we'll fallback to a normal queue signal. */
     chain->present.present_id_valid = false;
 
+    /* Compute blits on the async queue must observe all rendering submitted before Present(). */
+    if (chain->async.vkd3d_queue)
+        dxgi_vk_swap_chain_signal_user_semaphore(chain);
+
     /* There is currently no present timing in Vulkan we can rely on, so just duplicate blit them as needed.
      * This happens on a thread, so the blocking should not be a significant problem.
      * TODO: Propose VK_EXT_present_interval. */
@@ -1909,7 +2690,9 @@ static void dxgi_vk_swap_chain_present_callback(void *chain_)
     {
         /* A present iteration may or may not render to backbuffer. We'll apply best effort here.
          * Forward progress must be ensured, so if we cannot get anything on-screen in a reasonable amount of retries, ignore it. */
+        VKD3D_REGION_BEGIN(present_iteration);
         dxgi_vk_swap_chain_present_iteration(chain, 0);
+        VKD3D_REGION_END(present_iteration);
     }
 
     /* When this is signalled, lets main thread know that it's safe to free user buffers.
@@ -1919,6 +2702,10 @@ static void dxgi_vk_swap_chain_present_callback(void *chain_)
     /* Signal latency fence. */
     dxgi_vk_swap_chain_signal_waitable_handle(chain);
 
+    /* Without present wait, the best we can do is to note when the present was queued. */
+    if (!chain->present.present_id_valid)
+        dxgi_vk_swap_chain_complete_frame_timing(chain, chain->request.frame_index, 0, vkd3d_get_current_time_ns());
+
     /* Signal main thread that we are done with all CPU work.
      * No need to signal a condition variable, main thread can poll to deduce. */
     vkd3d_atomic_uint32_store_explicit(&chain->present.present_count, next_present_count, vkd3d_memory_order_release);
@@ -1950,12 +2737,16 @@ static void *dxgi_vk_swap_chain_wait_worker(void *chain_)
     struct dxgi_vk_swap_chain *chain = chain_;
 
     const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    uint64_t gpu_complete_time_ns, present_complete_time_ns;
     uint64_t begin_frame_time_ns = 0;
     uint64_t end_frame_time_ns = 0;
     uint64_t next_wait_id = 0;
+    uint64_t frame_index;
+    uint64_t blit_count;
     int previous_semaphore;
 
     vkd3d_set_thread_name("vkd3d-swapchain-sync");
+    vkd3d_set_thread_role(VKD3D_THREAD_ROLE_SWAPCHAIN);
 
     for (;;)
     {
@@ -1964,15 +2755,24 @@ static void *dxgi_vk_swap_chain_wait_worker(void *chain_)
             pthread_cond_wait(&chain->wait_thread.cond, &chain->wait_thread.lock);
         next_wait_id = chain->wait_thread.wait_queue[0].id;
         begin_frame_time_ns = chain->wait_thread.wait_queue[0].begin_frame_time_ns;
+        frame_index = chain->wait_thread.wait_queue[0].frame_index;
+        blit_count = chain->wait_thread.wait_queue[0].blit_count;
         pthread_mutex_unlock(&chain->wait_thread.lock);
 
         /* Sentinel for swapchain teardown. */
         if (!next_wait_id)
             break;
 
+        /* The blit is the last GPU work of a frame, so this is when the GPU is done with it.
+         * Present can never complete before this, so waiting here adds no latency. */
+        dxgi_vk_swap_chain_drain_blit_semaphore(chain, blit_count);
+        gpu_complete_time_ns = vkd3d_get_current_time_ns();
+
         /* We don't really care if we observed OUT_OF_DATE or something here. */
         VK_CALL(vkWaitForPresentKHR(chain->queue->device->vk_device, chain->present.vk_swapchain,
                 next_wait_id, UINT64_MAX));
+        present_complete_time_ns = vkd3d_get_current_time_ns();
+        dxgi_vk_swap_chain_complete_frame_timing(chain, frame_index, gpu_complete_time_ns, present_complete_time_ns);
 
         if (begin_frame_time_ns)
             end_frame_time_ns = vkd3d_get_current_time_ns();
@@ -2041,16 +2841,153 @@ static HRESULT dxgi_vk_swap_chain_init_waiter_thread(struct dxgi_vk_swap_chain *
     return S_OK;
 }
 
+void dxgi_vk_swap_chain_low_latency_apply_sleep_mode(struct dxgi_vk_swap_chain *chain)
+{
+    const struct vkd3d_low_latency_state *state = &chain->queue->device->low_latency;
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkLatencySleepModeInfoNV sleep_mode_info;
+    VkResult vr;
+
+    if (!chain->present.vk_swapchain)
+        return;
+
+    memset(&sleep_mode_info, 0, sizeof(sleep_mode_info));
+    sleep_mode_info.sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_MODE_INFO_NV;
+    sleep_mode_info.lowLatencyMode = state->mode_enabled;
+    sleep_mode_info.lowLatencyBoost = state->boost;
+    sleep_mode_info.minimumIntervalUs = state->minimum_interval_us;
+
+    if ((vr = VK_CALL(vkSetLatencySleepModeNV(chain->queue->device->vk_device,
+            chain->present.vk_swapchain, &sleep_mode_info))) < 0)
+        ERR("Failed to set latency sleep mode, vr %d.\n", vr);
+}
+
+bool dxgi_vk_swap_chain_low_latency_sleep(struct dxgi_vk_swap_chain *chain, VkSemaphore vk_semaphore, uint64_t value)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkLatencySleepInfoNV sleep_info;
+    VkResult vr;
+
+    /* If there is no swapchain yet, there is nothing to pace against. */
+    if (!chain->present.vk_swapchain)
+        return false;
+
+    memset(&sleep_info, 0, sizeof(sleep_info));
+    sleep_info.sType = VK_STRUCTURE_TYPE_LATENCY_SLEEP_INFO_NV;
+    sleep_info.signalSemaphore = vk_semaphore;
+    sleep_info.value = value;
+
+    if ((vr = VK_CALL(vkLatencySleepNV(chain->queue->device->vk_device, chain->present.vk_swapchain, &sleep_info))) < 0)
+    {
+        ERR("Failed to queue latency sleep, vr %d.\n", vr);
+        return false;
+    }
+
+    return true;
+}
+
+void dxgi_vk_swap_chain_low_latency_set_marker(struct dxgi_vk_swap_chain *chain, uint64_t frame_id, VkLatencyMarkerNV marker)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkSetLatencyMarkerInfoNV marker_info;
+
+    if (!chain->present.vk_swapchain)
+        return;
+
+    memset(&marker_info, 0, sizeof(marker_info));
+    marker_info.sType = VK_STRUCTURE_TYPE_SET_LATENCY_MARKER_INFO_NV;
+    marker_info.presentID = frame_id;
+    marker_info.marker = marker;
+
+    VK_CALL(vkSetLatencyMarkerNV(chain->queue->device->vk_device, chain->present.vk_swapchain, &marker_info));
+}
+
+HRESULT dxgi_vk_swap_chain_low_latency_get_timings(struct dxgi_vk_swap_chain *chain, D3D12_LATENCY_RESULTS *results)
+{
+    const struct vkd3d_vk_device_procs *vk_procs = &chain->queue->device->vk_procs;
+    VkLatencyTimingsFrameReportNV timings[ARRAY_SIZE(results->frame_reports)];
+    VkGetLatencyMarkerInfoNV marker_info;
+    D3D12_FRAME_REPORT *report;
+    uint32_t i;
+
+    if (!chain->present.vk_swapchain)
+        return DXGI_ERROR_INVALID_CALL;
+
+    memset(timings, 0, sizeof(timings));
+    for (i = 0; i < ARRAY_SIZE(timings); i++)
+        timings[i].sType = VK_STRUCTURE_TYPE_LATENCY_TIMINGS_FRAME_REPORT_NV;
+
+    memset(&marker_info, 0, sizeof(marker_info));
+    marker_info.sType = VK_STRUCTURE_TYPE_GET_LATENCY_MARKER_INFO_NV;
+    marker_info.timingCount = ARRAY_SIZE(timings);
+    marker_info.pTimings = timings;
+
+    VK_CALL(vkGetLatencyTimingsNV(chain->queue->device->vk_device, chain->present.vk_swapchain, &marker_info));
+
+    /* Reports are expected oldest first, and we get them in the same order. */
+    for (i = 0; i < marker_info.timingCount; i++)
+    {
+        report = &results->frame_reports[i];
+        report->frameID = timings[i].presentID;
+        report->inputSampleTime = timings[i].inputSampleTimeUs;
+        report->simStartTime = timings[i].simStartTimeUs;
+        report->simEndTime = timings[i].simEndTimeUs;
+        report->renderSubmitStartTime = timings[i].renderSubmitStartTimeUs;
+        report->renderSubmitEndTime = timings[i].renderSubmitEndTimeUs;
+        report->presentStartTime = timings[i].presentStartTimeUs;
+        report->presentEndTime = timings[i].presentEndTimeUs;
+        report->driverStartTime = timings[i].driverStartTimeUs;
+        report->driverEndTime = timings[i].driverEndTimeUs;
+        report->osRenderQueueStartTime = timings[i].osRenderQueueStartTimeUs;
+        report->osRenderQueueEndTime = timings[i].osRenderQueueEndTimeUs;
+        report->gpuRenderStartTime = timings[i].gpuRenderStartTimeUs;
+        report->gpuRenderEndTime = timings[i].gpuRenderEndTimeUs;
+        report->gpuActiveRenderTimeUs = timings[i].gpuRenderEndTimeUs - timings[i].gpuRenderStartTimeUs;
+        report->gpuFrameTimeUs = i ? timings[i].gpuRenderEndTimeUs - timings[i - 1].gpuRenderEndTimeUs : 0;
+    }
+
+    return S_OK;
+}
+
+static void dxgi_vk_swap_chain_init_frame_timing(struct dxgi_vk_swap_chain *chain)
+{
+    char env[VKD3D_PATH_MAX];
+    double frame_rate;
+
+    pthread_mutex_init(&chain->timing.lock, NULL);
+
+    if (vkd3d_get_env_var("VKD3D_SWAPCHAIN_FRAME_RATE", env, sizeof(env)) &&
+            (frame_rate = strtod(env, NULL)) > 0.0)
+    {
+        INFO("Pacing frames to %.3f FPS.\n", frame_rate);
+        chain->timing.target_interval_ns = (uint64_t)(1e9 / frame_rate);
+    }
+
+    if (vkd3d_get_env_var("VKD3D_SWAPCHAIN_TIMING_CSV", env, sizeof(env)))
+    {
+        if ((chain->timing.csv_file = fopen(env, "w")))
+        {
+            INFO("Writing frame timings to %s.\n", env);
+            fprintf(chain->timing.csv_file, "present_count,cpu_submit_ns,gpu_complete_ns,present_complete_ns\n");
+        }
+        else
+            ERR("Failed to open %s for frame timings.\n", env);
+    }
+}
+
 static HRESULT dxgi_vk_swap_chain_init(struct dxgi_vk_swap_chain *chain, IDXGIVkSurfaceFactory *pFactory,
         const DXGI_SWAP_CHAIN_DESC1 *pDesc, struct d3d12_command_queue *queue)
 {
     HRESULT hr;
 
     chain->IDXGIVkSwapChain_iface.lpVtbl = &dxgi_vk_swap_chain_vtbl;
+    chain->IDXGIVkSwapChainFramePacing_iface.lpVtbl = &dxgi_vk_swap_chain_frame_pacing_vtbl;
     chain->refcount = 1;
     chain->queue = queue;
     chain->desc = *pDesc;
 
+    dxgi_vk_swap_chain_init_frame_timing(chain);
+
     INFO("Creating swapchain (%u x %u), BufferCount = %u.\n",
             pDesc->Width, pDesc->Height, pDesc->BufferCount);
 
@@ -2063,9 +3000,13 @@ static HRESULT dxgi_vk_swap_chain_init(struct dxgi_vk_swap_chain *chain, IDXGIVk
     if (FAILED(hr = dxgi_vk_swap_chain_create_surface(chain, pFactory)))
         goto err;
 
+    dxgi_vk_swap_chain_init_async_queue(chain);
+
     if (FAILED(hr = dxgi_vk_swap_chain_init_waiter_thread(chain)))
         goto err;
 
+    vkd3d_low_latency_register_swapchain(queue->device, chain);
+
     ID3D12CommandQueue_AddRef(&queue->ID3D12CommandQueue_iface);
     return S_OK;
 
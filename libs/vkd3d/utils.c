@@ -612,7 +612,7 @@ VkFormat vkd3d_internal_get_vk_format(const struct d3d12_device *device, DXGI_FO
 
 void vkd3d_format_copy_data(const struct vkd3d_format *format, const uint8_t *src,
         unsigned int src_row_pitch, unsigned int src_slice_pitch, uint8_t *dst, unsigned int dst_row_pitch,
-        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d)
+        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d, bool dst_write_combined)
 {
     unsigned int row_block_count, row_count, row_size, slice, row;
     unsigned int slice_count = d;
@@ -629,9 +629,16 @@ void vkd3d_format_copy_data(const struct vkd3d_format *format, const uint8_t *sr
         {
             src_row = &src[slice * src_slice_pitch + row * src_row_pitch];
             dst_row = &dst[slice * dst_slice_pitch + row * dst_row_pitch];
-            memcpy(dst_row, src_row, row_size);
+
+            if (dst_write_combined)
+                vkd3d_memcpy_non_temporal(dst_row, src_row, row_size);
+            else
+                memcpy(dst_row, src_row, row_size);
         }
     }
+
+    if (dst_write_combined)
+        vkd3d_memcpy_non_temporal_barrier();
 }
 
 VkFormat vkd3d_get_vk_format(DXGI_FORMAT format)
@@ -1216,14 +1223,108 @@ static struct vkd3d_private_data *vkd3d_private_store_get_private_data(
     return NULL;
 }
 
+#define VKD3D_PRIVATE_STORE_SLOT_USED (1ull << 32)
+
+/* Slots are accessed with atomics only. On the read side, acquire loads keep the sequence
+ * re-check ordered after the slot contents, and on the write side, release stores keep the
+ * slot contents ordered after the sequence is made odd. */
+static void vkd3d_private_store_slot_read(struct vkd3d_private_store_slot *slot,
+        struct vkd3d_private_store_slot *copy)
+{
+    unsigned int i;
+
+    copy->size = vkd3d_atomic_uint64_load_explicit(&slot->size, vkd3d_memory_order_acquire);
+    for (i = 0; i < ARRAY_SIZE(slot->tag); i++)
+        copy->tag[i] = vkd3d_atomic_uint64_load_explicit(&slot->tag[i], vkd3d_memory_order_acquire);
+    for (i = 0; i < ARRAY_SIZE(slot->data); i++)
+        copy->data[i] = vkd3d_atomic_uint64_load_explicit(&slot->data[i], vkd3d_memory_order_acquire);
+}
+
+static bool vkd3d_private_store_slot_matches(const struct vkd3d_private_store_slot *slot, const uint64_t *tag)
+{
+    return (slot->size & VKD3D_PRIVATE_STORE_SLOT_USED) && slot->tag[0] == tag[0] && slot->tag[1] == tag[1];
+}
+
+static struct vkd3d_private_store_slot *vkd3d_private_store_find_slot_locked(
+        struct vkd3d_private_store *store, const uint64_t *tag, bool allow_free)
+{
+    struct vkd3d_private_store_slot *free_slot = NULL;
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(store->slots); i++)
+    {
+        if (vkd3d_private_store_slot_matches(&store->slots[i], tag))
+            return &store->slots[i];
+        if (!free_slot && !(store->slots[i].size & VKD3D_PRIVATE_STORE_SLOT_USED))
+            free_slot = &store->slots[i];
+    }
+
+    return allow_free ? free_slot : NULL;
+}
+
+static void vkd3d_private_store_write_slot_locked(struct vkd3d_private_store *store,
+        struct vkd3d_private_store_slot *slot, const uint64_t *tag, const void *data, unsigned int data_size)
+{
+    uint64_t words[ARRAY_SIZE(slot->data)];
+    uint32_t sequence;
+    unsigned int i;
+
+    memset(words, 0, sizeof(words));
+    if (data)
+        memcpy(words, data, data_size);
+
+    sequence = vkd3d_atomic_uint32_load_explicit(&store->sequence, vkd3d_memory_order_relaxed);
+    vkd3d_atomic_uint32_store_explicit(&store->sequence, sequence + 1, vkd3d_memory_order_relaxed);
+
+    for (i = 0; i < ARRAY_SIZE(slot->tag); i++)
+        vkd3d_atomic_uint64_store_explicit(&slot->tag[i], tag[i], vkd3d_memory_order_release);
+    for (i = 0; i < ARRAY_SIZE(slot->data); i++)
+        vkd3d_atomic_uint64_store_explicit(&slot->data[i], words[i], vkd3d_memory_order_release);
+    vkd3d_atomic_uint64_store_explicit(&slot->size,
+            data ? VKD3D_PRIVATE_STORE_SLOT_USED | data_size : 0, vkd3d_memory_order_release);
+
+    vkd3d_atomic_uint32_store_explicit(&store->sequence, sequence + 2, vkd3d_memory_order_release);
+}
+
+static bool vkd3d_private_store_get_inline_data(struct vkd3d_private_store *store,
+        const uint64_t *tag, struct vkd3d_private_store_slot *copy)
+{
+    uint32_t sequence;
+    unsigned int i;
+
+    sequence = vkd3d_atomic_uint32_load_explicit(&store->sequence, vkd3d_memory_order_acquire);
+    if (sequence & 1)
+        return false;
+
+    for (i = 0; i < ARRAY_SIZE(store->slots); i++)
+    {
+        vkd3d_private_store_slot_read(&store->slots[i], copy);
+        if (vkd3d_private_store_slot_matches(copy, tag))
+            return vkd3d_atomic_uint32_load_explicit(&store->sequence, vkd3d_memory_order_relaxed) == sequence;
+    }
+
+    /* Not inline, or a writer got in the way. Either way the locked path sorts it out. */
+    return false;
+}
+
 HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *store,
         const GUID *tag, const void *data, unsigned int data_size, bool is_object)
 {
     struct vkd3d_private_data *d, *old_data;
+    struct vkd3d_private_store_slot *slot;
     const void *ptr = data;
+    uint64_t tag_words[2];
+
+    memcpy(tag_words, tag, sizeof(tag_words));
 
     if (!data)
     {
+        if ((slot = vkd3d_private_store_find_slot_locked(store, tag_words, false)))
+        {
+            vkd3d_private_store_write_slot_locked(store, slot, tag_words, NULL, 0);
+            return S_OK;
+        }
+
         if ((d = vkd3d_private_store_get_private_data(store, tag)))
         {
             vkd3d_private_data_destroy(d);
@@ -1240,6 +1341,16 @@ HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *store,
         ptr = &data;
     }
 
+    /* Interfaces need a reference taken under the lock, so they always go to the list. */
+    if (!is_object && data_size <= VKD3D_PRIVATE_STORE_INLINE_DATA_SIZE &&
+            (slot = vkd3d_private_store_find_slot_locked(store, tag_words, true)))
+    {
+        if ((old_data = vkd3d_private_store_get_private_data(store, tag)))
+            vkd3d_private_data_destroy(old_data);
+        vkd3d_private_store_write_slot_locked(store, slot, tag_words, data, data_size);
+        return S_OK;
+    }
+
     if (!(d = vkd3d_malloc(offsetof(struct vkd3d_private_data, data[data_size]))))
         return E_OUTOFMEMORY;
 
@@ -1250,6 +1361,8 @@ HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *store,
     if (is_object)
         IUnknown_AddRef(d->object);
 
+    if ((slot = vkd3d_private_store_find_slot_locked(store, tag_words, false)))
+        vkd3d_private_store_write_slot_locked(store, slot, tag_words, NULL, 0);
     if ((old_data = vkd3d_private_store_get_private_data(store, tag)))
         vkd3d_private_data_destroy(old_data);
     list_add_tail(&store->content, &d->entry);
@@ -1257,19 +1370,50 @@ HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *store,
     return S_OK;
 }
 
+static HRESULT vkd3d_private_store_copy_inline_data(const struct vkd3d_private_store_slot *slot,
+        unsigned int *out_size, void *out)
+{
+    unsigned int data_size = slot->size & ~VKD3D_PRIVATE_STORE_SLOT_USED;
+    unsigned int size = *out_size;
+
+    *out_size = data_size;
+    if (!out)
+        return S_OK;
+
+    if (size < data_size)
+        return DXGI_ERROR_MORE_DATA;
+
+    memcpy(out, slot->data, data_size);
+    return S_OK;
+}
+
 HRESULT vkd3d_get_private_data(struct vkd3d_private_store *store,
         const GUID *tag, unsigned int *out_size, void *out)
 {
+    struct vkd3d_private_store_slot slot_copy;
+    struct vkd3d_private_store_slot *slot;
     const struct vkd3d_private_data *data;
+    uint64_t tag_words[2];
     unsigned int size;
     HRESULT hr;
 
     if (!out_size)
         return E_INVALIDARG;
 
+    memcpy(tag_words, tag, sizeof(tag_words));
+
+    if (vkd3d_private_store_get_inline_data(store, tag_words, &slot_copy))
+        return vkd3d_private_store_copy_inline_data(&slot_copy, out_size, out);
+
     if (FAILED(hr = vkd3d_private_data_lock(store)))
         return hr;
 
+    if ((slot = vkd3d_private_store_find_slot_locked(store, tag_words, false)))
+    {
+        hr = vkd3d_private_store_copy_inline_data(slot, out_size, out);
+        goto done;
+    }
+
     if (!(data = vkd3d_private_store_get_private_data(store, tag)))
     {
         *out_size = 0;
@@ -19,6 +19,25 @@
 #define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
 
 #include "vkd3d_private.h"
+#include "vkd3d_rw_spinlock.h"
+
+/* Root descriptors and raw VA CBVs tend to hit the same few ring buffers over and over,
+ * so remember the last resolved range per thread. Any insert or remove bumps the global
+ * generation, which invalidates the cached range for every thread and every map. */
+struct vkd3d_va_map_thread_cache
+{
+    const struct vkd3d_va_map *va_map;
+    uint64_t generation;
+    struct vkd3d_unique_resource *resource;
+};
+
+static VKD3D_THREAD_LOCAL struct vkd3d_va_map_thread_cache vkd3d_va_map_thread_cache;
+static uint64_t vkd3d_va_map_generation_counter;
+
+static inline void vkd3d_va_map_invalidate_thread_caches(void)
+{
+    vkd3d_atomic_uint64_increment(&vkd3d_va_map_generation_counter, vkd3d_memory_order_release);
+}
 
 static inline VkDeviceAddress vkd3d_va_map_get_next_address(VkDeviceAddress va)
 {
@@ -92,42 +111,33 @@ static void vkd3d_va_map_cleanup_tree(struct vkd3d_va_tree *tree)
     }
 }
 
-static struct vkd3d_unique_resource *vkd3d_va_map_find_small_entry(struct vkd3d_va_map *va_map,
-        VkDeviceAddress va, size_t *index)
+static int vkd3d_va_map_compare_small_entry(const void *key, const struct rb_entry *entry)
 {
-    struct vkd3d_unique_resource *resource = NULL;
-    size_t hi = va_map->small_entries_count;
-    size_t lo = 0;
-
-    while (lo < hi)
-    {
-        struct vkd3d_unique_resource *r;
-        size_t i = lo + (hi - lo) / 2;
+    const struct vkd3d_unique_resource *resource = RB_ENTRY_VALUE(entry, const struct vkd3d_unique_resource, va_entry);
+    VkDeviceAddress va = *(const VkDeviceAddress *)key;
 
-        r = va_map->small_entries[i];
+    if (va < resource->va)
+        return -1;
+    else if (va >= resource->va + resource->size)
+        return 1;
+    else
+        return 0;
+}
 
-        if (va < r->va)
-            hi = i;
-        else if (va >= r->va + r->size)
-            lo = i + 1;
-        else
-        {
-            lo = hi = i;
-            resource = r;
-        }
-    }
+static struct vkd3d_unique_resource *vkd3d_va_map_find_small_entry(struct vkd3d_va_map *va_map, VkDeviceAddress va)
+{
+    struct rb_entry *entry;
 
-    if (index)
-        *index = lo;
+    if (!(entry = rb_get(&va_map->small_entries, &va)))
+        return NULL;
 
-    return resource;
+    return RB_ENTRY_VALUE(entry, struct vkd3d_unique_resource, va_entry);
 }
 
 void vkd3d_va_map_insert(struct vkd3d_va_map *va_map, struct vkd3d_unique_resource *resource)
 {
     VkDeviceAddress block_va, min_va, max_va;
     struct vkd3d_va_block *block;
-    size_t index;
 
     if (resource->size >= VKD3D_VA_BLOCK_SIZE)
     {
@@ -155,74 +165,112 @@ void vkd3d_va_map_insert(struct vkd3d_va_map *va_map, struct vkd3d_unique_resour
     }
     else
     {
-        pthread_mutex_lock(&va_map->mutex);
+        rw_spinlock_acquire_write(&va_map->small_entries_lock);
+        rb_put(&va_map->small_entries, &resource->va, &resource->va_entry);
+        rw_spinlock_release_write(&va_map->small_entries_lock);
+    }
 
-        if (!vkd3d_va_map_find_small_entry(va_map, resource->va, &index))
-        {
-            vkd3d_array_reserve((void**)&va_map->small_entries, &va_map->small_entries_size,
-                    va_map->small_entries_count + 1, sizeof(*va_map->small_entries));
+    vkd3d_va_map_invalidate_thread_caches();
+}
 
-            memmove(&va_map->small_entries[index + 1], &va_map->small_entries[index],
-                    sizeof(*va_map->small_entries) * (va_map->small_entries_count - index));
+static void vkd3d_va_map_remove_blocks(struct vkd3d_va_map *va_map, const struct vkd3d_unique_resource *resource)
+{
+    VkDeviceAddress block_va, min_va, max_va;
+    struct vkd3d_va_block *block;
 
-            va_map->small_entries[index] = resource;
-            va_map->small_entries_count += 1;
+    min_va = resource->va;
+    max_va = resource->va + resource->size;
+    block_va = min_va & ~VKD3D_VA_LO_MASK;
+
+    while (block_va < max_va)
+    {
+        block = vkd3d_va_map_get_block(va_map, block_va);
+
+        if (vkd3d_atomic_ptr_load_explicit(&block->l.resource, vkd3d_memory_order_relaxed) == resource)
+        {
+            vkd3d_atomic_uint64_store_explicit(&block->l.va, 0, vkd3d_memory_order_relaxed);
+            vkd3d_atomic_ptr_store_explicit(&block->l.resource, NULL, vkd3d_memory_order_relaxed);
+        }
+        else if (vkd3d_atomic_ptr_load_explicit(&block->r.resource, vkd3d_memory_order_relaxed) == resource)
+        {
+            vkd3d_atomic_uint64_store_explicit(&block->r.va, 0, vkd3d_memory_order_relaxed);
+            vkd3d_atomic_ptr_store_explicit(&block->r.resource, NULL, vkd3d_memory_order_relaxed);
         }
 
-        pthread_mutex_unlock(&va_map->mutex);
+        block_va += VKD3D_VA_BLOCK_SIZE;
     }
 }
 
-void vkd3d_va_map_remove(struct vkd3d_va_map *va_map, const struct vkd3d_unique_resource *resource)
+static void vkd3d_va_map_remove_small_entry_locked(struct vkd3d_va_map *va_map,
+        const struct vkd3d_unique_resource *resource)
 {
-    VkDeviceAddress block_va, min_va, max_va;
-    struct vkd3d_va_block *block;
-    size_t index;
+    struct vkd3d_unique_resource *small_entry;
+
+    if ((small_entry = vkd3d_va_map_find_small_entry(va_map, resource->va)) == resource)
+        rb_remove(&va_map->small_entries, &small_entry->va_entry);
+}
 
+void vkd3d_va_map_remove(struct vkd3d_va_map *va_map, const struct vkd3d_unique_resource *resource)
+{
     if (resource->size >= VKD3D_VA_BLOCK_SIZE)
     {
-        min_va = resource->va;
-        max_va = resource->va + resource->size;
-        block_va = min_va & ~VKD3D_VA_LO_MASK;
+        vkd3d_va_map_remove_blocks(va_map, resource);
+    }
+    else
+    {
+        rw_spinlock_acquire_write(&va_map->small_entries_lock);
+        vkd3d_va_map_remove_small_entry_locked(va_map, resource);
+        rw_spinlock_release_write(&va_map->small_entries_lock);
+    }
 
-        while (block_va < max_va)
-        {
-            block = vkd3d_va_map_get_block(va_map, block_va);
+    vkd3d_va_map_invalidate_thread_caches();
+}
 
-            if (vkd3d_atomic_ptr_load_explicit(&block->l.resource, vkd3d_memory_order_relaxed) == resource)
-            {
-                vkd3d_atomic_uint64_store_explicit(&block->l.va, 0, vkd3d_memory_order_relaxed);
-                vkd3d_atomic_ptr_store_explicit(&block->l.resource, NULL, vkd3d_memory_order_relaxed);
-            }
-            else if (vkd3d_atomic_ptr_load_explicit(&block->r.resource, vkd3d_memory_order_relaxed) == resource)
-            {
-                vkd3d_atomic_uint64_store_explicit(&block->r.va, 0, vkd3d_memory_order_relaxed);
-                vkd3d_atomic_ptr_store_explicit(&block->r.resource, NULL, vkd3d_memory_order_relaxed);
-            }
+/* Same as vkd3d_va_map_remove for every resource, but takes the small entry lock only once. */
+void vkd3d_va_map_remove_batch(struct vkd3d_va_map *va_map,
+        const struct vkd3d_unique_resource * const *resources, size_t count)
+{
+    bool has_small_entries = false;
+    size_t i;
 
-            block_va += VKD3D_VA_BLOCK_SIZE;
-        }
-    }
-    else
+    for (i = 0; i < count; i++)
     {
-        pthread_mutex_lock(&va_map->mutex);
+        if (resources[i]->size >= VKD3D_VA_BLOCK_SIZE)
+            vkd3d_va_map_remove_blocks(va_map, resources[i]);
+        else
+            has_small_entries = true;
+    }
 
-        if (vkd3d_va_map_find_small_entry(va_map, resource->va, &index) == resource)
-        {
-            va_map->small_entries_count -= 1;
+    vkd3d_va_map_invalidate_thread_caches();
 
-            memmove(&va_map->small_entries[index], &va_map->small_entries[index + 1],
-                    sizeof(*va_map->small_entries) * (va_map->small_entries_count - index));
-        }
+    if (!has_small_entries)
+        return;
 
-        pthread_mutex_unlock(&va_map->mutex);
+    rw_spinlock_acquire_write(&va_map->small_entries_lock);
+    for (i = 0; i < count; i++)
+    {
+        if (resources[i]->size < VKD3D_VA_BLOCK_SIZE)
+            vkd3d_va_map_remove_small_entry_locked(va_map, resources[i]);
     }
+    rw_spinlock_release_write(&va_map->small_entries_lock);
 }
 
 static struct vkd3d_unique_resource *vkd3d_va_map_deref_mutable(struct vkd3d_va_map *va_map, VkDeviceAddress va)
 {
-    struct vkd3d_va_block *block = vkd3d_va_map_find_block(va_map, va);
+    struct vkd3d_va_map_thread_cache *cache = &vkd3d_va_map_thread_cache;
     struct vkd3d_unique_resource *resource = NULL;
+    struct vkd3d_va_block *block;
+    uint64_t generation;
+
+    /* Sample the generation before the lookup, so that a concurrent insert or remove
+     * can only cause the next lookup to miss, never to return a stale range. */
+    generation = vkd3d_atomic_uint64_load_explicit(&vkd3d_va_map_generation_counter, vkd3d_memory_order_acquire);
+
+    if (cache->resource && cache->va_map == va_map && cache->generation == generation &&
+            va >= cache->resource->va && va < cache->resource->va + cache->resource->size)
+        return cache->resource;
+
+    block = vkd3d_va_map_find_block(va_map, va);
 
     if (block)
     {
@@ -234,9 +282,16 @@ static struct vkd3d_unique_resource *vkd3d_va_map_deref_mutable(struct vkd3d_va_
 
     if (!resource)
     {
-        pthread_mutex_lock(&va_map->mutex);
-        resource = vkd3d_va_map_find_small_entry(va_map, va, NULL);
-        pthread_mutex_unlock(&va_map->mutex);
+        rw_spinlock_acquire_read(&va_map->small_entries_lock);
+        resource = vkd3d_va_map_find_small_entry(va_map, va);
+        rw_spinlock_release_read(&va_map->small_entries_lock);
+    }
+
+    if (resource)
+    {
+        cache->va_map = va_map;
+        cache->generation = generation;
+        cache->resource = resource;
     }
 
     return resource;
@@ -303,13 +358,14 @@ VkAccelerationStructureKHR vkd3d_va_map_place_acceleration_structure(struct vkd3
 void vkd3d_va_map_init(struct vkd3d_va_map *va_map)
 {
     memset(va_map, 0, sizeof(*va_map));
-    pthread_mutex_init(&va_map->mutex, NULL);
+    spinlock_init(&va_map->small_entries_lock);
+    rb_init(&va_map->small_entries, vkd3d_va_map_compare_small_entry);
 }
 
 void vkd3d_va_map_cleanup(struct vkd3d_va_map *va_map)
 {
+    /* A new map may be allocated at the same address. */
+    vkd3d_va_map_invalidate_thread_caches();
     vkd3d_va_map_cleanup_tree(&va_map->va_tree);
-    pthread_mutex_destroy(&va_map->mutex);
-    vkd3d_free(va_map->small_entries);
 }
 
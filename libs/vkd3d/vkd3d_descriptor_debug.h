@@ -44,6 +44,7 @@ const VkDescriptorBufferInfo *vkd3d_descriptor_debug_get_global_info_descriptor(
 void vkd3d_descriptor_debug_init(void);
 bool vkd3d_descriptor_debug_active_log(void);
 bool vkd3d_descriptor_debug_active_qa_checks(void);
+bool vkd3d_descriptor_debug_qa_check_shader(uint64_t shader_hash);
 
 void vkd3d_descriptor_debug_register_heap(
         struct vkd3d_descriptor_qa_heap_buffer_data *heap, uint64_t cookie,
@@ -80,6 +81,7 @@ VkDeviceSize vkd3d_descriptor_debug_heap_info_size(unsigned int num_descriptors)
 #define vkd3d_descriptor_debug_init() ((void)0)
 #define vkd3d_descriptor_debug_active_log() ((void)0)
 #define vkd3d_descriptor_debug_active_qa_checks() (false)
+#define vkd3d_descriptor_debug_qa_check_shader(shader_hash) (false)
 #define vkd3d_descriptor_debug_register_heap(heap, cookie, desc) ((void)0)
 #define vkd3d_descriptor_debug_unregister_heap(cookie) ((void)0)
 #define vkd3d_descriptor_debug_register_resource_cookie(global_info, cookie, desc) ((void)0)
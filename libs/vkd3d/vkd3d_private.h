@@ -34,6 +34,7 @@
 #include "vkd3d_version.h"
 #include "vkd3d_shader.h"
 #include "vkd3d_threads.h"
+#include "vkd3d_job_pool.h"
 #include "vkd3d_platform.h"
 #include "vkd3d_swapchain_factory.h"
 #include "vkd3d_command_list_vkd3d_ext.h"
@@ -123,6 +124,7 @@ struct vkd3d_vulkan_info
     bool KHR_external_semaphore_win32;
     bool KHR_present_wait;
     bool KHR_present_id;
+    bool KHR_maintenance5;
     /* EXT device extensions */
     bool EXT_calibrated_timestamps;
     bool EXT_conditional_rendering;
@@ -148,11 +150,14 @@ struct vkd3d_vulkan_info
     bool EXT_fragment_shader_interlock;
     bool EXT_pageable_device_local_memory;
     bool EXT_memory_priority;
+    bool EXT_memory_budget;
+    bool EXT_device_generated_commands;
     /* AMD device extensions */
     bool AMD_buffer_marker;
     bool AMD_device_coherent_memory;
     bool AMD_shader_core_properties;
     bool AMD_shader_core_properties2;
+    bool AMD_anti_lag;
     /* NV device extensions */
     bool NV_shader_sm_builtins;
     bool NVX_binary_import;
@@ -161,6 +166,7 @@ struct vkd3d_vulkan_info
     bool NV_compute_shader_derivatives;
     bool NV_device_diagnostic_checkpoints;
     bool NV_device_generated_commands;
+    bool NV_low_latency2;
     /* VALVE extensions */
     bool VALVE_mutable_descriptor_type;
     bool VALVE_descriptor_set_host_mapping;
@@ -195,6 +201,16 @@ struct vkd3d_instance
 extern uint64_t vkd3d_config_flags;
 extern struct vkd3d_shader_quirk_info vkd3d_shader_quirk_info;
 
+enum vkd3d_thread_role
+{
+    VKD3D_THREAD_ROLE_SUBMISSION,
+    VKD3D_THREAD_ROLE_FENCE,
+    VKD3D_THREAD_ROLE_SWAPCHAIN,
+};
+
+/* Applies the scheduling policy for a latency critical internal thread, call on the thread itself. */
+void vkd3d_set_thread_role(enum vkd3d_thread_role role);
+
 struct vkd3d_waiting_fence
 {
     d3d12_fence_iface *fence;
@@ -216,6 +232,12 @@ struct vkd3d_fence_worker
     struct vkd3d_waiting_fence *enqueued_fences;
     size_t enqueued_fences_size;
 
+    /* Scratch arrays for VKD3D_CONFIG_FLAG_FENCE_WORKER_WAIT_ANY. Only accessed by the worker thread. */
+    VkSemaphore *wait_semaphores;
+    size_t wait_semaphores_size;
+    uint64_t *wait_values;
+    size_t wait_values_size;
+
     struct d3d12_device *device;
 };
 
@@ -224,6 +246,32 @@ HRESULT vkd3d_fence_worker_start(struct vkd3d_fence_worker *worker,
 HRESULT vkd3d_fence_worker_stop(struct vkd3d_fence_worker *worker,
         struct d3d12_device *device);
 
+/* Multiplexes waits for all shared fences with pending events on a single thread. */
+struct vkd3d_shared_fence_worker
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool should_exit;
+    bool is_running;
+
+    struct list fences;
+
+    /* Scratch arrays, only accessed by the worker thread. */
+    struct d3d12_shared_fence **wait_fences;
+    size_t wait_fences_size;
+    VkSemaphore *wait_semaphores;
+    size_t wait_semaphores_size;
+    uint64_t *wait_values;
+    size_t wait_values_size;
+
+    struct d3d12_device *device;
+};
+
+HRESULT vkd3d_shared_fence_worker_init(struct vkd3d_shared_fence_worker *worker,
+        struct d3d12_device *device);
+void vkd3d_shared_fence_worker_cleanup(struct vkd3d_shared_fence_worker *worker);
+
 /* 2 MiB is a good threshold, because it's huge page size. */
 #define VKD3D_VA_BLOCK_SIZE_BITS (21)
 #define VKD3D_VA_BLOCK_SIZE (1ull << VKD3D_VA_BLOCK_SIZE_BITS)
@@ -267,15 +315,16 @@ struct vkd3d_va_map
 {
     struct vkd3d_va_tree va_tree;
 
-    pthread_mutex_t mutex;
-
-    struct vkd3d_unique_resource **small_entries;
-    size_t small_entries_size;
-    size_t small_entries_count;
+    /* Resources smaller than VKD3D_VA_BLOCK_SIZE, keyed by VA range.
+     * Lookups only take the lock for reading, so they do not contend with each other. */
+    spinlock_t small_entries_lock;
+    struct rb_tree small_entries;
 };
 
 void vkd3d_va_map_insert(struct vkd3d_va_map *va_map, struct vkd3d_unique_resource *resource);
 void vkd3d_va_map_remove(struct vkd3d_va_map *va_map, const struct vkd3d_unique_resource *resource);
+void vkd3d_va_map_remove_batch(struct vkd3d_va_map *va_map,
+        const struct vkd3d_unique_resource * const *resources, size_t count);
 const struct vkd3d_unique_resource *vkd3d_va_map_deref(struct vkd3d_va_map *va_map, VkDeviceAddress va);
 VkAccelerationStructureKHR vkd3d_va_map_place_acceleration_structure(struct vkd3d_va_map *va_map,
         struct d3d12_device *device,
@@ -296,9 +345,25 @@ struct vkd3d_gpu_va_slab
     void *ptr;
 };
 
+/* The first few small entries which are not interfaces live inline in the store, and lookups read them
+ * without the mutex, since some applications and middleware query private data on every bind.
+ * Writers hold the mutex and keep the sequence odd while they modify slots. */
+#define VKD3D_PRIVATE_STORE_INLINE_SLOT_COUNT 2
+#define VKD3D_PRIVATE_STORE_INLINE_DATA_SIZE 16
+
+struct vkd3d_private_store_slot
+{
+    uint64_t tag[2];
+    /* Data size, and VKD3D_PRIVATE_STORE_SLOT_USED if the slot holds an entry. */
+    uint64_t size;
+    uint64_t data[VKD3D_PRIVATE_STORE_INLINE_DATA_SIZE / sizeof(uint64_t)];
+};
+
 struct vkd3d_private_store
 {
     pthread_mutex_t mutex;
+    uint32_t sequence;
+    struct vkd3d_private_store_slot slots[VKD3D_PRIVATE_STORE_INLINE_SLOT_COUNT];
 
     struct list content;
 };
@@ -330,6 +395,8 @@ static inline HRESULT vkd3d_private_store_init(struct vkd3d_private_store *store
     int rc;
 
     list_init(&store->content);
+    memset(store->slots, 0, sizeof(store->slots));
+    store->sequence = 0;
 
     if ((rc = pthread_mutex_init(&store->mutex, NULL)))
         ERR("Failed to initialize mutex, error %d.\n", rc);
@@ -374,8 +441,10 @@ HRESULT vkd3d_private_store_set_private_data(struct vkd3d_private_store *store,
 
 typedef void(*vkd3d_set_name_callback)(void *, const char *);
 
+/* Wide names which fit in name_buffer are converted in place, so that the
+ * common case of short names does not hit the heap. */
 static inline bool vkd3d_private_data_object_name_ptr(REFGUID guid,
-    UINT data_size, const void *data, const char **out_name)
+    UINT data_size, const void *data, char *name_buffer, size_t name_buffer_size, const char **out_name)
 {
     if (out_name)
         *out_name = NULL;
@@ -409,7 +478,7 @@ static inline bool vkd3d_private_data_object_name_ptr(REFGUID guid,
             return true;
 
         if (out_name)
-            *out_name = vkd3d_strdup_w_utf8(name, data_size / sizeof(WCHAR));
+            *out_name = vkd3d_strdup_w_utf8_buffer(name, data_size / sizeof(WCHAR), name_buffer, name_buffer_size);
         return true;
     }
 
@@ -420,6 +489,7 @@ static inline HRESULT vkd3d_set_private_data(struct vkd3d_private_store *store,
         const GUID *tag, unsigned int data_size, const void *data,
         vkd3d_set_name_callback set_name_callback, void *calling_object)
 {
+    char name_buffer[256];
     const char *name;
     HRESULT hr;
 
@@ -432,10 +502,11 @@ static inline HRESULT vkd3d_set_private_data(struct vkd3d_private_store *store,
         return hr;
     }
 
-    if (set_name_callback && vkd3d_private_data_object_name_ptr(tag, data_size, data, &name))
+    if (set_name_callback && vkd3d_private_data_object_name_ptr(tag, data_size, data,
+            name_buffer, sizeof(name_buffer), &name))
     {
         set_name_callback(calling_object, name);
-        if (name && name != data)
+        if (name && name != data && name != name_buffer)
             vkd3d_free((void *)name);
     }
 
@@ -459,7 +530,7 @@ static inline HRESULT vkd3d_set_private_data_interface(struct vkd3d_private_stor
         return hr;
     }
 
-    if (set_name_callback && vkd3d_private_data_object_name_ptr(tag, 0, NULL, NULL))
+    if (set_name_callback && vkd3d_private_data_object_name_ptr(tag, 0, NULL, NULL, 0, NULL))
         set_name_callback(calling_object, NULL);
 
     vkd3d_private_data_unlock(store);
@@ -506,6 +577,8 @@ struct d3d12_fence
 
     uint64_t max_pending_virtual_timeline_value;
     uint64_t virtual_value;
+    /* Mirrors virtual_value for lock-free reads. Only written with the fence lock held. */
+    uint64_t completed_value;
     uint64_t physical_value;
     uint64_t counter;
     struct d3d12_fence_value *pending_updates;
@@ -562,13 +635,13 @@ struct d3d12_shared_fence
 
     VkSemaphore timeline_semaphore;
 
-    pthread_t thread;
     pthread_mutex_t mutex;
-    pthread_cond_t cond_var;
-    uint32_t is_running;
-
     struct list events;
 
+    /* Owned by the device's shared fence worker, protected by its mutex. */
+    struct list worker_entry;
+    bool is_queued;
+
     struct d3d12_device *device;
 
     struct vkd3d_private_store private_store;
@@ -620,6 +693,9 @@ enum vkd3d_allocation_flag
      * They are never suballocated since we do that ourselves,
      * and we do not consume space in the VA map. */
     VKD3D_ALLOCATION_FLAG_INTERNAL_SCRATCH  = (1u << 6),
+    /* DEFAULT heap allocation which must land in HOST_VISIBLE | DEVICE_LOCAL memory,
+     * so that it is mapped and can be cleared on the CPU. Never falls back to system memory. */
+    VKD3D_ALLOCATION_FLAG_HOST_VISIBLE_VRAM = (1u << 7),
 };
 
 #define VKD3D_MEMORY_CHUNK_SIZE (VKD3D_VA_BLOCK_SIZE * 8)
@@ -675,6 +751,9 @@ struct vkd3d_unique_resource
     /* This is used to handle views when we cannot bind it to a
      * specific ID3D12Resource, i.e. RTAS. Only allocated as needed. */
     struct vkd3d_view_map *view_map;
+
+    /* Only meaningful for the instance inserted into the VA map as a small entry. */
+    struct rb_entry va_entry;
 };
 
 struct vkd3d_device_memory_allocation
@@ -715,6 +794,16 @@ static inline void vkd3d_memory_allocation_slice(struct vkd3d_memory_allocation
 
 struct vkd3d_memory_free_range
 {
+    union
+    {
+        struct
+        {
+            struct rb_entry offset_entry;
+            struct rb_entry size_entry;
+        };
+        /* Only used while the range is recycled. */
+        struct list spare_entry;
+    };
     VkDeviceSize offset;
     VkDeviceSize length;
 };
@@ -722,17 +811,27 @@ struct vkd3d_memory_free_range
 struct vkd3d_memory_chunk
 {
     struct vkd3d_memory_allocation allocation;
-    struct vkd3d_memory_free_range *free_ranges;
-    size_t free_ranges_size;
+
+    /* Free ranges are tracked by offset, so that neighbours can be merged on free,
+     * and by (length, offset), so that best-fit allocation is O(log n). */
+    struct rb_tree free_ranges_by_offset;
+    struct rb_tree free_ranges_by_size;
+    struct list spare_ranges;
     size_t free_ranges_count;
+    VkDeviceSize free_size;
+
+    struct vkd3d_memory_allocator_shard *shard;
 };
 
 #define VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT (16u)
+/* The command buffer ring grows on demand when bursts of clears keep every command buffer in flight. */
+#define VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_MAX_COUNT (256u)
 
 enum vkd3d_memory_transfer_op
 {
     VKD3D_MEMORY_TRANSFER_OP_CLEAR_ALLOCATION,
     VKD3D_MEMORY_TRANSFER_OP_WRITE_SUBRESOURCE,
+    VKD3D_MEMORY_TRANSFER_OP_INITIAL_TRANSITION,
 };
 
 struct vkd3d_memory_transfer_info
@@ -746,6 +845,19 @@ struct vkd3d_memory_transfer_info
     VkExtent3D extent;
 };
 
+struct vkd3d_memory_transfer_command_buffer
+{
+    VkCommandBuffer vk_command_buffer;
+    UINT64 signal_value; /* Signaled when the last submission of this command buffer completes. */
+};
+
+struct vkd3d_memory_transfer_clear_range
+{
+    VkBuffer vk_buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+
 struct vkd3d_memory_transfer_tracked_resource
 {
     struct d3d12_resource *resource;
@@ -761,7 +873,10 @@ struct vkd3d_memory_transfer_queue
     pthread_cond_t cond;
     pthread_t thread;
 
-    VkCommandBuffer vk_command_buffers[VKD3D_MEMORY_TRANSFER_COMMAND_BUFFER_COUNT];
+    /* Ring of command buffers in submission order, command_buffer_index is the oldest one. */
+    struct vkd3d_memory_transfer_command_buffer *command_buffers;
+    size_t command_buffers_size;
+    size_t command_buffer_count;
     VkCommandPool vk_command_pool;
     VkSemaphore vk_semaphore;
 
@@ -769,12 +884,18 @@ struct vkd3d_memory_transfer_queue
     UINT64 next_signal_value;
 
     VkDeviceSize num_bytes_pending;
-    uint32_t command_buffer_index;
+    size_t command_buffer_index;
 
     struct vkd3d_memory_transfer_info *transfers;
     size_t transfer_size;
     size_t transfer_count;
 
+    struct vkd3d_memory_transfer_clear_range *clear_ranges;
+    size_t clear_ranges_size;
+
+    VkImageMemoryBarrier2 *image_barriers;
+    size_t image_barriers_size;
+
     struct vkd3d_memory_transfer_tracked_resource *tracked_resources;
     size_t tracked_resource_size;
     size_t tracked_resource_count;
@@ -783,28 +904,67 @@ struct vkd3d_memory_transfer_queue
 void vkd3d_memory_transfer_queue_cleanup(struct vkd3d_memory_transfer_queue *queue);
 HRESULT vkd3d_memory_transfer_queue_init(struct vkd3d_memory_transfer_queue *queue, struct d3d12_device *device);
 HRESULT vkd3d_memory_transfer_queue_flush(struct vkd3d_memory_transfer_queue *queue);
+bool vkd3d_memory_transfer_queue_cancel_clear(struct vkd3d_memory_transfer_queue *queue,
+        struct vkd3d_memory_allocation *allocation);
+void vkd3d_memory_transfer_queue_reclear_allocation(struct vkd3d_memory_transfer_queue *queue,
+        struct vkd3d_memory_allocation *allocation);
 HRESULT vkd3d_memory_transfer_queue_write_subresource(struct vkd3d_memory_transfer_queue *queue,
         struct d3d12_resource *resource, uint32_t subresource_idx, VkOffset3D offset, VkExtent3D extent);
+void vkd3d_memory_transfer_queue_initial_transition(struct vkd3d_memory_transfer_queue *queue,
+        struct d3d12_resource *resource);
+void vkd3d_memory_transfer_queue_cancel_initial_transition(struct vkd3d_memory_transfer_queue *queue,
+        struct d3d12_resource *resource);
 
-struct vkd3d_memory_allocator
+#define VKD3D_MEMORY_ALLOCATOR_HEAP_TYPE_COUNT 4
+#define VKD3D_MEMORY_ALLOCATOR_SIZE_CLASS_COUNT 2
+#define VKD3D_MEMORY_ALLOCATOR_SMALL_ALLOCATION_SIZE (256 * 1024)
+
+struct vkd3d_memory_allocator_shard
 {
     pthread_mutex_t mutex;
 
     struct vkd3d_memory_chunk **chunks;
     size_t chunks_size;
     size_t chunks_count;
+};
+
+struct vkd3d_memory_allocator
+{
+    /* Sub-allocation is sharded by heap type and size class,
+     * each shard has its own lock and chunk list. */
+    struct vkd3d_memory_allocator_shard shards[VKD3D_MEMORY_ALLOCATOR_HEAP_TYPE_COUNT * VKD3D_MEMORY_ALLOCATOR_SIZE_CLASS_COUNT];
 
     struct vkd3d_va_map va_map;
 };
 
+struct vkd3d_memory_allocator_stats
+{
+    size_t chunk_count;
+    VkDeviceSize total_size;
+    VkDeviceSize free_size;
+    size_t free_range_count;
+    VkDeviceSize largest_free_range;
+};
+
+void vkd3d_memory_allocator_get_stats(struct vkd3d_memory_allocator *allocator,
+        struct vkd3d_memory_allocator_stats *stats);
+
 void vkd3d_free_memory(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
         const struct vkd3d_memory_allocation *allocation);
+void vkd3d_free_memory_batch(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
+        const struct vkd3d_memory_allocation * const *allocations, size_t count);
+bool vkd3d_memory_allocation_is_write_combined(struct d3d12_device *device,
+        const struct vkd3d_memory_allocation *allocation);
 HRESULT vkd3d_allocate_memory(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
         const struct vkd3d_allocate_memory_info *info, struct vkd3d_memory_allocation *allocation);
 bool vkd3d_allocate_image_memory_prefers_dedicated(struct d3d12_device *device,
         D3D12_HEAP_FLAGS heap_flags, const VkMemoryRequirements *requirements);
 HRESULT vkd3d_allocate_heap_memory(struct d3d12_device *device, struct vkd3d_memory_allocator *allocator,
         const struct vkd3d_allocate_heap_memory_info *info, struct vkd3d_memory_allocation *allocation);
+/* Page offsets are relative to the allocation's CPU address. */
+HRESULT vkd3d_memory_allocation_get_write_watch(const struct vkd3d_memory_allocation *allocation,
+        bool reset, VkDeviceSize offset, VkDeviceSize size,
+        uint64_t *page_offsets, size_t *page_count, uint32_t *page_size);
 
 HRESULT vkd3d_memory_allocator_init(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device);
 void vkd3d_memory_allocator_cleanup(struct vkd3d_memory_allocator *allocator, struct d3d12_device *device);
@@ -820,6 +980,13 @@ typedef struct
 
     D3D12_RESIDENCY_PRIORITY d3d12priority;
     LONG residency_count;
+    bool demoted; /* Priority was lowered by the residency manager under memory pressure. */
+
+    /* Only used when automatic residency demotion is enabled, protected by the residency manager lock. */
+    struct list entry;
+    const struct vkd3d_device_memory_allocation *allocation;
+    bool tracked;
+    uint64_t last_use_frame;
 } priority_info;
 
 struct d3d12_heap
@@ -833,12 +1000,22 @@ struct d3d12_heap
 
     priority_info priority;
 
+    /* Placed resources ordered by heap offset, to answer aliasing queries exactly. */
+    spinlock_t placed_resources_lock;
+    struct rb_tree placed_resources;
+    VkDeviceSize placed_resource_max_size;
+    /* Set once any reserved resource maps tiles to this heap, which the index cannot see. */
+    uint32_t has_tile_mappings;
+
     struct d3d12_device *device;
     struct vkd3d_private_store private_store;
 };
 
 HRESULT d3d12_heap_create(struct d3d12_device *device, const D3D12_HEAP_DESC *desc,
         void *host_address, struct d3d12_heap **heap);
+void d3d12_heap_register_placed_resource(struct d3d12_heap *heap, struct d3d12_resource *resource,
+        VkDeviceSize offset, VkDeviceSize size);
+void d3d12_heap_unregister_placed_resource(struct d3d12_heap *heap, struct d3d12_resource *resource);
 HRESULT d3d12_device_validate_custom_heap_type(struct d3d12_device *device,
         const D3D12_HEAP_PROPERTIES *heap_properties);
 
@@ -869,6 +1046,8 @@ enum vkd3d_resource_flag
     VKD3D_RESOURCE_EXTERNAL               = (1u << 5),
     VKD3D_RESOURCE_ACCELERATION_STRUCTURE = (1u << 6),
     VKD3D_RESOURCE_SIMULTANEOUS_ACCESS    = (1u << 7),
+    /* Memory may still be pending in the device memory bind queue. */
+    VKD3D_RESOURCE_DEFERRED_BIND          = (1u << 8),
 };
 
 struct d3d12_sparse_image_region
@@ -892,6 +1071,13 @@ struct d3d12_sparse_tile
         struct d3d12_sparse_image_region image;
         struct d3d12_sparse_buffer_region buffer;
     };
+};
+
+/* Range of tiles mapped to contiguous memory, or unmapped if vk_memory is null. */
+struct d3d12_sparse_tile_run
+{
+    uint32_t tile_index;
+    uint32_t tile_count;
     VkDeviceMemory vk_memory;
     VkDeviceSize vk_offset;
 };
@@ -901,6 +1087,10 @@ struct d3d12_sparse_info
     uint32_t tile_count;
     uint32_t tiling_count;
     struct d3d12_sparse_tile *tiles;
+    /* Sorted, non-overlapping runs covering all tiles. Only accessed from the submission thread. */
+    struct d3d12_sparse_tile_run *runs;
+    size_t runs_size;
+    size_t run_count;
     D3D12_TILE_SHAPE tile_shape;
     D3D12_PACKED_MIP_INFO packed_mips;
     D3D12_SUBRESOURCE_TILING *tilings;
@@ -911,6 +1101,8 @@ struct vkd3d_view_map
 {
     spinlock_t spinlock;
     struct hash_map map;
+    /* Unique per initialized map, tags entries of the per-thread lookup cache. */
+    uint64_t epoch;
 #ifdef VKD3D_ENABLE_DESCRIPTOR_QA
     uint64_t resource_cookie;
 #endif
@@ -943,6 +1135,15 @@ struct d3d12_resource
     struct vkd3d_unique_resource res;
 
     struct d3d12_heap *heap;
+    struct
+    {
+        struct rb_entry entry;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        /* Number of other placed resources overlapping this one. Protected by the heap lock. */
+        uint32_t alias_count;
+        bool registered;
+    } heap_range;
 
     uint32_t flags;
 
@@ -953,6 +1154,18 @@ struct d3d12_resource
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     bool initial_layout_transition_validate_only;
 #endif
+    /* Set when the initial transition was handed to the memory transfer queue,
+     * the semaphore value is that of the submission which recorded it, if any.
+     * Both are protected by the transfer queue mutex. */
+    bool initial_transition_queued;
+    uint64_t initial_transition_semaphore_value;
+    /* Set while the zero-clear of a committed texture is still queued and
+     * may be dropped if the first GPU use overwrites the entire resource. */
+    uint32_t lazy_clear;
+
+    /* Bumped when the buffer may have been rewritten for use as indirect arguments.
+     * Only maintained with VKD3D_CONFIG_FLAG_EXECUTE_INDIRECT_CACHE. */
+    uint32_t indirect_generation;
 
     struct d3d12_sparse_info sparse;
     struct vkd3d_view_map view_map;
@@ -974,6 +1187,13 @@ static inline bool d3d12_resource_is_buffer(const struct d3d12_resource *resourc
     return resource->desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER;
 }
 
+static inline void d3d12_resource_invalidate_indirect_cache(struct d3d12_resource *resource)
+{
+    if (resource && (vkd3d_config_flags & VKD3D_CONFIG_FLAG_EXECUTE_INDIRECT_CACHE) &&
+            d3d12_resource_is_buffer(resource))
+        vkd3d_atomic_uint32_increment(&resource->indirect_generation, vkd3d_memory_order_relaxed);
+}
+
 static inline bool d3d12_resource_is_acceleration_structure(const struct d3d12_resource *resource)
 {
     return !!(resource->flags & VKD3D_RESOURCE_ACCELERATION_STRUCTURE);
@@ -998,6 +1218,11 @@ LONG64 vkd3d_allocate_cookie();
 bool d3d12_resource_is_cpu_accessible(const struct d3d12_resource *resource);
 void d3d12_resource_promote_desc(const D3D12_RESOURCE_DESC *desc, D3D12_RESOURCE_DESC1 *desc1);
 HRESULT d3d12_resource_validate_desc(const D3D12_RESOURCE_DESC1 *desc, struct d3d12_device *device);
+
+const struct d3d12_sparse_tile_run *d3d12_sparse_info_find_run(const struct d3d12_sparse_info *sparse,
+        uint32_t tile_index);
+bool d3d12_sparse_info_map_tiles(struct d3d12_sparse_info *sparse, uint32_t tile_index,
+        uint32_t tile_count, VkDeviceMemory vk_memory, VkDeviceSize vk_offset);
 VkImageSubresource d3d12_resource_get_vk_subresource(const struct d3d12_resource *resource,
         uint32_t subresource_idx, bool all_aspects);
 VkImageAspectFlags vk_image_aspect_flags_from_d3d12(
@@ -1016,10 +1241,93 @@ HRESULT d3d12_resource_create_committed(struct d3d12_device *device, const D3D12
 HRESULT d3d12_resource_create_placed(struct d3d12_device *device, const D3D12_RESOURCE_DESC1 *desc,
         struct d3d12_heap *heap, uint64_t heap_offset, D3D12_RESOURCE_STATES initial_state,
         const D3D12_CLEAR_VALUE *optimized_clear_value, struct d3d12_resource **resource);
+HRESULT d3d12_resource_create_transient_slots(struct d3d12_device *device, struct d3d12_heap *heap,
+        unsigned int slot_count, const D3D12_TRANSIENT_RESOURCE_SLOT_DESC *slot_descs,
+        struct d3d12_resource **resources);
 HRESULT d3d12_resource_create_reserved(struct d3d12_device *device,
         const D3D12_RESOURCE_DESC1 *desc, D3D12_RESOURCE_STATES initial_state,
         const D3D12_CLEAR_VALUE *optimized_clear_value, struct d3d12_resource **resource);
 
+#define VKD3D_RESOURCE_RECYCLE_POOL_MAX_COUNT 64u
+#define VKD3D_RESOURCE_RECYCLE_POOL_MAX_SIZE (256ull * 1024 * 1024)
+
+struct vkd3d_resource_recycle_entry
+{
+    struct list entry;
+    D3D12_RESOURCE_DESC1 desc;
+    D3D12_HEAP_PROPERTIES heap_properties;
+    D3D12_HEAP_FLAGS heap_flags;
+    VkImage vk_image;
+    VkImageView vrs_view;
+    struct vkd3d_memory_allocation mem;
+    uint32_t resource_flags;
+    VkImageLayout common_layout;
+};
+
+/* Recently released committed textures, most recently released first.
+ * Only used with VKD3D_CONFIG_FLAG_RECYCLE_COMMITTED_RESOURCES. */
+struct vkd3d_resource_recycle_pool
+{
+    pthread_mutex_t mutex;
+    struct list entries;
+    uint32_t entry_count;
+    VkDeviceSize total_size;
+};
+
+HRESULT vkd3d_resource_recycle_pool_init(struct vkd3d_resource_recycle_pool *pool);
+void vkd3d_resource_recycle_pool_cleanup(struct vkd3d_resource_recycle_pool *pool, struct d3d12_device *device);
+
+/* Resources whose last reference is gone, torn down in batches on a worker thread.
+ * Only used with VKD3D_CONFIG_FLAG_DEFERRED_RESOURCE_DESTROY. */
+struct vkd3d_resource_destroy_queue
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool should_exit;
+    bool is_running;
+
+    struct d3d12_resource **resources;
+    size_t resources_size;
+    size_t resource_count;
+
+    /* Only accessed by the worker thread. */
+    struct d3d12_resource **batch;
+    size_t batch_size;
+
+    struct d3d12_device *device;
+};
+
+HRESULT vkd3d_resource_destroy_queue_init(struct vkd3d_resource_destroy_queue *queue, struct d3d12_device *device);
+void vkd3d_resource_destroy_queue_cleanup(struct vkd3d_resource_destroy_queue *queue);
+
+#define VKD3D_MEMORY_BIND_QUEUE_THRESHOLD 256
+
+/* Memory binds of placed textures, issued in one vkBindImageMemory2 call before the first
+ * view creation, command recording or destruction which may touch any of the images.
+ * Only used with VKD3D_CONFIG_FLAG_DEFERRED_MEMORY_BIND. */
+struct vkd3d_memory_bind_queue
+{
+    pthread_mutex_t mutex;
+    VkBindImageMemoryInfo *binds;
+    size_t binds_size;
+    /* Written under the mutex, read without it to skip the lock when nothing is pending. */
+    uint32_t bind_count;
+};
+
+HRESULT vkd3d_memory_bind_queue_init(struct vkd3d_memory_bind_queue *queue);
+void vkd3d_memory_bind_queue_cleanup(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device);
+bool vkd3d_memory_bind_queue_push(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device,
+        const VkBindImageMemoryInfo *bind_info);
+void vkd3d_memory_bind_queue_flush(struct vkd3d_memory_bind_queue *queue, struct d3d12_device *device);
+
+static inline void vkd3d_memory_bind_queue_flush_if_pending(struct vkd3d_memory_bind_queue *queue,
+        struct d3d12_device *device)
+{
+    if (vkd3d_atomic_uint32_load_explicit(&queue->bind_count, vkd3d_memory_order_acquire))
+        vkd3d_memory_bind_queue_flush(queue, device);
+}
+
 static inline struct d3d12_resource *impl_from_ID3D12Resource2(ID3D12Resource2 *iface)
 {
     extern CONST_VTBL struct ID3D12Resource2Vtbl d3d12_resource_vtbl;
@@ -1050,6 +1358,67 @@ HRESULT vkd3d_create_buffer_explicit_usage(struct d3d12_device *device,
 HRESULT vkd3d_get_image_allocation_info(struct d3d12_device *device,
         const D3D12_RESOURCE_DESC1 *desc, D3D12_RESOURCE_ALLOCATION_INFO *allocation_info);
 
+/* Memoizes vkd3d_get_image_allocation_info(), since applications packing heaps tend to query
+ * the same texture descs over and over. Slots are direct-mapped on the normalized desc, and a
+ * slot which another thread is accessing counts as a miss, so lookups never wait on each other. */
+#define VKD3D_IMAGE_ALLOCATION_INFO_CACHE_SIZE 1024
+
+struct vkd3d_image_allocation_info_cache_entry
+{
+    spinlock_t lock;
+    bool valid;
+    D3D12_RESOURCE_DESC1 desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info;
+};
+
+struct vkd3d_image_allocation_info_cache
+{
+    struct vkd3d_image_allocation_info_cache_entry *entries;
+    uint64_t hit_count;
+    uint64_t miss_count;
+};
+
+HRESULT vkd3d_image_allocation_info_cache_init(struct vkd3d_image_allocation_info_cache *cache);
+void vkd3d_image_allocation_info_cache_cleanup(struct vkd3d_image_allocation_info_cache *cache);
+
+/* Memoizes the VkImageCreateInfo chain derived from a texture desc, so that recurring
+ * texture shapes skip format compatibility and usage derivation on creation. Organized
+ * like the allocation info cache. Shared and reserved resources are never cached. */
+#define VKD3D_IMAGE_CREATE_INFO_CACHE_SIZE 512
+
+struct vkd3d_image_create_info_cache_entry;
+
+struct vkd3d_image_create_info_cache
+{
+    struct vkd3d_image_create_info_cache_entry *entries;
+    uint64_t hit_count;
+    uint64_t miss_count;
+};
+
+HRESULT vkd3d_image_create_info_cache_init(struct vkd3d_image_create_info_cache *cache);
+void vkd3d_image_create_info_cache_cleanup(struct vkd3d_image_create_info_cache *cache);
+
+/* CUDA interop handles of views, which middleware queries again every frame.
+ * Keyed on view cookies, which are never reused, so entries cannot go stale. */
+#define VKD3D_CUDA_HANDLE_CACHE_SIZE 256
+
+struct vkd3d_cuda_handle_cache_entry
+{
+    spinlock_t lock;
+    bool valid;
+    VkDescriptorType vk_descriptor_type;
+    uint64_t view_cookie;
+    uint64_t sampler_cookie;
+    uint32_t handle;
+};
+
+struct vkd3d_cuda_handle_cache
+{
+    struct vkd3d_cuda_handle_cache_entry entries[VKD3D_CUDA_HANDLE_CACHE_SIZE];
+    uint64_t hit_count;
+    uint64_t miss_count;
+};
+
 enum vkd3d_view_type
 {
     VKD3D_VIEW_TYPE_BUFFER,
@@ -1241,8 +1610,6 @@ void d3d12_desc_create_sampler_embedded(vkd3d_cpu_descriptor_va_t sampler,
 bool vkd3d_create_vk_buffer_view(struct d3d12_device *device,
         VkBuffer vk_buffer, const struct vkd3d_format *format,
         VkDeviceSize offset, VkDeviceSize range, VkBufferView *vk_view);
-bool vkd3d_create_raw_buffer_view(struct d3d12_device *device,
-        D3D12_GPU_VIRTUAL_ADDRESS gpu_address, VkBufferView *vk_buffer_view);
 HRESULT d3d12_create_static_sampler(struct d3d12_device *device,
         const D3D12_STATIC_SAMPLER_DESC *desc, VkSampler *vk_sampler);
 
@@ -1357,6 +1724,11 @@ struct d3d12_descriptor_heap
         struct vkd3d_device_memory_allocation device_allocation;
         uint8_t *host_allocation;
         VkDeviceSize offsets[VKD3D_MAX_BINDLESS_DESCRIPTOR_SETS];
+
+        /* Non-NULL if the heap is suballocated, buffer and memory are owned by the block. */
+        struct vkd3d_descriptor_arena_block *arena_block;
+        unsigned int arena_first_slot;
+        unsigned int arena_slot_count;
     } descriptor_buffer;
 
     VkDescriptorPool vk_descriptor_pool;
@@ -1375,6 +1747,13 @@ struct d3d12_descriptor_heap
 
     struct d3d12_null_descriptor_template null_descriptor_template;
 
+    /* With VKD3D_CONFIG_FLAG_DESCRIPTOR_COPY_DEDUP, one fingerprint per descriptor.
+     * Every descriptor write stores a unique value, copies propagate it. 0 means unknown. */
+    uint64_t *copy_fingerprints;
+
+    /* Bytes accounted to VKD3D_MEMORY_FOOTPRINT_DESCRIPTOR_HEAP. */
+    VkDeviceSize footprint_size;
+
     struct d3d12_device *device;
 
     struct vkd3d_private_store private_store;
@@ -1513,6 +1892,25 @@ static inline struct d3d12_desc_split d3d12_desc_decode_va(vkd3d_cpu_descriptor_
     return split;
 }
 
+/* Returns true if the destination descriptor already holds the source descriptor,
+ * otherwise records that it will once the copy is done. */
+static inline bool d3d12_desc_copy_is_redundant(const struct d3d12_desc_split *dst,
+        const struct d3d12_desc_split *src, unsigned int index)
+{
+    uint64_t fingerprint;
+
+    if (!dst->heap->copy_fingerprints)
+        return false;
+
+    fingerprint = src->heap->copy_fingerprints ? src->heap->copy_fingerprints[src->offset + index] : 0;
+
+    if (fingerprint && dst->heap->copy_fingerprints[dst->offset + index] == fingerprint)
+        return true;
+
+    dst->heap->copy_fingerprints[dst->offset + index] = fingerprint;
+    return false;
+}
+
 static inline uint32_t d3d12_desc_heap_offset_from_embedded_gpu_handle(D3D12_GPU_DESCRIPTOR_HANDLE handle,
         unsigned int cbv_srv_uav_size_log2, unsigned int sampler_size_log2)
 {
@@ -1642,10 +2040,68 @@ struct vkd3d_descriptor_hoist_desc
     uint32_t parameter_index;
 };
 
+/* Number of hoisted descriptor flushes observed on a root signature
+ * before the refresh strategy is locked in. */
+#define VKD3D_DESCRIPTOR_HOIST_FEEDBACK_WARMUP 4096u
+
+enum vkd3d_descriptor_hoist_mode
+{
+    /* Gathering statistics, hoisted descriptors are only refreshed when their heap offset changes. */
+    VKD3D_DESCRIPTOR_HOIST_MODE_WARMUP = 0,
+    /* Hoisted descriptors are only refreshed when their heap offset changes. */
+    VKD3D_DESCRIPTOR_HOIST_MODE_TRACKED,
+    /* Tracking rarely skipped anything, refresh every hoisted descriptor on every flush. */
+    VKD3D_DESCRIPTOR_HOIST_MODE_EAGER,
+};
+
+/* Shared between all command lists using the root signature, counters are updated atomically. */
+struct vkd3d_descriptor_hoist_feedback
+{
+    uint32_t mode; /* vkd3d_descriptor_hoist_mode */
+    uint32_t flush_count;
+    uint32_t table_rebind_count;
+    uint32_t descriptor_update_count;
+    uint32_t descriptor_skip_count;
+};
+
 struct vkd3d_descriptor_hoist_info
 {
     struct vkd3d_descriptor_hoist_desc desc[VKD3D_MAX_HOISTED_DESCRIPTORS];
     unsigned int num_desc;
+    /* Root parameters whose descriptor table feeds at least one hoisted descriptor. */
+    uint64_t table_mask;
+    struct vkd3d_descriptor_hoist_feedback *feedback;
+};
+
+/* Flattened form of the root parameter layout, compiled once at root signature creation.
+ * Draw-time flushing walks these arrays directly instead of decoding root parameters. */
+struct vkd3d_root_binding_constant_op
+{
+    uint16_t word_offset;
+    uint16_t word_count;
+};
+
+struct vkd3d_root_binding_table_op
+{
+    uint8_t parameter_index;
+    uint8_t table_index;
+};
+
+struct vkd3d_root_binding_program
+{
+    struct vkd3d_root_binding_constant_op constant_ops[D3D12_MAX_ROOT_COST];
+    struct vkd3d_root_binding_table_op table_ops[D3D12_MAX_ROOT_COST];
+    uint8_t root_descriptor_va_parameters[D3D12_MAX_ROOT_COST / 2];
+    uint64_t root_constant_word_mask;
+    unsigned int constant_op_count;
+    unsigned int table_op_count;
+    unsigned int root_descriptor_va_count;
+};
+
+struct vkd3d_root_signature_cache_key
+{
+    uint32_t checksum[4];
+    size_t size;
 };
 
 struct d3d12_root_signature
@@ -1656,11 +2112,18 @@ struct d3d12_root_signature
 
     vkd3d_shader_hash_t compatibility_hash;
 
+    /* Identical blobs share one object, as on native D3D12. */
+    struct vkd3d_root_signature_cache_key cache_key;
+    bool is_cached;
+
+    /* Assigned on first creation while VKD3D_CAPTURE_PATH is active, 0 otherwise. */
+    uint32_t capture_id;
+
     struct d3d12_bind_point_layout graphics, mesh, compute, raygen;
     VkDescriptorSetLayout vk_sampler_descriptor_layout;
     VkDescriptorSetLayout vk_root_descriptor_layout;
 
-    VkDescriptorPool vk_sampler_pool;
+    struct vkd3d_static_sampler_set *static_sampler_set;
     VkDescriptorSet vk_sampler_set;
 
     struct vkd3d_shader_root_parameter *parameters;
@@ -1700,6 +2163,7 @@ struct d3d12_root_signature
     VkSampler *static_samplers;
 
     struct vkd3d_descriptor_hoist_info hoist_info;
+    struct vkd3d_root_binding_program binding_program;
 
     struct d3d12_device *device;
 
@@ -1714,6 +2178,7 @@ HRESULT d3d12_root_signature_create_empty(struct d3d12_device *device,
         struct d3d12_root_signature **root_signature);
 /* Private ref counts, for pipeline library. */
 void d3d12_root_signature_inc_ref(struct d3d12_root_signature *state);
+bool d3d12_root_signature_try_inc_ref(struct d3d12_root_signature *state);
 void d3d12_root_signature_dec_ref(struct d3d12_root_signature *state);
 
 static inline struct d3d12_root_signature *impl_from_ID3D12RootSignature(ID3D12RootSignature *iface)
@@ -1725,6 +2190,15 @@ static inline struct d3d12_root_signature *impl_from_ID3D12RootSignature(ID3D12R
     return CONTAINING_RECORD(iface, struct d3d12_root_signature, ID3D12RootSignature_iface);
 }
 
+/* API capture, see vkd3d_capture.h for the trace format. */
+void vkd3d_init_capture(void);
+bool vkd3d_uses_capture(void);
+void vkd3d_capture_flush(void);
+void vkd3d_capture_root_signature(struct d3d12_root_signature *root_signature,
+        UINT node_mask, const void *blob, size_t size);
+void vkd3d_capture_compute_pipeline(const D3D12_COMPUTE_PIPELINE_STATE_DESC *desc);
+void vkd3d_capture_graphics_pipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC *desc);
+
 unsigned int d3d12_root_signature_get_shader_interface_flags(const struct d3d12_root_signature *root_signature,
         enum vkd3d_pipeline_type pipeline_type);
 HRESULT d3d12_root_signature_create_local_static_samplers_layout(struct d3d12_root_signature *root_signature,
@@ -1820,11 +2294,34 @@ struct vkd3d_vertex_input_pipeline_desc
     VkPipelineDynamicStateCreateInfo dy_info;
 };
 
+/* Immutable copy of a pipeline library map entry. Hash map entries move when the map grows,
+ * so lock-free lookups go through these instead. Records are only freed with the device. */
+struct vkd3d_pipeline_library_lookup_record
+{
+    VkPipeline vk_pipeline;
+    uint32_t hash;
+    uint8_t desc[];
+};
+
+#define VKD3D_PIPELINE_LIBRARY_LOOKUP_SLOT_COUNT 256
+
+/* Direct-mapped table in front of the vertex input and fragment output maps,
+ * which lets the linking hot path skip the rwlock entirely on a hit. */
+struct vkd3d_pipeline_library_lookup_cache
+{
+    struct vkd3d_pipeline_library_lookup_record *slots[VKD3D_PIPELINE_LIBRARY_LOOKUP_SLOT_COUNT];
+    /* Only maintained with VKD3D_CONFIG=pipeline_library_log, to keep the hot path free of shared writes. */
+    uint32_t fast_hit_count;
+    uint32_t hit_count;
+    uint32_t miss_count;
+};
+
 struct vkd3d_vertex_input_pipeline
 {
     struct hash_map_entry entry;
     struct vkd3d_vertex_input_pipeline_desc desc;
     VkPipeline vk_pipeline;
+    struct vkd3d_pipeline_library_lookup_record *lookup_record;
 };
 
 uint32_t vkd3d_vertex_input_pipeline_desc_hash(const void *key);
@@ -1856,6 +2353,7 @@ struct vkd3d_fragment_output_pipeline
     struct hash_map_entry entry;
     struct vkd3d_fragment_output_pipeline_desc desc;
     VkPipeline vk_pipeline;
+    struct vkd3d_pipeline_library_lookup_record *lookup_record;
 };
 
 uint32_t vkd3d_fragment_output_pipeline_desc_hash(const void *key);
@@ -1946,7 +2444,13 @@ struct d3d12_graphics_pipeline_state
     VkPipeline library;
     VkGraphicsPipelineLibraryFlagsEXT library_flags;
     VkPipelineCreateFlags library_create_flags;
-    struct list compiled_fallback_pipelines;
+    struct hash_map compiled_fallback_pipelines;
+
+    /* With VKD3D_CONFIG_FLAG_PIPELINE_ASYNC_COMPILE, the primary pipeline is compiled on the
+     * device compile pool. Until it completes, binds either fast-link the pipeline library or wait. */
+    struct vkd3d_job async_compile_task;
+    VkPipeline async_link_pipeline;
+    bool async_compile_from_cached_blob;
 
     bool xfb_enabled;
 };
@@ -1956,9 +2460,43 @@ static inline unsigned int dsv_attachment_mask(const struct d3d12_graphics_pipel
     return 1u << graphics->rt_count;
 }
 
+#define VKD3D_ROOT_CONSTANT_SPECIALIZATION_MAX_WORDS 16
+#define VKD3D_ROOT_CONSTANT_SPECIALIZATION_THRESHOLD 256
+
+enum vkd3d_root_constant_specialization_status
+{
+    VKD3D_ROOT_CONSTANT_SPECIALIZATION_PROFILING = 0,
+    VKD3D_ROOT_CONSTANT_SPECIALIZATION_QUEUED,
+    VKD3D_ROOT_CONSTANT_SPECIALIZATION_DONE,
+};
+
+/* A single compute pipeline variant with root constants folded into the shader.
+ * Only allocated with VKD3D_CONFIG_FLAG_SPECIALIZE_ROOT_CONSTANTS. */
+struct d3d12_compute_pipeline_specialization
+{
+    struct vkd3d_job task;
+    void *dxbc;
+    size_t dxbc_size;
+
+    /* Push constant word offsets of the root constants we profile. */
+    uint32_t word_offsets[VKD3D_ROOT_CONSTANT_SPECIALIZATION_MAX_WORDS];
+    unsigned int word_count;
+
+    /* Profiling counters, updated by any thread recording dispatches with the PSO. */
+    uint32_t observed_hash;
+    uint32_t stable_count;
+    uint32_t status; /* enum vkd3d_root_constant_specialization_status */
+
+    /* values are written before the task is queued, vk_pipeline before status becomes DONE.
+     * Readers must observe DONE with acquire semantics first. */
+    uint32_t values[VKD3D_ROOT_CONSTANT_SPECIALIZATION_MAX_WORDS];
+    VkPipeline vk_pipeline;
+};
+
 struct d3d12_compute_pipeline_state
 {
     VkPipeline vk_pipeline;
+    struct d3d12_compute_pipeline_specialization *specialization;
     struct vkd3d_shader_code code;
     struct vkd3d_shader_code_debug code_debug;
     VkShaderModuleIdentifierEXT identifier;
@@ -1974,6 +2512,35 @@ struct vkd3d_pipeline_cache_compatibility
     uint64_t dxbc_blob_hashes[VKD3D_MAX_SHADER_STAGES];
 };
 
+enum vkd3d_pipeline_telemetry_phase
+{
+    VKD3D_PIPELINE_TELEMETRY_PHASE_SPIRV = 0,
+    VKD3D_PIPELINE_TELEMETRY_PHASE_PIPELINE,
+    VKD3D_PIPELINE_TELEMETRY_PHASE_LINK,
+    VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT
+};
+
+enum vkd3d_pipeline_telemetry_source
+{
+    VKD3D_PIPELINE_TELEMETRY_SOURCE_FRESH = 0,
+    VKD3D_PIPELINE_TELEMETRY_SOURCE_MEMORY,
+    VKD3D_PIPELINE_TELEMETRY_SOURCE_APPLICATION,
+    VKD3D_PIPELINE_TELEMETRY_SOURCE_DISK_CACHE,
+    VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT
+};
+
+/* Per-PSO creation cost. Only written under the device telemetry lock. */
+struct vkd3d_pipeline_telemetry_record
+{
+    uint64_t id;
+    uint64_t dxbc_hash;
+    uint64_t phase_ns[VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT];
+    uint32_t phase_source_mask[VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT];
+    enum vkd3d_pipeline_type pipeline_type;
+    /* Where the cached PSO blob came from, or FRESH if there was none. */
+    enum vkd3d_pipeline_telemetry_source cached_source;
+};
+
 /* ID3D12PipelineState */
 struct d3d12_pipeline_state
 {
@@ -1998,6 +2565,11 @@ struct d3d12_pipeline_state
     bool pso_is_loaded_from_cached_blob;
     bool pso_is_fully_dynamic;
 
+    /* Bytes of SPIR-V accounted to VKD3D_MEMORY_FOOTPRINT_PIPELINE_SPIRV. */
+    size_t spirv_footprint_size;
+
+    struct vkd3d_pipeline_telemetry_record telemetry;
+
     struct vkd3d_private_store private_store;
 };
 
@@ -2025,6 +2597,10 @@ ULONG d3d12_pipeline_state_inc_public_ref(struct d3d12_pipeline_state *state);
 void d3d12_pipeline_state_inc_ref(struct d3d12_pipeline_state *state);
 void d3d12_pipeline_state_dec_ref(struct d3d12_pipeline_state *state);
 
+void d3d12_pipeline_state_wait_async_compile(struct d3d12_pipeline_state *state);
+VkPipeline d3d12_pipeline_state_select_compute_pipeline(struct d3d12_pipeline_state *state,
+        const uint32_t *root_constants);
+
 struct d3d12_cached_pipeline_state
 {
     D3D12_CACHED_PIPELINE_STATE blob;
@@ -2095,8 +2671,11 @@ struct vkd3d_pipeline_key
 bool d3d12_pipeline_state_has_replaced_shaders(struct d3d12_pipeline_state *state);
 HRESULT d3d12_pipeline_state_create(struct d3d12_device *device, VkPipelineBindPoint bind_point,
         const struct d3d12_pipeline_state_desc *desc, struct d3d12_pipeline_state **state);
-VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_state *state,
+void d3d12_pipeline_state_init_pipeline_key(struct d3d12_pipeline_state *state,
         const struct vkd3d_dynamic_state *dyn_state, const struct vkd3d_format *dsv_format,
+        struct vkd3d_pipeline_key *key);
+VkPipeline d3d12_pipeline_state_get_or_create_pipeline(struct d3d12_pipeline_state *state,
+        const struct vkd3d_pipeline_key *key, const struct vkd3d_format *dsv_format,
         uint32_t *dynamic_state_flags);
 VkPipeline d3d12_pipeline_state_get_pipeline(struct d3d12_pipeline_state *state,
         const struct vkd3d_dynamic_state *dyn_state, const struct vkd3d_format *dsv_format,
@@ -2140,6 +2719,7 @@ struct vkd3d_pipeline_library_disk_cache
 
     char read_path[VKD3D_PATH_MAX];
     char write_path[VKD3D_PATH_MAX];
+    char index_path[VKD3D_PATH_MAX];
 
     /* The stream archive is designed to be safe against concurrent readers and writers, ala Fossilize.
      * There is a read-only portion, and a write-only portion which can be merged back to the read-only archive
@@ -2148,6 +2728,19 @@ struct vkd3d_pipeline_library_disk_cache
     bool stream_archive_attempted_write;
 };
 
+/* PSO entries are striped over independently locked shards, so that many threads
+ * loading and storing pipelines concurrently rarely contend on the same writer lock. */
+#define VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT 16
+
+struct d3d12_pipeline_library_shard
+{
+    rwlock_t lock;
+    struct hash_map map;
+
+    size_t total_name_table_size;
+    size_t total_blob_size;
+};
+
 struct d3d12_pipeline_library
 {
     d3d12_pipeline_library_iface ID3D12PipelineLibrary_iface;
@@ -2157,17 +2750,20 @@ struct d3d12_pipeline_library
 
     struct d3d12_device *device;
 
-    rwlock_t mutex;
+    /* Shards are selected by key hash. Serialization takes every shard lock
+     * in index order to get a consistent snapshot. */
+    struct d3d12_pipeline_library_shard pso_shards[VKD3D_PIPELINE_LIBRARY_PSO_SHARD_COUNT];
     /* driver_cache_map and spirv_cache_map can be touched in serialize_pipeline_state.
      * Use the internal mutex when touching the internal caches
      * so we don't need a big lock on the outside when serializing. */
     rwlock_t internal_hashmap_mutex;
-    struct hash_map pso_map;
     struct hash_map driver_cache_map;
     struct hash_map spirv_cache_map;
 
     size_t total_name_table_size;
     size_t total_blob_size;
+    /* Bytes accounted to VKD3D_MEMORY_FOOTPRINT_PIPELINE_LIBRARY, shards update it concurrently. */
+    uint64_t footprint_size;
 
     /* Non-owned pointer. Calls back into the disk cache when blobs are added. */
     struct vkd3d_pipeline_library_disk_cache *disk_cache_listener;
@@ -2194,6 +2790,8 @@ enum vkd3d_pipeline_library_flags
 HRESULT d3d12_pipeline_library_create(struct d3d12_device *device, const void *blob,
         size_t blob_length, uint32_t flags, /* vkd3d_pipeline_library_flags */
         struct d3d12_pipeline_library **pipeline_library);
+/* Flags for ID3D12PipelineLibrary objects created by the application. */
+uint32_t vkd3d_pipeline_library_get_application_flags(struct d3d12_device *device);
 
 VkResult vkd3d_create_pipeline_cache(struct d3d12_device *device,
         size_t size, const void *data, VkPipelineCache *cache);
@@ -2211,7 +2809,7 @@ HRESULT d3d12_cached_pipeline_state_validate(struct d3d12_device *device,
         const struct vkd3d_pipeline_cache_compatibility *compat);
 bool d3d12_cached_pipeline_state_is_dummy(const struct d3d12_cached_pipeline_state *state);
 void vkd3d_pipeline_cache_compat_from_state_desc(struct vkd3d_pipeline_cache_compatibility *compat,
-        const struct d3d12_pipeline_state_desc *desc);
+        struct d3d12_device *device, const struct d3d12_pipeline_state_desc *desc);
 
 ULONG d3d12_pipeline_library_inc_public_ref(struct d3d12_pipeline_library *state);
 ULONG d3d12_pipeline_library_dec_public_ref(struct d3d12_pipeline_library *state);
@@ -2234,6 +2832,34 @@ HRESULT vkd3d_pipeline_library_init_disk_cache(struct vkd3d_pipeline_library_dis
 /* Called on device destroy. */
 void vkd3d_pipeline_library_flush_disk_cache(struct vkd3d_pipeline_library_disk_cache *cache);
 
+/* Translated SPIR-V is shared between PSOs which use the same shader with equivalent
+ * compile arguments. Entries live until the device is destroyed, bounded by a size budget. */
+#define VKD3D_SHADER_SPIRV_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+struct vkd3d_shader_spirv_cache_key
+{
+    vkd3d_shader_hash_t dxbc_hash;
+    uint64_t root_signature_compat_hash;
+    uint64_t compile_args_hash;
+};
+
+struct vkd3d_shader_spirv_cache
+{
+    rwlock_t lock;
+    struct hash_map map;
+    size_t total_size;
+
+    uint64_t hit_count;
+    uint64_t miss_count;
+};
+
+HRESULT vkd3d_shader_spirv_cache_init(struct vkd3d_shader_spirv_cache *cache);
+void vkd3d_shader_spirv_cache_cleanup(struct vkd3d_shader_spirv_cache *cache);
+bool vkd3d_shader_spirv_cache_lookup(struct vkd3d_shader_spirv_cache *cache,
+        const struct vkd3d_shader_spirv_cache_key *key, struct vkd3d_shader_code *spirv);
+void vkd3d_shader_spirv_cache_insert(struct vkd3d_shader_spirv_cache *cache,
+        const struct vkd3d_shader_spirv_cache_key *key, const struct vkd3d_shader_code *spirv);
+
 struct vkd3d_buffer
 {
     VkBuffer vk_buffer;
@@ -2254,6 +2880,10 @@ struct d3d12_descriptor_pool_cache
 
 #define VKD3D_SCRATCH_BUFFER_SIZE (1ull << 20)
 #define VKD3D_SCRATCH_BUFFER_COUNT (32u)
+/* Scratch buffers and query pools an allocator keeps across Reset()
+ * so that steady-state recording does not go through the device pools. */
+#define VKD3D_COMMAND_ALLOCATOR_SCRATCH_BUFFER_RETAIN_COUNT (4u)
+#define VKD3D_COMMAND_ALLOCATOR_QUERY_POOL_RETAIN_COUNT (16u)
 
 struct vkd3d_scratch_buffer
 {
@@ -2268,7 +2898,8 @@ struct vkd3d_scratch_buffer
 #define VKD3D_QUERY_TYPE_INDEX_RT_SERIALIZE_SIZE (4u)
 #define VKD3D_QUERY_TYPE_INDEX_RT_CURRENT_SIZE (5u)
 #define VKD3D_QUERY_TYPE_INDEX_RT_SERIALIZE_SIZE_BOTTOM_LEVEL_POINTERS (6u)
-#define VKD3D_VIRTUAL_QUERY_TYPE_COUNT (7u)
+#define VKD3D_QUERY_TYPE_INDEX_TIMESTAMP (7u)
+#define VKD3D_VIRTUAL_QUERY_TYPE_COUNT (8u)
 #define VKD3D_VIRTUAL_QUERY_POOL_COUNT (128u)
 
 struct vkd3d_query_pool
@@ -2279,6 +2910,50 @@ struct vkd3d_query_pool
     uint32_t next_index;
 };
 
+/* GPU time spent in work vkd3d-proton records on its own behalf, with VKD3D_CONFIG=meta_timing. */
+enum vkd3d_meta_timing_category
+{
+    VKD3D_META_TIMING_CLEAR_UAV = 0,
+    VKD3D_META_TIMING_QUERY_RESOLVE,
+    VKD3D_META_TIMING_EXECUTE_INDIRECT,
+    VKD3D_META_TIMING_PREDICATION,
+    VKD3D_META_TIMING_CATEGORY_COUNT
+};
+
+struct vkd3d_meta_timing_scope
+{
+    VkQueryPool vk_query_pool;
+    uint32_t query_index;
+};
+
+struct vkd3d_meta_timing_record
+{
+    struct vkd3d_meta_timing_scope begin;
+    struct vkd3d_meta_timing_scope end;
+    enum vkd3d_meta_timing_category category;
+};
+
+/* Work recorded into a command list since its last Reset(). */
+enum vkd3d_command_list_stat
+{
+    VKD3D_COMMAND_LIST_STAT_DRAW = 0,
+    VKD3D_COMMAND_LIST_STAT_DISPATCH,
+    VKD3D_COMMAND_LIST_STAT_RENDER_PASS_BEGIN,
+    VKD3D_COMMAND_LIST_STAT_RENDER_PASS_SUSPEND,
+    VKD3D_COMMAND_LIST_STAT_RENDER_PASS_END,
+    VKD3D_COMMAND_LIST_STAT_BARRIER_BATCH,
+    VKD3D_COMMAND_LIST_STAT_DESCRIPTOR_BUFFER_BIND,
+    VKD3D_COMMAND_LIST_STAT_DYNAMIC_STATE_EMIT,
+    VKD3D_COMMAND_LIST_STAT_META_OPERATION,
+    VKD3D_COMMAND_LIST_STAT_QUERY_RESOLVE_FLUSH,
+    VKD3D_COMMAND_LIST_STAT_COUNT
+};
+
+struct vkd3d_command_list_stats
+{
+    uint32_t counts[VKD3D_COMMAND_LIST_STAT_COUNT];
+};
+
 struct d3d12_command_allocator_scratch_pool
 {
     struct vkd3d_scratch_buffer *scratch_buffers;
@@ -2294,13 +2969,31 @@ enum vkd3d_scratch_pool_kind
     VKD3D_SCRATCH_POOL_KIND_COUNT
 };
 
-/* ID3D12CommandAllocator */
-struct d3d12_command_allocator
+/* Transient buffer views are keyed on the unique resource cookie rather than the VkBuffer,
+ * since buffer handles may be recycled once the resource is destroyed. */
+struct vkd3d_buffer_view_pool_key
 {
-    ID3D12CommandAllocator ID3D12CommandAllocator_iface;
-    LONG refcount;
-
-    D3D12_COMMAND_LIST_TYPE type;
+    uint64_t cookie;
+    VkDeviceSize offset;
+    VkDeviceSize range;
+    VkFormat vk_format;
+};
+
+struct vkd3d_buffer_view_pool_entry
+{
+    struct hash_map_entry hash_entry;
+    struct vkd3d_buffer_view_pool_key key;
+    VkBufferView vk_buffer_view;
+    uint32_t generation;
+};
+
+/* ID3D12CommandAllocator */
+struct d3d12_command_allocator
+{
+    ID3D12CommandAllocator ID3D12CommandAllocator_iface;
+    LONG refcount;
+
+    D3D12_COMMAND_LIST_TYPE type;
     VkQueueFlags vk_queue_flags;
     uint32_t vk_family_index;
 
@@ -2310,9 +3003,10 @@ struct d3d12_command_allocator
     size_t views_size;
     size_t view_count;
 
-    VkBufferView *buffer_views;
-    size_t buffer_views_size;
-    size_t buffer_view_count;
+    /* Transient buffer views survive Reset and are reused by later recordings.
+     * Views which were not used since the previous Reset are destroyed. */
+    struct hash_map buffer_view_pool;
+    uint32_t buffer_view_generation;
 
     VkCommandBuffer *command_buffers;
     size_t command_buffers_size;
@@ -2324,8 +3018,25 @@ struct d3d12_command_allocator
     size_t query_pools_size;
     size_t query_pool_count;
 
+    /* Query pools retained from a previous Reset(), ready for reuse. */
+    struct vkd3d_query_pool *free_query_pools;
+    size_t free_query_pools_size;
+    size_t free_query_pool_count;
+
     struct vkd3d_query_pool active_query_pools[VKD3D_VIRTUAL_QUERY_TYPE_COUNT];
 
+    /* Query pools of each type acquired since the last Reset(), and a decaying peak
+     * of that count which decides how many pools are kept around and pre-acquired. */
+    uint32_t query_pool_usage[VKD3D_VIRTUAL_QUERY_TYPE_COUNT];
+    uint32_t query_pool_history[VKD3D_VIRTUAL_QUERY_TYPE_COUNT];
+
+    /* Timestamp pairs recorded around meta operations, read back on Reset(). */
+    struct vkd3d_meta_timing_record *meta_timings;
+    size_t meta_timings_size;
+    size_t meta_timing_count;
+    uint64_t meta_timing_mask;
+    bool meta_timing;
+
     LONG outstanding_submissions_count;
 
     struct d3d12_command_list *current_command_list;
@@ -2368,6 +3079,7 @@ struct vkd3d_pipeline_bindings
 
     uint32_t descriptor_tables[D3D12_MAX_ROOT_COST];
     uint64_t descriptor_table_active_mask;
+    uint64_t descriptor_table_dirty_mask;
     uint64_t descriptor_heap_dirty_mask;
 
     /* Needed when VK_KHR_push_descriptor is not available. */
@@ -2377,6 +3089,12 @@ struct vkd3d_pipeline_bindings
 
     uint32_t root_constants[D3D12_MAX_ROOT_COST];
     uint64_t root_constant_dirty_mask;
+    /* One bit per 32-bit word in root_constants. */
+    uint64_t root_constant_word_dirty_mask;
+
+    /* Heap offsets the hoisted descriptors were last resolved from. */
+    uint32_t hoisted_descriptor_offsets[VKD3D_MAX_HOISTED_DESCRIPTORS];
+    uint32_t hoisted_descriptor_valid_mask;
 };
 
 struct vkd3d_dynamic_state
@@ -2486,10 +3204,12 @@ struct vkd3d_rendering_info
     VkRenderingFragmentShadingRateAttachmentInfoKHR vrs;
     uint32_t state_flags;
     uint32_t rtv_mask;
+    /* Full clears of bound render targets not yet recorded. The clear values live in rtv[]. */
+    uint32_t clear_rtv_mask;
 };
 
-/* ID3D12CommandListExt */
-typedef ID3D12GraphicsCommandListExt d3d12_command_list_vkd3d_ext_iface;
+/* ID3D12GraphicsCommandListExt1 */
+typedef ID3D12GraphicsCommandListExt1 d3d12_command_list_vkd3d_ext_iface;
 
 struct d3d12_state_object;
 
@@ -2499,6 +3219,10 @@ struct d3d12_resource_tracking
     uint32_t plane_optimal_mask;
 };
 
+/* Direct-mapped on resource cookie, entries are indices into dsv_resource_tracking
+ * and are validated against the tracked resource on lookup. */
+#define VKD3D_DSV_RESOURCE_TRACKING_HINT_COUNT 16
+
 struct vkd3d_subresource_tracking
 {
     struct d3d12_resource *resource;
@@ -2520,6 +3244,7 @@ enum vkd3d_batch_type
     VKD3D_BATCH_TYPE_COPY_BUFFER_TO_IMAGE,
     VKD3D_BATCH_TYPE_COPY_IMAGE_TO_BUFFER,
     VKD3D_BATCH_TYPE_COPY_IMAGE,
+    VKD3D_BATCH_TYPE_RESOLVE,
 };
 
 struct vkd3d_image_copy_info
@@ -2531,6 +3256,7 @@ struct vkd3d_image_copy_info
     {
         VkBufferImageCopy2 buffer_image;
         VkImageCopy2 image;
+        VkImageResolve2 resolve;
     } copy;
     /* TODO: split d3d12_command_list_copy_image too, so this can be a local variable of before_copy_texture_region. */
     bool writes_full_subresource;
@@ -2549,6 +3275,11 @@ struct vkd3d_query_resolve_entry
     VkDeviceSize dst_offset;
 };
 
+/* Maximum number of query resolves merged into a single copy command. */
+#define VKD3D_QUERY_RESOLVE_MAX_MERGED_COPIES 32
+/* Maximum number of contiguous ranges for which SO statistics are copied straight into the heap. */
+#define VKD3D_QUERY_MAX_DIRECT_COPY_RANGES 8
+
 #define VKD3D_QUERY_LOOKUP_GRANULARITY_BITS (6u)
 #define VKD3D_QUERY_LOOKUP_GRANULARITY (1u << VKD3D_QUERY_LOOKUP_GRANULARITY_BITS)
 #define VKD3D_QUERY_LOOKUP_INDEX_MASK (VKD3D_QUERY_LOOKUP_GRANULARITY - 1u)
@@ -2566,19 +3297,26 @@ struct vkd3d_query_lookup_entry
     uint64_t query_mask;
 };
 
-#define VKD3D_COPY_TEXTURE_REGION_MAX_BATCH_SIZE 16
+/* The batch array grows on demand up to this many copies. */
+#define VKD3D_COPY_TEXTURE_REGION_MAX_BATCH_SIZE 256
+/* Maximum number of regions coalesced into a single vkCmdCopy*2 call. */
+#define VKD3D_COPY_TEXTURE_REGION_MAX_MERGED_REGIONS 32
 
 struct d3d12_transfer_batch_state
 {
     enum vkd3d_batch_type batch_type;
-    struct vkd3d_image_copy_info batch[VKD3D_COPY_TEXTURE_REGION_MAX_BATCH_SIZE];
+    struct vkd3d_image_copy_info *batch;
+    size_t batch_size;
     size_t batch_len;
 };
 
 #define VKD3D_MAX_WBI_BATCH_SIZE 128
+/* Batches which would need at least this many separate buffer updates are applied with a compute dispatch. */
+#define VKD3D_MIN_WBI_COMPUTE_UPDATE_COUNT 8
 
 struct d3d12_wbi_batch_state
 {
+    VkDeviceAddress vas[VKD3D_MAX_WBI_BATCH_SIZE];
     VkBuffer buffers[VKD3D_MAX_WBI_BATCH_SIZE];
     VkDeviceSize offsets[VKD3D_MAX_WBI_BATCH_SIZE];
     VkPipelineStageFlags stages[VKD3D_MAX_WBI_BATCH_SIZE];
@@ -2586,6 +3324,26 @@ struct d3d12_wbi_batch_state
     size_t batch_len;
 };
 
+/* Back-to-back RTAS builds without a barrier in between cannot depend on each other,
+ * so they are recorded with a single vkCmdBuildAccelerationStructuresKHR. */
+#define VKD3D_RTAS_BUILD_BATCH_SIZE 32
+
+struct d3d12_rtas_batch_state
+{
+    struct vkd3d_acceleration_structure_build_info *build_infos;
+    struct vkd3d_acceleration_structure_build_arena *arena;
+    VkDeviceAddress scratch_vas[VKD3D_RTAS_BUILD_BATCH_SIZE];
+    size_t build_count;
+};
+
+#define MAX_BATCHED_IMAGE_BARRIERS 16
+struct d3d12_command_list_barrier_batch
+{
+    VkImageMemoryBarrier2 vk_image_barriers[MAX_BATCHED_IMAGE_BARRIERS];
+    VkMemoryBarrier2 vk_memory_barrier;
+    uint32_t image_barrier_count;
+};
+
 union vkd3d_descriptor_heap_state
 {
     struct
@@ -2649,6 +3407,9 @@ struct d3d12_command_list
 
     bool predicate_enabled;
     VkDeviceAddress predicate_va;
+    /* Buffer range backing predicate_va, so that it can be consumed as a draw count. */
+    VkBuffer predicate_vk_buffer;
+    VkDeviceSize predicate_vk_offset;
 
     /* This is VK_NULL_HANDLE when we are no longer sure which pipeline to bind,
      * if this is NULL, we might need to lookup a pipeline key in order to bind the correct pipeline. */
@@ -2658,6 +3419,16 @@ struct d3d12_command_list
      * possible calls to vkCmdBindPipeline and avoids invalidating dynamic state. */
     VkPipeline command_buffer_pipeline;
 
+    /* Last fallback pipeline variant looked up by this list, so repeated draws
+     * with the same key do not have to take the pipeline state lock. */
+    struct
+    {
+        struct d3d12_pipeline_state *state;
+        struct vkd3d_pipeline_key key;
+        VkPipeline vk_pipeline;
+        uint32_t dynamic_state_flags;
+    } fallback_pipeline_cache;
+
     struct vkd3d_rendering_info rendering_info;
     struct vkd3d_dynamic_state dynamic_state;
     struct vkd3d_pipeline_bindings graphics_bindings;
@@ -2701,6 +3472,7 @@ struct d3d12_command_list
     struct d3d12_resource_tracking *dsv_resource_tracking;
     size_t dsv_resource_tracking_count;
     size_t dsv_resource_tracking_size;
+    uint32_t dsv_resource_tracking_hints[VKD3D_DSV_RESOURCE_TRACKING_HINT_COUNT];
 
     struct vkd3d_subresource_tracking *subresource_tracking;
     size_t subresource_tracking_count;
@@ -2717,6 +3489,13 @@ struct d3d12_command_list
 
     struct d3d12_transfer_batch_state transfer_batch;
     struct d3d12_wbi_batch_state wbi_batch;
+    struct d3d12_rtas_batch_state rtas_batch;
+
+    /* Barriers from ResourceBarrier() which are held back until a command depends on them,
+     * so that back-to-back barrier calls end up in a single vkCmdPipelineBarrier2. */
+    struct d3d12_command_list_barrier_batch deferred_barriers;
+
+    struct vkd3d_command_list_stats stats;
 
     struct vkd3d_private_store private_store;
 
@@ -2752,16 +3531,30 @@ static inline struct vkd3d_pipeline_bindings *d3d12_command_list_get_bindings(
 
 #define VKD3D_BUNDLE_CHUNK_SIZE (256 << 10)
 #define VKD3D_BUNDLE_COMMAND_ALIGNMENT (sizeof(UINT64))
+/* Command records which fit in a cache line never straddle one. */
+#define VKD3D_BUNDLE_CACHE_LINE_SIZE 64
+
+struct d3d12_bundle_chunk
+{
+    void *data;
+    size_t size;
+};
 
 struct d3d12_bundle_allocator
 {
     ID3D12CommandAllocator ID3D12CommandAllocator_iface;
     LONG refcount;
 
-    void **chunks;
+    /* Chunks are rewound rather than freed on Reset. If a recording spilled into
+     * multiple chunks, they are replaced by a single chunk sized for the high-water
+     * mark, so that subsequent recordings are contiguous in memory. */
+    struct d3d12_bundle_chunk *chunks;
     size_t chunks_size;
     size_t chunks_count;
+    size_t chunk_index;
     size_t chunk_offset;
+    size_t used_bytes;
+    size_t high_water_bytes;
 
     struct d3d12_bundle *current_bundle;
     struct d3d12_device *device;
@@ -2820,6 +3613,10 @@ struct vkd3d_queue
     VkQueueFlags vk_queue_flags;
     uint32_t timestamp_bits;
     uint32_t virtual_queue_count;
+    /* Created with a higher VkQueue priority than other queues in the family. */
+    bool high_priority;
+    /* Number of submission batches, used to balance queue assignment. Updated atomically. */
+    uint64_t execute_count;
 
     VkSemaphoreSubmitInfo *wait_semaphores;
     size_t wait_semaphores_size;
@@ -2856,6 +3653,7 @@ struct vkd3d_sparse_memory_bind
 {
     uint32_t dst_tile;
     uint32_t src_tile;
+    uint32_t tile_count;
     VkDeviceMemory vk_memory;
     VkDeviceSize vk_offset;
 };
@@ -2890,6 +3688,8 @@ struct d3d12_command_queue_submission_execute
     struct vkd3d_initial_transition *transitions;
     size_t transition_count;
 
+    uint64_t low_latency_frame_id;
+
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     /* Replays commands in submission order for heavy debug. */
     unsigned int *breadcrumb_indices;
@@ -2904,6 +3704,9 @@ struct d3d12_command_queue_submission_bind_sparse
     enum vkd3d_sparse_memory_bind_mode mode;
     uint32_t bind_count;
     struct vkd3d_sparse_memory_bind *bind_infos;
+    /* Precompacted ranges for UPDATE mode. COPY mode is compacted at execution time. */
+    uint32_t range_count;
+    struct vkd3d_sparse_memory_bind_range *bind_ranges;
     struct d3d12_resource *dst_resource;
     struct d3d12_resource *src_resource;
 };
@@ -2927,6 +3730,18 @@ struct d3d12_command_queue_submission
     };
 };
 
+/* Must be a power of two. */
+#define VKD3D_SUBMISSION_RING_SIZE 1024u
+#define VKD3D_SUBMISSION_RING_MASK (VKD3D_SUBMISSION_RING_SIZE - 1u)
+
+struct d3d12_command_queue_submission_slot
+{
+    /* Equals the ring position when the slot is free,
+     * and the ring position + 1 once a submission has been published. */
+    uint32_t sequence;
+    struct d3d12_command_queue_submission submission;
+};
+
 struct vkd3d_timeline_semaphore
 {
     VkSemaphore vk_semaphore;
@@ -2942,6 +3757,79 @@ struct dxgi_vk_swap_chain_factory
 
 HRESULT dxgi_vk_swap_chain_factory_init(struct d3d12_command_queue *queue, struct dxgi_vk_swap_chain_factory *chain);
 
+/* Low latency, driven either by ID3DLowLatencyDevice or implicitly through Present(). */
+struct dxgi_vk_swap_chain;
+
+struct vkd3d_low_latency_state
+{
+    /* Protects everything below, as well as the VkSwapchainKHR of the registered swapchain,
+     * which the present task can recreate at any time. */
+    pthread_mutex_t lock;
+    struct dxgi_vk_swap_chain *swapchain;
+
+    VkSemaphore vk_sleep_semaphore;
+    uint64_t sleep_count;
+
+    bool mode_enabled;
+    bool boost;
+    uint32_t minimum_interval_us;
+
+    /* Once the application drives sleeps and markers itself, we stop doing so in Present(). */
+    bool application_sleeps;
+    bool application_markers;
+
+    /* Frame ID which new submissions and presents are tagged with. Updated atomically. */
+    uint64_t frame_id;
+};
+
+HRESULT vkd3d_low_latency_state_init(struct vkd3d_low_latency_state *state, struct d3d12_device *device);
+void vkd3d_low_latency_state_cleanup(struct vkd3d_low_latency_state *state, struct d3d12_device *device);
+void vkd3d_low_latency_register_swapchain(struct d3d12_device *device, struct dxgi_vk_swap_chain *chain);
+void vkd3d_low_latency_unregister_swapchain(struct d3d12_device *device, struct dxgi_vk_swap_chain *chain);
+HRESULT vkd3d_low_latency_sleep(struct d3d12_device *device);
+void vkd3d_low_latency_notify_present(struct d3d12_device *device, uint64_t frame_id);
+void vkd3d_low_latency_begin_implicit_frame(struct d3d12_device *device);
+
+/* Must be called with vkd3d_low_latency_state::lock held. */
+void dxgi_vk_swap_chain_low_latency_apply_sleep_mode(struct dxgi_vk_swap_chain *chain);
+bool dxgi_vk_swap_chain_low_latency_sleep(struct dxgi_vk_swap_chain *chain, VkSemaphore vk_semaphore, uint64_t value);
+void dxgi_vk_swap_chain_low_latency_set_marker(struct dxgi_vk_swap_chain *chain, uint64_t frame_id, VkLatencyMarkerNV marker);
+HRESULT dxgi_vk_swap_chain_low_latency_get_timings(struct dxgi_vk_swap_chain *chain, D3D12_LATENCY_RESULTS *results);
+
+#define VKD3D_QUEUE_WATCHDOG_SLOT_COUNT 64
+
+struct vkd3d_queue_watchdog_slot
+{
+    uint64_t timeline_value;
+    uint64_t submit_time_ns;
+    bool reported;
+};
+
+/* Lightweight per-batch GPU timing, only accessed by the submission thread. */
+struct vkd3d_queue_watchdog
+{
+    bool enabled;
+    VkQueryPool vk_query_pool;
+    VkCommandPool vk_command_pool;
+    VkCommandBuffer vk_begin_commands[VKD3D_QUEUE_WATCHDOG_SLOT_COUNT];
+    VkCommandBuffer vk_end_commands[VKD3D_QUEUE_WATCHDOG_SLOT_COUNT];
+    struct vkd3d_queue_watchdog_slot slots[VKD3D_QUEUE_WATCHDOG_SLOT_COUNT];
+    uint32_t read_index;
+    uint32_t write_index;
+
+    uint64_t threshold_ns;
+    double ns_per_tick;
+    uint64_t timestamp_mask;
+
+    uint64_t interval_start_ns;
+    uint64_t interval_busy_ns;
+    uint64_t interval_latency_ns;
+    uint32_t interval_latency_count;
+    uint64_t interval_max_batch_ns;
+    uint32_t interval_batch_count;
+    uint32_t interval_slow_count;
+};
+
 /* ID3D12CommandQueue */
 struct d3d12_command_queue
 {
@@ -2958,13 +3846,17 @@ struct d3d12_command_queue
     pthread_cond_t queue_cond;
     pthread_t submission_thread;
 
-    struct d3d12_command_queue_submission *submissions;
-    size_t submissions_count;
-    size_t submissions_size;
+    /* Bounded lock-free MPSC ring. Producers claim slots with CAS on submission_ring_write,
+     * only the submission thread advances submission_ring_read. */
+    struct d3d12_command_queue_submission_slot *submission_ring;
+    uint32_t submission_ring_write;
+    uint32_t submission_ring_read;
+    uint32_t submission_thread_parked;
     uint64_t drain_count;
     uint64_t queue_drain_count;
 
     struct vkd3d_fence_worker fence_worker;
+    struct vkd3d_queue_watchdog watchdog;
     struct vkd3d_private_store private_store;
     struct dxgi_vk_swap_chain_factory vk_swap_chain_factory;
 };
@@ -2975,6 +3867,11 @@ void d3d12_command_queue_submit_stop(struct d3d12_command_queue *queue);
 void d3d12_command_queue_signal_inline(struct d3d12_command_queue *queue, d3d12_fence_iface *fence, uint64_t value);
 void d3d12_command_queue_enqueue_callback(struct d3d12_command_queue *queue, void (*callback)(void *), void *userdata);
 
+static inline struct d3d12_command_queue *impl_from_ID3D12CommandQueue(ID3D12CommandQueue *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d12_command_queue, ID3D12CommandQueue_iface);
+}
+
 struct vkd3d_execute_indirect_info
 {
     VkPipelineLayout vk_pipeline_layout;
@@ -3004,6 +3901,43 @@ enum vkd3d_patch_command_token
     VKD3D_PATCH_COMMAND_INT_MAX = 0x7fffffff
 };
 
+#define VKD3D_EXECUTE_INDIRECT_CACHE_ENTRY_COUNT 4
+/* Keys whose arguments keep changing are not static and stop being cached. */
+#define VKD3D_EXECUTE_INDIRECT_CACHE_MAX_INVALIDATIONS 8
+
+struct vkd3d_execute_indirect_cache_buffer
+{
+    VkBuffer vk_buffer;
+    VkDeviceAddress va;
+    struct vkd3d_device_memory_allocation memory;
+};
+
+struct vkd3d_execute_indirect_cache_entry
+{
+    uint64_t arg_cookie;
+    uint64_t arg_offset;
+    uint64_t count_cookie;
+    uint64_t count_offset;
+    uint32_t max_command_count;
+    uint32_t arg_generation;
+    uint32_t count_generation;
+    uint32_t invalidation_count;
+    /* Patched count lives right after the patched stream. */
+    VkDeviceSize count_buffer_offset;
+    struct vkd3d_execute_indirect_cache_buffer buffer;
+};
+
+struct vkd3d_execute_indirect_cache
+{
+    pthread_mutex_t mutex;
+    bool enabled;
+    struct vkd3d_execute_indirect_cache_entry entries[VKD3D_EXECUTE_INDIRECT_CACHE_ENTRY_COUNT];
+    /* Replaced buffers may still be in flight, so they live as long as the signature. */
+    struct vkd3d_execute_indirect_cache_buffer *retired_buffers;
+    size_t retired_buffers_size;
+    size_t retired_buffer_count;
+};
+
 /* ID3D12CommandSignature */
 struct d3d12_command_signature
 {
@@ -3030,10 +3964,20 @@ struct d3d12_command_signature
             int32_t source_offsets[D3D12_MAX_ROOT_COST];
             uint32_t dispatch_offset_words;
         } compute;
+        /* VK_EXT_device_generated_commands tokens consume the D3D12 argument layout as-is. */
+        struct
+        {
+            VkIndirectCommandsLayoutEXT layout;
+            VkShaderStageFlags stages;
+        } ext;
     } state_template;
     bool requires_state_template;
+    bool uses_ext_state_template;
     enum vkd3d_pipeline_type pipeline_type;
 
+    /* Patched streams of unchanged ExecuteIndirect arguments, for the NV graphics path. */
+    struct vkd3d_execute_indirect_cache indirect_cache;
+
     struct d3d12_device *device;
 
     struct vkd3d_private_store private_store;
@@ -3052,11 +3996,156 @@ static inline struct d3d12_command_signature *impl_from_ID3D12CommandSignature(I
     return CONTAINING_RECORD(iface, struct d3d12_command_signature, ID3D12CommandSignature_iface);
 }
 
+/* Root signature dedup, keyed on DXBC checksum. Entries hold no references. */
+struct vkd3d_root_signature_cache
+{
+    pthread_mutex_t mutex;
+    struct hash_map map;
+};
+
+HRESULT vkd3d_root_signature_cache_init(struct vkd3d_root_signature_cache *cache);
+void vkd3d_root_signature_cache_cleanup(struct vkd3d_root_signature_cache *cache);
+
+/* Device-wide refcounted store of internal pipeline library blobs (SPIR-V and driver caches),
+ * keyed on content so that multiple pipeline libraries share identical blobs in memory. */
+struct vkd3d_pipeline_blob_store
+{
+    pthread_mutex_t mutex;
+    struct hash_map map;
+};
+
+HRESULT vkd3d_pipeline_blob_store_init(struct vkd3d_pipeline_blob_store *store);
+void vkd3d_pipeline_blob_store_cleanup(struct vkd3d_pipeline_blob_store *store);
+
+/* Memoizes DXBC hashes for pipeline cache compatibility. Entries are keyed on the application
+ * pointer, size and the container checksum, so a hit implies the same bytecode. */
+#define VKD3D_SHADER_HASH_CACHE_SIZE 256
+
+struct vkd3d_shader_hash_cache_entry
+{
+    const void *code;
+    size_t size;
+    uint8_t checksum[16];
+    vkd3d_shader_hash_t hash;
+};
+
+struct vkd3d_shader_hash_cache
+{
+    pthread_mutex_t lock;
+    struct vkd3d_shader_hash_cache_entry entries[VKD3D_SHADER_HASH_CACHE_SIZE];
+};
+
+HRESULT vkd3d_shader_hash_cache_init(struct vkd3d_shader_hash_cache *cache);
+void vkd3d_shader_hash_cache_cleanup(struct vkd3d_shader_hash_cache *cache);
+
+/* Pipeline creation telemetry, active with VKD3D_CONFIG=pipeline_telemetry or when profiling.
+ * Totals are accumulated per phase and source, and the most expensive PSOs are kept for the
+ * report at device teardown. */
+#define VKD3D_PIPELINE_TELEMETRY_WORST_COUNT 16
+
+struct vkd3d_pipeline_telemetry
+{
+    pthread_mutex_t lock;
+    uint64_t next_id;
+    uint64_t total_ns[VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT][VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT];
+    uint32_t total_count[VKD3D_PIPELINE_TELEMETRY_PHASE_COUNT][VKD3D_PIPELINE_TELEMETRY_SOURCE_COUNT];
+    struct vkd3d_pipeline_telemetry_record worst[VKD3D_PIPELINE_TELEMETRY_WORST_COUNT];
+    unsigned int worst_count;
+};
+
+struct vkd3d_pipeline_telemetry_timer
+{
+    uint64_t begin_ns;
+    uint64_t begin_ticks;
+};
+
+HRESULT vkd3d_pipeline_telemetry_init(struct vkd3d_pipeline_telemetry *telemetry);
+void vkd3d_pipeline_telemetry_cleanup(struct vkd3d_pipeline_telemetry *telemetry);
+void vkd3d_pipeline_telemetry_begin(struct vkd3d_pipeline_telemetry_timer *timer);
+void vkd3d_pipeline_telemetry_end(struct d3d12_pipeline_state *state,
+        const struct vkd3d_pipeline_telemetry_timer *timer,
+        enum vkd3d_pipeline_telemetry_phase phase, enum vkd3d_pipeline_telemetry_source source);
+
+/* Device-wide meta operation GPU time, reported per frame about once a second. */
+struct vkd3d_meta_timing
+{
+    spinlock_t lock;
+    double ns_per_tick;
+    uint64_t total_ns[VKD3D_META_TIMING_CATEGORY_COUNT];
+    uint32_t total_count[VKD3D_META_TIMING_CATEGORY_COUNT];
+    uint64_t report_time_ns;
+    uint64_t report_frame_index;
+};
+
+void vkd3d_meta_timing_init(struct vkd3d_meta_timing *timing, struct d3d12_device *device);
+void vkd3d_meta_timing_cleanup(struct vkd3d_meta_timing *timing, struct d3d12_device *device);
+
+/* Device-wide totals of command list statistics, accumulated on submission
+ * and reported per frame about once a second with VKD3D_CONFIG=command_list_stats. */
+struct vkd3d_command_list_stats_report
+{
+    uint64_t totals[VKD3D_COMMAND_LIST_STAT_COUNT];
+    uint64_t list_count;
+    uint64_t frame_count;
+    UINT64 report_time_ns;
+};
+
+void vkd3d_command_list_stats_report_init(struct vkd3d_command_list_stats_report *report);
+void vkd3d_command_list_stats_report_notify_frame(struct vkd3d_command_list_stats_report *report);
+
+/* Host and device memory held by vkd3d-proton's own data structures.
+ * Maintained by the allocation functions, exposed through ID3D12DeviceExt1::GetMemoryFootprint
+ * and logged about once a second with VKD3D_CONFIG=log_memory_budget. */
+enum vkd3d_memory_footprint_category
+{
+    VKD3D_MEMORY_FOOTPRINT_DESCRIPTOR_HEAP = 0,
+    VKD3D_MEMORY_FOOTPRINT_MEMORY_CHUNK_SLACK,
+    VKD3D_MEMORY_FOOTPRINT_SCRATCH_POOL,
+    VKD3D_MEMORY_FOOTPRINT_QUERY_POOL,
+    VKD3D_MEMORY_FOOTPRINT_PIPELINE_SPIRV,
+    VKD3D_MEMORY_FOOTPRINT_PIPELINE_LIBRARY,
+    VKD3D_MEMORY_FOOTPRINT_VIEW_MAP,
+    VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT
+};
+
+struct vkd3d_memory_footprint
+{
+    uint64_t bytes[VKD3D_MEMORY_FOOTPRINT_CATEGORY_COUNT];
+    UINT64 report_time_ns;
+};
+
+static inline void vkd3d_memory_footprint_add(struct vkd3d_memory_footprint *footprint,
+        enum vkd3d_memory_footprint_category category, int64_t delta)
+{
+    if (delta)
+        vkd3d_atomic_uint64_add(&footprint->bytes[category], (uint64_t)delta, vkd3d_memory_order_relaxed);
+}
+
+void vkd3d_memory_footprint_init(struct vkd3d_memory_footprint *footprint);
+void vkd3d_memory_footprint_get(struct vkd3d_memory_footprint *footprint, uint64_t *bytes);
+void vkd3d_memory_footprint_notify_frame(struct vkd3d_memory_footprint *footprint);
+
 /* Static samplers */
+
+/* Root signatures which declare the same static samplers at the same bindings
+ * share one set layout and descriptor set. Refcount is protected by the sampler state mutex. */
+struct vkd3d_static_sampler_set
+{
+    uint32_t refcount;
+    uint32_t binding_count;
+    VkDescriptorSetLayoutBinding *bindings;
+    VkSampler *vk_samplers;
+
+    VkDescriptorSetLayout vk_set_layout;
+    VkDescriptorPool vk_pool;
+    VkDescriptorSet vk_set;
+};
+
 struct vkd3d_sampler_state
 {
     pthread_mutex_t mutex;
     struct hash_map map;
+    struct hash_map set_map;
 
     VkDescriptorPool *vk_descriptor_pools;
     size_t vk_descriptor_pools_size;
@@ -3083,6 +4172,19 @@ struct vkd3d_shader_debug_ring
     pthread_cond_t ring_cond;
     bool device_lost;
     bool active;
+
+    /* With VKD3D_SHADER_DEBUG_RING_BINARY_LOG, raw messages are written here for offline formatting. */
+    FILE *binary_log;
+
+    /* Only touched by the ring thread, reported on cleanup. */
+    struct
+    {
+        uint64_t message_count;
+        uint64_t overflow_count;
+        uint64_t dropped_word_count;
+        uint64_t pressure_count;
+        uint64_t incomplete_count;
+    } stats;
 };
 
 HRESULT vkd3d_sampler_state_init(struct vkd3d_sampler_state *state,
@@ -3096,6 +4198,36 @@ HRESULT vkd3d_sampler_state_allocate_descriptor_set(struct vkd3d_sampler_state *
         VkDescriptorPool *vk_pool);
 void vkd3d_sampler_state_free_descriptor_set(struct vkd3d_sampler_state *state,
         struct d3d12_device *device, VkDescriptorSet vk_set, VkDescriptorPool vk_pool);
+HRESULT vkd3d_sampler_state_acquire_static_sampler_set(struct vkd3d_sampler_state *state,
+        struct d3d12_device *device, unsigned int binding_count, const VkDescriptorSetLayoutBinding *bindings,
+        struct vkd3d_static_sampler_set **set);
+void vkd3d_sampler_state_release_static_sampler_set(struct vkd3d_sampler_state *state,
+        struct d3d12_device *device, struct vkd3d_static_sampler_set *set);
+
+/* Small shader visible descriptor heaps are suballocated from shared descriptor buffers.
+ * Heaps which land in the same block can be switched between without rebinding descriptor buffers. */
+#define VKD3D_DESCRIPTOR_ARENA_BLOCK_SIZE (4u * 1024u * 1024u)
+#define VKD3D_DESCRIPTOR_ARENA_SLOT_SIZE (16u * 1024u)
+#define VKD3D_DESCRIPTOR_ARENA_SLOT_COUNT (VKD3D_DESCRIPTOR_ARENA_BLOCK_SIZE / VKD3D_DESCRIPTOR_ARENA_SLOT_SIZE)
+#define VKD3D_DESCRIPTOR_ARENA_MAX_ALLOCATION_SIZE (256u * 1024u)
+
+struct vkd3d_descriptor_arena_block
+{
+    struct list entry;
+    VkBuffer vk_buffer;
+    VkDeviceAddress va;
+    struct vkd3d_device_memory_allocation device_allocation;
+    uint8_t *host_allocation;
+    VkBufferUsageFlags usage;
+    uint64_t used_slot_mask[VKD3D_DESCRIPTOR_ARENA_SLOT_COUNT / 64];
+    unsigned int allocation_count;
+};
+
+struct vkd3d_descriptor_arena
+{
+    pthread_mutex_t mutex;
+    struct list blocks;
+};
 
 struct vkd3d_global_descriptor_buffer
 {
@@ -3106,6 +4238,8 @@ struct vkd3d_global_descriptor_buffer
         struct vkd3d_device_memory_allocation device_allocation;
         VkBufferUsageFlags usage;
     } resource, sampler;
+
+    struct vkd3d_descriptor_arena resource_arena, sampler_arena;
 };
 
 HRESULT vkd3d_global_descriptor_buffer_init(struct vkd3d_global_descriptor_buffer *global_descriptor_buffer,
@@ -3167,17 +4301,14 @@ struct vkd3d_breadcrumb_counter
     uint32_t end_marker;
 };
 
+/* Kept at 16 bytes, since every draw and dispatch records a few of these. */
 struct vkd3d_breadcrumb_command
 {
     enum vkd3d_breadcrumb_command_type type;
+    VkShaderStageFlagBits shader_stage; /* Only for SET_SHADER_HASH. */
     union
     {
-        struct
-        {
-            vkd3d_shader_hash_t hash;
-            VkShaderStageFlagBits stage;
-        } shader;
-
+        vkd3d_shader_hash_t shader_hash;
         uint32_t word_32bit;
         uint64_t word_64bit;
         uint32_t count;
@@ -3186,6 +4317,11 @@ struct vkd3d_breadcrumb_command
     };
 };
 
+STATIC_ASSERT(sizeof(struct vkd3d_breadcrumb_command) == 16);
+
+/* Trace contexts keep their command storage across reuse, so this is only paid once per context. */
+#define VKD3D_BREADCRUMB_INITIAL_COMMAND_COUNT 1024
+
 struct vkd3d_breadcrumb_command_list_trace_context
 {
     struct vkd3d_breadcrumb_command *commands;
@@ -3211,10 +4347,9 @@ struct vkd3d_breadcrumb_tracer
     struct vkd3d_device_memory_allocation host_buffer_memory;
     struct vkd3d_breadcrumb_counter *mapped;
 
+    /* Contexts are claimed and released with atomics on their locked field. */
     struct vkd3d_breadcrumb_command_list_trace_context *trace_contexts;
-    size_t trace_context_index;
-
-    pthread_mutex_t lock;
+    uint32_t trace_context_index;
 };
 
 HRESULT vkd3d_breadcrumb_tracer_init(struct vkd3d_breadcrumb_tracer *tracer, struct d3d12_device *device);
@@ -3558,6 +4693,108 @@ HRESULT vkd3d_memory_info_init(struct vkd3d_memory_info *info,
 void vkd3d_memory_info_cleanup(struct vkd3d_memory_info *info,
         struct d3d12_device *device);
 
+/* Background residency manager for EnqueueMakeResident(). */
+struct vkd3d_residency_object
+{
+    struct d3d12_heap *heap;
+    struct d3d12_resource *resource;
+};
+
+struct vkd3d_residency_request
+{
+    struct vkd3d_residency_object *objects;
+    size_t object_count;
+    ID3D12Fence *fence;
+    UINT64 fence_value;
+};
+
+/* Re-evaluate budgets after this much device-local memory was allocated, or this many frames have passed. */
+#define VKD3D_RESIDENCY_BALANCE_ALLOCATION_THRESHOLD (64 * 1024 * 1024)
+#define VKD3D_RESIDENCY_BALANCE_FRAME_INTERVAL 60
+/* Allocations used within this many frames are never demoted. */
+#define VKD3D_RESIDENCY_HOT_FRAME_COUNT 4
+
+struct vkd3d_residency_manager
+{
+    struct d3d12_device *device;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool thread_active;
+    bool should_exit;
+
+    struct vkd3d_residency_request *requests;
+    size_t requests_size;
+    size_t requests_count;
+
+    /* Automatic demotion of cold allocations while device-local heaps are over budget. */
+    bool demotion_enabled;
+    bool balance_requested;
+    struct list tracked_objects;
+    VkDeviceSize allocated_since_balance;
+    uint64_t frame_index;
+};
+
+HRESULT vkd3d_residency_manager_init(struct vkd3d_residency_manager *manager, struct d3d12_device *device);
+void vkd3d_residency_manager_cleanup(struct vkd3d_residency_manager *manager);
+void vkd3d_residency_manager_register(struct vkd3d_residency_manager *manager,
+        priority_info *info, const struct vkd3d_device_memory_allocation *allocation);
+void vkd3d_residency_manager_unregister(struct vkd3d_residency_manager *manager, priority_info *info);
+void vkd3d_residency_manager_notify_allocation(struct vkd3d_residency_manager *manager,
+        uint32_t vk_memory_type, VkDeviceSize size, bool failed);
+void vkd3d_residency_manager_notify_frame(struct vkd3d_residency_manager *manager);
+
+static inline void vkd3d_residency_manager_mark_use(struct vkd3d_residency_manager *manager, priority_info *info)
+{
+    if (info->tracked)
+    {
+        vkd3d_atomic_uint64_store_explicit(&info->last_use_frame,
+                vkd3d_atomic_uint64_load_explicit(&manager->frame_index, vkd3d_memory_order_relaxed),
+                vkd3d_memory_order_relaxed);
+    }
+}
+
+/* Device timestamps are correlated with vkd3d_get_current_time_ns() in the background,
+ * so that timestamp conversions never have to go through the driver. */
+#define VKD3D_CLOCK_CALIBRATION_SAMPLE_COUNT 16
+
+struct vkd3d_clock_calibration_sample
+{
+    uint64_t host_ns;
+    uint64_t gpu_ticks;
+};
+
+struct vkd3d_clock_calibration
+{
+    struct d3d12_device *device;
+
+    pthread_mutex_t mutex;
+    condvar_reltime_t cond;
+    pthread_t thread;
+    bool thread_active;
+    bool should_exit;
+
+    /* Linear drift model fitted over the most recent samples, covered by model_lock. */
+    spinlock_t model_lock;
+    bool valid;
+    struct vkd3d_clock_calibration_sample anchor;
+    double ticks_per_ns;
+
+    /* Only accessed by the calibration thread after init. */
+    struct vkd3d_clock_calibration_sample samples[VKD3D_CLOCK_CALIBRATION_SAMPLE_COUNT];
+    uint32_t sample_count;
+    uint32_t sample_index;
+    double nominal_ticks_per_ns;
+};
+
+HRESULT vkd3d_clock_calibration_init(struct vkd3d_clock_calibration *calibration, struct d3d12_device *device);
+void vkd3d_clock_calibration_cleanup(struct vkd3d_clock_calibration *calibration);
+bool vkd3d_clock_calibration_get_gpu_ticks(struct vkd3d_clock_calibration *calibration,
+        uint64_t host_ns, uint64_t *gpu_ticks);
+bool vkd3d_clock_calibration_get_host_ns(struct vkd3d_clock_calibration *calibration,
+        uint64_t gpu_ticks, uint64_t *host_ns);
+
 /* meta operations */
 struct vkd3d_clear_uav_args
 {
@@ -3566,15 +4803,27 @@ struct vkd3d_clear_uav_args
     VkExtent2D extent;
 };
 
+/* Meta pipeline which is compiled on first use. Lookups after that are a single atomic load. */
+struct vkd3d_meta_pipeline_slot
+{
+    uint32_t state;
+    VkPipeline vk_pipeline;
+    VkPipelineLayout vk_pipeline_layout;
+    const uint32_t *code;
+    size_t code_size;
+    VkSpecializationInfo spec_info;
+    bool has_spec_info;
+};
+
 struct vkd3d_clear_uav_pipelines
 {
-    VkPipeline buffer;
-    VkPipeline buffer_raw;
-    VkPipeline image_1d;
-    VkPipeline image_2d;
-    VkPipeline image_3d;
-    VkPipeline image_1d_array;
-    VkPipeline image_2d_array;
+    struct vkd3d_meta_pipeline_slot buffer;
+    struct vkd3d_meta_pipeline_slot buffer_raw;
+    struct vkd3d_meta_pipeline_slot image_1d;
+    struct vkd3d_meta_pipeline_slot image_2d;
+    struct vkd3d_meta_pipeline_slot image_3d;
+    struct vkd3d_meta_pipeline_slot image_1d_array;
+    struct vkd3d_meta_pipeline_slot image_2d_array;
 };
 
 struct vkd3d_clear_uav_ops
@@ -3670,10 +4919,21 @@ struct vkd3d_swapchain_pipeline
     struct vkd3d_swapchain_pipeline_key key;
 };
 
+struct vkd3d_swapchain_compute_args
+{
+    VkExtent2D viewport_extent;
+    VkExtent2D image_extent;
+    uint32_t blank;
+};
+
+#define VKD3D_SWAPCHAIN_COMPUTE_WORKGROUP_SIZE (8)
+
 struct vkd3d_swapchain_ops
 {
     VkDescriptorSetLayout vk_set_layouts[2];
     VkPipelineLayout vk_pipeline_layouts[2];
+    VkDescriptorSetLayout vk_compute_set_layouts[2];
+    VkPipelineLayout vk_compute_pipeline_layouts[2];
     VkShaderModule vk_vs_module;
     VkShaderModule vk_fs_module;
     VkSampler vk_samplers[2];
@@ -3699,6 +4959,24 @@ struct vkd3d_query_resolve_args
     uint32_t query_count;
 };
 
+/* Binary occlusion resolves from one flush are merged into a single dispatch
+ * with one workgroup row per range, see cs_resolve_binary_queries_batch.comp. */
+#define VKD3D_QUERY_RESOLVE_MAX_BINARY_RANGES 256
+
+struct vkd3d_query_resolve_range
+{
+    VkDeviceAddress dst_va;
+    VkDeviceAddress src_va;
+    uint32_t query_count;
+    uint32_t padding;
+};
+
+struct vkd3d_query_resolve_batch_args
+{
+    VkDeviceAddress ranges_va;
+    uint32_t range_count;
+};
+
 struct vkd3d_query_gather_args
 {
     VkDeviceAddress dst_va;
@@ -3720,6 +4998,8 @@ struct vkd3d_query_ops
     VkPipeline vk_gather_so_statistics_pipeline;
     VkPipelineLayout vk_resolve_pipeline_layout;
     VkPipeline vk_resolve_binary_pipeline;
+    VkPipelineLayout vk_resolve_batch_pipeline_layout;
+    VkPipeline vk_resolve_binary_batch_pipeline;
 };
 
 HRESULT vkd3d_query_ops_init(struct vkd3d_query_ops *meta_query_ops,
@@ -3772,7 +5052,7 @@ struct vkd3d_predicate_ops
 {
     VkPipelineLayout vk_command_pipeline_layout;
     VkPipelineLayout vk_resolve_pipeline_layout;
-    VkPipeline vk_command_pipelines[VKD3D_PREDICATE_COMMAND_COUNT];
+    struct vkd3d_meta_pipeline_slot command_pipelines[VKD3D_PREDICATE_COMMAND_COUNT];
     VkPipeline vk_resolve_pipeline;
     uint32_t data_sizes[VKD3D_PREDICATE_COMMAND_COUNT];
 };
@@ -3808,12 +5088,26 @@ struct vkd3d_multi_dispatch_indirect_state_args
     uint32_t dispatch_offset_words;
 };
 
+struct vkd3d_execute_indirect_compact_args
+{
+    VkDeviceAddress indirect_va;
+    VkDeviceAddress count_va;
+    VkDeviceAddress sequence_indices_va;
+    VkDeviceAddress sequence_count_va;
+    uint32_t stride_words;
+    uint32_t action_offset_words;
+    uint32_t action_word_count;
+    uint32_t max_commands;
+};
+
 struct vkd3d_multi_dispatch_indirect_ops
 {
     VkPipelineLayout vk_multi_dispatch_indirect_layout;
     VkPipelineLayout vk_multi_dispatch_indirect_state_layout;
+    VkPipelineLayout vk_execute_indirect_compact_layout;
     VkPipeline vk_multi_dispatch_indirect_pipeline;
     VkPipeline vk_multi_dispatch_indirect_state_pipeline;
+    VkPipeline vk_execute_indirect_compact_pipeline;
 };
 
 HRESULT vkd3d_multi_dispatch_indirect_ops_init(struct vkd3d_multi_dispatch_indirect_ops *meta_predicate_ops,
@@ -3821,6 +5115,36 @@ HRESULT vkd3d_multi_dispatch_indirect_ops_init(struct vkd3d_multi_dispatch_indir
 void vkd3d_multi_dispatch_indirect_ops_cleanup(struct vkd3d_multi_dispatch_indirect_ops *meta_predicate_ops,
         struct d3d12_device *device);
 
+struct vkd3d_write_buffer_immediate_entry
+{
+    VkDeviceAddress va;
+    uint32_t value;
+    uint32_t padding;
+};
+
+struct vkd3d_write_buffer_immediate_args
+{
+    VkDeviceAddress entries_va;
+    uint32_t entry_count;
+};
+
+struct vkd3d_write_buffer_immediate_info
+{
+    VkPipelineLayout vk_pipeline_layout;
+    VkPipeline vk_pipeline;
+};
+
+struct vkd3d_write_buffer_immediate_ops
+{
+    VkPipelineLayout vk_pipeline_layout;
+    VkPipeline vk_pipeline;
+};
+
+HRESULT vkd3d_write_buffer_immediate_ops_init(struct vkd3d_write_buffer_immediate_ops *meta_wbi_ops,
+        struct d3d12_device *device);
+void vkd3d_write_buffer_immediate_ops_cleanup(struct vkd3d_write_buffer_immediate_ops *meta_wbi_ops,
+        struct d3d12_device *device);
+
 struct vkd3d_execute_indirect_args
 {
     VkDeviceAddress template_va;
@@ -3834,6 +5158,9 @@ struct vkd3d_execute_indirect_args
     /* Arbitrary tag used for debug version of state patcher. Debug messages from tag 0 are ignored. */
     uint32_t debug_tag;
     uint32_t implicit_instance;
+
+    /* Optional list of API command indices produced by the compaction pass. */
+    VkDeviceAddress sequence_indices_va;
 };
 
 struct vkd3d_execute_indirect_pipeline
@@ -3865,6 +5192,7 @@ struct vkd3d_meta_ops_common
 struct vkd3d_meta_ops
 {
     struct d3d12_device *device;
+    struct vkd3d_job prewarm_job;
     struct vkd3d_meta_ops_common common;
     struct vkd3d_clear_uav_ops clear_uav;
     struct vkd3d_copy_image_ops copy_image;
@@ -3873,6 +5201,7 @@ struct vkd3d_meta_ops
     struct vkd3d_predicate_ops predicate;
     struct vkd3d_execute_indirect_ops execute_indirect;
     struct vkd3d_multi_dispatch_indirect_ops multi_dispatch_indirect;
+    struct vkd3d_write_buffer_immediate_ops write_buffer_immediate;
 };
 
 HRESULT vkd3d_meta_ops_init(struct vkd3d_meta_ops *meta_ops, struct d3d12_device *device);
@@ -3905,10 +5234,21 @@ bool vkd3d_meta_get_query_gather_pipeline(struct vkd3d_meta_ops *meta_ops,
 void vkd3d_meta_get_predicate_pipeline(struct vkd3d_meta_ops *meta_ops,
         enum vkd3d_predicate_command_type command_type, struct vkd3d_predicate_command_info *info);
 
+static inline VkExtent3D vkd3d_meta_get_write_buffer_immediate_workgroup_size()
+{
+    VkExtent3D result = { 64, 1, 1 };
+    return result;
+}
+
+void vkd3d_meta_get_write_buffer_immediate_pipeline(struct vkd3d_meta_ops *meta_ops,
+        struct vkd3d_write_buffer_immediate_info *info);
+
 void vkd3d_meta_get_multi_dispatch_indirect_pipeline(struct vkd3d_meta_ops *meta_ops,
         struct vkd3d_multi_dispatch_indirect_info *info);
 void vkd3d_meta_get_multi_dispatch_indirect_state_pipeline(struct vkd3d_meta_ops *meta_ops,
         struct vkd3d_multi_dispatch_indirect_info *info);
+void vkd3d_meta_get_execute_indirect_compact_pipeline(struct vkd3d_meta_ops *meta_ops,
+        struct vkd3d_multi_dispatch_indirect_info *info);
 
 static inline uint32_t vkd3d_meta_get_multi_dispatch_indirect_workgroup_size(void)
 {
@@ -3944,6 +5284,7 @@ struct vkd3d_physical_device_info
     VkPhysicalDeviceFragmentShadingRatePropertiesKHR fragment_shading_rate_properties;
     VkPhysicalDeviceConservativeRasterizationPropertiesEXT conservative_rasterization_properties;
     VkPhysicalDeviceDeviceGeneratedCommandsPropertiesNV device_generated_commands_properties_nv;
+    VkPhysicalDeviceDeviceGeneratedCommandsPropertiesEXT device_generated_commands_properties_ext;
     VkPhysicalDeviceMeshShaderPropertiesEXT mesh_shader_properties;
     VkPhysicalDeviceShaderModuleIdentifierPropertiesEXT shader_module_identifier_properties;
     VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_buffer_properties;
@@ -3976,6 +5317,8 @@ struct vkd3d_physical_device_info
     VkPhysicalDeviceCoherentMemoryFeaturesAMD device_coherent_memory_features_amd;
     VkPhysicalDeviceRayTracingMaintenance1FeaturesKHR ray_tracing_maintenance1_features;
     VkPhysicalDeviceDeviceGeneratedCommandsFeaturesNV device_generated_commands_features_nv;
+    VkPhysicalDeviceDeviceGeneratedCommandsFeaturesEXT device_generated_commands_features_ext;
+    VkPhysicalDeviceMaintenance5FeaturesKHR maintenance5_features;
     VkPhysicalDeviceMeshShaderFeaturesEXT mesh_shader_features;
     VkPhysicalDeviceShaderModuleIdentifierFeaturesEXT shader_module_identifier_features;
     VkPhysicalDevicePresentIdFeaturesKHR present_id_features;
@@ -3987,6 +5330,7 @@ struct vkd3d_physical_device_info
     VkPhysicalDeviceFragmentShaderInterlockFeaturesEXT fragment_shader_interlock_features;
     VkPhysicalDeviceMemoryPriorityFeaturesEXT memory_priority_features;
     VkPhysicalDevicePageableDeviceLocalMemoryFeaturesEXT pageable_device_memory_features;
+    VkPhysicalDeviceAntiLagFeaturesAMD anti_lag_features_amd;
 
     VkPhysicalDeviceFeatures2 features2;
 
@@ -4041,24 +5385,51 @@ struct vkd3d_queue_family_info
     VkQueueFlags vk_queue_flags;
 };
 
-#define VKD3D_CACHED_COMMAND_ALLOCATOR_COUNT 8
-struct vkd3d_cached_command_allocator
+/* Command pools released by destroyed allocators are reset and kept around for reuse,
+ * since some applications create and destroy allocators every frame or job.
+ * Each queue family has a fixed array of slots which are claimed and released with atomics.
+ * The number of usable slots starts at zero and grows whenever an allocator has to create
+ * a new pool after pools were released before, so non-churny applications retain nothing. */
+#define VKD3D_COMMAND_POOL_CACHE_MAX_POOLS 32
+/* Initial high-water mark with VKD3D_CONFIG_FLAG_RECYCLE_COMMAND_POOLS. */
+#define VKD3D_COMMAND_POOL_CACHE_FORCED_POOLS 8
+
+struct vkd3d_command_pool_cache_family
 {
-    VkCommandPool vk_command_pool;
-    uint32_t vk_family_index;
+    UINT64 vk_command_pools[VKD3D_COMMAND_POOL_CACHE_MAX_POOLS]; /* VkCommandPool, 0 if free */
+    uint32_t high_water_mark;
+    uint32_t cached_count;
 };
 
+struct vkd3d_command_pool_cache
+{
+    struct vkd3d_command_pool_cache_family families[VKD3D_QUEUE_FAMILY_COUNT];
+    uint32_t release_count;
+
+    /* Statistics, only used for reporting. */
+    uint32_t hit_count;
+    uint32_t miss_count;
+    uint32_t drop_count;
+    uint32_t recycled_command_buffer_count;
+};
+
+void vkd3d_command_pool_cache_init(struct vkd3d_command_pool_cache *cache);
+void vkd3d_command_pool_cache_cleanup(struct vkd3d_command_pool_cache *cache, struct d3d12_device *device);
+
 /* ID3D12Device */
 typedef ID3D12Device10 d3d12_device_iface;
 
 struct vkd3d_descriptor_qa_global_info;
 struct vkd3d_descriptor_qa_heap_buffer_data;
 
-/* ID3D12DeviceExt */
-typedef ID3D12DeviceExt d3d12_device_vkd3d_ext_iface;
+/* ID3D12DeviceExt2 */
+typedef ID3D12DeviceExt2 d3d12_device_vkd3d_ext_iface;
 
-/* ID3D12DXVKInteropDevice */
-typedef ID3D12DXVKInteropDevice d3d12_dxvk_interop_device_iface;
+/* ID3D12DXVKInteropDevice1 */
+typedef ID3D12DXVKInteropDevice1 d3d12_dxvk_interop_device_iface;
+
+/* ID3DLowLatencyDevice */
+typedef ID3DLowLatencyDevice d3d_low_latency_device_iface;
 
 struct d3d12_device_scratch_pool
 {
@@ -4071,6 +5442,7 @@ struct d3d12_device
     d3d12_device_iface ID3D12Device_iface;
     d3d12_device_vkd3d_ext_iface ID3D12DeviceExt_iface;
     d3d12_dxvk_interop_device_iface ID3D12DXVKInteropDevice_iface;
+    d3d_low_latency_device_iface ID3DLowLatencyDevice_iface;
     LONG refcount;
 
     VkDevice vk_device;
@@ -4101,14 +5473,14 @@ struct d3d12_device
 
     struct vkd3d_memory_transfer_queue memory_transfers;
     struct vkd3d_memory_allocator memory_allocator;
+    struct vkd3d_shared_fence_worker shared_fence_worker;
 
     struct d3d12_device_scratch_pool scratch_pools[VKD3D_SCRATCH_POOL_KIND_COUNT];
 
     struct vkd3d_query_pool query_pools[VKD3D_VIRTUAL_QUERY_POOL_COUNT];
     size_t query_pool_count;
 
-    struct vkd3d_cached_command_allocator cached_command_allocators[VKD3D_CACHED_COMMAND_ALLOCATOR_COUNT];
-    size_t cached_command_allocator_count;
+    struct vkd3d_command_pool_cache command_pool_cache;
 
     uint32_t *descriptor_heap_gpu_vas;
     size_t descriptor_heap_gpu_va_count;
@@ -4123,16 +5495,41 @@ struct d3d12_device
     const struct vkd3d_format_compatibility_list *format_compatibility_lists;
     struct vkd3d_bindless_state bindless_state;
     struct vkd3d_memory_info memory_info;
+    struct vkd3d_residency_manager residency_manager;
+    struct vkd3d_clock_calibration clock_calibration;
+    struct vkd3d_resource_recycle_pool resource_recycle_pool;
+    struct vkd3d_resource_destroy_queue resource_destroy_queue;
+    struct vkd3d_memory_bind_queue memory_binds;
     struct vkd3d_meta_ops meta_ops;
     struct vkd3d_view_map sampler_map;
+    struct vkd3d_sampler_payload_cache sampler_payload_cache;
     struct vkd3d_sampler_state sampler_state;
+    struct vkd3d_root_signature_cache root_signature_cache;
+    struct vkd3d_pipeline_blob_store pipeline_blob_store;
+    struct vkd3d_pipeline_telemetry pipeline_telemetry;
+    struct vkd3d_meta_timing meta_timing;
+    struct vkd3d_memory_footprint memory_footprint;
+    struct vkd3d_command_list_stats_report command_list_stats;
+    struct vkd3d_shader_hash_cache shader_hash_cache;
+    struct vkd3d_image_allocation_info_cache image_allocation_info_cache;
+    struct vkd3d_image_create_info_cache image_create_info_cache;
+    struct vkd3d_cuda_handle_cache cuda_handle_cache;
+    struct vkd3d_low_latency_state low_latency;
     struct vkd3d_shader_debug_ring debug_ring;
     struct vkd3d_pipeline_library_disk_cache disk_cache;
+    /* Shared by background work which is not latency critical, e.g. async PSO compiles,
+     * disk cache serialization and meta pipeline prewarming. */
+    struct vkd3d_job_pool job_pool;
+    /* Number of threads, including the caller, that large CPU-side subresource copies are split across. */
+    uint32_t subresource_copy_thread_count;
+    struct vkd3d_shader_spirv_cache spirv_cache;
     struct vkd3d_global_descriptor_buffer global_descriptor_buffer;
     rwlock_t vertex_input_lock;
     struct hash_map vertex_input_pipelines;
+    struct vkd3d_pipeline_library_lookup_cache vertex_input_lookup;
     rwlock_t fragment_output_lock;
     struct hash_map fragment_output_pipelines;
+    struct vkd3d_pipeline_library_lookup_cache fragment_output_lookup;
 #ifdef VKD3D_ENABLE_BREADCRUMBS
     struct vkd3d_breadcrumb_tracer breadcrumb_tracer;
 #endif
@@ -4147,7 +5544,7 @@ HRESULT d3d12_device_create(struct vkd3d_instance *instance,
 struct vkd3d_queue_family_info *d3d12_device_get_vkd3d_queue_family(struct d3d12_device *device,
         D3D12_COMMAND_LIST_TYPE type);
 struct vkd3d_queue *d3d12_device_allocate_vkd3d_queue(struct d3d12_device *device,
-        struct vkd3d_queue_family_info *queue_family);
+        struct vkd3d_queue_family_info *queue_family, bool high_priority);
 void d3d12_device_unmap_vkd3d_queue(struct d3d12_device *device,
         struct vkd3d_queue *queue);
 bool d3d12_device_is_uma(struct d3d12_device *device, bool *coherent);
@@ -4178,11 +5575,11 @@ bool d3d12_device_validate_shader_meta(struct d3d12_device *device, const struct
 
 HRESULT d3d12_device_get_scratch_buffer(struct d3d12_device *device, enum vkd3d_scratch_pool_kind kind,
         VkDeviceSize min_size, uint32_t memory_types, struct vkd3d_scratch_buffer *scratch);
-void d3d12_device_return_scratch_buffer(struct d3d12_device *device, enum vkd3d_scratch_pool_kind kind,
-        const struct vkd3d_scratch_buffer *scratch);
+void d3d12_device_return_scratch_buffers(struct d3d12_device *device, enum vkd3d_scratch_pool_kind kind,
+        const struct vkd3d_scratch_buffer *scratch_buffers, size_t count);
 
 HRESULT d3d12_device_get_query_pool(struct d3d12_device *device, uint32_t type_index, struct vkd3d_query_pool *pool);
-void d3d12_device_return_query_pool(struct d3d12_device *device, const struct vkd3d_query_pool *pool);
+void d3d12_device_return_query_pools(struct d3d12_device *device, const struct vkd3d_query_pool *pools, size_t count);
 
 uint64_t d3d12_device_get_descriptor_heap_gpu_va(struct d3d12_device *device, D3D12_DESCRIPTOR_HEAP_TYPE type);
 void d3d12_device_return_descriptor_heap_gpu_va(struct d3d12_device *device, uint64_t va);
@@ -4192,6 +5589,16 @@ static inline bool d3d12_device_uses_descriptor_buffers(const struct d3d12_devic
     return device->global_descriptor_buffer.resource.va != 0;
 }
 
+static inline bool d3d12_device_supports_nv_low_latency(const struct d3d12_device *device)
+{
+    return device->vk_info.NV_low_latency2 && device->device_info.present_id_features.presentId;
+}
+
+static inline bool d3d12_device_supports_amd_anti_lag(const struct d3d12_device *device)
+{
+    return device->vk_info.AMD_anti_lag && device->device_info.anti_lag_features_amd.antiLag;
+}
+
 static inline bool is_cpu_accessible_heap(const D3D12_HEAP_PROPERTIES *properties)
 {
     if (properties->Type == D3D12_HEAP_TYPE_DEFAULT)
@@ -4420,10 +5827,11 @@ struct d3d12_state_object
     D3D12_STATE_OBJECT_FLAGS flags;
     struct d3d12_device *device;
 
-    /* Could potentially be a hashmap. */
     struct d3d12_state_object_identifier *exports;
     size_t exports_size;
     size_t exports_count;
+    /* Maps both mangled and plain export names to indices in exports[]. */
+    struct hash_map export_map;
 
     struct vkd3d_shader_library_entry_point *entry_points;
     size_t entry_points_count;
@@ -4531,7 +5939,7 @@ static inline bool vkd3d_format_is_compressed(const struct vkd3d_format *format)
 
 void vkd3d_format_copy_data(const struct vkd3d_format *format, const uint8_t *src,
         unsigned int src_row_pitch, unsigned int src_slice_pitch, uint8_t *dst, unsigned int dst_row_pitch,
-        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d);
+        unsigned int dst_slice_pitch, unsigned int w, unsigned int h, unsigned int d, bool dst_write_combined);
 
 const struct vkd3d_format *vkd3d_get_format(const struct d3d12_device *device,
         DXGI_FORMAT dxgi_format, bool depth_stencil);
@@ -4729,6 +6137,36 @@ struct vkd3d_view_key
 struct vkd3d_view *vkd3d_view_map_create_view(struct vkd3d_view_map *view_map,
         struct d3d12_device *device, const struct vkd3d_view_key *key);
 
+/* Lock-free insert-only cache of embedded sampler descriptor payloads,
+ * so that recreating a known sampler is a plain memcpy. */
+#define VKD3D_SAMPLER_PAYLOAD_CACHE_SIZE 2048u
+#define VKD3D_SAMPLER_PAYLOAD_CACHE_MAX_PROBES 16u
+#define VKD3D_SAMPLER_PAYLOAD_MAX_SIZE 64u
+
+enum vkd3d_sampler_payload_entry_state
+{
+    VKD3D_SAMPLER_PAYLOAD_ENTRY_EMPTY = 0,
+    VKD3D_SAMPLER_PAYLOAD_ENTRY_WRITING,
+    VKD3D_SAMPLER_PAYLOAD_ENTRY_READY,
+};
+
+struct vkd3d_sampler_payload_entry
+{
+    uint32_t state;
+    uint32_t hash;
+    D3D12_SAMPLER_DESC desc;
+    uint8_t payload[VKD3D_SAMPLER_PAYLOAD_MAX_SIZE];
+};
+
+struct vkd3d_sampler_payload_cache
+{
+    struct vkd3d_sampler_payload_entry *entries;
+    size_t payload_size;
+};
+
+HRESULT vkd3d_sampler_payload_cache_init(struct vkd3d_sampler_payload_cache *cache, struct d3d12_device *device);
+void vkd3d_sampler_payload_cache_cleanup(struct vkd3d_sampler_payload_cache *cache);
+
 /* Acceleration structure helpers. */
 struct vkd3d_acceleration_structure_build_info
 {
@@ -4744,13 +6182,31 @@ struct vkd3d_acceleration_structure_build_info
     VkAccelerationStructureBuildGeometryInfoKHR build_info;
     VkAccelerationStructureGeometryKHR *geometries;
     uint32_t *primitive_counts;
+    /* Storage beyond the stack arrays is owned by an arena rather than the heap. */
+    bool uses_arena;
 };
 
+/* Linear allocator for build infos which exceed the stack arrays. All allocations are
+ * released at once on reset, and after the first few builds nothing is allocated anymore. */
+struct vkd3d_acceleration_structure_build_arena
+{
+    void **blocks;
+    size_t blocks_size;
+    size_t blocks_count;
+    size_t block_size;
+    size_t block_offset;
+    size_t total_size;
+};
+
+void vkd3d_acceleration_structure_build_arena_reset(struct vkd3d_acceleration_structure_build_arena *arena);
+void vkd3d_acceleration_structure_build_arena_cleanup(struct vkd3d_acceleration_structure_build_arena *arena);
+
 void vkd3d_acceleration_structure_build_info_cleanup(
         struct vkd3d_acceleration_structure_build_info *info);
 bool vkd3d_acceleration_structure_convert_inputs(const struct d3d12_device *device,
         struct vkd3d_acceleration_structure_build_info *info,
-        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS *desc);
+        const D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS *desc,
+        struct vkd3d_acceleration_structure_build_arena *arena);
 void vkd3d_acceleration_structure_emit_postbuild_info(
         struct d3d12_command_list *list,
         const D3D12_RAYTRACING_ACCELERATION_STRUCTURE_POSTBUILD_INFO_DESC *desc,
@@ -43,12 +43,15 @@ enum vkd3d_meta_copy_mode
 #include <cs_clear_uav_image_3d_uint.h>
 #include <cs_predicate_command.h>
 #include <cs_resolve_binary_queries.h>
+#include <cs_resolve_binary_queries_batch.h>
 #include <cs_resolve_predicate.h>
 #include <cs_resolve_query.h>
 #include <cs_execute_indirect_patch.h>
 #include <cs_execute_indirect_patch_debug_ring.h>
+#include <cs_execute_indirect_compact.h>
 #include <cs_execute_indirect_multi_dispatch.h>
 #include <cs_execute_indirect_multi_dispatch_state.h>
+#include <cs_write_buffer_immediate.h>
 #include <vs_fullscreen_layer.h>
 #include <vs_fullscreen.h>
 #include <gs_fullscreen.h>
@@ -44,6 +44,7 @@ VK_INSTANCE_PFN(vkGetPhysicalDeviceFormatProperties)
 VK_INSTANCE_PFN(vkGetPhysicalDeviceFormatProperties2)
 VK_INSTANCE_PFN(vkGetPhysicalDeviceImageFormatProperties)
 VK_INSTANCE_PFN(vkGetPhysicalDeviceMemoryProperties)
+VK_INSTANCE_PFN(vkGetPhysicalDeviceMemoryProperties2)
 VK_INSTANCE_PFN(vkGetPhysicalDeviceProperties)
 VK_INSTANCE_PFN(vkGetPhysicalDeviceQueueFamilyProperties)
 VK_INSTANCE_PFN(vkGetPhysicalDeviceSparseImageFormatProperties)
@@ -197,6 +198,13 @@ VK_DEVICE_PFN(vkCmdSetDepthWriteEnable)
 /* VK_KHR_push_descriptor */
 VK_DEVICE_EXT_PFN(vkCmdPushDescriptorSetKHR)
 
+/* VK_KHR_deferred_host_operations */
+VK_DEVICE_EXT_PFN(vkCreateDeferredOperationKHR)
+VK_DEVICE_EXT_PFN(vkDestroyDeferredOperationKHR)
+VK_DEVICE_EXT_PFN(vkGetDeferredOperationMaxConcurrencyKHR)
+VK_DEVICE_EXT_PFN(vkGetDeferredOperationResultKHR)
+VK_DEVICE_EXT_PFN(vkDeferredOperationJoinKHR)
+
 /* VK_KHR_ray_tracing_pipeline */
 VK_DEVICE_EXT_PFN(vkCreateRayTracingPipelinesKHR)
 VK_DEVICE_EXT_PFN(vkGetRayTracingShaderGroupHandlesKHR)
@@ -318,6 +326,21 @@ VK_DEVICE_EXT_PFN(vkDestroyIndirectCommandsLayoutNV)
 VK_DEVICE_EXT_PFN(vkGetGeneratedCommandsMemoryRequirementsNV)
 VK_DEVICE_EXT_PFN(vkCmdExecuteGeneratedCommandsNV)
 
+/* VK_NV_low_latency2 */
+VK_DEVICE_EXT_PFN(vkSetLatencySleepModeNV)
+VK_DEVICE_EXT_PFN(vkLatencySleepNV)
+VK_DEVICE_EXT_PFN(vkSetLatencyMarkerNV)
+VK_DEVICE_EXT_PFN(vkGetLatencyTimingsNV)
+
+/* VK_AMD_anti_lag */
+VK_DEVICE_EXT_PFN(vkAntiLagUpdateAMD)
+
+/* VK_EXT_device_generated_commands */
+VK_DEVICE_EXT_PFN(vkCreateIndirectCommandsLayoutEXT)
+VK_DEVICE_EXT_PFN(vkDestroyIndirectCommandsLayoutEXT)
+VK_DEVICE_EXT_PFN(vkGetGeneratedCommandsMemoryRequirementsEXT)
+VK_DEVICE_EXT_PFN(vkCmdExecuteGeneratedCommandsEXT)
+
 /* VK_EXT_shader_module_identifier */
 VK_DEVICE_EXT_PFN(vkGetShaderModuleIdentifierEXT)
 
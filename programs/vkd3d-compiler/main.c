@@ -19,12 +19,16 @@
 #define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
 
 #include <fcntl.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 
 #include "vkd3d_common.h"
+#include "vkd3d_atomic.h"
+#include "vkd3d_string.h"
+#include "vkd3d_threads.h"
 #include "vkd3d_shader.h"
 
 static bool read_shader(struct vkd3d_shader_code *shader, const char *filename)
@@ -102,7 +106,9 @@ static void print_usage(const char *program_name)
     fprintf(stderr, "usage: %s", program_name);
     for (i = 0; i < ARRAY_SIZE(compiler_options); ++i)
         fprintf(stderr, " [%s]", compiler_options[i].name);
-    fprintf(stderr, " [-o <out_spirv_filename>] <dxbc_filename>\n");
+    fprintf(stderr, " [-o <out_spirv_filename>] [--benchmark <iterations>] <dxbc_filename>\n");
+    fprintf(stderr, "       %s --batch [-j <threads>] [-o <out_directory>] <manifest_filename | ->\n", program_name);
+    fprintf(stderr, "In batch mode, the manifest lists one input file per line and outputs are named <hash>.spv.\n");
 }
 
 struct options
@@ -110,6 +116,9 @@ struct options
     const char *filename;
     const char *output_filename;
     unsigned int compiler_options;
+    unsigned int benchmark_iterations;
+    unsigned int thread_count;
+    bool batch;
 };
 
 static bool parse_command_line(int argc, char **argv, struct options *options)
@@ -132,6 +141,32 @@ static bool parse_command_line(int argc, char **argv, struct options *options)
             continue;
         }
 
+        if (!strcmp(argv[i], "--batch"))
+        {
+            options->batch = true;
+            continue;
+        }
+
+        if (!strcmp(argv[i], "-j"))
+        {
+            if (i + 1 >= argc - 1)
+                return false;
+            options->thread_count = strtoul(argv[++i], NULL, 0);
+            if (!options->thread_count)
+                return false;
+            continue;
+        }
+
+        if (!strcmp(argv[i], "--benchmark"))
+        {
+            if (i + 1 >= argc - 1)
+                return false;
+            options->benchmark_iterations = strtoul(argv[++i], NULL, 0);
+            if (!options->benchmark_iterations)
+                return false;
+            continue;
+        }
+
         for (j = 0; j < ARRAY_SIZE(compiler_options); ++j)
         {
             if (!strcmp(argv[i], compiler_options[j].name))
@@ -144,10 +179,239 @@ static bool parse_command_line(int argc, char **argv, struct options *options)
             return false;
     }
 
+    if (!options->thread_count)
+        options->thread_count = 1;
+
+    /* -j only makes sense when there is more than one input. */
+    if (options->thread_count > 1 && !options->batch)
+        return false;
+
     options->filename = argv[argc - 1];
     return true;
 }
 
+static bool run_benchmark(const struct vkd3d_shader_code *dxbc, const struct options *options)
+{
+    struct vkd3d_shader_code spirv;
+    uint64_t start_ns, end_ns;
+    unsigned int i;
+    HRESULT hr;
+
+    /* Compiles the same blob repeatedly to measure frontend and SPIR-V emission cost. */
+    start_ns = vkd3d_get_current_time_ns();
+    for (i = 0; i < options->benchmark_iterations; ++i)
+    {
+        hr = vkd3d_shader_compile_dxbc(dxbc, &spirv, NULL, options->compiler_options, NULL, NULL);
+        if (FAILED(hr))
+        {
+            fprintf(stderr, "Failed to compile DXBC shader, hr %#x.\n", hr);
+            return false;
+        }
+        vkd3d_shader_free_shader_code(&spirv);
+    }
+    end_ns = vkd3d_get_current_time_ns();
+
+    printf("Compiled '%s' %u times: %.3f us per compile.\n", options->filename,
+            options->benchmark_iterations, 1e-3 * (double)(end_ns - start_ns) / options->benchmark_iterations);
+    return true;
+}
+
+struct batch_job
+{
+    char *filename;
+    vkd3d_shader_hash_t hash;
+    uint64_t compile_ns;
+    size_t spirv_size;
+    bool success;
+};
+
+struct batch_context
+{
+    const struct options *options;
+    struct batch_job *jobs;
+    size_t job_count;
+    uint32_t next_job;
+};
+
+static bool read_batch_manifest(struct batch_context *context, const char *filename)
+{
+    size_t jobs_size = 0, len;
+    bool success = true;
+    char line[4096];
+    FILE *fd;
+
+    if (!strcmp(filename, "-"))
+        fd = stdin;
+    else if (!(fd = fopen(filename, "r")))
+    {
+        fprintf(stderr, "Cannot open manifest for reading: '%s'.\n", filename);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fd))
+    {
+        len = strlen(line);
+        while (len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            line[--len] = '\0';
+
+        if (!len || line[0] == '#')
+            continue;
+
+        if (!vkd3d_array_reserve((void **)&context->jobs, &jobs_size,
+                context->job_count + 1, sizeof(*context->jobs)))
+        {
+            fprintf(stderr, "Out of memory.\n");
+            success = false;
+            break;
+        }
+
+        memset(&context->jobs[context->job_count], 0, sizeof(*context->jobs));
+        if (!(context->jobs[context->job_count].filename = vkd3d_strdup(line)))
+        {
+            fprintf(stderr, "Out of memory.\n");
+            success = false;
+            break;
+        }
+        context->job_count++;
+    }
+
+    if (ferror(fd))
+    {
+        fprintf(stderr, "Could not read manifest: '%s'.\n", filename);
+        success = false;
+    }
+
+    if (fd != stdin)
+        fclose(fd);
+    return success;
+}
+
+static void run_batch_job(const struct options *options, struct batch_job *job)
+{
+    struct vkd3d_shader_code dxbc, spirv;
+    uint64_t start_ns;
+    char path[4096];
+    HRESULT hr;
+
+    if (!read_shader(&dxbc, job->filename))
+        return;
+
+    job->hash = vkd3d_shader_hash(&dxbc);
+
+    start_ns = vkd3d_get_current_time_ns();
+    hr = vkd3d_shader_compile_dxbc(&dxbc, &spirv, NULL, options->compiler_options, NULL, NULL);
+    job->compile_ns = vkd3d_get_current_time_ns() - start_ns;
+    vkd3d_shader_free_shader_code(&dxbc);
+
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to compile '%s', hr %#x.\n", job->filename, hr);
+        return;
+    }
+
+    job->spirv_size = spirv.size;
+    job->success = true;
+
+    if (options->output_filename)
+    {
+        snprintf(path, sizeof(path), "%s/%016"PRIx64".spv", options->output_filename, job->hash);
+        job->success = write_shader(&spirv, path);
+    }
+
+    vkd3d_shader_free_shader_code(&spirv);
+}
+
+static void *batch_worker_main(void *userdata)
+{
+    struct batch_context *context = userdata;
+    uint32_t job_index;
+
+    vkd3d_set_thread_name("vkd3d-compiler");
+
+    /* Jobs are handed out one at a time, since compile times vary wildly between shaders. */
+    while ((job_index = vkd3d_atomic_uint32_increment(&context->next_job, vkd3d_memory_order_relaxed) - 1) <
+            context->job_count)
+        run_batch_job(context->options, &context->jobs[job_index]);
+
+    return NULL;
+}
+
+static bool run_batch(const struct options *options)
+{
+    uint64_t start_ns, wall_ns, total_compile_ns = 0;
+    struct batch_context context;
+    unsigned int thread_count, i;
+    pthread_t *threads = NULL;
+    size_t failure_count = 0;
+    bool success;
+
+    memset(&context, 0, sizeof(context));
+    context.options = options;
+
+    success = read_batch_manifest(&context, options->filename);
+
+    thread_count = options->thread_count;
+    if (thread_count > context.job_count)
+        thread_count = context.job_count ? context.job_count : 1;
+    if (success && !(threads = calloc(thread_count, sizeof(*threads))))
+    {
+        fprintf(stderr, "Out of memory.\n");
+        success = false;
+    }
+
+    if (success)
+    {
+        start_ns = vkd3d_get_current_time_ns();
+
+        /* The calling thread also participates. */
+        for (i = 1; i < thread_count; i++)
+        {
+            if (pthread_create(&threads[i], NULL, batch_worker_main, &context))
+            {
+                fprintf(stderr, "Failed to create worker thread.\n");
+                thread_count = i;
+                break;
+            }
+        }
+
+        batch_worker_main(&context);
+
+        for (i = 1; i < thread_count; i++)
+            pthread_join(threads[i], NULL);
+
+        wall_ns = vkd3d_get_current_time_ns() - start_ns;
+        free(threads);
+
+        for (i = 0; i < context.job_count; i++)
+        {
+            const struct batch_job *job = &context.jobs[i];
+
+            if (job->success)
+            {
+                printf("%016"PRIx64" %10.3f us %8zu bytes  %s\n", job->hash,
+                        1e-3 * (double)job->compile_ns, job->spirv_size, job->filename);
+                total_compile_ns += job->compile_ns;
+            }
+            else
+            {
+                printf("%016"PRIx64"     FAILED                     %s\n", job->hash, job->filename);
+                failure_count++;
+            }
+        }
+
+        printf("Compiled %zu of %zu shaders with %u threads in %.3f ms (%.3f ms compile time, %.1f shaders/s).\n",
+                context.job_count - failure_count, context.job_count, thread_count, 1e-6 * (double)wall_ns,
+                1e-6 * (double)total_compile_ns, wall_ns ? 1e9 * (double)context.job_count / (double)wall_ns : 0.0);
+
+        success = !failure_count;
+    }
+
+    for (i = 0; i < context.job_count; i++)
+        vkd3d_free(context.jobs[i].filename);
+    vkd3d_free(context.jobs);
+    return success;
+}
+
 int main(int argc, char **argv)
 {
     struct vkd3d_shader_code dxbc, spirv;
@@ -160,12 +424,21 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    if (options.batch)
+        return run_batch(&options) ? 0 : 1;
+
     if (!read_shader(&dxbc, options.filename))
     {
         fprintf(stderr, "Failed to read DXBC shader.\n");
         return 1;
     }
 
+    if (options.benchmark_iterations && !run_benchmark(&dxbc, &options))
+    {
+        vkd3d_shader_free_shader_code(&dxbc);
+        return 1;
+    }
+
     hr = vkd3d_shader_compile_dxbc(&dxbc, &spirv, NULL, options.compiler_options, NULL, NULL);
     vkd3d_shader_free_shader_code(&dxbc);
     if (FAILED(hr))
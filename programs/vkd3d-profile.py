@@ -28,22 +28,122 @@ import argparse
 import collections
 import struct
 
-ProfileCase = collections.namedtuple('ProfileCase', 'name iterations ticks')
+ProfileCase = collections.namedtuple('ProfileCase', 'name iterations ticks max contended histogram')
 
+MAX_PROFILING_REGIONS = 256
+LEGACY_BLOCK_SIZE = 64
+HISTOGRAM_OFFSET = 128
+HISTOGRAM_BUCKETS = 128
+HISTOGRAM_SUB_BUCKETS = 4
+PERCENTILES = (50, 90, 99)
 
-def is_valid_block(block):
-    if len(block) != 64:
+
+def is_valid_block(block, block_size):
+    if len(block) != block_size:
         return False
     ticks = struct.unpack('=Q', block[0:8])[0]
     iterations = struct.unpack('=Q', block[8:16])[0]
+    # Locks which were never contended have not waited for a single tick.
+    if block[16:21] == b'lock ':
+        return iterations != 0
     return ticks != 0 and iterations != 0 and block[16] != 0
 
 
 def parse_block(block):
     ticks = struct.unpack('=Q', block[0:8])[0]
     iterations = struct.unpack('=Q', block[8:16])[0]
-    name = block[16:].split(b'\0', 1)[0].decode('ascii')
-    return ProfileCase(ticks = ticks, iterations = iterations, name = name)
+    name = block[16:64].split(b'\0', 1)[0].decode('ascii')
+    if len(block) > LEGACY_BLOCK_SIZE:
+        max_ticks = struct.unpack('=Q', block[64:72])[0]
+        contended = struct.unpack('=Q', block[72:80])[0]
+        histogram = list(struct.unpack('={}Q'.format(HISTOGRAM_BUCKETS),
+            block[HISTOGRAM_OFFSET:HISTOGRAM_OFFSET + 8 * HISTOGRAM_BUCKETS]))
+    else:
+        max_ticks = 0
+        contended = 0
+        histogram = []
+    return ProfileCase(ticks = ticks, iterations = iterations, name = name, max = max_ticks,
+            contended = contended, histogram = histogram)
+
+
+def read_blocks(path):
+    # Older builds only emitted 64 byte blocks without histograms.
+    block_size = os.path.getsize(path) // MAX_PROFILING_REGIONS
+    blocks = []
+    with open(path, 'rb') as f:
+        for block in iter(lambda: f.read(block_size), b''):
+            if is_valid_block(block, block_size):
+                blocks.append(parse_block(block))
+    return blocks
+
+
+def bucket_lower_bound(bucket):
+    if bucket < HISTOGRAM_SUB_BUCKETS:
+        return bucket
+    octave = bucket // HISTOGRAM_SUB_BUCKETS - 1
+    return (HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS) << octave
+
+
+def histogram_percentile(block, percentile):
+    # Report the upper bound of the bucket which contains the percentile, HDR histogram style.
+    total = sum(block.histogram)
+    if total == 0:
+        return None
+    target = total * percentile / 100.0
+    count = 0
+    for bucket, value in enumerate(block.histogram):
+        count += value
+        if count >= target:
+            if bucket + 1 >= HISTOGRAM_BUCKETS:
+                return block.max
+            upper = bucket_lower_bound(bucket + 1) - 1
+            return min(upper, block.max) if block.max else upper
+    return block.max
+
+
+def format_percentiles(block):
+    if not block.histogram or sum(block.histogram) == 0:
+        return None
+    values = ['p{} {:.3f}'.format(p, histogram_percentile(block, p) / 1000.0) for p in PERCENTILES]
+    values.append('max {:.3f}'.format(block.max / 1000.0))
+    return ', '.join(values) + ' Kcycles per call'
+
+
+def subtract_block(block, delta):
+    histogram = block.histogram
+    if block.histogram and delta.histogram:
+        histogram = [a - b for a, b in zip(block.histogram, delta.histogram)]
+        if any(value < 0 for value in histogram):
+            raise AssertionError('After subtracting, histogram became negative.')
+    # The maximum cannot be subtracted, so it still covers the entire capture.
+    return ProfileCase(ticks = block.ticks - delta.ticks,
+            iterations = block.iterations - delta.iterations,
+            name = block.name, max = block.max, contended = block.contended - delta.contended,
+            histogram = histogram)
+
+
+def print_compare_report(blocks, other_blocks, allow):
+    other_map = { block.name: block for block in other_blocks }
+    print('Comparing against baseline (baseline -> profile):')
+    for block in blocks:
+        if not filter_name(block.name, allow) or block.name not in other_map:
+            continue
+        other = other_map[block.name]
+        avg = block.ticks / block.iterations
+        other_avg = other.ticks / other.iterations
+        print(block.name + ':')
+        print('    Iterations: {} -> {}'.format(other.iterations, block.iterations))
+        print('    Time spent per iteration: {:.3f} -> {:.3f} Kcycles ({:+.1f}%)'.format(
+            other_avg / 1000.0, avg / 1000.0, 100.0 * (avg - other_avg) / other_avg if other_avg else 0.0))
+        if block.histogram and other.histogram and sum(block.histogram) and sum(other.histogram):
+            for p in PERCENTILES:
+                print('    p{}: {:.3f} -> {:.3f} Kcycles per call'.format(p,
+                    histogram_percentile(other, p) / 1000.0, histogram_percentile(block, p) / 1000.0))
+            print('    max: {:.3f} -> {:.3f} Kcycles per call'.format(other.max / 1000.0, block.max / 1000.0))
+
+    only_profile = [block.name for block in blocks if block.name not in other_map and filter_name(block.name, allow)]
+    if only_profile:
+        print('Only in profile: ' + ', '.join(only_profile))
 
 
 def filter_name(name, allow):
@@ -62,11 +162,37 @@ def find_record_by_name(blocks, name):
 
 
 def normalize_block(block, iter):
-    return ProfileCase(name = block.name, iterations = block.iterations / iter, ticks = block.ticks / iter)
+    return block._replace(iterations = block.iterations / iter, ticks = block.ticks / iter)
 
 
 def per_iteration_normalize(block):
-    return ProfileCase(name = block.name, iterations = block.iterations, ticks = block.ticks / block.iterations)
+    return block._replace(ticks = block.ticks / block.iterations)
+
+
+def print_pso_report(blocks, count):
+    pso_blocks = [block for block in blocks if block.name.startswith('pso_')]
+    if not pso_blocks:
+        print('No pipeline creation regions in profile.')
+        return
+
+    print('Pipeline creation by phase:')
+    for phase in ('spirv', 'pipeline', 'link'):
+        phase_blocks = [block for block in pso_blocks if block.name.startswith('pso_' + phase + '_')]
+        iterations = sum(block.iterations for block in phase_blocks)
+        ticks = sum(block.ticks for block in phase_blocks)
+        if iterations == 0:
+            continue
+        print('    {}: {} iterations, {:.3f} Kcycles total, {:.3f} Kcycles per iteration'.format(
+            phase, iterations, ticks / 1000.0, ticks / (1000.0 * iterations)))
+        for block in sorted(phase_blocks, reverse = True, key = lambda a: a.ticks):
+            print('        {}: {} iterations, {:.3f} Kcycles total'.format(
+                block.name[len('pso_' + phase + '_'):], block.iterations, block.ticks / 1000.0))
+
+    print('Worst offenders (ticks per iteration):')
+    pso_blocks.sort(reverse = True, key = lambda a: a.ticks / a.iterations)
+    for block in pso_blocks[0:count]:
+        print('    {}: {:.3f} Kcycles per iteration over {} iterations'.format(
+            block.name, block.ticks / (1000.0 * block.iterations), block.iterations))
 
 
 def main():
@@ -76,6 +202,8 @@ def main():
     parser.add_argument('--name', nargs = '+', type = str, help = 'Only display data for certain counters.')
     parser.add_argument('--sort', type = str, default = 'none', help = 'Sorts input data according to "iterations" or "ticks".')
     parser.add_argument('--delta', type = str, help = 'Subtract iterations and timing from other profile blob.')
+    parser.add_argument('--pso', nargs = '?', type = int, const = 10, help = 'Summarize pipeline creation regions and list the N worst offenders.')
+    parser.add_argument('--compare', type = str, help = 'Compare averages and percentiles against a baseline profile blob from another run.')
     parser.add_argument('profile', help = 'The profile binary blob.')
 
     args = parser.parse_args()
@@ -84,26 +212,25 @@ def main():
 
     delta_map = {}
     if args.delta is not None:
-        with open(args.delta, 'rb') as f:
-            for block in iter(lambda: f.read(64), b''):
-                if is_valid_block(block):
-                    b = parse_block(block)
-                    delta_map[b.name] = b
+        delta_map = { b.name: b for b in read_blocks(args.delta) }
 
     blocks = []
-    with open(args.profile, 'rb') as f:
-        for block in iter(lambda: f.read(64), b''):
-            if is_valid_block(block):
-                b = parse_block(block)
-                if b.name in delta_map:
-                    d = delta_map[b.name]
-                    b = ProfileCase(ticks = b.ticks - d.ticks,
-                            iterations = b.iterations - d.iterations,
-                            name = b.name)
-                    if b.iterations < 0 or b.ticks < 0:
-                        raise AssertionError('After subtracting, iterations or ticks became negative.')
-                if b.iterations > 0:
-                    blocks.append(b)
+    for b in read_blocks(args.profile):
+        if b.name in delta_map:
+            b = subtract_block(b, delta_map[b.name])
+            if b.iterations < 0 or b.ticks < 0:
+                raise AssertionError('After subtracting, iterations or ticks became negative.')
+        if b.iterations > 0:
+            blocks.append(b)
+
+    if args.compare is not None:
+        other_blocks = [b for b in read_blocks(args.compare) if b.iterations > 0]
+        print_compare_report(blocks, other_blocks, args.name)
+        return
+
+    if args.pso is not None:
+        print_pso_report(blocks, args.pso)
+        return
 
     if args.divider is not None:
         if args.per_iteration:
@@ -138,5 +265,14 @@ def main():
             else:
                 print('    Total time spent: {:.3f}'.format(block.ticks / 1000.0), "Kcycles")
 
+            if block.name.startswith('lock '):
+                # Lock blocks count acquisitions as iterations and only time the waits.
+                print('    Contended: {} ({:.2f}%)'.format(block.contended,
+                    100.0 * block.contended / block.iterations if block.iterations else 0.0))
+
+            percentiles = format_percentiles(block)
+            if percentiles is not None:
+                print('    Wait:' if block.name.startswith('lock ') else '    Latency:', percentiles)
+
 if __name__ == '__main__':
     main()
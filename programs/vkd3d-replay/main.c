@@ -0,0 +1,490 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* Replays a trace recorded with VKD3D_CAPTURE_PATH as fast as possible and reports
+ * the CPU time spent inside the D3D12 implementation per call type. Nothing is presented,
+ * so this runs headless. Run the same trace before and after a change to compare. */
+
+#define COBJMACROS
+#define INITGUID
+#include "vkd3d_windows.h"
+#include "vkd3d_d3d12.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vkd3d_common.h"
+#include "vkd3d_capture.h"
+#include "vkd3d_file_utils.h"
+
+struct replay_reader
+{
+    const uint32_t *words;
+    size_t word_count;
+    size_t offset;
+    bool failed;
+};
+
+struct replay_stats
+{
+    const char *name;
+    unsigned int count;
+    unsigned int failures;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+struct replay_state
+{
+    ID3D12Device *device;
+    ID3D12RootSignature **root_signatures;
+    size_t root_signature_count;
+    struct replay_stats stats[VKD3D_CAPTURE_RECORD_GRAPHICS_PIPELINE + 1];
+};
+
+static const uint32_t *replay_reader_read_words(struct replay_reader *reader, size_t size)
+{
+    size_t word_count = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    const uint32_t *words;
+
+    if (reader->failed || word_count > reader->word_count - reader->offset)
+    {
+        reader->failed = true;
+        return NULL;
+    }
+
+    words = reader->words + reader->offset;
+    reader->offset += word_count;
+    return words;
+}
+
+static uint32_t replay_reader_read_u32(struct replay_reader *reader)
+{
+    const uint32_t *word = replay_reader_read_words(reader, sizeof(*word));
+    return word ? *word : 0;
+}
+
+static void replay_reader_read_struct(struct replay_reader *reader, void *data, size_t size)
+{
+    const uint32_t *words;
+
+    if ((words = replay_reader_read_words(reader, size)))
+        memcpy(data, words, size);
+    else
+        memset(data, 0, size);
+}
+
+static const void *replay_reader_read_blob(struct replay_reader *reader, size_t *size)
+{
+    *size = replay_reader_read_u32(reader);
+    return *size ? replay_reader_read_words(reader, *size) : NULL;
+}
+
+static const char *replay_reader_read_string(struct replay_reader *reader)
+{
+    const char *str;
+    size_t size;
+
+    str = replay_reader_read_blob(reader, &size);
+    if (!str || str[size - 1] != '\0')
+    {
+        reader->failed = true;
+        return "";
+    }
+
+    return str;
+}
+
+static void replay_reader_read_shader(struct replay_reader *reader, D3D12_SHADER_BYTECODE *code)
+{
+    size_t size;
+
+    code->pShaderBytecode = replay_reader_read_blob(reader, &size);
+    code->BytecodeLength = size;
+}
+
+static ID3D12RootSignature *replay_state_get_root_signature(struct replay_state *state, uint32_t id)
+{
+    if (!id || id >= state->root_signature_count)
+        return NULL;
+    return state->root_signatures[id];
+}
+
+static bool replay_state_set_root_signature(struct replay_state *state, uint32_t id, ID3D12RootSignature *root_signature)
+{
+    ID3D12RootSignature **new_root_signatures;
+    size_t new_count;
+
+    if (id >= state->root_signature_count)
+    {
+        new_count = max(id + 1, 2 * state->root_signature_count);
+        if (!(new_root_signatures = realloc(state->root_signatures, new_count * sizeof(*new_root_signatures))))
+            return false;
+        memset(new_root_signatures + state->root_signature_count, 0,
+                (new_count - state->root_signature_count) * sizeof(*new_root_signatures));
+        state->root_signatures = new_root_signatures;
+        state->root_signature_count = new_count;
+    }
+
+    /* The application created the same blob again. */
+    if (state->root_signatures[id])
+        ID3D12RootSignature_Release(state->root_signatures[id]);
+    state->root_signatures[id] = root_signature;
+    return true;
+}
+
+static void replay_stats_add(struct replay_stats *stats, uint64_t delta_ns, HRESULT hr)
+{
+    stats->count++;
+    stats->total_ns += delta_ns;
+    stats->max_ns = max(stats->max_ns, delta_ns);
+    if (FAILED(hr))
+        stats->failures++;
+}
+
+static bool replay_root_signature(struct replay_state *state, struct replay_reader *reader)
+{
+    ID3D12RootSignature *root_signature;
+    uint32_t id, node_mask;
+    uint64_t start_ns;
+    const void *blob;
+    size_t size;
+    HRESULT hr;
+
+    id = replay_reader_read_u32(reader);
+    node_mask = replay_reader_read_u32(reader);
+    blob = replay_reader_read_blob(reader, &size);
+    if (reader->failed)
+        return false;
+
+    start_ns = vkd3d_get_current_time_ns();
+    hr = ID3D12Device_CreateRootSignature(state->device, node_mask, blob, size,
+            &IID_ID3D12RootSignature, (void **)&root_signature);
+    replay_stats_add(&state->stats[VKD3D_CAPTURE_RECORD_ROOT_SIGNATURE], vkd3d_get_current_time_ns() - start_ns, hr);
+
+    if (FAILED(hr))
+    {
+        fprintf(stderr, "Failed to create root signature %u, hr #%x.\n", id, hr);
+        return true;
+    }
+
+    if (!replay_state_set_root_signature(state, id, root_signature))
+    {
+        ID3D12RootSignature_Release(root_signature);
+        return false;
+    }
+
+    return true;
+}
+
+static bool replay_compute_pipeline(struct replay_state *state, struct replay_reader *reader)
+{
+    D3D12_COMPUTE_PIPELINE_STATE_DESC desc;
+    ID3D12PipelineState *pipeline;
+    uint64_t start_ns;
+    HRESULT hr;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.pRootSignature = replay_state_get_root_signature(state, replay_reader_read_u32(reader));
+    desc.NodeMask = replay_reader_read_u32(reader);
+    desc.Flags = replay_reader_read_u32(reader);
+    replay_reader_read_shader(reader, &desc.CS);
+    if (reader->failed)
+        return false;
+
+    start_ns = vkd3d_get_current_time_ns();
+    hr = ID3D12Device_CreateComputePipelineState(state->device, &desc,
+            &IID_ID3D12PipelineState, (void **)&pipeline);
+    replay_stats_add(&state->stats[VKD3D_CAPTURE_RECORD_COMPUTE_PIPELINE], vkd3d_get_current_time_ns() - start_ns, hr);
+
+    if (SUCCEEDED(hr))
+        ID3D12PipelineState_Release(pipeline);
+    return true;
+}
+
+static bool replay_graphics_pipeline(struct replay_state *state, struct replay_reader *reader)
+{
+    D3D12_INPUT_ELEMENT_DESC *input_elements = NULL;
+    D3D12_SO_DECLARATION_ENTRY *so_entries = NULL;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+    ID3D12PipelineState *pipeline;
+    uint64_t start_ns;
+    unsigned int i;
+    size_t size;
+    HRESULT hr;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.pRootSignature = replay_state_get_root_signature(state, replay_reader_read_u32(reader));
+    replay_reader_read_shader(reader, &desc.VS);
+    replay_reader_read_shader(reader, &desc.PS);
+    replay_reader_read_shader(reader, &desc.DS);
+    replay_reader_read_shader(reader, &desc.HS);
+    replay_reader_read_shader(reader, &desc.GS);
+
+    desc.StreamOutput.NumEntries = replay_reader_read_u32(reader);
+    if (desc.StreamOutput.NumEntries && !reader->failed)
+    {
+        if (!(so_entries = calloc(desc.StreamOutput.NumEntries, sizeof(*so_entries))))
+            return false;
+
+        for (i = 0; i < desc.StreamOutput.NumEntries; i++)
+        {
+            so_entries[i].Stream = replay_reader_read_u32(reader);
+            so_entries[i].SemanticName = replay_reader_read_string(reader);
+            so_entries[i].SemanticIndex = replay_reader_read_u32(reader);
+            so_entries[i].StartComponent = replay_reader_read_u32(reader);
+            so_entries[i].ComponentCount = replay_reader_read_u32(reader);
+            so_entries[i].OutputSlot = replay_reader_read_u32(reader);
+        }
+        desc.StreamOutput.pSODeclaration = so_entries;
+    }
+    desc.StreamOutput.pBufferStrides = replay_reader_read_blob(reader, &size);
+    desc.StreamOutput.NumStrides = size / sizeof(UINT);
+    desc.StreamOutput.RasterizedStream = replay_reader_read_u32(reader);
+
+    replay_reader_read_struct(reader, &desc.BlendState, sizeof(desc.BlendState));
+    desc.SampleMask = replay_reader_read_u32(reader);
+    replay_reader_read_struct(reader, &desc.RasterizerState, sizeof(desc.RasterizerState));
+    replay_reader_read_struct(reader, &desc.DepthStencilState, sizeof(desc.DepthStencilState));
+
+    desc.InputLayout.NumElements = replay_reader_read_u32(reader);
+    if (desc.InputLayout.NumElements && !reader->failed)
+    {
+        if (!(input_elements = calloc(desc.InputLayout.NumElements, sizeof(*input_elements))))
+        {
+            free(so_entries);
+            return false;
+        }
+
+        for (i = 0; i < desc.InputLayout.NumElements; i++)
+        {
+            input_elements[i].SemanticName = replay_reader_read_string(reader);
+            input_elements[i].SemanticIndex = replay_reader_read_u32(reader);
+            input_elements[i].Format = replay_reader_read_u32(reader);
+            input_elements[i].InputSlot = replay_reader_read_u32(reader);
+            input_elements[i].AlignedByteOffset = replay_reader_read_u32(reader);
+            input_elements[i].InputSlotClass = replay_reader_read_u32(reader);
+            input_elements[i].InstanceDataStepRate = replay_reader_read_u32(reader);
+        }
+        desc.InputLayout.pInputElementDescs = input_elements;
+    }
+
+    desc.IBStripCutValue = replay_reader_read_u32(reader);
+    desc.PrimitiveTopologyType = replay_reader_read_u32(reader);
+    desc.NumRenderTargets = replay_reader_read_u32(reader);
+    for (i = 0; i < ARRAY_SIZE(desc.RTVFormats); i++)
+        desc.RTVFormats[i] = replay_reader_read_u32(reader);
+    desc.DSVFormat = replay_reader_read_u32(reader);
+    replay_reader_read_struct(reader, &desc.SampleDesc, sizeof(desc.SampleDesc));
+    desc.NodeMask = replay_reader_read_u32(reader);
+    desc.Flags = replay_reader_read_u32(reader);
+
+    if (!reader->failed)
+    {
+        start_ns = vkd3d_get_current_time_ns();
+        hr = ID3D12Device_CreateGraphicsPipelineState(state->device, &desc,
+                &IID_ID3D12PipelineState, (void **)&pipeline);
+        replay_stats_add(&state->stats[VKD3D_CAPTURE_RECORD_GRAPHICS_PIPELINE], vkd3d_get_current_time_ns() - start_ns, hr);
+
+        if (SUCCEEDED(hr))
+            ID3D12PipelineState_Release(pipeline);
+    }
+
+    free(input_elements);
+    free(so_entries);
+    return !reader->failed;
+}
+
+static bool replay_trace(struct replay_state *state, const struct vkd3d_memory_mapped_file *file)
+{
+    const struct vkd3d_capture_record_header *record;
+    const struct vkd3d_capture_header *header;
+    struct replay_reader reader;
+    const uint8_t *data;
+    size_t offset;
+    bool ret;
+
+    header = file->mapped;
+    if (file->mapped_size < sizeof(*header) || header->magic != VKD3D_CAPTURE_MAGIC)
+    {
+        fprintf(stderr, "Not a vkd3d-proton trace.\n");
+        return false;
+    }
+
+    if (header->version != VKD3D_CAPTURE_VERSION)
+    {
+        fprintf(stderr, "Trace version %u is not supported, expected %u.\n", header->version, VKD3D_CAPTURE_VERSION);
+        return false;
+    }
+
+    data = file->mapped;
+    offset = sizeof(*header);
+
+    while (offset + sizeof(*record) <= file->mapped_size)
+    {
+        record = (const struct vkd3d_capture_record_header *)(data + offset);
+        offset += sizeof(*record);
+
+        if ((record->size & 3) || record->size > file->mapped_size - offset)
+        {
+            fprintf(stderr, "Truncated record at offset %zu.\n", offset - sizeof(*record));
+            return false;
+        }
+
+        memset(&reader, 0, sizeof(reader));
+        reader.words = (const uint32_t *)(data + offset);
+        reader.word_count = record->size / sizeof(uint32_t);
+        offset += record->size;
+
+        switch (record->type)
+        {
+            case VKD3D_CAPTURE_RECORD_ROOT_SIGNATURE:
+                ret = replay_root_signature(state, &reader);
+                break;
+
+            case VKD3D_CAPTURE_RECORD_COMPUTE_PIPELINE:
+                ret = replay_compute_pipeline(state, &reader);
+                break;
+
+            case VKD3D_CAPTURE_RECORD_GRAPHICS_PIPELINE:
+                ret = replay_graphics_pipeline(state, &reader);
+                break;
+
+            default:
+                /* Newer recorders may add record types, skip what we do not understand. */
+                ret = true;
+                break;
+        }
+
+        if (!ret)
+        {
+            fprintf(stderr, "Failed to replay record of type %u.\n", record->type);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void replay_state_cleanup(struct replay_state *state)
+{
+    size_t i;
+
+    for (i = 0; i < state->root_signature_count; i++)
+        if (state->root_signatures[i])
+            ID3D12RootSignature_Release(state->root_signatures[i]);
+    free(state->root_signatures);
+    state->root_signatures = NULL;
+    state->root_signature_count = 0;
+}
+
+static void print_usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [--iterations <count>] [--csv] <trace>\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    struct vkd3d_memory_mapped_file file;
+    unsigned int iterations = 1;
+    struct replay_state state;
+    const char *path = NULL;
+    bool output_csv = false;
+    unsigned int i;
+    bool ret;
+    int arg;
+
+    for (arg = 1; arg < argc; arg++)
+    {
+        if (!strcmp(argv[arg], "--iterations") && arg + 1 < argc)
+            iterations = max(atoi(argv[++arg]), 1);
+        else if (!strcmp(argv[arg], "--csv"))
+            output_csv = true;
+        else if (!path)
+            path = argv[arg];
+        else
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!path)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (!vkd3d_file_map_read_only(path, &file))
+    {
+        fprintf(stderr, "Failed to map trace \"%s\".\n", path);
+        return 1;
+    }
+
+    memset(&state, 0, sizeof(state));
+    state.stats[VKD3D_CAPTURE_RECORD_ROOT_SIGNATURE].name = "CreateRootSignature";
+    state.stats[VKD3D_CAPTURE_RECORD_COMPUTE_PIPELINE].name = "CreateComputePipelineState";
+    state.stats[VKD3D_CAPTURE_RECORD_GRAPHICS_PIPELINE].name = "CreateGraphicsPipelineState";
+
+    if (FAILED(D3D12CreateDevice(NULL, D3D_FEATURE_LEVEL_11_0, &IID_ID3D12Device, (void **)&state.device)))
+    {
+        fprintf(stderr, "Failed to create device.\n");
+        vkd3d_file_unmap(&file);
+        return 1;
+    }
+
+    /* Later iterations run against warm in-memory caches, which isolates the translation overhead
+     * from shader compilation. */
+    for (i = 0, ret = true; i < iterations && ret; i++)
+    {
+        ret = replay_trace(&state, &file);
+        replay_state_cleanup(&state);
+    }
+
+    if (output_csv)
+        printf("call,count,failures,total_ms,avg_us,max_us\n");
+
+    for (i = 0; i < ARRAY_SIZE(state.stats); i++)
+    {
+        const struct replay_stats *stats = &state.stats[i];
+
+        if (!stats->count)
+            continue;
+
+        if (output_csv)
+        {
+            printf("%s,%u,%u,%.3f,%.3f,%.3f\n", stats->name, stats->count, stats->failures,
+                    1e-6 * (double)stats->total_ns, 1e-3 * (double)stats->total_ns / stats->count,
+                    1e-3 * (double)stats->max_ns);
+        }
+        else
+        {
+            printf("%-28s %8u calls, %4u failed, %10.3f ms total, %8.3f us avg, %8.3f us max\n",
+                    stats->name, stats->count, stats->failures,
+                    1e-6 * (double)stats->total_ns, 1e-3 * (double)stats->total_ns / stats->count,
+                    1e-3 * (double)stats->max_ns);
+        }
+    }
+
+    ID3D12Device_Release(state.device);
+    vkd3d_file_unmap(&file);
+    return ret ? 0 : 1;
+}
@@ -0,0 +1,642 @@
+/*
+ * Copyright 2023 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#define INITGUID
+#define VKD3D_TEST_DECLARE_MAIN
+#include "d3d12_crosstest.h"
+
+/* CPU overhead of the hot API entry points. Everything except the submission benchmark
+ * only records, so the numbers are independent of the GPU. Each benchmark is run with
+ * 1, 2, 4, ... up to --threads recording threads, which all share one device. */
+
+enum benchmark_output_format
+{
+    BENCHMARK_OUTPUT_TEXT,
+    BENCHMARK_OUTPUT_CSV,
+    BENCHMARK_OUTPUT_JSON,
+};
+
+static enum benchmark_output_format output_format = BENCHMARK_OUTPUT_TEXT;
+static unsigned int benchmark_iterations = 10;
+static unsigned int benchmark_thread_count = 4;
+
+#define MAX_BENCHMARK_THREADS 64
+#define BARRIER_TEXTURE_COUNT 16
+#define SUBMIT_LIST_COUNT 256
+#define SHADING_RATE_IMAGE_COUNT 4
+
+static void setup(int argc, char **argv)
+{
+    int i;
+
+    pfn_D3D12CreateDevice = get_d3d12_pfn(D3D12CreateDevice);
+    pfn_D3D12EnableExperimentalFeatures = get_d3d12_pfn(D3D12EnableExperimentalFeatures);
+    pfn_D3D12GetDebugInterface = get_d3d12_pfn(D3D12GetDebugInterface);
+
+    parse_args(argc, argv);
+    enable_d3d12_debug_layer(argc, argv);
+    init_adapter_info();
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--csv"))
+            output_format = BENCHMARK_OUTPUT_CSV;
+        else if (!strcmp(argv[i], "--json"))
+            output_format = BENCHMARK_OUTPUT_JSON;
+        else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+            benchmark_iterations = max(atoi(argv[++i]), 1);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            benchmark_thread_count = min(max(atoi(argv[++i]), 1), MAX_BENCHMARK_THREADS);
+    }
+
+    if (output_format == BENCHMARK_OUTPUT_CSV)
+        printf("run,benchmark,config,threads,count,total_ms,ns_per_call\n");
+}
+
+static void report_result(unsigned int run, const char *benchmark, const char *config,
+        unsigned int thread_count, unsigned int count, double seconds)
+{
+    double ns_per_call = count ? 1e9 * seconds / (double)count : 0.0;
+
+    switch (output_format)
+    {
+        case BENCHMARK_OUTPUT_CSV:
+            printf("%u,%s,%s,%u,%u,%.6f,%.3f\n", run, benchmark, config,
+                    thread_count, count, 1e3 * seconds, ns_per_call);
+            break;
+
+        case BENCHMARK_OUTPUT_JSON:
+            printf("{\"run\": %u, \"benchmark\": \"%s\", \"config\": \"%s\", \"threads\": %u, \"count\": %u, "
+                    "\"total_ms\": %.6f, \"ns_per_call\": %.3f}\n",
+                    run, benchmark, config, thread_count, count, 1e3 * seconds, ns_per_call);
+            break;
+
+        default:
+            printf("%s (%s, %u threads, %u calls) took: %.3f ms (%.3f ns / call).\n",
+                    benchmark, config, thread_count, count, 1e3 * seconds, ns_per_call);
+            break;
+    }
+}
+
+static double get_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER lc, lf;
+    QueryPerformanceCounter(&lc);
+    QueryPerformanceFrequency(&lf);
+    return (double)lc.QuadPart / (double)lf.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+struct benchmark_context
+{
+    ID3D12Device *device;
+    ID3D12CommandQueue *queue;
+    ID3D12RootSignature *root_signature;
+    ID3D12PipelineState *pipeline_state;
+    ID3D12DescriptorHeap *rtv_heap;
+    ID3D12DescriptorHeap *srv_heap;
+    ID3D12Resource *render_target;
+    ID3D12Resource *index_buffer;
+    ID3D12Resource *upload_buffer;
+    ID3D12Resource *copy_texture;
+    ID3D12Resource *barrier_textures[BARRIER_TEXTURE_COUNT];
+    ID3D12Resource *shading_rate_images[SHADING_RATE_IMAGE_COUNT];
+    ID3D12Heap *placed_heap;
+};
+
+struct benchmark_thread
+{
+    struct benchmark_context *context;
+    ID3D12CommandAllocator *allocator;
+    ID3D12GraphicsCommandList *list;
+    ID3D12GraphicsCommandList *submit_lists[SUBMIT_LIST_COUNT];
+    unsigned int count;
+    bool batched;
+};
+
+static bool init_benchmark_context(struct benchmark_context *context)
+{
+    static const uint16_t indices[] = { 0, 1, 2 };
+    D3D12_DESCRIPTOR_HEAP_DESC heap_desc;
+    D3D12_HEAP_DESC placed_heap_desc;
+    unsigned int i;
+    HRESULT hr;
+
+    memset(context, 0, sizeof(*context));
+
+    if (!(context->device = create_device()))
+        return false;
+
+    context->queue = create_command_queue(context->device, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            D3D12_COMMAND_QUEUE_PRIORITY_NORMAL);
+    context->root_signature = create_texture_root_signature(context->device,
+            D3D12_SHADER_VISIBILITY_ALL, 4, 0);
+    context->pipeline_state = create_pipeline_state(context->device, context->root_signature,
+            DXGI_FORMAT_R8G8B8A8_UNORM, NULL, NULL, NULL);
+
+    memset(&heap_desc, 0, sizeof(heap_desc));
+    heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    heap_desc.NumDescriptors = 1;
+    hr = ID3D12Device_CreateDescriptorHeap(context->device, &heap_desc,
+            &IID_ID3D12DescriptorHeap, (void **)&context->rtv_heap);
+    ok(SUCCEEDED(hr), "Failed to create RTV heap, hr %#x.\n", hr);
+
+    heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heap_desc.NumDescriptors = 1024;
+    heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    hr = ID3D12Device_CreateDescriptorHeap(context->device, &heap_desc,
+            &IID_ID3D12DescriptorHeap, (void **)&context->srv_heap);
+    ok(SUCCEEDED(hr), "Failed to create SRV heap, hr %#x.\n", hr);
+
+    context->render_target = create_default_texture2d(context->device, 256, 256, 1, 1,
+            DXGI_FORMAT_R8G8B8A8_UNORM, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    ID3D12Device_CreateRenderTargetView(context->device, context->render_target, NULL,
+            ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(context->rtv_heap));
+
+    context->index_buffer = create_upload_buffer(context->device, sizeof(indices), indices);
+    context->upload_buffer = create_upload_buffer(context->device, 64 * 64 * 4, NULL);
+    context->copy_texture = create_default_texture2d(context->device, 1024, 1024, 1, 1,
+            DXGI_FORMAT_R8G8B8A8_UNORM, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    for (i = 0; i < BARRIER_TEXTURE_COUNT; i++)
+    {
+        context->barrier_textures[i] = create_default_texture2d(context->device, 256, 256, 1, 1,
+                DXGI_FORMAT_R8G8B8A8_UNORM, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    }
+
+    /* Optional, the shading rate image benchmark is skipped without them. */
+    if (is_vrs_tier2_supported(context->device))
+    {
+        D3D12_FEATURE_DATA_D3D12_OPTIONS6 options6;
+        unsigned int tile_size;
+
+        memset(&options6, 0, sizeof(options6));
+        ID3D12Device_CheckFeatureSupport(context->device, D3D12_FEATURE_D3D12_OPTIONS6, &options6, sizeof(options6));
+        tile_size = max(options6.ShadingRateImageTileSize, 1);
+
+        for (i = 0; i < SHADING_RATE_IMAGE_COUNT; i++)
+        {
+            context->shading_rate_images[i] = create_default_texture2d(context->device,
+                    256 / tile_size, 256 / tile_size, 1, 1, DXGI_FORMAT_R8_UINT, D3D12_RESOURCE_FLAG_NONE,
+                    D3D12_RESOURCE_STATE_SHADING_RATE_SOURCE);
+        }
+    }
+
+    memset(&placed_heap_desc, 0, sizeof(placed_heap_desc));
+    placed_heap_desc.SizeInBytes = 16 * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    placed_heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    placed_heap_desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    hr = ID3D12Device_CreateHeap(context->device, &placed_heap_desc, &IID_ID3D12Heap, (void **)&context->placed_heap);
+    ok(SUCCEEDED(hr), "Failed to create heap, hr %#x.\n", hr);
+
+    return context->queue && context->root_signature && context->pipeline_state &&
+            context->rtv_heap && context->srv_heap && context->placed_heap;
+}
+
+static void destroy_benchmark_context(struct benchmark_context *context)
+{
+    unsigned int i;
+
+    for (i = 0; i < BARRIER_TEXTURE_COUNT; i++)
+    {
+        if (context->barrier_textures[i])
+            ID3D12Resource_Release(context->barrier_textures[i]);
+    }
+
+    for (i = 0; i < SHADING_RATE_IMAGE_COUNT; i++)
+    {
+        if (context->shading_rate_images[i])
+            ID3D12Resource_Release(context->shading_rate_images[i]);
+    }
+
+    if (context->placed_heap)
+        ID3D12Heap_Release(context->placed_heap);
+    if (context->copy_texture)
+        ID3D12Resource_Release(context->copy_texture);
+    if (context->upload_buffer)
+        ID3D12Resource_Release(context->upload_buffer);
+    if (context->index_buffer)
+        ID3D12Resource_Release(context->index_buffer);
+    if (context->render_target)
+        ID3D12Resource_Release(context->render_target);
+    if (context->srv_heap)
+        ID3D12DescriptorHeap_Release(context->srv_heap);
+    if (context->rtv_heap)
+        ID3D12DescriptorHeap_Release(context->rtv_heap);
+    if (context->pipeline_state)
+        ID3D12PipelineState_Release(context->pipeline_state);
+    if (context->root_signature)
+        ID3D12RootSignature_Release(context->root_signature);
+    if (context->queue)
+        ID3D12CommandQueue_Release(context->queue);
+    ID3D12Device_Release(context->device);
+}
+
+static void init_benchmark_threads(struct benchmark_context *context,
+        struct benchmark_thread *threads, unsigned int thread_count)
+{
+    unsigned int i;
+    HRESULT hr;
+
+    for (i = 0; i < thread_count; i++)
+    {
+        memset(&threads[i], 0, sizeof(threads[i]));
+        threads[i].context = context;
+
+        hr = ID3D12Device_CreateCommandAllocator(context->device, D3D12_COMMAND_LIST_TYPE_DIRECT,
+                &IID_ID3D12CommandAllocator, (void **)&threads[i].allocator);
+        ok(SUCCEEDED(hr), "Failed to create command allocator, hr %#x.\n", hr);
+        hr = ID3D12Device_CreateCommandList(context->device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+                threads[i].allocator, NULL, &IID_ID3D12GraphicsCommandList, (void **)&threads[i].list);
+        ok(SUCCEEDED(hr), "Failed to create command list, hr %#x.\n", hr);
+        ID3D12GraphicsCommandList_Close(threads[i].list);
+    }
+}
+
+static void destroy_benchmark_threads(struct benchmark_thread *threads, unsigned int thread_count)
+{
+    unsigned int i;
+
+    for (i = 0; i < thread_count; i++)
+    {
+        ID3D12GraphicsCommandList_Release(threads[i].list);
+        ID3D12CommandAllocator_Release(threads[i].allocator);
+    }
+}
+
+/* Runs the benchmark on every thread at once and returns the wall time. */
+static double run_benchmark_threads(thread_main_pfn main_pfn,
+        struct benchmark_thread *threads, unsigned int thread_count)
+{
+    HANDLE handles[MAX_BENCHMARK_THREADS];
+    double start_time;
+    unsigned int i;
+
+    start_time = get_time();
+    if (thread_count == 1)
+        main_pfn(&threads[0]);
+    else
+    {
+        for (i = 0; i < thread_count; i++)
+            handles[i] = create_thread(main_pfn, &threads[i]);
+        for (i = 0; i < thread_count; i++)
+            ok(join_thread(handles[i]), "Failed to join thread %u.\n", i);
+    }
+    return get_time() - start_time;
+}
+
+static void record_draws(void *userdata)
+{
+    struct benchmark_thread *thread = userdata;
+    struct benchmark_context *context = thread->context;
+    ID3D12GraphicsCommandList *list = thread->list;
+    D3D12_GPU_DESCRIPTOR_HANDLE gpu_handle;
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv;
+    D3D12_INDEX_BUFFER_VIEW ibv;
+    D3D12_VIEWPORT viewport;
+    unsigned int i, stride;
+    RECT scissor;
+
+    stride = ID3D12Device_GetDescriptorHandleIncrementSize(context->device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    rtv = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(context->rtv_heap);
+    gpu_handle = ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart(context->srv_heap);
+
+    ibv.BufferLocation = ID3D12Resource_GetGPUVirtualAddress(context->index_buffer);
+    ibv.SizeInBytes = 3 * sizeof(uint16_t);
+    ibv.Format = DXGI_FORMAT_R16_UINT;
+    set_viewport(&viewport, 0.0f, 0.0f, 256.0f, 256.0f, 0.0f, 1.0f);
+    set_rect(&scissor, 0, 0, 256, 256);
+
+    reset_command_list(list, thread->allocator);
+    ID3D12GraphicsCommandList_SetDescriptorHeaps(list, 1, &context->srv_heap);
+    ID3D12GraphicsCommandList_SetGraphicsRootSignature(list, context->root_signature);
+    ID3D12GraphicsCommandList_SetPipelineState(list, context->pipeline_state);
+    ID3D12GraphicsCommandList_IASetPrimitiveTopology(list, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D12GraphicsCommandList_IASetIndexBuffer(list, &ibv);
+    ID3D12GraphicsCommandList_RSSetViewports(list, 1, &viewport);
+    ID3D12GraphicsCommandList_RSSetScissorRects(list, 1, &scissor);
+    ID3D12GraphicsCommandList_OMSetRenderTargets(list, 1, &rtv, false, NULL);
+
+    /* Mimic a typical engine, which changes per-draw constants every draw
+     * and material tables every few draws. */
+    for (i = 0; i < thread->count; i++)
+    {
+        if (!(i & 3))
+        {
+            D3D12_GPU_DESCRIPTOR_HANDLE table = gpu_handle;
+            table.ptr += ((i >> 2) & 1023) * stride;
+            ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable(list, 0, table);
+        }
+
+        ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstant(list, 1, i, 0);
+        ID3D12GraphicsCommandList_DrawIndexedInstanced(list, 3, 1, 0, 0, 0);
+    }
+
+    ID3D12GraphicsCommandList_Close(list);
+}
+
+static void record_shading_rate_image_switches(void *userdata)
+{
+    struct benchmark_thread *thread = userdata;
+    struct benchmark_context *context = thread->context;
+    ID3D12GraphicsCommandList5 *list5;
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv;
+    D3D12_INDEX_BUFFER_VIEW ibv;
+    D3D12_VIEWPORT viewport;
+    unsigned int i;
+    RECT scissor;
+    HRESULT hr;
+
+    hr = ID3D12GraphicsCommandList_QueryInterface(thread->list, &IID_ID3D12GraphicsCommandList5, (void **)&list5);
+    ok(SUCCEEDED(hr), "Failed to query ID3D12GraphicsCommandList5, hr %#x.\n", hr);
+    if (FAILED(hr))
+        return;
+
+    rtv = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(context->rtv_heap);
+    ibv.BufferLocation = ID3D12Resource_GetGPUVirtualAddress(context->index_buffer);
+    ibv.SizeInBytes = 3 * sizeof(uint16_t);
+    ibv.Format = DXGI_FORMAT_R16_UINT;
+    set_viewport(&viewport, 0.0f, 0.0f, 256.0f, 256.0f, 0.0f, 1.0f);
+    set_rect(&scissor, 0, 0, 256, 256);
+
+    reset_command_list(thread->list, thread->allocator);
+    ID3D12GraphicsCommandList5_SetDescriptorHeaps(list5, 1, &context->srv_heap);
+    ID3D12GraphicsCommandList5_SetGraphicsRootSignature(list5, context->root_signature);
+    ID3D12GraphicsCommandList5_SetPipelineState(list5, context->pipeline_state);
+    ID3D12GraphicsCommandList5_IASetPrimitiveTopology(list5, D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    ID3D12GraphicsCommandList5_IASetIndexBuffer(list5, &ibv);
+    ID3D12GraphicsCommandList5_RSSetViewports(list5, 1, &viewport);
+    ID3D12GraphicsCommandList5_RSSetScissorRects(list5, 1, &scissor);
+    ID3D12GraphicsCommandList5_OMSetRenderTargets(list5, 1, &rtv, false, NULL);
+
+    /* Per-pass shading rate images, e.g. one per view or per frame in flight,
+     * with a handful of draws in between. Every switch restarts rendering. */
+    for (i = 0; i < thread->count; i++)
+    {
+        if (!(i & 3))
+        {
+            ID3D12GraphicsCommandList5_RSSetShadingRateImage(list5,
+                    context->shading_rate_images[(i >> 2) % SHADING_RATE_IMAGE_COUNT]);
+        }
+
+        ID3D12GraphicsCommandList5_DrawIndexedInstanced(list5, 3, 1, 0, 0, 0);
+    }
+
+    ID3D12GraphicsCommandList5_Close(list5);
+    ID3D12GraphicsCommandList5_Release(list5);
+}
+
+static void record_barriers(void *userdata)
+{
+    D3D12_RESOURCE_BARRIER barriers[BARRIER_TEXTURE_COUNT];
+    struct benchmark_thread *thread = userdata;
+    struct benchmark_context *context = thread->context;
+    ID3D12GraphicsCommandList *list = thread->list;
+    D3D12_RESOURCE_STATES before, after;
+    unsigned int i, j;
+
+    reset_command_list(list, thread->allocator);
+
+    for (i = 0; i < thread->count / BARRIER_TEXTURE_COUNT; i++)
+    {
+        before = (i & 1) ? D3D12_RESOURCE_STATE_UNORDERED_ACCESS : D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        after = (i & 1) ? D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE : D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+
+        for (j = 0; j < BARRIER_TEXTURE_COUNT; j++)
+        {
+            barriers[j].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[j].Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            barriers[j].Transition.pResource = context->barrier_textures[j];
+            barriers[j].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barriers[j].Transition.StateBefore = before;
+            barriers[j].Transition.StateAfter = after;
+        }
+
+        if (thread->batched)
+            ID3D12GraphicsCommandList_ResourceBarrier(list, BARRIER_TEXTURE_COUNT, barriers);
+        else
+        {
+            for (j = 0; j < BARRIER_TEXTURE_COUNT; j++)
+                ID3D12GraphicsCommandList_ResourceBarrier(list, 1, &barriers[j]);
+        }
+    }
+
+    ID3D12GraphicsCommandList_Close(list);
+}
+
+static void create_committed_resources(void *userdata)
+{
+    struct benchmark_thread *thread = userdata;
+    struct benchmark_context *context = thread->context;
+    ID3D12Resource *resource;
+    unsigned int i;
+
+    for (i = 0; i < thread->count; i++)
+    {
+        resource = create_default_buffer(context->device, 64 * 1024,
+                D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COMMON);
+        if (resource)
+            ID3D12Resource_Release(resource);
+    }
+}
+
+static void create_placed_resources(void *userdata)
+{
+    struct benchmark_thread *thread = userdata;
+    struct benchmark_context *context = thread->context;
+    D3D12_RESOURCE_DESC resource_desc;
+    ID3D12Resource *resource;
+    unsigned int i;
+    HRESULT hr;
+
+    memset(&resource_desc, 0, sizeof(resource_desc));
+    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resource_desc.Width = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    resource_desc.Height = 1;
+    resource_desc.DepthOrArraySize = 1;
+    resource_desc.MipLevels = 1;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    /* Placed resources may alias freely, so all threads share the heap. */
+    for (i = 0; i < thread->count; i++)
+    {
+        hr = ID3D12Device_CreatePlacedResource(context->device, context->placed_heap,
+                (i & 15) * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, &resource_desc,
+                D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void **)&resource);
+        if (SUCCEEDED(hr))
+            ID3D12Resource_Release(resource);
+    }
+}
+
+static void record_texture_copies(void *userdata)
+{
+    struct benchmark_thread *thread = userdata;
+    struct benchmark_context *context = thread->context;
+    ID3D12GraphicsCommandList *list = thread->list;
+    D3D12_TEXTURE_COPY_LOCATION dst, src;
+    unsigned int i;
+
+    src.pResource = context->upload_buffer;
+    src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    src.PlacedFootprint.Offset = 0;
+    src.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    src.PlacedFootprint.Footprint.Width = 64;
+    src.PlacedFootprint.Footprint.Height = 64;
+    src.PlacedFootprint.Footprint.Depth = 1;
+    src.PlacedFootprint.Footprint.RowPitch = 64 * 4;
+
+    dst.pResource = context->copy_texture;
+    dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dst.SubresourceIndex = 0;
+
+    reset_command_list(list, thread->allocator);
+
+    /* Streaming uploads are typically many small tiles into an atlas or a mip chain. */
+    for (i = 0; i < thread->count; i++)
+    {
+        ID3D12GraphicsCommandList_CopyTextureRegion(list, &dst,
+                (i & 15) * 64, ((i >> 4) & 15) * 64, 0, &src, NULL);
+    }
+
+    ID3D12GraphicsCommandList_Close(list);
+}
+
+static void submit_command_lists(void *userdata)
+{
+    struct benchmark_thread *thread = userdata;
+    unsigned int i;
+
+    for (i = 0; i < thread->count; i++)
+        exec_command_list(thread->context->queue, thread->submit_lists[i]);
+}
+
+static unsigned int next_thread_count(unsigned int thread_count)
+{
+    if (thread_count < benchmark_thread_count && thread_count * 2 > benchmark_thread_count)
+        return benchmark_thread_count;
+    return thread_count * 2;
+}
+
+static void benchmark_recording(struct benchmark_context *context, const char *benchmark, const char *config,
+        thread_main_pfn main_pfn, unsigned int count, bool batched, unsigned int run)
+{
+    struct benchmark_thread threads[MAX_BENCHMARK_THREADS];
+    unsigned int thread_count, i;
+    double seconds;
+
+    for (thread_count = 1; thread_count <= benchmark_thread_count; thread_count = next_thread_count(thread_count))
+    {
+        init_benchmark_threads(context, threads, thread_count);
+        for (i = 0; i < thread_count; i++)
+        {
+            threads[i].count = count;
+            threads[i].batched = batched;
+        }
+
+        seconds = run_benchmark_threads(main_pfn, threads, thread_count);
+        report_result(run, benchmark, config, thread_count, count * thread_count, seconds);
+        destroy_benchmark_threads(threads, thread_count);
+    }
+}
+
+static void benchmark_submission(struct benchmark_context *context, unsigned int run)
+{
+    struct benchmark_thread threads[MAX_BENCHMARK_THREADS];
+    unsigned int thread_count, i, j;
+    double seconds;
+    HRESULT hr;
+
+    for (thread_count = 1; thread_count <= benchmark_thread_count; thread_count = next_thread_count(thread_count))
+    {
+        init_benchmark_threads(context, threads, thread_count);
+
+        /* Every list is only submitted once, so submissions never wait for the GPU to release a list. */
+        for (i = 0; i < thread_count; i++)
+        {
+            threads[i].count = SUBMIT_LIST_COUNT;
+            for (j = 0; j < SUBMIT_LIST_COUNT; j++)
+            {
+                hr = ID3D12Device_CreateCommandList(context->device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+                        threads[i].allocator, NULL, &IID_ID3D12GraphicsCommandList,
+                        (void **)&threads[i].submit_lists[j]);
+                ok(SUCCEEDED(hr), "Failed to create command list, hr %#x.\n", hr);
+                ID3D12GraphicsCommandList_Close(threads[i].submit_lists[j]);
+            }
+        }
+
+        seconds = run_benchmark_threads(submit_command_lists, threads, thread_count);
+        report_result(run, "execute_command_lists", "single_list", thread_count,
+                SUBMIT_LIST_COUNT * thread_count, seconds);
+
+        wait_queue_idle(context->device, context->queue);
+        for (i = 0; i < thread_count; i++)
+        {
+            for (j = 0; j < SUBMIT_LIST_COUNT; j++)
+                ID3D12GraphicsCommandList_Release(threads[i].submit_lists[j]);
+        }
+        destroy_benchmark_threads(threads, thread_count);
+    }
+}
+
+START_TEST(api_overhead_performance)
+{
+    struct benchmark_context context;
+    unsigned int i;
+
+    setup(argc, argv);
+    if (!init_benchmark_context(&context))
+    {
+        skip("Failed to initialize benchmark context.\n");
+        if (context.device)
+            destroy_benchmark_context(&context);
+        return;
+    }
+
+    for (i = 0; i < benchmark_iterations; i++)
+    {
+        benchmark_recording(&context, "draw_indexed_instanced", "root_constants_and_tables",
+                record_draws, 64 * 1024, false, i);
+        benchmark_recording(&context, "resource_barrier", "batched",
+                record_barriers, 64 * 1024, true, i);
+        benchmark_recording(&context, "resource_barrier", "single",
+                record_barriers, 64 * 1024, false, i);
+        benchmark_recording(&context, "create_resource", "committed_buffer",
+                create_committed_resources, 1024, false, i);
+        benchmark_recording(&context, "create_resource", "placed_buffer",
+                create_placed_resources, 1024, false, i);
+        benchmark_recording(&context, "copy_texture_region", "buffer_to_texture_64x64",
+                record_texture_copies, 16 * 1024, false, i);
+        if (context.shading_rate_images[0])
+        {
+            benchmark_recording(&context, "rs_set_shading_rate_image", "switch_every_4_draws",
+                    record_shading_rate_image_switches, 64 * 1024, false, i);
+        }
+        benchmark_submission(&context, i);
+    }
+
+    destroy_benchmark_context(&context);
+}
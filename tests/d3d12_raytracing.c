@@ -3967,6 +3967,82 @@ void test_raytracing_collection_identifiers(void)
     destroy_raytracing_test_context(&context);
 }
 
+void test_raytracing_many_exports_identifiers(void)
+{
+    const void *idents[256 + 1] = { NULL };
+    D3D12_HIT_GROUP_DESC hit_groups[256];
+    struct raytracing_test_context context;
+    ID3D12StateObjectProperties *props;
+    struct rt_pso_factory factory;
+    WCHAR names[256][16];
+    ID3D12StateObject *object;
+    const void *ident;
+    unsigned int i, j;
+    HRESULT hr;
+
+    if (!init_raytracing_test_context(&context, D3D12_RAYTRACING_TIER_1_0))
+        return;
+
+    /* Large state objects look up exports through a hash map. Make sure that every export
+     * still resolves to a stable identifier and that near-miss names do not resolve at all. */
+    memset(hit_groups, 0, sizeof(hit_groups));
+    for (i = 0; i < ARRAY_SIZE(hit_groups); i++)
+    {
+        static const char prefix[] = "HitGroup";
+
+        for (j = 0; j < ARRAY_SIZE(prefix) - 1; j++)
+            names[i][j] = prefix[j];
+        names[i][j++] = '0' + i / 100;
+        names[i][j++] = '0' + (i / 10) % 10;
+        names[i][j++] = '0' + i % 10;
+        names[i][j] = 0;
+
+        hit_groups[i].Type = D3D12_HIT_GROUP_TYPE_TRIANGLES;
+        hit_groups[i].HitGroupExport = names[i];
+    }
+
+    rt_pso_factory_init(&factory);
+    rt_pso_factory_add_dxil_library(&factory, get_dummy_raygen_rt_lib(), 0, NULL);
+    rt_pso_factory_add_state_object_config(&factory, D3D12_STATE_OBJECT_FLAG_NONE);
+    rt_pso_factory_add_pipeline_config(&factory, 1);
+    rt_pso_factory_add_shader_config(&factory, 8, 4);
+    for (i = 0; i < ARRAY_SIZE(hit_groups); i++)
+        rt_pso_factory_add_hit_group(&factory, &hit_groups[i]);
+    object = rt_pso_factory_compile(&context, &factory, D3D12_STATE_OBJECT_TYPE_RAYTRACING_PIPELINE);
+    ok(!!object, "Failed to create RTPSO.\n");
+
+    if (object)
+    {
+        hr = ID3D12StateObject_QueryInterface(object, &IID_ID3D12StateObjectProperties, (void **)&props);
+        ok(SUCCEEDED(hr), "Failed to query props interface, hr #%x.\n", hr);
+
+        for (i = 0; i < ARRAY_SIZE(hit_groups); i++)
+        {
+            idents[i] = ID3D12StateObjectProperties_GetShaderIdentifier(props, names[i]);
+            ok(!!idents[i], "Failed to query identifier for hit group %u.\n", i);
+        }
+
+        idents[i] = ID3D12StateObjectProperties_GetShaderIdentifier(props, u"main");
+        ok(!!idents[i], "Failed to query identifier for raygen.\n");
+
+        for (i = ARRAY_SIZE(hit_groups); i--; )
+        {
+            ident = ID3D12StateObjectProperties_GetShaderIdentifier(props, names[i]);
+            ok(ident == idents[i], "Mismatch in identifier pointer for hit group %u.\n", i);
+        }
+
+        ident = ID3D12StateObjectProperties_GetShaderIdentifier(props, u"HitGroup");
+        ok(!ident, "Unexpected identifier for non-existent export.\n");
+        ident = ID3D12StateObjectProperties_GetShaderIdentifier(props, u"HitGroup2560");
+        ok(!ident, "Unexpected identifier for non-existent export.\n");
+
+        ID3D12StateObjectProperties_Release(props);
+        ID3D12StateObject_Release(object);
+    }
+
+    destroy_raytracing_test_context(&context);
+}
+
 void test_raytracing_object_assignment_ignore_default(void)
 {
     struct raytracing_test_context context;
@@ -3385,3 +3385,128 @@ void test_aliasing_barrier_edge_cases(void)
 
     destroy_test_context(&context);
 }
+
+void test_transient_resource_slots(void)
+{
+    static const DXGI_FORMAT formats[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R8G8B8A8_UINT };
+    static const UINT clear_values[] = { 0xff0000ffu, 0x00345678u, 0x04030201u };
+    D3D12_TRANSIENT_RESOURCE_SLOT_DESC slot_descs[ARRAY_SIZE(formats)];
+    ID3D12Resource *resources[ARRAY_SIZE(formats)];
+    D3D12_RESOURCE_ALLOCATION_INFO alloc_info;
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv;
+    D3D12_RESOURCE_BARRIER barrier;
+    struct test_context_desc desc;
+    struct test_context context;
+    ID3D12DescriptorHeap *rtvs;
+    D3D12_HEAP_DESC heap_desc;
+    ID3D12DeviceExt2 *ext;
+    float color[4];
+    ID3D12Heap *heap;
+    unsigned int i;
+    HRESULT hr;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.no_render_target = true;
+    desc.no_pipeline = true;
+    desc.no_root_signature = true;
+    if (!init_test_context(&context, &desc))
+        return;
+
+    if (FAILED(ID3D12Device_QueryInterface(context.device, &IID_ID3D12DeviceExt2, (void **)&ext)))
+    {
+        skip("ID3D12DeviceExt2 not supported.\n");
+        destroy_test_context(&context);
+        return;
+    }
+
+    /* Every slot overlaps at offset 0. */
+    memset(slot_descs, 0, sizeof(slot_descs));
+    alloc_info.SizeInBytes = 0;
+    for (i = 0; i < ARRAY_SIZE(slot_descs); i++)
+    {
+        slot_descs[i].Desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        slot_descs[i].Desc.Width = 64;
+        slot_descs[i].Desc.Height = 64;
+        slot_descs[i].Desc.DepthOrArraySize = 1;
+        slot_descs[i].Desc.MipLevels = 1;
+        slot_descs[i].Desc.Format = formats[i];
+        slot_descs[i].Desc.SampleDesc.Count = 1;
+        slot_descs[i].Desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        slot_descs[i].Desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+        slot_descs[i].InitialState = D3D12_RESOURCE_STATE_RENDER_TARGET;
+        alloc_info.SizeInBytes = max(alloc_info.SizeInBytes, ID3D12Device_GetResourceAllocationInfo(context.device,
+                0, 1, (const D3D12_RESOURCE_DESC *)&slot_descs[i].Desc).SizeInBytes);
+    }
+
+    memset(&heap_desc, 0, sizeof(heap_desc));
+    heap_desc.SizeInBytes = alloc_info.SizeInBytes;
+    heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heap_desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+    hr = ID3D12Device_CreateHeap(context.device, &heap_desc, &IID_ID3D12Heap, (void **)&heap);
+    ok(hr == S_OK, "Failed to create heap, hr %#x.\n", hr);
+
+    hr = ID3D12DeviceExt2_CreateTransientResourceSlots(ext, heap, 0, slot_descs, &IID_ID3D12Resource, (void **)resources);
+    ok(hr == E_INVALIDARG, "Got unexpected hr %#x.\n", hr);
+
+    /* A slot which does not fit fails the whole set. */
+    slot_descs[1].HeapOffset = heap_desc.SizeInBytes;
+    memset(resources, 0, sizeof(resources));
+    hr = ID3D12DeviceExt2_CreateTransientResourceSlots(ext, heap, ARRAY_SIZE(slot_descs), slot_descs,
+            &IID_ID3D12Resource, (void **)resources);
+    ok(hr == E_INVALIDARG, "Got unexpected hr %#x.\n", hr);
+    ok(!resources[0] && !resources[1] && !resources[2], "Got unexpected resources.\n");
+    slot_descs[1].HeapOffset = 0;
+
+    hr = ID3D12DeviceExt2_CreateTransientResourceSlots(ext, heap, ARRAY_SIZE(slot_descs), slot_descs,
+            &IID_ID3D12Resource, (void **)resources);
+    ok(hr == S_OK, "Failed to create transient resource slots, hr %#x.\n", hr);
+
+    rtvs = create_cpu_descriptor_heap(context.device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 1);
+    rtv = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(rtvs);
+
+    /* Activate each slot in turn, as a frame graph would between passes. */
+    for (i = 0; i < ARRAY_SIZE(resources); i++)
+    {
+        vkd3d_test_set_context("Slot %u", i);
+
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Aliasing.pResourceBefore = i ? resources[i - 1] : NULL;
+        barrier.Aliasing.pResourceAfter = resources[i];
+        ID3D12GraphicsCommandList_ResourceBarrier(context.list, 1, &barrier);
+
+        if (formats[i] == DXGI_FORMAT_R8G8B8A8_UNORM)
+        {
+            color[0] = (float)(clear_values[i] & 0xff) / 255.0f;
+            color[1] = (float)((clear_values[i] >> 8) & 0xff) / 255.0f;
+            color[2] = (float)((clear_values[i] >> 16) & 0xff) / 255.0f;
+            color[3] = (float)(clear_values[i] >> 24) / 255.0f;
+        }
+        else if (formats[i] == DXGI_FORMAT_R32_UINT)
+        {
+            color[0] = (float)clear_values[i];
+            color[1] = color[2] = color[3] = 0.0f;
+        }
+        else
+        {
+            color[0] = (float)(clear_values[i] & 0xff);
+            color[1] = (float)((clear_values[i] >> 8) & 0xff);
+            color[2] = (float)((clear_values[i] >> 16) & 0xff);
+            color[3] = (float)(clear_values[i] >> 24);
+        }
+
+        ID3D12Device_CreateRenderTargetView(context.device, resources[i], NULL, rtv);
+        ID3D12GraphicsCommandList_ClearRenderTargetView(context.list, rtv, color, 0, NULL);
+        transition_resource_state(context.list, resources[i], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        check_sub_resource_uint(resources[i], 0, context.queue, context.list, clear_values[i], 0);
+        reset_command_list(context.list, context.allocator);
+    }
+    vkd3d_test_set_context(NULL);
+
+    ID3D12DescriptorHeap_Release(rtvs);
+    for (i = 0; i < ARRAY_SIZE(resources); i++)
+        ID3D12Resource_Release(resources[i]);
+    ID3D12Heap_Release(heap);
+    ID3D12DeviceExt2_Release(ext);
+    destroy_test_context(&context);
+}
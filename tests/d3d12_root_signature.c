@@ -26,8 +26,8 @@ void test_create_root_signature(void)
 {
     D3D12_ROOT_SIGNATURE_DESC root_signature_desc;
     D3D12_DESCRIPTOR_RANGE descriptor_ranges[2];
+    ID3D12RootSignature *root_signature, *root_signature2;
     D3D12_ROOT_PARAMETER root_parameters[3];
-    ID3D12RootSignature *root_signature;
     ID3D12Device *device, *tmp_device;
     ULONG refcount;
     HRESULT hr;
@@ -160,6 +160,14 @@ void test_create_root_signature(void)
     root_parameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_GEOMETRY;
     hr = create_root_signature(device, &root_signature_desc, &root_signature);
     ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
+
+    /* Identical blobs return the same object while it is alive. */
+    hr = create_root_signature(device, &root_signature_desc, &root_signature2);
+    ok(hr == S_OK, "Failed to create root signature, hr %#x.\n", hr);
+    ok(root_signature2 == root_signature, "Expected identical root signature objects.\n");
+    refcount = ID3D12RootSignature_Release(root_signature2);
+    ok(refcount == 1, "Got unexpected refcount %u.\n", (unsigned int)refcount);
+
     refcount = ID3D12RootSignature_Release(root_signature);
     ok(!refcount, "ID3D12RootSignature has %u references left.\n", (unsigned int)refcount);
 
@@ -1376,6 +1376,151 @@ void test_copy_tiles(void)
 #undef TILE_SIZE
 }
 
+static double get_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER lc, lf;
+    QueryPerformanceCounter(&lc);
+    QueryPerformanceFrequency(&lf);
+    return (double)lc.QuadPart / (double)lf.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+void test_copy_tile_mappings_large(void)
+{
+#define TILE_SIZE 65536
+#define TILE_COUNT 65536
+#define HEAP_TILE_COUNT 64
+    static const uint32_t check_tiles[] = { 0, 1, 63, 64, 1000, 32767, 32768, TILE_COUNT - 1 };
+    UINT range_offsets[TILE_COUNT / HEAP_TILE_COUNT], range_counts[TILE_COUNT / HEAP_TILE_COUNT];
+    ID3D12Resource *src_tiled, *dst_tiled, *heap_buffer, *readback_buffer;
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options;
+    D3D12_TILED_RESOURCE_COORDINATE region_offset;
+    D3D12_TILE_REGION_SIZE region_size;
+    D3D12_RESOURCE_DESC resource_desc;
+    double start_time, end_time;
+    struct resource_readback rb;
+    struct test_context context;
+    D3D12_HEAP_DESC heap_desc;
+    uint32_t *buffer_data;
+    ID3D12Heap *heap;
+    unsigned int i;
+    HRESULT hr;
+
+    if (!init_compute_test_context(&context))
+        return;
+
+    hr = ID3D12Device_CheckFeatureSupport(context.device, D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+    ok(hr == S_OK, "Failed to check feature support, hr %#x.\n", hr);
+
+    if (!options.TiledResourcesTier)
+    {
+        skip("Tiled resources not supported by device.\n");
+        destroy_test_context(&context);
+        return;
+    }
+
+    memset(&heap_desc, 0, sizeof(heap_desc));
+    heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heap_desc.SizeInBytes = TILE_SIZE * HEAP_TILE_COUNT;
+    heap_desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    hr = ID3D12Device_CreateHeap(context.device, &heap_desc, &IID_ID3D12Heap, (void **)&heap);
+    ok(hr == S_OK, "Failed to create heap, hr %#x.\n", hr);
+
+    heap_buffer = create_placed_buffer(context.device, heap, 0, heap_desc.SizeInBytes,
+            D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    /* Tag every heap tile with its index. */
+    buffer_data = malloc(heap_desc.SizeInBytes);
+    for (i = 0; i < heap_desc.SizeInBytes / sizeof(*buffer_data); i++)
+        buffer_data[i] = i / (TILE_SIZE / sizeof(*buffer_data));
+    upload_buffer_data(heap_buffer, 0, heap_desc.SizeInBytes, buffer_data, context.queue, context.list);
+    free(buffer_data);
+
+    memset(&resource_desc, 0, sizeof(resource_desc));
+    resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resource_desc.Width = (UINT64)TILE_SIZE * TILE_COUNT;
+    resource_desc.Height = 1;
+    resource_desc.DepthOrArraySize = 1;
+    resource_desc.MipLevels = 1;
+    resource_desc.Format = DXGI_FORMAT_UNKNOWN;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    hr = ID3D12Device_CreateReservedResource(context.device, &resource_desc,
+            D3D12_RESOURCE_STATE_COPY_SOURCE, NULL, &IID_ID3D12Resource, (void **)&src_tiled);
+    if (FAILED(hr))
+    {
+        skip("Failed to create %u-tile reserved buffer, hr %#x.\n", TILE_COUNT, hr);
+        ID3D12Resource_Release(heap_buffer);
+        ID3D12Heap_Release(heap);
+        destroy_test_context(&context);
+        return;
+    }
+
+    hr = ID3D12Device_CreateReservedResource(context.device, &resource_desc,
+            D3D12_RESOURCE_STATE_COPY_SOURCE, NULL, &IID_ID3D12Resource, (void **)&dst_tiled);
+    ok(hr == S_OK, "Failed to create reserved buffer, hr %#x.\n", hr);
+
+    /* Map the source resource to the heap repeatedly, which yields one mapping run per heap wrap-around. */
+    for (i = 0; i < ARRAY_SIZE(range_offsets); i++)
+    {
+        range_offsets[i] = 0;
+        range_counts[i] = HEAP_TILE_COUNT;
+    }
+
+    set_region_offset(&region_offset, 0, 0, 0, 0);
+    set_region_size(&region_size, TILE_COUNT, false, 0, 0, 0);
+
+    ID3D12CommandQueue_UpdateTileMappings(context.queue, src_tiled, 1, &region_offset, &region_size,
+            heap, ARRAY_SIZE(range_offsets), NULL, range_offsets, range_counts, D3D12_TILE_MAPPING_FLAG_NONE);
+    wait_queue_idle(context.device, context.queue);
+
+    start_time = get_time();
+    ID3D12CommandQueue_CopyTileMappings(context.queue, dst_tiled, &region_offset,
+            src_tiled, &region_offset, &region_size, D3D12_TILE_MAPPING_FLAG_NONE);
+    wait_queue_idle(context.device, context.queue);
+    end_time = get_time();
+
+    trace("CopyTileMappings (%u tiles): %.3f ms.\n", TILE_COUNT, 1e3 * (end_time - start_time));
+
+    readback_buffer = create_default_buffer(context.device, ARRAY_SIZE(check_tiles) * sizeof(uint32_t),
+            D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    for (i = 0; i < ARRAY_SIZE(check_tiles); i++)
+    {
+        ID3D12GraphicsCommandList_CopyBufferRegion(context.list, readback_buffer, i * sizeof(uint32_t),
+                dst_tiled, (UINT64)check_tiles[i] * TILE_SIZE, sizeof(uint32_t));
+    }
+
+    transition_resource_state(context.list, readback_buffer,
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    get_buffer_readback_with_command_list(readback_buffer, DXGI_FORMAT_R32_UINT, &rb, context.queue, context.list);
+
+    for (i = 0; i < ARRAY_SIZE(check_tiles); i++)
+    {
+        uint32_t value = get_readback_uint(&rb, i, 0, 0);
+        ok(value == check_tiles[i] % HEAP_TILE_COUNT, "Got %u, expected %u for tile %u.\n",
+                value, check_tiles[i] % HEAP_TILE_COUNT, check_tiles[i]);
+    }
+
+    release_resource_readback(&rb);
+
+    ID3D12Resource_Release(readback_buffer);
+    ID3D12Resource_Release(dst_tiled);
+    ID3D12Resource_Release(src_tiled);
+    ID3D12Resource_Release(heap_buffer);
+    ID3D12Heap_Release(heap);
+    destroy_test_context(&context);
+#undef HEAP_TILE_COUNT
+#undef TILE_COUNT
+#undef TILE_SIZE
+}
+
 static void test_buffer_feedback_instructions(bool use_dxil)
 {
 #define TILE_SIZE 65536
@@ -240,6 +240,7 @@ decl_test(test_get_resource_tiling);
 decl_test(test_update_tile_mappings);
 decl_test(test_sampler_border_color);
 decl_test(test_copy_tiles);
+decl_test(test_copy_tile_mappings_large);
 decl_test(test_buffer_feedback_instructions_sm51);
 decl_test(test_buffer_feedback_instructions_dxil);
 decl_test(test_texture_feedback_instructions_sm51);
@@ -307,6 +308,7 @@ decl_test(test_rayquery);
 decl_test(test_typed_srv_uav_cast);
 decl_test(test_typed_srv_cast_clear);
 decl_test(test_aliasing_barrier_edge_cases);
+decl_test(test_transient_resource_slots);
 decl_test(test_mesh_shader_create_pipeline);
 decl_test(test_mesh_shader_rendering);
 decl_test(test_mesh_shader_execute_indirect);
@@ -322,6 +324,7 @@ decl_test(test_raytracing_reject_duplicate_objects);
 decl_test(test_raytracing_embedded_subobjects);
 decl_test(test_raytracing_default_association_tiebreak);
 decl_test(test_raytracing_collection_identifiers);
+decl_test(test_raytracing_many_exports_identifiers);
 decl_test(test_fence_wait_robustness);
 decl_test(test_fence_wait_robustness_shared);
 decl_test(test_fence_wait_multiple);
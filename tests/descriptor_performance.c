@@ -22,8 +22,21 @@
 #define VKD3D_TEST_DECLARE_MAIN
 #include "d3d12_crosstest.h"
 
+enum benchmark_output_format
+{
+    BENCHMARK_OUTPUT_TEXT,
+    BENCHMARK_OUTPUT_CSV,
+    BENCHMARK_OUTPUT_JSON,
+};
+
+static enum benchmark_output_format output_format = BENCHMARK_OUTPUT_TEXT;
+static unsigned int benchmark_iterations = 100;
+static unsigned int benchmark_thread_count = 4;
+
 static void setup(int argc, char **argv)
 {
+    int i;
+
     pfn_D3D12CreateDevice = get_d3d12_pfn(D3D12CreateDevice);
     pfn_D3D12EnableExperimentalFeatures = get_d3d12_pfn(D3D12EnableExperimentalFeatures);
     pfn_D3D12GetDebugInterface = get_d3d12_pfn(D3D12GetDebugInterface);
@@ -34,6 +47,46 @@ static void setup(int argc, char **argv)
 
     pfn_D3D12CreateVersionedRootSignatureDeserializer = get_d3d12_pfn(D3D12CreateVersionedRootSignatureDeserializer);
     pfn_D3D12SerializeVersionedRootSignature = get_d3d12_pfn(D3D12SerializeVersionedRootSignature);
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--csv"))
+            output_format = BENCHMARK_OUTPUT_CSV;
+        else if (!strcmp(argv[i], "--json"))
+            output_format = BENCHMARK_OUTPUT_JSON;
+        else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+            benchmark_iterations = max(atoi(argv[++i]), 1);
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            benchmark_thread_count = max(atoi(argv[++i]), 1);
+    }
+
+    if (output_format == BENCHMARK_OUTPUT_CSV)
+        printf("run,benchmark,config,count,total_ms,ns_per_item\n");
+}
+
+/* Emits one result. CSV and JSON (one object per line) are meant for tracking regressions across releases. */
+static void report_result(unsigned int run, const char *benchmark, const char *config,
+        unsigned int count, double seconds)
+{
+    double ns_per_item = count ? 1e9 * seconds / (double)count : 0.0;
+
+    switch (output_format)
+    {
+        case BENCHMARK_OUTPUT_CSV:
+            printf("%u,%s,%s,%u,%.6f,%.3f\n", run, benchmark, config, count, 1e3 * seconds, ns_per_item);
+            break;
+
+        case BENCHMARK_OUTPUT_JSON:
+            printf("{\"run\": %u, \"benchmark\": \"%s\", \"config\": \"%s\", \"count\": %u, "
+                    "\"total_ms\": %.6f, \"ns_per_item\": %.3f}\n",
+                    run, benchmark, config, count, 1e3 * seconds, ns_per_item);
+            break;
+
+        default:
+            printf("%s (%s, %u items) took: %.3f ms (%.3f ns / item).\n",
+                    benchmark, config, count, 1e3 * seconds, ns_per_item);
+            break;
+    }
 }
 
 static double get_time(void)
@@ -95,6 +148,40 @@ static void copy_descriptor_heap_single(ID3D12Device *device, ID3D12DescriptorHe
     }
 }
 
+static void copy_descriptor_heap_ranges(ID3D12Device *device, ID3D12DescriptorHeap *gpu_heap,
+        ID3D12DescriptorHeap *cpu_heap, unsigned int count, unsigned int src_range_size)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE src_ranges[64];
+    D3D12_CPU_DESCRIPTOR_HANDLE dst_range;
+    D3D12_CPU_DESCRIPTOR_HANDLE gpu;
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu;
+    UINT src_range_sizes[64];
+    unsigned int i, j, table;
+    UINT dst_range_size;
+    UINT64 increment;
+
+    gpu = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(gpu_heap);
+    cpu = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+    increment = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    dst_range_size = ARRAY_SIZE(src_ranges) * src_range_size;
+
+    /* Build tables of 64 ranges gathered from scattered locations in the CPU heap. */
+    for (table = 0; table + dst_range_size <= count; table += dst_range_size)
+    {
+        for (i = 0; i < ARRAY_SIZE(src_ranges); i++)
+        {
+            j = (table + i * 997 * src_range_size) % (count - src_range_size);
+            src_ranges[i].ptr = cpu.ptr + j * increment;
+            src_range_sizes[i] = src_range_size;
+        }
+
+        dst_range.ptr = gpu.ptr + table * increment;
+        ID3D12Device_CopyDescriptors(device, 1, &dst_range, &dst_range_size,
+                ARRAY_SIZE(src_ranges), src_ranges, src_range_sizes,
+                D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+}
+
 static void zero_descriptor_heap(ID3D12Device *device, ID3D12DescriptorHeap *heap, unsigned int count)
 {
     D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc;
@@ -108,125 +195,421 @@ static void zero_descriptor_heap(ID3D12Device *device, ID3D12DescriptorHeap *hea
     fill_descriptor_heap_srv(device, heap, NULL, &srv_desc, count);
 }
 
-static void do_benchmark_run(ID3D12Device *device)
+static ID3D12DescriptorHeap *create_benchmark_heap(ID3D12Device *device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+        D3D12_DESCRIPTOR_HEAP_FLAGS flags, unsigned int count)
 {
-    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc;
     D3D12_DESCRIPTOR_HEAP_DESC heap_desc;
-    ID3D12DescriptorHeap *gpu_heap;
-    ID3D12DescriptorHeap *cpu_heap;
-    double start_time, end_time;
-    ID3D12Resource *texture;
+    ID3D12DescriptorHeap *heap;
     HRESULT hr;
 
-    heap_desc.NumDescriptors = 1000000;
-    heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-    heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heap_desc.NumDescriptors = count;
+    heap_desc.Flags = flags;
+    heap_desc.Type = type;
     heap_desc.NodeMask = 0;
-    hr = ID3D12Device_CreateDescriptorHeap(device, &heap_desc, &IID_ID3D12DescriptorHeap, (void**)&cpu_heap);
+    hr = ID3D12Device_CreateDescriptorHeap(device, &heap_desc, &IID_ID3D12DescriptorHeap, (void**)&heap);
     ok(SUCCEEDED(hr), "Failed to create descriptor heap, hr #%x.\n", hr);
+    return SUCCEEDED(hr) ? heap : NULL;
+}
 
-    heap_desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    hr = ID3D12Device_CreateDescriptorHeap(device, &heap_desc, &IID_ID3D12DescriptorHeap, (void**)&gpu_heap);
-    ok(SUCCEEDED(hr), "Failed to create descriptor heap, hr #%x.\n", hr);
+static void benchmark_heap_creation(ID3D12Device *device, unsigned int run)
+{
+    static const struct
+    {
+        D3D12_DESCRIPTOR_HEAP_TYPE type;
+        D3D12_DESCRIPTOR_HEAP_FLAGS flags;
+        const char *config;
+    }
+    heap_types[] =
+    {
+        { D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12_DESCRIPTOR_HEAP_FLAG_NONE, "cbv_srv_uav_cpu" },
+        { D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, "cbv_srv_uav_gpu" },
+    };
+    static const unsigned int counts[] = { 1024, 16 * 1024, 256 * 1024, 1000000 };
+    const unsigned int repeat_count = 8;
+    double start_time, end_time;
+    ID3D12DescriptorHeap *heap;
+    unsigned int i, j, k;
+    char config[64];
 
-    texture = create_default_texture2d(device,
-                                       256, 256, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                       D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-    ok(texture != NULL, "Failed to create texture.\n");
+    for (i = 0; i < ARRAY_SIZE(heap_types); i++)
+    {
+        for (j = 0; j < ARRAY_SIZE(counts); j++)
+        {
+            sprintf(config, "%s_%u", heap_types[i].config, counts[j]);
+
+            start_time = get_time();
+            for (k = 0; k < repeat_count; k++)
+            {
+                if ((heap = create_benchmark_heap(device, heap_types[i].type, heap_types[i].flags, counts[j])))
+                    ID3D12DescriptorHeap_Release(heap);
+            }
+            end_time = get_time();
+
+            report_result(run, "create_heap", config, repeat_count, end_time - start_time);
+        }
+    }
 
-    srv_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    /* Sampler heaps are capped at 2048 descriptors in shader visible heaps. */
+    start_time = get_time();
+    for (k = 0; k < repeat_count; k++)
+    {
+        if ((heap = create_benchmark_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+                D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, 2048)))
+            ID3D12DescriptorHeap_Release(heap);
+    }
+    end_time = get_time();
+    report_result(run, "create_heap", "sampler_gpu_2048", repeat_count, end_time - start_time);
+}
+
+static void benchmark_view_creation(ID3D12Device *device, ID3D12DescriptorHeap *cpu_heap,
+        ID3D12DescriptorHeap *sampler_heap, ID3D12Resource *buffer, unsigned int run)
+{
+    D3D12_CONSTANT_BUFFER_VIEW_DESC cbv_desc;
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uav_desc;
+    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc;
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu_handle;
+    const unsigned int view_count = 100000;
+    D3D12_SAMPLER_DESC sampler_desc;
+    double start_time, end_time;
+    UINT stride, i;
+
+    memset(&srv_desc, 0, sizeof(srv_desc));
+    srv_desc.Format = DXGI_FORMAT_R32_UINT;
+    srv_desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
     srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-    srv_desc.Texture2D.MipLevels = 1;
-    srv_desc.Texture2D.MostDetailedMip = 0;
-    srv_desc.Texture2D.PlaneSlice = 0;
-    srv_desc.Texture2D.ResourceMinLODClamp = 0.0f;
+    srv_desc.Buffer.NumElements = 1024;
 
-    /* Benchmark creation of 1 million SRVs in CPU-only heaps. */
+    memset(&uav_desc, 0, sizeof(uav_desc));
+    uav_desc.Format = DXGI_FORMAT_R32_UINT;
+    uav_desc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+    uav_desc.Buffer.NumElements = 1024;
+
+    cbv_desc.BufferLocation = ID3D12Resource_GetGPUVirtualAddress(buffer);
+    cbv_desc.SizeInBytes = 256;
+
+    memset(&sampler_desc, 0, sizeof(sampler_desc));
+    sampler_desc.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler_desc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler_desc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler_desc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
+    sampler_desc.MaxLOD = 1000.0f;
+
+    stride = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    cpu_handle = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+    start_time = get_time();
+    for (i = 0; i < view_count; i++, cpu_handle.ptr += stride)
     {
-        start_time = get_time();
-        fill_descriptor_heap_srv(device, cpu_heap, texture, &srv_desc, 1000000);
-        end_time = get_time();
-        printf("Creating 1M SRVs on blank CPU heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        srv_desc.Buffer.FirstElement = i & 1023;
+        ID3D12Device_CreateShaderResourceView(device, buffer, &srv_desc, cpu_handle);
     }
+    end_time = get_time();
+    report_result(run, "create_view", "srv_buffer", view_count, end_time - start_time);
 
-    /* Do the same thing again, but this time on a used heap, so we also have to destroy existing views. */
+    cpu_handle = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+    start_time = get_time();
+    for (i = 0; i < view_count; i++, cpu_handle.ptr += stride)
     {
-        start_time = get_time();
-        fill_descriptor_heap_srv(device, cpu_heap, texture, &srv_desc, 1000000);
-        end_time = get_time();
-        printf("Creating 1M SRVs on dirty CPU heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        uav_desc.Buffer.FirstElement = i & 1023;
+        ID3D12Device_CreateUnorderedAccessView(device, buffer, NULL, &uav_desc, cpu_handle);
     }
+    end_time = get_time();
+    report_result(run, "create_view", "uav_buffer", view_count, end_time - start_time);
 
-    /* Fill shader visible heaps */
+    cpu_handle = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+    start_time = get_time();
+    for (i = 0; i < view_count; i++, cpu_handle.ptr += stride)
     {
-        start_time = get_time();
-        fill_descriptor_heap_srv(device, gpu_heap, texture, &srv_desc, 1000000);
-        end_time = get_time();
-        printf("Creating 1M SRVs on blank GPU-visible heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        cbv_desc.BufferLocation = ID3D12Resource_GetGPUVirtualAddress(buffer) + (i & 1023) * 256;
+        ID3D12Device_CreateConstantBufferView(device, &cbv_desc, cpu_handle);
     }
+    end_time = get_time();
+    report_result(run, "create_view", "cbv", view_count, end_time - start_time);
 
-    /* Do the same thing again, but this time on a used heap, so we also have to destroy existing views. */
+    stride = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+    start_time = get_time();
+    for (i = 0; i < view_count; i++)
     {
-        start_time = get_time();
-        fill_descriptor_heap_srv(device, gpu_heap, texture, &srv_desc, 1000000);
-        end_time = get_time();
-        printf("Creating 1M SRVs on dirty GPU-visible heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        /* Cycle through a handful of unique samplers like a real application would. */
+        cpu_handle = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(sampler_heap);
+        cpu_handle.ptr += (i & 2047) * stride;
+        sampler_desc.MaxAnisotropy = 1 + (i & 15);
+        ID3D12Device_CreateSampler(device, &sampler_desc, cpu_handle);
     }
+    end_time = get_time();
+    report_result(run, "create_view", "sampler", view_count, end_time - start_time);
+}
+
+struct copy_thread_data
+{
+    ID3D12Device *device;
+    D3D12_CPU_DESCRIPTOR_HANDLE dst;
+    D3D12_CPU_DESCRIPTOR_HANDLE src;
+    unsigned int src_count;
+    unsigned int dst_count;
+    unsigned int seed;
+};
+
+static unsigned int lcg_next(unsigned int *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 8;
+}
 
-    /* Try copying descriptors */
+static void copy_descriptor_random_ranges(void *userdata)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE src_ranges[32];
+    struct copy_thread_data *data = userdata;
+    UINT src_range_sizes[32];
+    D3D12_CPU_DESCRIPTOR_HANDLE dst;
+    unsigned int i, offset, size;
+    unsigned int state;
+    UINT dst_range_size;
+    UINT64 increment;
+
+    increment = ID3D12Device_GetDescriptorHandleIncrementSize(data->device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    state = data->seed;
+
+    for (offset = 0; offset + ARRAY_SIZE(src_ranges) * 16 <= data->dst_count; offset += dst_range_size)
     {
-        start_time = get_time();
-        copy_descriptor_heap(device, gpu_heap, cpu_heap, 1000000);
-        end_time = get_time();
-        printf("Copying 1M SRVs to dirty GPU visible heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        dst_range_size = 0;
+        for (i = 0; i < ARRAY_SIZE(src_ranges); i++)
+        {
+            size = 1 + lcg_next(&state) % 16;
+            src_ranges[i].ptr = data->src.ptr + (lcg_next(&state) % (data->src_count - size)) * increment;
+            src_range_sizes[i] = size;
+            dst_range_size += size;
+        }
+
+        dst.ptr = data->dst.ptr + offset * increment;
+        ID3D12Device_CopyDescriptors(data->device, 1, &dst, &dst_range_size,
+                ARRAY_SIZE(src_ranges), src_ranges, src_range_sizes,
+                D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
     }
+}
 
-    /* Try copying descriptors with duplication */
+static void benchmark_copy_random_ranges(ID3D12Device *device, ID3D12DescriptorHeap *gpu_heap,
+        ID3D12DescriptorHeap *cpu_heap, unsigned int count, unsigned int thread_count, unsigned int run)
+{
+    struct copy_thread_data data[64];
+    double start_time, end_time;
+    HANDLE threads[64];
+    unsigned int i, per_thread;
+    UINT64 increment;
+    char config[64];
+
+    thread_count = min(thread_count, ARRAY_SIZE(threads));
+    per_thread = count / thread_count;
+    increment = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    /* Every thread writes to its own slice of the destination heap, sources are shared. */
+    for (i = 0; i < thread_count; i++)
     {
-        start_time = get_time();
-        copy_descriptor_heap(device, gpu_heap, cpu_heap, 1000000);
-        end_time = get_time();
-        printf("Copying 1M SRVs (duplicates) took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        data[i].device = device;
+        data[i].src = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_heap);
+        data[i].dst = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(gpu_heap);
+        data[i].dst.ptr += i * per_thread * increment;
+        data[i].src_count = count;
+        data[i].dst_count = per_thread;
+        data[i].seed = 1234 + i;
     }
 
-    /* Create zero descriptors. */
+    start_time = get_time();
+    if (thread_count == 1)
+        copy_descriptor_random_ranges(&data[0]);
+    else
     {
-        start_time = get_time();
-        zero_descriptor_heap(device, gpu_heap, 1000000);
-        end_time = get_time();
-        printf("Creating 1M null-SRVs took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        for (i = 0; i < thread_count; i++)
+            threads[i] = create_thread(copy_descriptor_random_ranges, &data[i]);
+        for (i = 0; i < thread_count; i++)
+            ok(join_thread(threads[i]), "Failed to join thread %u.\n", i);
     }
+    end_time = get_time();
+
+    sprintf(config, "random_ranges_%u_threads", thread_count);
+    report_result(run, "copy_descriptors", config, per_thread * thread_count, end_time - start_time);
+}
+
+static void benchmark_copy_simple_variants(ID3D12Device *device, ID3D12DescriptorHeap *gpu_heap,
+        ID3D12DescriptorHeap *cpu_heap, ID3D12DescriptorHeap *cpu_heap2,
+        ID3D12DescriptorHeap *gpu_sampler_heap, ID3D12DescriptorHeap *cpu_sampler_heap,
+        unsigned int count, unsigned int run)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE dst, src;
+    double start_time, end_time;
+    UINT64 increment;
+    unsigned int i;
+
+    /* CopyDescriptorsSimple dispatches to different kernels depending on descriptor count,
+     * heap type and whether the destination is shader visible, so time each combination. */
+    start_time = get_time();
+    copy_descriptor_heap(device, gpu_heap, cpu_heap, count);
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "cbv_srv_uav_cpu_to_gpu_bulk", count, end_time - start_time);
+
+    start_time = get_time();
+    copy_descriptor_heap_single(device, gpu_heap, cpu_heap, count);
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "cbv_srv_uav_cpu_to_gpu_single", count, end_time - start_time);
+
+    start_time = get_time();
+    copy_descriptor_heap(device, cpu_heap2, cpu_heap, count);
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "cbv_srv_uav_cpu_to_cpu_bulk", count, end_time - start_time);
+
+    start_time = get_time();
+    copy_descriptor_heap_single(device, cpu_heap2, cpu_heap, count);
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "cbv_srv_uav_cpu_to_cpu_single", count, end_time - start_time);
 
-    /* Try copying descriptors on top of zero-initialized descriptor heap. */
+    increment = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+
+    start_time = get_time();
+    for (i = 0; i < count / 2048; i++)
     {
-        start_time = get_time();
-        copy_descriptor_heap(device, gpu_heap, cpu_heap, 1000000);
-        end_time = get_time();
-        printf("Copying 1M SRVs to zeroed GPU visible heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        ID3D12Device_CopyDescriptorsSimple(device, 2048,
+                ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(gpu_sampler_heap),
+                ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_sampler_heap),
+                D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
     }
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "sampler_cpu_to_gpu_bulk", (count / 2048) * 2048,
+            end_time - start_time);
 
-    /* Try copying descriptors one at a time on top of zero-initialized descriptor heap. */
+    start_time = get_time();
+    for (i = 0; i < count; i++)
     {
-        start_time = get_time();
-        copy_descriptor_heap_single(device, gpu_heap, cpu_heap, 1000000);
-        end_time = get_time();
-        printf("Copying 1M individual SRVs to GPU visible heap (duplicates) took: %.3f ms.\n", 1e3 * (end_time - start_time));
+        dst = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(gpu_sampler_heap);
+        src = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(cpu_sampler_heap);
+        dst.ptr += (i & 2047) * increment;
+        src.ptr += (i & 2047) * increment;
+        ID3D12Device_CopyDescriptorsSimple(device, 1, dst, src, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
     }
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "sampler_cpu_to_gpu_single", count, end_time - start_time);
+}
 
-    /* Create zero descriptors. */
-    zero_descriptor_heap(device, gpu_heap, 1000000);
+static void do_benchmark_run(ID3D12Device *device, unsigned int run)
+{
+    ID3D12DescriptorHeap *gpu_sampler_heap, *cpu_sampler_heap;
+    ID3D12DescriptorHeap *gpu_heap, *cpu_heap, *cpu_heap2;
+    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc;
+    const unsigned int count = 1000000;
+    double start_time, end_time;
+    ID3D12Resource *texture;
+    ID3D12Resource *buffer;
+
+    cpu_heap = create_benchmark_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            D3D12_DESCRIPTOR_HEAP_FLAG_NONE, count);
+    cpu_heap2 = create_benchmark_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            D3D12_DESCRIPTOR_HEAP_FLAG_NONE, count);
+    gpu_heap = create_benchmark_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, count);
+    cpu_sampler_heap = create_benchmark_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+            D3D12_DESCRIPTOR_HEAP_FLAG_NONE, 2048);
+    gpu_sampler_heap = create_benchmark_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
+            D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, 2048);
+
+    if (!cpu_heap || !cpu_heap2 || !gpu_heap || !cpu_sampler_heap || !gpu_sampler_heap)
+        goto out;
 
-    {
-        start_time = get_time();
-        copy_descriptor_heap_single(device, gpu_heap, cpu_heap, 1000000);
-        end_time = get_time();
-        printf("Copying 1M individual SRVs to zeroed GPU visible heap took: %.3f ms.\n", 1e3 * (end_time - start_time));
-    }
+    texture = create_default_texture2d(device,
+                                       256, 256, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM,
+                                       D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    ok(texture != NULL, "Failed to create texture.\n");
+
+    buffer = create_default_buffer(device, 256 * 1024, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    ok(buffer != NULL, "Failed to create buffer.\n");
 
+    srv_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srv_desc.Texture2D.MipLevels = 1;
+    srv_desc.Texture2D.MostDetailedMip = 0;
+    srv_desc.Texture2D.PlaneSlice = 0;
+    srv_desc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+    benchmark_heap_creation(device, run);
+    benchmark_view_creation(device, cpu_heap, cpu_sampler_heap, buffer, run);
+
+    /* Benchmark creation of 1 million SRVs in CPU-only heaps. */
+    start_time = get_time();
+    fill_descriptor_heap_srv(device, cpu_heap, texture, &srv_desc, count);
+    end_time = get_time();
+    report_result(run, "fill_srv_texture", "cpu_heap", count, end_time - start_time);
+
+    /* Do the same thing again, but this time on a used heap, so we also have to destroy existing views. */
+    start_time = get_time();
+    fill_descriptor_heap_srv(device, cpu_heap, texture, &srv_desc, count);
+    end_time = get_time();
+    report_result(run, "fill_srv_texture", "cpu_heap_dirty", count, end_time - start_time);
+
+    /* Fill shader visible heaps */
+    start_time = get_time();
+    fill_descriptor_heap_srv(device, gpu_heap, texture, &srv_desc, count);
+    end_time = get_time();
+    report_result(run, "fill_srv_texture", "gpu_heap", count, end_time - start_time);
+
+    start_time = get_time();
+    fill_descriptor_heap_srv(device, gpu_heap, texture, &srv_desc, count);
+    end_time = get_time();
+    report_result(run, "fill_srv_texture", "gpu_heap_dirty", count, end_time - start_time);
+
+    /* Try copying descriptors, the second copy is full of duplicates. */
+    start_time = get_time();
+    copy_descriptor_heap(device, gpu_heap, cpu_heap, count);
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "cbv_srv_uav_cpu_to_gpu_dirty", count, end_time - start_time);
+
+    start_time = get_time();
+    copy_descriptor_heap(device, gpu_heap, cpu_heap, count);
+    end_time = get_time();
+    report_result(run, "copy_descriptors_simple", "cbv_srv_uav_cpu_to_gpu_duplicates", count, end_time - start_time);
+
+    /* Create zero descriptors. */
+    start_time = get_time();
+    zero_descriptor_heap(device, gpu_heap, count);
+    end_time = get_time();
+    report_result(run, "fill_srv_null", "gpu_heap", count, end_time - start_time);
+
+    benchmark_copy_simple_variants(device, gpu_heap, cpu_heap, cpu_heap2,
+            gpu_sampler_heap, cpu_sampler_heap, count, run);
+
+    /* Copy descriptor tables gathered from many small source ranges. */
+    start_time = get_time();
+    copy_descriptor_heap_ranges(device, gpu_heap, cpu_heap, count, 1);
+    end_time = get_time();
+    report_result(run, "copy_descriptors", "ranges_1", count, end_time - start_time);
+
+    start_time = get_time();
+    copy_descriptor_heap_ranges(device, gpu_heap, cpu_heap, count, 8);
+    end_time = get_time();
+    report_result(run, "copy_descriptors", "ranges_8", count, end_time - start_time);
+
+    start_time = get_time();
+    copy_descriptor_heap_ranges(device, gpu_heap, cpu_heap, count, 64);
+    end_time = get_time();
+    report_result(run, "copy_descriptors", "ranges_64", count, end_time - start_time);
+
+    benchmark_copy_random_ranges(device, gpu_heap, cpu_heap, count, 1, run);
+    if (benchmark_thread_count > 1)
+        benchmark_copy_random_ranges(device, gpu_heap, cpu_heap, count, benchmark_thread_count, run);
+
+    ID3D12Resource_Release(buffer);
     ID3D12Resource_Release(texture);
-    ID3D12DescriptorHeap_Release(cpu_heap);
-    ID3D12DescriptorHeap_Release(gpu_heap);
+
+out:
+    if (cpu_heap)
+        ID3D12DescriptorHeap_Release(cpu_heap);
+    if (cpu_heap2)
+        ID3D12DescriptorHeap_Release(cpu_heap2);
+    if (gpu_heap)
+        ID3D12DescriptorHeap_Release(gpu_heap);
+    if (cpu_sampler_heap)
+        ID3D12DescriptorHeap_Release(cpu_sampler_heap);
+    if (gpu_sampler_heap)
+        ID3D12DescriptorHeap_Release(gpu_sampler_heap);
 }
 
 START_TEST(descriptor_performance)
@@ -238,9 +621,8 @@ START_TEST(descriptor_performance)
     device = create_device();
     ok(device != NULL, "Failed to create device.\n");
 
-    for (i = 0; i < 100; i++)
-        do_benchmark_run(device);
+    for (i = 0; i < benchmark_iterations; i++)
+        do_benchmark_run(device, i);
 
     ID3D12Device_Release(device);
 }
-
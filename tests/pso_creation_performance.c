@@ -0,0 +1,361 @@
+/*
+ * Copyright 2023 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#define INITGUID
+#define VKD3D_TEST_DECLARE_MAIN
+#include "d3d12_crosstest.h"
+
+/* Measures PSO creation latency. Every PSO in a run is unique, and --salt selects which
+ * slice of the PSO space a run covers. Within one process, three scenarios are timed:
+ * - "create": first creation in this process.
+ * - "library": loading from a deserialized ID3D12PipelineLibrary.
+ * - "repeat": creating the same PSOs again, which hits the in-memory caches.
+ *
+ * Whether "create" is cold depends on the environment. Running twice with the same salt
+ * turns "create" into a disk cache hit with the default VKD3D_SHADER_CACHE_PATH, and into
+ * a driver cache only hit with VKD3D_SHADER_CACHE_PATH=0. Use a new salt for a cold run. */
+
+static unsigned int pso_count = 1000;
+static unsigned int pso_salt;
+static bool output_csv;
+
+static void setup(int argc, char **argv)
+{
+    int i;
+
+    pfn_D3D12CreateDevice = get_d3d12_pfn(D3D12CreateDevice);
+    pfn_D3D12EnableExperimentalFeatures = get_d3d12_pfn(D3D12EnableExperimentalFeatures);
+    pfn_D3D12GetDebugInterface = get_d3d12_pfn(D3D12GetDebugInterface);
+
+    parse_args(argc, argv);
+    enable_d3d12_debug_layer(argc, argv);
+    init_adapter_info();
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--csv"))
+            output_csv = true;
+        else if (!strcmp(argv[i], "--count") && i + 1 < argc)
+            pso_count = max(atoi(argv[++i]), 1);
+        else if (!strcmp(argv[i], "--salt") && i + 1 < argc)
+            pso_salt = atoi(argv[++i]);
+    }
+
+    if (output_csv)
+        printf("kind,scenario,count,total_ms,p50_us,p90_us,p99_us,max_us\n");
+}
+
+static double get_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER lc, lf;
+    QueryPerformanceCounter(&lc);
+    QueryPerformanceFrequency(&lf);
+    return (double)lc.QuadPart / (double)lf.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double da = *(const double *)a, db = *(const double *)b;
+    return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+static double percentile(const double *sorted, unsigned int count, unsigned int p)
+{
+    return sorted[min(count - 1, (count * p) / 100)];
+}
+
+static void report_result(const char *kind, const char *scenario, double *latencies,
+        unsigned int count, double seconds)
+{
+    qsort(latencies, count, sizeof(*latencies), compare_double);
+
+    if (output_csv)
+    {
+        printf("%s,%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", kind, scenario, count, 1e3 * seconds,
+                1e6 * percentile(latencies, count, 50), 1e6 * percentile(latencies, count, 90),
+                1e6 * percentile(latencies, count, 99), 1e6 * latencies[count - 1]);
+    }
+    else
+    {
+        printf("%s PSOs (%s, %u PSOs) took: %.3f ms, p50 %.3f us, p90 %.3f us, p99 %.3f us, max %.3f us.\n",
+                kind, scenario, count, 1e3 * seconds,
+                1e6 * percentile(latencies, count, 50), 1e6 * percentile(latencies, count, 90),
+                1e6 * percentile(latencies, count, 99), 1e6 * latencies[count - 1]);
+    }
+}
+
+static const DWORD cs_code[] =
+{
+#if 0
+    RWByteAddressBuffer o;
+
+    [numthreads(1, 1, 1)]
+    void main(uint3 group_id : SV_groupID)
+    {
+        uint idx = group_id.x + group_id.y * 2 + group_id.z * 6;
+        o.Store(idx * 4, idx);
+    }
+#endif
+    0x43425844, 0xfdd6a339, 0xf3b8096e, 0xb5977014, 0xcdb26cfd, 0x00000001, 0x00000118, 0x00000003,
+    0x0000002c, 0x0000003c, 0x0000004c, 0x4e475349, 0x00000008, 0x00000000, 0x00000008, 0x4e47534f,
+    0x00000008, 0x00000000, 0x00000008, 0x58454853, 0x000000c4, 0x00050050, 0x00000031, 0x0100086a,
+    0x0300009d, 0x0011e000, 0x00000000, 0x0200005f, 0x00021072, 0x02000068, 0x00000001, 0x0400009b,
+    0x00000001, 0x00000001, 0x00000001, 0x06000029, 0x00100012, 0x00000000, 0x0002101a, 0x00004001,
+    0x00000001, 0x0600001e, 0x00100012, 0x00000000, 0x0010000a, 0x00000000, 0x0002100a, 0x08000023,
+    0x00100012, 0x00000000, 0x0002102a, 0x00004001, 0x00000006, 0x0010000a, 0x00000000, 0x07000029,
+    0x00100022, 0x00000000, 0x0010000a, 0x00000000, 0x00004001, 0x00000002, 0x070000a6, 0x0011e012,
+    0x00000000, 0x0010001a, 0x00000000, 0x0010000a, 0x00000000, 0x0100003e,
+};
+
+struct pso_corpus
+{
+    ID3D12RootSignature **compute_root_signatures;
+    ID3D12RootSignature *graphics_root_signature;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC *graphics_descs;
+    ID3D12PipelineState **psos;
+    double *latencies;
+};
+
+/* Compute PSOs differ in where the UAV lives in the descriptor table, which changes the generated code.
+ * Graphics PSOs share the default shaders and differ in blend state, which only changes the pipeline. */
+static void init_pso_corpus(ID3D12Device *device, struct pso_corpus *corpus)
+{
+    static const D3D12_BLEND blends[] =
+    {
+        D3D12_BLEND_ZERO, D3D12_BLEND_ONE, D3D12_BLEND_SRC_COLOR, D3D12_BLEND_INV_SRC_COLOR,
+        D3D12_BLEND_SRC_ALPHA, D3D12_BLEND_INV_SRC_ALPHA, D3D12_BLEND_DEST_ALPHA, D3D12_BLEND_INV_DEST_ALPHA,
+        D3D12_BLEND_DEST_COLOR, D3D12_BLEND_INV_DEST_COLOR, D3D12_BLEND_BLEND_FACTOR, D3D12_BLEND_INV_BLEND_FACTOR,
+    };
+    static const D3D12_BLEND_OP blend_ops[] =
+    {
+        D3D12_BLEND_OP_ADD, D3D12_BLEND_OP_SUBTRACT, D3D12_BLEND_OP_REV_SUBTRACT, D3D12_BLEND_OP_MIN, D3D12_BLEND_OP_MAX,
+    };
+    D3D12_RENDER_TARGET_BLEND_DESC *rt_blend;
+    D3D12_ROOT_SIGNATURE_DESC rs_desc;
+    D3D12_ROOT_PARAMETER root_param;
+    D3D12_DESCRIPTOR_RANGE range;
+    unsigned int i, index;
+
+    corpus->compute_root_signatures = calloc(pso_count, sizeof(*corpus->compute_root_signatures));
+    corpus->graphics_descs = calloc(pso_count, sizeof(*corpus->graphics_descs));
+    corpus->psos = calloc(pso_count, sizeof(*corpus->psos));
+    corpus->latencies = calloc(pso_count, sizeof(*corpus->latencies));
+
+    memset(&rs_desc, 0, sizeof(rs_desc));
+    memset(&root_param, 0, sizeof(root_param));
+    memset(&range, 0, sizeof(range));
+    root_param.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    root_param.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    root_param.DescriptorTable.pDescriptorRanges = &range;
+    root_param.DescriptorTable.NumDescriptorRanges = 1;
+    rs_desc.NumParameters = 1;
+    rs_desc.pParameters = &root_param;
+    range.NumDescriptors = 1;
+    range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+
+    for (i = 0; i < pso_count; i++)
+    {
+        range.OffsetInDescriptorsFromTableStart = pso_salt * pso_count + i;
+        create_root_signature(device, &rs_desc, &corpus->compute_root_signatures[i]);
+    }
+
+    corpus->graphics_root_signature = create_empty_root_signature(device,
+            D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+    for (i = 0; i < pso_count; i++)
+    {
+        index = pso_salt * pso_count + i;
+        init_pipeline_state_desc(&corpus->graphics_descs[i], corpus->graphics_root_signature,
+                DXGI_FORMAT_R8G8B8A8_UNORM, NULL, NULL, NULL);
+
+        rt_blend = &corpus->graphics_descs[i].BlendState.RenderTarget[0];
+        rt_blend->BlendEnable = TRUE;
+        rt_blend->SrcBlend = blends[index % ARRAY_SIZE(blends)];
+        index /= ARRAY_SIZE(blends);
+        rt_blend->DestBlend = blends[index % ARRAY_SIZE(blends)];
+        index /= ARRAY_SIZE(blends);
+        rt_blend->BlendOp = blend_ops[index % ARRAY_SIZE(blend_ops)];
+        index /= ARRAY_SIZE(blend_ops);
+        rt_blend->RenderTargetWriteMask = 1 + index % D3D12_COLOR_WRITE_ENABLE_ALL;
+        rt_blend->SrcBlendAlpha = D3D12_BLEND_ONE;
+        rt_blend->DestBlendAlpha = D3D12_BLEND_ZERO;
+        rt_blend->BlendOpAlpha = D3D12_BLEND_OP_ADD;
+    }
+}
+
+static void destroy_pso_corpus(struct pso_corpus *corpus)
+{
+    unsigned int i;
+
+    for (i = 0; i < pso_count; i++)
+    {
+        if (corpus->compute_root_signatures[i])
+            ID3D12RootSignature_Release(corpus->compute_root_signatures[i]);
+    }
+
+    ID3D12RootSignature_Release(corpus->graphics_root_signature);
+    free(corpus->compute_root_signatures);
+    free(corpus->graphics_descs);
+    free(corpus->psos);
+    free(corpus->latencies);
+}
+
+static void release_psos(struct pso_corpus *corpus)
+{
+    unsigned int i;
+
+    for (i = 0; i < pso_count; i++)
+    {
+        if (corpus->psos[i])
+            ID3D12PipelineState_Release(corpus->psos[i]);
+        corpus->psos[i] = NULL;
+    }
+}
+
+static void get_pso_name(WCHAR *wname, size_t size, bool compute, unsigned int index)
+{
+    char name[32];
+    unsigned int i;
+
+    snprintf(name, sizeof(name), "%s%u", compute ? "c" : "g", index);
+    for (i = 0; i < size; i++)
+        wname[i] = (WCHAR)name[min(i, sizeof(name) - 1)];
+}
+
+/* Creates or loads every PSO of one kind and reports the distribution.
+ * If store_lib is set, every created PSO is also stored in it. */
+static void benchmark_psos(ID3D12Device1 *device1, struct pso_corpus *corpus, bool compute,
+        const char *scenario, ID3D12PipelineLibrary *load_lib, ID3D12PipelineLibrary *store_lib)
+{
+    D3D12_COMPUTE_PIPELINE_STATE_DESC compute_desc;
+    double start_time, pso_start_time;
+    WCHAR wname[32];
+    unsigned int i;
+    HRESULT hr;
+
+    memset(&compute_desc, 0, sizeof(compute_desc));
+    compute_desc.CS.pShaderBytecode = cs_code;
+    compute_desc.CS.BytecodeLength = sizeof(cs_code);
+
+    start_time = get_time();
+    for (i = 0; i < pso_count; i++)
+    {
+        compute_desc.pRootSignature = corpus->compute_root_signatures[i];
+        if (load_lib)
+            get_pso_name(wname, ARRAY_SIZE(wname), compute, i);
+
+        pso_start_time = get_time();
+        if (load_lib && compute)
+        {
+            hr = ID3D12PipelineLibrary_LoadComputePipeline(load_lib, wname, &compute_desc,
+                    &IID_ID3D12PipelineState, (void **)&corpus->psos[i]);
+        }
+        else if (load_lib)
+        {
+            hr = ID3D12PipelineLibrary_LoadGraphicsPipeline(load_lib, wname, &corpus->graphics_descs[i],
+                    &IID_ID3D12PipelineState, (void **)&corpus->psos[i]);
+        }
+        else if (compute)
+        {
+            hr = ID3D12Device1_CreateComputePipelineState(device1, &compute_desc,
+                    &IID_ID3D12PipelineState, (void **)&corpus->psos[i]);
+        }
+        else
+        {
+            hr = ID3D12Device1_CreateGraphicsPipelineState(device1, &corpus->graphics_descs[i],
+                    &IID_ID3D12PipelineState, (void **)&corpus->psos[i]);
+        }
+        corpus->latencies[i] = get_time() - pso_start_time;
+        ok(SUCCEEDED(hr), "Failed to create PSO %u, hr %#x.\n", i, hr);
+
+        if (store_lib && SUCCEEDED(hr))
+        {
+            get_pso_name(wname, ARRAY_SIZE(wname), compute, i);
+            ID3D12PipelineLibrary_StorePipeline(store_lib, wname, corpus->psos[i]);
+        }
+    }
+
+    report_result(compute ? "compute" : "graphics", scenario, corpus->latencies, pso_count, get_time() - start_time);
+    release_psos(corpus);
+}
+
+START_TEST(pso_creation_performance)
+{
+    ID3D12PipelineLibrary *store_lib, *load_lib;
+    struct pso_corpus corpus;
+    ID3D12Device1 *device1;
+    ID3D12Device *device;
+    size_t serialized_size;
+    void *blob;
+    HRESULT hr;
+
+    setup(argc, argv);
+    device = create_device();
+    ok(device != NULL, "Failed to create device.\n");
+    if (!device)
+        return;
+
+    if (FAILED(ID3D12Device_QueryInterface(device, &IID_ID3D12Device1, (void **)&device1)))
+    {
+        skip("ID3D12Device1 is not supported.\n");
+        ID3D12Device_Release(device);
+        return;
+    }
+
+    init_pso_corpus(device, &corpus);
+
+    hr = ID3D12Device1_CreatePipelineLibrary(device1, NULL, 0, &IID_ID3D12PipelineLibrary, (void **)&store_lib);
+    ok(SUCCEEDED(hr), "Failed to create library, hr %#x.\n", hr);
+
+    benchmark_psos(device1, &corpus, true, "create", NULL, store_lib);
+    benchmark_psos(device1, &corpus, false, "create", NULL, store_lib);
+
+    /* Round trip through the serialized blob, like an application loading its library at startup. */
+    serialized_size = ID3D12PipelineLibrary_GetSerializedSize(store_lib);
+    blob = malloc(serialized_size);
+    hr = ID3D12PipelineLibrary_Serialize(store_lib, blob, serialized_size);
+    ok(SUCCEEDED(hr), "Failed to serialize library, hr %#x.\n", hr);
+    ID3D12PipelineLibrary_Release(store_lib);
+
+    hr = ID3D12Device1_CreatePipelineLibrary(device1, blob, serialized_size,
+            &IID_ID3D12PipelineLibrary, (void **)&load_lib);
+    ok(SUCCEEDED(hr), "Failed to create library from blob, hr %#x.\n", hr);
+
+    if (SUCCEEDED(hr))
+    {
+        benchmark_psos(device1, &corpus, true, "library", load_lib, NULL);
+        benchmark_psos(device1, &corpus, false, "library", load_lib, NULL);
+        ID3D12PipelineLibrary_Release(load_lib);
+    }
+
+    benchmark_psos(device1, &corpus, true, "repeat", NULL, NULL);
+    benchmark_psos(device1, &corpus, false, "repeat", NULL, NULL);
+
+    free(blob);
+    destroy_pso_corpus(&corpus);
+    ID3D12Device1_Release(device1);
+    ID3D12Device_Release(device);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2023 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#define INITGUID
+#define VKD3D_TEST_DECLARE_MAIN
+#include "d3d12_crosstest.h"
+
+static void setup(int argc, char **argv)
+{
+    pfn_D3D12CreateDevice = get_d3d12_pfn(D3D12CreateDevice);
+    pfn_D3D12EnableExperimentalFeatures = get_d3d12_pfn(D3D12EnableExperimentalFeatures);
+    pfn_D3D12GetDebugInterface = get_d3d12_pfn(D3D12GetDebugInterface);
+
+    parse_args(argc, argv);
+    enable_d3d12_debug_layer(argc, argv);
+    init_adapter_info();
+}
+
+static double get_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER lc, lf;
+    QueryPerformanceCounter(&lc);
+    QueryPerformanceFrequency(&lf);
+    return (double)lc.QuadPart / (double)lf.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+static void do_benchmark_run(ID3D12Device5 *device5, ID3D12CommandQueue *queue,
+        ID3D12CommandAllocator *allocator, ID3D12GraphicsCommandList4 *list4,
+        ID3D12Resource *vbo, unsigned int blas_count)
+{
+    D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO prebuild_info;
+    D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC build_desc;
+    double record_time, total_time, start_time, end_time;
+    D3D12_RAYTRACING_GEOMETRY_DESC geom_desc;
+    const unsigned int iterations = 16;
+    ID3D12Resource *scratch, *rtas;
+    UINT64 scratch_size, rtas_size;
+    ID3D12Device *device;
+    unsigned int i, j;
+
+    ID3D12Device5_QueryInterface(device5, &IID_ID3D12Device, (void **)&device);
+
+    memset(&geom_desc, 0, sizeof(geom_desc));
+    geom_desc.Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
+    geom_desc.Flags = D3D12_RAYTRACING_GEOMETRY_FLAG_OPAQUE;
+    geom_desc.Triangles.VertexBuffer.StartAddress = ID3D12Resource_GetGPUVirtualAddress(vbo);
+    geom_desc.Triangles.VertexBuffer.StrideInBytes = 3 * sizeof(float);
+    geom_desc.Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
+    geom_desc.Triangles.VertexCount = 3;
+
+    memset(&build_desc, 0, sizeof(build_desc));
+    build_desc.Inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
+    build_desc.Inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_BUILD;
+    build_desc.Inputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+    build_desc.Inputs.NumDescs = 1;
+    build_desc.Inputs.pGeometryDescs = &geom_desc;
+
+    ID3D12Device5_GetRaytracingAccelerationStructurePrebuildInfo(device5, &build_desc.Inputs, &prebuild_info);
+
+    /* Every build gets its own scratch and destination range, so they can all run concurrently,
+     * which is what engines do when rebuilding skinned BLASes. */
+    scratch_size = align(prebuild_info.ScratchDataSizeInBytes, D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+    rtas_size = align(prebuild_info.ResultDataMaxSizeInBytes, D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BYTE_ALIGNMENT);
+
+    scratch = create_default_buffer(device, scratch_size * blas_count,
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    rtas = create_default_buffer(device, rtas_size * blas_count,
+            D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE);
+
+    record_time = 0.0;
+    total_time = 0.0;
+
+    for (i = 0; i < iterations; i++)
+    {
+        start_time = get_time();
+        for (j = 0; j < blas_count; j++)
+        {
+            build_desc.DestAccelerationStructureData = ID3D12Resource_GetGPUVirtualAddress(rtas) + j * rtas_size;
+            build_desc.ScratchAccelerationStructureData = ID3D12Resource_GetGPUVirtualAddress(scratch) + j * scratch_size;
+            ID3D12GraphicsCommandList4_BuildRaytracingAccelerationStructure(list4, &build_desc, 0, NULL);
+        }
+        uav_barrier((ID3D12GraphicsCommandList *)list4, NULL);
+        ID3D12GraphicsCommandList4_Close(list4);
+        end_time = get_time();
+        record_time += end_time - start_time;
+
+        exec_command_list(queue, (ID3D12GraphicsCommandList *)list4);
+        wait_queue_idle(device, queue);
+        total_time += get_time() - start_time;
+
+        ID3D12CommandAllocator_Reset(allocator);
+        ID3D12GraphicsCommandList4_Reset(list4, allocator, NULL);
+    }
+
+    printf("BLAS build (%u x 1 triangle): record %.3f us, record + execute %.3f us per iteration.\n",
+            blas_count, 1e6 * record_time / iterations, 1e6 * total_time / iterations);
+
+    ID3D12Resource_Release(scratch);
+    ID3D12Resource_Release(rtas);
+    ID3D12Device_Release(device);
+}
+
+START_TEST(rtas_build_performance)
+{
+    static const float vertices[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+    D3D12_FEATURE_DATA_D3D12_OPTIONS5 options5;
+    ID3D12GraphicsCommandList4 *list4;
+    ID3D12CommandAllocator *allocator;
+    ID3D12CommandQueue *queue;
+    ID3D12Device5 *device5;
+    ID3D12Device *device;
+    ID3D12Resource *vbo;
+    HRESULT hr;
+
+    setup(argc, argv);
+    device = create_device();
+    ok(device != NULL, "Failed to create device.\n");
+    if (!device)
+        return;
+
+    if (FAILED(ID3D12Device_QueryInterface(device, &IID_ID3D12Device5, (void **)&device5)))
+    {
+        skip("ID3D12Device5 is not supported.\n");
+        ID3D12Device_Release(device);
+        return;
+    }
+
+    if (FAILED(ID3D12Device5_CheckFeatureSupport(device5, D3D12_FEATURE_D3D12_OPTIONS5, &options5, sizeof(options5))) ||
+            options5.RaytracingTier < D3D12_RAYTRACING_TIER_1_0)
+    {
+        skip("Raytracing is not supported.\n");
+        ID3D12Device5_Release(device5);
+        ID3D12Device_Release(device);
+        return;
+    }
+
+    queue = create_command_queue(device, D3D12_COMMAND_LIST_TYPE_DIRECT, D3D12_COMMAND_QUEUE_PRIORITY_NORMAL);
+    hr = ID3D12Device_CreateCommandAllocator(device, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            &IID_ID3D12CommandAllocator, (void **)&allocator);
+    ok(SUCCEEDED(hr), "Failed to create command allocator, hr %#x.\n", hr);
+    hr = ID3D12Device_CreateCommandList(device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            allocator, NULL, &IID_ID3D12GraphicsCommandList4, (void **)&list4);
+    ok(SUCCEEDED(hr), "Failed to create command list, hr %#x.\n", hr);
+
+    vbo = create_upload_buffer(device, sizeof(vertices), vertices);
+
+    do_benchmark_run(device5, queue, allocator, list4, vbo, 16);
+    do_benchmark_run(device5, queue, allocator, list4, vbo, 256);
+    do_benchmark_run(device5, queue, allocator, list4, vbo, 1024);
+
+    ID3D12Resource_Release(vbo);
+    ID3D12GraphicsCommandList4_Release(list4);
+    ID3D12CommandAllocator_Release(allocator);
+    ID3D12CommandQueue_Release(queue);
+    ID3D12Device5_Release(device5);
+    ID3D12Device_Release(device);
+}
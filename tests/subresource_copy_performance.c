@@ -0,0 +1,144 @@
+/*
+ * Copyright 2023 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#define INITGUID
+#define VKD3D_TEST_DECLARE_MAIN
+#include "d3d12_crosstest.h"
+
+static void setup(int argc, char **argv)
+{
+    pfn_D3D12CreateDevice = get_d3d12_pfn(D3D12CreateDevice);
+    pfn_D3D12EnableExperimentalFeatures = get_d3d12_pfn(D3D12EnableExperimentalFeatures);
+    pfn_D3D12GetDebugInterface = get_d3d12_pfn(D3D12GetDebugInterface);
+
+    parse_args(argc, argv);
+    enable_d3d12_debug_layer(argc, argv);
+    init_adapter_info();
+}
+
+static double get_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER lc, lf;
+    QueryPerformanceCounter(&lc);
+    QueryPerformanceFrequency(&lf);
+    return (double)lc.QuadPart / (double)lf.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+static ID3D12Resource *create_cpu_texture(ID3D12Device *device, D3D12_RESOURCE_DIMENSION dimension,
+        D3D12_CPU_PAGE_PROPERTY page_property, UINT width, UINT height, UINT depth)
+{
+    D3D12_HEAP_PROPERTIES heap_properties;
+    D3D12_RESOURCE_DESC resource_desc;
+    ID3D12Resource *resource;
+    HRESULT hr;
+
+    memset(&resource_desc, 0, sizeof(resource_desc));
+    resource_desc.Dimension = dimension;
+    resource_desc.Width = width;
+    resource_desc.Height = height;
+    resource_desc.DepthOrArraySize = depth;
+    resource_desc.MipLevels = 1;
+    resource_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    resource_desc.SampleDesc.Count = 1;
+    resource_desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    memset(&heap_properties, 0, sizeof(heap_properties));
+    heap_properties.Type = D3D12_HEAP_TYPE_CUSTOM;
+    heap_properties.CPUPageProperty = page_property;
+    heap_properties.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+
+    hr = ID3D12Device_CreateCommittedResource(device, &heap_properties, D3D12_HEAP_FLAG_NONE,
+            &resource_desc, D3D12_RESOURCE_STATE_COMMON, NULL, &IID_ID3D12Resource, (void **)&resource);
+    return SUCCEEDED(hr) ? resource : NULL;
+}
+
+static void do_benchmark_run(ID3D12Device *device, const char *tag, D3D12_RESOURCE_DIMENSION dimension,
+        D3D12_CPU_PAGE_PROPERTY page_property, UINT width, UINT height, UINT depth)
+{
+    const unsigned int iterations = 16;
+    double start_time, end_time;
+    UINT row_pitch, slice_pitch;
+    ID3D12Resource *texture;
+    unsigned int i;
+    size_t size;
+    HRESULT hr;
+    void *data;
+
+    if (!(texture = create_cpu_texture(device, dimension, page_property, width, height, depth)))
+    {
+        skip("Failed to create %s texture.\n", tag);
+        return;
+    }
+
+    row_pitch = width * 4;
+    slice_pitch = row_pitch * height;
+    size = (size_t)slice_pitch * depth;
+    data = malloc(size);
+    memset(data, 0x80, size);
+
+    start_time = get_time();
+    for (i = 0; i < iterations; i++)
+    {
+        hr = ID3D12Resource_WriteToSubresource(texture, 0, NULL, data, row_pitch, slice_pitch);
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    }
+    end_time = get_time();
+    printf("WriteToSubresource (%s, %u MiB): %.3f GB/s.\n", tag, (unsigned int)(size >> 20),
+            1e-9 * (double)size * iterations / (end_time - start_time));
+
+    start_time = get_time();
+    for (i = 0; i < iterations; i++)
+    {
+        hr = ID3D12Resource_ReadFromSubresource(texture, data, row_pitch, slice_pitch, 0, NULL);
+        ok(hr == S_OK, "Got unexpected hr %#x.\n", hr);
+    }
+    end_time = get_time();
+    printf("ReadFromSubresource (%s, %u MiB): %.3f GB/s.\n", tag, (unsigned int)(size >> 20),
+            1e-9 * (double)size * iterations / (end_time - start_time));
+
+    free(data);
+    ID3D12Resource_Release(texture);
+}
+
+START_TEST(subresource_copy_performance)
+{
+    ID3D12Device *device;
+
+    setup(argc, argv);
+    device = create_device();
+    ok(device != NULL, "Failed to create device.\n");
+
+    do_benchmark_run(device, "3D write-back", D3D12_RESOURCE_DIMENSION_TEXTURE3D,
+            D3D12_CPU_PAGE_PROPERTY_WRITE_BACK, 256, 256, 256);
+    do_benchmark_run(device, "3D write-combine", D3D12_RESOURCE_DIMENSION_TEXTURE3D,
+            D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE, 256, 256, 256);
+    do_benchmark_run(device, "2D write-back", D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+            D3D12_CPU_PAGE_PROPERTY_WRITE_BACK, 4096, 4096, 1);
+    do_benchmark_run(device, "2D write-combine", D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+            D3D12_CPU_PAGE_PROPERTY_WRITE_COMBINE, 4096, 4096, 1);
+
+    ID3D12Device_Release(device);
+}
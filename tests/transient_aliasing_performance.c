@@ -0,0 +1,209 @@
+/*
+ * Copyright 2024 Hans-Kristian Arntzen for Valve Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#define VKD3D_DBG_CHANNEL VKD3D_DBG_CHANNEL_API
+
+#define INITGUID
+#define VKD3D_TEST_DECLARE_MAIN
+#include "d3d12_crosstest.h"
+
+/* Mimics a frame graph transient allocator, which recreates all of its aliased
+ * render targets in one heap every frame. Run with and without
+ * VKD3D_CONFIG=deferred_memory_bind to compare. */
+
+#define TRANSIENT_FRAME_COUNT 16
+#define TRANSIENT_RESOURCE_COUNT 512
+#define TRANSIENT_HEAP_SIZE (64ull << 20)
+
+static void setup(int argc, char **argv)
+{
+    pfn_D3D12CreateDevice = get_d3d12_pfn(D3D12CreateDevice);
+    pfn_D3D12EnableExperimentalFeatures = get_d3d12_pfn(D3D12EnableExperimentalFeatures);
+    pfn_D3D12GetDebugInterface = get_d3d12_pfn(D3D12GetDebugInterface);
+
+    parse_args(argc, argv);
+    enable_d3d12_debug_layer(argc, argv);
+    init_adapter_info();
+}
+
+static double get_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER lc, lf;
+    QueryPerformanceCounter(&lc);
+    QueryPerformanceFrequency(&lf);
+    return (double)lc.QuadPart / (double)lf.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+static void get_transient_desc(D3D12_RESOURCE_DESC *desc, unsigned int index)
+{
+    static const DXGI_FORMAT formats[] =
+    {
+        DXGI_FORMAT_R8G8B8A8_UNORM,
+        DXGI_FORMAT_R16G16B16A16_FLOAT,
+        DXGI_FORMAT_R11G11B10_FLOAT,
+        DXGI_FORMAT_R32_UINT,
+    };
+
+    memset(desc, 0, sizeof(*desc));
+    desc->Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc->Width = 256u << (index % 3);
+    desc->Height = 256u << ((index / 3) % 3);
+    desc->DepthOrArraySize = 1;
+    desc->MipLevels = 1;
+    desc->Format = formats[index % ARRAY_SIZE(formats)];
+    desc->SampleDesc.Count = 1;
+    desc->Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    desc->Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+}
+
+static void do_benchmark_run(ID3D12Device *device, ID3D12CommandQueue *queue,
+        ID3D12CommandAllocator *allocator, ID3D12GraphicsCommandList *list,
+        ID3D12Heap *heap, ID3D12DescriptorHeap *rtv_heap, bool use_resources)
+{
+    static const float clear_color[] = { 0.25f, 0.5f, 0.75f, 1.0f };
+    ID3D12Resource *resources[TRANSIENT_RESOURCE_COUNT];
+    D3D12_RESOURCE_ALLOCATION_INFO allocation_info;
+    double create_time = 0.0, use_time = 0.0;
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv;
+    unsigned int frame, i, rtv_size;
+    D3D12_RESOURCE_BARRIER barrier;
+    D3D12_RESOURCE_DESC desc;
+    UINT64 heap_offset;
+    double start_time;
+    HRESULT hr;
+
+    rtv_size = ID3D12Device_GetDescriptorHandleIncrementSize(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+
+    for (frame = 0; frame < TRANSIENT_FRAME_COUNT; frame++)
+    {
+        heap_offset = 0;
+        start_time = get_time();
+
+        for (i = 0; i < TRANSIENT_RESOURCE_COUNT; i++)
+        {
+            get_transient_desc(&desc, i);
+            allocation_info = ID3D12Device_GetResourceAllocationInfo(device, 0, 1, &desc);
+
+            /* Reuse the heap from the start once full, same as a real aliasing allocator would. */
+            heap_offset = align(heap_offset, allocation_info.Alignment);
+            if (heap_offset + allocation_info.SizeInBytes > TRANSIENT_HEAP_SIZE)
+                heap_offset = 0;
+
+            hr = ID3D12Device_CreatePlacedResource(device, heap, heap_offset, &desc,
+                    D3D12_RESOURCE_STATE_RENDER_TARGET, NULL, &IID_ID3D12Resource, (void **)&resources[i]);
+            ok(hr == S_OK, "Failed to create placed resource, hr %#x.\n", hr);
+            heap_offset += allocation_info.SizeInBytes;
+        }
+
+        create_time += get_time() - start_time;
+
+        if (use_resources)
+        {
+            start_time = get_time();
+            reset_command_list(list, allocator);
+
+            for (i = 0; i < TRANSIENT_RESOURCE_COUNT; i++)
+            {
+                rtv = ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart(rtv_heap);
+                rtv.ptr += i * rtv_size;
+
+                memset(&barrier, 0, sizeof(barrier));
+                barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+                barrier.Aliasing.pResourceAfter = resources[i];
+                ID3D12GraphicsCommandList_ResourceBarrier(list, 1, &barrier);
+
+                ID3D12Device_CreateRenderTargetView(device, resources[i], NULL, rtv);
+                ID3D12GraphicsCommandList_ClearRenderTargetView(list, rtv, clear_color, 0, NULL);
+            }
+
+            hr = ID3D12GraphicsCommandList_Close(list);
+            ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+            exec_command_list(queue, list);
+            wait_queue_idle(device, queue);
+            use_time += get_time() - start_time;
+        }
+
+        for (i = 0; i < TRANSIENT_RESOURCE_COUNT; i++)
+            ID3D12Resource_Release(resources[i]);
+    }
+
+    printf("%s: %.3f us per CreatePlacedResource", use_resources ? "Create and clear" : "Create only",
+            1e6 * create_time / (TRANSIENT_FRAME_COUNT * TRANSIENT_RESOURCE_COUNT));
+    if (use_resources)
+        printf(", %.3f ms per frame to create views, clear and submit", 1e3 * use_time / TRANSIENT_FRAME_COUNT);
+    printf(".\n");
+}
+
+START_TEST(transient_aliasing_performance)
+{
+    ID3D12CommandAllocator *allocator;
+    ID3D12GraphicsCommandList *list;
+    ID3D12DescriptorHeap *rtv_heap;
+    D3D12_HEAP_DESC heap_desc;
+    ID3D12CommandQueue *queue;
+    ID3D12Device *device;
+    ID3D12Heap *heap;
+    HRESULT hr;
+
+    setup(argc, argv);
+    if (!(device = create_device()))
+    {
+        skip("Failed to create device.\n");
+        return;
+    }
+
+    queue = create_command_queue(device, D3D12_COMMAND_LIST_TYPE_DIRECT, D3D12_COMMAND_QUEUE_PRIORITY_NORMAL);
+
+    hr = ID3D12Device_CreateCommandAllocator(device, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            &IID_ID3D12CommandAllocator, (void **)&allocator);
+    ok(hr == S_OK, "Failed to create command allocator, hr %#x.\n", hr);
+    hr = ID3D12Device_CreateCommandList(device, 0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            allocator, NULL, &IID_ID3D12GraphicsCommandList, (void **)&list);
+    ok(hr == S_OK, "Failed to create command list, hr %#x.\n", hr);
+    hr = ID3D12GraphicsCommandList_Close(list);
+    ok(hr == S_OK, "Failed to close command list, hr %#x.\n", hr);
+
+    rtv_heap = create_cpu_descriptor_heap(device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, TRANSIENT_RESOURCE_COUNT);
+
+    memset(&heap_desc, 0, sizeof(heap_desc));
+    heap_desc.SizeInBytes = TRANSIENT_HEAP_SIZE;
+    heap_desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heap_desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    heap_desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+    hr = ID3D12Device_CreateHeap(device, &heap_desc, &IID_ID3D12Heap, (void **)&heap);
+    ok(hr == S_OK, "Failed to create heap, hr %#x.\n", hr);
+
+    if (SUCCEEDED(hr))
+    {
+        do_benchmark_run(device, queue, allocator, list, heap, rtv_heap, false);
+        do_benchmark_run(device, queue, allocator, list, heap, rtv_heap, true);
+        ID3D12Heap_Release(heap);
+    }
+
+    ID3D12DescriptorHeap_Release(rtv_heap);
+    ID3D12GraphicsCommandList_Release(list);
+    ID3D12CommandAllocator_Release(allocator);
+    ID3D12CommandQueue_Release(queue);
+    ID3D12Device_Release(device);
+}
@@ -23,6 +23,7 @@
 #include "vkd3d_test.h"
 #include <vkd3d_shader.h>
 #include "vkd3d_shader_private.h"
+#include "hashmap.h"
 
 #include <locale.h>
 
@@ -133,6 +134,52 @@ static void test_vkd3d_shader_pfns(void)
     ok(rc == VKD3D_OK, "Got unexpected error code %d.\n", rc);
 }
 
+static void test_vkd3d_shader_cache(void)
+{
+    struct vkd3d_shader_code spirv, cached_spirv;
+    struct vkd3d_shader_cache_info info;
+    struct vkd3d_shader_cache *cache;
+    int rc;
+
+    static const DWORD vs_code[] =
+    {
+#if 0
+        float4 main(int4 p : POSITION) : SV_Position
+        {
+            return p;
+        }
+#endif
+        0x43425844, 0x3fd50ab1, 0x580a1d14, 0x28f5f602, 0xd1083e3a, 0x00000001, 0x000000d8, 0x00000003,
+        0x0000002c, 0x00000060, 0x00000094, 0x4e475349, 0x0000002c, 0x00000001, 0x00000008, 0x00000020,
+        0x00000000, 0x00000000, 0x00000002, 0x00000000, 0x00000f0f, 0x49534f50, 0x4e4f4954, 0xababab00,
+        0x4e47534f, 0x0000002c, 0x00000001, 0x00000008, 0x00000020, 0x00000000, 0x00000001, 0x00000003,
+        0x00000000, 0x0000000f, 0x505f5653, 0x7469736f, 0x006e6f69, 0x52444853, 0x0000003c, 0x00010040,
+        0x0000000f, 0x0300005f, 0x001010f2, 0x00000000, 0x04000067, 0x001020f2, 0x00000000, 0x00000001,
+        0x0500002b, 0x001020f2, 0x00000000, 0x00101e46, 0x00000000, 0x0100003e,
+    };
+    static const struct vkd3d_shader_code vs = {vs_code, sizeof(vs_code)};
+
+    memset(&info, 0, sizeof(info));
+    rc = vkd3d_shader_cache_create(&info, &cache);
+    ok(rc == VKD3D_OK, "Got unexpected error code %d.\n", rc);
+    if (rc != VKD3D_OK)
+        return;
+
+    rc = vkd3d_shader_cache_compile_dxbc(cache, &vs, &spirv, 0, NULL, NULL);
+    ok(rc == VKD3D_OK, "Got unexpected error code %d.\n", rc);
+    rc = vkd3d_shader_cache_compile_dxbc(cache, &vs, &cached_spirv, 0, NULL, NULL);
+    ok(rc == VKD3D_OK, "Got unexpected error code %d.\n", rc);
+
+    ok(spirv.size == cached_spirv.size, "Got size %zu, expected %zu.\n", cached_spirv.size, spirv.size);
+    if (spirv.size == cached_spirv.size)
+        ok(!memcmp(spirv.code, cached_spirv.code, spirv.size), "Cached SPIR-V does not match.\n");
+    ok(spirv.meta.hash == cached_spirv.meta.hash, "Got unexpected hash mismatch.\n");
+
+    vkd3d_shader_free_shader_code(&cached_spirv);
+    vkd3d_shader_free_shader_code(&spirv);
+    vkd3d_shader_cache_destroy(cache);
+}
+
 static void test_vkd3d_dxbc_checksum(void)
 {
     /* Sanity check output so we can verified we migrated correctly. */
@@ -394,11 +441,37 @@ static void test_vkd3d_dxbc_checksum(void)
     }
 }
 
+static void test_hash_xxh64(void)
+{
+    uint8_t data[100];
+    uint64_t hash;
+    size_t i;
+
+    /* Reference values from the XXH64 specification. */
+    hash = hash_xxh64("", 0, 0);
+    ok(hash == 0xef46db3751d8e999ull, "Got unexpected hash %016"PRIx64".\n", hash);
+    hash = hash_xxh64("abc", 3, 0);
+    ok(hash == 0x44bc2cf5ad770999ull, "Got unexpected hash %016"PRIx64".\n", hash);
+
+    /* Exercise the 32-byte stripe loop and every tail path, from an unaligned pointer as well. */
+    for (i = 0; i < ARRAY_SIZE(data); i++)
+        data[i] = i;
+    hash = hash_xxh64(data, sizeof(data) - 1, 0);
+    memmove(data + 1, data, sizeof(data) - 1);
+    ok(hash_xxh64(data + 1, sizeof(data) - 1, 0) == hash, "Hash depends on alignment.\n");
+    for (i = 0; i < ARRAY_SIZE(data); i++)
+        data[i] = i;
+    hash = hash_xxh64(data, sizeof(data), 0);
+    ok(hash == 0x6ac1e58032166597ull, "Got unexpected hash %016"PRIx64".\n", hash);
+}
+
 START_TEST(vkd3d_shader_api)
 {
     setlocale(LC_ALL, "");
 
     run_test(test_invalid_shaders);
     run_test(test_vkd3d_shader_pfns);
+    run_test(test_vkd3d_shader_cache);
     run_test(test_vkd3d_dxbc_checksum);
+    run_test(test_hash_xxh64);
 }